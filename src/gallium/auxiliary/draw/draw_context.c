@@ -1086,6 +1086,24 @@ draw_collect_pipeline_statistics(struct draw_context *draw,
    draw->collect_statistics = enable;
 }
 
+/**
+ * Returns the post-transform vertex cache counters accumulated since the
+ * context was created or since the last draw_reset_vertex_cache_stats().
+ * The hit ratio is hits / lookups.
+ */
+void
+draw_get_vertex_cache_stats(const struct draw_context *draw,
+                            struct draw_vertex_cache_stats *stats)
+{
+   *stats = draw->vcache_stats;
+}
+
+void
+draw_reset_vertex_cache_stats(struct draw_context *draw)
+{
+   memset(&draw->vcache_stats, 0, sizeof(draw->vcache_stats));
+}
+
 /**
  * Computes clipper invocation statistics.
  *
@@ -210,6 +210,10 @@ void draw_vs_reset_so(struct draw_vertex_shader *dvs);
 struct draw_fragment_shader *
 draw_create_fragment_shader(struct draw_context *draw,
                             const struct pipe_shader_state *shader);
+struct draw_fragment_shader *
+draw_create_fragment_shader_info(struct draw_context *draw,
+                                 const struct pipe_shader_state *shader,
+                                 const struct tgsi_shader_info *info);
 void draw_bind_fragment_shader(struct draw_context *draw,
                                struct draw_fragment_shader *dvs);
 void draw_delete_fragment_shader(struct draw_context *draw,
@@ -291,6 +295,20 @@ void draw_set_force_passthrough( struct draw_context *draw,
 void draw_collect_pipeline_statistics(struct draw_context *draw,
                                       boolean enable);
 
+/**
+ * Post-transform vertex cache counters for indexed draws.  Every lookup
+ * that hits is a vertex that did not have to be fetched and shaded again.
+ */
+struct draw_vertex_cache_stats {
+   uint64_t lookups;
+   uint64_t hits;
+};
+
+void draw_get_vertex_cache_stats(const struct draw_context *draw,
+                                 struct draw_vertex_cache_stats *stats);
+
+void draw_reset_vertex_cache_stats(struct draw_context *draw);
+
 /*******************************************************************************
  * Draw pipeline 
  */
@@ -54,6 +54,28 @@ draw_create_fragment_shader(struct draw_context *draw,
 }
 
 
+/**
+ * Like draw_create_fragment_shader(), but for shaders which aren't
+ * expressed in TGSI (e.g. NIR), where the caller already produced the
+ * equivalent shader info.
+ */
+struct draw_fragment_shader *
+draw_create_fragment_shader_info(struct draw_context *draw,
+                                 const struct pipe_shader_state *shader,
+                                 const struct tgsi_shader_info *info)
+{
+   struct draw_fragment_shader *dfs;
+
+   dfs = CALLOC_STRUCT(draw_fragment_shader);
+   if (dfs) {
+      dfs->base = *shader;
+      dfs->info = *info;
+   }
+
+   return dfs;
+}
+
+
 void
 draw_bind_fragment_shader(struct draw_context *draw,
                           struct draw_fragment_shader *dfs)
@@ -31,6 +31,7 @@
 #include "draw_context.h"
 #ifdef HAVE_LLVM
 #include "draw_llvm.h"
+#include "gallivm/lp_bld_init.h"
 #endif
 
 #include "tgsi/tgsi_parse.h"
@@ -148,10 +149,7 @@ static void tgsi_fetch_gs_input(struct draw_geometry_shader *shader,
             machine->Inputs[idx].xyzw[2].u[prim_idx] = shader->in_prim_idx;
             machine->Inputs[idx].xyzw[3].u[prim_idx] = shader->in_prim_idx;
          } else {
-            vs_slot = draw_gs_get_input_index(
-               shader->info.input_semantic_name[slot],
-               shader->info.input_semantic_index[slot],
-               shader->input_info);
+            vs_slot = shader->input_map[slot];
             if (vs_slot < 0) {
                debug_printf("VS/GS signature mismatch!\n");
                machine->Inputs[idx].xyzw[0].f[prim_idx] = 0;
@@ -224,8 +222,9 @@ llvm_fetch_gs_input(struct draw_geometry_shader *shader,
    unsigned slot, i;
    int vs_slot;
    unsigned input_vertex_stride = shader->input_vertex_stride;
+   const unsigned chan_stride = shader->vector_length;
    const float (*input_ptr)[4];
-   float (*input_data)[6][PIPE_MAX_SHADER_INPUTS][TGSI_NUM_CHANNELS][TGSI_NUM_CHANNELS] = &shader->gs_input->data;
+   float *input_data = shader->gs_input;
 
    shader->llvm_prim_ids[shader->fetched_prim_count] = shader->in_prim_idx;
 
@@ -240,6 +239,11 @@ llvm_fetch_gs_input(struct draw_geometry_shader *shader,
       input = (const float (*)[4])(
          (const char *)input_ptr + (indices[i] * input_vertex_stride));
       for (slot = 0, vs_slot = 0; slot < shader->info.num_inputs; ++slot) {
+         /* [i][slot][chan][prim_idx] */
+         float *data = input_data +
+            (i * PIPE_MAX_SHADER_INPUTS + slot) * TGSI_NUM_CHANNELS *
+            chan_stride + prim_idx;
+
          if (shader->info.input_semantic_name[slot] == TGSI_SEMANTIC_PRIMID) {
             /* skip. we handle system values through gallivm */
             /* NOTE: If we hit this case here it's an ordinary input not a sv,
@@ -248,16 +252,13 @@ llvm_fetch_gs_input(struct draw_geometry_shader *shader,
              * would make sense so hack around this later in gallivm.
              */
          } else {
-            vs_slot = draw_gs_get_input_index(
-               shader->info.input_semantic_name[slot],
-               shader->info.input_semantic_index[slot],
-               shader->input_info);
+            vs_slot = shader->input_map[slot];
             if (vs_slot < 0) {
                debug_printf("VS/GS signature mismatch!\n");
-               (*input_data)[i][slot][0][prim_idx] = 0;
-               (*input_data)[i][slot][1][prim_idx] = 0;
-               (*input_data)[i][slot][2][prim_idx] = 0;
-               (*input_data)[i][slot][3][prim_idx] = 0;
+               data[0 * chan_stride] = 0;
+               data[1 * chan_stride] = 0;
+               data[2 * chan_stride] = 0;
+               data[3 * chan_stride] = 0;
             } else {
 #if DEBUG_INPUTS
                debug_printf("\tSlot = %d, vs_slot = %d, i = %d:\n",
@@ -267,16 +268,16 @@ llvm_fetch_gs_input(struct draw_geometry_shader *shader,
                assert(!util_is_inf_or_nan(input[vs_slot][2]));
                assert(!util_is_inf_or_nan(input[vs_slot][3]));
 #endif
-               (*input_data)[i][slot][0][prim_idx] = input[vs_slot][0];
-               (*input_data)[i][slot][1][prim_idx] = input[vs_slot][1];
-               (*input_data)[i][slot][2][prim_idx] = input[vs_slot][2];
-               (*input_data)[i][slot][3][prim_idx] = input[vs_slot][3];
+               data[0 * chan_stride] = input[vs_slot][0];
+               data[1 * chan_stride] = input[vs_slot][1];
+               data[2 * chan_stride] = input[vs_slot][2];
+               data[3 * chan_stride] = input[vs_slot][3];
 #if DEBUG_INPUTS
                debug_printf("\t\t%f %f %f %f\n",
-                            (*input_data)[i][slot][0][prim_idx],
-                            (*input_data)[i][slot][1][prim_idx],
-                            (*input_data)[i][slot][2][prim_idx],
-                            (*input_data)[i][slot][3][prim_idx]);
+                            data[0 * chan_stride],
+                            data[1 * chan_stride],
+                            data[2 * chan_stride],
+                            data[3 * chan_stride]);
 #endif
                ++vs_slot;
             }
@@ -381,7 +382,7 @@ llvm_gs_run(struct draw_geometry_shader *shader,
    input += (shader->emitted_vertices * shader->vertex_size);
 
    ret = shader->current_variant->jit_func(
-      shader->jit_context, shader->gs_input->data,
+      shader->jit_context, shader->gs_input,
       (struct vertex_header*)input,
       input_primitives,
       shader->draw->instance_id,
@@ -404,7 +405,7 @@ static void gs_flush(struct draw_geometry_shader *shader)
    }
 
    debug_assert(input_primitives > 0 &&
-                input_primitives <= 4);
+                input_primitives <= shader->vector_length);
 
    out_prim_count = shader->run(shader, input_primitives);
    shader->fetch_outputs(shader, out_prim_count,
@@ -556,7 +557,7 @@ int draw_geometry_shader_run(struct draw_geometry_shader *shader,
     * overflown vertices into some area where they won't harm anyone */
    unsigned total_verts_per_buffer = shader->primitive_boundary *
       num_in_primitives;
-   unsigned invocation;
+   unsigned invocation, slot;
    //Assume at least one primitive
    max_out_prims = MAX2(max_out_prims, 1);
 
@@ -592,6 +593,12 @@ int draw_geometry_shader_run(struct draw_geometry_shader *shader,
    shader->input_vertex_stride = input_stride;
    shader->input = input;
    shader->input_info = input_info;
+   for (slot = 0; slot < shader->info.num_inputs; ++slot) {
+      shader->input_map[slot] = draw_gs_get_input_index(
+         shader->info.input_semantic_name[slot],
+         shader->info.input_semantic_index[slot],
+         input_info);
+   }
    FREE(shader->primitive_lengths);
    shader->primitive_lengths = MALLOC(max_out_prims * sizeof(unsigned) * shader->num_invocations);
 
@@ -760,11 +767,11 @@ draw_create_geometry_shader(struct draw_context *draw,
 
 #ifdef HAVE_LLVM
    if (use_llvm) {
-      /* TODO: change the input array to handle the following
-         vector length, instead of the currently hardcoded
-         TGSI_NUM_CHANNELS
-      gs->vector_length = lp_native_vector_width / 32;*/
-      gs->vector_length = TGSI_NUM_CHANNELS;
+      /* Batch as many input primitives per invocation as the native SIMD
+       * width allows: 4 with SSE, 8 with AVX.  Like for the VS, the emit
+       * code has only been tuned up to 8-wide vectors.
+       */
+      gs->vector_length = MIN2(lp_native_vector_width, 256) / 32;
    } else
 #endif
    {
@@ -812,8 +819,10 @@ draw_create_geometry_shader(struct draw_context *draw,
 #ifdef HAVE_LLVM
    if (use_llvm) {
       int vector_size = gs->vector_length * sizeof(float);
-      gs->gs_input = align_malloc(sizeof(struct draw_gs_inputs), 16);
-      memset(gs->gs_input, 0, sizeof(struct draw_gs_inputs));
+      unsigned input_size =
+         DRAW_GS_INPUT_SIZE(gs->vector_length) * sizeof(float);
+      gs->gs_input = align_malloc(input_size, vector_size);
+      memset(gs->gs_input, 0, input_size);
       gs->llvm_prim_lengths = 0;
 
       gs->llvm_emitted_primitives = align_malloc(vector_size, vector_size);
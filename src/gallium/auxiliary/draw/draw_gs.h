@@ -41,17 +41,16 @@ struct draw_gs_jit_context;
 struct draw_gs_llvm_variant;
 
 /**
- * Structure holding the inputs to the geometry shader. It uses SOA layout.
- * The dimensions are as follows:
+ * Number of floats holding the inputs to the geometry shader. They use SOA
+ * layout. The dimensions are as follows:
  * - maximum number of vertices for a geometry shader input primitive
  *   (6 for triangle_adjacency)
  * - maximum number of attributes for each vertex
  * - four channels per each attribute (x,y,z,w)
  * - number of input primitives equal to the SOA vector length
  */
-struct draw_gs_inputs {
-   float data[6][PIPE_MAX_SHADER_INPUTS][TGSI_NUM_CHANNELS][TGSI_NUM_CHANNELS];
-};
+#define DRAW_GS_INPUT_SIZE(vector_length) \
+   (6 * PIPE_MAX_SHADER_INPUTS * TGSI_NUM_CHANNELS * (vector_length))
 #endif
 
 /**
@@ -87,13 +86,15 @@ struct draw_geometry_shader {
    unsigned fetched_prim_count;
    const float (*input)[4];
    const struct tgsi_shader_info *input_info;
+   /** VS output slot for each GS input slot, -1 if not written by the VS */
+   int input_map[PIPE_MAX_SHADER_INPUTS];
    unsigned vector_length;
    unsigned max_out_prims;
 
    unsigned num_invocations;
    unsigned invocation_id;
 #ifdef HAVE_LLVM
-   struct draw_gs_inputs *gs_input;
+   float *gs_input;
    struct draw_gs_jit_context *jit_context;
    struct draw_gs_llvm_variant *current_variant;
    struct vertex_header *gs_output;
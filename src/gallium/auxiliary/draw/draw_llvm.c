@@ -328,12 +328,13 @@ create_gs_jit_context_type(struct gallivm_state *gallivm,
 
 
 static LLVMTypeRef
-create_gs_jit_input_type(struct gallivm_state *gallivm)
+create_gs_jit_input_type(struct gallivm_state *gallivm,
+                         unsigned vector_length)
 {
    LLVMTypeRef float_type = LLVMFloatTypeInContext(gallivm->context);
    LLVMTypeRef input_array;
 
-   input_array = LLVMVectorType(float_type, TGSI_NUM_CHANNELS); /* num primitives */
+   input_array = LLVMVectorType(float_type, vector_length); /* num primitives */
    input_array = LLVMArrayType(input_array, TGSI_NUM_CHANNELS); /* num channels */
    input_array = LLVMArrayType(input_array, PIPE_MAX_SHADER_INPUTS); /* num attrs per vertex */
    input_array = LLVMPointerType(input_array, 0); /* num vertices per prim */
@@ -565,7 +566,7 @@ draw_llvm_create_variant(struct draw_llvm *llvm,
    util_snprintf(module_name, sizeof(module_name), "draw_llvm_vs_variant%u",
                  variant->shader->variants_cached);
 
-   variant->gallivm = gallivm_create(module_name, llvm->context);
+   variant->gallivm = gallivm_create(module_name, llvm->context, NULL);
 
    create_jit_types(variant);
 
@@ -629,6 +630,8 @@ generate_vs(struct draw_llvm_variant *variant,
                      NULL,
                      draw_sampler,
                      &llvm->draw->vs.vertex_shader->info,
+                     NULL,
+                     NULL,
                      NULL);
 
    {
@@ -1445,18 +1448,28 @@ draw_gs_llvm_emit_vertex(const struct lp_build_tgsi_gs_iface *gs_base,
    LLVMValueRef clipmask = lp_build_const_int_vec(gallivm,
                                                   lp_int_type(gs_type), 0);
    LLVMValueRef indices[LP_MAX_VECTOR_LENGTH];
-   LLVMValueRef next_prim_offset =
-      lp_build_const_int32(gallivm, variant->shader->base.primitive_boundary);
+   LLVMValueRef lane_offsets[LP_MAX_VECTOR_LENGTH];
+   LLVMValueRef vertex_indices;
    LLVMValueRef io = variant->io_ptr;
    unsigned i;
    const struct tgsi_shader_info *gs_info = &variant->shader->base.info;
 
+   /*
+    * Every lane owns primitive_boundary output vertices; compute all the
+    * output slots with one vector add and only extract the lanes for the
+    * scattered stores.
+    */
+   for (i = 0; i < gs_type.length; ++i) {
+      lane_offsets[i] = lp_build_const_int32(
+         gallivm, i * variant->shader->base.primitive_boundary);
+   }
+   vertex_indices = LLVMBuildAdd(builder, emitted_vertices_vec,
+                                 LLVMConstVector(lane_offsets, gs_type.length),
+                                 "");
+
    for (i = 0; i < gs_type.length; ++i) {
       LLVMValueRef ind = lp_build_const_int32(gallivm, i);
-      LLVMValueRef currently_emitted =
-         LLVMBuildExtractElement(builder, emitted_vertices_vec, ind, "");
-      indices[i] = LLVMBuildMul(builder, ind, next_prim_offset, "");
-      indices[i] = LLVMBuildAdd(builder, indices[i], currently_emitted, "");
+      indices[i] = LLVMBuildExtractElement(builder, vertex_indices, ind, "");
    }
 
    convert_to_aos(gallivm, io, indices,
@@ -1548,7 +1561,11 @@ draw_llvm_generate(struct draw_llvm *llvm, struct draw_llvm_variant *variant)
    struct lp_build_context bld, blduivec;
    struct lp_build_loop_state lp_loop;
    struct lp_build_if_state if_ctx;
-   const int vector_length = lp_native_vector_width / 32;
+   /*
+    * The vertex fetch/emit code has only been tuned up to 8-wide vectors,
+    * 16-wide (AVX-512) is used for fragment shading only.
+    */
+   const int vector_length = MIN2(lp_native_vector_width, 256) / 32;
    LLVMValueRef outputs[PIPE_MAX_SHADER_OUTPUTS][TGSI_NUM_CHANNELS];
    struct lp_build_sampler_soa *sampler = 0;
    LLVMValueRef ret, clipmask_bool_ptr;
@@ -2189,7 +2206,8 @@ create_gs_jit_types(struct draw_gs_llvm_variant *var)
                                              "draw_gs_jit_context");
    var->context_ptr_type = LLVMPointerType(context_type, 0);
 
-   var->input_array_type = create_gs_jit_input_type(gallivm);
+   var->input_array_type =
+      create_gs_jit_input_type(gallivm, var->shader->base.vector_length);
 }
 
 static LLVMTypeRef
@@ -2356,7 +2374,9 @@ draw_gs_llvm_generate(struct draw_llvm *llvm,
                      NULL,
                      sampler,
                      &llvm->draw->gs.geometry_shader->info,
-                     (const struct lp_build_tgsi_gs_iface *)&gs_iface);
+                     (const struct lp_build_tgsi_gs_iface *)&gs_iface,
+                     NULL,
+                     NULL);
 
    sampler->destroy(sampler);
 
@@ -2391,7 +2411,7 @@ draw_gs_llvm_create_variant(struct draw_llvm *llvm,
    util_snprintf(module_name, sizeof(module_name), "draw_llvm_gs_variant%u",
                  variant->shader->variants_cached);
 
-   variant->gallivm = gallivm_create(module_name, llvm->context);
+   variant->gallivm = gallivm_create(module_name, llvm->context, NULL);
 
    create_gs_jit_types(variant);
 
@@ -277,7 +277,7 @@ typedef boolean
 
 typedef int
 (*draw_gs_jit_func)(struct draw_gs_jit_context *context,
-                    float inputs[6][PIPE_MAX_SHADER_INPUTS][TGSI_NUM_CHANNELS][TGSI_NUM_CHANNELS],
+                    float *inputs,
                     struct vertex_header *output,
                     unsigned num_prims,
                     unsigned instance_id,
@@ -36,6 +36,21 @@
 #include "util/u_math.h"
 
 
+/**
+ * State for the triangle list fast path, see tri_list_setup().
+ */
+struct tri_list {
+   struct draw_stage *clip;     /**< clip stage, NULL if not clipping */
+   struct draw_stage *accept;   /**< stage for unclipped triangles */
+   boolean cull;                /**< do face culling here */
+   boolean cull_clipped;        /**< also for triangles that need clipping */
+   boolean front_ccw;
+   unsigned cull_face;
+   unsigned pos;
+   float viewport_sign;         /**< sign of viewport x scale * y scale */
+};
+
+
 
 boolean draw_pipeline_init( struct draw_context *draw )
 {
@@ -167,6 +182,196 @@ static void do_triangle( struct draw_context *draw,
 }
 
 
+/**
+ * Triangle list fast path.
+ *
+ * When clipping and culling are the only stages in front of the backend,
+ * classify the triangles of a run in one tight loop instead of pushing each
+ * of them through the clip and cull stage callbacks:  triangles outside a
+ * clip plane and culled triangles are dropped without building a
+ * prim_header, triangles inside the clip volume (or the guard band) go
+ * straight to the backend, and only triangles that really cross a plane
+ * enter the clip stage.
+ *
+ * Consecutive triangles to be clipped are handed to the clip stage in
+ * batches, see draw_clip_tri_batch(), rather than one callback each.
+ *
+ * \return FALSE if the current pipeline has other stages
+ */
+static boolean
+tri_list_setup(struct draw_context *draw, struct tri_list *tris)
+{
+   struct draw_stage *stage = draw_validate_pipeline(draw);
+   boolean has_cull = FALSE;
+
+   tris->clip = NULL;
+   if (stage == draw->pipeline.clip) {
+      tris->clip = stage;
+      stage = stage->next;
+   }
+   if (stage == draw->pipeline.cull) {
+      has_cull = TRUE;
+      stage = stage->next;
+   }
+   if (stage != draw->pipeline.rasterize)
+      return FALSE;
+
+   /* leave cull distances to the cull stage */
+   tris->cull = has_cull &&
+                !draw_current_shader_num_written_culldistances(draw);
+   tris->accept = has_cull && !tris->cull ? draw->pipeline.cull :
+                                            draw->pipeline.rasterize;
+   tris->front_ccw = draw->rasterizer->front_ccw;
+   tris->cull_face = draw->rasterizer->cull_face;
+   tris->pos = draw_current_shader_position_output(draw);
+
+   /*
+    * Triangles to be clipped are culled on their clip space position, which
+    * needs the visible part to have w > 0 (guaranteed by either the xy or
+    * the z planes) and a single viewport matching what the clipper uses.
+    */
+   tris->cull_clipped = tris->cull && tris->clip &&
+                        (draw->clip_xy || draw->clip_z) &&
+                        !draw->bypass_viewport &&
+                        !draw_current_shader_uses_viewport_index(draw);
+   tris->viewport_sign =
+      draw->viewports[0].scale[0] * draw->viewports[0].scale[1] < 0.0f ?
+      -1.0f : 1.0f;
+
+   return TRUE;
+}
+
+
+/**
+ * Face culling on window coordinates, exactly like the cull stage.
+ */
+static inline boolean
+tri_list_cull_window(const struct tri_list *tris,
+                     const float *v0, const float *v1, const float *v2,
+                     float *det)
+{
+   const float ex = v0[0] - v2[0];
+   const float ey = v0[1] - v2[1];
+   const float fx = v1[0] - v2[0];
+   const float fy = v1[1] - v2[1];
+
+   *det = ex * fy - ey * fx;
+
+   if (*det != 0) {
+      unsigned ccw = (*det < 0);
+      unsigned face = (ccw == tris->front_ccw) ? PIPE_FACE_FRONT :
+                                                 PIPE_FACE_BACK;
+      return (face & tris->cull_face) != 0;
+   }
+
+   return (PIPE_FACE_BACK & tris->cull_face) != 0;
+}
+
+
+/**
+ * Face culling on clip space positions, for triangles crossing clip planes.
+ *
+ * The determinant of the (x, y, w) rows is w0 * w1 * w2 times the
+ * normalized device coordinate area, and its sign tells on which side of
+ * the triangle's plane the eye is.  So it gives the facing of every piece
+ * the clipper would produce, even when some vertices are behind the eye.
+ * Degenerate cases are left to the cull stage after clipping.
+ */
+static inline boolean
+tri_list_cull_clip(const struct tri_list *tris,
+                   const float *v0, const float *v1, const float *v2)
+{
+   const float det = (v0[0] * (v1[1] * v2[3] - v2[1] * v1[3]) -
+                      v0[1] * (v1[0] * v2[3] - v2[0] * v1[3]) +
+                      v0[3] * (v1[0] * v2[1] - v2[0] * v1[1])) *
+                     tris->viewport_sign;
+   unsigned ccw, face;
+
+   if (!(det < 0.0f || det > 0.0f))
+      return FALSE;
+
+   ccw = (det < 0);
+   face = (ccw == tris->front_ccw) ? PIPE_FACE_FRONT : PIPE_FACE_BACK;
+   return (face & tris->cull_face) != 0;
+}
+
+
+static void
+tri_list_run(const struct tri_list *tris,
+             char *verts,
+             unsigned stride,
+             const ushort *elts,
+             unsigned count,
+             unsigned max_index)
+{
+   struct prim_header clip_prims[DRAW_CLIP_TRI_BATCH];
+   struct prim_header prim;
+   unsigned num_clip = 0;
+   unsigned i;
+
+   prim.flags = DRAW_PIPE_RESET_STIPPLE | DRAW_PIPE_EDGE_FLAG_ALL;
+   prim.pad = 0;
+
+   for (i = 0; i + 2 < count; i += 3) {
+      struct vertex_header *v0, *v1, *v2;
+      unsigned clipmask;
+
+      if (elts) {
+         v0 = (struct vertex_header *)(verts + stride * MIN2(elts[i], max_index));
+         v1 = (struct vertex_header *)(verts + stride * MIN2(elts[i + 1], max_index));
+         v2 = (struct vertex_header *)(verts + stride * MIN2(elts[i + 2], max_index));
+      }
+      else {
+         v0 = (struct vertex_header *)(verts + stride * i);
+         v1 = (struct vertex_header *)(verts + stride * (i + 1));
+         v2 = (struct vertex_header *)(verts + stride * (i + 2));
+      }
+
+      clipmask = v0->clipmask | v1->clipmask | v2->clipmask;
+
+      prim.v[0] = v0;
+      prim.v[1] = v1;
+      prim.v[2] = v2;
+      prim.det = 0;
+
+      if (tris->clip && clipmask) {
+         /* trivial reject */
+         if (v0->clipmask & v1->clipmask & v2->clipmask)
+            continue;
+
+         if (tris->cull_clipped &&
+             tri_list_cull_clip(tris, v0->clip_pos, v1->clip_pos,
+                                v2->clip_pos))
+            continue;
+
+         clip_prims[num_clip++] = prim;
+         if (num_clip == DRAW_CLIP_TRI_BATCH) {
+            draw_clip_tri_batch(tris->clip, clip_prims, num_clip);
+            num_clip = 0;
+         }
+      }
+      else {
+         if (tris->cull &&
+             tri_list_cull_window(tris, v0->data[tris->pos],
+                                  v1->data[tris->pos], v2->data[tris->pos],
+                                  &prim.det))
+            continue;
+
+         /* keep the triangles in order */
+         if (num_clip) {
+            draw_clip_tri_batch(tris->clip, clip_prims, num_clip);
+            num_clip = 0;
+         }
+
+         tris->accept->tri(tris->accept, &prim);
+      }
+   }
+
+   if (num_clip)
+      draw_clip_tri_batch(tris->clip, clip_prims, num_clip);
+}
+
+
 /*
  * Set up macros for draw_pt_decompose.h template code.
  * This code uses vertex indexes / elements.
@@ -227,8 +432,13 @@ void draw_pipeline_run( struct draw_context *draw,
                         const struct draw_vertex_info *vert_info,
                         const struct draw_prim_info *prim_info)
 {
+   struct tri_list tris;
+   boolean use_tri_list;
    unsigned i, start;
 
+   use_tri_list = prim_info->prim == PIPE_PRIM_TRIANGLES &&
+                  tri_list_setup(draw, &tris);
+
    draw->pipeline.verts = (char *)vert_info->verts;
    draw->pipeline.vertex_stride = vert_info->stride;
    draw->pipeline.vertex_count = vert_info->count;
@@ -258,14 +468,22 @@ void draw_pipeline_run( struct draw_context *draw,
       }
 #endif
 
-      pipe_run_elts(draw,
-                    prim_info->prim,
-                    prim_info->flags,
-                    vert_info->verts,
-                    vert_info->stride,
-                    prim_info->elts + start,
-                    count,
-                    vert_info->count - 1);
+      if (use_tri_list)
+         tri_list_run(&tris,
+                      (char *)vert_info->verts,
+                      vert_info->stride,
+                      prim_info->elts + start,
+                      count,
+                      vert_info->count - 1);
+      else
+         pipe_run_elts(draw,
+                       prim_info->prim,
+                       prim_info->flags,
+                       vert_info->verts,
+                       vert_info->stride,
+                       prim_info->elts + start,
+                       count,
+                       vert_info->count - 1);
    }
 
    draw->pipeline.verts = NULL;
@@ -314,8 +532,13 @@ void draw_pipeline_run_linear( struct draw_context *draw,
                                const struct draw_vertex_info *vert_info,
                                const struct draw_prim_info *prim_info)
 {
+   struct tri_list tris;
+   boolean use_tri_list;
    unsigned i, start;
 
+   use_tri_list = prim_info->prim == PIPE_PRIM_TRIANGLES &&
+                  tri_list_setup(draw, &tris);
+
    for (start = i = 0;
         i < prim_info->primitive_count;
         start += prim_info->primitive_lengths[i], i++)
@@ -330,12 +553,15 @@ void draw_pipeline_run_linear( struct draw_context *draw,
 
       assert(count <= vert_info->count);
 
-      pipe_run_linear(draw,
-                      prim_info->prim,
-                      prim_info->flags,
-                      (struct vertex_header*)verts,
-                      vert_info->stride,
-                      count);
+      if (use_tri_list)
+         tri_list_run(&tris, verts, vert_info->stride, NULL, count, 0);
+      else
+         pipe_run_linear(draw,
+                         prim_info->prim,
+                         prim_info->flags,
+                         (struct vertex_header*)verts,
+                         vert_info->stride,
+                         count);
    }
 
    draw->pipeline.verts = NULL;
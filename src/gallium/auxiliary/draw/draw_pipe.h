@@ -92,6 +92,8 @@ extern struct draw_stage *draw_wide_line_stage( struct draw_context *context );
 extern struct draw_stage *draw_wide_point_stage( struct draw_context *context );
 extern struct draw_stage *draw_validate_stage( struct draw_context *context );
 
+extern struct draw_stage *draw_validate_pipeline( struct draw_context *draw );
+
 extern void draw_free_temp_verts( struct draw_stage *stage );
 extern boolean draw_alloc_temp_verts( struct draw_stage *stage, unsigned nr );
 
@@ -101,6 +103,13 @@ void draw_pipe_passthrough_tri(struct draw_stage *stage, struct prim_header *hea
 void draw_pipe_passthrough_line(struct draw_stage *stage, struct prim_header *header);
 void draw_pipe_passthrough_point(struct draw_stage *stage, struct prim_header *header);
 
+/** Maximum number of triangles passed to draw_clip_tri_batch() */
+#define DRAW_CLIP_TRI_BATCH 64
+
+void draw_clip_tri_batch(struct draw_stage *stage,
+                         struct prim_header *prims,
+                         unsigned count);
+
 void draw_aapoint_prepare_outputs(struct draw_context *context,
                                   struct draw_stage *stage);
 void draw_aaline_prepare_outputs(struct draw_context *context,
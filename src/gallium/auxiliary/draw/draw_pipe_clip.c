@@ -386,11 +386,14 @@ static inline float getclipdist(const struct clip_stage *clipper,
 }
 
 /* Clip a triangle against the viewport and user clip planes.
+ * If given, near_dist holds the distances of the three vertices to the
+ * first plane of clipmask, computed by draw_clip_tri_batch().
  */
 static void
 do_clip_tri(struct draw_stage *stage,
             struct prim_header *header,
-            unsigned clipmask)
+            unsigned clipmask,
+            const float *near_dist)
 {
    struct clip_stage *clipper = clip_stage( stage );
    struct vertex_header *a[MAX_CLIPPED_VERTICES];
@@ -405,6 +408,7 @@ do_clip_tri(struct draw_stage *stage,
    boolean bEdges[MAX_CLIPPED_VERTICES];
    boolean *inEdges = aEdges;
    boolean *outEdges = bEdges;
+   float dist[MAX_CLIPPED_VERTICES];
    int viewport_index = 0;
 
    inlist[0] = header->v[0];
@@ -465,26 +469,29 @@ do_clip_tri(struct draw_stage *stage,
       float dp_prev;
       unsigned outcount = 0;
 
-      dp_prev = getclipdist(clipper, vert_prev, plane_idx);
       clipmask &= ~(1<<plane_idx);
 
-      if (util_is_inf_or_nan(dp_prev))
-         return; //discard nan
-
       assert(n < MAX_CLIPPED_VERTICES);
       if (n >= MAX_CLIPPED_VERTICES)
          return;
+
+      for (i = 0; i < n; i++) {
+         dist[i] = near_dist ? near_dist[i] :
+                               getclipdist(clipper, inlist[i], plane_idx);
+         if (util_is_inf_or_nan(dist[i]))
+            return; //discard nan
+      }
+      near_dist = NULL;
+
       inlist[n] = inlist[0]; /* prevent rotation of vertices */
       inEdges[n] = inEdges[0];
+      dist[n] = dist[0];
+      dp_prev = dist[0];
 
       for (i = 1; i <= n; i++) {
          struct vertex_header *vert = inlist[i];
          boolean *edge = &inEdges[i];
-
-         float dp = getclipdist(clipper, vert, plane_idx);
-
-         if (util_is_inf_or_nan(dp))
-            return; //discard nan
+         float dp = dist[i];
 
          if (dp_prev >= 0.0f) {
             assert(outcount < MAX_CLIPPED_VERTICES);
@@ -759,7 +766,7 @@ clip_tri(struct draw_stage *stage, struct prim_header *header)
    else if ((header->v[0]->clipmask & 
              header->v[1]->clipmask & 
              header->v[2]->clipmask) == 0) {
-      do_clip_tri(stage, header, clipmask);
+      do_clip_tri(stage, header, clipmask, NULL);
    }
 }
 
@@ -943,6 +950,50 @@ static void clip_first_line(struct draw_stage *stage,
 }
 
 
+/**
+ * Clip a batch of triangles, in order, for the triangle list fast path in
+ * draw_pipe.c.  None of them is trivially rejected or inside the clip
+ * volume.
+ *
+ * Large triangles mostly cross the near plane only, as the guard band
+ * keeps them from crossing the xy planes.  The near plane distances of the
+ * whole batch are computed up front in one loop, and the triangles which
+ * cross no other plane are clipped with them, without looking up the
+ * plane distances one vertex at a time.
+ */
+void
+draw_clip_tri_batch(struct draw_stage *stage,
+                    struct prim_header *prims,
+                    unsigned count)
+{
+   struct clip_stage *clipper = clip_stage(stage);
+   float dist[DRAW_CLIP_TRI_BATCH][3];
+   const float *plane;
+   unsigned i, j;
+
+   assert(count <= DRAW_CLIP_TRI_BATCH);
+
+   if (stage->tri != clip_tri)
+      clip_init_state(stage);
+
+   plane = clipper->plane[4];
+   for (i = 0; i < count; i++) {
+      for (j = 0; j < 3; j++)
+         dist[i][j] = dot4(prims[i].v[j]->clip_pos, plane);
+   }
+
+   for (i = 0; i < count; i++) {
+      unsigned clipmask = (prims[i].v[0]->clipmask |
+                           prims[i].v[1]->clipmask |
+                           prims[i].v[2]->clipmask);
+
+      assert(clipmask);
+      do_clip_tri(stage, &prims[i], clipmask,
+                  clipmask == (1 << 4) ? dist[i] : NULL);
+   }
+}
+
+
 static void clip_flush(struct draw_stage *stage, unsigned flags)
 {
    stage->tri = clip_first_tri;
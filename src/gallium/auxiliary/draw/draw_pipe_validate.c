@@ -278,6 +278,17 @@ static struct draw_stage *validate_pipeline( struct draw_stage *stage )
    return draw->pipeline.first;
 }
 
+/**
+ * Validate the pipeline now instead of on the first primitive, for callers
+ * that need to know which stages are active.
+ */
+struct draw_stage *draw_validate_pipeline( struct draw_context *draw )
+{
+   if (draw->pipeline.first == draw->pipeline.validate)
+      return validate_pipeline( draw->pipeline.validate );
+   return draw->pipeline.first;
+}
+
 static void validate_tri( struct draw_stage *stage, 
 			  struct prim_header *header )
 {
@@ -44,7 +44,9 @@
 #include "pipe/p_state.h"
 #include "pipe/p_defines.h"
 
+#include "draw/draw_context.h"
 #include "tgsi/tgsi_scan.h"
+#include "util/u_queue.h"
 
 #ifdef HAVE_LLVM
 struct gallivm_state;
@@ -59,6 +61,11 @@ struct gallivm_state;
  */
 #define DRAW_MAX_FETCH_IDX 0xffffffff
 
+/**
+ * Maximum number of worker threads for vertex processing.
+ */
+#define DRAW_MAX_THREADS 16
+
 struct pipe_context;
 struct draw_vertex_shader;
 struct draw_context;
@@ -212,6 +219,10 @@ struct draw_context
 
       boolean test_fse;         /* enable FSE even though its not correct (eg for softpipe) */
       boolean no_fse;           /* disable FSE even when it is correct */
+
+      /** Worker threads sharing the vertex shading of large draws */
+      struct util_queue vs_queue;
+      unsigned num_threads;
    } pt;
 
    struct {
@@ -339,6 +350,8 @@ struct draw_context
    struct pipe_query_data_pipeline_statistics statistics;
    boolean collect_statistics;
 
+   struct draw_vertex_cache_stats vcache_stats;
+
    struct draw_assembler *ia;
 
    void *driver_private;
@@ -45,6 +45,7 @@
 
 DEBUG_GET_ONCE_BOOL_OPTION(draw_fse, "DRAW_FSE", FALSE)
 DEBUG_GET_ONCE_BOOL_OPTION(draw_no_fse, "DRAW_NO_FSE", FALSE)
+DEBUG_GET_ONCE_NUM_OPTION(draw_num_threads, "DRAW_NUM_THREADS", 0)
 
 /* Overall we split things into:
  *     - frontend -- prepare fetch_elts, draw_elts - eg vsplit
@@ -192,8 +193,18 @@ boolean draw_pt_init( struct draw_context *draw )
       return FALSE;
 
 #if HAVE_LLVM
-   if (draw->llvm)
+   if (draw->llvm) {
+      unsigned num_threads = MIN2(debug_get_option_draw_num_threads(),
+                                  DRAW_MAX_THREADS);
+
       draw->pt.middle.llvm = draw_pt_fetch_pipeline_or_emit_llvm( draw );
+
+      if (num_threads &&
+          util_queue_init(&draw->pt.vs_queue, "draw_vs", DRAW_MAX_THREADS,
+                          num_threads, 0)) {
+         draw->pt.num_threads = num_threads;
+      }
+   }
 #endif
 
    return TRUE;
@@ -202,6 +213,11 @@ boolean draw_pt_init( struct draw_context *draw )
 
 void draw_pt_destroy( struct draw_context *draw )
 {
+   if (util_queue_is_initialized(&draw->pt.vs_queue)) {
+      util_queue_destroy(&draw->pt.vs_queue);
+      draw->pt.num_threads = 0;
+   }
+
    if (draw->pt.middle.llvm) {
       draw->pt.middle.llvm->destroy( draw->pt.middle.llvm );
       draw->pt.middle.llvm = NULL;
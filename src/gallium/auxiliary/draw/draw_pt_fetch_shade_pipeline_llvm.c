@@ -40,6 +40,37 @@
 #include "gallivm/lp_bld_debug.h"
 
 
+/**
+ * Don't bother the worker threads with fewer vertices than this.
+ */
+#define MIN_VERTICES_PER_THREAD 256
+
+/**
+ * Chunk size asked of vsplit per thread shading vertices, and the chunk
+ * size limit, which keeps vertex indices within the 16 bit draw elements.
+ */
+#define VERTICES_PER_THREAD 4096
+#define MAX_THREADED_VERTICES 32768
+
+
+struct llvm_middle_end;
+
+/**
+ * A range of a draw's vertices, fetched and shaded on a worker thread.
+ */
+struct llvm_vs_job {
+   struct llvm_middle_end *fpme;
+   struct vertex_header *verts;
+   unsigned offset;
+   unsigned count;
+   unsigned start_or_maxelt;
+   unsigned vid_base;
+   const unsigned *elts;
+   boolean clipped;
+   struct util_queue_fence fence;
+};
+
+
 struct llvm_middle_end {
    struct draw_pt_middle_end base;
    struct draw_context *draw;
@@ -57,6 +88,8 @@ struct llvm_middle_end {
 
    struct draw_llvm *llvm;
    struct draw_llvm_variant *current_variant;
+
+   struct llvm_vs_job jobs[DRAW_MAX_THREADS];
 };
 
 
@@ -186,6 +219,17 @@ llvm_middle_end_prepare( struct draw_pt_middle_end *middle,
       *max_vertices = 4096;
    }
 
+   /* Chunks of 4096 vertices would leave the worker threads with ranges
+    * of a few hundred vertices, so let every thread have that many.  Not
+    * with a GS, whose output grows with the chunk and is indexed with 16
+    * bit elements too.
+    */
+   if (draw->pt.num_threads && !gs) {
+      *max_vertices = MAX2(*max_vertices,
+                           MIN2((draw->pt.num_threads + 1) * VERTICES_PER_THREAD,
+                                MAX_THREADED_VERTICES));
+   }
+
    /* Get the number of float[4] attributes per vertex.
     * Note: this must be done after draw_pt_emit_prepare() since that
     * can effect the vertex size.
@@ -317,6 +361,121 @@ llvm_middle_end_bind_parameters(struct draw_pt_middle_end *middle)
 }
 
 
+/**
+ * Fetch and shade count vertices starting at offset in the vertices
+ * to process, storing them at the same offset in verts.
+ * \return  TRUE if any vertex was clipped
+ */
+static boolean
+llvm_middle_end_shade_range(struct llvm_middle_end *fpme,
+                            struct vertex_header *verts,
+                            unsigned offset,
+                            unsigned count,
+                            unsigned start_or_maxelt,
+                            unsigned vid_base,
+                            const unsigned *elts)
+{
+   struct draw_context *draw = fpme->draw;
+
+   verts = (struct vertex_header *)
+      ((char *)verts + offset * fpme->vertex_size);
+
+   /* vertex ids follow from the fetch index, so ranges are independent */
+   if (elts)
+      elts += offset;
+   else
+      start_or_maxelt += offset;
+
+   return fpme->current_variant->jit_func(&fpme->llvm->jit_context,
+                                          verts,
+                                          draw->pt.user.vbuffer,
+                                          count,
+                                          start_or_maxelt,
+                                          fpme->vertex_size,
+                                          draw->pt.vertex_buffer,
+                                          draw->instance_id,
+                                          vid_base,
+                                          draw->start_instance,
+                                          elts);
+}
+
+
+static void
+llvm_vs_job_execute(void *data, int thread_index)
+{
+   struct llvm_vs_job *job = (struct llvm_vs_job *) data;
+
+   job->clipped = llvm_middle_end_shade_range(job->fpme, job->verts,
+                                              job->offset, job->count,
+                                              job->start_or_maxelt,
+                                              job->vid_base, job->elts);
+}
+
+
+/**
+ * Fetch and shade the vertices of a draw chunk.
+ *
+ * With DRAW_NUM_THREADS, large chunks are split into ranges which worker
+ * threads shade in parallel with this one.  Each range writes its own part
+ * of verts, so the output is in the same order as when shading serially
+ * and everything after the vertex shader runs unchanged.
+ * \return  TRUE if any vertex was clipped
+ */
+static boolean
+llvm_middle_end_shade(struct llvm_middle_end *fpme,
+                      struct vertex_header *verts,
+                      unsigned count,
+                      unsigned start_or_maxelt,
+                      unsigned vid_base,
+                      const unsigned *elts)
+{
+   struct draw_context *draw = fpme->draw;
+   unsigned num_ranges, range_size, offset, i;
+   boolean clipped;
+
+   num_ranges = MIN2(draw->pt.num_threads + 1,
+                     count / MIN_VERTICES_PER_THREAD);
+   if (num_ranges <= 1) {
+      return llvm_middle_end_shade_range(fpme, verts, 0, count,
+                                         start_or_maxelt, vid_base, elts);
+   }
+
+   /*
+    * The shader stores whole vectors of vertices, so ranges must start on
+    * a vector boundary not to clobber their neighbours.
+    */
+   range_size = align(DIV_ROUND_UP(count, num_ranges),
+                      lp_native_vector_width / 32);
+
+   for (i = 0, offset = range_size; offset < count; i++, offset += range_size) {
+      struct llvm_vs_job *job = &fpme->jobs[i];
+
+      job->fpme = fpme;
+      job->verts = verts;
+      job->offset = offset;
+      job->count = MIN2(range_size, count - offset);
+      job->start_or_maxelt = start_or_maxelt;
+      job->vid_base = vid_base;
+      job->elts = elts;
+      job->clipped = FALSE;
+
+      util_queue_add_job(&draw->pt.vs_queue, job, &job->fence,
+                         llvm_vs_job_execute, NULL);
+   }
+
+   /* the first range is done here */
+   clipped = llvm_middle_end_shade_range(fpme, verts, 0, range_size,
+                                         start_or_maxelt, vid_base, elts);
+
+   while (i--) {
+      util_queue_fence_wait(&fpme->jobs[i].fence);
+      clipped |= fpme->jobs[i].clipped;
+   }
+
+   return clipped;
+}
+
+
 static void
 pipeline(struct llvm_middle_end *llvm,
          const struct draw_vertex_info *vert_info,
@@ -397,17 +556,9 @@ llvm_pipeline_generic(struct draw_pt_middle_end *middle,
       vid_base = draw->pt.user.eltBias;
       elts = fetch_info->elts;
    }
-   clipped = fpme->current_variant->jit_func(&fpme->llvm->jit_context,
-                                             llvm_vert_info.verts,
-                                             draw->pt.user.vbuffer,
-                                             fetch_info->count,
-                                             start_or_maxelt,
-                                             fpme->vertex_size,
-                                             draw->pt.vertex_buffer,
-                                             draw->instance_id,
-                                             vid_base,
-                                             draw->start_instance,
-                                             elts);
+   clipped = llvm_middle_end_shade(fpme, llvm_vert_info.verts,
+                                   fetch_info->count, start_or_maxelt,
+                                   vid_base, elts);
 
    /* Finished with fetch and vs:
     */
@@ -597,6 +748,10 @@ static void
 llvm_middle_end_destroy(struct draw_pt_middle_end *middle)
 {
    struct llvm_middle_end *fpme = llvm_middle_end(middle);
+   unsigned i;
+
+   for (i = 0; i < ARRAY_SIZE(fpme->jobs); i++)
+      util_queue_fence_destroy(&fpme->jobs[i].fence);
 
    if (fpme->fetch)
       draw_pt_fetch_destroy( fpme->fetch );
@@ -618,6 +773,7 @@ struct draw_pt_middle_end *
 draw_pt_fetch_pipeline_or_emit_llvm(struct draw_context *draw)
 {
    struct llvm_middle_end *fpme = 0;
+   unsigned i;
 
    if (!draw->llvm)
       return NULL;
@@ -626,6 +782,9 @@ draw_pt_fetch_pipeline_or_emit_llvm(struct draw_context *draw)
    if (!fpme)
       goto fail;
 
+   for (i = 0; i < ARRAY_SIZE(fpme->jobs); i++)
+      util_queue_fence_init(&fpme->jobs[i].fence);
+
    fpme->base.prepare         = llvm_middle_end_prepare;
    fpme->base.bind_parameters = llvm_middle_end_bind_parameters;
    fpme->base.run             = llvm_middle_end_run;
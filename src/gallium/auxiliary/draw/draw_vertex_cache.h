@@ -0,0 +1,105 @@
+/**************************************************************************
+ * 
+ * Copyright 2018 VMware, Inc.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ **************************************************************************/
+
+/**
+ * Post-transform vertex cache.
+ *
+ * Maps fetch (vertex buffer) indices to draw (shaded vertex) indices
+ * within one segment of an indexed draw, so that every distinct vertex
+ * of the segment is only fetched and shaded once, no matter in which
+ * order the index stream references it.
+ *
+ * This is an open addressing hash table with linear probing.  Entries
+ * are tagged with the generation they were inserted in, so clearing the
+ * cache between segments is just a counter increment.
+ */
+
+#ifndef DRAW_VERTEX_CACHE_H
+#define DRAW_VERTEX_CACHE_H
+
+#include "pipe/p_compiler.h"
+
+
+/**
+ * Must be a power of two and at least twice the largest number of
+ * distinct vertices added between two clears, to keep probe sequences
+ * short.
+ */
+#define DRAW_VERTEX_CACHE_ORDER 11
+#define DRAW_VERTEX_CACHE_SIZE  (1 << DRAW_VERTEX_CACHE_ORDER)
+
+
+struct draw_vertex_cache {
+   unsigned generation;
+   unsigned generations[DRAW_VERTEX_CACHE_SIZE];
+   unsigned fetches[DRAW_VERTEX_CACHE_SIZE];
+   ushort draws[DRAW_VERTEX_CACHE_SIZE];
+};
+
+
+/**
+ * Forget all entries.  Must be called at least once before the cache is
+ * used, the cache itself may be zero-initialized memory.
+ */
+static inline void
+draw_vertex_cache_clear(struct draw_vertex_cache *cache)
+{
+   if (++cache->generation == 0) {
+      memset(cache->generations, 0, sizeof(cache->generations));
+      cache->generation = 1;
+   }
+}
+
+
+/**
+ * Look up a fetch index, inserting it with the given draw index if it is
+ * not present yet.
+ *
+ * \return the draw index the fetch index maps to; equal to \p draw iff
+ *         the fetch index was not in the cache.
+ */
+static inline ushort
+draw_vertex_cache_add(struct draw_vertex_cache *cache,
+                      unsigned fetch, ushort draw)
+{
+   /* Fibonacci hashing, spreads runs of consecutive indices evenly */
+   unsigned slot = (fetch * 2654435761u) >> (32 - DRAW_VERTEX_CACHE_ORDER);
+
+   while (cache->generations[slot] == cache->generation) {
+      if (cache->fetches[slot] == fetch)
+         return cache->draws[slot];
+      slot = (slot + 1) & (DRAW_VERTEX_CACHE_SIZE - 1);
+   }
+
+   cache->generations[slot] = cache->generation;
+   cache->fetches[slot] = fetch;
+   cache->draws[slot] = draw;
+
+   return draw;
+}
+
+
+#endif /* DRAW_VERTEX_CACHE_H */
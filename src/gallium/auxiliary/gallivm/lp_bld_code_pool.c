@@ -0,0 +1,415 @@
+/**************************************************************************
+ * 
+ * Copyright 2018 VMware, Inc.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ **************************************************************************/
+
+/**
+ * @file
+ * Process-wide pool of executable memory for JIT compiled code.
+ *
+ * The free list is managed with u_mm, just like rtasm's executable heap.
+ * The pool's address range is reserved without any access rights and each
+ * chunk is made readable, writable and executable the first time an
+ * allocation reaches it.  Code and data of a module share pages with those
+ * of other modules, so the W^X dance of LLVM's SectionMemoryManager is not
+ * possible here; if the system refuses such mappings the pool disables
+ * itself and LLVM's own memory manager is used instead.
+ */
+
+
+#include "pipe/p_config.h"
+#include "util/u_debug.h"
+#include "util/u_math.h"
+#include "util/u_memory.h"
+#include "os/os_thread.h"
+
+#include "lp_bld_code_pool.h"
+
+
+#if defined(PIPE_OS_UNIX)
+
+#include <sys/mman.h>
+#include "util/u_mm.h"
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+#define CODE_POOL_PROT (PROT_READ | PROT_WRITE | PROT_EXEC)
+
+/** Smallest allocation granularity, as log2 */
+#define CODE_POOL_MIN_ALIGN2 4
+
+
+DEBUG_GET_ONCE_BOOL_OPTION(code_pool, "GALLIVM_CODE_POOL", TRUE)
+DEBUG_GET_ONCE_BOOL_OPTION(huge_pages, "GALLIVM_HUGE_PAGES", FALSE)
+
+
+static mtx_t pool_mutex = _MTX_INITIALIZER_NP;
+
+static struct
+{
+   boolean initialized;
+   boolean huge_pages;
+
+   uint8_t *base;
+   size_t size;
+   struct mem_block *heap;
+
+   /** Chunks below this one have been made accessible */
+   unsigned num_committed;
+   /** Per chunk, number of live allocations overlapping it */
+   unsigned *chunk_users;
+   /** Per chunk, whether it may still hold pages */
+   boolean *chunk_resident;
+   unsigned num_resident;
+
+   size_t used;
+   size_t peak_used;
+   unsigned num_allocs;
+   unsigned total_allocs;
+   unsigned total_frees;
+   unsigned released_chunks;
+} pool;
+
+
+/**
+ * Make a chunk of the reserved range accessible.
+ */
+static boolean
+code_pool_commit(unsigned chunk)
+{
+   uint8_t *addr = pool.base + (size_t)chunk * LP_CODE_POOL_CHUNK_SIZE;
+
+#ifdef MAP_HUGETLB
+   /*
+    * Explicit huge pages only work if the administrator set some aside.
+    * A failed MAP_FIXED mapping may leave a hole behind, which the mmap
+    * below fills again.
+    */
+   if (pool.huge_pages &&
+       mmap(addr, LP_CODE_POOL_CHUNK_SIZE, CODE_POOL_PROT,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED | MAP_HUGETLB,
+            -1, 0) == addr) {
+      return TRUE;
+   }
+#endif
+
+   if (mprotect(addr, LP_CODE_POOL_CHUNK_SIZE, CODE_POOL_PROT) != 0 &&
+       mmap(addr, LP_CODE_POOL_CHUNK_SIZE, CODE_POOL_PROT,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != addr) {
+      return FALSE;
+   }
+
+#ifdef MADV_HUGEPAGE
+   /* Otherwise ask for transparent huge pages. */
+   if (pool.huge_pages)
+      madvise(addr, LP_CODE_POOL_CHUNK_SIZE, MADV_HUGEPAGE);
+#endif
+
+   return TRUE;
+}
+
+
+/**
+ * Return the pages of a chunk without live allocations to the OS.
+ * The chunk stays accessible and reads back as zeros when reused.
+ */
+static void
+code_pool_release(unsigned chunk)
+{
+   uint8_t *addr = pool.base + (size_t)chunk * LP_CODE_POOL_CHUNK_SIZE;
+
+   madvise(addr, LP_CODE_POOL_CHUNK_SIZE, MADV_DONTNEED);
+   pool.chunk_resident[chunk] = FALSE;
+   pool.num_resident--;
+   pool.released_chunks++;
+}
+
+
+/**
+ * Reserve the pool address range.  Called with the mutex held.
+ * \return  TRUE if the pool can be used
+ */
+static boolean
+code_pool_init(void)
+{
+   const size_t chunk_size = LP_CODE_POOL_CHUNK_SIZE;
+   /* Keep all code within reach of 32-bit relative addressing. */
+   size_t size = sizeof(void *) == 8 ? 256 * 1024 * 1024 : 32 * 1024 * 1024;
+   unsigned num_chunks = size / chunk_size;
+   uint8_t *map, *base;
+
+   if (pool.initialized)
+      return pool.heap != NULL;
+
+   pool.initialized = TRUE;
+
+   if (!debug_get_option_code_pool())
+      return FALSE;
+
+   pool.huge_pages = debug_get_option_huge_pages();
+
+   /*
+    * Reserve one extra chunk so that the range can be aligned to the huge
+    * page size, then give back what sticks out on either side.
+    */
+   map = mmap(NULL, size + chunk_size, PROT_NONE,
+              MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+   if (map == MAP_FAILED)
+      return FALSE;
+
+   base = (uint8_t *)(((uintptr_t)map + chunk_size - 1) &
+                      ~(uintptr_t)(chunk_size - 1));
+   if (base != map)
+      munmap(map, base - map);
+   munmap(base + size, map + chunk_size - base);
+
+   pool.base = base;
+   pool.size = size;
+   pool.heap = u_mmInit(0, (int)size);
+   pool.chunk_users = CALLOC(num_chunks, sizeof *pool.chunk_users);
+   pool.chunk_resident = CALLOC(num_chunks, sizeof *pool.chunk_resident);
+
+   /* Find out now whether executable and writable mappings are allowed. */
+   if (!pool.heap || !pool.chunk_users || !pool.chunk_resident ||
+       !code_pool_commit(0)) {
+      debug_printf("gallivm: could not set up the JIT code pool\n");
+      if (pool.heap)
+         u_mmDestroy(pool.heap);
+      FREE(pool.chunk_users);
+      FREE(pool.chunk_resident);
+      munmap(base, size);
+      memset(&pool, 0, sizeof pool);
+      pool.initialized = TRUE;
+      return FALSE;
+   }
+
+   pool.num_committed = 1;
+   return TRUE;
+}
+
+
+boolean
+lp_code_pool_enabled(void)
+{
+   boolean enabled;
+
+   mtx_lock(&pool_mutex);
+   enabled = code_pool_init();
+   mtx_unlock(&pool_mutex);
+
+   return enabled;
+}
+
+
+/**
+ * Allocate memory for code or data from the pool.
+ * \return  NULL if the pool is disabled or full
+ */
+void *
+lp_code_pool_alloc(size_t size, unsigned alignment)
+{
+   struct mem_block *block;
+   unsigned first, last, i;
+   int align2;
+   void *ptr = NULL;
+
+   align2 = util_logbase2(MAX2(alignment, 1));
+   align2 = MAX2(align2, CODE_POOL_MIN_ALIGN2);
+   size = (size + (1 << CODE_POOL_MIN_ALIGN2) - 1) &
+          ~(size_t)((1 << CODE_POOL_MIN_ALIGN2) - 1);
+
+   mtx_lock(&pool_mutex);
+
+   if (!code_pool_init() || size == 0 || size > pool.size)
+      goto out;
+
+   block = u_mmAllocMem(pool.heap, (int)size, align2, 0);
+   if (!block)
+      goto out;
+
+   first = block->ofs / LP_CODE_POOL_CHUNK_SIZE;
+   last = (block->ofs + block->size - 1) / LP_CODE_POOL_CHUNK_SIZE;
+
+   while (pool.num_committed <= last) {
+      if (!code_pool_commit(pool.num_committed)) {
+         u_mmFreeMem(block);
+         goto out;
+      }
+      pool.num_committed++;
+   }
+
+   for (i = first; i <= last; i++) {
+      pool.chunk_users[i]++;
+      if (!pool.chunk_resident[i]) {
+         pool.chunk_resident[i] = TRUE;
+         pool.num_resident++;
+      }
+   }
+
+   pool.used += block->size;
+   pool.peak_used = MAX2(pool.peak_used, pool.used);
+   pool.num_allocs++;
+   pool.total_allocs++;
+
+   ptr = pool.base + block->ofs;
+
+out:
+   mtx_unlock(&pool_mutex);
+   return ptr;
+}
+
+
+void
+lp_code_pool_free(void *ptr)
+{
+   struct mem_block *block;
+   unsigned first, last, i;
+
+   if (!ptr)
+      return;
+
+   mtx_lock(&pool_mutex);
+
+   assert(pool.heap);
+   assert((uint8_t *)ptr >= pool.base &&
+          (uint8_t *)ptr < pool.base + pool.size);
+
+   block = u_mmFindBlock(pool.heap, (int)((uint8_t *)ptr - pool.base));
+   assert(block);
+   if (block) {
+      first = block->ofs / LP_CODE_POOL_CHUNK_SIZE;
+      last = (block->ofs + block->size - 1) / LP_CODE_POOL_CHUNK_SIZE;
+
+      pool.used -= block->size;
+      pool.num_allocs--;
+      pool.total_frees++;
+
+      /* Coalesces with free neighbours. */
+      u_mmFreeMem(block);
+
+      for (i = first; i <= last; i++) {
+         assert(pool.chunk_users[i]);
+         /* Keep one chunk around, to avoid churn with a single variant. */
+         if (--pool.chunk_users[i] == 0 && pool.num_resident > 1)
+            code_pool_release(i);
+      }
+   }
+
+   mtx_unlock(&pool_mutex);
+}
+
+
+void
+lp_code_pool_get_stats(struct lp_code_pool_stats *stats)
+{
+   const struct mem_block *p;
+
+   memset(stats, 0, sizeof *stats);
+
+   mtx_lock(&pool_mutex);
+
+   if (pool.heap) {
+      stats->reserved = pool.size;
+      stats->committed = (size_t)pool.num_committed * LP_CODE_POOL_CHUNK_SIZE;
+      stats->resident = (size_t)pool.num_resident * LP_CODE_POOL_CHUNK_SIZE;
+      stats->used = pool.used;
+      stats->peak_used = pool.peak_used;
+      stats->num_allocs = pool.num_allocs;
+      stats->total_allocs = pool.total_allocs;
+      stats->total_frees = pool.total_frees;
+      stats->released_chunks = pool.released_chunks;
+      stats->huge_pages = pool.huge_pages;
+
+      for (p = pool.heap->next_free; p != pool.heap; p = p->next_free) {
+         stats->num_free_blocks++;
+         stats->largest_free = MAX2(stats->largest_free, (size_t)p->size);
+      }
+   }
+
+   mtx_unlock(&pool_mutex);
+}
+
+
+#else /* !PIPE_OS_UNIX */
+
+
+boolean
+lp_code_pool_enabled(void)
+{
+   return FALSE;
+}
+
+
+void *
+lp_code_pool_alloc(size_t size, unsigned alignment)
+{
+   return NULL;
+}
+
+
+void
+lp_code_pool_free(void *ptr)
+{
+   assert(!ptr);
+}
+
+
+void
+lp_code_pool_get_stats(struct lp_code_pool_stats *stats)
+{
+   memset(stats, 0, sizeof *stats);
+}
+
+
+#endif /* !PIPE_OS_UNIX */
+
+
+void
+lp_code_pool_print_stats(void)
+{
+   struct lp_code_pool_stats stats;
+
+   lp_code_pool_get_stats(&stats);
+   if (!stats.reserved)
+      return;
+
+   debug_printf("gallivm: code pool: %u allocs, %u KB used (peak %u KB), "
+                "%u KB resident, %u KB committed, %u free blocks "
+                "(largest %u KB), %u chunks released%s\n",
+                stats.num_allocs,
+                (unsigned)(stats.used / 1024),
+                (unsigned)(stats.peak_used / 1024),
+                (unsigned)(stats.resident / 1024),
+                (unsigned)(stats.committed / 1024),
+                stats.num_free_blocks,
+                (unsigned)(stats.largest_free / 1024),
+                stats.released_chunks,
+                stats.huge_pages ? ", huge pages" : "");
+}
@@ -0,0 +1,99 @@
+/**************************************************************************
+ * 
+ * Copyright 2018 VMware, Inc.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ **************************************************************************/
+
+/**
+ * @file
+ * Process-wide pool of executable memory for JIT compiled code.
+ *
+ * All gallivm modules place their code and data in one virtual address
+ * range, reserved up front and made accessible in 2MB chunks as it fills up,
+ * instead of each module getting its own pages from LLVM.  This keeps the
+ * code of many small shader variants packed together, which is kinder to
+ * the iTLB, and the chunks can optionally be backed by huge pages.
+ *
+ * Freed blocks are coalesced and reused by later allocations.  Chunks that
+ * no longer hold any live allocation are given back to the OS, although
+ * their address range stays reserved.
+ */
+
+
+#ifndef LP_BLD_CODE_POOL_H
+#define LP_BLD_CODE_POOL_H
+
+
+#include "pipe/p_compiler.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Size and granularity in which the pool address range is made accessible.
+ */
+#define LP_CODE_POOL_CHUNK_SIZE (2 * 1024 * 1024)
+
+
+struct lp_code_pool_stats
+{
+   size_t reserved;       /**< size of the pool address range */
+   size_t committed;      /**< bytes made accessible so far */
+   size_t resident;       /**< bytes in chunks holding live allocations */
+   size_t used;           /**< bytes in live allocations */
+   size_t peak_used;      /**< high-water mark of used */
+   size_t largest_free;   /**< largest free block */
+   unsigned num_allocs;   /**< number of live allocations */
+   unsigned num_free_blocks;
+   unsigned total_allocs; /**< allocations made since the pool was created */
+   unsigned total_frees;
+   unsigned released_chunks; /**< times a chunk was returned to the OS */
+   boolean huge_pages;
+};
+
+
+boolean
+lp_code_pool_enabled(void);
+
+void *
+lp_code_pool_alloc(size_t size, unsigned alignment);
+
+void
+lp_code_pool_free(void *ptr);
+
+void
+lp_code_pool_get_stats(struct lp_code_pool_stats *stats);
+
+void
+lp_code_pool_print_stats(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+
+#endif /* LP_BLD_CODE_POOL_H */
@@ -46,6 +46,8 @@
 #define GALLIVM_DEBUG_NO_QUAD_LOD   (1 << 7)
 #define GALLIVM_DEBUG_GC            (1 << 8)
 #define GALLIVM_DEBUG_DUMP_BC       (1 << 9)
+#define GALLIVM_DEBUG_CODE_POOL     (1 << 10)
+#define GALLIVM_DEBUG_NO_FAST_SAMPLE (1 << 11)
 
 
 #ifdef __cplusplus
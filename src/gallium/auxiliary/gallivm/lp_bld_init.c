@@ -34,6 +34,7 @@
 #include "util/simple_list.h"
 #include "util/os_time.h"
 #include "lp_bld.h"
+#include "lp_bld_code_pool.h"
 #include "lp_bld_debug.h"
 #include "lp_bld_misc.h"
 #include "lp_bld_init.h"
@@ -71,6 +72,8 @@ static const struct debug_named_value lp_bld_debug_flags[] = {
    { "no_quad_lod", GALLIVM_DEBUG_NO_QUAD_LOD, NULL },
    { "gc",     GALLIVM_DEBUG_GC, NULL },
    { "dumpbc", GALLIVM_DEBUG_DUMP_BC, NULL },
+   { "codepool", GALLIVM_DEBUG_CODE_POOL, NULL },
+   { "no_fast_sample", GALLIVM_DEBUG_NO_FAST_SAMPLE, NULL },
    DEBUG_NAMED_VALUE_END
 };
 
@@ -101,8 +104,9 @@ enum LLVM_CodeGenOpt_Level {
 
 
 /**
- * Create the LLVM (optimization) pass manager and install
- * relevant optimization passes.
+ * Create the LLVM (optimization) pass manager.
+ * The passes are installed by add_optimization_passes() at compile time,
+ * once it is known whether the module is to be optimized.
  * \return  TRUE for success, FALSE for failure
  */
 static boolean
@@ -133,7 +137,18 @@ create_pass_manager(struct gallivm_state *gallivm)
       free(td_str);
    }
 
-   if ((gallivm_debug & GALLIVM_DEBUG_NO_OPT) == 0) {
+   return TRUE;
+}
+
+
+/**
+ * Install the optimization passes, or only the bare minimum if
+ * optimization was disabled globally or for this module.
+ */
+static void
+add_optimization_passes(struct gallivm_state *gallivm)
+{
+   if ((gallivm_debug & GALLIVM_DEBUG_NO_OPT) == 0 && !gallivm->no_opt) {
       /* These are the passes currently listed in llvm-c/Transforms/Scalar.h,
        * but there are more on SVN.
        * TODO: Add more passes.
@@ -153,8 +168,6 @@ create_pass_manager(struct gallivm_state *gallivm)
        */
       LLVMAddPromoteMemoryToRegisterPass(gallivm->passmgr);
    }
-
-   return TRUE;
 }
 
 
@@ -176,6 +189,13 @@ gallivm_free_ir(struct gallivm_state *gallivm)
       LLVMDisposeModule(gallivm->module);
    }
 
+   /* The cache is only needed while compiling, forget about it now */
+   if (gallivm->cache) {
+      lp_free_objcache(gallivm->cache->jit_obj_cache);
+      gallivm->cache->jit_obj_cache = NULL;
+      gallivm->cache = NULL;
+   }
+
    FREE(gallivm->module_name);
 
    if (!use_mcjit) {
@@ -213,6 +233,9 @@ gallivm_free_code(struct gallivm_state *gallivm)
    gallivm->code = NULL;
    lp_free_memory_manager(gallivm->memorymgr);
    gallivm->memorymgr = NULL;
+
+   if (gallivm_debug & GALLIVM_DEBUG_CODE_POOL)
+      lp_code_pool_print_stats();
 }
 
 
@@ -224,7 +247,7 @@ init_gallivm_engine(struct gallivm_state *gallivm)
       char *error = NULL;
       int ret;
 
-      if (gallivm_debug & GALLIVM_DEBUG_NO_OPT) {
+      if ((gallivm_debug & GALLIVM_DEBUG_NO_OPT) || gallivm->no_opt) {
          optlevel = None;
       }
       else {
@@ -233,6 +256,7 @@ init_gallivm_engine(struct gallivm_state *gallivm)
 
       ret = lp_build_create_jit_compiler_for_module(&gallivm->engine,
                                                     &gallivm->code,
+                                                    gallivm->cache,
                                                     gallivm->module,
                                                     gallivm->memorymgr,
                                                     (unsigned) optlevel,
@@ -285,7 +309,7 @@ fail:
  */
 static boolean
 init_gallivm_state(struct gallivm_state *gallivm, const char *name,
-                   LLVMContextRef context)
+                   LLVMContextRef context, struct lp_cached_code *cache)
 {
    assert(!gallivm->context);
    assert(!gallivm->module);
@@ -294,6 +318,7 @@ init_gallivm_state(struct gallivm_state *gallivm, const char *name,
       return FALSE;
 
    gallivm->context = context;
+   gallivm->cache = cache;
 
    if (!gallivm->context)
       goto fail;
@@ -420,6 +445,10 @@ lp_build_init(void)
       util_cpu_caps.has_avx2 = 0;
       util_cpu_caps.has_f16c = 0;
       util_cpu_caps.has_fma = 0;
+      util_cpu_caps.has_avx512f = 0;
+      util_cpu_caps.has_avx512bw = 0;
+      util_cpu_caps.has_avx512dq = 0;
+      util_cpu_caps.has_avx512vl = 0;
    }
 #endif
 
@@ -430,8 +459,20 @@ lp_build_init(void)
     * See also:
     * - http://www.anandtech.com/show/4955/the-bulldozer-review-amd-fx8150-tested/2
     */
-   if (util_cpu_caps.has_avx &&
-       util_cpu_caps.has_intel) {
+   if (util_cpu_caps.has_avx512f &&
+       util_cpu_caps.has_avx512bw &&
+       util_cpu_caps.has_avx512dq &&
+       util_cpu_caps.has_avx512vl &&
+       util_cpu_caps.has_intel &&
+       HAVE_LLVM >= 0x0400) {
+      /* Skylake-SP and later.  We need BW/DQ/VL so that the 8/16 bit and
+       * 64 bit integer ops and the narrower vectors we split into on the
+       * way to memory have native encodings too.  LLVM 4.0 is the first
+       * version picking up the AVX-512 features from the host CPU.
+       */
+      lp_native_vector_width = 512;
+   } else if (util_cpu_caps.has_avx &&
+              util_cpu_caps.has_intel) {
       lp_native_vector_width = 256;
    } else {
       /* Leave it at 128, even when no SIMD extensions are available.
@@ -456,6 +497,15 @@ lp_build_init(void)
       util_cpu_caps.has_f16c = 0;
       util_cpu_caps.has_fma = 0;
    }
+   if (lp_native_vector_width <= 256) {
+      /* Likewise for AVX-512, so that LP_NATIVE_VECTOR_WIDTH=256 gives the
+       * plain AVX2 code paths, in gallivm and in the llvmpipe rasterizer.
+       */
+      util_cpu_caps.has_avx512f = 0;
+      util_cpu_caps.has_avx512bw = 0;
+      util_cpu_caps.has_avx512dq = 0;
+      util_cpu_caps.has_avx512vl = 0;
+   }
    if (HAVE_LLVM < 0x0304 || !use_mcjit) {
       /* AVX2 support has only been tested with LLVM 3.4, and it requires
        * MCJIT. */
@@ -493,15 +543,18 @@ lp_build_init(void)
 
 /**
  * Create a new gallivm_state object.
+ * \param cache  optional cached machine code for the module, see
+ *               struct lp_cached_code
  */
 struct gallivm_state *
-gallivm_create(const char *name, LLVMContextRef context)
+gallivm_create(const char *name, LLVMContextRef context,
+               struct lp_cached_code *cache)
 {
    struct gallivm_state *gallivm;
 
    gallivm = CALLOC_STRUCT(gallivm_state);
    if (gallivm) {
-      if (!init_gallivm_state(gallivm, name, context)) {
+      if (!init_gallivm_state(gallivm, name, context, cache)) {
          FREE(gallivm);
          gallivm = NULL;
       }
@@ -565,10 +618,17 @@ gallivm_compile_module(struct gallivm_state *gallivm)
       gallivm->builder = NULL;
    }
 
+   /* The machine code was found in the cache, so there is no point in
+    * optimizing the IR: the engine will load the object instead.
+    */
+   if (gallivm->cache && gallivm->cache->data_size)
+      goto skip_cached;
+
    if (gallivm_debug & GALLIVM_DEBUG_PERF)
       time_begin = os_time_get();
 
    /* Run optimization passes */
+   add_optimization_passes(gallivm);
    LLVMInitializeFunctionPassManager(gallivm->passmgr);
    func = LLVMGetFirstFunction(gallivm->module);
    while (func) {
@@ -611,6 +671,7 @@ gallivm_compile_module(struct gallivm_state *gallivm)
                    filename);
    }
 
+skip_cached:
    if (use_mcjit) {
       /* Setting the module's DataLayout to an empty string will cause the
        * ExecutionEngine to copy to the DataLayout string from its target
@@ -39,6 +39,23 @@
 extern "C" {
 #endif
 
+/**
+ * Machine code of a module, as a relocatable object file.
+ *
+ * If data_size is non-zero when the module is compiled, the object is
+ * loaded from data instead of optimizing and compiling the IR.  Otherwise
+ * the compiled object is stored into data (malloc'ed, to be freed by the
+ * caller), so that it can be put in a persistent cache.
+ */
+struct lp_cached_code {
+   void *data;
+   size_t data_size;
+   /** Set if the code embeds process specific addresses */
+   boolean dont_cache;
+   void *jit_obj_cache;
+};
+
+
 struct gallivm_state
 {
    char *module_name;
@@ -50,7 +67,13 @@ struct gallivm_state
    LLVMBuilderRef builder;
    LLVMMCJITMemoryManagerRef memorymgr;
    struct lp_generated_code *code;
+   struct lp_cached_code *cache;
    unsigned compiled;
+   /**
+    * Skip the IR optimizations and use the fastest code generator, for code
+    * which is needed quickly rather than run often.  Set before compiling.
+    */
+   boolean no_opt;
 };
 
 
@@ -59,7 +82,8 @@ lp_build_init(void);
 
 
 struct gallivm_state *
-gallivm_create(const char *name, LLVMContextRef context);
+gallivm_create(const char *name, LLVMContextRef context,
+               struct lp_cached_code *cache);
 
 void
 gallivm_destroy(struct gallivm_state *gallivm);
@@ -55,6 +55,11 @@
 
 #define LP_MAX_TGSI_CONST_BUFFER_SIZE (LP_MAX_TGSI_CONSTS * sizeof(float[4]))
 
+#define LP_MAX_TGSI_SHADER_BUFFERS 16
+
+/** Largest tessellation patch, GL_MAX_PATCH_VERTICES */
+#define LP_MAX_TESS_PATCH_VERTICES 32
+
 /*
  * For quick access we cache registers in statically
  * allocated arrays. Here we define the maximum size
@@ -66,6 +66,10 @@
 #else
 #include <llvm/ExecutionEngine/SectionMemoryManager.h>
 #endif
+#if HAVE_LLVM >= 0x0306
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/Support/MemoryBuffer.h>
+#endif
 #include <llvm/Support/CommandLine.h>
 #include <llvm/Support/Host.h>
 #include <llvm/Support/PrettyStackTrace.h>
@@ -94,9 +98,12 @@
 #include "pipe/p_config.h"
 #include "util/u_debug.h"
 #include "util/u_cpu_detect.h"
+#include "util/u_string.h"
 
 #include "lp_bld_misc.h"
+#include "lp_bld_code_pool.h"
 #include "lp_bld_debug.h"
+#include "lp_bld_init.h"
 
 namespace {
 
@@ -354,6 +361,29 @@ class DelegatingJITMemoryManager : public BaseMemoryManager {
 #endif
                                            IsReadOnly);
       }
+#if HAVE_LLVM >= 0x0306
+      virtual bool needsToReserveAllocationSpace() override {
+         return mgr()->needsToReserveAllocationSpace();
+      }
+#if HAVE_LLVM >= 0x0308
+      virtual void reserveAllocationSpace(uintptr_t CodeSize,
+                                          uint32_t CodeAlign,
+                                          uintptr_t RODataSize,
+                                          uint32_t RODataAlign,
+                                          uintptr_t RWDataSize,
+                                          uint32_t RWDataAlign) override {
+         mgr()->reserveAllocationSpace(CodeSize, CodeAlign,
+                                       RODataSize, RODataAlign,
+                                       RWDataSize, RWDataAlign);
+      }
+#else
+      virtual void reserveAllocationSpace(uintptr_t CodeSize,
+                                          uintptr_t DataSizeRO,
+                                          uintptr_t DataSizeRW) override {
+         mgr()->reserveAllocationSpace(CodeSize, DataSizeRO, DataSizeRW);
+      }
+#endif
+#endif
 #if HAVE_LLVM >= 0x0304
       virtual void registerEHFrames(uint8_t *Addr, uint64_t LoadAddr, size_t Size) {
          mgr()->registerEHFrames(Addr, LoadAddr, Size);
@@ -407,9 +437,11 @@ class ShaderMemoryManager : public DelegatingJITMemoryManager {
       typedef std::vector<void *> Vec;
       Vec FunctionBody, ExceptionTable;
       BaseMemoryManager *TheMM;
+      size_t Size;
 
       GeneratedCode(BaseMemoryManager *MM) {
          TheMM = MM;
+         Size = 0;
       }
 
       ~GeneratedCode() {
@@ -459,6 +491,60 @@ class ShaderMemoryManager : public DelegatingJITMemoryManager {
          delete (GeneratedCode *) code;
       }
 
+      static size_t getGeneratedCodeSize(const struct lp_generated_code *code) {
+         return ((const GeneratedCode *) code)->Size;
+      }
+
+      /*
+       * Account for the memory taken by the code and its data.
+       */
+#if HAVE_LLVM < 0x0306
+      virtual void endFunctionBody(const llvm::Function *F,
+                                   uint8_t *FunctionStart,
+                                   uint8_t *FunctionEnd) {
+         code->Size += FunctionEnd - FunctionStart;
+         DelegatingJITMemoryManager::endFunctionBody(F, FunctionStart,
+                                                     FunctionEnd);
+      }
+#endif
+#if HAVE_LLVM >= 0x0304
+      virtual uint8_t *allocateCodeSection(uintptr_t Size,
+                                           unsigned Alignment,
+                                           unsigned SectionID,
+                                           llvm::StringRef SectionName) {
+         code->Size += Size;
+         return DelegatingJITMemoryManager::allocateCodeSection(Size,
+                                                                Alignment,
+                                                                SectionID,
+                                                                SectionName);
+      }
+#else
+      virtual uint8_t *allocateCodeSection(uintptr_t Size,
+                                           unsigned Alignment,
+                                           unsigned SectionID) {
+         code->Size += Size;
+         return DelegatingJITMemoryManager::allocateCodeSection(Size,
+                                                                Alignment,
+                                                                SectionID);
+      }
+#endif
+      virtual uint8_t *allocateDataSection(uintptr_t Size,
+                                           unsigned Alignment,
+                                           unsigned SectionID,
+#if HAVE_LLVM >= 0x0304
+                                           llvm::StringRef SectionName,
+#endif
+                                           bool IsReadOnly) {
+         code->Size += Size;
+         return DelegatingJITMemoryManager::allocateDataSection(Size,
+                                                                Alignment,
+                                                                SectionID,
+#if HAVE_LLVM >= 0x0304
+                                                                SectionName,
+#endif
+                                                                IsReadOnly);
+      }
+
 #if HAVE_LLVM < 0x0304
       virtual void deallocateExceptionTable(void *ET) {
          // remember for later deallocation
@@ -473,10 +559,236 @@ class ShaderMemoryManager : public DelegatingJITMemoryManager {
 };
 
 
+#if HAVE_LLVM >= 0x0306
+/*
+ * Memory manager placing code and data in the process-wide code pool.
+ *
+ * MCJIT tells us the total size of a module's sections before allocating
+ * them, so they are all carved out of a single pool block and each module
+ * stays contiguous.  The blocks go back to the pool when the manager is
+ * deleted, that is when gallivm_destroy() frees the code.  If the pool is
+ * full, a private SectionMemoryManager is used for the whole module:
+ * sections are never split between the two, as relocations between them
+ * could be out of range.
+ */
+class CodePoolMemoryManager : public llvm::RTDyldMemoryManager {
+
+   struct Section {
+      uint8_t *Addr;
+      uintptr_t Size;
+   };
+
+   /* Part of the reserved block set aside for one kind of section. */
+   struct Area {
+      uint8_t *Cur;
+      uintptr_t Left;
+   };
+
+   std::vector<void *> Blocks;
+   std::vector<Section> CodeSections;
+   Area Code, ROData, RWData;
+   llvm::SectionMemoryManager *Fallback;
+
+   /*
+    * The sizes MCJIT reports include the padding between sections, but
+    * assume each area starts at the largest alignment of its sections.
+    */
+   static uintptr_t areaSize(uintptr_t Size, unsigned Alignment) {
+      return Size ? Size + Alignment : 0;
+   }
+
+   static void setArea(Area &A, uint8_t *Start, uintptr_t Size) {
+      A.Cur = Start;
+      A.Left = Size;
+   }
+
+   void reserve(uintptr_t CodeSize, uintptr_t RODataSize,
+                uintptr_t RWDataSize) {
+      uint8_t *Block;
+
+      if (Fallback)
+         return;
+
+      Block = (uint8_t *)lp_code_pool_alloc(CodeSize + RODataSize +
+                                            RWDataSize, 64);
+      if (!Block) {
+         Fallback = new llvm::SectionMemoryManager();
+         return;
+      }
+
+      Blocks.push_back(Block);
+      setArea(Code, Block, CodeSize);
+      setArea(ROData, Block + CodeSize, RODataSize);
+      setArea(RWData, Block + CodeSize + RODataSize, RWDataSize);
+   }
+
+   uint8_t *allocate(Area &A, uintptr_t Size, unsigned Alignment) {
+      uintptr_t Pad;
+      uint8_t *Addr;
+
+      Alignment = Alignment ? Alignment : 16;
+      Pad = -(uintptr_t)A.Cur & (Alignment - 1);
+      if (!A.Cur || Pad + Size > A.Left) {
+         /* The reservation was too small.  Stay in the pool, so the
+          * module's sections remain within reach of each other.
+          */
+         if (gallivm_debug & GALLIVM_DEBUG_PERF) {
+            debug_printf("%s: section of %lu bytes outside of the reserved "
+                         "block\n", __FUNCTION__, (unsigned long)Size);
+         }
+         Addr = (uint8_t *)lp_code_pool_alloc(Size, Alignment);
+         if (Addr)
+            Blocks.push_back(Addr);
+         return Addr;
+      }
+
+      Addr = A.Cur + Pad;
+      A.Cur = Addr + Size;
+      A.Left -= Pad + Size;
+      return Addr;
+   }
+
+   public:
+
+      CodePoolMemoryManager() : Fallback(NULL) {
+         setArea(Code, NULL, 0);
+         setArea(ROData, NULL, 0);
+         setArea(RWData, NULL, 0);
+      }
+
+      virtual ~CodePoolMemoryManager() {
+         std::vector<void *>::iterator i;
+
+         for (i = Blocks.begin(); i != Blocks.end(); ++i)
+            lp_code_pool_free(*i);
+         delete Fallback;
+      }
+
+      virtual bool needsToReserveAllocationSpace() override {
+         return true;
+      }
+
+#if HAVE_LLVM >= 0x0308
+      virtual void reserveAllocationSpace(uintptr_t CodeSize,
+                                          uint32_t CodeAlign,
+                                          uintptr_t RODataSize,
+                                          uint32_t RODataAlign,
+                                          uintptr_t RWDataSize,
+                                          uint32_t RWDataAlign) override {
+         reserve(areaSize(CodeSize, CodeAlign),
+                 areaSize(RODataSize, RODataAlign),
+                 areaSize(RWDataSize, RWDataAlign));
+      }
+#else
+      virtual void reserveAllocationSpace(uintptr_t CodeSize,
+                                          uintptr_t DataSizeRO,
+                                          uintptr_t DataSizeRW) override {
+         /* The alignments aren't passed in, assume no section needs more
+          * than a cache line.
+          */
+         reserve(areaSize(CodeSize, 64),
+                 areaSize(DataSizeRO, 64),
+                 areaSize(DataSizeRW, 64));
+      }
+#endif
+
+      virtual uint8_t *allocateCodeSection(uintptr_t Size,
+                                           unsigned Alignment,
+                                           unsigned SectionID,
+                                           llvm::StringRef SectionName) override {
+         if (Fallback)
+            return Fallback->allocateCodeSection(Size, Alignment,
+                                                 SectionID, SectionName);
+
+         uint8_t *Addr = allocate(Code, Size, Alignment);
+         if (Addr) {
+            Section S = { Addr, Size };
+            CodeSections.push_back(S);
+         }
+         return Addr;
+      }
+
+      virtual uint8_t *allocateDataSection(uintptr_t Size,
+                                           unsigned Alignment,
+                                           unsigned SectionID,
+                                           llvm::StringRef SectionName,
+                                           bool IsReadOnly) override {
+         if (Fallback)
+            return Fallback->allocateDataSection(Size, Alignment,
+                                                 SectionID, SectionName,
+                                                 IsReadOnly);
+
+         return allocate(IsReadOnly ? ROData : RWData, Size, Alignment);
+      }
+
+      virtual bool finalizeMemory(std::string *ErrMsg = 0) override {
+         std::vector<Section>::iterator i;
+
+         if (Fallback)
+            return Fallback->finalizeMemory(ErrMsg);
+
+         /* Pool memory is always executable, just flush the icache. */
+         for (i = CodeSections.begin(); i != CodeSections.end(); ++i)
+            llvm::sys::Memory::InvalidateInstructionCache(i->Addr, i->Size);
+         CodeSections.clear();
+         return false;
+      }
+};
+#endif
+
+
+#if HAVE_LLVM >= 0x0306
+/*
+ * MCJIT object cache backed by a struct lp_cached_code.
+ *
+ * If the lp_cached_code already holds an object file it is handed to MCJIT
+ * instead of compiling the module, otherwise the freshly compiled object is
+ * copied into it, so that the caller can store it in a persistent cache.
+ */
+class LPObjectCache : public llvm::ObjectCache {
+   struct lp_cached_code *cache_out;
+   bool has_object;
+
+   public:
+      LPObjectCache(struct lp_cached_code *cache) {
+         cache_out = cache;
+         has_object = false;
+      }
+
+      virtual ~LPObjectCache() {
+      }
+
+      virtual void notifyObjectCompiled(const llvm::Module *M,
+                                        llvm::MemoryBufferRef Obj) {
+         assert(!has_object);
+         has_object = true;
+         cache_out->data_size = Obj.getBufferSize();
+         cache_out->data = malloc(cache_out->data_size);
+         if (!cache_out->data) {
+            cache_out->data_size = 0;
+            return;
+         }
+         memcpy(cache_out->data, Obj.getBufferStart(), cache_out->data_size);
+      }
+
+      virtual std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *M) {
+         if (!cache_out->data_size)
+            return nullptr;
+         /* Copy, so that the caller may free its data once compiled */
+         return llvm::MemoryBuffer::getMemBufferCopy(
+            llvm::StringRef((const char *)cache_out->data,
+                            cache_out->data_size),
+            M->getModuleIdentifier());
+      }
+};
+#endif
+
+
 /**
  * Same as LLVMCreateJITCompilerForModule, but:
  * - allows using MCJIT and enabling AVX feature where available.
  * - set target options
+ * - optionally load/store the machine code through cache_out
  *
  * See also:
  * - llvm/lib/ExecutionEngine/ExecutionEngineBindings.cpp
@@ -487,6 +799,7 @@ extern "C"
 LLVMBool
 lp_build_create_jit_compiler_for_module(LLVMExecutionEngineRef *OutJIT,
                                         lp_generated_code **OutCode,
+                                        struct lp_cached_code *cache_out,
                                         LLVMModuleRef M,
                                         LLVMMCJITMemoryManagerRef CMM,
                                         unsigned OptLevel,
@@ -754,6 +1067,13 @@ lp_build_create_jit_compiler_for_module(LLVMExecutionEngineRef *OutJIT,
    JIT->RegisterJITEventListener(JEL);
 #endif
    if (JIT) {
+#if HAVE_LLVM >= 0x0306
+      if (cache_out && useMCJIT) {
+         LPObjectCache *objcache = new LPObjectCache(cache_out);
+         JIT->setObjectCache(objcache);
+         cache_out->jit_obj_cache = (void *)objcache;
+      }
+#endif
       *OutJIT = wrap(JIT);
       return 0;
    }
@@ -772,6 +1092,16 @@ lp_free_generated_code(struct lp_generated_code *code)
    ShaderMemoryManager::freeGeneratedCode(code);
 }
 
+/**
+ * Number of bytes of code and data generated so far for a module.
+ */
+extern "C"
+size_t
+lp_get_generated_code_size(const struct lp_generated_code *code)
+{
+   return ShaderMemoryManager::getGeneratedCodeSize(code);
+}
+
 extern "C"
 LLVMMCJITMemoryManagerRef
 lp_get_default_memory_manager()
@@ -780,7 +1110,10 @@ lp_get_default_memory_manager()
 #if HAVE_LLVM < 0x0306
    mm = llvm::JITMemoryManager::CreateDefaultMemManager();
 #else
-   mm = new llvm::SectionMemoryManager();
+   if (lp_code_pool_enabled())
+      mm = new CodePoolMemoryManager();
+   else
+      mm = new llvm::SectionMemoryManager();
 #endif
    return reinterpret_cast<LLVMMCJITMemoryManagerRef>(mm);
 }
@@ -792,6 +1125,33 @@ lp_free_memory_manager(LLVMMCJITMemoryManagerRef memorymgr)
    delete reinterpret_cast<BaseMemoryManager*>(memorymgr);
 }
 
+/**
+ * Free the object cache created by lp_build_create_jit_compiler_for_module.
+ * Must be called after the engine using it has been disposed.
+ */
+extern "C"
+void
+lp_free_objcache(void *objcache_ptr)
+{
+#if HAVE_LLVM >= 0x0306
+   LPObjectCache *objcache = (LPObjectCache *)objcache_ptr;
+   delete objcache;
+#else
+   assert(!objcache_ptr);
+#endif
+}
+
+/**
+ * Name of the CPU that code is generated for (the -mcpu option).
+ */
+extern "C"
+void
+lp_build_get_host_cpu_name(char *buf, size_t size)
+{
+   std::string name = llvm::sys::getHostCPUName().str();
+   util_snprintf(buf, size, "%s", name.c_str());
+}
+
 extern "C" LLVMValueRef
 lp_get_called_value(LLVMValueRef call)
 {
@@ -0,0 +1,104 @@
+/**************************************************************************
+ * 
+ * Copyright 2018 VMware, Inc.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ **************************************************************************/
+
+/**
+ * @file
+ * NIR to LLVM IR translation.
+ *
+ * The SoA translator mirrors lp_bld_tgsi_soa.c: it emits code for a whole
+ * vector of pixels/vertices at once, uses the same execution mask helpers
+ * for control flow and goes through the same lp_build_sampler_soa
+ * interface for texturing, so callers can swap one for the other.
+ *
+ * Only fragment shaders are translated so far.  There is no geometry
+ * shader interface (emit_vertex/end_primitive), and draw_llvm.c still
+ * builds vertex and geometry shaders from TGSI.
+ */
+
+#ifndef LP_BLD_NIR_H
+#define LP_BLD_NIR_H
+
+#include "gallivm/lp_bld.h"
+#include "gallivm/lp_bld_limits.h"
+#include "gallivm/lp_bld_tgsi.h"
+#include "lp_bld_type.h"
+
+
+struct nir_shader;
+struct nir_shader_compiler_options;
+
+
+/**
+ * Compiler options describing which NIR operations the backend handles
+ * natively; everything else must be lowered by the state tracker.
+ */
+const struct nir_shader_compiler_options *
+lp_build_nir_compiler_options(void);
+
+
+/**
+ * Lower and optimize a shader into the form lp_build_nir_soa() expects:
+ * I/O and uniforms as intrinsics, scalar ALU ops, and out of SSA for phis.
+ * Must be called once, before lp_build_nir_info().
+ */
+void
+lp_build_nir_prepare(struct nir_shader *nir);
+
+
+/**
+ * Whether lp_build_nir_soa() can translate a prepared shader.  Callers
+ * must use the TGSI backend for shaders it can't.
+ */
+boolean
+lp_build_nir_supported(const struct nir_shader *nir);
+
+
+/**
+ * Fill in the same summary lp_build_tgsi_info() produces for TGSI tokens,
+ * with inputs and outputs numbered by driver_location.
+ */
+void
+lp_build_nir_info(const struct nir_shader *nir,
+                  struct lp_tgsi_info *info);
+
+
+void
+lp_build_nir_soa(struct gallivm_state *gallivm,
+                 const struct nir_shader *nir,
+                 struct lp_type type,
+                 struct lp_build_mask_context *mask,
+                 LLVMValueRef consts_ptr,
+                 LLVMValueRef const_sizes_ptr,
+                 const struct lp_bld_tgsi_system_values *system_values,
+                 const LLVMValueRef (*inputs)[4],
+                 LLVMValueRef (*outputs)[4],
+                 LLVMValueRef context_ptr,
+                 LLVMValueRef thread_data_ptr,
+                 struct lp_build_sampler_soa *sampler,
+                 const struct tgsi_shader_info *info);
+
+
+#endif /* LP_BLD_NIR_H */
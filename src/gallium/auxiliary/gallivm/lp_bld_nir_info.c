@@ -0,0 +1,458 @@
+/**************************************************************************
+ * 
+ * Copyright 2018 VMware, Inc.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ **************************************************************************/
+
+/**
+ * @file
+ * Gather the lp_tgsi_info summary of a NIR shader.
+ *
+ * llvmpipe and draw key most of their state off the tgsi_shader_info of a
+ * shader (inputs, outputs, samplers, kill, ...).  Rather than teaching all
+ * of them about NIR, produce the same structure from the NIR variables and
+ * intrinsics, numbering inputs and outputs by driver_location.
+ */
+
+#include "util/u_memory.h"
+#include "util/u_math.h"
+#include "compiler/nir/nir.h"
+#include "tgsi/tgsi_from_mesa.h"
+#include "lp_bld_nir.h"
+
+
+static unsigned
+nir_var_num_slots(const nir_variable *var)
+{
+   const struct glsl_type *type = var->type;
+
+   if (var->data.compact)
+      return DIV_ROUND_UP(glsl_get_length(type), 4);
+
+   return glsl_count_attribute_slots(type, false);
+}
+
+
+static unsigned
+nir_var_usage_mask(const nir_variable *var)
+{
+   const struct glsl_type *type = glsl_without_array(var->type);
+
+   if (var->data.compact)
+      return TGSI_WRITEMASK_XYZW;
+
+   return ((1 << glsl_get_vector_elements(type)) - 1) <<
+          var->data.location_frac;
+}
+
+
+static void
+nir_varying_semantic(gl_varying_slot slot,
+                     unsigned *semantic_name,
+                     unsigned *semantic_index)
+{
+   /*
+    * llvmpipe doesn't advertise PIPE_CAP_TGSI_TEXCOORD, so the state tracker
+    * already moved the texcoord and generic slots to where the TGSI path
+    * puts them; only the point sprite coordinate needs the same treatment
+    * as in st_glsl_to_tgsi.
+    */
+   if (slot == VARYING_SLOT_PNTC) {
+      *semantic_name = TGSI_SEMANTIC_GENERIC;
+      *semantic_index = 8;
+      return;
+   }
+
+   tgsi_get_gl_varying_semantic(slot, true, semantic_name, semantic_index);
+}
+
+
+static unsigned
+nir_input_interpolate(const nir_variable *var, unsigned semantic_name)
+{
+   switch (semantic_name) {
+   case TGSI_SEMANTIC_POSITION:
+      return TGSI_INTERPOLATE_LINEAR;
+   case TGSI_SEMANTIC_FACE:
+   case TGSI_SEMANTIC_PRIMID:
+      return TGSI_INTERPOLATE_CONSTANT;
+   default:
+      break;
+   }
+
+   switch (var->data.interpolation) {
+   case INTERP_MODE_FLAT:
+      return TGSI_INTERPOLATE_CONSTANT;
+   case INTERP_MODE_NOPERSPECTIVE:
+      return TGSI_INTERPOLATE_LINEAR;
+   case INTERP_MODE_NONE:
+      if (semantic_name == TGSI_SEMANTIC_COLOR)
+         return TGSI_INTERPOLATE_COLOR;
+      /* fallthrough */
+   default:
+      return TGSI_INTERPOLATE_PERSPECTIVE;
+   }
+}
+
+
+static void
+nir_scan_inputs(const nir_shader *nir, struct tgsi_shader_info *info)
+{
+   boolean is_fs = nir->info.stage == MESA_SHADER_FRAGMENT;
+
+   nir_foreach_variable(var, &nir->inputs) {
+      unsigned num_slots = nir_var_num_slots(var);
+      unsigned usage_mask = nir_var_usage_mask(var);
+      unsigned i;
+
+      for (i = 0; i < num_slots; i++) {
+         unsigned index = var->data.driver_location + i;
+         unsigned semantic_name, semantic_index;
+
+         if (index >= PIPE_MAX_SHADER_INPUTS)
+            break;
+
+         if (is_fs) {
+            nir_varying_semantic(var->data.location + i,
+                                 &semantic_name, &semantic_index);
+         }
+         else {
+            semantic_name = TGSI_SEMANTIC_GENERIC;
+            semantic_index = var->data.location + i;
+         }
+
+         info->input_semantic_name[index] = semantic_name;
+         info->input_semantic_index[index] = semantic_index;
+         info->input_usage_mask[index] |= usage_mask;
+         info->num_inputs = MAX2(info->num_inputs, index + 1);
+
+         if (!is_fs)
+            continue;
+
+         info->input_interpolate[index] =
+            nir_input_interpolate(var, semantic_name);
+         if (var->data.sample)
+            info->input_interpolate_loc[index] = TGSI_INTERPOLATE_LOC_SAMPLE;
+         else if (var->data.centroid)
+            info->input_interpolate_loc[index] = TGSI_INTERPOLATE_LOC_CENTROID;
+         else
+            info->input_interpolate_loc[index] = TGSI_INTERPOLATE_LOC_CENTER;
+
+         switch (semantic_name) {
+         case TGSI_SEMANTIC_POSITION:
+            info->reads_position = TRUE;
+            info->properties[TGSI_PROPERTY_FS_COORD_ORIGIN] =
+               var->data.origin_upper_left ?
+               TGSI_FS_COORD_ORIGIN_UPPER_LEFT :
+               TGSI_FS_COORD_ORIGIN_LOWER_LEFT;
+            info->properties[TGSI_PROPERTY_FS_COORD_PIXEL_CENTER] =
+               var->data.pixel_center_integer ?
+               TGSI_FS_COORD_PIXEL_CENTER_INTEGER :
+               TGSI_FS_COORD_PIXEL_CENTER_HALF_INTEGER;
+            break;
+         case TGSI_SEMANTIC_FACE:
+            info->uses_frontface = TRUE;
+            break;
+         case TGSI_SEMANTIC_PRIMID:
+            info->uses_primid = TRUE;
+            break;
+         case TGSI_SEMANTIC_COLOR:
+            info->colors_read |= usage_mask << (semantic_index * 4);
+            break;
+         default:
+            break;
+         }
+      }
+   }
+}
+
+
+static void
+nir_scan_outputs(const nir_shader *nir, struct tgsi_shader_info *info)
+{
+   boolean is_fs = nir->info.stage == MESA_SHADER_FRAGMENT;
+
+   nir_foreach_variable(var, &nir->outputs) {
+      unsigned num_slots = nir_var_num_slots(var);
+      unsigned usage_mask = nir_var_usage_mask(var);
+      unsigned i;
+
+      for (i = 0; i < num_slots; i++) {
+         unsigned index = var->data.driver_location + i;
+         unsigned semantic_name, semantic_index;
+
+         if (index >= PIPE_MAX_SHADER_OUTPUTS)
+            break;
+
+         if (is_fs) {
+            tgsi_get_gl_frag_result_semantic(var->data.location + i,
+                                             &semantic_name, &semantic_index);
+            /* dual source blending writes the second source to COLOR[1] */
+            if (semantic_name == TGSI_SEMANTIC_COLOR && var->data.index == 1)
+               semantic_index = 1;
+         }
+         else {
+            nir_varying_semantic(var->data.location + i,
+                                 &semantic_name, &semantic_index);
+         }
+
+         info->output_semantic_name[index] = semantic_name;
+         info->output_semantic_index[index] = semantic_index;
+         info->output_usagemask[index] |= usage_mask;
+         info->num_outputs = MAX2(info->num_outputs, index + 1);
+
+         switch (semantic_name) {
+         case TGSI_SEMANTIC_POSITION:
+            if (is_fs)
+               info->writes_z = TRUE;
+            else
+               info->writes_position = TRUE;
+            break;
+         case TGSI_SEMANTIC_STENCIL:
+            info->writes_stencil = TRUE;
+            break;
+         case TGSI_SEMANTIC_SAMPLEMASK:
+            info->writes_samplemask = TRUE;
+            break;
+         case TGSI_SEMANTIC_COLOR:
+            if (is_fs) {
+               info->colors_written |= 1 << semantic_index;
+               if (var->data.location == FRAG_RESULT_COLOR)
+                  info->properties[TGSI_PROPERTY_FS_COLOR0_WRITES_ALL_CBUFS] = 1;
+            }
+            break;
+         case TGSI_SEMANTIC_PSIZE:
+            info->writes_psize = TRUE;
+            break;
+         default:
+            break;
+         }
+      }
+   }
+}
+
+
+static void
+nir_scan_tex(const nir_shader *nir,
+             const nir_tex_instr *tex,
+             struct lp_tgsi_info *info)
+{
+   unsigned unit = tex->texture_index;
+   unsigned i;
+
+   /*
+    * The state tracker lowers GL samplers so that texture and sampler index
+    * always match, which is what the TGSI TEX opcodes assume too.
+    */
+   if (unit < PIPE_MAX_SAMPLERS) {
+      info->base.file_mask[TGSI_FILE_SAMPLER] |= 1 << unit;
+      info->base.file_max[TGSI_FILE_SAMPLER] =
+         MAX2(info->base.file_max[TGSI_FILE_SAMPLER], (int)unit);
+      info->base.samplers_declared |= 1 << unit;
+   }
+   if (tex->sampler_index != tex->texture_index)
+      info->sampler_texture_units_different = TRUE;
+
+   for (i = 0; i < tex->num_srcs; i++) {
+      if (tex->src[i].src_type == nir_tex_src_texture_offset ||
+          tex->src[i].src_type == nir_tex_src_sampler_offset)
+         info->indirect_textures = TRUE;
+   }
+
+   if (nir->info.stage == MESA_SHADER_FRAGMENT &&
+       (tex->op == nir_texop_tex ||
+        tex->op == nir_texop_txb ||
+        tex->op == nir_texop_lod))
+      info->base.uses_derivatives = TRUE;
+
+   info->base.num_memory_instructions++;
+}
+
+
+static void
+nir_scan_intrinsic(const nir_shader *nir,
+                   const nir_intrinsic_instr *instr,
+                   struct tgsi_shader_info *info)
+{
+   switch (instr->intrinsic) {
+   case nir_intrinsic_discard:
+   case nir_intrinsic_discard_if:
+      info->uses_kill = TRUE;
+      break;
+   case nir_intrinsic_load_uniform:
+      info->const_buffers_declared |= 1;
+      if (!nir_src_as_const_value(instr->src[0]))
+         info->const_buffers_indirect |= 1;
+      break;
+   case nir_intrinsic_load_ubo: {
+      nir_const_value *block = nir_src_as_const_value(instr->src[0]);
+
+      /* UBO n lives in constant buffer n + 1, after the default uniforms */
+      if (block) {
+         if (block->u32[0] + 1 < PIPE_MAX_CONSTANT_BUFFERS)
+            info->const_buffers_declared |= 1 << (block->u32[0] + 1);
+      }
+      else {
+         info->const_buffers_declared |=
+            u_bit_consecutive(1, MIN2(nir->info.num_ubos,
+                                      PIPE_MAX_CONSTANT_BUFFERS - 1));
+         info->dim_indirect_files |= 1 << TGSI_FILE_CONSTANT;
+      }
+      break;
+   }
+   case nir_intrinsic_load_front_face:
+      info->uses_frontface = TRUE;
+      break;
+   case nir_intrinsic_load_vertex_id:
+      info->uses_vertexid = TRUE;
+      break;
+   case nir_intrinsic_load_vertex_id_zero_base:
+      info->uses_vertexid_nobase = TRUE;
+      break;
+   case nir_intrinsic_load_base_vertex:
+      info->uses_basevertex = TRUE;
+      break;
+   case nir_intrinsic_load_instance_id:
+      info->uses_instanceid = TRUE;
+      break;
+   case nir_intrinsic_load_primitive_id:
+      info->uses_primid = TRUE;
+      break;
+   case nir_intrinsic_load_invocation_id:
+      info->uses_invocationid = TRUE;
+      break;
+   case nir_intrinsic_load_local_invocation_id:
+      info->uses_thread_id[0] = TRUE;
+      info->uses_thread_id[1] = TRUE;
+      info->uses_thread_id[2] = TRUE;
+      break;
+   case nir_intrinsic_load_work_group_id:
+      info->uses_block_id[0] = TRUE;
+      info->uses_block_id[1] = TRUE;
+      info->uses_block_id[2] = TRUE;
+      break;
+   case nir_intrinsic_load_num_work_groups:
+      info->uses_grid_size = TRUE;
+      break;
+   case nir_intrinsic_load_local_group_size:
+      info->uses_block_size = TRUE;
+      break;
+   default:
+      break;
+   }
+}
+
+
+void
+lp_build_nir_info(const struct nir_shader *nir,
+                  struct lp_tgsi_info *info)
+{
+   struct tgsi_shader_info *base = &info->base;
+   unsigned index;
+
+   memset(info, 0, sizeof *info);
+   for (index = 0; index < TGSI_FILE_COUNT; index++)
+      base->file_max[index] = -1;
+   for (index = 0; index < PIPE_MAX_CONSTANT_BUFFERS; index++)
+      base->const_file_max[index] = -1;
+
+   base->processor = pipe_shader_type_from_mesa(nir->info.stage);
+
+   nir_scan_inputs(nir, base);
+   nir_scan_outputs(nir, base);
+
+   nir_foreach_function(func, nir) {
+      if (!func->impl)
+         continue;
+
+      nir_foreach_block(block, func->impl) {
+         nir_foreach_instr(instr, block) {
+            switch (instr->type) {
+            case nir_instr_type_alu: {
+               const nir_alu_instr *alu = nir_instr_as_alu(instr);
+               if (alu->op == nir_op_fddx || alu->op == nir_op_fddy ||
+                   alu->op == nir_op_fddx_fine || alu->op == nir_op_fddy_fine ||
+                   alu->op == nir_op_fddx_coarse ||
+                   alu->op == nir_op_fddy_coarse)
+                  base->uses_derivatives = TRUE;
+               if (alu->dest.dest.is_ssa ?
+                   alu->dest.dest.ssa.bit_size == 64 :
+                   alu->dest.dest.reg.reg->bit_size == 64)
+                  base->uses_doubles = TRUE;
+               break;
+            }
+            case nir_instr_type_tex:
+               nir_scan_tex(nir, nir_instr_as_tex(instr), info);
+               break;
+            case nir_instr_type_intrinsic:
+               nir_scan_intrinsic(nir, nir_instr_as_intrinsic(instr), base);
+               break;
+            default:
+               break;
+            }
+            base->num_instructions++;
+         }
+      }
+   }
+
+   /*
+    * There are no tokens, but callers treat num_tokens <= 1 as "the null
+    * fragment shader", so account for an END plus a header like tgsi_scan.
+    */
+   base->num_tokens = base->num_instructions + 2;
+
+   if (base->num_inputs) {
+      base->file_max[TGSI_FILE_INPUT] = base->num_inputs - 1;
+      base->file_count[TGSI_FILE_INPUT] = base->num_inputs;
+      base->file_mask[TGSI_FILE_INPUT] = u_bit_consecutive(0, MIN2(base->num_inputs, 32));
+   }
+   if (base->num_outputs) {
+      base->file_max[TGSI_FILE_OUTPUT] = base->num_outputs - 1;
+      base->file_count[TGSI_FILE_OUTPUT] = base->num_outputs;
+      base->file_mask[TGSI_FILE_OUTPUT] = u_bit_consecutive(0, MIN2(base->num_outputs, 32));
+   }
+   if (base->file_max[TGSI_FILE_SAMPLER] >= 0) {
+      base->file_count[TGSI_FILE_SAMPLER] =
+         util_bitcount(base->file_mask[TGSI_FILE_SAMPLER]);
+   }
+   if (nir->num_uniforms) {
+      base->const_buffers_declared |= 1;
+      base->const_file_max[0] = nir->num_uniforms - 1;
+      base->file_max[TGSI_FILE_CONSTANT] = nir->num_uniforms - 1;
+   }
+   for (index = 1; index < PIPE_MAX_CONSTANT_BUFFERS; index++) {
+      if (base->const_buffers_declared & (1 << index))
+         base->const_file_max[index] = 0;
+   }
+
+   /*
+    * Let the color buffer shortcuts point at the (unknown) output channel
+    * descriptions, the blit detection in lp_state_fs.c bails out on them.
+    */
+   for (index = 0; index < base->num_outputs; index++) {
+      if (base->output_semantic_name[index] == TGSI_SEMANTIC_COLOR &&
+          base->output_semantic_index[index] < PIPE_MAX_COLOR_BUFS) {
+         info->cbuf[base->output_semantic_index[index]] = info->output[index];
+      }
+   }
+}
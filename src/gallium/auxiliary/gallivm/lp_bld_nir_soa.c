@@ -0,0 +1,1801 @@
+/**************************************************************************
+ * 
+ * Copyright 2018 VMware, Inc.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ **************************************************************************/
+
+/**
+ * @file
+ * NIR to LLVM IR translation -- SoA.
+ *
+ * Counterpart of lp_bld_tgsi_soa.c for shaders handed to the driver as NIR.
+ * The shader is first lowered to scalar ALU operations and taken out of
+ * SSA form for phis only (see lp_build_nir_prepare()), so that every value
+ * crossing divergent control flow lives in a NIR register.  Registers are
+ * backed by allocas written under the execution mask; all other SSA values
+ * map straight onto LLVM values.
+ */
+
+#include "pipe/p_shader_tokens.h"
+#include "util/u_debug.h"
+#include "util/u_math.h"
+#include "util/u_memory.h"
+#include "compiler/nir/nir.h"
+#include "lp_bld_nir.h"
+#include "lp_bld_type.h"
+#include "lp_bld_const.h"
+#include "lp_bld_arit.h"
+#include "lp_bld_bitarit.h"
+#include "lp_bld_init.h"
+#include "lp_bld_intr.h"
+#include "lp_bld_logic.h"
+#include "lp_bld_flow.h"
+#include "lp_bld_quad.h"
+#include "lp_bld_debug.h"
+#include "lp_bld_sample.h"
+#include "lp_bld_struct.h"
+
+
+struct lp_build_nir_soa_context
+{
+   struct lp_build_context bld;
+   struct lp_build_context uint_bld;
+   struct lp_build_context int_bld;
+   struct lp_build_context elem_bld;
+
+   struct lp_exec_mask exec_mask;
+   struct lp_build_mask_context *mask;
+
+   const struct tgsi_shader_info *info;
+   struct lp_bld_tgsi_system_values system_values;
+
+   const LLVMValueRef (*inputs)[TGSI_NUM_CHANNELS];
+   LLVMValueRef (*outputs)[TGSI_NUM_CHANNELS];
+
+   LLVMValueRef consts_ptr;
+   LLVMValueRef const_sizes_ptr;
+   LLVMValueRef consts[LP_MAX_TGSI_CONST_BUFFERS];
+   LLVMValueRef consts_sizes[LP_MAX_TGSI_CONST_BUFFERS];
+
+   LLVMValueRef context_ptr;
+   LLVMValueRef thread_data_ptr;
+
+   struct lp_build_sampler_soa *sampler;
+
+   /** LLVM values of the SSA defs, indexed by def index * 4 + channel */
+   LLVMValueRef *ssa_defs;
+
+   /** Backing arrays of the NIR registers, four vectors per element */
+   LLVMValueRef *regs;
+};
+
+
+static void
+emit_cf_list(struct lp_build_nir_soa_context *bld, struct exec_list *list);
+
+
+static inline LLVMValueRef
+cast_float(struct lp_build_nir_soa_context *bld, LLVMValueRef val)
+{
+   return LLVMBuildBitCast(bld->bld.gallivm->builder, val,
+                           bld->bld.vec_type, "");
+}
+
+
+static inline LLVMValueRef
+cast_int(struct lp_build_nir_soa_context *bld, LLVMValueRef val)
+{
+   return LLVMBuildBitCast(bld->bld.gallivm->builder, val,
+                           bld->int_bld.vec_type, "");
+}
+
+
+/**
+ * Vector of {0, 1, 2, ...}, to address each lane of an SoA array.
+ */
+static LLVMValueRef
+get_lane_offsets(struct lp_build_nir_soa_context *bld)
+{
+   struct gallivm_state *gallivm = bld->bld.gallivm;
+   LLVMValueRef offsets = bld->uint_bld.undef;
+   unsigned i;
+
+   for (i = 0; i < bld->uint_bld.type.length; i++) {
+      LLVMValueRef ii = lp_build_const_int32(gallivm, i);
+      offsets = LLVMBuildInsertElement(gallivm->builder, offsets, ii, ii, "");
+   }
+   return offsets;
+}
+
+
+/**
+ * Load one scalar per lane from base_ptr[indexes[lane]].
+ * Lanes set in overflow_mask read index zero and return zero, matching the
+ * out of bounds behaviour of constant buffers in lp_bld_tgsi_soa.c.
+ */
+static LLVMValueRef
+build_gather(struct lp_build_nir_soa_context *bld,
+             LLVMValueRef base_ptr,
+             LLVMValueRef indexes,
+             LLVMValueRef overflow_mask)
+{
+   struct gallivm_state *gallivm = bld->bld.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMValueRef res = bld->bld.undef;
+   unsigned i;
+
+   if (overflow_mask) {
+      indexes = lp_build_select(&bld->uint_bld, overflow_mask,
+                                bld->uint_bld.zero, indexes);
+   }
+
+   for (i = 0; i < bld->bld.type.length; i++) {
+      LLVMValueRef ii = lp_build_const_int32(gallivm, i);
+      LLVMValueRef index = LLVMBuildExtractElement(builder, indexes, ii, "");
+      LLVMValueRef scalar_ptr = LLVMBuildGEP(builder, base_ptr,
+                                             &index, 1, "gather_ptr");
+      LLVMValueRef scalar = LLVMBuildLoad(builder, scalar_ptr, "");
+
+      res = LLVMBuildInsertElement(builder, res, scalar, ii, "");
+   }
+
+   if (overflow_mask) {
+      res = lp_build_select(&bld->bld, overflow_mask, bld->bld.zero, res);
+   }
+
+   return res;
+}
+
+
+/**
+ * Store values[lane] to base_ptr[indexes[lane]] for the active lanes.
+ */
+static void
+emit_mask_scatter(struct lp_build_nir_soa_context *bld,
+                  LLVMValueRef base_ptr,
+                  LLVMValueRef indexes,
+                  LLVMValueRef values)
+{
+   struct gallivm_state *gallivm = bld->bld.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMValueRef pred = bld->exec_mask.has_mask ?
+                       bld->exec_mask.exec_mask : NULL;
+   unsigned i;
+
+   for (i = 0; i < bld->bld.type.length; i++) {
+      LLVMValueRef ii = lp_build_const_int32(gallivm, i);
+      LLVMValueRef index = LLVMBuildExtractElement(builder, indexes, ii, "");
+      LLVMValueRef scalar_ptr = LLVMBuildGEP(builder, base_ptr,
+                                             &index, 1, "scatter_ptr");
+      LLVMValueRef val = LLVMBuildExtractElement(builder, values, ii,
+                                                 "scatter_val");
+
+      if (pred) {
+         LLVMValueRef scalar_pred =
+            LLVMBuildExtractElement(builder, pred, ii, "scatter_pred");
+         LLVMValueRef dst_val = LLVMBuildLoad(builder, scalar_ptr, "");
+         val = lp_build_select(&bld->elem_bld, scalar_pred, val, dst_val);
+      }
+      LLVMBuildStore(builder, val, scalar_ptr);
+   }
+}
+
+
+static LLVMValueRef get_src(struct lp_build_nir_soa_context *bld,
+                            nir_src src, unsigned chan);
+
+
+/**
+ * Per-lane element offsets into the float array backing an indirectly
+ * addressed register.
+ */
+static LLVMValueRef
+get_reg_offsets(struct lp_build_nir_soa_context *bld,
+                const nir_register *reg,
+                unsigned base_offset,
+                const nir_src *indirect,
+                unsigned chan)
+{
+   struct lp_build_context *uint_bld = &bld->uint_bld;
+   struct gallivm_state *gallivm = bld->bld.gallivm;
+   LLVMValueRef index;
+
+   index = lp_build_add(uint_bld, cast_int(bld, get_src(bld, *indirect, 0)),
+                        lp_build_const_int_vec(gallivm, uint_bld->type,
+                                               base_offset));
+   index = lp_build_min(uint_bld, index,
+                        lp_build_const_int_vec(gallivm, uint_bld->type,
+                                               MAX2(reg->num_array_elems, 1) - 1));
+
+   /* (index * 4 + chan) * length + lane */
+   index = lp_build_shl_imm(uint_bld, index, 2);
+   index = lp_build_add(uint_bld, index,
+                        lp_build_const_int_vec(gallivm, uint_bld->type, chan));
+   index = lp_build_mul(uint_bld, index,
+                        lp_build_const_int_vec(gallivm, uint_bld->type,
+                                               uint_bld->type.length));
+   return lp_build_add(uint_bld, index, get_lane_offsets(bld));
+}
+
+
+static LLVMValueRef
+get_reg_float_ptr(struct lp_build_nir_soa_context *bld,
+                  const nir_register *reg)
+{
+   LLVMTypeRef float_ptr_type =
+      LLVMPointerType(LLVMFloatTypeInContext(bld->bld.gallivm->context), 0);
+
+   return LLVMBuildBitCast(bld->bld.gallivm->builder, bld->regs[reg->index],
+                           float_ptr_type, "");
+}
+
+
+static LLVMValueRef
+load_reg(struct lp_build_nir_soa_context *bld,
+         const nir_reg_src *src,
+         unsigned chan)
+{
+   struct gallivm_state *gallivm = bld->bld.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+
+   if (src->indirect) {
+      LLVMValueRef offsets = get_reg_offsets(bld, src->reg, src->base_offset,
+                                             src->indirect, chan);
+      return build_gather(bld, get_reg_float_ptr(bld, src->reg),
+                          offsets, NULL);
+   }
+   else {
+      LLVMValueRef index =
+         lp_build_const_int32(gallivm, src->base_offset * 4 + chan);
+      LLVMValueRef ptr = LLVMBuildGEP(builder, bld->regs[src->reg->index],
+                                      &index, 1, "");
+      return LLVMBuildLoad(builder, ptr, "");
+   }
+}
+
+
+static void
+store_reg(struct lp_build_nir_soa_context *bld,
+          const nir_reg_dest *dest,
+          unsigned chan,
+          LLVMValueRef val)
+{
+   struct gallivm_state *gallivm = bld->bld.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+
+   val = cast_float(bld, val);
+
+   if (dest->indirect) {
+      LLVMValueRef offsets = get_reg_offsets(bld, dest->reg, dest->base_offset,
+                                             dest->indirect, chan);
+      emit_mask_scatter(bld, get_reg_float_ptr(bld, dest->reg), offsets, val);
+   }
+   else {
+      LLVMValueRef index =
+         lp_build_const_int32(gallivm, dest->base_offset * 4 + chan);
+      LLVMValueRef ptr = LLVMBuildGEP(builder, bld->regs[dest->reg->index],
+                                      &index, 1, "");
+      lp_exec_mask_store(&bld->exec_mask, &bld->bld, val, ptr);
+   }
+}
+
+
+/**
+ * Return the raw (untyped) value of one channel of a source.
+ */
+static LLVMValueRef
+get_src(struct lp_build_nir_soa_context *bld, nir_src src, unsigned chan)
+{
+   if (src.is_ssa)
+      return bld->ssa_defs[src.ssa->index * 4 + chan];
+   else
+      return load_reg(bld, &src.reg, chan);
+}
+
+
+static void
+assign_dest(struct lp_build_nir_soa_context *bld,
+            const nir_dest *dest,
+            unsigned chan,
+            LLVMValueRef val)
+{
+   if (dest->is_ssa)
+      bld->ssa_defs[dest->ssa.index * 4 + chan] = val;
+   else
+      store_reg(bld, &dest->reg, chan, val);
+}
+
+
+static unsigned
+get_dest_num_components(const nir_dest *dest)
+{
+   return dest->is_ssa ? dest->ssa.num_components : dest->reg.reg->num_components;
+}
+
+
+static unsigned
+get_dest_bit_size(const nir_dest *dest)
+{
+   return dest->is_ssa ? dest->ssa.bit_size : dest->reg.reg->bit_size;
+}
+
+
+static unsigned
+get_src_bit_size(const nir_src *src)
+{
+   return src->is_ssa ? src->ssa->bit_size : src->reg.reg->bit_size;
+}
+
+
+/**
+ * Fetch one channel of an ALU source, cast to its type and with the
+ * abs/negate modifiers applied.
+ */
+static LLVMValueRef
+get_alu_src(struct lp_build_nir_soa_context *bld,
+            const nir_alu_instr *instr,
+            unsigned src,
+            unsigned chan)
+{
+   nir_alu_type type =
+      nir_alu_type_get_base_type(nir_op_infos[instr->op].input_types[src]);
+   const nir_alu_src *alu_src = &instr->src[src];
+   LLVMValueRef val = get_src(bld, alu_src->src, alu_src->swizzle[chan]);
+
+   if (type == nir_type_float) {
+      val = cast_float(bld, val);
+      if (alu_src->abs)
+         val = lp_build_abs(&bld->bld, val);
+      if (alu_src->negate)
+         val = lp_build_negate(&bld->bld, val);
+   }
+   else {
+      val = cast_int(bld, val);
+      if (alu_src->abs)
+         val = lp_build_abs(&bld->int_bld, val);
+      if (alu_src->negate)
+         val = lp_build_negate(&bld->int_bld, val);
+   }
+   return val;
+}
+
+
+/**
+ * Integer division helpers, with the same divide by zero results as
+ * the corresponding TGSI opcodes so neither path can raise SIGFPE.
+ */
+static LLVMValueRef
+emit_div_mod(struct lp_build_nir_soa_context *bld,
+             nir_op op,
+             LLVMValueRef a,
+             LLVMValueRef b)
+{
+   LLVMBuilderRef builder = bld->bld.gallivm->builder;
+   struct lp_build_context *bld_div =
+      (op == nir_op_udiv || op == nir_op_umod) ? &bld->uint_bld : &bld->int_bld;
+   LLVMValueRef div_mask = lp_build_cmp(&bld->uint_bld, PIPE_FUNC_EQUAL, b,
+                                        bld->uint_bld.zero);
+   LLVMValueRef divisor = LLVMBuildOr(builder, div_mask, b, "");
+   LLVMValueRef res;
+
+   switch (op) {
+   case nir_op_idiv:
+      res = lp_build_div(bld_div, a, divisor);
+      /* idiv by zero doesn't have a guaranteed return value chose 0 */
+      return LLVMBuildAnd(builder, LLVMBuildNot(builder, div_mask, ""),
+                          res, "");
+   case nir_op_udiv:
+      res = lp_build_div(bld_div, a, divisor);
+      return LLVMBuildOr(builder, div_mask, res, "");
+   case nir_op_umod:
+   case nir_op_irem:
+      res = lp_build_mod(bld_div, a, divisor);
+      return LLVMBuildOr(builder, div_mask, res, "");
+   case nir_op_imod: {
+      /* irem takes the sign of the dividend, imod the one of the divisor */
+      LLVMValueRef fixup;
+      res = lp_build_mod(bld_div, a, divisor);
+      fixup = LLVMBuildAnd(builder,
+                           lp_build_cmp(bld_div, PIPE_FUNC_NOTEQUAL, res,
+                                        bld_div->zero),
+                           lp_build_cmp(bld_div, PIPE_FUNC_LESS,
+                                        LLVMBuildXor(builder, res, divisor, ""),
+                                        bld_div->zero), "");
+      res = lp_build_select(bld_div, fixup,
+                            lp_build_add(bld_div, res, divisor), res);
+      return LLVMBuildOr(builder, div_mask, res, "");
+   }
+   default:
+      assert(0);
+      return bld_div->undef;
+   }
+}
+
+
+static LLVMValueRef
+emit_bit_intrinsic(struct lp_build_nir_soa_context *bld,
+                   const char *name_root,
+                   LLVMValueRef a,
+                   boolean zero_undef_arg)
+{
+   struct gallivm_state *gallivm = bld->bld.gallivm;
+   char intrinsic[64];
+
+   lp_format_intrinsic(intrinsic, sizeof intrinsic, name_root,
+                       bld->int_bld.vec_type);
+   if (zero_undef_arg) {
+      return lp_build_intrinsic_binary(gallivm->builder, intrinsic,
+                                       bld->int_bld.vec_type, a,
+                                       LLVMConstInt(LLVMInt1TypeInContext(gallivm->context),
+                                                    0, 0));
+   }
+   return lp_build_intrinsic_unary(gallivm->builder, intrinsic,
+                                   bld->int_bld.vec_type, a);
+}
+
+
+static LLVMValueRef
+emit_find_msb(struct lp_build_nir_soa_context *bld, LLVMValueRef a)
+{
+   /* 31 - ctlz(a), which yields -1 for zero input as required */
+   LLVMValueRef lz = emit_bit_intrinsic(bld, "llvm.ctlz", a, TRUE);
+
+   return lp_build_sub(&bld->int_bld,
+                       lp_build_const_int_vec(bld->bld.gallivm,
+                                              bld->int_bld.type, 31), lz);
+}
+
+
+/**
+ * Emit one channel of a per-component ALU operation.
+ * Returns NULL for operations the backend doesn't implement.
+ */
+static LLVMValueRef
+emit_alu_op(struct lp_build_nir_soa_context *bld,
+            nir_op op,
+            LLVMValueRef *src)
+{
+   struct gallivm_state *gallivm = bld->bld.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   struct lp_build_context *float_bld = &bld->bld;
+   struct lp_build_context *int_bld = &bld->int_bld;
+   struct lp_build_context *uint_bld = &bld->uint_bld;
+   LLVMValueRef tmp;
+
+   switch (op) {
+   case nir_op_fmov:
+   case nir_op_imov:
+      return src[0];
+
+   /* floating point */
+   case nir_op_fneg:
+      return lp_build_negate(float_bld, src[0]);
+   case nir_op_fabs:
+      return lp_build_abs(float_bld, src[0]);
+   case nir_op_fsat:
+      return lp_build_clamp_zero_one_nanzero(float_bld, src[0]);
+   case nir_op_fsign:
+      return lp_build_sgn(float_bld, src[0]);
+   case nir_op_fadd:
+      return lp_build_add(float_bld, src[0], src[1]);
+   case nir_op_fsub:
+      return lp_build_sub(float_bld, src[0], src[1]);
+   case nir_op_fmul:
+      return lp_build_mul(float_bld, src[0], src[1]);
+   case nir_op_fdiv:
+      return lp_build_div(float_bld, src[0], src[1]);
+   case nir_op_ffma:
+      return lp_build_mad(float_bld, src[0], src[1], src[2]);
+   case nir_op_flrp:
+      return lp_build_lerp(float_bld, src[2], src[0], src[1], 0);
+   case nir_op_fmin:
+      return lp_build_min_ext(float_bld, src[0], src[1],
+                              GALLIVM_NAN_RETURN_OTHER);
+   case nir_op_fmax:
+      return lp_build_max_ext(float_bld, src[0], src[1],
+                              GALLIVM_NAN_RETURN_OTHER);
+   case nir_op_frcp:
+      return lp_build_rcp(float_bld, src[0]);
+   case nir_op_frsq:
+      return lp_build_rsqrt(float_bld, src[0]);
+   case nir_op_fsqrt:
+      return lp_build_sqrt(float_bld, src[0]);
+   case nir_op_fexp2:
+      return lp_build_exp2(float_bld, src[0]);
+   case nir_op_flog2:
+      return lp_build_log2_safe(float_bld, src[0]);
+   case nir_op_fpow:
+      return lp_build_pow(float_bld, src[0], src[1]);
+   case nir_op_fsin:
+      return lp_build_sin(float_bld, src[0]);
+   case nir_op_fcos:
+      return lp_build_cos(float_bld, src[0]);
+   case nir_op_ffloor:
+      return lp_build_floor(float_bld, src[0]);
+   case nir_op_fceil:
+      return lp_build_ceil(float_bld, src[0]);
+   case nir_op_ftrunc:
+      return lp_build_trunc(float_bld, src[0]);
+   case nir_op_fround_even:
+      return lp_build_round(float_bld, src[0]);
+   case nir_op_ffract:
+      return lp_build_fract(float_bld, src[0]);
+   case nir_op_fddx:
+   case nir_op_fddx_fine:
+   case nir_op_fddx_coarse:
+      return lp_build_ddx(float_bld, src[0]);
+   case nir_op_fddy:
+   case nir_op_fddy_fine:
+   case nir_op_fddy_coarse:
+      return lp_build_ddy(float_bld, src[0]);
+
+   /* comparisons, producing 0 / ~0 booleans */
+   case nir_op_flt:
+      return lp_build_cmp_ordered(float_bld, PIPE_FUNC_LESS, src[0], src[1]);
+   case nir_op_fge:
+      return lp_build_cmp_ordered(float_bld, PIPE_FUNC_GEQUAL, src[0], src[1]);
+   case nir_op_feq:
+      return lp_build_cmp_ordered(float_bld, PIPE_FUNC_EQUAL, src[0], src[1]);
+   case nir_op_fne:
+      return lp_build_cmp(float_bld, PIPE_FUNC_NOTEQUAL, src[0], src[1]);
+   case nir_op_ilt:
+      return lp_build_cmp(int_bld, PIPE_FUNC_LESS, src[0], src[1]);
+   case nir_op_ige:
+      return lp_build_cmp(int_bld, PIPE_FUNC_GEQUAL, src[0], src[1]);
+   case nir_op_ieq:
+      return lp_build_cmp(int_bld, PIPE_FUNC_EQUAL, src[0], src[1]);
+   case nir_op_ine:
+      return lp_build_cmp(int_bld, PIPE_FUNC_NOTEQUAL, src[0], src[1]);
+   case nir_op_ult:
+      return lp_build_cmp(uint_bld, PIPE_FUNC_LESS, src[0], src[1]);
+   case nir_op_uge:
+      return lp_build_cmp(uint_bld, PIPE_FUNC_GEQUAL, src[0], src[1]);
+
+   /* selects */
+   case nir_op_bcsel:
+      return lp_build_select(int_bld, src[0], src[1], src[2]);
+   case nir_op_fcsel:
+      tmp = lp_build_cmp(float_bld, PIPE_FUNC_NOTEQUAL, src[0], float_bld->zero);
+      return lp_build_select(float_bld, tmp, src[1], src[2]);
+
+   /* conversions */
+   case nir_op_i2f32:
+      return lp_build_int_to_float(float_bld, src[0]);
+   case nir_op_u2f32:
+      return LLVMBuildUIToFP(builder, src[0], float_bld->vec_type, "");
+   case nir_op_f2i32:
+      return lp_build_itrunc(float_bld, src[0]);
+   case nir_op_f2u32:
+      return LLVMBuildFPToUI(builder, src[0], uint_bld->vec_type, "");
+   case nir_op_i2i32:
+   case nir_op_u2u32:
+   case nir_op_f2f32:
+      return src[0];
+   case nir_op_f2b:
+      return lp_build_cmp(float_bld, PIPE_FUNC_NOTEQUAL, src[0], float_bld->zero);
+   case nir_op_i2b:
+      return lp_build_cmp(int_bld, PIPE_FUNC_NOTEQUAL, src[0], int_bld->zero);
+   case nir_op_b2f:
+      return LLVMBuildAnd(builder, src[0],
+                          cast_int(bld, float_bld->one), "");
+   case nir_op_b2i:
+      return LLVMBuildAnd(builder, src[0], int_bld->one, "");
+
+   /* integer arithmetic */
+   case nir_op_ineg:
+      return lp_build_negate(int_bld, src[0]);
+   case nir_op_iabs:
+      return lp_build_abs(int_bld, src[0]);
+   case nir_op_isign:
+      return lp_build_sgn(int_bld, src[0]);
+   case nir_op_iadd:
+      return lp_build_add(int_bld, src[0], src[1]);
+   case nir_op_isub:
+      return lp_build_sub(int_bld, src[0], src[1]);
+   case nir_op_imul:
+      return lp_build_mul(int_bld, src[0], src[1]);
+   case nir_op_imul_high:
+      lp_build_mul_32_lohi_cpu(int_bld, src[0], src[1], &tmp);
+      return tmp;
+   case nir_op_umul_high:
+      lp_build_mul_32_lohi_cpu(uint_bld, src[0], src[1], &tmp);
+      return tmp;
+   case nir_op_idiv:
+   case nir_op_udiv:
+   case nir_op_umod:
+   case nir_op_irem:
+   case nir_op_imod:
+      return emit_div_mod(bld, op, src[0], src[1]);
+   case nir_op_imin:
+      return lp_build_min(int_bld, src[0], src[1]);
+   case nir_op_imax:
+      return lp_build_max(int_bld, src[0], src[1]);
+   case nir_op_umin:
+      return lp_build_min(uint_bld, src[0], src[1]);
+   case nir_op_umax:
+      return lp_build_max(uint_bld, src[0], src[1]);
+
+   /* bit operations; shift counts are taken modulo 32 like in TGSI */
+   case nir_op_inot:
+      return lp_build_not(int_bld, src[0]);
+   case nir_op_iand:
+      return lp_build_and(int_bld, src[0], src[1]);
+   case nir_op_ior:
+      return lp_build_or(int_bld, src[0], src[1]);
+   case nir_op_ixor:
+      return lp_build_xor(int_bld, src[0], src[1]);
+   case nir_op_ishl:
+   case nir_op_ishr:
+   case nir_op_ushr:
+      tmp = lp_build_and(int_bld, src[1],
+                         lp_build_const_int_vec(gallivm, int_bld->type, 31));
+      if (op == nir_op_ishl)
+         return lp_build_shl(int_bld, src[0], tmp);
+      else if (op == nir_op_ishr)
+         return lp_build_shr(int_bld, src[0], tmp);
+      else
+         return lp_build_shr(uint_bld, src[0], tmp);
+   case nir_op_bit_count:
+      return emit_bit_intrinsic(bld, "llvm.ctpop", src[0], FALSE);
+   case nir_op_find_lsb:
+      tmp = emit_bit_intrinsic(bld, "llvm.cttz", src[0], TRUE);
+      return lp_build_select(int_bld,
+                             lp_build_cmp(int_bld, PIPE_FUNC_EQUAL, src[0],
+                                          int_bld->zero),
+                             lp_build_const_int_vec(gallivm, int_bld->type, -1),
+                             tmp);
+   case nir_op_ufind_msb:
+      return emit_find_msb(bld, src[0]);
+   case nir_op_ifind_msb:
+      /* for negative values look for the most significant zero bit */
+      tmp = lp_build_shr_imm(int_bld, src[0], 31);
+      return emit_find_msb(bld, lp_build_xor(int_bld, src[0], tmp));
+
+   default:
+      return NULL;
+   }
+}
+
+
+static void
+emit_alu(struct lp_build_nir_soa_context *bld, const nir_alu_instr *instr)
+{
+   const nir_op_info *info = &nir_op_infos[instr->op];
+   unsigned num_components = get_dest_num_components(&instr->dest.dest);
+   unsigned write_mask = instr->dest.dest.is_ssa ?
+                         (1 << num_components) - 1 : instr->dest.write_mask;
+   unsigned chan, i;
+
+   /* see lp_build_nir_supported() */
+   assert(get_dest_bit_size(&instr->dest.dest) == 32);
+
+   for (chan = 0; chan < num_components; chan++) {
+      LLVMValueRef src[4];
+      LLVMValueRef res = NULL;
+
+      if (!(write_mask & (1 << chan)))
+         continue;
+
+      if (instr->op == nir_op_vec2 ||
+               instr->op == nir_op_vec3 ||
+               instr->op == nir_op_vec4) {
+         res = get_alu_src(bld, instr, chan, 0);
+      }
+      else if (info->output_size == 0) {
+         for (i = 0; i < info->num_inputs; i++)
+            src[i] = get_alu_src(bld, instr, i, chan);
+         res = emit_alu_op(bld, instr->op, src);
+      }
+
+      if (!res) {
+         _debug_printf("warning: unsupported NIR ALU op %s\n", info->name);
+         res = bld->bld.undef;
+      }
+      else if (instr->dest.saturate) {
+         res = lp_build_clamp_zero_one_nanzero(&bld->bld, cast_float(bld, res));
+      }
+
+      assign_dest(bld, &instr->dest.dest, chan, res);
+   }
+}
+
+
+static void
+emit_load_const(struct lp_build_nir_soa_context *bld,
+                const nir_load_const_instr *instr)
+{
+   unsigned chan;
+
+   for (chan = 0; chan < instr->def.num_components; chan++) {
+      bld->ssa_defs[instr->def.index * 4 + chan] =
+         lp_build_const_int_vec(bld->bld.gallivm, bld->int_bld.type,
+                                (int)instr->value.u32[chan]);
+   }
+}
+
+
+static void
+emit_ssa_undef(struct lp_build_nir_soa_context *bld,
+               const nir_ssa_undef_instr *instr)
+{
+   unsigned chan;
+
+   for (chan = 0; chan < instr->def.num_components; chan++)
+      bld->ssa_defs[instr->def.index * 4 + chan] = bld->int_bld.undef;
+}
+
+
+/**
+ * Select the value of lanes whose dynamic index matches each candidate.
+ * Used for indirectly addressed inputs and outputs, which are rare enough
+ * not to warrant copying them into arrays like the TGSI path does.
+ */
+static LLVMValueRef
+get_io_index(struct lp_build_nir_soa_context *bld,
+             const nir_intrinsic_instr *instr,
+             const nir_src *offset,
+             unsigned *base)
+{
+   nir_const_value *const_offset = nir_src_as_const_value(*offset);
+
+   *base = nir_intrinsic_base(instr);
+   if (const_offset) {
+      *base += const_offset->u32[0];
+      return NULL;
+   }
+   return cast_int(bld, get_src(bld, *offset, 0));
+}
+
+
+static LLVMValueRef
+get_input(struct lp_build_nir_soa_context *bld,
+          unsigned index,
+          unsigned chan)
+{
+   const struct tgsi_shader_info *info = bld->info;
+   LLVMValueRef val;
+
+   if (index >= info->num_inputs || chan >= TGSI_NUM_CHANNELS)
+      return bld->bld.undef;
+
+   switch (info->input_semantic_name[index]) {
+   case TGSI_SEMANTIC_PRIMID:
+      /* This is really a system value not a regular input */
+      if (bld->system_values.prim_id)
+         return bld->system_values.prim_id;
+      break;
+   case TGSI_SEMANTIC_FACE:
+      /* llvmpipe interpolates the face as +1/-1, NIR wants a boolean */
+      val = bld->inputs[index][0];
+      if (val && chan == 0)
+         return lp_build_cmp(&bld->bld, PIPE_FUNC_GREATER, val, bld->bld.zero);
+      break;
+   default:
+      break;
+   }
+
+   val = bld->inputs[index][chan];
+   return val ? val : bld->bld.undef;
+}
+
+
+static void
+emit_load_input(struct lp_build_nir_soa_context *bld,
+                const nir_intrinsic_instr *instr)
+{
+   unsigned component = nir_intrinsic_component(instr);
+   unsigned base, chan;
+   LLVMValueRef indirect = get_io_index(bld, instr, &instr->src[0], &base);
+
+   for (chan = 0; chan < instr->num_components; chan++) {
+      LLVMValueRef res;
+
+      if (indirect) {
+         unsigned i;
+
+         res = bld->bld.undef;
+         for (i = base; i < bld->info->num_inputs; i++) {
+            LLVMValueRef cond =
+               lp_build_cmp(&bld->int_bld, PIPE_FUNC_EQUAL, indirect,
+                            lp_build_const_int_vec(bld->bld.gallivm,
+                                                   bld->int_bld.type, i - base));
+            res = lp_build_select(&bld->bld, cond,
+                                  cast_float(bld, get_input(bld, i, component + chan)),
+                                  res);
+         }
+      }
+      else {
+         res = get_input(bld, base, component + chan);
+      }
+      assign_dest(bld, &instr->dest, chan, res);
+   }
+}
+
+
+static void
+emit_store_output(struct lp_build_nir_soa_context *bld,
+                  const nir_intrinsic_instr *instr)
+{
+   const struct tgsi_shader_info *info = bld->info;
+   unsigned write_mask = nir_intrinsic_write_mask(instr);
+   unsigned component = nir_intrinsic_component(instr);
+   unsigned base, chan, i;
+   LLVMValueRef indirect = get_io_index(bld, instr, &instr->src[1], &base);
+
+   for (chan = 0; chan < instr->num_components; chan++) {
+      LLVMValueRef val;
+
+      if (!(write_mask & (1 << chan)))
+         continue;
+
+      val = cast_float(bld, get_src(bld, instr->src[0], chan));
+
+      for (i = base; i < info->num_outputs; i++) {
+         unsigned out_chan = component + chan;
+         LLVMValueRef ptr;
+
+         /*
+          * Scalar NIR fragment results land in the channels the TGSI
+          * semantics use, which is where llvmpipe looks for them.
+          */
+         if (info->processor == PIPE_SHADER_FRAGMENT) {
+            switch (info->output_semantic_name[i]) {
+            case TGSI_SEMANTIC_POSITION:
+               out_chan = 2;
+               break;
+            case TGSI_SEMANTIC_STENCIL:
+               out_chan = 1;
+               break;
+            case TGSI_SEMANTIC_SAMPLEMASK:
+               out_chan = 0;
+               break;
+            default:
+               break;
+            }
+         }
+
+         ptr = out_chan < TGSI_NUM_CHANNELS ? bld->outputs[i][out_chan] : NULL;
+
+         if (!indirect) {
+            if (ptr)
+               lp_exec_mask_store(&bld->exec_mask, &bld->bld, val, ptr);
+            break;
+         }
+
+         if (ptr) {
+            LLVMValueRef cond =
+               lp_build_cmp(&bld->int_bld, PIPE_FUNC_EQUAL, indirect,
+                            lp_build_const_int_vec(bld->bld.gallivm,
+                                                   bld->int_bld.type, i - base));
+            LLVMValueRef old = LLVMBuildLoad(bld->bld.gallivm->builder, ptr, "");
+            lp_exec_mask_store(&bld->exec_mask, &bld->bld,
+                               lp_build_select(&bld->bld, cond, val, old), ptr);
+         }
+      }
+   }
+}
+
+
+/**
+ * Load one dword from constant buffer 'slot' at the given dword offset.
+ */
+static LLVMValueRef
+load_const_buffer(struct lp_build_nir_soa_context *bld,
+                  unsigned slot,
+                  LLVMValueRef dword_offset,
+                  unsigned const_offset)
+{
+   struct gallivm_state *gallivm = bld->bld.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   struct lp_build_context *uint_bld = &bld->uint_bld;
+   LLVMValueRef consts_ptr = bld->consts[slot];
+
+   if (!consts_ptr) {
+      assert(0);
+      return bld->bld.zero;
+   }
+
+   if (dword_offset) {
+      LLVMValueRef num_consts, overflow_mask, index;
+
+      index = lp_build_add(uint_bld, dword_offset,
+                           lp_build_const_int_vec(gallivm, uint_bld->type,
+                                                  const_offset));
+
+      /* the buffer size is in vec4 units */
+      num_consts = lp_build_broadcast_scalar(uint_bld, bld->consts_sizes[slot]);
+      overflow_mask = lp_build_compare(gallivm, uint_bld->type,
+                                       PIPE_FUNC_GEQUAL,
+                                       lp_build_shr_imm(uint_bld, index, 2),
+                                       num_consts);
+      return build_gather(bld, consts_ptr, index, overflow_mask);
+   }
+   else {
+      LLVMValueRef index = lp_build_const_int32(gallivm, const_offset);
+      LLVMValueRef scalar_ptr = LLVMBuildGEP(builder, consts_ptr, &index, 1, "");
+      LLVMValueRef scalar = LLVMBuildLoad(builder, scalar_ptr, "");
+      return lp_build_broadcast_scalar(&bld->bld, scalar);
+   }
+}
+
+
+static void
+emit_load_uniform(struct lp_build_nir_soa_context *bld,
+                  const nir_intrinsic_instr *instr)
+{
+   unsigned base, chan;
+   LLVMValueRef indirect = get_io_index(bld, instr, &instr->src[0], &base);
+
+   /* the default uniform block is constant buffer 0, in vec4 units */
+   if (indirect)
+      indirect = lp_build_shl_imm(&bld->uint_bld, indirect, 2);
+
+   for (chan = 0; chan < instr->num_components; chan++) {
+      assign_dest(bld, &instr->dest, chan,
+                  load_const_buffer(bld, 0, indirect, base * 4 + chan));
+   }
+}
+
+
+static void
+emit_load_ubo(struct lp_build_nir_soa_context *bld,
+              const nir_intrinsic_instr *instr)
+{
+   struct lp_build_context *uint_bld = &bld->uint_bld;
+   nir_const_value *block = nir_src_as_const_value(instr->src[0]);
+   nir_const_value *offset = nir_src_as_const_value(instr->src[1]);
+   LLVMValueRef dword_offset = NULL;
+   unsigned const_offset = 0;
+   unsigned chan;
+
+   if (offset)
+      const_offset = offset->u32[0] / 4;
+   else
+      dword_offset = lp_build_shr_imm(uint_bld,
+                                      cast_int(bld, get_src(bld, instr->src[1], 0)),
+                                      2);
+
+   for (chan = 0; chan < instr->num_components; chan++) {
+      LLVMValueRef res;
+
+      /* UBO n is bound to constant buffer n + 1 */
+      if (block) {
+         unsigned slot = block->u32[0] + 1;
+         res = slot < LP_MAX_TGSI_CONST_BUFFERS && bld->consts[slot] ?
+               load_const_buffer(bld, slot, dword_offset, const_offset + chan) :
+               bld->bld.zero;
+      }
+      else {
+         LLVMValueRef index = cast_int(bld, get_src(bld, instr->src[0], 0));
+         unsigned slot;
+
+         res = bld->bld.zero;
+         for (slot = 1; slot < LP_MAX_TGSI_CONST_BUFFERS; slot++) {
+            LLVMValueRef cond;
+
+            if (!bld->consts[slot])
+               continue;
+
+            cond = lp_build_cmp(uint_bld, PIPE_FUNC_EQUAL, index,
+                                lp_build_const_int_vec(bld->bld.gallivm,
+                                                       uint_bld->type,
+                                                       slot - 1));
+            res = lp_build_select(&bld->bld, cond,
+                                  load_const_buffer(bld, slot, dword_offset,
+                                                    const_offset + chan),
+                                  res);
+         }
+      }
+      assign_dest(bld, &instr->dest, chan, res);
+   }
+}
+
+
+static void
+emit_discard(struct lp_build_nir_soa_context *bld, LLVMValueRef cond)
+{
+   LLVMBuilderRef builder = bld->bld.gallivm->builder;
+   LLVMValueRef mask;
+
+   if (!bld->mask)
+      return;
+
+   /* lanes that stay alive: not killed, or not executing */
+   if (cond)
+      mask = LLVMBuildNot(builder, cond, "");
+   else
+      mask = LLVMConstNull(bld->int_bld.vec_type);
+
+   if (bld->exec_mask.has_mask) {
+      LLVMValueRef invmask = LLVMBuildNot(builder, bld->exec_mask.exec_mask,
+                                          "kilp");
+      mask = LLVMBuildOr(builder, mask, invmask, "");
+   }
+
+   lp_build_mask_update(bld->mask, mask);
+   lp_build_mask_check(bld->mask);
+}
+
+
+static LLVMValueRef
+get_front_face(struct lp_build_nir_soa_context *bld)
+{
+   unsigned i;
+
+   for (i = 0; i < bld->info->num_inputs; i++) {
+      if (bld->info->input_semantic_name[i] == TGSI_SEMANTIC_FACE)
+         return get_input(bld, i, 0);
+   }
+   return lp_build_const_int_vec(bld->bld.gallivm, bld->int_bld.type, ~0);
+}
+
+
+static void
+emit_intrinsic(struct lp_build_nir_soa_context *bld,
+               const nir_intrinsic_instr *instr)
+{
+   struct lp_build_context *uint_bld = &bld->uint_bld;
+   const struct lp_bld_tgsi_system_values *sv = &bld->system_values;
+   LLVMValueRef vals[3] = { NULL };
+   unsigned num_vals = 1, chan;
+
+   switch (instr->intrinsic) {
+   case nir_intrinsic_load_input:
+      emit_load_input(bld, instr);
+      return;
+   case nir_intrinsic_store_output:
+      emit_store_output(bld, instr);
+      return;
+   case nir_intrinsic_load_uniform:
+      emit_load_uniform(bld, instr);
+      return;
+   case nir_intrinsic_load_ubo:
+      emit_load_ubo(bld, instr);
+      return;
+   case nir_intrinsic_discard:
+      emit_discard(bld, NULL);
+      return;
+   case nir_intrinsic_discard_if:
+      emit_discard(bld, cast_int(bld, get_src(bld, instr->src[0], 0)));
+      return;
+   case nir_intrinsic_load_front_face:
+      vals[0] = get_front_face(bld);
+      break;
+   case nir_intrinsic_load_vertex_id:
+      vals[0] = sv->vertex_id;
+      break;
+   case nir_intrinsic_load_vertex_id_zero_base:
+      vals[0] = sv->vertex_id_nobase;
+      break;
+   case nir_intrinsic_load_base_vertex:
+      vals[0] = sv->basevertex;
+      break;
+   case nir_intrinsic_load_primitive_id:
+      vals[0] = sv->prim_id;
+      break;
+   case nir_intrinsic_load_instance_id:
+      if (sv->instance_id)
+         vals[0] = lp_build_broadcast_scalar(uint_bld, sv->instance_id);
+      break;
+   case nir_intrinsic_load_invocation_id:
+      if (sv->invocation_id)
+         vals[0] = lp_build_broadcast_scalar(uint_bld, sv->invocation_id);
+      break;
+   case nir_intrinsic_load_local_invocation_id:
+      num_vals = 3;
+      for (chan = 0; chan < 3; chan++)
+         vals[chan] = sv->thread_id[chan];
+      break;
+   case nir_intrinsic_load_work_group_id:
+   case nir_intrinsic_load_num_work_groups:
+   case nir_intrinsic_load_local_group_size: {
+      const LLVMValueRef *scalars =
+         instr->intrinsic == nir_intrinsic_load_work_group_id ? sv->block_id :
+         instr->intrinsic == nir_intrinsic_load_num_work_groups ? sv->grid_size :
+         sv->block_size;
+      num_vals = 3;
+      for (chan = 0; chan < 3; chan++) {
+         if (scalars[chan])
+            vals[chan] = lp_build_broadcast_scalar(uint_bld, scalars[chan]);
+      }
+      break;
+   }
+   default:
+      _debug_printf("warning: unsupported NIR intrinsic %s\n",
+                    nir_intrinsic_infos[instr->intrinsic].name);
+      if (nir_intrinsic_infos[instr->intrinsic].has_dest)
+         num_vals = 0;
+      else
+         return;
+      break;
+   }
+
+   for (chan = 0; chan < get_dest_num_components(&instr->dest); chan++) {
+      assign_dest(bld, &instr->dest, chan,
+                  chan < num_vals && vals[chan] ? vals[chan] : uint_bld->undef);
+   }
+}
+
+
+static enum lp_sampler_lod_property
+get_lod_property(struct lp_build_nir_soa_context *bld, const nir_src *src)
+{
+   /*
+    * Unlike with TGSI, constants are recognized wherever they came from,
+    * but there's still no way to spot dynamically uniform values.
+    */
+   if (nir_src_as_const_value(*src))
+      return LP_SAMPLER_LOD_SCALAR;
+   else if (bld->info->processor == PIPE_SHADER_FRAGMENT &&
+            !(gallivm_debug & GALLIVM_DEBUG_NO_QUAD_LOD))
+      return LP_SAMPLER_LOD_PER_QUAD;
+   else
+      return LP_SAMPLER_LOD_PER_ELEMENT;
+}
+
+
+static unsigned
+get_tex_target(const nir_tex_instr *instr)
+{
+   switch (instr->sampler_dim) {
+   case GLSL_SAMPLER_DIM_1D:
+      return instr->is_array ? PIPE_TEXTURE_1D_ARRAY : PIPE_TEXTURE_1D;
+   case GLSL_SAMPLER_DIM_3D:
+      return PIPE_TEXTURE_3D;
+   case GLSL_SAMPLER_DIM_CUBE:
+      return instr->is_array ? PIPE_TEXTURE_CUBE_ARRAY : PIPE_TEXTURE_CUBE;
+   case GLSL_SAMPLER_DIM_RECT:
+      return PIPE_TEXTURE_RECT;
+   case GLSL_SAMPLER_DIM_BUF:
+      return PIPE_BUFFER;
+   default:
+      return instr->is_array ? PIPE_TEXTURE_2D_ARRAY : PIPE_TEXTURE_2D;
+   }
+}
+
+
+static void
+emit_size_query(struct lp_build_nir_soa_context *bld,
+                const nir_tex_instr *instr)
+{
+   struct lp_sampler_size_query_params params;
+   LLVMValueRef sizes[4];
+   unsigned target = get_tex_target(instr);
+   unsigned chan, i;
+
+   memset(&params, 0, sizeof params);
+   params.int_type = bld->int_bld.type;
+   params.texture_unit = instr->texture_index;
+   params.target = target;
+   params.context_ptr = bld->context_ptr;
+   params.is_sviewinfo = TRUE;
+   params.lod_property = LP_SAMPLER_LOD_SCALAR;
+   params.sizes_out = sizes;
+
+   if (target != PIPE_BUFFER && target != PIPE_TEXTURE_RECT) {
+      params.explicit_lod = bld->int_bld.zero;
+      for (i = 0; i < instr->num_srcs; i++) {
+         if (instr->src[i].src_type == nir_tex_src_lod) {
+            params.explicit_lod =
+               cast_int(bld, get_src(bld, instr->src[i].src, 0));
+            params.lod_property = get_lod_property(bld, &instr->src[i].src);
+         }
+      }
+   }
+
+   bld->sampler->emit_size_query(bld->sampler, bld->bld.gallivm, &params);
+
+   if (instr->op == nir_texop_query_levels) {
+      assign_dest(bld, &instr->dest, 0, sizes[3]);
+      return;
+   }
+
+   for (chan = 0; chan < nir_tex_instr_dest_size(instr); chan++)
+      assign_dest(bld, &instr->dest, chan, sizes[chan]);
+}
+
+
+static void
+emit_tex(struct lp_build_nir_soa_context *bld,
+         const nir_tex_instr *instr)
+{
+   struct gallivm_state *gallivm = bld->bld.gallivm;
+   LLVMValueRef coords[5];
+   LLVMValueRef offsets[3] = { NULL };
+   LLVMValueRef texel[4];
+   LLVMValueRef lod = NULL;
+   struct lp_derivatives derivs;
+   struct lp_sampler_params params;
+   enum lp_sampler_lod_property lod_property = LP_SAMPLER_LOD_SCALAR;
+   boolean is_fetch = instr->op == nir_texop_txf ||
+                      instr->op == nir_texop_txf_ms;
+   LLVMValueRef coord_undef = is_fetch ? bld->int_bld.undef : bld->bld.undef;
+   unsigned sample_key;
+   unsigned num_coords, num_derivs, num_offsets;
+   unsigned chan, i;
+
+   if (!bld->sampler) {
+      _debug_printf("warning: found texture instruction but no sampler generator supplied\n");
+      for (chan = 0; chan < nir_tex_instr_dest_size(instr); chan++)
+         assign_dest(bld, &instr->dest, chan, bld->bld.undef);
+      return;
+   }
+
+   switch (instr->op) {
+   case nir_texop_txs:
+   case nir_texop_query_levels:
+      emit_size_query(bld, instr);
+      return;
+   case nir_texop_tex:
+   case nir_texop_txb:
+   case nir_texop_txl:
+   case nir_texop_txd:
+      sample_key = LP_SAMPLER_OP_TEXTURE << LP_SAMPLER_OP_TYPE_SHIFT;
+      break;
+   case nir_texop_txf:
+   case nir_texop_txf_ms:
+      sample_key = LP_SAMPLER_OP_FETCH << LP_SAMPLER_OP_TYPE_SHIFT;
+      break;
+   case nir_texop_lod:
+      sample_key = LP_SAMPLER_OP_LODQ << LP_SAMPLER_OP_TYPE_SHIFT;
+      break;
+   case nir_texop_tg4:
+      /* the sampler only gathers the first component */
+      if (instr->component != 0)
+         _debug_printf("warning: unsupported gather component %u\n",
+                       instr->component);
+      sample_key = LP_SAMPLER_OP_GATHER << LP_SAMPLER_OP_TYPE_SHIFT;
+      break;
+   default:
+      _debug_printf("warning: unsupported NIR texture op %u\n", instr->op);
+      for (chan = 0; chan < nir_tex_instr_dest_size(instr); chan++)
+         assign_dest(bld, &instr->dest, chan, bld->bld.undef);
+      return;
+   }
+
+   switch (instr->sampler_dim) {
+   case GLSL_SAMPLER_DIM_1D:
+   case GLSL_SAMPLER_DIM_BUF:
+      num_derivs = 1;
+      num_offsets = 1;
+      break;
+   case GLSL_SAMPLER_DIM_3D:
+      num_derivs = 3;
+      num_offsets = 3;
+      break;
+   case GLSL_SAMPLER_DIM_CUBE:
+      num_derivs = 3;
+      num_offsets = 2;
+      break;
+   default:
+      num_derivs = 2;
+      num_offsets = 2;
+      break;
+   }
+
+   for (i = 0; i < 5; i++)
+      coords[i] = coord_undef;
+
+   memset(&params, 0, sizeof params);
+
+   for (i = 0; i < instr->num_srcs; i++) {
+      const nir_src *src = &instr->src[i].src;
+
+      switch (instr->src[i].src_type) {
+      case nir_tex_src_coord:
+         num_coords = instr->coord_components - instr->is_array;
+         for (chan = 0; chan < num_coords && chan < 3; chan++)
+            coords[chan] = get_src(bld, *src, chan);
+         /* Layer coord always goes into 3rd slot, except for cube map arrays */
+         if (instr->is_array) {
+            coords[instr->sampler_dim == GLSL_SAMPLER_DIM_CUBE ? 3 : 2] =
+               get_src(bld, *src, num_coords);
+         }
+         break;
+      case nir_tex_src_comparator:
+         /* Shadow coord occupies always 5th slot. */
+         sample_key |= LP_SAMPLER_SHADOW;
+         coords[4] = get_src(bld, *src, 0);
+         break;
+      case nir_tex_src_offset:
+         sample_key |= LP_SAMPLER_OFFSETS;
+         for (chan = 0; chan < num_offsets; chan++)
+            offsets[chan] = cast_int(bld, get_src(bld, *src, chan));
+         break;
+      case nir_tex_src_bias:
+         sample_key |= LP_SAMPLER_LOD_BIAS << LP_SAMPLER_LOD_CONTROL_SHIFT;
+         lod = get_src(bld, *src, 0);
+         lod_property = get_lod_property(bld, src);
+         break;
+      case nir_tex_src_lod:
+         /* texel fetches from buffers and msaa surfaces have no lod */
+         if (instr->sampler_dim == GLSL_SAMPLER_DIM_BUF ||
+             instr->sampler_dim == GLSL_SAMPLER_DIM_MS)
+            break;
+         sample_key |= LP_SAMPLER_LOD_EXPLICIT << LP_SAMPLER_LOD_CONTROL_SHIFT;
+         lod = get_src(bld, *src, 0);
+         lod_property = get_lod_property(bld, src);
+         break;
+      case nir_tex_src_ddx:
+      case nir_tex_src_ddy:
+         for (chan = 0; chan < num_derivs; chan++) {
+            LLVMValueRef deriv = cast_float(bld, get_src(bld, *src, chan));
+            if (instr->src[i].src_type == nir_tex_src_ddx)
+               derivs.ddx[chan] = deriv;
+            else
+               derivs.ddy[chan] = deriv;
+         }
+         break;
+      case nir_tex_src_ms_index:
+         /* like the TGSI path, multisample textures only have sample 0 */
+         break;
+      default:
+         _debug_printf("warning: unsupported NIR texture source %u\n",
+                       instr->src[i].src_type);
+         break;
+      }
+   }
+
+   if (instr->op == nir_texop_txd) {
+      sample_key |= LP_SAMPLER_LOD_DERIVATIVES << LP_SAMPLER_LOD_CONTROL_SHIFT;
+      params.derivs = &derivs;
+      if (bld->info->processor == PIPE_SHADER_FRAGMENT &&
+          !(gallivm_debug & GALLIVM_DEBUG_NO_QUAD_LOD))
+         lod_property = LP_SAMPLER_LOD_PER_QUAD;
+      else
+         lod_property = LP_SAMPLER_LOD_PER_ELEMENT;
+   }
+   sample_key |= lod_property << LP_SAMPLER_LOD_PROPERTY_SHIFT;
+
+   if (is_fetch) {
+      for (i = 0; i < 5; i++)
+         coords[i] = cast_int(bld, coords[i]);
+   }
+   else {
+      for (i = 0; i < 5; i++)
+         coords[i] = cast_float(bld, coords[i]);
+      if (lod)
+         lod = cast_float(bld, lod);
+   }
+   if (lod && is_fetch)
+      lod = cast_int(bld, lod);
+
+   params.type = bld->bld.type;
+   params.sample_key = sample_key;
+   params.texture_index = instr->texture_index;
+   /*
+    * Texel fetches don't use the sampler, keep it at 0 like the TGSI path
+    * so it can't exceed PIPE_MAX_SAMPLERS.
+    */
+   params.sampler_index = is_fetch ? 0 : instr->texture_index;
+   params.context_ptr = bld->context_ptr;
+   params.thread_data_ptr = bld->thread_data_ptr;
+   params.coords = coords;
+   params.offsets = offsets;
+   params.lod = lod;
+   params.texel = texel;
+
+   bld->sampler->emit_tex_sample(bld->sampler, gallivm, &params);
+
+   for (chan = 0; chan < nir_tex_instr_dest_size(instr); chan++)
+      assign_dest(bld, &instr->dest, chan, texel[chan]);
+}
+
+
+static void
+emit_jump(struct lp_build_nir_soa_context *bld, const nir_jump_instr *instr)
+{
+   switch (instr->type) {
+   case nir_jump_break:
+      lp_exec_break(&bld->exec_mask, NULL);
+      break;
+   case nir_jump_continue:
+      lp_exec_continue(&bld->exec_mask);
+      break;
+   default:
+      /* returns are lowered away by lp_build_nir_prepare() */
+      assert(0);
+      break;
+   }
+}
+
+
+static void
+emit_block(struct lp_build_nir_soa_context *bld, nir_block *block)
+{
+   nir_foreach_instr(instr, block) {
+      switch (instr->type) {
+      case nir_instr_type_alu:
+         emit_alu(bld, nir_instr_as_alu(instr));
+         break;
+      case nir_instr_type_load_const:
+         emit_load_const(bld, nir_instr_as_load_const(instr));
+         break;
+      case nir_instr_type_ssa_undef:
+         emit_ssa_undef(bld, nir_instr_as_ssa_undef(instr));
+         break;
+      case nir_instr_type_intrinsic:
+         emit_intrinsic(bld, nir_instr_as_intrinsic(instr));
+         break;
+      case nir_instr_type_tex:
+         emit_tex(bld, nir_instr_as_tex(instr));
+         break;
+      case nir_instr_type_jump:
+         emit_jump(bld, nir_instr_as_jump(instr));
+         break;
+      default:
+         /* phis and parallel copies are gone after nir_convert_from_ssa */
+         _debug_printf("warning: unexpected NIR instruction type %u\n",
+                       instr->type);
+         assert(0);
+         break;
+      }
+   }
+}
+
+
+static void
+emit_if(struct lp_build_nir_soa_context *bld, nir_if *nif)
+{
+   nir_block *else_block = nir_if_first_else_block(nif);
+
+   lp_exec_mask_cond_push(&bld->exec_mask,
+                          cast_int(bld, get_src(bld, nif->condition, 0)));
+
+   emit_cf_list(bld, &nif->then_list);
+
+   if (else_block != nir_if_last_else_block(nif) ||
+       !exec_list_is_empty(&else_block->instr_list)) {
+      lp_exec_mask_cond_invert(&bld->exec_mask);
+      emit_cf_list(bld, &nif->else_list);
+   }
+
+   lp_exec_mask_cond_pop(&bld->exec_mask);
+}
+
+
+static void
+emit_loop(struct lp_build_nir_soa_context *bld, nir_loop *loop)
+{
+   lp_exec_bgnloop(&bld->exec_mask);
+   emit_cf_list(bld, &loop->body);
+   lp_exec_endloop(bld->bld.gallivm, &bld->exec_mask);
+}
+
+
+static void
+emit_cf_list(struct lp_build_nir_soa_context *bld, struct exec_list *list)
+{
+   foreach_list_typed(nir_cf_node, node, node, list) {
+      switch (node->type) {
+      case nir_cf_node_block:
+         emit_block(bld, nir_cf_node_as_block(node));
+         break;
+      case nir_cf_node_if:
+         emit_if(bld, nir_cf_node_as_if(node));
+         break;
+      case nir_cf_node_loop:
+         emit_loop(bld, nir_cf_node_as_loop(node));
+         break;
+      default:
+         assert(0);
+         break;
+      }
+   }
+}
+
+
+static void
+emit_prologue(struct lp_build_nir_soa_context *bld,
+              nir_function_impl *impl)
+{
+   struct gallivm_state *gallivm = bld->bld.gallivm;
+   const struct tgsi_shader_info *info = bld->info;
+   unsigned index, chan;
+
+   /*
+    * Outputs are written under the execution mask, possibly from deep
+    * within control flow, so they need their storage set up front.
+    */
+   for (index = 0; index < info->num_outputs; index++) {
+      for (chan = 0; chan < TGSI_NUM_CHANNELS; chan++) {
+         bld->outputs[index][chan] = lp_build_alloca(gallivm,
+                                                     bld->bld.vec_type,
+                                                     "output");
+      }
+   }
+
+   /*
+    * Fetch the constant buffer pointers just once, for the same compile
+    * time reasons as in lp_bld_tgsi_soa.c.
+    */
+   for (index = 0; index < LP_MAX_TGSI_CONST_BUFFERS; index++) {
+      if (info->const_buffers_declared & (1 << index)) {
+         LLVMValueRef index2D = lp_build_const_int32(gallivm, index);
+         bld->consts[index] =
+            lp_build_array_get(gallivm, bld->consts_ptr, index2D);
+         bld->consts_sizes[index] =
+            lp_build_array_get(gallivm, bld->const_sizes_ptr, index2D);
+      }
+   }
+
+   nir_foreach_register(reg, &impl->registers) {
+      unsigned size = MAX2(reg->num_array_elems, 1) * 4;
+      bld->regs[reg->index] =
+         lp_build_array_alloca(gallivm, bld->bld.vec_type,
+                               lp_build_const_int32(gallivm, size), "reg");
+   }
+}
+
+
+void
+lp_build_nir_soa(struct gallivm_state *gallivm,
+                 const struct nir_shader *nir,
+                 struct lp_type type,
+                 struct lp_build_mask_context *mask,
+                 LLVMValueRef consts_ptr,
+                 LLVMValueRef const_sizes_ptr,
+                 const struct lp_bld_tgsi_system_values *system_values,
+                 const LLVMValueRef (*inputs)[TGSI_NUM_CHANNELS],
+                 LLVMValueRef (*outputs)[TGSI_NUM_CHANNELS],
+                 LLVMValueRef context_ptr,
+                 LLVMValueRef thread_data_ptr,
+                 struct lp_build_sampler_soa *sampler,
+                 const struct tgsi_shader_info *info)
+{
+   struct lp_build_nir_soa_context bld;
+   nir_function_impl *impl = nir_shader_get_entrypoint((nir_shader *)nir);
+
+   assert(type.length <= LP_MAX_VECTOR_LENGTH);
+
+   memset(&bld, 0, sizeof bld);
+   lp_build_context_init(&bld.bld, gallivm, type);
+   lp_build_context_init(&bld.uint_bld, gallivm, lp_uint_type(type));
+   lp_build_context_init(&bld.int_bld, gallivm, lp_int_type(type));
+   lp_build_context_init(&bld.elem_bld, gallivm, lp_elem_type(type));
+   bld.mask = mask;
+   bld.info = info;
+   bld.system_values = *system_values;
+   bld.inputs = inputs;
+   bld.outputs = outputs;
+   bld.consts_ptr = consts_ptr;
+   bld.const_sizes_ptr = const_sizes_ptr;
+   bld.context_ptr = context_ptr;
+   bld.thread_data_ptr = thread_data_ptr;
+   bld.sampler = sampler;
+
+   bld.ssa_defs = CALLOC(impl->ssa_alloc * 4, sizeof(LLVMValueRef));
+   bld.regs = CALLOC(MAX2(impl->reg_alloc, 1), sizeof(LLVMValueRef));
+   if (!bld.ssa_defs || !bld.regs) {
+      FREE(bld.ssa_defs);
+      FREE(bld.regs);
+      return;
+   }
+
+   lp_exec_mask_init(&bld.exec_mask, &bld.int_bld);
+
+   emit_prologue(&bld, impl);
+   emit_cf_list(&bld, &impl->body);
+
+   lp_exec_mask_fini(&bld.exec_mask);
+
+   FREE(bld.ssa_defs);
+   FREE(bld.regs);
+}
+
+
+static int
+type_size(const struct glsl_type *type)
+{
+   return glsl_count_attribute_slots(type, false);
+}
+
+
+static void
+convert_loops_to_lcssa(struct exec_list *list)
+{
+   foreach_list_typed(nir_cf_node, node, node, list) {
+      switch (node->type) {
+      case nir_cf_node_if: {
+         nir_if *nif = nir_cf_node_as_if(node);
+         convert_loops_to_lcssa(&nif->then_list);
+         convert_loops_to_lcssa(&nif->else_list);
+         break;
+      }
+      case nir_cf_node_loop: {
+         nir_loop *loop = nir_cf_node_as_loop(node);
+         convert_loops_to_lcssa(&loop->body);
+         nir_convert_loop_to_lcssa(loop);
+         break;
+      }
+      default:
+         break;
+      }
+   }
+}
+
+
+static void
+optimize_nir(struct nir_shader *nir)
+{
+   bool progress;
+
+   do {
+      progress = false;
+
+      NIR_PASS_V(nir, nir_lower_alu_to_scalar);
+      NIR_PASS(progress, nir, nir_copy_prop);
+      NIR_PASS(progress, nir, nir_opt_remove_phis);
+      NIR_PASS(progress, nir, nir_opt_dce);
+      if (nir_opt_trivial_continues(nir)) {
+         progress = true;
+         NIR_PASS(progress, nir, nir_copy_prop);
+         NIR_PASS(progress, nir, nir_opt_dce);
+      }
+      NIR_PASS(progress, nir, nir_opt_if);
+      NIR_PASS(progress, nir, nir_opt_dead_cf);
+      NIR_PASS(progress, nir, nir_opt_cse);
+      NIR_PASS(progress, nir, nir_opt_peephole_select, 8);
+      NIR_PASS(progress, nir, nir_opt_algebraic);
+      NIR_PASS(progress, nir, nir_opt_constant_folding);
+      NIR_PASS(progress, nir, nir_opt_undef);
+      NIR_PASS(progress, nir, nir_opt_loop_unroll, (nir_variable_mode)0);
+   } while (progress);
+}
+
+
+void
+lp_build_nir_prepare(struct nir_shader *nir)
+{
+   static const nir_lower_tex_options tex_options = {
+      .lower_txp = ~0u,
+   };
+
+   NIR_PASS_V(nir, nir_lower_io,
+              nir_var_shader_in | nir_var_shader_out | nir_var_uniform,
+              type_size, (nir_lower_io_options)0);
+   NIR_PASS_V(nir, nir_lower_global_vars_to_local);
+   NIR_PASS_V(nir, nir_lower_vars_to_ssa);
+   NIR_PASS_V(nir, nir_lower_regs_to_ssa);
+   NIR_PASS_V(nir, nir_lower_returns);
+   NIR_PASS_V(nir, nir_lower_tex, &tex_options);
+
+   optimize_nir(nir);
+
+   /*
+    * Go out of SSA for phis only: with all lanes of a vector running the
+    * same instructions, a value that crosses divergent control flow must
+    * be written under the execution mask, which the registers take care
+    * of.  LCSSA makes this apply to values leaving loops too.
+    */
+   NIR_PASS_V(nir, nir_lower_locals_to_regs);
+   nir_foreach_function(func, nir) {
+      if (func->impl)
+         convert_loops_to_lcssa(&func->impl->body);
+   }
+   NIR_PASS_V(nir, nir_convert_from_ssa, true);
+
+   nir_foreach_function(func, nir) {
+      if (func->impl) {
+         nir_index_ssa_defs(func->impl);
+         nir_index_local_regs(func->impl);
+      }
+   }
+}
+
+
+/**
+ * Only 32-bit values are translated: shaders with 64-bit or 16-bit types
+ * must use the TGSI backend.
+ */
+boolean
+lp_build_nir_supported(const struct nir_shader *nir)
+{
+   nir_foreach_function(func, nir) {
+      if (!func->impl)
+         continue;
+
+      nir_foreach_register(reg, &func->impl->registers) {
+         if (reg->bit_size != 32)
+            return FALSE;
+      }
+
+      nir_foreach_block(block, func->impl) {
+         nir_foreach_instr(instr, block) {
+            switch (instr->type) {
+            case nir_instr_type_alu: {
+               const nir_alu_instr *alu = nir_instr_as_alu(instr);
+               unsigned i;
+
+               if (get_dest_bit_size(&alu->dest.dest) != 32)
+                  return FALSE;
+               for (i = 0; i < nir_op_infos[alu->op].num_inputs; i++) {
+                  if (get_src_bit_size(&alu->src[i].src) != 32)
+                     return FALSE;
+               }
+               break;
+            }
+            case nir_instr_type_load_const:
+               if (nir_instr_as_load_const(instr)->def.bit_size != 32)
+                  return FALSE;
+               break;
+            case nir_instr_type_ssa_undef:
+               if (nir_instr_as_ssa_undef(instr)->def.bit_size != 32)
+                  return FALSE;
+               break;
+            case nir_instr_type_intrinsic: {
+               const nir_intrinsic_instr *intr = nir_instr_as_intrinsic(instr);
+
+               if (nir_intrinsic_infos[intr->intrinsic].has_dest &&
+                   get_dest_bit_size(&intr->dest) != 32)
+                  return FALSE;
+               break;
+            }
+            case nir_instr_type_tex:
+               if (get_dest_bit_size(&nir_instr_as_tex(instr)->dest) != 32)
+                  return FALSE;
+               break;
+            default:
+               break;
+            }
+         }
+      }
+   }
+
+   return TRUE;
+}
+
+
+static const struct nir_shader_compiler_options lp_nir_options = {
+   .lower_ffma = true,
+   .lower_flrp32 = true,
+   .lower_flrp64 = true,
+   .lower_fmod32 = true,
+   .lower_fmod64 = true,
+   .lower_bitfield_extract = true,
+   .lower_bitfield_insert = true,
+   .lower_uadd_carry = true,
+   .lower_usub_borrow = true,
+   .lower_scmp = true,
+   .lower_pack_half_2x16 = true,
+   .lower_pack_unorm_2x16 = true,
+   .lower_pack_snorm_2x16 = true,
+   .lower_pack_unorm_4x8 = true,
+   .lower_pack_snorm_4x8 = true,
+   .lower_unpack_half_2x16 = true,
+   .lower_unpack_unorm_2x16 = true,
+   .lower_unpack_snorm_2x16 = true,
+   .lower_unpack_unorm_4x8 = true,
+   .lower_unpack_snorm_4x8 = true,
+   .lower_extract_byte = true,
+   .lower_extract_word = true,
+   .native_integers = true,
+   .max_unroll_iterations = 32,
+};
+
+
+const struct nir_shader_compiler_options *
+lp_build_nir_compiler_options(void)
+{
+   return &lp_nir_options;
+}
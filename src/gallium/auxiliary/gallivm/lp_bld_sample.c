@@ -2023,16 +2023,69 @@ lp_build_sample_partial_offset(struct lp_build_context *bld,
 }
 
 
+/**
+ * Compute the partial offset of a texel along the x or y axis of an image
+ * with the tiled layout (see LP_TEXTURE_TILE_SIZE).
+ *
+ * @param texel_size  size of a texel in bytes
+ * @param axis        0 for the x axis, 1 for the y axis
+ * @param coord       coordinate in texels
+ * @param stride      texel size for the x axis, number of bytes between
+ *                    rows of tiles for the y axis
+ * @return  relative offset of the texel in bytes
+ */
+LLVMValueRef
+lp_build_sample_tiled_partial_offset(struct lp_build_context *bld,
+                                     unsigned texel_size,
+                                     unsigned axis,
+                                     LLVMValueRef coord,
+                                     LLVMValueRef stride)
+{
+   LLVMBuilderRef builder = bld->gallivm->builder;
+   const unsigned tile_size = LP_TEXTURE_TILE_SIZE;
+   LLVMValueRef tile_shift, tile_mask;
+   LLVMValueRef tile_coord, subcoord;
+   LLVMValueRef tile_stride, texel_stride;
+
+   assert(axis < 2);
+
+   tile_shift = lp_build_const_int_vec(bld->gallivm, bld->type,
+                                       util_logbase2(tile_size));
+   tile_mask = lp_build_const_int_vec(bld->gallivm, bld->type, tile_size - 1);
+   tile_coord = LLVMBuildLShr(builder, coord, tile_shift, "");
+   subcoord = LLVMBuildAnd(builder, coord, tile_mask, "");
+
+   if (axis == 0) {
+      /* whole tiles lie between horizontally adjacent tiles */
+      tile_stride = lp_build_const_int_vec(bld->gallivm, bld->type,
+                                           tile_size * tile_size * texel_size);
+      texel_stride = stride;
+   }
+   else {
+      tile_stride = stride;
+      texel_stride = lp_build_const_int_vec(bld->gallivm, bld->type,
+                                            tile_size * texel_size);
+   }
+
+   return lp_build_add(bld,
+                       lp_build_mul(bld, tile_coord, tile_stride),
+                       lp_build_mul(bld, subcoord, texel_stride));
+}
+
+
 /**
  * Compute the offset of a pixel block.
  *
  * x, y, z, y_stride, z_stride are vectors, and they refer to pixels.
+ * If tiled is set, the texture has the tiled layout, which is only
+ * supported for formats with 1x1 pixel blocks.
  *
  * Returns the relative offset and i,j sub-block coordinates
  */
 void
 lp_build_sample_offset(struct lp_build_context *bld,
                        const struct util_format_description *format_desc,
+                       boolean tiled,
                        LLVMValueRef x,
                        LLVMValueRef y,
                        LLVMValueRef z,
@@ -2048,17 +2101,35 @@ lp_build_sample_offset(struct lp_build_context *bld,
    x_stride = lp_build_const_vec(bld->gallivm, bld->type,
                                  format_desc->block.bits/8);
 
-   lp_build_sample_partial_offset(bld,
-                                  format_desc->block.width,
-                                  x, x_stride,
-                                  &offset, out_i);
+   if (tiled) {
+      assert(format_desc->block.width == 1 &&
+             format_desc->block.height == 1);
+      offset = lp_build_sample_tiled_partial_offset(bld,
+                                                    format_desc->block.bits/8,
+                                                    0, x, x_stride);
+      *out_i = bld->zero;
+   }
+   else {
+      lp_build_sample_partial_offset(bld,
+                                     format_desc->block.width,
+                                     x, x_stride,
+                                     &offset, out_i);
+   }
 
    if (y && y_stride) {
       LLVMValueRef y_offset;
-      lp_build_sample_partial_offset(bld,
-                                     format_desc->block.height,
-                                     y, y_stride,
-                                     &y_offset, out_j);
+      if (tiled) {
+         y_offset = lp_build_sample_tiled_partial_offset(bld,
+                                                         format_desc->block.bits/8,
+                                                         1, y, y_stride);
+         *out_j = bld->zero;
+      }
+      else {
+         lp_build_sample_partial_offset(bld,
+                                        format_desc->block.height,
+                                        y, y_stride,
+                                        &y_offset, out_j);
+      }
       offset = lp_build_add(bld, offset, y_offset);
    }
    else {
@@ -122,6 +122,20 @@ struct lp_sampler_size_query_params
    LLVMValueRef explicit_lod;
    LLVMValueRef *sizes_out;
 };
+
+
+/**
+ * Size of the texel tiles of textures with the tiled layout.
+ *
+ * Each 2D image (mip level, array layer, cube face or 3D slice) of such
+ * textures is stored as LP_TEXTURE_TILE_SIZE x LP_TEXTURE_TILE_SIZE texel
+ * tiles, with the texels of a tile and the tiles of an image both in
+ * row-major order.  The row stride is then the number of bytes between
+ * successive rows of tiles.
+ */
+#define LP_TEXTURE_TILE_SIZE 4
+
+
 /**
  * Texture static state.
  *
@@ -143,6 +157,7 @@ struct lp_static_texture_state
    unsigned pot_height:1;
    unsigned pot_depth:1;
    unsigned level_zero_only:1;
+   unsigned tiled:1;         /**< see LP_TEXTURE_TILE_SIZE */
 };
 
 
@@ -590,9 +605,18 @@ lp_build_sample_partial_offset(struct lp_build_context *bld,
                                LLVMValueRef *out_i);
 
 
+LLVMValueRef
+lp_build_sample_tiled_partial_offset(struct lp_build_context *bld,
+                                     unsigned texel_size,
+                                     unsigned axis,
+                                     LLVMValueRef coord,
+                                     LLVMValueRef stride);
+
+
 void
 lp_build_sample_offset(struct lp_build_context *bld,
                        const struct util_format_description *format_desc,
+                       boolean tiled,
                        LLVMValueRef x,
                        LLVMValueRef y,
                        LLVMValueRef z,
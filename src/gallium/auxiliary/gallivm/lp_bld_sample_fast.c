@@ -0,0 +1,469 @@
+/**************************************************************************
+ * 
+ * Copyright 2018 VMware, Inc.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ **************************************************************************/
+
+/**
+ * @file
+ * Texture sampling -- specialized code for common sampler states.
+ *
+ * lp_build_sample_soa() handles every combination of wrap modes, filters,
+ * mipmapping and targets, which makes for a lot of IR even when sampling
+ * a single level 2D texture with clamp to edge wrapping, by far the most
+ * common case.  Here is a table of routines for such cases which skip
+ * everything not needed for them: no lod, no level selection, no wrap mode
+ * or border color handling.  The first routine whose state matches
+ * generates the code.
+ */
+
+#include "pipe/p_defines.h"
+#include "pipe/p_state.h"
+#include "util/u_debug.h"
+#include "util/u_format.h"
+#include "util/u_cpu_detect.h"
+#include "lp_bld_debug.h"
+#include "lp_bld_type.h"
+#include "lp_bld_const.h"
+#include "lp_bld_arit.h"
+#include "lp_bld_bitarit.h"
+#include "lp_bld_gather.h"
+#include "lp_bld_format.h"
+#include "lp_bld_sample.h"
+#include "lp_bld_sample_fast.h"
+
+
+/**
+ * The mipmap level being sampled, with its dimensions.
+ */
+struct lp_sample_fast_level
+{
+   LLVMValueRef data_ptr;
+   LLVMValueRef width;       /**< int_coord vector */
+   LLVMValueRef height;      /**< int_coord vector */
+   LLVMValueRef row_stride;  /**< int_coord vector */
+};
+
+
+struct lp_sample_fast_path
+{
+   const char *name;
+
+   boolean
+   (*match)(const struct lp_build_sample_context *bld);
+
+   void
+   (*build)(struct lp_build_sample_context *bld,
+            const struct lp_sample_fast_level *level,
+            LLVMValueRef s,
+            LLVMValueRef t,
+            LLVMValueRef texel_out[4]);
+};
+
+
+static boolean
+is_clamp_to_edge(const struct lp_static_sampler_state *sampler)
+{
+   return sampler->wrap_s == PIPE_TEX_WRAP_CLAMP_TO_EDGE &&
+          sampler->wrap_t == PIPE_TEX_WRAP_CLAMP_TO_EDGE &&
+          !sampler->force_nearest_s &&
+          !sampler->force_nearest_t;
+}
+
+
+/**
+ * Scale normalized coords by the level size.
+ * \param shift  number of fractional bits to keep
+ */
+static void
+sample_fast_unnormalize(struct lp_build_sample_context *bld,
+                        const struct lp_sample_fast_level *level,
+                        unsigned shift,
+                        LLVMValueRef *s,
+                        LLVMValueRef *t)
+{
+   struct lp_build_context *coord_bld = &bld->coord_bld;
+   struct lp_build_context *int_coord_bld = &bld->int_coord_bld;
+
+   if (bld->static_sampler_state->normalized_coords) {
+      LLVMValueRef width = level->width, height = level->height;
+
+      if (shift) {
+         width = lp_build_shl_imm(int_coord_bld, width, shift);
+         height = lp_build_shl_imm(int_coord_bld, height, shift);
+      }
+      *s = lp_build_mul(coord_bld, *s, lp_build_int_to_float(coord_bld, width));
+      *t = lp_build_mul(coord_bld, *t, lp_build_int_to_float(coord_bld, height));
+   }
+   else if (shift) {
+      *s = lp_build_mul_imm(coord_bld, *s, 1 << shift);
+      *t = lp_build_mul_imm(coord_bld, *t, 1 << shift);
+   }
+}
+
+
+static LLVMValueRef
+sample_fast_clamp(struct lp_build_sample_context *bld,
+                  LLVMValueRef coord,
+                  LLVMValueRef size)
+{
+   struct lp_build_context *int_coord_bld = &bld->int_coord_bld;
+   LLVMValueRef max = lp_build_sub(int_coord_bld, size, int_coord_bld->one);
+
+   return lp_build_clamp(int_coord_bld, coord, int_coord_bld->zero, max);
+}
+
+
+/**
+ * Fetch texels at integer coords, in SoA float (or int) form.
+ */
+static void
+sample_fast_fetch(struct lp_build_sample_context *bld,
+                  const struct lp_sample_fast_level *level,
+                  LLVMValueRef x,
+                  LLVMValueRef y,
+                  LLVMValueRef texel_out[4])
+{
+   LLVMValueRef offset, i, j;
+
+   lp_build_sample_offset(&bld->int_coord_bld,
+                          bld->format_desc,
+                          bld->static_texture_state->tiled,
+                          x, y, NULL, level->row_stride, NULL,
+                          &offset, &i, &j);
+
+   lp_build_fetch_rgba_soa(bld->gallivm,
+                           bld->format_desc,
+                           bld->texel_type, TRUE,
+                           level->data_ptr, offset,
+                           i, j,
+                           bld->cache,
+                           texel_out);
+}
+
+
+/*
+ * Nearest filtering, any format.
+ */
+
+static boolean
+match_nearest(const struct lp_build_sample_context *bld)
+{
+   const struct lp_static_sampler_state *sampler = bld->static_sampler_state;
+
+   /* CLAMP behaves like CLAMP_TO_EDGE with nearest filtering */
+   return sampler->min_img_filter == PIPE_TEX_FILTER_NEAREST &&
+          (sampler->wrap_s == PIPE_TEX_WRAP_CLAMP_TO_EDGE ||
+           sampler->wrap_s == PIPE_TEX_WRAP_CLAMP) &&
+          (sampler->wrap_t == PIPE_TEX_WRAP_CLAMP_TO_EDGE ||
+           sampler->wrap_t == PIPE_TEX_WRAP_CLAMP);
+}
+
+
+static void
+build_nearest(struct lp_build_sample_context *bld,
+              const struct lp_sample_fast_level *level,
+              LLVMValueRef s,
+              LLVMValueRef t,
+              LLVMValueRef texel_out[4])
+{
+   LLVMValueRef x, y;
+
+   sample_fast_unnormalize(bld, level, 0, &s, &t);
+
+   x = sample_fast_clamp(bld, lp_build_ifloor(&bld->coord_bld, s),
+                         level->width);
+   y = sample_fast_clamp(bld, lp_build_ifloor(&bld->coord_bld, t),
+                         level->height);
+
+   sample_fast_fetch(bld, level, x, y, texel_out);
+}
+
+
+/*
+ * Bilinear filtering of RGBA8 variants in 8 bit fixed point.
+ */
+
+static boolean
+match_linear_rgba8(const struct lp_build_sample_context *bld)
+{
+   const struct util_format_description *format_desc = bld->format_desc;
+   unsigned length = bld->texel_type.length;
+
+   /*
+    * Like the AoS path, only go 8-wide with AVX2, and never 16-wide as that
+    * would need 64 element vectors.
+    */
+   return bld->static_sampler_state->min_img_filter == PIPE_TEX_FILTER_LINEAR &&
+          is_clamp_to_edge(bld->static_sampler_state) &&
+          format_desc->layout == UTIL_FORMAT_LAYOUT_PLAIN &&
+          format_desc->colorspace == UTIL_FORMAT_COLORSPACE_RGB &&
+          util_format_is_rgba8_variant(format_desc) &&
+          (length == 4 || (length == 8 && util_cpu_caps.has_avx2));
+}
+
+
+/**
+ * Partial byte offset along one axis.
+ */
+static LLVMValueRef
+sample_fast_axis_offset(struct lp_build_sample_context *bld,
+                        unsigned axis,
+                        LLVMValueRef coord,
+                        LLVMValueRef stride)
+{
+   if (bld->static_texture_state->tiled) {
+      return lp_build_sample_tiled_partial_offset(&bld->int_coord_bld,
+                                                  bld->format_desc->block.bits / 8,
+                                                  axis, coord, stride);
+   }
+   return lp_build_mul(&bld->int_coord_bld, coord, stride);
+}
+
+
+static void
+build_linear_rgba8(struct lp_build_sample_context *bld,
+                   const struct lp_sample_fast_level *level,
+                   LLVMValueRef s,
+                   LLVMValueRef t,
+                   LLVMValueRef texel_out[4])
+{
+   struct gallivm_state *gallivm = bld->gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   struct lp_build_context *int_coord_bld = &bld->int_coord_bld;
+   struct lp_build_context u8n;
+   LLVMTypeRef u8n_vec_type;
+   LLVMValueRef c128, c255, splat;
+   LLVMValueRef x[2], y[2], x_offset[2], y_offset[2];
+   LLVMValueRef s_fpart, t_fpart;
+   LLVMValueRef texels[2][2]; /* [y][x] */
+   LLVMValueRef packed, unswizzled[4];
+   unsigned i, k;
+
+   lp_build_context_init(&u8n, gallivm, lp_type_unorm(8, bld->vector_width));
+   u8n_vec_type = lp_build_vec_type(gallivm, u8n.type);
+
+   /* 8 fractional bits, minus half a texel */
+   sample_fast_unnormalize(bld, level, 8, &s, &t);
+   c128 = lp_build_const_int_vec(gallivm, int_coord_bld->type, 128);
+   s = lp_build_sub(int_coord_bld, lp_build_iround(&bld->coord_bld, s), c128);
+   t = lp_build_sub(int_coord_bld, lp_build_iround(&bld->coord_bld, t), c128);
+
+   x[0] = lp_build_shr_imm(int_coord_bld, s, 8);
+   y[0] = lp_build_shr_imm(int_coord_bld, t, 8);
+   x[1] = lp_build_add(int_coord_bld, x[0], int_coord_bld->one);
+   y[1] = lp_build_add(int_coord_bld, y[0], int_coord_bld->one);
+
+   for (i = 0; i < 2; i++) {
+      x[i] = sample_fast_clamp(bld, x[i], level->width);
+      y[i] = sample_fast_clamp(bld, y[i], level->height);
+      x_offset[i] = sample_fast_axis_offset(bld, 0, x[i],
+                       lp_build_const_int_vec(gallivm, int_coord_bld->type,
+                                              bld->format_desc->block.bits / 8));
+      y_offset[i] = sample_fast_axis_offset(bld, 1, y[i], level->row_stride);
+   }
+
+   for (i = 0; i < 2; i++) {
+      for (k = 0; k < 2; k++) {
+         LLVMValueRef offset = lp_build_add(int_coord_bld,
+                                            x_offset[k], y_offset[i]);
+
+         /* read the pixels as is, swizzling is done at the end */
+         texels[i][k] = lp_build_gather(gallivm,
+                                        bld->texel_type.length,
+                                        bld->format_desc->block.bits,
+                                        lp_type_uint(bld->texel_type.width),
+                                        TRUE,
+                                        level->data_ptr, offset, TRUE);
+         texels[i][k] = LLVMBuildBitCast(builder, texels[i][k],
+                                         u8n_vec_type, "");
+      }
+   }
+
+   /*
+    * Replicate the 8 bit weights into all 4 bytes of each pixel with a
+    * multiplication, instead of shuffling.
+    */
+   c255 = lp_build_const_int_vec(gallivm, int_coord_bld->type, 255);
+   splat = lp_build_const_int_vec(gallivm, int_coord_bld->type, 0x01010101);
+   s_fpart = LLVMBuildAnd(builder, s, c255, "");
+   t_fpart = LLVMBuildAnd(builder, t, c255, "");
+   s_fpart = LLVMBuildMul(builder, s_fpart, splat, "");
+   t_fpart = LLVMBuildMul(builder, t_fpart, splat, "");
+   s_fpart = LLVMBuildBitCast(builder, s_fpart, u8n_vec_type, "");
+   t_fpart = LLVMBuildBitCast(builder, t_fpart, u8n_vec_type, "");
+
+   packed = lp_build_lerp_2d(&u8n, s_fpart, t_fpart,
+                             texels[0][0], texels[0][1],
+                             texels[1][0], texels[1][1],
+                             LP_BLD_LERP_PRESCALED_WEIGHTS);
+
+   lp_build_rgba8_to_fi32_soa(gallivm, bld->texel_type, packed, unswizzled);
+   lp_build_format_swizzle_soa(bld->format_desc, &bld->texel_bld,
+                               unswizzled, texel_out);
+}
+
+
+/*
+ * Bilinear filtering in floating point, any filterable format.
+ */
+
+static boolean
+match_linear(const struct lp_build_sample_context *bld)
+{
+   const struct util_format_description *format_desc = bld->format_desc;
+
+   /* 4-wide, formats which fit 8 bits are better off with the AoS path */
+   return bld->static_sampler_state->min_img_filter == PIPE_TEX_FILTER_LINEAR &&
+          is_clamp_to_edge(bld->static_sampler_state) &&
+          bld->texel_type.floating &&
+          !util_format_has_stencil(format_desc) &&
+          (!util_format_fits_8unorm(format_desc) ||
+           bld->texel_type.length > 4);
+}
+
+
+static void
+build_linear(struct lp_build_sample_context *bld,
+             const struct lp_sample_fast_level *level,
+             LLVMValueRef s,
+             LLVMValueRef t,
+             LLVMValueRef texel_out[4])
+{
+   struct lp_build_context *coord_bld = &bld->coord_bld;
+   struct lp_build_context *int_coord_bld = &bld->int_coord_bld;
+   LLVMValueRef half = lp_build_const_vec(bld->gallivm, coord_bld->type, 0.5);
+   LLVMValueRef x[2], y[2], s_fpart, t_fpart;
+   LLVMValueRef texels[2][2][4]; /* [y][x][chan] */
+   unsigned i, k, chan;
+
+   sample_fast_unnormalize(bld, level, 0, &s, &t);
+
+   lp_build_ifloor_fract(coord_bld, lp_build_sub(coord_bld, s, half),
+                         &x[0], &s_fpart);
+   lp_build_ifloor_fract(coord_bld, lp_build_sub(coord_bld, t, half),
+                         &y[0], &t_fpart);
+   x[1] = lp_build_add(int_coord_bld, x[0], int_coord_bld->one);
+   y[1] = lp_build_add(int_coord_bld, y[0], int_coord_bld->one);
+
+   for (i = 0; i < 2; i++) {
+      x[i] = sample_fast_clamp(bld, x[i], level->width);
+      y[i] = sample_fast_clamp(bld, y[i], level->height);
+   }
+
+   for (i = 0; i < 2; i++) {
+      for (k = 0; k < 2; k++) {
+         sample_fast_fetch(bld, level, x[k], y[i], texels[i][k]);
+      }
+   }
+
+   for (chan = 0; chan < 4; chan++) {
+      texel_out[chan] = lp_build_lerp_2d(&bld->texel_bld, s_fpart, t_fpart,
+                                         texels[0][0][chan], texels[0][1][chan],
+                                         texels[1][0][chan], texels[1][1][chan],
+                                         0);
+   }
+}
+
+
+/**
+ * In order of preference.
+ */
+static const struct lp_sample_fast_path
+sample_fast_paths[] = {
+   { "nearest", match_nearest, build_nearest },
+   { "linear_rgba8", match_linear_rgba8, build_linear_rgba8 },
+   { "linear", match_linear, build_linear },
+};
+
+
+/**
+ * Generate specialized sampling code if the sampler and texture state
+ * allow it.
+ *
+ * Only handles plain texture sampling (not fetches, gathers or lod
+ * queries), and expects bld to have been set up by lp_build_sample_soa.
+ * The format swizzle is left to the caller.
+ *
+ * \return TRUE if code was generated, FALSE to use the generic paths
+ */
+boolean
+lp_build_sample_fast(struct lp_build_sample_context *bld,
+                     unsigned texture_index,
+                     const LLVMValueRef *coords,
+                     const LLVMValueRef *offsets,
+                     LLVMValueRef texel_out[4])
+{
+   const struct lp_static_texture_state *texture = bld->static_texture_state;
+   const struct lp_static_sampler_state *sampler = bld->static_sampler_state;
+   const struct lp_sample_fast_path *path = NULL;
+   struct lp_sample_fast_level level;
+   LLVMValueRef ilevel, size, row_stride_vec, img_stride_vec, depth;
+   unsigned i;
+
+   if (gallivm_debug & GALLIVM_DEBUG_NO_FAST_SAMPLE)
+      return FALSE;
+
+   /*
+    * A single 2D level, one filter and no texel offsets: the lod doesn't
+    * matter and the level is always the first one of the view.
+    */
+   if ((texture->target != PIPE_TEXTURE_2D &&
+        texture->target != PIPE_TEXTURE_RECT) ||
+       offsets[0] ||
+       sampler->compare_mode != PIPE_TEX_COMPARE_NONE ||
+       sampler->min_mip_filter != PIPE_TEX_MIPFILTER_NONE ||
+       sampler->min_img_filter != sampler->mag_img_filter ||
+       bld->num_mips != 1) {
+      return FALSE;
+   }
+
+   for (i = 0; i < ARRAY_SIZE(sample_fast_paths); i++) {
+      if (sample_fast_paths[i].match(bld)) {
+         path = &sample_fast_paths[i];
+         break;
+      }
+   }
+
+   if (!path)
+      return FALSE;
+
+   if (gallivm_debug & GALLIVM_DEBUG_PERF) {
+      debug_printf("%s: using %s sampling for %s\n",
+                   __FUNCTION__, path->name, bld->format_desc->short_name);
+   }
+
+   ilevel = bld->dynamic_state->first_level(bld->dynamic_state, bld->gallivm,
+                                            bld->context_ptr, texture_index);
+   lp_build_mipmap_level_sizes(bld, ilevel, &size,
+                               &row_stride_vec, &img_stride_vec);
+   lp_build_extract_image_sizes(bld, &bld->int_size_bld,
+                                bld->int_coord_type, size,
+                                &level.width, &level.height, &depth);
+   level.row_stride = row_stride_vec;
+   level.data_ptr = lp_build_get_mipmap_level(bld, ilevel);
+
+   path->build(bld, &level, coords[0], coords[1], texel_out);
+
+   return TRUE;
+}
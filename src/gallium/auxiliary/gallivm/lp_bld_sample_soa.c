@@ -57,6 +57,7 @@
 #include "lp_bld_format.h"
 #include "lp_bld_sample.h"
 #include "lp_bld_sample_aos.h"
+#include "lp_bld_sample_fast.h"
 #include "lp_bld_struct.h"
 #include "lp_bld_quad.h"
 #include "lp_bld_pack.h"
@@ -139,6 +140,7 @@ lp_build_sample_texel_soa(struct lp_build_sample_context *bld,
    /* convert x,y,z coords to linear offset from start of texture, in bytes */
    lp_build_sample_offset(&bld->int_coord_bld,
                           bld->format_desc,
+                          bld->static_texture_state->tiled,
                           x, y, z, y_stride, z_stride,
                           &offset, &i, &j);
    if (mipoffsets) {
@@ -2673,6 +2675,7 @@ lp_build_fetch_texel(struct lp_build_sample_context *bld,
 
    lp_build_sample_offset(int_coord_bld,
                           bld->format_desc,
+                          bld->static_texture_state->tiled,
                           x, y, z, row_stride_vec, img_stride_vec,
                           &offset, &i, &j);
 
@@ -3098,6 +3101,12 @@ lp_build_sample_soa_code(struct gallivm_state *gallivm,
                            texel_out);
    }
 
+   else if (op_is_tex &&
+            lp_build_sample_fast(&bld, texture_index, newcoords, offsets,
+                                 texel_out)) {
+      /* specialized code for a common sampler state was generated */
+   }
+
    else {
       LLVMValueRef lod_fpart = NULL, lod_positive = NULL;
       LLVMValueRef ilevel0 = NULL, ilevel1 = NULL, lod = NULL;
@@ -3166,9 +3175,11 @@ lp_build_sample_soa_code(struct gallivm_state *gallivm,
       /*
        * we only try 8-wide sampling with soa or if we have AVX2
        * as it appears to be a loss with just AVX)
+       * 16-wide aos isn't tried at all, the packed 8-bit texels would
+       * need 64 element vectors.
        */
       if (num_quads == 1 || !use_aos ||
-          (util_cpu_caps.has_avx2 &&
+          (util_cpu_caps.has_avx2 && num_quads <= 2 &&
            (bld.num_lods == 1 ||
             derived_sampler_state.min_img_filter == derived_sampler_state.mag_img_filter))) {
          if (use_aos) {
@@ -67,6 +67,9 @@ struct lp_build_mask_context;
 struct gallivm_state;
 struct lp_derivatives;
 struct lp_build_tgsi_gs_iface;
+struct lp_build_tgsi_cs_iface;
+struct lp_build_tgsi_tess_iface;
+struct lp_build_tgsi_context;
 
 
 enum lp_build_tex_modifier {
@@ -170,6 +173,16 @@ struct lp_bld_tgsi_system_values {
    LLVMValueRef prim_id;
    LLVMValueRef basevertex;
    LLVMValueRef invocation_id;
+   /* Tessellation shaders: tess_coord is a vector, the others are scalars */
+   LLVMValueRef vertices_in;
+   LLVMValueRef tess_coord[3];
+   LLVMValueRef tess_outer[4];
+   LLVMValueRef tess_inner[2];
+   /* Compute shaders: thread_id is a vector, the others are scalars */
+   LLVMValueRef thread_id[3];
+   LLVMValueRef block_id[3];
+   LLVMValueRef grid_size[3];
+   LLVMValueRef block_size[3];
 };
 
 
@@ -230,7 +243,13 @@ lp_build_tgsi_soa(struct gallivm_state *gallivm,
                   LLVMValueRef thread_data_ptr,
                   struct lp_build_sampler_soa *sampler,
                   const struct tgsi_shader_info *info,
-                  const struct lp_build_tgsi_gs_iface *gs_iface);
+                  const struct lp_build_tgsi_gs_iface *gs_iface,
+                  const struct lp_build_tgsi_cs_iface *cs_iface,
+                  const struct lp_build_tgsi_tess_iface *tess_iface);
+
+unsigned
+lp_build_tgsi_soa_temps_size(const struct tgsi_shader_info *info,
+                             struct lp_type type);
 
 
 void
@@ -306,6 +325,48 @@ struct lp_exec_mask {
    int function_stack_size;
 };
 
+/*
+ * Execution mask helpers, shared by the TGSI and NIR SoA translators.
+ */
+
+void
+lp_exec_mask_init(struct lp_exec_mask *mask, struct lp_build_context *bld);
+
+void
+lp_exec_mask_fini(struct lp_exec_mask *mask);
+
+void
+lp_exec_mask_update(struct lp_exec_mask *mask);
+
+void
+lp_exec_mask_cond_push(struct lp_exec_mask *mask, LLVMValueRef val);
+
+void
+lp_exec_mask_cond_invert(struct lp_exec_mask *mask);
+
+void
+lp_exec_mask_cond_pop(struct lp_exec_mask *mask);
+
+void
+lp_exec_bgnloop(struct lp_exec_mask *mask);
+
+void
+lp_exec_break(struct lp_exec_mask *mask,
+              struct lp_build_tgsi_context *bld_base);
+
+void
+lp_exec_continue(struct lp_exec_mask *mask);
+
+void
+lp_exec_endloop(struct gallivm_state *gallivm,
+                struct lp_exec_mask *mask);
+
+void
+lp_exec_mask_store(struct lp_exec_mask *mask,
+                   struct lp_build_context *bld_store,
+                   LLVMValueRef val,
+                   LLVMValueRef dst_ptr);
+
 struct lp_build_tgsi_inst_list
 {
    struct tgsi_full_instruction *instructions;
@@ -398,6 +459,12 @@ struct lp_build_tgsi_context
      */
    void (*emit_prologue)(struct lp_build_tgsi_context*);
 
+   /** Like emit_prologue, but called once all the declarations and
+     * immediates have been emitted, right before the first instruction.
+     * It is optional as well.
+     */
+   void (*emit_prologue_post_decl)(struct lp_build_tgsi_context*);
+
    /** This function allows the user to insert some instructions at the end of
      * the program.  This callback is intended to be used for emitting
      * instructions to handle the export for the output registers, but it can
@@ -430,6 +497,71 @@ struct lp_build_tgsi_gs_iface
                        LLVMValueRef emitted_prims_vec);
 };
 
+/**
+ * Compute shader memory.
+ *
+ * A shader that contains barriers is split into phases at every barrier.
+ * The caller runs phase N for all the invocations of a block before
+ * running phase N + 1 for any of them, passing the phase number in
+ * 'phase'.  Only barriers in main, outside of control flow and before any
+ * RET, can split phases: the caller must not build shaders with others.
+ * The temporaries then have to survive from one phase to the next, so
+ * they live in 'temps_ptr', which is private to each group of invocations,
+ * rather than on the stack.
+ */
+struct lp_build_tgsi_cs_iface
+{
+   LLVMValueRef shared_ptr;      /**< i8 *, the block's shared memory */
+   LLVMValueRef shared_size;     /**< i32, its size in bytes */
+   LLVMValueRef ssbo_ptr;        /**< [N x i32 *] *, buffer base pointers */
+   LLVMValueRef ssbo_sizes_ptr;  /**< [N x i32] *, buffer sizes in bytes */
+   LLVMValueRef phase;           /**< i32, or NULL if no barriers */
+   LLVMValueRef temps_ptr;       /**< i8 *, or NULL if no barriers */
+};
+
+/**
+ * Tessellation control and evaluation shader inputs and outputs.
+ *
+ * Per-vertex inputs (2D INPUT registers) come from fetch_vertex_input,
+ * per-patch inputs from fetch_patch_input.  A control shader's outputs are
+ * shared by all the invocations of a patch, so they are not kept in
+ * registers: every OUTPUT write goes through emit_store_output and every
+ * OUTPUT read through fetch_output, with vertex_index NULL for per-patch
+ * outputs.  emit_store_output is NULL for an evaluation shader, whose
+ * outputs are ordinary registers.
+ */
+struct lp_build_tgsi_tess_iface
+{
+   LLVMValueRef (*fetch_vertex_input)(const struct lp_build_tgsi_tess_iface *tess_iface,
+                                      struct lp_build_tgsi_context * bld_base,
+                                      boolean is_vindex_indirect,
+                                      LLVMValueRef vertex_index,
+                                      boolean is_aindex_indirect,
+                                      LLVMValueRef attrib_index,
+                                      LLVMValueRef swizzle_index);
+   LLVMValueRef (*fetch_patch_input)(const struct lp_build_tgsi_tess_iface *tess_iface,
+                                     struct lp_build_tgsi_context * bld_base,
+                                     boolean is_aindex_indirect,
+                                     LLVMValueRef attrib_index,
+                                     LLVMValueRef swizzle_index);
+   LLVMValueRef (*fetch_output)(const struct lp_build_tgsi_tess_iface *tess_iface,
+                                struct lp_build_tgsi_context * bld_base,
+                                boolean is_vindex_indirect,
+                                LLVMValueRef vertex_index,
+                                boolean is_aindex_indirect,
+                                LLVMValueRef attrib_index,
+                                LLVMValueRef swizzle_index);
+   void (*emit_store_output)(const struct lp_build_tgsi_tess_iface *tess_iface,
+                             struct lp_build_tgsi_context * bld_base,
+                             boolean is_vindex_indirect,
+                             LLVMValueRef vertex_index,
+                             boolean is_aindex_indirect,
+                             LLVMValueRef attrib_index,
+                             LLVMValueRef swizzle_index,
+                             LLVMValueRef value,
+                             LLVMValueRef mask_vec);
+};
+
 struct lp_build_tgsi_soa_context
 {
    struct lp_build_tgsi_context bld_base;
@@ -438,6 +570,8 @@ struct lp_build_tgsi_soa_context
    struct lp_build_context elem_bld;
 
    const struct lp_build_tgsi_gs_iface *gs_iface;
+   const struct lp_build_tgsi_cs_iface *cs_iface;
+   const struct lp_build_tgsi_tess_iface *tess_iface;
    LLVMValueRef emitted_prims_vec_ptr;
    LLVMValueRef total_emitted_vertices_vec_ptr;
    LLVMValueRef emitted_vertices_vec_ptr;
@@ -447,6 +581,8 @@ struct lp_build_tgsi_soa_context
    LLVMValueRef const_sizes_ptr;
    LLVMValueRef consts[LP_MAX_TGSI_CONST_BUFFERS];
    LLVMValueRef consts_sizes[LP_MAX_TGSI_CONST_BUFFERS];
+   LLVMValueRef ssbos[LP_MAX_TGSI_SHADER_BUFFERS];
+   LLVMValueRef ssbo_sizes[LP_MAX_TGSI_SHADER_BUFFERS];
    const LLVMValueRef (*inputs)[TGSI_NUM_CHANNELS];
    LLVMValueRef (*outputs)[TGSI_NUM_CHANNELS];
    LLVMValueRef context_ptr;
@@ -494,6 +630,14 @@ struct lp_build_tgsi_soa_context
 
    uint num_immediates;
    boolean use_immediates_array;
+
+   /* Compute shader phases, see lp_build_tgsi_cs_iface */
+   LLVMValueRef phase_switch;
+   LLVMBasicBlockRef phase_end_block;
+   unsigned num_phases;
+
+   /** Where masked off lanes of memory stores and atomics go */
+   LLVMValueRef scratch_ptr;
 };
 
 void
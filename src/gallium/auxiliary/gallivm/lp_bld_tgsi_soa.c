@@ -195,7 +195,7 @@ lp_exec_mask_function_init(struct lp_exec_mask *mask, int function_idx)
       ctx->loop_limiter);
 }
 
-static void lp_exec_mask_init(struct lp_exec_mask *mask, struct lp_build_context *bld)
+void lp_exec_mask_init(struct lp_exec_mask *mask, struct lp_build_context *bld)
 {
    mask->bld = bld;
    mask->has_mask = FALSE;
@@ -213,13 +213,13 @@ static void lp_exec_mask_init(struct lp_exec_mask *mask, struct lp_build_context
    lp_exec_mask_function_init(mask, 0);
 }
 
-static void
+void
 lp_exec_mask_fini(struct lp_exec_mask *mask)
 {
    FREE(mask->function_stack);
 }
 
-static void lp_exec_mask_update(struct lp_exec_mask *mask)
+void lp_exec_mask_update(struct lp_exec_mask *mask)
 {
    LLVMBuilderRef builder = mask->bld->gallivm->builder;
    boolean has_loop_mask = mask_has_loop(mask);
@@ -263,8 +263,8 @@ static void lp_exec_mask_update(struct lp_exec_mask *mask)
                      has_ret_mask);
 }
 
-static void lp_exec_mask_cond_push(struct lp_exec_mask *mask,
-                                   LLVMValueRef val)
+void lp_exec_mask_cond_push(struct lp_exec_mask *mask,
+                            LLVMValueRef val)
 {
    LLVMBuilderRef builder = mask->bld->gallivm->builder;
    struct function_ctx *ctx = func_ctx(mask);
@@ -285,7 +285,7 @@ static void lp_exec_mask_cond_push(struct lp_exec_mask *mask,
    lp_exec_mask_update(mask);
 }
 
-static void lp_exec_mask_cond_invert(struct lp_exec_mask *mask)
+void lp_exec_mask_cond_invert(struct lp_exec_mask *mask)
 {
    LLVMBuilderRef builder = mask->bld->gallivm->builder;
    struct function_ctx *ctx = func_ctx(mask);
@@ -308,7 +308,7 @@ static void lp_exec_mask_cond_invert(struct lp_exec_mask *mask)
    lp_exec_mask_update(mask);
 }
 
-static void lp_exec_mask_cond_pop(struct lp_exec_mask *mask)
+void lp_exec_mask_cond_pop(struct lp_exec_mask *mask)
 {
    struct function_ctx *ctx = func_ctx(mask);
    assert(ctx->cond_stack_size);
@@ -319,7 +319,7 @@ static void lp_exec_mask_cond_pop(struct lp_exec_mask *mask)
    lp_exec_mask_update(mask);
 }
 
-static void lp_exec_bgnloop(struct lp_exec_mask *mask)
+void lp_exec_bgnloop(struct lp_exec_mask *mask)
 {
    LLVMBuilderRef builder = mask->bld->gallivm->builder;
    struct function_ctx *ctx = func_ctx(mask);
@@ -352,8 +352,8 @@ static void lp_exec_bgnloop(struct lp_exec_mask *mask)
    lp_exec_mask_update(mask);
 }
 
-static void lp_exec_break(struct lp_exec_mask *mask,
-                          struct lp_build_tgsi_context * bld_base)
+void lp_exec_break(struct lp_exec_mask *mask,
+                   struct lp_build_tgsi_context * bld_base)
 {
    LLVMBuilderRef builder = mask->bld->gallivm->builder;
    struct function_ctx *ctx = func_ctx(mask);
@@ -402,7 +402,7 @@ static void lp_exec_break(struct lp_exec_mask *mask,
    lp_exec_mask_update(mask);
 }
 
-static void lp_exec_continue(struct lp_exec_mask *mask)
+void lp_exec_continue(struct lp_exec_mask *mask)
 {
    LLVMBuilderRef builder = mask->bld->gallivm->builder;
    LLVMValueRef exec_mask = LLVMBuildNot(builder,
@@ -417,8 +417,8 @@ static void lp_exec_continue(struct lp_exec_mask *mask)
 }
 
 
-static void lp_exec_endloop(struct gallivm_state *gallivm,
-                            struct lp_exec_mask *mask)
+void lp_exec_endloop(struct gallivm_state *gallivm,
+                     struct lp_exec_mask *mask)
 {
    LLVMBuilderRef builder = mask->bld->gallivm->builder;
    struct function_ctx *ctx = func_ctx(mask);
@@ -727,10 +727,10 @@ static void lp_exec_default(struct lp_exec_mask *mask,
  * should be stored into the address
  * (0 means don't store this bit, 1 means do store).
  */
-static void lp_exec_mask_store(struct lp_exec_mask *mask,
-                               struct lp_build_context *bld_store,
-                               LLVMValueRef val,
-                               LLVMValueRef dst_ptr)
+void lp_exec_mask_store(struct lp_exec_mask *mask,
+                        struct lp_build_context *bld_store,
+                        LLVMValueRef val,
+                        LLVMValueRef dst_ptr)
 {
    LLVMBuilderRef builder = mask->bld->gallivm->builder;
    LLVMValueRef exec_mask = mask->has_mask ? mask->exec_mask : NULL;
@@ -1045,9 +1045,10 @@ emit_mask_scatter(struct lp_build_tgsi_soa_context *bld,
  * temporary register file.
  */
 static LLVMValueRef
-get_indirect_index(struct lp_build_tgsi_soa_context *bld,
-                   unsigned reg_file, unsigned reg_index,
-                   const struct tgsi_ind_register *indirect_reg)
+get_indirect_index_limit(struct lp_build_tgsi_soa_context *bld,
+                         unsigned reg_file, unsigned reg_index,
+                         const struct tgsi_ind_register *indirect_reg,
+                         int index_limit)
 {
    LLVMBuilderRef builder = bld->bld_base.base.gallivm->builder;
    struct lp_build_context *uint_bld = &bld->bld_base.uint_bld;
@@ -1084,6 +1085,23 @@ get_indirect_index(struct lp_build_tgsi_soa_context *bld,
 
    index = lp_build_add(uint_bld, base, rel);
 
+   if (index_limit >= 0) {
+      max_index = lp_build_const_int_vec(bld->bld_base.base.gallivm,
+                                         uint_bld->type,
+                                         index_limit);
+
+      assert(!uint_bld->type.sign);
+      index = lp_build_min(uint_bld, index, max_index);
+   }
+
+   return index;
+}
+
+static LLVMValueRef
+get_indirect_index(struct lp_build_tgsi_soa_context *bld,
+                   unsigned reg_file, unsigned reg_index,
+                   const struct tgsi_ind_register *indirect_reg)
+{
    /*
     * emit_fetch_constant handles constant buffer overflow so this code
     * is pointless for them.
@@ -1093,16 +1111,11 @@ get_indirect_index(struct lp_build_tgsi_soa_context *bld,
     * to return incorrect data (not necessarily 0) for indices that are
     * larger than the declared size but smaller than the buffer size.
     */
-   if (reg_file != TGSI_FILE_CONSTANT) {
-      max_index = lp_build_const_int_vec(bld->bld_base.base.gallivm,
-                                         uint_bld->type,
-                                         bld->bld_base.info->file_max[reg_file]);
-
-      assert(!uint_bld->type.sign);
-      index = lp_build_min(uint_bld, index, max_index);
-   }
+   int index_limit = reg_file == TGSI_FILE_CONSTANT ?
+      -1 : bld->bld_base.info->file_max[reg_file];
 
-   return index;
+   return get_indirect_index_limit(bld, reg_file, reg_index, indirect_reg,
+                                   index_limit);
 }
 
 static struct lp_build_context *
@@ -1533,6 +1546,120 @@ emit_fetch_gs_input(
    return res;
 }
 
+/**
+ * Register indices of a tessellation shader input or output.  Sets
+ * *vertex_index to NULL for a per-patch register, which has no dimension.
+ */
+static void
+get_tess_indices(
+   struct lp_build_tgsi_soa_context *bld,
+   unsigned file,
+   unsigned index,
+   boolean is_indirect,
+   const struct tgsi_ind_register *indirect,
+   boolean has_dimension,
+   const struct tgsi_dimension *dim,
+   const struct tgsi_ind_register *dim_indirect,
+   LLVMValueRef *attrib_index,
+   LLVMValueRef *vertex_index)
+{
+   struct gallivm_state *gallivm = bld->bld_base.base.gallivm;
+
+   if (is_indirect) {
+      *attrib_index = get_indirect_index(bld, file, index, indirect);
+   } else {
+      *attrib_index = lp_build_const_int32(gallivm, index);
+   }
+
+   if (!has_dimension) {
+      *vertex_index = NULL;
+   } else if (dim->Indirect) {
+      /* bounded by the patch size, not by the register file */
+      int vertex_limit = file == TGSI_FILE_OUTPUT ?
+         bld->bld_base.info->properties[TGSI_PROPERTY_TCS_VERTICES_OUT] - 1 :
+         LP_MAX_TESS_PATCH_VERTICES - 1;
+      *vertex_index = get_indirect_index_limit(bld, file, dim->Index,
+                                               dim_indirect, vertex_limit);
+   } else {
+      *vertex_index = lp_build_const_int32(gallivm, dim->Index);
+   }
+}
+
+static LLVMValueRef
+emit_fetch_tess_reg(
+   struct lp_build_tgsi_context * bld_base,
+   const struct tgsi_full_src_register * reg,
+   unsigned swizzle,
+   LLVMValueRef attrib_index,
+   LLVMValueRef vertex_index)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+   const struct lp_build_tgsi_tess_iface *tess_iface = bld->tess_iface;
+   LLVMValueRef swizzle_index =
+      lp_build_const_int32(bld_base->base.gallivm, swizzle);
+
+   if (reg->Register.File == TGSI_FILE_OUTPUT) {
+      return tess_iface->fetch_output(tess_iface, bld_base,
+                                      reg->Dimension.Indirect,
+                                      vertex_index,
+                                      reg->Register.Indirect,
+                                      attrib_index,
+                                      swizzle_index);
+   } else if (vertex_index) {
+      return tess_iface->fetch_vertex_input(tess_iface, bld_base,
+                                            reg->Dimension.Indirect,
+                                            vertex_index,
+                                            reg->Register.Indirect,
+                                            attrib_index,
+                                            swizzle_index);
+   } else {
+      return tess_iface->fetch_patch_input(tess_iface, bld_base,
+                                           reg->Register.Indirect,
+                                           attrib_index,
+                                           swizzle_index);
+   }
+}
+
+/**
+ * Fetch a tessellation shader input, or a control shader output, through
+ * lp_build_tgsi_tess_iface.
+ */
+static LLVMValueRef
+emit_fetch_tess(
+   struct lp_build_tgsi_context * bld_base,
+   const struct tgsi_full_src_register * reg,
+   enum tgsi_opcode_type stype,
+   unsigned swizzle)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+   LLVMBuilderRef builder = bld_base->base.gallivm->builder;
+   LLVMValueRef attrib_index, vertex_index;
+   LLVMValueRef res;
+
+   get_tess_indices(bld, reg->Register.File, reg->Register.Index,
+                    reg->Register.Indirect, &reg->Indirect,
+                    reg->Register.Dimension, &reg->Dimension,
+                    &reg->DimIndirect,
+                    &attrib_index, &vertex_index);
+
+   res = emit_fetch_tess_reg(bld_base, reg, swizzle,
+                             attrib_index, vertex_index);
+   assert(res);
+
+   if (tgsi_type_is_64bit(stype)) {
+      LLVMValueRef res2 = emit_fetch_tess_reg(bld_base, reg, swizzle + 1,
+                                              attrib_index, vertex_index);
+      assert(res2);
+      res = emit_fetch_64bit(bld_base, stype, res, res2);
+   } else if (stype == TGSI_TYPE_UNSIGNED) {
+      res = LLVMBuildBitCast(builder, res, bld_base->uint_bld.vec_type, "");
+   } else if (stype == TGSI_TYPE_SIGNED) {
+      res = LLVMBuildBitCast(builder, res, bld_base->int_bld.vec_type, "");
+   }
+
+   return res;
+}
+
 static LLVMValueRef
 emit_fetch_temporary(
    struct lp_build_tgsi_context * bld_base,
@@ -1647,6 +1774,57 @@ emit_fetch_system_value(
       atype = TGSI_TYPE_UNSIGNED;
       break;
 
+   case TGSI_SEMANTIC_VERTICESIN:
+      res = lp_build_broadcast_scalar(&bld_base->uint_bld, bld->system_values.vertices_in);
+      atype = TGSI_TYPE_UNSIGNED;
+      break;
+
+   case TGSI_SEMANTIC_TESSCOORD:
+      res = swizzle < 3 ? bld->system_values.tess_coord[swizzle]
+                        : bld_base->base.zero;
+      atype = TGSI_TYPE_FLOAT;
+      break;
+
+   case TGSI_SEMANTIC_TESSOUTER:
+      res = lp_build_broadcast_scalar(&bld_base->base,
+                                      bld->system_values.tess_outer[swizzle]);
+      atype = TGSI_TYPE_FLOAT;
+      break;
+
+   case TGSI_SEMANTIC_TESSINNER:
+      res = swizzle < 2 ? lp_build_broadcast_scalar(&bld_base->base,
+                                                    bld->system_values.tess_inner[swizzle])
+                        : bld_base->base.zero;
+      atype = TGSI_TYPE_FLOAT;
+      break;
+
+   case TGSI_SEMANTIC_THREAD_ID:
+      res = swizzle < 3 ? bld->system_values.thread_id[swizzle]
+                        : bld_base->uint_bld.zero;
+      atype = TGSI_TYPE_UNSIGNED;
+      break;
+
+   case TGSI_SEMANTIC_BLOCK_ID:
+      res = swizzle < 3 ? lp_build_broadcast_scalar(&bld_base->uint_bld,
+                                                    bld->system_values.block_id[swizzle])
+                        : bld_base->uint_bld.zero;
+      atype = TGSI_TYPE_UNSIGNED;
+      break;
+
+   case TGSI_SEMANTIC_GRID_SIZE:
+      res = swizzle < 3 ? lp_build_broadcast_scalar(&bld_base->uint_bld,
+                                                    bld->system_values.grid_size[swizzle])
+                        : bld_base->uint_bld.zero;
+      atype = TGSI_TYPE_UNSIGNED;
+      break;
+
+   case TGSI_SEMANTIC_BLOCK_SIZE:
+      res = swizzle < 3 ? lp_build_broadcast_scalar(&bld_base->uint_bld,
+                                                    bld->system_values.block_size[swizzle])
+                        : bld_base->uint_bld.zero;
+      atype = TGSI_TYPE_UNSIGNED;
+      break;
+
    default:
       assert(!"unexpected semantic in emit_fetch_system_value");
       res = bld_base->base.zero;
@@ -1733,6 +1911,9 @@ emit_store_64bit_chan(struct lp_build_tgsi_context *bld_base,
    lp_exec_mask_store(&bld->exec_mask, float_bld, temp2, chan_ptr2);
 }
 
+static LLVMValueRef
+mask_vec(struct lp_build_tgsi_context *bld_base);
+
 /**
  * Register store.
  */
@@ -1789,7 +1970,25 @@ emit_store_chan(
       /* Outputs are always stored as floats */
       value = LLVMBuildBitCast(builder, value, float_bld->vec_type, "");
 
-      if (reg->Register.Indirect) {
+      if (bld->tess_iface && bld->tess_iface->emit_store_output) {
+         LLVMValueRef attrib_index, vertex_index;
+
+         assert(!tgsi_type_is_64bit(dtype));
+         get_tess_indices(bld, reg->Register.File, reg->Register.Index,
+                          reg->Register.Indirect, &reg->Indirect,
+                          reg->Register.Dimension, &reg->Dimension,
+                          &reg->DimIndirect,
+                          &attrib_index, &vertex_index);
+         bld->tess_iface->emit_store_output(bld->tess_iface, bld_base,
+                                            reg->Dimension.Indirect,
+                                            vertex_index,
+                                            reg->Register.Indirect,
+                                            attrib_index,
+                                            lp_build_const_int32(gallivm, chan_index),
+                                            value,
+                                            mask_vec(bld_base));
+      }
+      else if (reg->Register.Indirect) {
          LLVMValueRef index_vec;  /* indexes into the output registers */
          LLVMValueRef outputs_array;
          LLVMTypeRef fptr_type;
@@ -2850,6 +3049,9 @@ lp_emit_declaration_soa(
       break;
 
    case TGSI_FILE_OUTPUT:
+      /* tessellation control shader outputs are not kept in registers */
+      if (bld->tess_iface && bld->tess_iface->emit_store_output)
+         break;
       if (!(bld->indirect_files & (1 << TGSI_FILE_OUTPUT))) {
          for (idx = first; idx <= last; ++idx) {
             for (i = 0; i < TGSI_NUM_CHANNELS; i++)
@@ -2904,6 +3106,21 @@ lp_emit_declaration_soa(
    }
       break;
 
+   case TGSI_FILE_BUFFER:
+      /* Same as for constants, fetch the pointers just once */
+      if (bld->cs_iface && bld->cs_iface->ssbo_ptr) {
+         assert(last < LP_MAX_TGSI_SHADER_BUFFERS);
+         for (idx = first; idx <= last; ++idx) {
+            LLVMValueRef index = lp_build_const_int32(gallivm, idx);
+            bld->ssbos[idx] =
+               lp_build_array_get(gallivm, bld->cs_iface->ssbo_ptr, index);
+            bld->ssbo_sizes[idx] =
+               lp_build_array_get(gallivm, bld->cs_iface->ssbo_sizes_ptr,
+                                  index);
+         }
+      }
+      break;
+
    default:
       /* don't need to declare other vars */
       break;
@@ -3639,12 +3856,392 @@ cont_emit(
    lp_exec_continue(&bld->exec_mask);
 }
 
+/**
+ * Lanes that memory writes apply to: the live invocations that aren't
+ * disabled by control flow.
+ */
+static LLVMValueRef
+get_memory_write_mask(struct lp_build_tgsi_context *bld_base)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+
+   if (bld->mask)
+      return mask_vec(bld_base);
+   if (bld->exec_mask.has_mask)
+      return bld->exec_mask.exec_mask;
+   return LLVMConstAllOnes(bld_base->uint_bld.vec_type);
+}
+
+/**
+ * Base pointer, as an i32 pointer, and size in 32-bit elements of the
+ * buffer or shared memory a LOAD, STORE or atomic instruction accesses.
+ * Returns FALSE if the resource isn't available to the shader.
+ */
+static boolean
+get_memory_resource(struct lp_build_tgsi_soa_context *bld,
+                    unsigned file, unsigned index, boolean indirect,
+                    LLVMValueRef *base_ptr,
+                    LLVMValueRef *num_elems)
+{
+   struct gallivm_state *gallivm = bld->bld_base.base.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMTypeRef i32_ptr_type =
+      LLVMPointerType(LLVMInt32TypeInContext(gallivm->context), 0);
+   LLVMValueRef ptr, size;
+
+   if (indirect || !bld->cs_iface)
+      return FALSE;
+
+   switch (file) {
+   case TGSI_FILE_BUFFER:
+      if (index >= LP_MAX_TGSI_SHADER_BUFFERS || !bld->ssbos[index])
+         return FALSE;
+      ptr = bld->ssbos[index];
+      size = bld->ssbo_sizes[index];
+      break;
+   case TGSI_FILE_MEMORY:
+      if (!bld->cs_iface->shared_ptr)
+         return FALSE;
+      ptr = bld->cs_iface->shared_ptr;
+      size = bld->cs_iface->shared_size;
+      break;
+   default:
+      return FALSE;
+   }
+
+   *base_ptr = LLVMBuildBitCast(builder, ptr, i32_ptr_type, "");
+   *num_elems = LLVMBuildLShr(builder, size,
+                              lp_build_const_int32(gallivm, 2), "");
+   return TRUE;
+}
+
+/**
+ * Pointers to the elements at 'indexes' of each lane, or to a scratch
+ * location for the lanes which are off in 'mask', so that stores and
+ * atomics don't need any control flow.
+ */
+static LLVMValueRef
+get_lane_ptr(struct lp_build_tgsi_soa_context *bld,
+             LLVMValueRef base_ptr,
+             LLVMValueRef indexes,
+             LLVMValueRef mask,
+             unsigned lane)
+{
+   struct gallivm_state *gallivm = bld->bld_base.base.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMValueRef ii = lp_build_const_int32(gallivm, lane);
+   LLVMValueRef index = LLVMBuildExtractElement(builder, indexes, ii, "");
+   LLVMValueRef pred = LLVMBuildExtractElement(builder, mask, ii, "");
+   LLVMValueRef ptr = LLVMBuildGEP(builder, base_ptr, &index, 1, "");
+
+   if (!bld->scratch_ptr)
+      bld->scratch_ptr = lp_build_alloca(gallivm,
+                                         LLVMInt32TypeInContext(gallivm->context),
+                                         "scratch");
+
+   pred = LLVMBuildICmp(builder, LLVMIntNE, pred,
+                        lp_build_const_int32(gallivm, 0), "");
+   return LLVMBuildSelect(builder, pred, ptr, bld->scratch_ptr, "");
+}
+
+static void
+load_emit(
+   const struct lp_build_tgsi_action * action,
+   struct lp_build_tgsi_context * bld_base,
+   struct lp_build_emit_data * emit_data)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+   struct gallivm_state *gallivm = bld_base->base.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   struct lp_build_context *uint_bld = &bld_base->uint_bld;
+   const struct tgsi_full_instruction *inst = emit_data->inst;
+   const struct tgsi_full_src_register *reg = &inst->Src[0];
+   LLVMValueRef base_ptr, num_elems, offset, index;
+   unsigned chan;
+
+   if (!get_memory_resource(bld, reg->Register.File, reg->Register.Index,
+                            reg->Register.Indirect, &base_ptr, &num_elems)) {
+      TGSI_FOR_EACH_DST0_ENABLED_CHANNEL(inst, chan) {
+         emit_data->output[chan] = bld_base->base.zero;
+      }
+      return;
+   }
+
+   base_ptr = LLVMBuildBitCast(builder, base_ptr,
+                               LLVMPointerType(bld->elem_bld.elem_type, 0), "");
+   num_elems = lp_build_broadcast_scalar(uint_bld, num_elems);
+
+   offset = lp_build_emit_fetch(bld_base, inst, 1, TGSI_CHAN_X);
+   offset = LLVMBuildBitCast(builder, offset, uint_bld->vec_type, "");
+   index = lp_build_shr_imm(uint_bld, offset, 2);
+
+   /*
+    * Out of bounds loads return zero, like for constant buffers; this
+    * relies on unbound buffers pointing at some valid dummy memory.
+    */
+   TGSI_FOR_EACH_DST0_ENABLED_CHANNEL(inst, chan) {
+      LLVMValueRef chan_index =
+         lp_build_add(uint_bld, index,
+                      lp_build_const_int_vec(gallivm, uint_bld->type, chan));
+      LLVMValueRef overflow_mask =
+         lp_build_cmp(uint_bld, PIPE_FUNC_GEQUAL, chan_index, num_elems);
+
+      emit_data->output[chan] = build_gather(bld_base, base_ptr, chan_index,
+                                             overflow_mask, NULL);
+   }
+}
+
+static void
+store_emit(
+   const struct lp_build_tgsi_action * action,
+   struct lp_build_tgsi_context * bld_base,
+   struct lp_build_emit_data * emit_data)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+   struct gallivm_state *gallivm = bld_base->base.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   struct lp_build_context *uint_bld = &bld_base->uint_bld;
+   const struct tgsi_full_instruction *inst = emit_data->inst;
+   const struct tgsi_full_dst_register *reg = &inst->Dst[0];
+   LLVMValueRef base_ptr, num_elems, offset, index, write_mask;
+   unsigned chan, i;
+
+   if (!get_memory_resource(bld, reg->Register.File, reg->Register.Index,
+                            reg->Register.Indirect, &base_ptr, &num_elems))
+      return;
+
+   num_elems = lp_build_broadcast_scalar(uint_bld, num_elems);
+   write_mask = get_memory_write_mask(bld_base);
+
+   offset = lp_build_emit_fetch(bld_base, inst, 0, TGSI_CHAN_X);
+   offset = LLVMBuildBitCast(builder, offset, uint_bld->vec_type, "");
+   index = lp_build_shr_imm(uint_bld, offset, 2);
+
+   TGSI_FOR_EACH_DST0_ENABLED_CHANNEL(inst, chan) {
+      LLVMValueRef chan_index =
+         lp_build_add(uint_bld, index,
+                      lp_build_const_int_vec(gallivm, uint_bld->type, chan));
+      LLVMValueRef in_bounds =
+         lp_build_cmp(uint_bld, PIPE_FUNC_LESS, chan_index, num_elems);
+      LLVMValueRef mask = LLVMBuildAnd(builder, write_mask, in_bounds, "");
+      LLVMValueRef value = lp_build_emit_fetch(bld_base, inst, 1, chan);
+
+      value = LLVMBuildBitCast(builder, value, uint_bld->vec_type, "");
+
+      /*
+       * Masked off lanes must not write anything at all, not even the
+       * old value, as other threads may be writing the same buffer.
+       */
+      for (i = 0; i < uint_bld->type.length; i++) {
+         LLVMValueRef ii = lp_build_const_int32(gallivm, i);
+         LLVMValueRef ptr = get_lane_ptr(bld, base_ptr, chan_index, mask, i);
+         LLVMBuildStore(builder,
+                        LLVMBuildExtractElement(builder, value, ii, ""),
+                        ptr);
+      }
+   }
+}
+
+static void
+atomic_emit(
+   const struct lp_build_tgsi_action * action,
+   struct lp_build_tgsi_context * bld_base,
+   struct lp_build_emit_data * emit_data)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+   struct gallivm_state *gallivm = bld_base->base.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   struct lp_build_context *uint_bld = &bld_base->uint_bld;
+   const struct tgsi_full_instruction *inst = emit_data->inst;
+   const struct tgsi_full_src_register *reg = &inst->Src[0];
+   LLVMValueRef base_ptr, num_elems, offset, index, mask;
+   LLVMValueRef data, cmp = NULL;
+   LLVMValueRef res = uint_bld->undef;
+   LLVMAtomicRMWBinOp op = LLVMAtomicRMWBinOpAdd;
+   unsigned chan, i;
+
+   switch (inst->Instruction.Opcode) {
+   case TGSI_OPCODE_ATOMUADD:
+      op = LLVMAtomicRMWBinOpAdd;
+      break;
+   case TGSI_OPCODE_ATOMXCHG:
+      op = LLVMAtomicRMWBinOpXchg;
+      break;
+   case TGSI_OPCODE_ATOMAND:
+      op = LLVMAtomicRMWBinOpAnd;
+      break;
+   case TGSI_OPCODE_ATOMOR:
+      op = LLVMAtomicRMWBinOpOr;
+      break;
+   case TGSI_OPCODE_ATOMXOR:
+      op = LLVMAtomicRMWBinOpXor;
+      break;
+   case TGSI_OPCODE_ATOMUMIN:
+      op = LLVMAtomicRMWBinOpUMin;
+      break;
+   case TGSI_OPCODE_ATOMUMAX:
+      op = LLVMAtomicRMWBinOpUMax;
+      break;
+   case TGSI_OPCODE_ATOMIMIN:
+      op = LLVMAtomicRMWBinOpMin;
+      break;
+   case TGSI_OPCODE_ATOMIMAX:
+      op = LLVMAtomicRMWBinOpMax;
+      break;
+   case TGSI_OPCODE_ATOMCAS:
+      break;
+   default:
+      assert(0);
+      break;
+   }
+
+   if (!get_memory_resource(bld, reg->Register.File, reg->Register.Index,
+                            reg->Register.Indirect, &base_ptr, &num_elems)) {
+      TGSI_FOR_EACH_DST0_ENABLED_CHANNEL(inst, chan) {
+         emit_data->output[chan] = uint_bld->zero;
+      }
+      return;
+   }
+
+   num_elems = lp_build_broadcast_scalar(uint_bld, num_elems);
+
+   offset = lp_build_emit_fetch(bld_base, inst, 1, TGSI_CHAN_X);
+   offset = LLVMBuildBitCast(builder, offset, uint_bld->vec_type, "");
+   index = lp_build_shr_imm(uint_bld, offset, 2);
+
+   data = lp_build_emit_fetch(bld_base, inst, 2, TGSI_CHAN_X);
+   data = LLVMBuildBitCast(builder, data, uint_bld->vec_type, "");
+   if (inst->Instruction.Opcode == TGSI_OPCODE_ATOMCAS) {
+      /* src2 is the value to compare with, src3 the one to store */
+      cmp = data;
+      data = lp_build_emit_fetch(bld_base, inst, 3, TGSI_CHAN_X);
+      data = LLVMBuildBitCast(builder, data, uint_bld->vec_type, "");
+   }
+
+   mask = LLVMBuildAnd(builder, get_memory_write_mask(bld_base),
+                       lp_build_cmp(uint_bld, PIPE_FUNC_LESS, index, num_elems),
+                       "");
+
+   /*
+    * The lanes are done one after the other, so this is also correct when
+    * several of them hit the same address.
+    */
+   for (i = 0; i < uint_bld->type.length; i++) {
+      LLVMValueRef ii = lp_build_const_int32(gallivm, i);
+      LLVMValueRef ptr = get_lane_ptr(bld, base_ptr, index, mask, i);
+      LLVMValueRef val = LLVMBuildExtractElement(builder, data, ii, "");
+      LLVMValueRef old;
+
+      if (cmp) {
+         LLVMValueRef cmp_val = LLVMBuildExtractElement(builder, cmp, ii, "");
+#if HAVE_LLVM >= 0x0309
+         old = LLVMBuildAtomicCmpXchg(builder, ptr, cmp_val, val,
+                                      LLVMAtomicOrderingSequentiallyConsistent,
+                                      LLVMAtomicOrderingSequentiallyConsistent,
+                                      FALSE);
+         old = LLVMBuildExtractValue(builder, old, 0, "");
+#else
+         /* XXX not atomic with respect to other threads */
+         LLVMValueRef equal;
+         old = LLVMBuildLoad(builder, ptr, "");
+         equal = LLVMBuildICmp(builder, LLVMIntEQ, old, cmp_val, "");
+         LLVMBuildStore(builder,
+                        LLVMBuildSelect(builder, equal, val, old, ""), ptr);
+#endif
+      }
+      else {
+         old = LLVMBuildAtomicRMW(builder, op, ptr, val,
+                                  LLVMAtomicOrderingSequentiallyConsistent,
+                                  FALSE);
+      }
+
+      res = LLVMBuildInsertElement(builder, res, old, ii, "");
+   }
+
+   TGSI_FOR_EACH_DST0_ENABLED_CHANNEL(inst, chan) {
+      emit_data->output[chan] = res;
+   }
+}
+
+static void
+resq_emit(
+   const struct lp_build_tgsi_action * action,
+   struct lp_build_tgsi_context * bld_base,
+   struct lp_build_emit_data * emit_data)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+   const struct tgsi_full_instruction *inst = emit_data->inst;
+   const struct tgsi_full_src_register *reg = &inst->Src[0];
+   LLVMValueRef size = bld_base->uint_bld.zero;
+   unsigned chan;
+
+   /* Only buffers, which just have a size in bytes */
+   if (reg->Register.File == TGSI_FILE_BUFFER &&
+       !reg->Register.Indirect &&
+       reg->Register.Index < LP_MAX_TGSI_SHADER_BUFFERS &&
+       bld->ssbo_sizes[reg->Register.Index]) {
+      size = lp_build_broadcast_scalar(&bld_base->uint_bld,
+                                       bld->ssbo_sizes[reg->Register.Index]);
+   }
+
+   TGSI_FOR_EACH_DST0_ENABLED_CHANNEL(inst, chan) {
+      emit_data->output[chan] = size;
+   }
+}
+
+/**
+ * Start the next phase of a compute shader, see lp_build_tgsi_cs_iface.
+ */
+static void
+barrier_emit(
+   const struct lp_build_tgsi_action * action,
+   struct lp_build_tgsi_context * bld_base,
+   struct lp_build_emit_data * emit_data)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+   struct gallivm_state *gallivm = bld_base->base.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMBasicBlockRef block;
+
+   if (!bld->phase_switch)
+      return;
+
+   /* Callers must not build shaders with barriers in control flow */
+   assert(!bld->exec_mask.has_mask);
+
+   LLVMBuildBr(builder, bld->phase_end_block);
+
+   block = lp_build_insert_new_block(gallivm, "phase");
+   LLVMAddCase(bld->phase_switch,
+               lp_build_const_int32(gallivm, bld->num_phases++), block);
+   LLVMPositionBuilderAtEnd(builder, block);
+}
+
+static void
+membar_emit(
+   const struct lp_build_tgsi_action * action,
+   struct lp_build_tgsi_context * bld_base,
+   struct lp_build_emit_data * emit_data)
+{
+   /*
+    * Nothing to do: the invocations of a block run on the same thread, in
+    * order, and the atomics are sequentially consistent.
+    */
+}
+
 static void emit_prologue(struct lp_build_tgsi_context * bld_base)
 {
    struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
    struct gallivm_state * gallivm = bld_base->base.gallivm;
 
-   if (bld->indirect_files & (1 << TGSI_FILE_TEMPORARY)) {
+   if (bld->cs_iface && bld->cs_iface->temps_ptr) {
+      /* must hold lp_build_tgsi_soa_temps_size() bytes */
+      bld->temps_array =
+         LLVMBuildBitCast(gallivm->builder, bld->cs_iface->temps_ptr,
+                          LLVMPointerType(bld_base->base.vec_type, 0),
+                          "temp_array");
+   }
+   else if (bld->indirect_files & (1 << TGSI_FILE_TEMPORARY)) {
       LLVMValueRef array_size =
          lp_build_const_int32(gallivm,
                          bld_base->info->file_max[TGSI_FILE_TEMPORARY] * 4 + 4);
@@ -3653,7 +4250,8 @@ static void emit_prologue(struct lp_build_tgsi_context * bld_base)
                                               "temp_array");
    }
 
-   if (bld->indirect_files & (1 << TGSI_FILE_OUTPUT)) {
+   if (bld->indirect_files & (1 << TGSI_FILE_OUTPUT) &&
+       !(bld->tess_iface && bld->tess_iface->emit_store_output)) {
       LLVMValueRef array_size =
          lp_build_const_int32(gallivm,
                             bld_base->info->file_max[TGSI_FILE_OUTPUT] * 4 + 4);
@@ -3673,7 +4271,8 @@ static void emit_prologue(struct lp_build_tgsi_context * bld_base)
 
    /* If we have indirect addressing in inputs we need to copy them into
     * our alloca array to be able to iterate over them */
-   if (bld->indirect_files & (1 << TGSI_FILE_INPUT) && !bld->gs_iface) {
+   if (bld->indirect_files & (1 << TGSI_FILE_INPUT) &&
+       !bld->gs_iface && !bld->tess_iface) {
       unsigned index, chan;
       LLVMTypeRef vec_type = bld_base->base.vec_type;
       LLVMValueRef array_size = lp_build_const_int32(gallivm,
@@ -3725,16 +4324,47 @@ static void emit_prologue(struct lp_build_tgsi_context * bld_base)
    if (DEBUG_EXECUTION) {
       lp_build_printf(gallivm, "\n");
       emit_dump_file(bld, TGSI_FILE_CONSTANT);
-      if (!bld->gs_iface)
+      if (!bld->gs_iface && !bld->tess_iface)
          emit_dump_file(bld, TGSI_FILE_INPUT);
    }
 }
 
+/**
+ * Jump to the code of the phase to run, see lp_build_tgsi_cs_iface.
+ * Everything up to here runs in all phases.
+ */
+static void emit_prologue_post_decl(struct lp_build_tgsi_context * bld_base)
+{
+   struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
+   struct gallivm_state * gallivm = bld_base->base.gallivm;
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMBasicBlockRef block;
+
+   if (!bld->cs_iface || !bld->cs_iface->phase)
+      return;
+
+   bld->phase_end_block = lp_build_insert_new_block(gallivm, "phase_end");
+   block = lp_build_insert_new_block(gallivm, "phase");
+
+   bld->phase_switch = LLVMBuildSwitch(builder, bld->cs_iface->phase,
+                                       bld->phase_end_block,
+                                       bld_base->info->opcode_count[TGSI_OPCODE_BARRIER] + 1);
+   LLVMAddCase(bld->phase_switch, lp_build_const_int32(gallivm, 0), block);
+   bld->num_phases = 1;
+
+   LLVMPositionBuilderAtEnd(builder, block);
+}
+
 static void emit_epilogue(struct lp_build_tgsi_context * bld_base)
 {
    struct lp_build_tgsi_soa_context * bld = lp_soa_context(bld_base);
    LLVMBuilderRef builder = bld_base->base.gallivm->builder;
 
+   if (bld->phase_switch) {
+      LLVMBuildBr(builder, bld->phase_end_block);
+      LLVMPositionBuilderAtEnd(builder, bld->phase_end_block);
+   }
+
    if (DEBUG_EXECUTION) {
       /* for debugging */
       if (0) {
@@ -3763,7 +4393,7 @@ static void emit_epilogue(struct lp_build_tgsi_context * bld_base)
                                  &bld->bld_base,
                                  total_emitted_vertices_vec,
                                  emitted_prims_vec);
-   } else {
+   } else if (!(bld->tess_iface && bld->tess_iface->emit_store_output)) {
       gather_outputs(bld);
    }
 }
@@ -3782,7 +4412,9 @@ lp_build_tgsi_soa(struct gallivm_state *gallivm,
                   LLVMValueRef thread_data_ptr,
                   struct lp_build_sampler_soa *sampler,
                   const struct tgsi_shader_info *info,
-                  const struct lp_build_tgsi_gs_iface *gs_iface)
+                  const struct lp_build_tgsi_gs_iface *gs_iface,
+                  const struct lp_build_tgsi_cs_iface *cs_iface,
+                  const struct lp_build_tgsi_tess_iface *tess_iface)
 {
    struct lp_build_tgsi_soa_context bld;
 
@@ -3862,6 +4494,7 @@ lp_build_tgsi_soa(struct gallivm_state *gallivm,
    bld.bld_base.emit_immediate = lp_emit_immediate_soa;
 
    bld.bld_base.emit_prologue = emit_prologue;
+   bld.bld_base.emit_prologue_post_decl = emit_prologue_post_decl;
    bld.bld_base.emit_epilogue = emit_epilogue;
 
    /* Set opcode actions */
@@ -3911,6 +4544,22 @@ lp_build_tgsi_soa(struct gallivm_state *gallivm,
    bld.bld_base.op_actions[TGSI_OPCODE_GATHER4].emit = gather4_emit;
    bld.bld_base.op_actions[TGSI_OPCODE_SVIEWINFO].emit = sviewinfo_emit;
    bld.bld_base.op_actions[TGSI_OPCODE_LOD].emit = lod_emit;
+   /* Buffers and shared memory */
+   bld.bld_base.op_actions[TGSI_OPCODE_LOAD].emit = load_emit;
+   bld.bld_base.op_actions[TGSI_OPCODE_STORE].emit = store_emit;
+   bld.bld_base.op_actions[TGSI_OPCODE_RESQ].emit = resq_emit;
+   bld.bld_base.op_actions[TGSI_OPCODE_ATOMUADD].emit = atomic_emit;
+   bld.bld_base.op_actions[TGSI_OPCODE_ATOMXCHG].emit = atomic_emit;
+   bld.bld_base.op_actions[TGSI_OPCODE_ATOMCAS].emit = atomic_emit;
+   bld.bld_base.op_actions[TGSI_OPCODE_ATOMAND].emit = atomic_emit;
+   bld.bld_base.op_actions[TGSI_OPCODE_ATOMOR].emit = atomic_emit;
+   bld.bld_base.op_actions[TGSI_OPCODE_ATOMXOR].emit = atomic_emit;
+   bld.bld_base.op_actions[TGSI_OPCODE_ATOMUMIN].emit = atomic_emit;
+   bld.bld_base.op_actions[TGSI_OPCODE_ATOMUMAX].emit = atomic_emit;
+   bld.bld_base.op_actions[TGSI_OPCODE_ATOMIMIN].emit = atomic_emit;
+   bld.bld_base.op_actions[TGSI_OPCODE_ATOMIMAX].emit = atomic_emit;
+   bld.bld_base.op_actions[TGSI_OPCODE_BARRIER].emit = barrier_emit;
+   bld.bld_base.op_actions[TGSI_OPCODE_MEMBAR].emit = membar_emit;
 
 
    if (gs_iface) {
@@ -3938,6 +4587,24 @@ lp_build_tgsi_soa(struct gallivm_state *gallivm,
                                 max_output_vertices);
    }
 
+   if (tess_iface) {
+      /* inputs are always indirect with tessellation, like with gs */
+      bld.indirect_files |= (1 << TGSI_FILE_INPUT);
+      bld.tess_iface = tess_iface;
+      bld.bld_base.emit_fetch_funcs[TGSI_FILE_INPUT] = emit_fetch_tess;
+      if (tess_iface->emit_store_output) {
+         bld.indirect_files |= (1 << TGSI_FILE_OUTPUT);
+         bld.bld_base.emit_fetch_funcs[TGSI_FILE_OUTPUT] = emit_fetch_tess;
+      }
+   }
+
+   if (cs_iface) {
+      bld.cs_iface = cs_iface;
+      /* the temporaries must outlive the phase, see emit_prologue */
+      if (cs_iface->temps_ptr)
+         bld.indirect_files |= (1 << TGSI_FILE_TEMPORARY);
+   }
+
    lp_exec_mask_init(&bld.exec_mask, &bld.bld_base.int_bld);
 
    bld.system_values = *system_values;
@@ -3961,3 +4628,15 @@ lp_build_tgsi_soa(struct gallivm_state *gallivm,
    }
    lp_exec_mask_fini(&bld.exec_mask);
 }
+
+
+/**
+ * Size in bytes of the lp_build_tgsi_cs_iface::temps_ptr storage.
+ */
+unsigned
+lp_build_tgsi_soa_temps_size(const struct tgsi_shader_info *info,
+                             struct lp_type type)
+{
+   return (info->file_max[TGSI_FILE_TEMPORARY] * 4 + 4) *
+          (type.width * type.length / 8);
+}
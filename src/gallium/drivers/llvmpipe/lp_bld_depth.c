@@ -457,6 +457,18 @@ lp_build_occlusion_count(struct gallivm_state *gallivm,
                                        LLVMInt32TypeInContext(context), bits);
       count = LLVMBuildZExt(builder, count, LLVMIntTypeInContext(context, 64), "");
    }
+   else if(util_cpu_caps.has_avx512f && type.length == 16) {
+      /* compare into a <16 x i1> which maps directly onto a k register */
+      const char *popcntintr = "llvm.ctpop.i16";
+      LLVMTypeRef i16t = LLVMInt16TypeInContext(context);
+      LLVMValueRef bits = LLVMBuildBitCast(builder, maskvalue,
+                                           lp_build_int_vec_type(gallivm, type), "");
+      bits = LLVMBuildICmp(builder, LLVMIntSLT, bits,
+                           LLVMConstNull(LLVMTypeOf(bits)), "");
+      bits = LLVMBuildBitCast(builder, bits, i16t, "");
+      count = lp_build_intrinsic_unary(builder, popcntintr, i16t, bits);
+      count = LLVMBuildZExt(builder, count, LLVMIntTypeInContext(context, 64), "");
+   }
    else {
       unsigned i;
       LLVMValueRef countv = LLVMBuildAnd(builder, maskvalue, countmask, "countv");
@@ -511,6 +523,125 @@ lp_build_occlusion_count(struct gallivm_state *gallivm,
 }
 
 
+/**
+ * Position, in a row-major 4x4 block, of element i of a 16-wide vector
+ * holding the block as four 2x2 quads (see generate_quad_mask).
+ * Swaps the two middle bits, hence is its own inverse.
+ */
+static inline unsigned
+quad_to_linear_4x4(unsigned i)
+{
+   return (i & 9) | ((i & 2) << 1) | ((i & 4) >> 1);
+}
+
+
+/**
+ * Load a whole 4x4 block of depth/stencil values for 16-wide fragment
+ * vectors, swizzled into quad order.
+ */
+static LLVMValueRef
+load_swizzled_4x4(struct gallivm_state *gallivm,
+                  struct lp_type zs_type,
+                  boolean is_1d,
+                  LLVMValueRef depth_ptr,
+                  LLVMValueRef depth_stride)
+{
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMValueRef shuffles[16];
+   LLVMValueRef rows[4];
+   LLVMValueRef lo, hi;
+   struct lp_type row_type = zs_type;
+   LLVMTypeRef row_ptr_type;
+   unsigned i;
+
+   row_type.length = 4;
+   row_ptr_type = LLVMPointerType(lp_build_vec_type(gallivm, row_type), 0);
+
+   for (i = 0; i < 4; i++) {
+      if (is_1d && i > 0) {
+         rows[i] = lp_build_undef(gallivm, row_type);
+      }
+      else {
+         LLVMValueRef offset = LLVMBuildMul(builder, depth_stride,
+                                            lp_build_const_int32(gallivm, i), "");
+         LLVMValueRef ptr = LLVMBuildGEP(builder, depth_ptr, &offset, 1, "");
+         ptr = LLVMBuildBitCast(builder, ptr, row_ptr_type, "");
+         rows[i] = LLVMBuildLoad(builder, ptr, "");
+      }
+   }
+
+   lo = lp_build_concat(gallivm, &rows[0], row_type, 2);
+   hi = lp_build_concat(gallivm, &rows[2], row_type, 2);
+
+   for (i = 0; i < 16; i++) {
+      shuffles[i] = lp_build_const_int32(gallivm, quad_to_linear_4x4(i));
+   }
+
+   return LLVMBuildShuffleVector(builder, lo, hi,
+                                 LLVMConstVector(shuffles, 16), "");
+}
+
+
+/**
+ * Store a whole 4x4 block of (already masked) depth/stencil values from
+ * 16-wide fragment vectors, the inverse of load_swizzled_4x4.
+ */
+static void
+store_swizzled_4x4(struct gallivm_state *gallivm,
+                   struct lp_type zs_type,
+                   unsigned zs_bits,
+                   boolean is_1d,
+                   LLVMValueRef depth_ptr,
+                   LLVMValueRef depth_stride,
+                   LLVMValueRef z_value,
+                   LLVMValueRef s_value)
+{
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMValueRef shuffles[32];
+   LLVMValueRef linear;
+   struct lp_type row_type = zs_type;
+   LLVMTypeRef row_vec_type;
+   unsigned row_length;
+   unsigned i;
+
+   row_type.length = 4;
+   row_vec_type = lp_build_vec_type(gallivm, row_type);
+
+   if (zs_bits <= 32) {
+      for (i = 0; i < 16; i++) {
+         shuffles[i] = lp_build_const_int32(gallivm, quad_to_linear_4x4(i));
+      }
+      linear = LLVMBuildShuffleVector(builder, z_value, z_value,
+                                      LLVMConstVector(shuffles, 16), "");
+      row_length = 4;
+   }
+   else {
+      /* interleave z and s while unswizzling */
+      for (i = 0; i < 16; i++) {
+         shuffles[i*2] = lp_build_const_int32(gallivm, quad_to_linear_4x4(i));
+         shuffles[i*2+1] = lp_build_const_int32(gallivm,
+                                                quad_to_linear_4x4(i) + 16);
+      }
+      linear = LLVMBuildShuffleVector(builder, z_value, s_value,
+                                      LLVMConstVector(shuffles, 32), "");
+      row_length = 8;
+   }
+
+   for (i = 0; i < (is_1d ? 1 : 4); i++) {
+      LLVMValueRef offset = LLVMBuildMul(builder, depth_stride,
+                                         lp_build_const_int32(gallivm, i), "");
+      LLVMValueRef ptr = LLVMBuildGEP(builder, depth_ptr, &offset, 1, "");
+      LLVMValueRef row = lp_build_extract_range(gallivm, linear,
+                                                i * row_length, row_length);
+
+      ptr = LLVMBuildBitCast(builder, ptr,
+                             LLVMPointerType(row_vec_type, 0), "");
+      row = LLVMBuildBitCast(builder, row, row_vec_type, "");
+      LLVMBuildStore(builder, row, ptr);
+   }
+}
+
+
 /**
  * Load depth/stencil values.
  * The stored values are linear, swizzle them.
@@ -548,55 +679,62 @@ lp_build_depth_stencil_load_swizzled(struct gallivm_state *gallivm,
    zs_load_type.length = zs_load_type.length / 2;
    load_ptr_type = LLVMPointerType(lp_build_vec_type(gallivm, zs_load_type), 0);
 
-   if (z_src_type.length == 4) {
-      unsigned i;
-      LLVMValueRef looplsb = LLVMBuildAnd(builder, loop_counter,
-                                          lp_build_const_int32(gallivm, 1), "");
-      LLVMValueRef loopmsb = LLVMBuildAnd(builder, loop_counter,
-                                          lp_build_const_int32(gallivm, 2), "");
-      LLVMValueRef offset2 = LLVMBuildMul(builder, loopmsb,
-                                          depth_stride, "");
-      depth_offset1 = LLVMBuildMul(builder, looplsb,
-                                   lp_build_const_int32(gallivm, depth_bytes * 2), "");
-      depth_offset1 = LLVMBuildAdd(builder, depth_offset1, offset2, "");
-
-      /* just concatenate the loaded 2x2 values into 4-wide vector */
-      for (i = 0; i < 4; i++) {
-         shuffles[i] = lp_build_const_int32(gallivm, i);
-      }
+   if (z_src_type.length == 16) {
+      /* A single iteration covers the whole 4x4 block */
+      *z_fb = load_swizzled_4x4(gallivm, zs_type, is_1d,
+                                depth_ptr, depth_stride);
    }
    else {
-      unsigned i;
-      LLVMValueRef loopx2 = LLVMBuildShl(builder, loop_counter,
-                                         lp_build_const_int32(gallivm, 1), "");
-      assert(z_src_type.length == 8);
-      depth_offset1 = LLVMBuildMul(builder, loopx2, depth_stride, "");
-      /*
-       * We load 2x4 values, and need to swizzle them (order
-       * 0,1,4,5,2,3,6,7) - not so hot with avx unfortunately.
-       */
-      for (i = 0; i < 8; i++) {
-         shuffles[i] = lp_build_const_int32(gallivm, (i&1) + (i&2) * 2 + (i&4) / 2);
+      if (z_src_type.length == 4) {
+         unsigned i;
+         LLVMValueRef looplsb = LLVMBuildAnd(builder, loop_counter,
+                                             lp_build_const_int32(gallivm, 1), "");
+         LLVMValueRef loopmsb = LLVMBuildAnd(builder, loop_counter,
+                                             lp_build_const_int32(gallivm, 2), "");
+         LLVMValueRef offset2 = LLVMBuildMul(builder, loopmsb,
+                                             depth_stride, "");
+         depth_offset1 = LLVMBuildMul(builder, looplsb,
+                                      lp_build_const_int32(gallivm, depth_bytes * 2), "");
+         depth_offset1 = LLVMBuildAdd(builder, depth_offset1, offset2, "");
+
+         /* just concatenate the loaded 2x2 values into 4-wide vector */
+         for (i = 0; i < 4; i++) {
+            shuffles[i] = lp_build_const_int32(gallivm, i);
+         }
+      }
+      else {
+         unsigned i;
+         LLVMValueRef loopx2 = LLVMBuildShl(builder, loop_counter,
+                                            lp_build_const_int32(gallivm, 1), "");
+         assert(z_src_type.length == 8);
+         depth_offset1 = LLVMBuildMul(builder, loopx2, depth_stride, "");
+         /*
+          * We load 2x4 values, and need to swizzle them (order
+          * 0,1,4,5,2,3,6,7) - not so hot with avx unfortunately.
+          */
+         for (i = 0; i < 8; i++) {
+            shuffles[i] = lp_build_const_int32(gallivm, (i&1) + (i&2) * 2 + (i&4) / 2);
+         }
       }
-   }
 
-   depth_offset2 = LLVMBuildAdd(builder, depth_offset1, depth_stride, "");
+      depth_offset2 = LLVMBuildAdd(builder, depth_offset1, depth_stride, "");
 
-   /* Load current z/stencil values from z/stencil buffer */
-   zs_dst_ptr = LLVMBuildGEP(builder, depth_ptr, &depth_offset1, 1, "");
-   zs_dst_ptr = LLVMBuildBitCast(builder, zs_dst_ptr, load_ptr_type, "");
-   zs_dst1 = LLVMBuildLoad(builder, zs_dst_ptr, "");
-   if (is_1d) {
-      zs_dst2 = lp_build_undef(gallivm, zs_load_type);
-   }
-   else {
-      zs_dst_ptr = LLVMBuildGEP(builder, depth_ptr, &depth_offset2, 1, "");
+      /* Load current z/stencil values from z/stencil buffer */
+      zs_dst_ptr = LLVMBuildGEP(builder, depth_ptr, &depth_offset1, 1, "");
       zs_dst_ptr = LLVMBuildBitCast(builder, zs_dst_ptr, load_ptr_type, "");
-      zs_dst2 = LLVMBuildLoad(builder, zs_dst_ptr, "");
-   }
+      zs_dst1 = LLVMBuildLoad(builder, zs_dst_ptr, "");
+      if (is_1d) {
+         zs_dst2 = lp_build_undef(gallivm, zs_load_type);
+      }
+      else {
+         zs_dst_ptr = LLVMBuildGEP(builder, depth_ptr, &depth_offset2, 1, "");
+         zs_dst_ptr = LLVMBuildBitCast(builder, zs_dst_ptr, load_ptr_type, "");
+         zs_dst2 = LLVMBuildLoad(builder, zs_dst_ptr, "");
+      }
 
-   *z_fb = LLVMBuildShuffleVector(builder, zs_dst1, zs_dst2,
-                                  LLVMConstVector(shuffles, zs_type.length), "");
+      *z_fb = LLVMBuildShuffleVector(builder, zs_dst1, zs_dst2,
+                                     LLVMConstVector(shuffles, zs_type.length), "");
+   }
    *s_fb = *z_fb;
 
    if (format_desc->block.bits < z_src_type.width) {
@@ -710,7 +848,8 @@ lp_build_depth_stencil_write_swizzled(struct gallivm_state *gallivm,
       unsigned i;
       LLVMValueRef loopx2 = LLVMBuildShl(builder, loop_counter,
                                          lp_build_const_int32(gallivm, 1), "");
-      assert(z_src_type.length == 8);
+      /* the 16-wide case only uses the pointers set up here */
+      assert(z_src_type.length == 8 || z_src_type.length == 16);
       depth_offset1 = LLVMBuildMul(builder, loopx2, depth_stride, "");
       /*
        * We load 2x4 values, and need to swizzle them (order
@@ -747,6 +886,12 @@ lp_build_depth_stencil_write_swizzled(struct gallivm_state *gallivm,
                                lp_build_int_vec_type(gallivm, zs_type), "");
    }
 
+   if (z_src_type.length == 16) {
+      store_swizzled_4x4(gallivm, zs_type, format_desc->block.bits, is_1d,
+                         depth_ptr, depth_stride, z_value, s_value);
+      return;
+   }
+
    if (format_desc->block.bits <= 32) {
       if (z_src_type.length == 4) {
          zs_dst1 = lp_build_extract_range(gallivm, z_value, 0, 2);
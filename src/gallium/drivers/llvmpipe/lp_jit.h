@@ -45,6 +45,7 @@
 
 struct lp_build_format_cache;
 struct lp_fragment_shader_variant;
+struct lp_compute_shader_variant;
 struct llvmpipe_screen;
 
 
@@ -135,6 +136,10 @@ struct lp_jit_context
 
    struct lp_jit_texture textures[PIPE_MAX_SHADER_SAMPLER_VIEWS];
    struct lp_jit_sampler samplers[PIPE_MAX_SAMPLERS];
+
+   /* Shader buffers, only used by compute shaders */
+   const uint32_t *ssbos[LP_MAX_TGSI_SHADER_BUFFERS];
+   uint32_t ssbo_sizes[LP_MAX_TGSI_SHADER_BUFFERS];
 };
 
 
@@ -153,6 +158,8 @@ enum {
    LP_JIT_CTX_VIEWPORTS,
    LP_JIT_CTX_TEXTURES,
    LP_JIT_CTX_SAMPLERS,
+   LP_JIT_CTX_SSBOS,
+   LP_JIT_CTX_SSBO_SIZES,
    LP_JIT_CTX_COUNT
 };
 
@@ -187,6 +194,12 @@ enum {
 #define lp_jit_context_samplers(_gallivm, _ptr) \
    lp_build_struct_get_ptr(_gallivm, _ptr, LP_JIT_CTX_SAMPLERS, "samplers")
 
+#define lp_jit_context_ssbos(_gallivm, _ptr) \
+   lp_build_struct_get_ptr(_gallivm, _ptr, LP_JIT_CTX_SSBOS, "ssbos")
+
+#define lp_jit_context_ssbo_sizes(_gallivm, _ptr) \
+   lp_build_struct_get_ptr(_gallivm, _ptr, LP_JIT_CTX_SSBO_SIZES, "ssbo_sizes")
+
 
 struct lp_jit_thread_data
 {
@@ -254,6 +267,34 @@ typedef void
                     unsigned depth_stride);
 
 
+/**
+ * typedef for compute shader function
+ *
+ * Runs a group of invocations, as many as there are lanes in the vector
+ * type, of one phase of one block.
+ *
+ * @param context           jit context
+ * @param thread_data       task thread data
+ * @param block_id          x, y, z id of the block
+ * @param grid_size         x, y, z number of blocks
+ * @param block_size        x, y, z number of invocations per block
+ * @param first_invocation  linear index in the block of the first lane
+ * @param phase             barrier phase to run
+ * @param shared_mem        block shared memory
+ * @param temps             storage for the temporaries of these invocations
+ */
+typedef void
+(*lp_jit_cs_func)(const struct lp_jit_context *context,
+                  struct lp_jit_thread_data *thread_data,
+                  const uint32_t *block_id,
+                  const uint32_t *grid_size,
+                  const uint32_t *block_size,
+                  uint32_t first_invocation,
+                  uint32_t phase,
+                  void *shared_mem,
+                  void *temps);
+
+
 void
 lp_jit_screen_cleanup(struct llvmpipe_screen *screen);
 
@@ -266,4 +307,13 @@ void
 lp_jit_init_types(struct lp_fragment_shader_variant *lp);
 
 
+void
+lp_jit_init_cs_types(struct lp_compute_shader_variant *lp);
+
+
+void
+lp_jit_texture_from_pipe(struct lp_jit_texture *jit_tex,
+                         const struct pipe_sampler_view *view);
+
+
 #endif /* LP_JIT_H */
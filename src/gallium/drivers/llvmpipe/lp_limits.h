@@ -61,7 +61,11 @@
 #define LP_MAX_WIDTH  (1 << (LP_MAX_TEXTURE_LEVELS - 1))
 
 
-#define LP_MAX_THREADS 16
+/**
+ * Max number of rasterizer threads.  The per-thread state is allocated at
+ * runtime for the actual thread count, so this is only a sanity limit.
+ */
+#define LP_MAX_THREADS 256
 
 
 /**
@@ -76,10 +80,10 @@
 #define LP_MAX_SHADER_VARIANTS 1024
 
 /**
- * Max number of instructions (for all fragment shaders combined per context)
- * that will be kept around (counted in terms of llvm ir).
+ * Default max bytes of machine code (for all fragment shaders combined per
+ * context) that will be kept around.  See also LP_SHADER_CACHE_SIZE.
  */
-#define LP_MAX_SHADER_INSTRUCTIONS (2048 * LP_MAX_SHADER_VARIANTS)
+#define LP_MAX_SHADER_CODE_SIZE (64 * 1024 * 1024)
 
 /**
  * Max number of setup variants that will be kept around.
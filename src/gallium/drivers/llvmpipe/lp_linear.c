@@ -0,0 +1,687 @@
+/**************************************************************************
+ * 
+ * Copyright 2018 VMware, Inc.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ **************************************************************************/
+
+
+/**
+ * Linear fast path for simple 2D textured and blended triangles.
+ *
+ * See lp_linear.h for the overview.  The variant check matches shaders of
+ * the form
+ *
+ *    TEX OUT[0], IN[k], SAMP[n], 2D|RECT
+ *
+ * (optionally through a TEMP and a MOV) with a matching 8-bit BGRA/RGBA
+ * texture and color buffer, no depth/stencil/alpha test, and either no
+ * blending or premultiplied "over" blending.  The triangle check then
+ * verifies that the texture coordinates are affine in window space and,
+ * when the sampler filters or wraps, that each pixel center maps exactly
+ * onto a texel center so that nearest sampling gives the same result.
+ */
+
+
+#include "pipe/p_defines.h"
+#include "util/u_format.h"
+#include "util/u_math.h"
+#include "util/u_rect.h"
+#include "tgsi/tgsi_parse.h"
+
+#include "lp_debug.h"
+#include "lp_jit.h"
+#include "lp_linear.h"
+#include "lp_rast.h"
+#include "lp_rast_priv.h"
+#include "lp_state_fs.h"
+
+#if defined(PIPE_ARCH_SSE)
+#include <emmintrin.h>
+#endif
+
+
+/**
+ * Largest error, in texels, tolerated when deciding whether pixel centers
+ * land on texel centers.
+ */
+#define LINEAR_EPSILON (1.0f / 1024.0f)
+
+
+/**
+ * Group color formats which share the same byte order, so that texels can
+ * be written to the color buffer as they are.
+ */
+static unsigned
+format_family(enum pipe_format format)
+{
+   switch (format) {
+   case PIPE_FORMAT_B8G8R8A8_UNORM:
+   case PIPE_FORMAT_B8G8R8X8_UNORM:
+      return 1;
+   case PIPE_FORMAT_R8G8B8A8_UNORM:
+   case PIPE_FORMAT_R8G8B8X8_UNORM:
+      return 2;
+   default:
+      return 0;
+   }
+}
+
+
+static boolean
+is_plain_src(const struct tgsi_full_src_register *src)
+{
+   return !src->Register.Indirect &&
+          !src->Register.Dimension &&
+          !src->Register.Absolute &&
+          !src->Register.Negate;
+}
+
+
+static boolean
+is_color_output(const struct lp_fragment_shader *shader,
+                const struct tgsi_full_dst_register *dst)
+{
+   const struct tgsi_shader_info *info = &shader->info.base;
+   unsigned index = dst->Register.Index;
+
+   return dst->Register.File == TGSI_FILE_OUTPUT &&
+          !dst->Register.Indirect &&
+          dst->Register.WriteMask == TGSI_WRITEMASK_XYZW &&
+          index < info->num_outputs &&
+          info->output_semantic_name[index] == TGSI_SEMANTIC_COLOR &&
+          info->output_semantic_index[index] == 0;
+}
+
+
+/**
+ * Match the shader tokens against the single texture fetch pattern.
+ * \return TRUE on a match, with the input and sampler unit returned
+ */
+static boolean
+match_shader(const struct lp_fragment_shader *shader,
+             unsigned *input, unsigned *unit)
+{
+   struct tgsi_parse_context parse;
+   int tex_temp = -1;
+   boolean have_tex = FALSE, have_output = FALSE, done = FALSE;
+   boolean ok = TRUE;
+
+   if (!shader->base.tokens ||
+       shader->info.base.num_outputs != 1 ||
+       shader->info.indirect_textures ||
+       shader->info.sampler_texture_units_different)
+      return FALSE;
+
+   if (tgsi_parse_init(&parse, shader->base.tokens) != TGSI_PARSE_OK)
+      return FALSE;
+
+   while (ok && !done && !tgsi_parse_end_of_tokens(&parse)) {
+      const struct tgsi_full_instruction *inst;
+
+      tgsi_parse_token(&parse);
+      if (parse.FullToken.Token.Type != TGSI_TOKEN_TYPE_INSTRUCTION)
+         continue;
+
+      inst = &parse.FullToken.FullInstruction;
+      if (inst->Instruction.Saturate) {
+         ok = FALSE;
+         break;
+      }
+
+      switch (inst->Instruction.Opcode) {
+      case TGSI_OPCODE_TEX:
+      {
+         const struct tgsi_full_src_register *coord = &inst->Src[0];
+         const struct tgsi_full_src_register *samp = &inst->Src[1];
+
+         if (have_tex ||
+             coord->Register.File != TGSI_FILE_INPUT ||
+             !is_plain_src(coord) ||
+             coord->Register.SwizzleX != TGSI_SWIZZLE_X ||
+             coord->Register.SwizzleY != TGSI_SWIZZLE_Y ||
+             samp->Register.File != TGSI_FILE_SAMPLER ||
+             samp->Register.Indirect ||
+             (inst->Texture.Texture != TGSI_TEXTURE_2D &&
+              inst->Texture.Texture != TGSI_TEXTURE_RECT)) {
+            ok = FALSE;
+            break;
+         }
+
+         if (is_color_output(shader, &inst->Dst[0])) {
+            have_output = TRUE;
+         }
+         else if (inst->Dst[0].Register.File == TGSI_FILE_TEMPORARY &&
+                  !inst->Dst[0].Register.Indirect &&
+                  inst->Dst[0].Register.WriteMask == TGSI_WRITEMASK_XYZW) {
+            tex_temp = inst->Dst[0].Register.Index;
+         }
+         else {
+            ok = FALSE;
+            break;
+         }
+
+         have_tex = TRUE;
+         *input = coord->Register.Index;
+         *unit = samp->Register.Index;
+         break;
+      }
+
+      case TGSI_OPCODE_MOV:
+      {
+         const struct tgsi_full_src_register *src = &inst->Src[0];
+
+         if (have_output ||
+             tex_temp < 0 ||
+             src->Register.File != TGSI_FILE_TEMPORARY ||
+             src->Register.Index != tex_temp ||
+             !is_plain_src(src) ||
+             src->Register.SwizzleX != TGSI_SWIZZLE_X ||
+             src->Register.SwizzleY != TGSI_SWIZZLE_Y ||
+             src->Register.SwizzleZ != TGSI_SWIZZLE_Z ||
+             src->Register.SwizzleW != TGSI_SWIZZLE_W ||
+             !is_color_output(shader, &inst->Dst[0])) {
+            ok = FALSE;
+            break;
+         }
+         have_output = TRUE;
+         break;
+      }
+
+      case TGSI_OPCODE_END:
+         done = TRUE;
+         break;
+
+      default:
+         ok = FALSE;
+         break;
+      }
+   }
+
+   tgsi_parse_free(&parse);
+
+   return ok && have_output;
+}
+
+
+/**
+ * Decide whether the variant can use the linear path and fill in
+ * variant->linear accordingly.
+ */
+void
+lp_linear_check_variant(struct lp_fragment_shader_variant *variant)
+{
+   const struct lp_fragment_shader_variant_key *key = &variant->key;
+   const struct lp_fragment_shader *shader = variant->shader;
+   const struct pipe_rt_blend_state *rt = &key->blend.rt[0];
+   struct lp_linear_info *linear = &variant->linear;
+   const struct lp_static_texture_state *texture;
+   const struct lp_static_sampler_state *sampler;
+   const struct util_format_description *cbuf_desc;
+   unsigned input, unit;
+   boolean nearest;
+
+   memset(linear, 0, sizeof *linear);
+
+   if (LP_PERF & PERF_NO_LINEAR_PATH)
+      return;
+
+   if (PIPE_ENDIAN_NATIVE != PIPE_ENDIAN_LITTLE)
+      return;
+
+   if (key->nr_cbufs != 1 ||
+       key->resource_1d ||
+       key->depth.enabled ||
+       key->stencil[0].enabled ||
+       key->alpha.enabled ||
+       key->occlusion_count ||
+       key->blend.logicop_enable ||
+       key->blend.alpha_to_coverage ||
+       key->blend.alpha_to_one)
+      return;
+
+   cbuf_desc = util_format_description(key->cbuf_format[0]);
+   if (!format_family(key->cbuf_format[0]) ||
+       !util_format_colormask_full(cbuf_desc, rt->colormask))
+      return;
+
+   if (rt->blend_enable) {
+      /* Only premultiplied (ONE) or non-premultiplied (SRC_ALPHA) "over" */
+      if (rt->rgb_func != PIPE_BLEND_ADD ||
+          rt->alpha_func != PIPE_BLEND_ADD ||
+          rt->rgb_dst_factor != PIPE_BLENDFACTOR_INV_SRC_ALPHA ||
+          rt->alpha_dst_factor != PIPE_BLENDFACTOR_INV_SRC_ALPHA ||
+          (rt->rgb_src_factor != PIPE_BLENDFACTOR_ONE &&
+           rt->rgb_src_factor != PIPE_BLENDFACTOR_SRC_ALPHA) ||
+          (rt->alpha_src_factor != PIPE_BLENDFACTOR_ONE &&
+           rt->alpha_src_factor != PIPE_BLENDFACTOR_SRC_ALPHA))
+         return;
+   }
+
+   if (!match_shader(shader, &input, &unit))
+      return;
+
+   if (input >= shader->info.base.num_inputs ||
+       unit >= key->nr_samplers ||
+       shader->inputs[input].cyl_wrap ||
+       (shader->inputs[input].interp != LP_INTERP_LINEAR &&
+        shader->inputs[input].interp != LP_INTERP_PERSPECTIVE))
+      return;
+
+   texture = &key->state[unit].texture_state;
+   sampler = &key->state[unit].sampler_state;
+
+   if (texture->tiled ||
+       format_family(texture->format) != format_family(key->cbuf_format[0]) ||
+       texture->swizzle_r != PIPE_SWIZZLE_X ||
+       texture->swizzle_g != PIPE_SWIZZLE_Y ||
+       texture->swizzle_b != PIPE_SWIZZLE_Z ||
+       (texture->swizzle_a != PIPE_SWIZZLE_W &&
+        texture->swizzle_a != PIPE_SWIZZLE_1))
+      return;
+
+   /* The sampler state alone decides whether coords are normalized */
+   if (texture->target != PIPE_TEXTURE_2D &&
+       texture->target != PIPE_TEXTURE_RECT)
+      return;
+
+   if (sampler->compare_mode != PIPE_TEX_COMPARE_NONE)
+      return;
+
+   nearest = sampler->min_img_filter == PIPE_TEX_FILTER_NEAREST &&
+             sampler->mag_img_filter == PIPE_TEX_FILTER_NEAREST &&
+             sampler->min_mip_filter == PIPE_TEX_MIPFILTER_NONE;
+
+   if (sampler->min_mip_filter != PIPE_TEX_MIPFILTER_NONE &&
+       (sampler->lod_bias_non_zero ||
+        sampler->apply_min_lod ||
+        sampler->min_max_lod_equal))
+      return;
+
+   linear->enabled = TRUE;
+   linear->blend = rt->blend_enable ? LP_LINEAR_BLEND_OVER :
+                                      LP_LINEAR_BLEND_NONE;
+   linear->rgb_src_alpha = rt->rgb_src_factor == PIPE_BLENDFACTOR_SRC_ALPHA;
+   linear->a_src_alpha = rt->alpha_src_factor == PIPE_BLENDFACTOR_SRC_ALPHA;
+   linear->src_alpha_one = texture->swizzle_a == PIPE_SWIZZLE_1 ||
+                           !util_format_has_alpha(texture->format);
+   linear->one_to_one = !nearest;
+   linear->wrap_clamp =
+      (sampler->wrap_s == PIPE_TEX_WRAP_CLAMP_TO_EDGE ||
+       (nearest && sampler->wrap_s == PIPE_TEX_WRAP_CLAMP)) &&
+      (sampler->wrap_t == PIPE_TEX_WRAP_CLAMP_TO_EDGE ||
+       (nearest && sampler->wrap_t == PIPE_TEX_WRAP_CLAMP));
+   linear->normalized = sampler->normalized_coords;
+   linear->perspective =
+      shader->inputs[input].interp == LP_INTERP_PERSPECTIVE;
+   linear->input = input;
+   linear->unit = unit;
+}
+
+
+/**
+ * Texture coordinate planes, in texels, plus where to fetch texels from.
+ */
+struct linear_setup
+{
+   float u0, dudx, dudy;
+   float v0, dvdx, dvdy;
+   float umax, vmax;
+   const uint8_t *texels;
+   unsigned stride;
+};
+
+
+static boolean
+linear_setup_init(struct linear_setup *ls,
+                  const struct lp_linear_info *linear,
+                  const struct lp_jit_texture *tex,
+                  const struct lp_rast_shader_inputs *inputs)
+{
+   const float (*a0)[4] = (const float (*)[4]) GET_A0(inputs);
+   const float (*dadx)[4] = (const float (*)[4]) GET_DADX(inputs);
+   const float (*dady)[4] = (const float (*)[4]) GET_DADY(inputs);
+   const unsigned slot = 1 + linear->input;
+   const unsigned level = tex->first_level;
+   unsigned width, height;
+   float su = 1.0f, sv = 1.0f;
+
+   if (!tex->base || level >= LP_MAX_TEXTURE_LEVELS)
+      return FALSE;
+
+   width = u_minify(tex->width, level);
+   height = u_minify(tex->height, level);
+
+   if (linear->normalized) {
+      su = (float) width;
+      sv = (float) height;
+   }
+
+   if (linear->perspective) {
+      /* w is constant across the triangle, see lp_linear_check_triangle */
+      const float oow = 1.0f / a0[0][3];
+      su *= oow;
+      sv *= oow;
+   }
+
+   ls->u0 = a0[slot][0] * su;
+   ls->dudx = dadx[slot][0] * su;
+   ls->dudy = dady[slot][0] * su;
+   ls->v0 = a0[slot][1] * sv;
+   ls->dvdx = dadx[slot][1] * sv;
+   ls->dvdy = dady[slot][1] * sv;
+   ls->umax = (float) (width - 1);
+   ls->vmax = (float) (height - 1);
+   ls->texels = (const uint8_t *) tex->base + tex->mip_offsets[level];
+   ls->stride = tex->row_stride[level];
+
+   return TRUE;
+}
+
+
+/**
+ * Is the coefficient (in texels per pixel) +/-1 or 0, to within an error
+ * which stays below LINEAR_EPSILON across the given extent?
+ */
+static inline boolean
+is_unit_step(float d, float extent, boolean zero)
+{
+   float target = zero ? 0.0f : (d < 0.0f ? -1.0f : 1.0f);
+   return fabsf(d - target) * extent <= LINEAR_EPSILON;
+}
+
+
+static inline boolean
+is_texel_center(float c)
+{
+   return fabsf(c - floorf(c) - 0.5f) <= LINEAR_EPSILON;
+}
+
+
+/**
+ * Decide whether a triangle using a linear variant can actually be shaded
+ * by the linear path.  Called at setup time, after the coefficients have
+ * been computed.
+ */
+boolean
+lp_linear_check_triangle(const struct lp_fragment_shader_variant *variant,
+                         const struct lp_jit_context *jit_context,
+                         const struct lp_rast_shader_inputs *inputs,
+                         const struct u_rect *bbox)
+{
+   const struct lp_linear_info *linear = &variant->linear;
+   const struct lp_jit_texture *tex;
+   struct linear_setup ls;
+   float x0, y0, x1, y1;
+
+   if (!linear->enabled)
+      return FALSE;
+
+   if (linear->perspective) {
+      const float (*a0)[4] = (const float (*)[4]) GET_A0(inputs);
+      const float (*dadx)[4] = (const float (*)[4]) GET_DADX(inputs);
+      const float (*dady)[4] = (const float (*)[4]) GET_DADY(inputs);
+
+      /* Only affine when w is the same at all three vertices */
+      if (dadx[0][3] != 0.0f || dady[0][3] != 0.0f || !(a0[0][3] > 0.0f))
+         return FALSE;
+   }
+
+   tex = &jit_context->textures[linear->unit];
+   if (!linear_setup_init(&ls, linear, tex, inputs))
+      return FALSE;
+
+   x0 = (float) bbox->x0;
+   y0 = (float) bbox->y0;
+   x1 = (float) bbox->x1;
+   y1 = (float) bbox->y1;
+
+   if (linear->one_to_one) {
+      const float w = x1 - x0 + 1.0f;
+      const float h = y1 - y0 + 1.0f;
+      const float extent = w + h;
+
+      /* No scaling, no rotation other than flips, texel centers on pixels */
+      if (!is_unit_step(ls.dudx, extent, FALSE) ||
+          !is_unit_step(ls.dudy, extent, TRUE) ||
+          !is_unit_step(ls.dvdx, extent, TRUE) ||
+          !is_unit_step(ls.dvdy, extent, FALSE) ||
+          !is_texel_center(ls.u0 + ls.dudx * x0 + ls.dudy * y0) ||
+          !is_texel_center(ls.v0 + ls.dvdx * x0 + ls.dvdy * y0))
+         return FALSE;
+   }
+
+   if (!linear->wrap_clamp) {
+      /* Coords are affine, so checking the bounding box corners suffices */
+      const float umax = ls.umax + 1.0f, vmax = ls.vmax + 1.0f;
+      const float xs[2] = { x0, x1 }, ys[2] = { y0, y1 };
+      unsigned i;
+
+      for (i = 0; i < 4; i++) {
+         float x = xs[i & 1], y = ys[i >> 1];
+         float u = ls.u0 + ls.dudx * x + ls.dudy * y;
+         float v = ls.v0 + ls.dvdx * x + ls.dvdy * y;
+
+         if (!(u >= 0.0f && u <= umax && v >= 0.0f && v <= vmax))
+            return FALSE;
+      }
+   }
+
+   return TRUE;
+}
+
+
+static inline uint32_t
+fetch_texel(const struct linear_setup *ls, float u, float v)
+{
+   int iu, iv;
+
+   /* Written so that NaNs end up as zero */
+   u = u > 0.0f ? u : 0.0f;
+   v = v > 0.0f ? v : 0.0f;
+   iu = (int) MIN2(u, ls->umax);
+   iv = (int) MIN2(v, ls->vmax);
+
+   return *(const uint32_t *) (ls->texels + iv * ls->stride + iu * 4);
+}
+
+
+static inline unsigned
+div255(unsigned x)
+{
+   x += 128;
+   return (x + (x >> 8)) >> 8;
+}
+
+
+/**
+ * Blend four texels into the color buffer.
+ */
+static inline void
+blend4(const struct lp_linear_info *linear,
+       const uint32_t src[4], uint32_t *dst, unsigned mask)
+{
+   uint32_t res[4];
+   unsigned i;
+
+   if (linear->blend == LP_LINEAR_BLEND_NONE) {
+      for (i = 0; i < 4; i++) {
+         if (mask & (1 << i))
+            dst[i] = src[i];
+      }
+      return;
+   }
+
+#if defined(PIPE_ARCH_SSE)
+   {
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i c128 = _mm_set1_epi16(128);
+      const __m128i c255 = _mm_set1_epi16(255);
+      const short rgb = linear->rgb_src_alpha ? -1 : 0;
+      const short a = linear->a_src_alpha ? -1 : 0;
+      const __m128i sel = _mm_set_epi16(a, rgb, rgb, rgb, a, rgb, rgb, rgb);
+      __m128i s = _mm_loadu_si128((const __m128i *) src);
+      __m128i d = _mm_loadu_si128((const __m128i *) dst);
+      __m128i half[2];
+      unsigned j;
+
+      for (j = 0; j < 2; j++) {
+         __m128i s16, d16, sa, fs, t0, t1;
+
+         s16 = j ? _mm_unpackhi_epi8(s, zero) : _mm_unpacklo_epi8(s, zero);
+         d16 = j ? _mm_unpackhi_epi8(d, zero) : _mm_unpacklo_epi8(d, zero);
+
+         sa = _mm_shufflelo_epi16(s16, _MM_SHUFFLE(3, 3, 3, 3));
+         sa = _mm_shufflehi_epi16(sa, _MM_SHUFFLE(3, 3, 3, 3));
+         fs = _mm_or_si128(_mm_and_si128(sel, sa), _mm_andnot_si128(sel, c255));
+
+         /* t = div255(s * fs) + div255(d * (255 - sa)) */
+         t0 = _mm_add_epi16(_mm_mullo_epi16(s16, fs), c128);
+         t0 = _mm_srli_epi16(_mm_add_epi16(t0, _mm_srli_epi16(t0, 8)), 8);
+         t1 = _mm_mullo_epi16(d16, _mm_sub_epi16(c255, sa));
+         t1 = _mm_add_epi16(t1, c128);
+         t1 = _mm_srli_epi16(_mm_add_epi16(t1, _mm_srli_epi16(t1, 8)), 8);
+         half[j] = _mm_add_epi16(t0, t1);
+      }
+
+      _mm_storeu_si128((__m128i *) res, _mm_packus_epi16(half[0], half[1]));
+   }
+#else
+   for (i = 0; i < 4; i++) {
+      const uint8_t *s = (const uint8_t *) &src[i];
+      const uint8_t *d = (const uint8_t *) &dst[i];
+      uint8_t *r = (uint8_t *) &res[i];
+      unsigned sa = s[3];
+      unsigned c;
+
+      for (c = 0; c < 4; c++) {
+         unsigned fs = (c == 3 ? linear->a_src_alpha : linear->rgb_src_alpha)
+                       ? sa : 255;
+         unsigned t = div255(s[c] * fs) + div255(d[c] * (255 - sa));
+         r[c] = MIN2(t, 255);
+      }
+   }
+#endif
+
+   if (mask == 0xf) {
+      memcpy(dst, res, sizeof res);
+   }
+   else {
+      for (i = 0; i < 4; i++) {
+         if (mask & (1 << i))
+            dst[i] = res[i];
+      }
+   }
+}
+
+
+/**
+ * Shade four horizontally adjacent pixels starting at window position x, y.
+ */
+static inline void
+shade_span4(const struct lp_linear_info *linear,
+            const struct linear_setup *ls,
+            int x, int y, uint32_t *dst, unsigned mask)
+{
+   float u = ls->u0 + ls->dudx * x + ls->dudy * y;
+   float v = ls->v0 + ls->dvdx * x + ls->dvdy * y;
+   uint32_t src[4];
+   unsigned i;
+
+   for (i = 0; i < 4; i++) {
+      src[i] = fetch_texel(ls, u, v);
+      if (linear->src_alpha_one)
+         src[i] |= 0xff000000;
+      u += ls->dudx;
+      v += ls->dvdx;
+   }
+
+   blend4(linear, src, dst, mask);
+}
+
+
+/**
+ * Shade a whole tile (or the part of it inside the framebuffer).
+ */
+void
+lp_linear_shade_tile(struct lp_rasterizer_task *task,
+                     const struct lp_rast_shader_inputs *inputs)
+{
+   const struct lp_rast_state *state = task->state;
+   const struct lp_linear_info *linear = &state->variant->linear;
+   const unsigned stride = task->scene->cbufs[0].stride;
+   struct linear_setup ls;
+   uint8_t *color;
+   unsigned x, y;
+
+   if (!linear_setup_init(&ls, linear,
+                          &state->jit_context.textures[linear->unit],
+                          inputs))
+      return;
+
+   color = lp_rast_get_color_block_pointer(task, 0, task->x, task->y,
+                                           inputs->layer);
+
+   /* Color tiles are allocated in whole 4x4 blocks, like the JIT path */
+   for (y = 0; y < task->height; y++) {
+      uint32_t *row = (uint32_t *) (color + y * stride);
+
+      for (x = 0; x < task->width; x += 4) {
+         shade_span4(linear, &ls, task->x + x, task->y + y, row + x, 0xf);
+      }
+   }
+}
+
+
+/**
+ * Shade the pixels of a 4x4 block indicated by mask, where bit (y*4 + x)
+ * corresponds to the pixel at (x, y) within the block.
+ */
+void
+lp_linear_shade_block(struct lp_rasterizer_task *task,
+                      const struct lp_rast_shader_inputs *inputs,
+                      unsigned x, unsigned y,
+                      unsigned mask)
+{
+   const struct lp_rast_state *state = task->state;
+   const struct lp_linear_info *linear = &state->variant->linear;
+   const unsigned stride = task->scene->cbufs[0].stride;
+   struct linear_setup ls;
+   uint8_t *color;
+   unsigned i;
+
+   if (!linear_setup_init(&ls, linear,
+                          &state->jit_context.textures[linear->unit],
+                          inputs))
+      return;
+
+   color = lp_rast_get_color_block_pointer(task, 0, x, y, inputs->layer);
+
+   for (i = 0; i < 4; i++) {
+      unsigned row_mask = (mask >> (4 * i)) & 0xf;
+
+      if (row_mask) {
+         shade_span4(linear, &ls, x, y + i,
+                     (uint32_t *) (color + i * stride), row_mask);
+      }
+   }
+}
@@ -0,0 +1,98 @@
+/**************************************************************************
+ * 
+ * Copyright 2018 VMware, Inc.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ **************************************************************************/
+
+
+/**
+ * Linear fast path.
+ *
+ * Most 2D and compositing work (window systems, video players, GUI
+ * toolkits) draws screen-aligned quads with a single unfiltered texture
+ * lookup, optionally blended with premultiplied alpha.  For those the
+ * generic 4x4 SoA fragment pipeline does a lot of useless work:
+ * interpolating in float, swizzling between SoA and AoS and converting
+ * to and from float.  Instead we detect them here, once per variant and
+ * once per triangle, and shade them with straight 8-bit span code.
+ */
+
+#ifndef LP_LINEAR_H
+#define LP_LINEAR_H
+
+#include "pipe/p_compiler.h"
+
+
+struct lp_fragment_shader_variant;
+struct lp_jit_context;
+struct lp_rast_shader_inputs;
+struct lp_rasterizer_task;
+struct u_rect;
+
+
+enum lp_linear_blend {
+   LP_LINEAR_BLEND_NONE = 0,   /**< dst = src */
+   LP_LINEAR_BLEND_OVER        /**< dst = src * fsrc + dst * (1 - src.a) */
+};
+
+
+/**
+ * What a fragment shader variant does, when it qualifies for the linear
+ * path.  Computed from the variant key and the shader tokens.
+ */
+struct lp_linear_info {
+   unsigned enabled:1;
+   unsigned blend:1;            /**< enum lp_linear_blend */
+   unsigned rgb_src_alpha:1;    /**< rgb src factor is SRC_ALPHA, not ONE */
+   unsigned a_src_alpha:1;      /**< alpha src factor is SRC_ALPHA, not ONE */
+   unsigned src_alpha_one:1;    /**< texture has no alpha channel */
+   unsigned one_to_one:1;       /**< sampling needs texel centers hit exactly */
+   unsigned wrap_clamp:1;       /**< out of range coords are clamped */
+   unsigned normalized:1;       /**< coords are in [0,1], not in texels */
+   unsigned perspective:1;      /**< input is perspective interpolated */
+   unsigned input:8;            /**< fragment shader input with the coords */
+   unsigned unit:8;             /**< texture and sampler unit */
+};
+
+
+void
+lp_linear_check_variant(struct lp_fragment_shader_variant *variant);
+
+boolean
+lp_linear_check_triangle(const struct lp_fragment_shader_variant *variant,
+                         const struct lp_jit_context *jit_context,
+                         const struct lp_rast_shader_inputs *inputs,
+                         const struct u_rect *bbox);
+
+void
+lp_linear_shade_tile(struct lp_rasterizer_task *task,
+                     const struct lp_rast_shader_inputs *inputs);
+
+void
+lp_linear_shade_block(struct lp_rasterizer_task *task,
+                      const struct lp_rast_shader_inputs *inputs,
+                      unsigned x, unsigned y,
+                      unsigned mask);
+
+
+#endif /* LP_LINEAR_H */
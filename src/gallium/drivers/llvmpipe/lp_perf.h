@@ -56,10 +56,13 @@ struct lp_counters
    unsigned nr_fully_covered_4;
    unsigned nr_partially_covered_4;
    unsigned nr_non_empty_4;
+   unsigned nr_hiz_reject_16;
+   unsigned nr_hiz_reject_tri;
    unsigned nr_llvm_compiles;
    int64_t llvm_compile_time;  /**< total, in microseconds */
 
    unsigned nr_color_tile_clear;
+   unsigned nr_color_tile_clear_deferred;
    unsigned nr_color_tile_load;
    unsigned nr_color_tile_store;
 };
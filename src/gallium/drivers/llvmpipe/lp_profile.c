@@ -0,0 +1,258 @@
+/**************************************************************************
+ * 
+ * Copyright 2018 VMware, Inc.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ **************************************************************************/
+
+
+/**
+ * Frame profiler, see lp_profile.h.
+ *
+ * The output is the JSON array form of the trace event format, one
+ * complete ("X") event per line, with thread name metadata up front.
+ */
+
+
+#include <stdio.h>
+
+#include "util/u_atomic.h"
+#include "util/u_debug.h"
+#include "util/u_memory.h"
+#include "util/u_string.h"
+
+#include "lp_debug.h"
+#include "lp_profile.h"
+#include "lp_rast.h"
+#include "lp_rast_priv.h"
+#include "lp_scene.h"
+
+
+/** Trace thread id for the binning events */
+#define LP_PROFILE_SETUP_TID 1000
+
+
+struct lp_profile
+{
+   FILE *file;
+   int64_t t0;                 /**< time base for the trace */
+   int64_t scene_start;        /**< when rasterization of the scene began */
+   unsigned scene_no;
+};
+
+
+static inline double
+profile_us(const struct lp_profile *profile, int64_t t)
+{
+   return (double) (t - profile->t0) / 1000.0;
+}
+
+
+static void
+profile_write_thread_name(struct lp_profile *profile,
+                          unsigned tid, const char *name)
+{
+   fprintf(profile->file,
+           "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+           "\"args\":{\"name\":\"%s\"}},\n",
+           tid, name);
+}
+
+
+/** Number of rasterizers which opened a trace file so far */
+static int profile_count = 0;
+
+
+/**
+ * Open the trace file and allocate the per thread rings, if LP_PROFILE
+ * is set.  Returns NULL otherwise.
+ *
+ * Every context has its own rasterizer and so its own trace.  The first
+ * one writes to the LP_PROFILE file, later ones to <file>.<n> so they
+ * don't truncate each other's.
+ */
+struct lp_profile *
+lp_profile_create(struct lp_rasterizer *rast)
+{
+   const char *option = debug_get_option("LP_PROFILE", NULL);
+   char filename[1024];
+   struct lp_profile *profile;
+   unsigned i;
+   int n;
+
+   if (!option || !*option)
+      return NULL;
+
+   profile = CALLOC_STRUCT(lp_profile);
+   if (!profile)
+      return NULL;
+
+   n = p_atomic_inc_return(&profile_count) - 1;
+   if (n == 0)
+      util_snprintf(filename, sizeof filename, "%s", option);
+   else
+      util_snprintf(filename, sizeof filename, "%s.%d", option, n);
+
+   profile->file = fopen(filename, "w");
+   if (!profile->file) {
+      debug_printf("llvmpipe: couldn't open profile file %s\n", filename);
+      FREE(profile);
+      return NULL;
+   }
+
+   for (i = 0; i < MAX2(1, rast->num_threads); i++) {
+      rast->tasks[i].profile.events =
+         MALLOC(LP_PROFILE_RING_SIZE * sizeof(struct lp_profile_event));
+      rast->tasks[i].profile.count = 0;
+      if (!rast->tasks[i].profile.events) {
+         lp_profile_destroy(rast, profile);
+         return NULL;
+      }
+   }
+
+   profile->t0 = os_time_get_nano();
+
+   fprintf(profile->file, "[\n");
+   profile_write_thread_name(profile, LP_PROFILE_SETUP_TID, "setup");
+   for (i = 0; i < MAX2(1, rast->num_threads); i++) {
+      char name[16];
+      util_snprintf(name, sizeof name, "llvmpipe-%u", i);
+      profile_write_thread_name(profile, i, name);
+   }
+
+   return profile;
+}
+
+
+void
+lp_profile_destroy(struct lp_rasterizer *rast, struct lp_profile *profile)
+{
+   unsigned i;
+
+   for (i = 0; i < MAX2(1, rast->num_threads); i++) {
+      FREE(rast->tasks[i].profile.events);
+      rast->tasks[i].profile.events = NULL;
+   }
+
+   if (profile->file) {
+      /* the metadata event just avoids the trailing comma */
+      fprintf(profile->file,
+              "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+              "\"args\":{\"name\":\"llvmpipe\"}}\n]\n");
+      fclose(profile->file);
+   }
+
+   FREE(profile);
+}
+
+
+/**
+ * Called by the thread that begins rasterizing a scene.
+ */
+void
+lp_profile_begin_scene(struct lp_profile *profile)
+{
+   profile->scene_start = os_time_get_nano();
+}
+
+
+/**
+ * Write out the events of a scene, once all threads are done with it.
+ */
+void
+lp_profile_end_scene(struct lp_rasterizer *rast,
+                     struct lp_profile *profile,
+                     const struct lp_scene *scene)
+{
+   FILE *f = profile->file;
+   const int64_t scene_end = os_time_get_nano();
+   unsigned i;
+
+   fprintf(f,
+           "{\"name\":\"bin scene %u\",\"cat\":\"setup\",\"ph\":\"X\","
+           "\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+           "\"args\":{\"tiles\":\"%ux%u\"}},\n",
+           profile->scene_no, LP_PROFILE_SETUP_TID,
+           profile_us(profile, scene->bin_start),
+           (scene->bin_end - scene->bin_start) / 1000.0,
+           scene->tiles_x, scene->tiles_y);
+
+   for (i = 0; i < MAX2(1, rast->num_threads); i++) {
+      struct lp_profile_ring *ring = &rast->tasks[i].profile;
+      unsigned first = 0;
+      unsigned j;
+
+      fprintf(f,
+              "{\"name\":\"scene %u\",\"cat\":\"scene\",\"ph\":\"X\","
+              "\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},\n",
+              profile->scene_no, i,
+              profile_us(profile, profile->scene_start),
+              (scene_end - profile->scene_start) / 1000.0);
+
+      if (ring->count > LP_PROFILE_RING_SIZE) {
+         first = ring->count - LP_PROFILE_RING_SIZE;
+         fprintf(f,
+                 "{\"name\":\"%u events dropped\",\"ph\":\"i\",\"s\":\"t\","
+                 "\"pid\":1,\"tid\":%u,\"ts\":%.3f},\n",
+                 first, i, profile_us(profile, profile->scene_start));
+      }
+
+      for (j = first; j < ring->count; j++) {
+         const struct lp_profile_event *event =
+            &ring->events[j & (LP_PROFILE_RING_SIZE - 1)];
+
+         if (event->type == LP_PROFILE_BIN) {
+            fprintf(f,
+                    "{\"name\":\"bin %u,%u\",\"cat\":\"bin\",\"ph\":\"X\","
+                    "\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f},\n",
+                    event->x, event->y, i,
+                    profile_us(profile, event->start),
+                    (event->end - event->start) / 1000.0);
+         }
+         else if (event->variant != LP_PROFILE_NO_VARIANT) {
+            fprintf(f,
+                    "{\"name\":\"%s fs%u\",\"cat\":\"cmd\",\"ph\":\"X\","
+                    "\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+                    "\"args\":{\"tile\":\"%u,%u\",\"variant\":%u}},\n",
+                    lp_rast_cmd_name(event->cmd), event->variant, i,
+                    profile_us(profile, event->start),
+                    (event->end - event->start) / 1000.0,
+                    event->x, event->y, event->variant);
+         }
+         else {
+            fprintf(f,
+                    "{\"name\":\"%s\",\"cat\":\"cmd\",\"ph\":\"X\","
+                    "\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+                    "\"args\":{\"tile\":\"%u,%u\"}},\n",
+                    lp_rast_cmd_name(event->cmd), i,
+                    profile_us(profile, event->start),
+                    (event->end - event->start) / 1000.0,
+                    event->x, event->y);
+         }
+      }
+
+      ring->count = 0;
+   }
+
+   fflush(f);
+   profile->scene_no++;
+}
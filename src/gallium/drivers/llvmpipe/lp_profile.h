@@ -0,0 +1,117 @@
+/**************************************************************************
+ * 
+ * Copyright 2018 VMware, Inc.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ **************************************************************************/
+
+
+/**
+ * Frame profiler.
+ *
+ * With LP_PROFILE=<file>, every rasterizer thread records when it starts
+ * and finishes each bin and each bin command into a ring buffer.  Once a
+ * scene is rasterized, the events of all threads are appended to the file
+ * in Chrome's trace event format, together with the time the scene took
+ * to bin.  The result can be loaded into chrome://tracing or Perfetto to
+ * see how work is spread across threads and which shader variants cost
+ * the most.  Contexts after the first write to <file>.1, <file>.2, etc.
+ */
+
+#ifndef LP_PROFILE_H
+#define LP_PROFILE_H
+
+#include "pipe/p_compiler.h"
+#include "util/os_time.h"
+
+
+/** Events kept per thread and scene, must be a power of two */
+#define LP_PROFILE_RING_SIZE (1 << 16)
+
+#define LP_PROFILE_NO_VARIANT (~0U)
+
+struct lp_rasterizer;
+struct lp_scene;
+
+
+enum lp_profile_event_type
+{
+   LP_PROFILE_BIN,
+   LP_PROFILE_CMD
+};
+
+
+struct lp_profile_event
+{
+   int64_t start, end;         /**< os_time_get_nano() */
+   uint16_t x, y;              /**< tile position, in tiles */
+   uint8_t type;               /**< enum lp_profile_event_type */
+   uint8_t cmd;                /**< LP_RAST_OP_x */
+   unsigned variant;           /**< fragment shader variant number */
+};
+
+
+/**
+ * Per thread event ring.  'events' is NULL unless profiling.
+ */
+struct lp_profile_ring
+{
+   struct lp_profile_event *events;
+   unsigned count;             /**< events recorded, may exceed the size */
+};
+
+
+static inline void
+lp_profile_record(struct lp_profile_ring *ring,
+                  enum lp_profile_event_type type,
+                  unsigned cmd, unsigned x, unsigned y,
+                  unsigned variant, int64_t start)
+{
+   struct lp_profile_event *event =
+      &ring->events[ring->count++ & (LP_PROFILE_RING_SIZE - 1)];
+
+   event->start = start;
+   event->end = os_time_get_nano();
+   event->x = x;
+   event->y = y;
+   event->type = type;
+   event->cmd = cmd;
+   event->variant = variant;
+}
+
+
+struct lp_profile *
+lp_profile_create(struct lp_rasterizer *rast);
+
+void
+lp_profile_destroy(struct lp_rasterizer *rast, struct lp_profile *profile);
+
+void
+lp_profile_begin_scene(struct lp_profile *profile);
+
+void
+lp_profile_end_scene(struct lp_rasterizer *rast,
+                     struct lp_profile *profile,
+                     const struct lp_scene *scene);
+
+
+#endif /* LP_PROFILE_H */
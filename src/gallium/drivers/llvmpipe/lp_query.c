@@ -48,19 +48,46 @@ static struct llvmpipe_query *llvmpipe_query( struct pipe_query *p )
    return (struct llvmpipe_query *)p;
 }
 
+/**
+ * Current value of the counter of a driver specific query.
+ */
+static uint64_t
+lp_driver_query_count(const struct llvmpipe_context *llvmpipe, unsigned type)
+{
+   switch (type) {
+   case LP_QUERY_FS_VARIANT_HITS:
+      return llvmpipe->fs_variant_hits;
+   case LP_QUERY_FS_VARIANT_MISSES:
+      return llvmpipe->fs_variant_misses;
+   case LP_QUERY_FS_VARIANT_EVICTIONS:
+      return llvmpipe->fs_variant_evictions;
+   default:
+      assert(0);
+      return 0;
+   }
+}
+
+
 static struct pipe_query *
 llvmpipe_create_query(struct pipe_context *pipe, 
                       unsigned type,
                       unsigned index)
 {
+   struct llvmpipe_screen *screen = llvmpipe_screen(pipe->screen);
+   unsigned num_threads = MAX2(1, screen->num_threads);
    struct llvmpipe_query *pq;
 
-   assert(type < PIPE_QUERY_TYPES);
+   assert(type < PIPE_QUERY_TYPES ||
+          (type >= PIPE_QUERY_DRIVER_SPECIFIC && type <= LP_QUERY_LAST));
 
-   pq = CALLOC_STRUCT( llvmpipe_query );
+   /* The per-thread counters are allocated along with the query */
+   pq = CALLOC(1, sizeof *pq + 2 * num_threads * sizeof(uint64_t));
 
    if (pq) {
       pq->type = type;
+      pq->num_threads = num_threads;
+      pq->start = (uint64_t *)(pq + 1);
+      pq->end = pq->start + num_threads;
    }
 
    return (struct pipe_query *) pq;
@@ -95,9 +122,8 @@ llvmpipe_get_query_result(struct pipe_context *pipe,
                           boolean wait,
                           union pipe_query_result *vresult)
 {
-   struct llvmpipe_screen *screen = llvmpipe_screen(pipe->screen);
-   unsigned num_threads = MAX2(1, screen->num_threads);
    struct llvmpipe_query *pq = llvmpipe_query(q);
+   unsigned num_threads = pq->num_threads;
    uint64_t *result = (uint64_t *)vresult;
    int i;
 
@@ -119,6 +145,11 @@ llvmpipe_get_query_result(struct pipe_context *pipe,
    *result = 0;
 
    switch (pq->type) {
+   case LP_QUERY_FS_VARIANT_HITS:
+   case LP_QUERY_FS_VARIANT_MISSES:
+   case LP_QUERY_FS_VARIANT_EVICTIONS:
+      *result = pq->driver_count;
+      break;
    case PIPE_QUERY_OCCLUSION_COUNTER:
       for (i = 0; i < num_threads; i++) {
          *result += pq->end[i];
@@ -192,6 +223,12 @@ llvmpipe_begin_query(struct pipe_context *pipe, struct pipe_query *q)
    struct llvmpipe_context *llvmpipe = llvmpipe_context( pipe );
    struct llvmpipe_query *pq = llvmpipe_query(q);
 
+   /* Driver specific counters are kept by the context, not binned */
+   if (pq->type >= PIPE_QUERY_DRIVER_SPECIFIC) {
+      pq->driver_count = lp_driver_query_count(llvmpipe, pq->type);
+      return true;
+   }
+
    /* Check if the query is already in the scene.  If so, we need to
     * flush the scene now.  Real apps shouldn't re-use a query in a
     * frame of rendering.
@@ -201,8 +238,8 @@ llvmpipe_begin_query(struct pipe_context *pipe, struct pipe_query *q)
    }
 
 
-   memset(pq->start, 0, sizeof(pq->start));
-   memset(pq->end, 0, sizeof(pq->end));
+   memset(pq->start, 0, pq->num_threads * sizeof(pq->start[0]));
+   memset(pq->end, 0, pq->num_threads * sizeof(pq->end[0]));
    lp_setup_begin_query(llvmpipe->setup, pq);
 
    switch (pq->type) {
@@ -249,6 +286,12 @@ llvmpipe_end_query(struct pipe_context *pipe, struct pipe_query *q)
    struct llvmpipe_context *llvmpipe = llvmpipe_context( pipe );
    struct llvmpipe_query *pq = llvmpipe_query(q);
 
+   if (pq->type >= PIPE_QUERY_DRIVER_SPECIFIC) {
+      pq->driver_count = lp_driver_query_count(llvmpipe, pq->type) -
+                         pq->driver_count;
+      return true;
+   }
+
    lp_setup_end_query(llvmpipe->setup, pq);
 
    switch (pq->type) {
@@ -328,6 +371,33 @@ llvmpipe_check_render_cond(struct llvmpipe_context *lp)
       return TRUE;
 }
 
+int
+llvmpipe_get_driver_query_info(struct pipe_screen *screen,
+                               unsigned index,
+                               struct pipe_driver_query_info *info)
+{
+#define QUERY(NAME, ENUM) \
+   {NAME, ENUM, {0}, PIPE_DRIVER_QUERY_TYPE_UINT64, \
+    PIPE_DRIVER_QUERY_RESULT_TYPE_CUMULATIVE, 0, 0x0}
+
+   static const struct pipe_driver_query_info queries[] = {
+      QUERY("fs-variant-hits", LP_QUERY_FS_VARIANT_HITS),
+      QUERY("fs-variant-misses", LP_QUERY_FS_VARIANT_MISSES),
+      QUERY("fs-variant-evictions", LP_QUERY_FS_VARIANT_EVICTIONS),
+   };
+
+#undef QUERY
+
+   if (!info)
+      return ARRAY_SIZE(queries);
+
+   if (index >= ARRAY_SIZE(queries))
+      return 0;
+
+   *info = queries[index];
+   return 1;
+}
+
 static void
 llvmpipe_set_active_query_state(struct pipe_context *pipe, boolean enable)
 {
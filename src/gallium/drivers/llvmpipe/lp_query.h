@@ -39,15 +39,26 @@
 
 
 struct llvmpipe_context;
+struct pipe_screen;
+struct pipe_driver_query_info;
+
+
+/** Driver specific queries, see llvmpipe_get_driver_query_info() */
+#define LP_QUERY_FS_VARIANT_HITS      (PIPE_QUERY_DRIVER_SPECIFIC + 0)
+#define LP_QUERY_FS_VARIANT_MISSES    (PIPE_QUERY_DRIVER_SPECIFIC + 1)
+#define LP_QUERY_FS_VARIANT_EVICTIONS (PIPE_QUERY_DRIVER_SPECIFIC + 2)
+#define LP_QUERY_LAST                 LP_QUERY_FS_VARIANT_EVICTIONS
 
 
 struct llvmpipe_query {
-   uint64_t start[LP_MAX_THREADS];  /* start count value for each thread */
-   uint64_t end[LP_MAX_THREADS];    /* end count value for each thread */
+   uint64_t *start;                 /* start count value for each thread */
+   uint64_t *end;                   /* end count value for each thread */
+   unsigned num_threads;            /* size of the start/end arrays */
    struct lp_fence *fence;          /* fence from last scene this was binned in */
    unsigned type;                   /* PIPE_QUERY_* */
    unsigned num_primitives_generated;
    unsigned num_primitives_written;
+   uint64_t driver_count;           /* LP_QUERY_* counter value */
 
    struct pipe_query_data_pipeline_statistics stats;
 };
@@ -57,4 +68,8 @@ extern void llvmpipe_init_query_funcs(struct llvmpipe_context * );
 
 extern boolean llvmpipe_check_render_cond(struct llvmpipe_context *);
 
+extern int llvmpipe_get_driver_query_info(struct pipe_screen *screen,
+                                          unsigned index,
+                                          struct pipe_driver_query_info *info);
+
 #endif /* LP_QUERY_H */
@@ -26,6 +26,7 @@
  **************************************************************************/
 
 #include <limits.h>
+#include "util/u_cpu_detect.h"
 #include "util/u_memory.h"
 #include "util/u_math.h"
 #include "util/u_rect.h"
@@ -69,17 +70,120 @@ lp_rast_begin( struct lp_rasterizer *rast,
 
    LP_DBG(DEBUG_RAST, "%s\n", __FUNCTION__);
 
+   if (rast->profile)
+      lp_profile_begin_scene(rast->profile);
+
    lp_scene_begin_rasterization( scene );
    lp_scene_bin_iter_begin( scene );
 }
 
 
+/**
+ * Finish rasterizing a scene: reset it and signal its fence, after which
+ * the setup module may reuse it.
+ * Called once per scene by one thread.
+ */
 static void
 lp_rast_end( struct lp_rasterizer *rast )
 {
-   lp_scene_end_rasterization( rast->curr_scene );
+   struct lp_scene *scene = rast->curr_scene;
+   struct lp_fence *fence = NULL;
+
+   if (rast->profile)
+      lp_profile_end_scene(rast, rast->profile, scene);
+
+   /* The scene drops its fence reference when it is reset */
+   lp_fence_reference(&fence, scene->fence);
+
+   lp_scene_end_rasterization( scene );
 
    rast->curr_scene = NULL;
+
+   if (fence) {
+      lp_fence_signal(fence);
+      lp_fence_reference(&fence, NULL);
+   }
+}
+
+
+/**
+ * Set up fast clears for the current tile.
+ *
+ * If a bin contains nothing but clears, color clears just record the
+ * clear color in the resource's tile_clear entry.  Otherwise a previously
+ * recorded clear is written out now, unless the bin starts by clearing
+ * the whole tile anyway.
+ */
+static void
+lp_rast_tile_begin_clears(struct lp_rasterizer_task *task,
+                          const struct cmd_bin *bin,
+                          int x, int y)
+{
+   const struct lp_scene *scene = task->scene;
+   const struct cmd_block *block;
+   unsigned cleared_first = 0;
+   boolean shaded = FALSE;
+   unsigned i, k;
+
+   task->defer_clear = 0;
+
+   for (i = 0; i < scene->fb.nr_cbufs; i++) {
+      const struct pipe_surface *cbuf = scene->fb.cbufs[i];
+      struct llvmpipe_resource *lpr;
+
+      task->tile_clear[i] = NULL;
+      if (!cbuf || !llvmpipe_resource_is_texture(cbuf->texture))
+         continue;
+
+      lpr = llvmpipe_resource(cbuf->texture);
+      if (lpr->tile_clear &&
+          cbuf->u.tex.level == 0 && cbuf->u.tex.first_layer == 0) {
+         task->tile_clear[i] = &lpr->tile_clear[y * lpr->tiles_x + x];
+      }
+   }
+
+   for (block = bin->head; block && !shaded; block = block->next) {
+      for (k = 0; k < block->count; k++) {
+         const unsigned cmd = block->cmd[k];
+
+         if (cmd == LP_RAST_OP_CLEAR_COLOR) {
+            cleared_first |= 1 << block->arg[k].clear_rb->cbuf;
+         }
+         else if (cmd != LP_RAST_OP_CLEAR_ZSTENCIL &&
+                  cmd != LP_RAST_OP_SET_STATE &&
+                  cmd != LP_RAST_OP_BEGIN_QUERY &&
+                  cmd != LP_RAST_OP_END_QUERY) {
+            shaded = TRUE;
+            break;
+         }
+      }
+   }
+
+   for (i = 0; i < scene->fb.nr_cbufs; i++) {
+      const struct pipe_surface *cbuf = scene->fb.cbufs[i];
+      struct llvmpipe_resource *lpr;
+      boolean whole_tile;
+
+      if (!task->tile_clear[i])
+         continue;
+
+      /* Does the framebuffer cover all of the resource's tile? */
+      lpr = llvmpipe_resource(cbuf->texture);
+      whole_tile = task->x + task->width >= MIN2(task->x + TILE_SIZE,
+                                                 lpr->base.width0) &&
+                   task->y + task->height >= MIN2(task->y + TILE_SIZE,
+                                                  lpr->base.height0);
+
+      if (!shaded && whole_tile &&
+          scene->fb_max_layer == 0 &&
+          util_format_get_blocksize(cbuf->format) ==
+          util_format_get_blocksize(lpr->base.format)) {
+         task->defer_clear |= 1 << i;
+      }
+      else if (!(whole_tile && (cleared_first & (1 << i)))) {
+         llvmpipe_resolve_tile_clear(lpr, x, y);
+      }
+   }
 }
 
 
@@ -116,11 +220,15 @@ lp_rast_tile_begin(struct lp_rasterizer_task *task,
                                 scene->cbufs[i].format_bytes * task->x;
       }
    }
+   lp_rast_tile_begin_clears(task, bin, x, y);
+
    if (task->scene->fb.zsbuf) {
       task->depth_tile = scene->zsbuf.map +
                          scene->zsbuf.stride * task->y +
                          scene->zsbuf.format_bytes * task->x;
    }
+
+   lp_rast_hiz_begin_tile(task);
 }
 
 
@@ -152,6 +260,23 @@ lp_rast_clear_color(struct lp_rasterizer_task *task,
    LP_DBG(DEBUG_RAST, "%s clear value (target format %d) raw 0x%x,0x%x,0x%x,0x%x\n",
           __FUNCTION__, format, uc.ui[0], uc.ui[1], uc.ui[2], uc.ui[3]);
 
+   if (task->tile_clear[cbuf]) {
+      struct llvmpipe_tile_clear *tc = task->tile_clear[cbuf];
+
+      if (task->defer_clear & (1 << cbuf)) {
+         struct llvmpipe_resource *lpr =
+            llvmpipe_resource(scene->fb.cbufs[cbuf]->texture);
+
+         tc->cleared = TRUE;
+         tc->value = uc;
+         lpr->clears_pending = TRUE;
+         LP_COUNT(nr_color_tile_clear_deferred);
+         return;
+      }
+
+      /* overwritten below */
+      tc->cleared = FALSE;
+   }
 
    util_fill_box(scene->cbufs[cbuf].map,
                  format,
@@ -281,6 +406,9 @@ lp_rast_clear_zstencil(struct lp_rasterizer_task *task,
          }
          dst_layer += scene->zsbuf.layer_stride;
       }
+
+      lp_rast_hiz_clear(task, arg.clear_zstencil.value,
+                        arg.clear_zstencil.mask);
    }
 }
 
@@ -300,6 +428,7 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
    const struct lp_rast_state *state;
    struct lp_fragment_shader_variant *variant;
    const unsigned tile_x = task->x, tile_y = task->y;
+   unsigned hiz_rejected;
    unsigned x, y;
 
    if (inputs->disable) {
@@ -316,6 +445,14 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
    }
    variant = state->variant;
 
+   if (inputs->linear) {
+      lp_linear_shade_tile(task, inputs);
+      return;
+   }
+
+   /* skip the 16x16 blocks where the triangle is occluded */
+   hiz_rejected = lp_rast_hiz_reject_blocks(task, inputs, 0xffff);
+
    /* render the whole 64x64 tile in 4x4 chunks */
    for (y = 0; y < task->height; y += 4){
       for (x = 0; x < task->width; x += 4) {
@@ -325,6 +462,10 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
          unsigned depth_stride = 0;
          unsigned i;
 
+         if (hiz_rejected & (1 << ((y / LP_HIZ_BLOCK_SIZE) * LP_HIZ_TILE_BLOCKS +
+                                   x / LP_HIZ_BLOCK_SIZE)))
+            continue;
+
          /* color buffer */
          for (i = 0; i < scene->fb.nr_cbufs; i++){
             if (scene->fb.cbufs[i]) {
@@ -348,6 +489,9 @@ lp_rast_shade_tile(struct lp_rasterizer_task *task,
          /* Propagate non-interpolated raster state. */
          task->thread_data.raster_state.viewport_index = inputs->viewport_index;
 
+         if (task->hiz.write)
+            lp_rast_hiz_update(task, inputs, tile_x + x, tile_y + y);
+
          /* run shader on 4x4 block */
          BEGIN_JIT_CALL(state, task);
          variant->jit_function[RAST_WHOLE]( &state->jit_context,
@@ -453,6 +597,14 @@ lp_rast_shade_quads_mask(struct lp_rasterizer_task *task,
       /* Propagate non-interpolated raster state. */
       task->thread_data.raster_state.viewport_index = inputs->viewport_index;
 
+      if (inputs->linear) {
+         lp_linear_shade_block(task, inputs, x, y, mask);
+         return;
+      }
+
+      if (task->hiz.write)
+         lp_rast_hiz_update(task, inputs, x, y);
+
       /* run shader on 4x4 block */
       BEGIN_JIT_CALL(state, task);
       variant->jit_function[RAST_EDGE_TEST](&state->jit_context,
@@ -539,6 +691,7 @@ lp_rast_set_state(struct lp_rasterizer_task *task,
                   const union lp_rast_cmd_arg arg)
 {
    task->state = arg.state;
+   lp_rast_hiz_set_state(task);
 }
 
 
@@ -596,6 +749,25 @@ static lp_rast_cmd_func dispatch[LP_RAST_OP_MAX] =
 };
 
 
+/**
+ * Fragment shader variant run by a command, for the profiler.
+ */
+static inline unsigned
+cmd_variant_no(const struct lp_rasterizer_task *task, unsigned cmd)
+{
+   switch (cmd) {
+   case LP_RAST_OP_CLEAR_COLOR:
+   case LP_RAST_OP_CLEAR_ZSTENCIL:
+   case LP_RAST_OP_BEGIN_QUERY:
+   case LP_RAST_OP_END_QUERY:
+   case LP_RAST_OP_SET_STATE:
+      return LP_PROFILE_NO_VARIANT;
+   default:
+      return task->state ? task->state->variant->no : LP_PROFILE_NO_VARIANT;
+   }
+}
+
+
 static void
 do_rasterize_bin(struct lp_rasterizer_task *task,
                  const struct cmd_bin *bin,
@@ -609,6 +781,19 @@ do_rasterize_bin(struct lp_rasterizer_task *task,
 
    for (block = bin->head; block; block = block->next) {
       for (k = 0; k < block->count; k++) {
+         if (task->hiz.test &&
+             lp_rast_hiz_reject_cmd(task, block->cmd[k], &block->arg[k]))
+            continue;
+
+         if (task->profile.events) {
+            int64_t start = os_time_get_nano();
+            dispatch[block->cmd[k]]( task, block->arg[k] );
+            lp_profile_record(&task->profile, LP_PROFILE_CMD,
+                              block->cmd[k], x, y,
+                              cmd_variant_no(task, block->cmd[k]), start);
+            continue;
+         }
+
          dispatch[block->cmd[k]]( task, block->arg[k] );
       }
    }
@@ -626,12 +811,21 @@ static void
 rasterize_bin(struct lp_rasterizer_task *task,
               const struct cmd_bin *bin, int x, int y )
 {
+   int64_t start = 0;
+
+   if (task->profile.events)
+      start = os_time_get_nano();
+
    lp_rast_tile_begin( task, bin, x, y );
 
    do_rasterize_bin(task, bin, x, y);
 
    lp_rast_tile_end(task);
 
+   if (task->profile.events)
+      lp_profile_record(&task->profile, LP_PROFILE_BIN,
+                        0, x, y, LP_PROFILE_NO_VARIANT, start);
+
 
    /* Debug/Perf flags:
     */
@@ -686,7 +880,8 @@ rasterize_scene(struct lp_rasterizer_task *task,
          int i, j;
 
          assert(scene);
-         while ((bin = lp_scene_bin_iter_next(scene, &i, &j))) {
+         while ((bin = lp_scene_bin_iter_next(scene, task->thread_index,
+                                              &i, &j))) {
             if (!is_empty_bin( bin ))
                rasterize_bin(task, bin, i, j);
          }
@@ -708,11 +903,46 @@ rasterize_scene(struct lp_rasterizer_task *task,
    }
 #endif
 
-   if (scene->fence) {
-      lp_fence_signal(scene->fence);
+   task->scene = NULL;
+}
+
+
+/**
+ * Run func on each of the rasterizer threads, and wait for all of them to
+ * return.  Used for work other than scenes, like compute shaders.
+ *
+ * The caller must hold the screen's rast_mutex and make sure that no scene
+ * is being rasterized.
+ */
+void
+lp_rast_run_job( struct lp_rasterizer *rast,
+                 lp_rast_job_func func,
+                 void *data )
+{
+   unsigned i;
+
+   if (rast->num_threads == 0) {
+      unsigned fpstate = util_fpstate_get();
+
+      util_fpstate_set_denorms_to_zero(fpstate);
+      func(data, &rast->tasks[0].thread_data, 0);
+      util_fpstate_set(fpstate);
+      return;
    }
 
-   task->scene = NULL;
+   rast->job_func = func;
+   rast->job_data = data;
+
+   for (i = 0; i < rast->num_threads; i++) {
+      pipe_semaphore_signal(&rast->tasks[i].work_ready);
+   }
+
+   for (i = 0; i < rast->num_threads; i++) {
+      pipe_semaphore_wait(&rast->tasks[i].work_done);
+   }
+
+   rast->job_func = NULL;
+   rast->job_data = NULL;
 }
 
 
@@ -741,8 +971,6 @@ lp_rast_queue_scene( struct lp_rasterizer *rast,
       lp_rast_end( rast );
 
       util_fpstate_set(fpstate);
-
-      rast->curr_scene = NULL;
    }
    else {
       /* threaded rendering! */
@@ -760,29 +988,13 @@ lp_rast_queue_scene( struct lp_rasterizer *rast,
 }
 
 
-void
-lp_rast_finish( struct lp_rasterizer *rast )
-{
-   if (rast->num_threads == 0) {
-      /* nothing to do */
-   }
-   else {
-      int i;
-
-      /* wait for work to complete */
-      for (i = 0; i < rast->num_threads; i++) {
-         pipe_semaphore_wait(&rast->tasks[i].work_done);
-      }
-   }
-}
-
-
 /**
  * This is the thread's main entrypoint.
  * It's a simple loop:
  *   1. wait for work
  *   2. do work
- *   3. signal that we're done
+ *
+ * Completion of a scene is signalled through the scene's fence.
  */
 static int
 thread_function(void *init_data)
@@ -796,6 +1008,12 @@ thread_function(void *init_data)
    util_snprintf(thread_name, sizeof thread_name, "llvmpipe-%u", task->thread_index);
    u_thread_setname(thread_name);
 
+   /* Keep each thread on a fixed CPU, so that the band of tiles it owns
+    * (see lp_scene_bin_iter_begin) stays in that CPU's caches and NUMA node.
+    */
+   if (rast->pin_threads)
+      u_thread_pin_to_cpu(task->thread_index % util_cpu_caps.nr_cpus);
+
    /* Make sure that denorms are treated like zeros. This is 
     * the behavior required by D3D10. OpenGL doesn't care.
     */
@@ -811,6 +1029,13 @@ thread_function(void *init_data)
       if (rast->exit_flag)
          break;
 
+      if (rast->job_func) {
+         rast->job_func(rast->job_data, &task->thread_data,
+                        task->thread_index);
+         pipe_semaphore_signal(&task->work_done);
+         continue;
+      }
+
       if (task->thread_index == 0) {
          /* thread[0]:
           *  - get next scene to rasterize
@@ -835,17 +1060,16 @@ thread_function(void *init_data)
       /* wait for all threads to finish with this scene */
       util_barrier_wait( &rast->barrier );
 
-      /* XXX: shouldn't be necessary:
+      /* thread[0]:
+       *  - unmap the framebuffer surfaces, reset the scene and signal
+       *    its fence
        */
       if (task->thread_index == 0) {
          lp_rast_end( rast );
       }
 
-      /* signal done with work */
       if (debug)
          debug_printf("thread %d done working\n", task->thread_index);
-
-      pipe_semaphore_signal(&task->work_done);
    }
 
 #ifdef _WIN32
@@ -891,6 +1115,18 @@ lp_rast_create( unsigned num_threads )
       goto no_rast;
    }
 
+   rast->tasks = CALLOC(MAX2(1, num_threads), sizeof *rast->tasks);
+   if (!rast->tasks) {
+      goto no_tasks;
+   }
+
+   if (num_threads > 0) {
+      rast->threads = CALLOC(num_threads, sizeof *rast->threads);
+      if (!rast->threads) {
+         goto no_threads;
+      }
+   }
+
    rast->full_scenes = lp_scene_queue_create();
    if (!rast->full_scenes) {
       goto no_full_scenes;
@@ -910,6 +1146,20 @@ lp_rast_create( unsigned num_threads )
    rast->num_threads = num_threads;
 
    rast->no_rast = debug_get_bool_option("LP_NO_RAST", FALSE);
+   rast->pin_threads = debug_get_bool_option("LP_PIN_THREADS", FALSE);
+
+#ifdef LP_RAST_HAVE_AVX512
+   /*
+    * has_avx512f is already cleared by lp_build_init() if the native
+    * vector width was restricted to 256 bits or less.
+    */
+   if (util_cpu_caps.has_avx512f) {
+      dispatch[LP_RAST_OP_TRIANGLE_32_3_4] = lp_rast_triangle_32_3_4_avx512;
+      dispatch[LP_RAST_OP_TRIANGLE_32_3_16] = lp_rast_triangle_32_3_16_avx512;
+   }
+#endif
+
+   rast->profile = lp_profile_create(rast);
 
    create_rast_threads(rast);
 
@@ -923,7 +1173,7 @@ lp_rast_create( unsigned num_threads )
    return rast;
 
 no_thread_data_cache:
-   for (i = 0; i < MAX2(1, rast->num_threads); i++) {
+   for (i = 0; i < MAX2(1, num_threads); i++) {
       if (rast->tasks[i].thread_data.cache) {
          align_free(rast->tasks[i].thread_data.cache);
       }
@@ -931,6 +1181,10 @@ no_thread_data_cache:
 
    lp_scene_queue_destroy(rast->full_scenes);
 no_full_scenes:
+   FREE(rast->threads);
+no_threads:
+   FREE(rast->tasks);
+no_tasks:
    FREE(rast);
 no_rast:
    return NULL;
@@ -977,8 +1231,13 @@ void lp_rast_destroy( struct lp_rasterizer *rast )
       util_barrier_destroy( &rast->barrier );
    }
 
+   if (rast->profile)
+      lp_profile_destroy(rast, rast->profile);
+
    lp_scene_queue_destroy(rast->full_scenes);
 
+   FREE(rast->threads);
+   FREE(rast->tasks);
    FREE(rast);
 }
 
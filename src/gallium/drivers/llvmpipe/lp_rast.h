@@ -100,7 +100,8 @@ struct lp_rast_shader_inputs {
    unsigned frontfacing:1;      /** True for front-facing */
    unsigned disable:1;          /** Partially binned, disable this command */
    unsigned opaque:1;           /** Is opaque */
-   unsigned pad0:29;            /* wasted space */
+   unsigned linear:1;           /** Shade with the linear path, see lp_linear.h */
+   unsigned pad0:28;            /* wasted space */
    unsigned stride;             /* how much to advance data between a0, dadx, dady */
    unsigned layer;              /* the layer to render to (from gs, already clamped) */
    unsigned viewport_index;     /* the active viewport index (from gs, already clamped) */
@@ -166,8 +167,19 @@ void
 lp_rast_queue_scene( struct lp_rasterizer *rast,
                      struct lp_scene *scene );
 
+
+/**
+ * Function run by each rasterizer thread for lp_rast_run_job.
+ */
+typedef void (*lp_rast_job_func)(void *data,
+                                 struct lp_jit_thread_data *thread_data,
+                                 unsigned thread_index);
+
 void
-lp_rast_finish( struct lp_rasterizer *rast );
+lp_rast_run_job( struct lp_rasterizer *rast,
+                 lp_rast_job_func func,
+                 void *data );
+
 
 
 union lp_rast_cmd_arg {
@@ -306,6 +318,9 @@ lp_rast_arg_null( void )
 #define LP_RAST_OP_MAX               0x1d
 #define LP_RAST_OP_MASK              0xff
 
+const char *
+lp_rast_cmd_name(unsigned cmd);
+
 void
 lp_debug_bins( struct lp_scene *scene );
 void
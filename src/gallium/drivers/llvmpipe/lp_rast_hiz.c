@@ -0,0 +1,480 @@
+/**************************************************************************
+ * 
+ * Copyright 2018 VMware, Inc.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ **************************************************************************/
+
+
+/**
+ * Per tile hierarchical Z, see lp_rast_hiz.h.
+ */
+
+
+#include <float.h>
+
+#include "pipe/p_defines.h"
+#include "util/u_format.h"
+#include "util/u_math.h"
+
+#include "lp_debug.h"
+#include "lp_perf.h"
+#include "lp_rast.h"
+#include "lp_rast_priv.h"
+#include "lp_rast_hiz.h"
+#include "lp_state_fs.h"
+
+
+static inline float
+hiz_unpack(const struct lp_rast_hiz *hiz, uint64_t value)
+{
+   if (hiz->is_float) {
+      union fi fi;
+      fi.ui = (uint32_t) value;
+      return fi.f;
+   }
+   return (float) (((uint32_t) value >> hiz->shift) & hiz->mask) * hiz->scale;
+}
+
+
+/**
+ * Depth range of the triangle over the given rectangle (window coords),
+ * as the fragment shader will see it after clamping, widened a bit to
+ * account for interpolation rounding.
+ */
+static inline void
+hiz_tri_range(const struct lp_rasterizer_task *task,
+              const struct lp_rast_shader_inputs *inputs,
+              unsigned x, unsigned y, unsigned w, unsigned h,
+              float *zlo, float *zhi)
+{
+   const struct lp_rast_hiz *hiz = &task->hiz;
+   const float a0 = GET_A0(inputs)[0][2];
+   const float dzdx = GET_DADX(inputs)[0][2];
+   const float dzdy = GET_DADY(inputs)[0][2];
+   const float x1 = (float) (x + w);
+   const float y1 = (float) (y + h);
+   float z0, lo, hi, eps;
+
+   /*
+    * The plane is evaluated relative to (0,0), so the error grows with
+    * the magnitude of the terms.  Pixel centers are within the rectangle
+    * for both pixel center conventions.
+    */
+   z0 = a0 + dzdx * x + dzdy * y;
+   lo = z0 + MIN2(dzdx, 0.0f) * w + MIN2(dzdy, 0.0f) * h;
+   hi = z0 + MAX2(dzdx, 0.0f) * w + MAX2(dzdy, 0.0f) * h;
+   eps = (fabsf(a0) + fabsf(dzdx) * x1 + fabsf(dzdy) * y1) * (1.0f / (1 << 20));
+
+   /* Same clamping as lp_bld_interp.c / lp_build_depth_clamp */
+   if (task->state->variant->key.depth_clamp) {
+      const struct lp_jit_viewport *vp =
+         &task->state->jit_context.viewports[inputs->viewport_index];
+      const float vmin = MIN2(vp->min_depth, vp->max_depth);
+      const float vmax = MAX2(vp->min_depth, vp->max_depth);
+      lo = CLAMP(lo, vmin, vmax);
+      hi = CLAMP(hi, vmin, vmax);
+   }
+   else {
+      lo = MIN2(lo, 1.0f);
+      hi = MIN2(hi, 1.0f);
+   }
+
+   if (!hiz->is_float) {
+      /* The conversion to unorm saturates and rounds to the nearest step */
+      lo = CLAMP(lo, 0.0f, 1.0f);
+      hi = CLAMP(hi, 0.0f, 1.0f);
+      eps += hiz->scale;
+   }
+
+   *zlo = lo - eps;
+   *zhi = hi + eps;
+}
+
+
+/**
+ * Read back exact depth bounds of a block from the depth buffer.
+ */
+static void
+hiz_load_block(struct lp_rasterizer_task *task, unsigned b)
+{
+   struct lp_rast_hiz *hiz = &task->hiz;
+   const unsigned stride = task->scene->zsbuf.stride;
+   const unsigned bx = (b % LP_HIZ_TILE_BLOCKS) * LP_HIZ_BLOCK_SIZE;
+   const unsigned by = (b / LP_HIZ_TILE_BLOCKS) * LP_HIZ_BLOCK_SIZE;
+   const uint8_t *row = task->depth_tile + by * stride + bx * hiz->format_bytes;
+   unsigned w = 0, h = 0;
+   unsigned i, j;
+
+   if (bx < task->width && by < task->height) {
+      w = MIN2(LP_HIZ_BLOCK_SIZE, task->width - bx);
+      h = MIN2(LP_HIZ_BLOCK_SIZE, task->height - by);
+   }
+
+   if (hiz->is_float) {
+      float zmin = FLT_MAX, zmax = -FLT_MAX;
+
+      for (i = 0; i < h; i++) {
+         const uint8_t *p = row;
+         for (j = 0; j < w; j++) {
+            const float z = *(const float *) p;
+            zmin = MIN2(zmin, z);
+            zmax = MAX2(zmax, z);
+            p += hiz->format_bytes;
+         }
+         row += stride;
+      }
+      hiz->zmin[b] = zmin;
+      hiz->zmax[b] = zmax;
+   }
+   else {
+      uint32_t zmin = ~0U, zmax = 0;
+
+      for (i = 0; i < h; i++) {
+         if (hiz->format_bytes == 2) {
+            const uint16_t *p = (const uint16_t *) row;
+            for (j = 0; j < w; j++) {
+               zmin = MIN2(zmin, p[j]);
+               zmax = MAX2(zmax, p[j]);
+            }
+         }
+         else {
+            const uint32_t *p = (const uint32_t *) row;
+            for (j = 0; j < w; j++) {
+               const uint32_t z = (p[j] >> hiz->shift) & hiz->mask;
+               zmin = MIN2(zmin, z);
+               zmax = MAX2(zmax, z);
+            }
+         }
+         row += stride;
+      }
+
+      if (w && h) {
+         hiz->zmin[b] = (float) zmin * hiz->scale;
+         hiz->zmax[b] = (float) zmax * hiz->scale;
+      }
+      else {
+         /* No pixels of this block are inside the framebuffer */
+         hiz->zmin[b] = FLT_MAX;
+         hiz->zmax[b] = -FLT_MAX;
+      }
+   }
+
+   hiz->known |= 1 << b;
+   hiz->stale &= ~(1 << b);
+}
+
+
+/**
+ * Whether the depth test fails everywhere in block b for fragments with
+ * depth in [zlo, zhi].
+ */
+static boolean
+hiz_block_test(struct lp_rasterizer_task *task, unsigned b,
+               float zlo, float zhi)
+{
+   struct lp_rast_hiz *hiz = &task->hiz;
+   const unsigned bit = 1 << b;
+
+   switch (hiz->func) {
+   case PIPE_FUNC_LESS:
+   case PIPE_FUNC_LEQUAL:
+      if (hiz->known & bit) {
+         if (zlo > hiz->zmax[b])
+            return TRUE;
+         /* A tighter far bound can't help if we're in front of it all */
+         if (!(hiz->stale & bit) || !(zlo > hiz->zmin[b]))
+            return FALSE;
+      }
+      hiz_load_block(task, b);
+      return zlo > hiz->zmax[b];
+
+   case PIPE_FUNC_GREATER:
+   case PIPE_FUNC_GEQUAL:
+      if (hiz->known & bit) {
+         if (zhi < hiz->zmin[b])
+            return TRUE;
+         if (!(hiz->stale & bit) || !(zhi < hiz->zmax[b]))
+            return FALSE;
+      }
+      hiz_load_block(task, b);
+      return zhi < hiz->zmin[b];
+
+   default:
+      return FALSE;
+   }
+}
+
+
+/**
+ * Test the rectangle at tile relative x,y against all the blocks it
+ * overlaps.
+ */
+static boolean
+hiz_reject_rect(struct lp_rasterizer_task *task,
+                const struct lp_rast_shader_inputs *inputs,
+                unsigned x, unsigned y, unsigned size)
+{
+   const unsigned bx0 = x / LP_HIZ_BLOCK_SIZE;
+   const unsigned by0 = y / LP_HIZ_BLOCK_SIZE;
+   const unsigned bx1 = MIN2((x + size - 1) / LP_HIZ_BLOCK_SIZE, LP_HIZ_TILE_BLOCKS - 1);
+   const unsigned by1 = MIN2((y + size - 1) / LP_HIZ_BLOCK_SIZE, LP_HIZ_TILE_BLOCKS - 1);
+   unsigned bx, by;
+
+   for (by = by0; by <= by1; by++) {
+      for (bx = bx0; bx <= bx1; bx++) {
+         const unsigned x0 = MAX2(x, bx * LP_HIZ_BLOCK_SIZE);
+         const unsigned y0 = MAX2(y, by * LP_HIZ_BLOCK_SIZE);
+         const unsigned x1 = MIN2(x + size, (bx + 1) * LP_HIZ_BLOCK_SIZE);
+         const unsigned y1 = MIN2(y + size, (by + 1) * LP_HIZ_BLOCK_SIZE);
+         float zlo, zhi;
+
+         hiz_tri_range(task, inputs, task->x + x0, task->y + y0,
+                       x1 - x0, y1 - y0, &zlo, &zhi);
+         if (!hiz_block_test(task, by * LP_HIZ_TILE_BLOCKS + bx, zlo, zhi))
+            return FALSE;
+      }
+   }
+
+   return TRUE;
+}
+
+
+void
+lp_rast_hiz_begin_tile(struct lp_rasterizer_task *task)
+{
+   struct lp_rast_hiz *hiz = &task->hiz;
+   const struct lp_scene *scene = task->scene;
+
+   hiz->known = 0;
+   hiz->stale = 0;
+   hiz->has_depth = FALSE;
+   hiz->test = FALSE;
+   hiz->write = FALSE;
+
+   if ((LP_PERF & PERF_NO_HIZ) || !scene->fb.zsbuf || !scene->zsbuf.map)
+      return;
+
+   {
+      const struct util_format_description *desc =
+         util_format_description(scene->fb.zsbuf->format);
+      const struct util_format_channel_description *chan;
+
+      if (!util_format_has_depth(desc))
+         return;
+
+      chan = &desc->channel[desc->swizzle[0]];
+
+      hiz->has_depth = TRUE;
+      hiz->format_bytes = desc->block.bits / 8;
+      hiz->is_float = chan->type == UTIL_FORMAT_TYPE_FLOAT;
+      hiz->shift = chan->shift;
+      hiz->mask = chan->size >= 32 ? ~0U : (1U << chan->size) - 1;
+      hiz->scale = hiz->is_float ? 1.0f : 1.0f / (float) hiz->mask;
+   }
+}
+
+
+/**
+ * Called when the rasterizer state (and so the fragment shader variant)
+ * changes.
+ */
+void
+lp_rast_hiz_set_state(struct lp_rasterizer_task *task)
+{
+   struct lp_rast_hiz *hiz = &task->hiz;
+   const struct lp_fragment_shader_variant *variant = task->state->variant;
+   const struct lp_fragment_shader_variant_key *key = &variant->key;
+
+   hiz->test = FALSE;
+   hiz->write = FALSE;
+
+   if (!hiz->has_depth || !key->depth.enabled || key->resource_1d)
+      return;
+
+   hiz->func = key->depth.func;
+   hiz->write = key->depth.writemask;
+   hiz->writes_z = variant->shader->info.base.writes_z;
+
+   /*
+    * Rejecting fragments early also skips their stencil updates, and
+    * shader computed depth isn't known up front.
+    */
+   hiz->test = !key->stencil[0].enabled &&
+               !hiz->writes_z &&
+               (hiz->func == PIPE_FUNC_LESS ||
+                hiz->func == PIPE_FUNC_LEQUAL ||
+                hiz->func == PIPE_FUNC_GREATER ||
+                hiz->func == PIPE_FUNC_GEQUAL);
+}
+
+
+/**
+ * Called for depth/stencil clears.  Clears always cover the whole tile.
+ */
+void
+lp_rast_hiz_clear(struct lp_rasterizer_task *task,
+                  uint64_t value, uint64_t mask)
+{
+   struct lp_rast_hiz *hiz = &task->hiz;
+   const uint64_t depth_mask = (uint64_t) hiz->mask << hiz->shift;
+   unsigned b;
+
+   if (!hiz->has_depth || !(mask & depth_mask))
+      return;
+
+   if ((mask & depth_mask) != depth_mask) {
+      /* Partial depth clear, shouldn't really happen */
+      hiz->known = 0;
+      return;
+   }
+
+   for (b = 0; b < LP_HIZ_TILE_BLOCKS * LP_HIZ_TILE_BLOCKS; b++) {
+      hiz->zmin[b] = hiz->zmax[b] = hiz_unpack(hiz, value);
+   }
+   hiz->known = (1 << (LP_HIZ_TILE_BLOCKS * LP_HIZ_TILE_BLOCKS)) - 1;
+   hiz->stale = 0;
+}
+
+
+/**
+ * Return the subset of the given tile blocks (bit y * 4 + x, as in
+ * lp_rast_tri_tmp.h) where the triangle is completely occluded.
+ */
+unsigned
+lp_rast_hiz_reject_blocks(struct lp_rasterizer_task *task,
+                          const struct lp_rast_shader_inputs *inputs,
+                          unsigned blocks)
+{
+   unsigned rejected = 0;
+
+   if (!task->hiz.test || inputs->layer != 0)
+      return 0;
+
+   while (blocks) {
+      const unsigned b = u_bit_scan(&blocks);
+      const unsigned x = (b % LP_HIZ_TILE_BLOCKS) * LP_HIZ_BLOCK_SIZE;
+      const unsigned y = (b / LP_HIZ_TILE_BLOCKS) * LP_HIZ_BLOCK_SIZE;
+      float zlo, zhi;
+
+      hiz_tri_range(task, inputs, task->x + x, task->y + y,
+                    LP_HIZ_BLOCK_SIZE, LP_HIZ_BLOCK_SIZE, &zlo, &zhi);
+      if (hiz_block_test(task, b, zlo, zhi))
+         rejected |= 1 << b;
+   }
+
+   LP_COUNT_ADD(nr_hiz_reject_16, util_bitcount(rejected));
+
+   return rejected;
+}
+
+
+/**
+ * Test the small triangle commands, which are binned with the 4x4 or
+ * 16x16 area they are contained in, before they get rasterized.  Larger
+ * triangles are tested per block in lp_rast_tri_tmp.h.
+ */
+boolean
+lp_rast_hiz_reject_cmd(struct lp_rasterizer_task *task,
+                       unsigned cmd,
+                       const union lp_rast_cmd_arg *arg)
+{
+   const struct lp_rast_triangle *tri;
+   unsigned size;
+
+   switch (cmd) {
+   case LP_RAST_OP_TRIANGLE_3_4:
+   case LP_RAST_OP_TRIANGLE_32_3_4:
+      size = 4;
+      break;
+   case LP_RAST_OP_TRIANGLE_3_16:
+   case LP_RAST_OP_TRIANGLE_4_16:
+   case LP_RAST_OP_TRIANGLE_32_3_16:
+   case LP_RAST_OP_TRIANGLE_32_4_16:
+      size = 16;
+      break;
+   default:
+      return FALSE;
+   }
+
+   tri = arg->triangle.tri;
+   if (tri->inputs.disable || tri->inputs.layer != 0)
+      return FALSE;
+
+   if (hiz_reject_rect(task, &tri->inputs,
+                       arg->triangle.plane_mask & 0xff,
+                       arg->triangle.plane_mask >> 8,
+                       size)) {
+      LP_COUNT(nr_hiz_reject_tri);
+      return TRUE;
+   }
+
+   return FALSE;
+}
+
+
+/**
+ * Widen the bounds for a 4x4 stamp at window position x,y which is about
+ * to be shaded with depth writes enabled.
+ */
+void
+lp_rast_hiz_update(struct lp_rasterizer_task *task,
+                   const struct lp_rast_shader_inputs *inputs,
+                   unsigned x, unsigned y)
+{
+   struct lp_rast_hiz *hiz = &task->hiz;
+   const unsigned b = ((y % TILE_SIZE) / LP_HIZ_BLOCK_SIZE) * LP_HIZ_TILE_BLOCKS +
+                      (x % TILE_SIZE) / LP_HIZ_BLOCK_SIZE;
+   float zlo, zhi;
+
+   if (!(hiz->known & (1 << b)) || inputs->layer != 0)
+      return;
+
+   if (hiz->writes_z) {
+      hiz->known &= ~(1 << b);
+      return;
+   }
+
+   hiz_tri_range(task, inputs, x, y, 4, 4, &zlo, &zhi);
+
+   switch (hiz->func) {
+   case PIPE_FUNC_NEVER:
+   case PIPE_FUNC_EQUAL:
+      return;
+   case PIPE_FUNC_LESS:
+   case PIPE_FUNC_LEQUAL:
+      /* values only decrease */
+      hiz->zmin[b] = MIN2(hiz->zmin[b], zlo);
+      break;
+   case PIPE_FUNC_GREATER:
+   case PIPE_FUNC_GEQUAL:
+      /* values only increase */
+      hiz->zmax[b] = MAX2(hiz->zmax[b], zhi);
+      break;
+   default:
+      hiz->zmin[b] = MIN2(hiz->zmin[b], zlo);
+      hiz->zmax[b] = MAX2(hiz->zmax[b], zhi);
+      break;
+   }
+
+   hiz->stale |= 1 << b;
+}
@@ -0,0 +1,110 @@
+/**************************************************************************
+ * 
+ * Copyright 2018 VMware, Inc.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ **************************************************************************/
+
+
+/**
+ * Hierarchical Z.
+ *
+ * For every 16x16 block of the tile being rasterized we keep conservative
+ * bounds of the depth values in the depth buffer.  Triangles whose depth
+ * over a block cannot pass the depth test against those bounds are
+ * discarded for that block before they are rasterized and shaded.
+ *
+ * The bounds are set by depth clears, read back from the depth buffer the
+ * first time a block is needed, and widened by the depth range of every
+ * 4x4 stamp that writes depth.  With the usual LESS/LEQUAL test, writes
+ * only ever bring depth values closer, so the far bound gets loose; it is
+ * read back again only when a tighter bound might reject a triangle.
+ *
+ * The bounds are per tile and per thread, and only cover layer 0.
+ */
+
+#ifndef LP_RAST_HIZ_H
+#define LP_RAST_HIZ_H
+
+#include "pipe/p_compiler.h"
+#include "lp_limits.h"
+
+
+#define LP_HIZ_BLOCK_SIZE 16
+#define LP_HIZ_TILE_BLOCKS (TILE_SIZE / LP_HIZ_BLOCK_SIZE)
+
+struct lp_rasterizer_task;
+struct lp_rast_shader_inputs;
+union lp_rast_cmd_arg;
+
+
+struct lp_rast_hiz
+{
+   /* Depth buffer layout, set up at the beginning of each tile */
+   boolean has_depth;
+   boolean is_float;
+   unsigned format_bytes;
+   unsigned shift;
+   uint32_t mask;
+   float scale;            /**< 1 / (2^bits - 1) for unorm depth */
+
+   /* Current state, set up by lp_rast_hiz_set_state() */
+   boolean test;           /**< may reject with the current state */
+   boolean write;          /**< current state writes depth */
+   boolean writes_z;       /**< ... and the shader computes it */
+   unsigned func;          /**< PIPE_FUNC_x */
+
+   /* Per block bounds, bit (y * LP_HIZ_TILE_BLOCKS + x) of the masks */
+   unsigned known;         /**< zmin/zmax are valid */
+   unsigned stale;         /**< zmin/zmax may be much looser than needed */
+   float zmin[LP_HIZ_TILE_BLOCKS * LP_HIZ_TILE_BLOCKS];
+   float zmax[LP_HIZ_TILE_BLOCKS * LP_HIZ_TILE_BLOCKS];
+};
+
+
+void
+lp_rast_hiz_begin_tile(struct lp_rasterizer_task *task);
+
+void
+lp_rast_hiz_set_state(struct lp_rasterizer_task *task);
+
+void
+lp_rast_hiz_clear(struct lp_rasterizer_task *task,
+                  uint64_t value, uint64_t mask);
+
+unsigned
+lp_rast_hiz_reject_blocks(struct lp_rasterizer_task *task,
+                          const struct lp_rast_shader_inputs *inputs,
+                          unsigned blocks);
+
+boolean
+lp_rast_hiz_reject_cmd(struct lp_rasterizer_task *task,
+                       unsigned cmd,
+                       const union lp_rast_cmd_arg *arg);
+
+void
+lp_rast_hiz_update(struct lp_rasterizer_task *task,
+                   const struct lp_rast_shader_inputs *inputs,
+                   unsigned x, unsigned y);
+
+
+#endif /* LP_RAST_HIZ_H */
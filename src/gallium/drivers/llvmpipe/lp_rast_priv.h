@@ -37,6 +37,9 @@
 #include "lp_state.h"
 #include "lp_texture.h"
 #include "lp_limits.h"
+#include "lp_linear.h"
+#include "lp_rast_hiz.h"
+#include "lp_profile.h"
 
 
 #define TILE_VECTOR_HEIGHT 4
@@ -91,6 +94,11 @@ struct lp_rasterizer_task
    uint8_t *color_tiles[PIPE_MAX_COLOR_BUFS];
    uint8_t *depth_tile;
 
+   /** Fast clear state of this tile per color buffer, or NULL */
+   struct llvmpipe_tile_clear *tile_clear[PIPE_MAX_COLOR_BUFS];
+   /** Color buffers whose clears are only recorded in tile_clear */
+   unsigned defer_clear;
+
    /** "back" pointer */
    struct lp_rasterizer *rast;
 
@@ -102,6 +110,12 @@ struct lp_rasterizer_task
    uint64_t ps_invocations;
    uint8_t ps_inv_multiplier;
 
+   /** Depth bounds of the current tile */
+   struct lp_rast_hiz hiz;
+
+   /** Timings of this thread's bins and commands (LP_PROFILE) */
+   struct lp_profile_ring profile;
+
    pipe_semaphore work_ready;
    pipe_semaphore work_done;
 };
@@ -123,11 +137,21 @@ struct lp_rasterizer
    /** The scene currently being rasterized by the threads */
    struct lp_scene *curr_scene;
 
-   /** A task object for each rasterization thread */
-   struct lp_rasterizer_task tasks[LP_MAX_THREADS];
+   /** A task object for each rasterization thread, MAX2(1, num_threads) */
+   struct lp_rasterizer_task *tasks;
 
    unsigned num_threads;
-   thrd_t threads[LP_MAX_THREADS];
+   thrd_t *threads;
+
+   /** Pin thread N to CPU N (LP_PIN_THREADS) */
+   boolean pin_threads;
+
+   /** Frame profiler, or NULL unless LP_PROFILE is set */
+   struct lp_profile *profile;
+
+   /** Job run by all the threads instead of a scene, see lp_rast_run_job */
+   lp_rast_job_func job_func;
+   void *job_data;
 
    /** For synchronizing the rasterization threads */
    util_barrier barrier;
@@ -266,6 +290,14 @@ lp_rast_shade_quads_all( struct lp_rasterizer_task *task,
       /* Propagate non-interpolated raster state. */
       task->thread_data.raster_state.viewport_index = inputs->viewport_index;
 
+      if (inputs->linear) {
+         lp_linear_shade_block(task, inputs, x, y, 0xffff);
+         return;
+      }
+
+      if (task->hiz.write)
+         lp_rast_hiz_update(task, inputs, x, y);
+
       /* run shader on 4x4 block */
       BEGIN_JIT_CALL(state, task);
       variant->jit_function[RAST_WHOLE]( &state->jit_context,
@@ -337,6 +369,24 @@ void lp_rast_triangle_32_3_16( struct lp_rasterizer_task *,
 void lp_rast_triangle_32_4_16( struct lp_rasterizer_task *, 
                             const union lp_rast_cmd_arg );
 
+/*
+ * AVX-512 versions of the 3 plane 4x4 and 16x16 block kernels.  They are
+ * compiled with a function level target attribute, so the rest of the
+ * driver doesn't need AVX-512, and selected at runtime in lp_rast_create.
+ */
+#if defined(PIPE_ARCH_X86_64) && \
+    ((defined(__clang__) && \
+      (__clang_major__ > 3 || (__clang_major__ == 3 && __clang_minor__ >= 9))) || \
+     (!defined(__clang__) && defined(PIPE_CC_GCC) && PIPE_CC_GCC_VERSION >= 409))
+#define LP_RAST_HAVE_AVX512 1
+
+void lp_rast_triangle_32_3_4_avx512(struct lp_rasterizer_task *,
+                                    const union lp_rast_cmd_arg );
+
+void lp_rast_triangle_32_3_16_avx512(struct lp_rasterizer_task *,
+                                     const union lp_rast_cmd_arg );
+#endif
+
 void
 lp_rast_set_state(struct lp_rasterizer_task *task,
                   const union lp_rast_cmd_arg arg);
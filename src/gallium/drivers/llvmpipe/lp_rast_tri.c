@@ -684,6 +684,144 @@ lp_rast_triangle_32_3_4(struct lp_rasterizer_task *task,
 #endif
 
 
+#ifdef LP_RAST_HAVE_AVX512
+
+#include <immintrin.h>
+
+#define LP_AVX512 __attribute__((target("avx512f")))
+
+/**
+ * Set up the three edge functions for 16-wide evaluation.
+ *
+ * c[i] is adjusted to the block origin, and decremented so that coverage
+ * is just a sign test, like the SSE version.  span[i] holds the edge
+ * function increments at the 16 pixels of a 4x4 block, in row-major
+ * order, which is also the bit order of the coverage masks.
+ */
+static inline LP_AVX512 void
+setup_planes_avx512(const struct lp_rast_plane *plane,
+                    int x, int y,
+                    int c[3], int rej[3], __m512i span[3])
+{
+   const __m512i px = _mm512_setr_epi32(0, 1, 2, 3, 0, 1, 2, 3,
+                                        0, 1, 2, 3, 0, 1, 2, 3);
+   const __m512i py = _mm512_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1,
+                                        2, 2, 2, 2, 3, 3, 3, 3);
+   unsigned i;
+
+   for (i = 0; i < 3; i++) {
+      const int dcdx = -plane[i].dcdx;
+      const int dcdy = plane[i].dcdy;
+
+      c[i] = (int) plane[i].c + dcdx * x + dcdy * y - 1;
+
+      /* trivial reject offset for a 4x4 block, as the SSE code computes */
+      if (rej) {
+         rej[i] = ((dcdy > 0 ? dcdy : 0) - (plane[i].dcdx < 0 ? plane[i].dcdx : 0)) * 4 + 1;
+      }
+
+      span[i] = _mm512_add_epi32(_mm512_mullo_epi32(px, _mm512_set1_epi32(dcdx)),
+                                 _mm512_mullo_epi32(py, _mm512_set1_epi32(dcdy)));
+   }
+}
+
+
+/**
+ * Mask of the pixels of a 4x4 block which are outside the triangle.
+ */
+static inline LP_AVX512 unsigned
+block_outmask_avx512(const int c[3], const __m512i span[3])
+{
+   __m512i c0 = _mm512_add_epi32(_mm512_set1_epi32(c[0]), span[0]);
+   __m512i c1 = _mm512_add_epi32(_mm512_set1_epi32(c[1]), span[1]);
+   __m512i c2 = _mm512_add_epi32(_mm512_set1_epi32(c[2]), span[2]);
+   __m512i cor = _mm512_or_si512(_mm512_or_si512(c0, c1), c2);
+
+   return _mm512_cmplt_epi32_mask(cor, _mm512_setzero_si512());
+}
+
+
+LP_AVX512 void
+lp_rast_triangle_32_3_16_avx512(struct lp_rasterizer_task *task,
+                                const union lp_rast_cmd_arg arg)
+{
+   const struct lp_rast_triangle *tri = arg.triangle.tri;
+   const struct lp_rast_plane *plane = GET_PLANES(tri);
+   int x = (arg.triangle.plane_mask & 0xff) + task->x;
+   int y = (arg.triangle.plane_mask >> 8) + task->y;
+   int c[3], rej[3];
+   __m512i span[3];
+   int32_t cblock[3][16];
+   unsigned live;
+   unsigned i;
+
+   struct { unsigned mask:16; unsigned i:8; unsigned j:8; } out[16];
+   unsigned nr = 0;
+
+   setup_planes_avx512(plane, x, y, c, rej, span);
+
+   /*
+    * The edge function values at the origins of the sixteen 4x4 blocks
+    * are just the per-pixel increments times four.  Trivially reject
+    * blocks for all planes at once.
+    */
+   live = 0xffff;
+   for (i = 0; i < 3; i++) {
+      __m512i cb = _mm512_add_epi32(_mm512_set1_epi32(c[i]),
+                                    _mm512_slli_epi32(span[i], 2));
+
+      _mm512_storeu_si512(cblock[i], cb);
+      live &= ~_mm512_cmplt_epi32_mask(_mm512_add_epi32(cb, _mm512_set1_epi32(rej[i])),
+                                       _mm512_setzero_si512());
+   }
+
+   while (live) {
+      const unsigned b = u_bit_scan(&live);
+      const int cb[3] = { cblock[0][b], cblock[1][b], cblock[2][b] };
+      unsigned mask = block_outmask_avx512(cb, span);
+
+      out[nr].i = b / 4;
+      out[nr].j = b % 4;
+      out[nr].mask = mask;
+      if (mask != 0xffff)
+         nr++;
+   }
+
+   for (i = 0; i < nr; i++)
+      lp_rast_shade_quads_mask(task,
+                               &tri->inputs,
+                               x + 4 * out[i].j,
+                               y + 4 * out[i].i,
+                               0xffff & ~out[i].mask);
+}
+
+
+LP_AVX512 void
+lp_rast_triangle_32_3_4_avx512(struct lp_rasterizer_task *task,
+                               const union lp_rast_cmd_arg arg)
+{
+   const struct lp_rast_triangle *tri = arg.triangle.tri;
+   const struct lp_rast_plane *plane = GET_PLANES(tri);
+   int x = (arg.triangle.plane_mask & 0xff) + task->x;
+   int y = (arg.triangle.plane_mask >> 8) + task->y;
+   int c[3];
+   __m512i span[3];
+   unsigned mask;
+
+   setup_planes_avx512(plane, x, y, c, NULL, span);
+
+   mask = block_outmask_avx512(c, span);
+   if (mask != 0xffff)
+      lp_rast_shade_quads_mask(task,
+                               &tri->inputs,
+                               x,
+                               y,
+                               0xffff & ~mask);
+}
+
+#endif /* LP_RAST_HAVE_AVX512 */
+
+
 #if defined PIPE_ARCH_SSE
 #define BUILD_MASKS(c, cdiff, dcdx, dcdy, omask, pmask) build_masks_sse((int)c, (int)cdiff, dcdx, dcdy, omask, pmask)
 #define BUILD_MASK_LINEAR(c, dcdx, dcdy) build_mask_linear_sse((int)c, dcdx, dcdy)
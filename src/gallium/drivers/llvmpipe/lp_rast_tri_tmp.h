@@ -284,6 +284,15 @@ TAG(lp_rast_triangle)(struct lp_rasterizer_task *task,
 
    LP_COUNT_ADD(nr_empty_16, util_bitcount(0xffff & ~(partial_mask | inmask)));
 
+   /* Drop the blocks where the triangle is hidden by what's already drawn
+    */
+   if (task->hiz.test) {
+      unsigned hiz_mask = lp_rast_hiz_reject_blocks(task, &tri->inputs,
+                                                    partial_mask | inmask);
+      partial_mask &= ~hiz_mask;
+      inmask &= ~hiz_mask;
+   }
+
    /* Iterate over partials:
     */
    while (partial_mask) {
@@ -25,12 +25,14 @@
  *
  **************************************************************************/
 
+#include "util/u_atomic.h"
 #include "util/u_framebuffer.h"
 #include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/u_inlines.h"
 #include "util/simple_list.h"
 #include "util/u_format.h"
+#include "util/os_time.h"
 #include "lp_scene.h"
 #include "lp_fence.h"
 #include "lp_debug.h"
@@ -49,9 +51,10 @@ struct resource_ref {
 /**
  * Create a new scene object.
  * \param queue  the queue to put newly rendered/emptied scenes into
+ * \param num_threads  number of rasterizer threads that will share the bins
  */
 struct lp_scene *
-lp_scene_create( struct pipe_context *pipe )
+lp_scene_create( struct pipe_context *pipe, unsigned num_threads )
 {
    struct lp_scene *scene = CALLOC_STRUCT(lp_scene);
    if (!scene)
@@ -59,6 +62,14 @@ lp_scene_create( struct pipe_context *pipe )
 
    scene->pipe = pipe;
 
+   scene->num_bin_ranges = MAX2(1, num_threads);
+   scene->bin_ranges = align_malloc(scene->num_bin_ranges *
+                                    sizeof *scene->bin_ranges, 64);
+   if (!scene->bin_ranges) {
+      FREE(scene);
+      return NULL;
+   }
+
    scene->data.head =
       CALLOC_STRUCT(data_block);
 
@@ -91,6 +102,7 @@ lp_scene_destroy(struct lp_scene *scene)
 {
    lp_fence_reference(&scene->fence, NULL);
    mtx_destroy(&scene->mutex);
+   align_free(scene->bin_ranges);
    assert(scene->data.head->next == NULL);
    FREE(scene->data.head);
    FREE(scene);
@@ -198,6 +210,26 @@ lp_scene_begin_rasterization(struct lp_scene *scene)
                                                LP_TEX_USAGE_READ_WRITE);
       scene->zsbuf.format_bytes = util_format_get_blocksize(zsbuf->format);
    }
+
+   /*
+    * Textures sampled by this scene must have their fast cleared tiles
+    * filled in.  Scenes are rasterized in order and no tile of this one
+    * has run yet, so nothing else is touching them now.  This includes
+    * textures which are also render targets of the scene, e.g. when
+    * building mipmaps, where another level of the texture is sampled.
+    */
+   {
+      struct resource_ref *ref;
+
+      for (ref = scene->resources; ref; ref = ref->next) {
+         for (i = 0; i < ref->count; i++) {
+            struct pipe_resource *res = ref->resource[i];
+
+            if (llvmpipe_resource_is_texture(res))
+               llvmpipe_resolve_clears(res);
+         }
+      }
+   }
 }
 
 
@@ -249,6 +281,8 @@ lp_scene_end_rasterization(struct lp_scene *scene )
     */
    assert(lp_scene_is_empty(scene));
 
+   mtx_lock(&scene->mutex);
+
    /* Decrement texture ref counts
     */
    {
@@ -298,6 +332,8 @@ lp_scene_end_rasterization(struct lp_scene *scene )
    scene->alloc_failed = FALSE;
 
    util_unreference_framebuffer_state( &scene->fb );
+
+   mtx_unlock(&scene->mutex);
 }
 
 
@@ -429,81 +465,152 @@ lp_scene_add_resource_reference(struct lp_scene *scene,
 
 /**
  * Does this scene have a reference to the given resource?
+ * Returns a mask of LP_REFERENCED_FOR_READ/WRITE bits.
+ *
+ * The scene may still be queued for rasterization, and be reset by a
+ * rasterizer thread concurrently, hence the locking.
  */
-boolean
-lp_scene_is_resource_referenced(const struct lp_scene *scene,
+unsigned
+lp_scene_is_resource_referenced(struct lp_scene *scene,
                                 const struct pipe_resource *resource)
 {
    const struct resource_ref *ref;
+   unsigned referenced = LP_UNREFERENCED;
    int i;
 
+   mtx_lock(&scene->mutex);
+
+   for (i = 0; i < scene->fb.nr_cbufs; i++) {
+      if (scene->fb.cbufs[i] && scene->fb.cbufs[i]->texture == resource) {
+         referenced = LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE;
+         goto out;
+      }
+   }
+   if (scene->fb.zsbuf && scene->fb.zsbuf->texture == resource) {
+      referenced = LP_REFERENCED_FOR_READ | LP_REFERENCED_FOR_WRITE;
+      goto out;
+   }
+
    for (ref = scene->resources; ref; ref = ref->next) {
-      for (i = 0; i < ref->count; i++)
-         if (ref->resource[i] == resource)
-            return TRUE;
+      for (i = 0; i < ref->count; i++) {
+         if (ref->resource[i] == resource) {
+            referenced = LP_REFERENCED_FOR_READ;
+            goto out;
+         }
+      }
    }
 
-   return FALSE;
+out:
+   mtx_unlock(&scene->mutex);
+   return referenced;
 }
 
 
 
 
-/** advance curr_x,y to the next bin */
+#define BIN_RANGE_PACK(begin, end) \
+   ((uint64_t)(begin) | ((uint64_t)(end) << 32))
+#define BIN_RANGE_BEGIN(packed) ((unsigned)((packed) & 0xffffffff))
+#define BIN_RANGE_END(packed)   ((unsigned)((packed) >> 32))
+
+
+/**
+ * Pop one bin index off the front (owner) or the back (thief) of a range.
+ * Returns FALSE if the range is exhausted.
+ */
 static boolean
-next_bin(struct lp_scene *scene)
+bin_range_pop(struct lp_bin_range *range, boolean steal, unsigned *index)
 {
-   scene->curr_x++;
-   if (scene->curr_x >= scene->tiles_x) {
-      scene->curr_x = 0;
-      scene->curr_y++;
-   }
-   if (scene->curr_y >= scene->tiles_y) {
-      /* no more bins */
-      return FALSE;
-   }
+   uint64_t old, new;
+
+   do {
+      unsigned begin, end;
+
+      old = p_atomic_read(&range->packed);
+      begin = BIN_RANGE_BEGIN(old);
+      end = BIN_RANGE_END(old);
+
+      if (begin >= end)
+         return FALSE;
+
+      if (steal) {
+         end--;
+         *index = end;
+      }
+      else {
+         *index = begin;
+         begin++;
+      }
+
+      new = BIN_RANGE_PACK(begin, end);
+   } while (p_atomic_cmpxchg(&range->packed, old, new) != old);
+
    return TRUE;
 }
 
 
+/**
+ * Prepare the scene's bins for rasterization.
+ *
+ * The bins are split, in row-major order, into one contiguous range per
+ * rasterizer thread, so that each thread keeps working on the same band
+ * of tiles (and hence the same framebuffer memory) from one scene to the
+ * next.  Called once per scene, by one thread, before any thread calls
+ * lp_scene_bin_iter_next().
+ */
 void
 lp_scene_bin_iter_begin( struct lp_scene *scene )
 {
-   scene->curr_x = scene->curr_y = -1;
+   unsigned num_bins = lp_scene_get_num_bins(scene);
+   unsigned num_ranges = scene->num_bin_ranges;
+   unsigned i;
+
+   for (i = 0; i < num_ranges; i++) {
+      unsigned begin = (unsigned)((uint64_t)num_bins * i / num_ranges);
+      unsigned end = (unsigned)((uint64_t)num_bins * (i + 1) / num_ranges);
+      scene->bin_ranges[i].packed = BIN_RANGE_PACK(begin, end);
+   }
 }
 
 
 /**
- * Return pointer to next bin to be rendered.
- * The lp_scene::curr_x and ::curr_y fields will be advanced.
- * Multiple rendering threads will call this function to get a chunk
- * of work (a bin) to work on.
+ * Return pointer to next bin to be rendered by the given thread.
+ *
+ * A thread first drains its own range front to back.  Once that is
+ * empty it steals from the back of the other threads' ranges, trying the
+ * nearest thread indices first, as those are the most likely to be
+ * working on neighbouring (and hence cache/NUMA-local) tiles.
  */
 struct cmd_bin *
-lp_scene_bin_iter_next( struct lp_scene *scene , int *x, int *y)
+lp_scene_bin_iter_next( struct lp_scene *scene, unsigned range,
+                        int *x, int *y )
 {
-   struct cmd_bin *bin = NULL;
+   unsigned num_ranges = scene->num_bin_ranges;
+   unsigned index;
+   unsigned i;
 
-   mtx_lock(&scene->mutex);
+   assert(range < num_ranges);
 
-   if (scene->curr_x < 0) {
-      /* first bin */
-      scene->curr_x = 0;
-      scene->curr_y = 0;
-   }
-   else if (!next_bin(scene)) {
-      /* no more bins left */
-      goto end;
+   if (!bin_range_pop(&scene->bin_ranges[range], FALSE, &index)) {
+      for (i = 1; i < num_ranges; i++) {
+         /* Visit victims in the order range+1, range-1, range+2, ... */
+         unsigned dist = (i + 1) / 2;
+         unsigned victim = (i & 1) ? range + dist : range + num_ranges - dist;
+         victim %= num_ranges;
+
+         if (bin_range_pop(&scene->bin_ranges[victim], TRUE, &index))
+            break;
+      }
+      if (i == num_ranges) {
+         /* no more bins left */
+         return NULL;
+      }
    }
 
-   bin = lp_scene_get_bin(scene, scene->curr_x, scene->curr_y);
-   *x = scene->curr_x;
-   *y = scene->curr_y;
+   *x = index % scene->tiles_x;
+   *y = index / scene->tiles_x;
 
-end:
-   /*printf("return bin %p at %d, %d\n", (void *) bin, *bin_x, *bin_y);*/
-   mtx_unlock(&scene->mutex);
-   return bin;
+   return lp_scene_get_bin(scene, *x, *y);
 }
 
 
@@ -516,6 +623,7 @@ void lp_scene_begin_binning( struct lp_scene *scene,
    assert(lp_scene_is_empty(scene));
 
    scene->discard = discard;
+   scene->bin_start = os_time_get_nano();
    util_copy_framebuffer_state(&scene->fb, fb);
 
    scene->tiles_x = align(fb->width, TILE_SIZE) / TILE_SIZE;
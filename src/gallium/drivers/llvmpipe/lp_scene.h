@@ -117,6 +117,18 @@ struct data_block_list {
 
 struct resource_ref;
 
+/**
+ * A contiguous range of bins [begin, end), in row-major bin order, owned
+ * by one rasterizer thread.  Both ends are packed into a single 64-bit
+ * word so that the owner (popping from the front) and thieves (popping
+ * from the back) can update it with one compare-and-swap.
+ */
+struct lp_bin_range {
+   uint64_t packed;
+   /* Keep each range on its own cache line to avoid false sharing */
+   uint8_t pad[64 - sizeof(uint64_t)];
+};
+
 /**
  * All bins and bin data are contained here.
  * Per-bin data goes into the 'tile' bins.
@@ -173,16 +185,26 @@ struct lp_scene {
     */
    unsigned tiles_x, tiles_y;
 
-   int curr_x, curr_y;  /**< for iterating over bins */
+   /** When binning of the scene began and ended, for LP_PROFILE */
+   int64_t bin_start, bin_end;
+
+   /** Protects the resource list and framebuffer state, which the setup
+    * module may look at while a rasterizer thread resets the scene.
+    */
    mtx_t mutex;
 
+   /** Per-thread bin ranges, for iterating over bins */
+   struct lp_bin_range *bin_ranges;
+   unsigned num_bin_ranges;
+
    struct cmd_bin tile[TILES_X][TILES_Y];
    struct data_block_list data;
 };
 
 
 
-struct lp_scene *lp_scene_create(struct pipe_context *pipe);
+struct lp_scene *lp_scene_create(struct pipe_context *pipe,
+                                 unsigned num_threads);
 
 void lp_scene_destroy(struct lp_scene *scene);
 
@@ -199,8 +221,8 @@ boolean lp_scene_add_resource_reference(struct lp_scene *scene,
                                         struct pipe_resource *resource,
                                         boolean initializing_scene);
 
-boolean lp_scene_is_resource_referenced(const struct lp_scene *scene,
-                                        const struct pipe_resource *resource );
+unsigned lp_scene_is_resource_referenced(struct lp_scene *scene,
+                                         const struct pipe_resource *resource );
 
 
 /**
@@ -382,7 +404,8 @@ void
 lp_scene_bin_iter_begin( struct lp_scene *scene );
 
 struct cmd_bin *
-lp_scene_bin_iter_next( struct lp_scene *scene, int *x, int *y );
+lp_scene_bin_iter_next( struct lp_scene *scene, unsigned range,
+                        int *x, int *y );
 
 
 
@@ -38,7 +38,8 @@
 
 
 
-#define MAX_SCENE_QUEUE 4
+/* Enough for a few contexts' worth of pipelined scenes (see MAX_SCENES) */
+#define MAX_SCENE_QUEUE 16
 
 struct scene_packet {
    struct util_packet header;
@@ -32,10 +32,16 @@
 #include "util/u_format.h"
 #include "util/u_string.h"
 #include "util/u_format_s3tc.h"
+#include "util/disk_cache.h"
+#include "util/mesa-sha1.h"
 #include "pipe/p_defines.h"
 #include "pipe/p_screen.h"
 #include "draw/draw_context.h"
 #include "gallivm/lp_bld_type.h"
+#include "gallivm/lp_bld_debug.h"
+#include "gallivm/lp_bld_init.h"
+#include "gallivm/lp_bld_misc.h"
+#include "gallivm/lp_bld_nir.h"
 
 #include "os/os_misc.h"
 #include "util/os_time.h"
@@ -48,6 +54,7 @@
 #include "lp_public.h"
 #include "lp_limits.h"
 #include "lp_rast.h"
+#include "lp_query.h"
 
 #include "state_tracker/sw_winsys.h"
 
@@ -67,6 +74,7 @@ static const struct debug_named_value lp_debug_flags[] = {
    { "fence", DEBUG_FENCE, NULL },
    { "mem", DEBUG_MEM, NULL },
    { "fs", DEBUG_FS, NULL },
+   { "nir", DEBUG_NIR, NULL },
    DEBUG_NAMED_VALUE_END
 };
 #endif
@@ -81,6 +89,9 @@ static const struct debug_named_value lp_perf_flags[] = {
    { "no_blend",       PERF_NO_BLEND, NULL },
    { "no_depth",       PERF_NO_DEPTH, NULL },
    { "no_alphatest",   PERF_NO_ALPHATEST, NULL },
+   { "no_linear_path", PERF_NO_LINEAR_PATH, NULL },
+   { "no_hiz",         PERF_NO_HIZ, NULL },
+   { "no_tex_tiling",  PERF_NO_TEX_TILING, NULL },
    DEBUG_NAMED_VALUE_END
 };
 
@@ -208,7 +219,11 @@ llvmpipe_get_param(struct pipe_screen *screen, enum pipe_cap param)
    case PIPE_CAP_QUADS_FOLLOW_PROVOKING_VERTEX_CONVENTION:
       return 0;
    case PIPE_CAP_COMPUTE:
-      return 0;
+      /* Groundwork only: shader buffers, shared memory and top-level barriers.
+       * GL_ARB_compute_shader stays off in st/mesa until images and
+       * graphics-stage atomic counters are implemented.
+       */
+      return 1;
    case PIPE_CAP_USER_VERTEX_BUFFERS:
       return 1;
    case PIPE_CAP_VERTEX_BUFFER_OFFSET_4BYTE_ALIGNED_ONLY:
@@ -375,6 +390,11 @@ llvmpipe_get_shader_param(struct pipe_screen *screen,
    {
    case PIPE_SHADER_FRAGMENT:
       switch (param) {
+      case PIPE_SHADER_CAP_SUPPORTED_IRS:
+         /* NIR is translated by lp_bld_nir_soa, but TGSI stays preferred
+          * since the draw module runs vertex and geometry shaders from TGSI.
+          */
+         return (1 << PIPE_SHADER_IR_TGSI) | (1 << PIPE_SHADER_IR_NIR);
       default:
          return gallivm_get_shader_param(param);
       }
@@ -398,11 +418,80 @@ llvmpipe_get_shader_param(struct pipe_screen *screen,
       default:
          return draw_get_shader_param(shader, param);
       }
+   case PIPE_SHADER_COMPUTE:
+      switch (param) {
+      case PIPE_SHADER_CAP_MAX_SHADER_BUFFERS:
+         return LP_MAX_TGSI_SHADER_BUFFERS;
+      default:
+         return gallivm_get_shader_param(param);
+      }
    default:
       return 0;
    }
 }
 
+static const void *
+llvmpipe_get_compiler_options(struct pipe_screen *screen,
+                              enum pipe_shader_ir ir,
+                              enum pipe_shader_type shader)
+{
+   assert(ir == PIPE_SHADER_IR_NIR);
+   return lp_build_nir_compiler_options();
+}
+
+static int
+llvmpipe_get_compute_param(struct pipe_screen *_screen,
+                           enum pipe_shader_ir ir_type,
+                           enum pipe_compute_cap param,
+                           void *ret)
+{
+   switch (param) {
+   case PIPE_COMPUTE_CAP_IR_TARGET:
+      return 0;
+   case PIPE_COMPUTE_CAP_MAX_GRID_SIZE:
+      if (ret) {
+         uint64_t *grid_size = ret;
+         grid_size[0] = 65535;
+         grid_size[1] = 65535;
+         grid_size[2] = 65535;
+      }
+      return 3 * sizeof(uint64_t);
+   case PIPE_COMPUTE_CAP_MAX_BLOCK_SIZE:
+      if (ret) {
+         uint64_t *block_size = ret;
+         block_size[0] = 1024;
+         block_size[1] = 1024;
+         block_size[2] = 1024;
+      }
+      return 3 * sizeof(uint64_t);
+   case PIPE_COMPUTE_CAP_MAX_THREADS_PER_BLOCK:
+      if (ret) {
+         uint64_t *max_threads_per_block = ret;
+         *max_threads_per_block = 1024;
+      }
+      return sizeof(uint64_t);
+   case PIPE_COMPUTE_CAP_MAX_LOCAL_SIZE:
+      if (ret) {
+         uint64_t *max_local_size = ret;
+         *max_local_size = 32768;
+      }
+      return sizeof(uint64_t);
+   case PIPE_COMPUTE_CAP_GRID_DIMENSION:
+   case PIPE_COMPUTE_CAP_MAX_GLOBAL_SIZE:
+   case PIPE_COMPUTE_CAP_MAX_PRIVATE_SIZE:
+   case PIPE_COMPUTE_CAP_MAX_INPUT_SIZE:
+   case PIPE_COMPUTE_CAP_MAX_MEM_ALLOC_SIZE:
+   case PIPE_COMPUTE_CAP_MAX_CLOCK_FREQUENCY:
+   case PIPE_COMPUTE_CAP_MAX_COMPUTE_UNITS:
+   case PIPE_COMPUTE_CAP_IMAGES_SUPPORTED:
+   case PIPE_COMPUTE_CAP_SUBGROUP_SIZE:
+   case PIPE_COMPUTE_CAP_ADDRESS_BITS:
+   case PIPE_COMPUTE_CAP_MAX_VARIABLE_THREADS_PER_BLOCK:
+      break;
+   }
+   return 0;
+}
+
 static float
 llvmpipe_get_paramf(struct pipe_screen *screen, enum pipe_capf param)
 {
@@ -552,6 +641,18 @@ llvmpipe_flush_frontbuffer(struct pipe_screen *_screen,
    struct llvmpipe_screen *screen = llvmpipe_screen(_screen);
    struct sw_winsys *winsys = screen->winsys;
    struct llvmpipe_resource *texture = llvmpipe_resource(resource);
+   struct lp_fence *fence = NULL;
+
+   /* Scenes may still be queued for rasterization after the flush which
+    * preceded this, so drain the rasterizer before presenting.
+    */
+   mtx_lock(&screen->rast_mutex);
+   lp_fence_reference(&fence, screen->last_fence);
+   mtx_unlock(&screen->rast_mutex);
+   if (fence) {
+      lp_fence_wait(fence);
+      lp_fence_reference(&fence, NULL);
+   }
 
    assert(texture->dt);
    if (texture->dt)
@@ -567,6 +668,13 @@ llvmpipe_destroy_screen( struct pipe_screen *_screen )
    if (screen->rast)
       lp_rast_destroy(screen->rast);
 
+   lp_fence_reference(&screen->last_fence, NULL);
+
+   if (util_queue_is_initialized(&screen->compile_queue))
+      util_queue_destroy(&screen->compile_queue);
+
+   disk_cache_destroy(screen->disk_shader_cache);
+
    lp_jit_screen_cleanup(screen);
 
    if(winsys->destroy)
@@ -619,6 +727,119 @@ llvmpipe_get_timestamp(struct pipe_screen *_screen)
    return os_time_get_nano();
 }
 
+/**
+ * Create the persistent shader cache.
+ *
+ * The machine code depends on the Mesa and LLVM builds, on the CPU it is
+ * generated for and on the debug/perf options, so all of these go into the
+ * cache id.  The shader and variant key are hashed by the callers.
+ */
+static void
+lp_disk_cache_create(struct llvmpipe_screen *screen)
+{
+   struct mesa_sha1 ctx;
+   unsigned char sha1[20];
+   char cache_id[20 * 2 + 1];
+   char cpu_name[64];
+   uint32_t mesa_timestamp, llvm_timestamp;
+   uint64_t cpu_flags = 0;
+   unsigned debug_flags[4];
+
+   if (!disk_cache_get_function_timestamp(lp_disk_cache_create,
+                                          &mesa_timestamp) ||
+       !disk_cache_get_function_timestamp(LLVMModuleCreateWithNameInContext,
+                                          &llvm_timestamp))
+      return;
+
+   lp_build_get_host_cpu_name(cpu_name, sizeof cpu_name);
+
+   /* These are the features gallivm generates code for, after lp_build_init
+    * has masked them.
+    */
+   cpu_flags |= (uint64_t)util_cpu_caps.has_sse    << 0;
+   cpu_flags |= (uint64_t)util_cpu_caps.has_sse2   << 1;
+   cpu_flags |= (uint64_t)util_cpu_caps.has_sse3   << 2;
+   cpu_flags |= (uint64_t)util_cpu_caps.has_ssse3  << 3;
+   cpu_flags |= (uint64_t)util_cpu_caps.has_sse4_1 << 4;
+   cpu_flags |= (uint64_t)util_cpu_caps.has_sse4_2 << 5;
+   cpu_flags |= (uint64_t)util_cpu_caps.has_avx    << 6;
+   cpu_flags |= (uint64_t)util_cpu_caps.has_avx2   << 7;
+   cpu_flags |= (uint64_t)util_cpu_caps.has_f16c   << 8;
+   cpu_flags |= (uint64_t)util_cpu_caps.has_fma    << 9;
+   cpu_flags |= (uint64_t)util_cpu_caps.has_altivec << 10;
+   cpu_flags |= (uint64_t)util_cpu_caps.has_neon   << 11;
+   cpu_flags |= (uint64_t)lp_native_vector_width   << 32;
+
+   debug_flags[0] = LP_DEBUG;
+   debug_flags[1] = LP_PERF;
+   debug_flags[2] = gallivm_debug;
+   debug_flags[3] = sizeof(void *);
+
+   _mesa_sha1_init(&ctx);
+   _mesa_sha1_update(&ctx, &mesa_timestamp, sizeof mesa_timestamp);
+   _mesa_sha1_update(&ctx, &llvm_timestamp, sizeof llvm_timestamp);
+   _mesa_sha1_update(&ctx, cpu_name, strlen(cpu_name));
+   _mesa_sha1_update(&ctx, debug_flags, sizeof debug_flags);
+   _mesa_sha1_final(&ctx, sha1);
+   disk_cache_format_hex_id(cache_id, sha1, 20 * 2);
+
+   screen->disk_shader_cache = disk_cache_create("llvmpipe", cache_id,
+                                                 cpu_flags);
+}
+
+
+/**
+ * Look up the machine code for a shader variant in the disk cache.
+ * On a hit cache->data/data_size are filled in, and must be freed by the
+ * caller.
+ */
+void
+lp_disk_cache_find_shader(struct llvmpipe_screen *screen,
+                          struct lp_cached_code *cache,
+                          const unsigned char ir_sha1_cache_key[20])
+{
+   cache_key sha1;
+   size_t binary_size;
+   void *buffer;
+
+   if (!screen->disk_shader_cache)
+      return;
+
+   disk_cache_compute_key(screen->disk_shader_cache, ir_sha1_cache_key, 20,
+                          sha1);
+
+   buffer = disk_cache_get(screen->disk_shader_cache, sha1, &binary_size);
+   if (!buffer) {
+      cache->data_size = 0;
+      return;
+   }
+
+   cache->data = buffer;
+   cache->data_size = binary_size;
+}
+
+
+/**
+ * Store the machine code of a freshly compiled shader variant in the disk
+ * cache, unless it can't be reused by other processes.
+ */
+void
+lp_disk_cache_insert_shader(struct llvmpipe_screen *screen,
+                            struct lp_cached_code *cache,
+                            const unsigned char ir_sha1_cache_key[20])
+{
+   cache_key sha1;
+
+   if (!screen->disk_shader_cache || !cache->data_size || cache->dont_cache)
+      return;
+
+   disk_cache_compute_key(screen->disk_shader_cache, ir_sha1_cache_key, 20,
+                          sha1);
+   disk_cache_put(screen->disk_shader_cache, sha1, cache->data,
+                  cache->data_size, NULL);
+}
+
+
 /**
  * Create a new pipe_screen object
  * Note: we're not presently subclassing pipe_screen (no llvmpipe_screen).
@@ -627,6 +848,8 @@ struct pipe_screen *
 llvmpipe_create_screen(struct sw_winsys *winsys)
 {
    struct llvmpipe_screen *screen;
+   unsigned num_compiler_threads;
+   long cache_size_mb;
 
    util_cpu_detect();
 
@@ -647,6 +870,8 @@ llvmpipe_create_screen(struct sw_winsys *winsys)
 
    screen->winsys = winsys;
 
+   lp_disk_cache_create(screen);
+
    screen->base.destroy = llvmpipe_destroy_screen;
 
    screen->base.get_name = llvmpipe_get_name;
@@ -654,6 +879,8 @@ llvmpipe_create_screen(struct sw_winsys *winsys)
    screen->base.get_device_vendor = llvmpipe_get_vendor; // TODO should be the CPU vendor
    screen->base.get_param = llvmpipe_get_param;
    screen->base.get_shader_param = llvmpipe_get_shader_param;
+   screen->base.get_compute_param = llvmpipe_get_compute_param;
+   screen->base.get_compiler_options = llvmpipe_get_compiler_options;
    screen->base.get_paramf = llvmpipe_get_paramf;
    screen->base.is_format_supported = llvmpipe_is_format_supported;
 
@@ -663,6 +890,7 @@ llvmpipe_create_screen(struct sw_winsys *winsys)
    screen->base.fence_finish = llvmpipe_fence_finish;
 
    screen->base.get_timestamp = llvmpipe_get_timestamp;
+   screen->base.get_driver_query_info = llvmpipe_get_driver_query_info;
 
    llvmpipe_init_screen_resource_funcs(&screen->base);
 
@@ -673,13 +901,31 @@ llvmpipe_create_screen(struct sw_winsys *winsys)
    screen->num_threads = debug_get_num_option("LP_NUM_THREADS", screen->num_threads);
    screen->num_threads = MIN2(screen->num_threads, LP_MAX_THREADS);
 
+   cache_size_mb = debug_get_num_option("LP_SHADER_CACHE_SIZE",
+                                        LP_MAX_SHADER_CODE_SIZE >> 20);
+   screen->fs_cache_size = (uint64_t) MAX2(cache_size_mb, 1) << 20;
+
    screen->rast = lp_rast_create(screen->num_threads);
    if (!screen->rast) {
+      disk_cache_destroy(screen->disk_shader_cache);
       lp_jit_screen_cleanup(screen);
       FREE(screen);
       return NULL;
    }
    (void) mtx_init(&screen->rast_mutex, mtx_plain);
 
+   /* Compiler threads run at the lowest priority, so that they don't slow
+    * down the rasterizer threads.  If the queue can't be created, variants
+    * are simply compiled synchronously.
+    */
+   num_compiler_threads = debug_get_num_option("LP_ASYNC_COMPILE", 0);
+   num_compiler_threads = MIN2(num_compiler_threads, LP_MAX_THREADS);
+   if (num_compiler_threads) {
+      (void) util_queue_init(&screen->compile_queue, "llvmpipe_compile",
+                             32, num_compiler_threads,
+                             UTIL_QUEUE_INIT_RESIZE_IF_FULL |
+                             UTIL_QUEUE_INIT_USE_MINIMUM_PRIORITY);
+   }
+
    return &screen->base;
 }
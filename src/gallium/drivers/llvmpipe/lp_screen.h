@@ -37,10 +37,13 @@
 #include "pipe/p_screen.h"
 #include "pipe/p_defines.h"
 #include "os/os_thread.h"
+#include "util/u_queue.h"
 #include "gallivm/lp_bld.h"
 
 
 struct sw_winsys;
+struct disk_cache;
+struct lp_cached_code;
 
 
 struct llvmpipe_screen
@@ -57,6 +60,18 @@ struct llvmpipe_screen
 
    struct lp_rasterizer *rast;
    mtx_t rast_mutex;
+
+   /** Fence of the most recently queued scene, from any context */
+   struct lp_fence *last_fence;
+
+   /** Persistent cache of compiled shader variants (may be NULL) */
+   struct disk_cache *disk_shader_cache;
+
+   /** Compiles optimized shader variants in the background, if initialized */
+   struct util_queue compile_queue;
+
+   /** Code size budget of each context's fragment shader variants */
+   uint64_t fs_cache_size;
 };
 
 
@@ -69,5 +84,16 @@ llvmpipe_screen( struct pipe_screen *pipe )
 }
 
 
+void
+lp_disk_cache_find_shader(struct llvmpipe_screen *screen,
+                          struct lp_cached_code *cache,
+                          const unsigned char ir_sha1_cache_key[20]);
+
+void
+lp_disk_cache_insert_shader(struct llvmpipe_screen *screen,
+                            struct lp_cached_code *cache,
+                            const unsigned char ir_sha1_cache_key[20]);
+
+
 
 #endif /* LP_SCREEN_H */
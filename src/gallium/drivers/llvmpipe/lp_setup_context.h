@@ -54,9 +54,12 @@
 struct lp_setup_variant;
 
 
-/** Max number of scenes */
-/* XXX: make multiple scenes per context work, see lp_setup_rasterize_scene */
-#define MAX_SCENES 1
+/**
+ * Max number of scenes per context.  Scenes form a pipeline: while the
+ * rasterizer threads work on one scene the next ones can be binned.  The
+ * actual depth is setup->num_scenes (LP_NUM_SCENES).
+ */
+#define MAX_SCENES 8
 
 
 
@@ -87,8 +90,10 @@ struct lp_setup_context
     */
    struct draw_stage *vbuf;
    unsigned num_threads;
+   unsigned num_scenes;
    unsigned scene_idx;
    struct lp_scene *scenes[MAX_SCENES];  /**< all the scenes */
+   struct lp_fence *scene_fences[MAX_SCENES]; /**< fences of queued scenes */
    struct lp_scene *scene;               /**< current scene being built */
 
    struct lp_fence *last_fence;
@@ -384,6 +384,9 @@ do_triangle_ccw(struct lp_setup_context *setup,
    tri->inputs.frontfacing = frontfacing;
    tri->inputs.disable = FALSE;
    tri->inputs.opaque = setup->fs.current.variant->opaque;
+   tri->inputs.linear = lp_linear_check_triangle(setup->fs.current.variant,
+                                                 &setup->fs.current.jit_context,
+                                                 &tri->inputs, &bbox);
    tri->inputs.layer = layer;
    tri->inputs.viewport_index = viewport_index;
 
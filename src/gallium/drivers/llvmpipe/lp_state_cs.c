@@ -0,0 +1,835 @@
+/**************************************************************************
+ * 
+ * Copyright 2018 VMware, Inc.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ * 
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ * 
+ **************************************************************************/
+
+/**
+ * Compute shaders.
+ *
+ * Work groups are handed out to the rasterizer threads, which run them
+ * one at a time from start to end.  The invocations of a work group are
+ * run a vector of them at a time; to honour barriers, the shader code is
+ * split into phases at each barrier, see lp_build_tgsi_cs_iface, and every
+ * vector of invocations runs a phase before any of them starts the next.
+ */
+
+#include "pipe/p_defines.h"
+#include "util/u_atomic.h"
+#include "util/u_inlines.h"
+#include "util/u_math.h"
+#include "util/u_memory.h"
+#include "util/u_string.h"
+#include "tgsi/tgsi_dump.h"
+#include "tgsi/tgsi_parse.h"
+#include "gallivm/lp_bld_arit.h"
+#include "gallivm/lp_bld_const.h"
+#include "gallivm/lp_bld_debug.h"
+#include "gallivm/lp_bld_flow.h"
+#include "gallivm/lp_bld_init.h"
+#include "gallivm/lp_bld_intr.h"
+#include "gallivm/lp_bld_logic.h"
+#include "gallivm/lp_bld_struct.h"
+#include "gallivm/lp_bld_tgsi.h"
+#include "gallivm/lp_bld_type.h"
+#include "lp_context.h"
+#include "lp_debug.h"
+#include "lp_fence.h"
+#include "lp_flush.h"
+#include "lp_rast.h"
+#include "lp_screen.h"
+#include "lp_state.h"
+#include "lp_state_cs.h"
+#include "lp_tex_sample.h"
+#include "lp_texture.h"
+
+
+/** Variants kept per compute shader */
+#define LP_MAX_CS_VARIANTS 8
+
+
+/**
+ * State of a grid launch, shared by the rasterizer threads.
+ */
+struct lp_cs_job
+{
+   struct lp_jit_context jit_context;
+
+   lp_jit_cs_func jit_function;
+
+   uint32_t grid_size[3];
+   uint32_t block_size[3];
+
+   unsigned num_phases;
+   unsigned num_chunks;       /**< vectors of invocations per work group */
+   unsigned chunk_length;     /**< invocations per vector */
+   unsigned shared_size;      /**< bytes of shared memory per work group */
+   unsigned temps_size;       /**< bytes of temporaries per vector */
+
+   uint64_t num_blocks;
+   int64_t next_block;        /**< next work group to hand out */
+
+   /** Shared memory followed by temporaries, for each rasterizer thread */
+   uint8_t *thread_mem[LP_MAX_THREADS];
+};
+
+
+static unsigned cs_no = 0;
+
+static const float fake_const_buf[4];
+static const uint32_t fake_ssbo_buf[4];
+
+
+static struct lp_type
+cs_vector_type(void)
+{
+   struct lp_type type;
+
+   memset(&type, 0, sizeof type);
+   type.floating = TRUE;      /* floating point values */
+   type.sign = TRUE;          /* values are signed */
+   type.norm = FALSE;         /* values are not limited to [0,1] or [-1,1] */
+   type.width = 32;           /* 32-bit float */
+   type.length = MIN2(lp_native_vector_width / 32, 16);
+
+   return type;
+}
+
+
+/**
+ * Generate the compute shader function, see lp_jit_cs_func.
+ */
+static void
+generate_compute(struct lp_compute_shader *shader,
+                 struct lp_compute_shader_variant *variant)
+{
+   struct gallivm_state *gallivm = variant->gallivm;
+   LLVMContextRef lc = gallivm->context;
+   LLVMTypeRef int32_type = LLVMInt32TypeInContext(lc);
+   LLVMTypeRef int32_ptr_type = LLVMPointerType(int32_type, 0);
+   LLVMTypeRef int8_ptr_type = LLVMPointerType(LLVMInt8TypeInContext(lc), 0);
+   struct lp_type cs_type = cs_vector_type();
+   LLVMTypeRef arg_types[9];
+   LLVMTypeRef func_type;
+   LLVMValueRef function;
+   LLVMValueRef context_ptr, thread_data_ptr;
+   LLVMValueRef block_id_ptr, grid_size_ptr, block_size_ptr;
+   LLVMValueRef first_invocation, phase, shared_ptr, temps_ptr;
+   LLVMValueRef consts_ptr, num_consts_ptr;
+   LLVMValueRef invocation, size_x, size_y, num_invocations, tmp;
+   LLVMValueRef lanes[LP_MAX_VECTOR_LENGTH];
+   LLVMValueRef outputs[PIPE_MAX_SHADER_OUTPUTS][TGSI_NUM_CHANNELS];
+   LLVMBasicBlockRef block;
+   LLVMBuilderRef builder;
+   struct lp_build_context uint_bld;
+   struct lp_build_mask_context mask;
+   struct lp_bld_tgsi_system_values system_values;
+   struct lp_build_tgsi_cs_iface cs_iface;
+   struct lp_build_sampler_soa *sampler;
+   unsigned i;
+
+   /*
+    * Generate the function prototype. Any change here must be reflected in
+    * lp_jit.h's lp_jit_cs_func function pointer type, and vice-versa.
+    */
+   arg_types[0] = variant->jit_context_ptr_type;       /* context */
+   arg_types[1] = variant->jit_thread_data_ptr_type;   /* per thread data */
+   arg_types[2] = int32_ptr_type;                      /* block_id */
+   arg_types[3] = int32_ptr_type;                      /* grid_size */
+   arg_types[4] = int32_ptr_type;                      /* block_size */
+   arg_types[5] = int32_type;                          /* first_invocation */
+   arg_types[6] = int32_type;                          /* phase */
+   arg_types[7] = int8_ptr_type;                       /* shared_mem */
+   arg_types[8] = int8_ptr_type;                       /* temps */
+
+   func_type = LLVMFunctionType(LLVMVoidTypeInContext(lc),
+                                arg_types, ARRAY_SIZE(arg_types), 0);
+
+   function = LLVMAddFunction(gallivm->module, "cs_variant", func_type);
+   LLVMSetFunctionCallConv(function, LLVMCCallConv);
+
+   variant->function = function;
+
+   for (i = 0; i < ARRAY_SIZE(arg_types); ++i)
+      if (LLVMGetTypeKind(arg_types[i]) == LLVMPointerTypeKind)
+         lp_add_function_attr(function, i + 1, LP_FUNC_ATTR_NOALIAS);
+
+   context_ptr      = LLVMGetParam(function, 0);
+   thread_data_ptr  = LLVMGetParam(function, 1);
+   block_id_ptr     = LLVMGetParam(function, 2);
+   grid_size_ptr    = LLVMGetParam(function, 3);
+   block_size_ptr   = LLVMGetParam(function, 4);
+   first_invocation = LLVMGetParam(function, 5);
+   phase            = LLVMGetParam(function, 6);
+   shared_ptr       = LLVMGetParam(function, 7);
+   temps_ptr        = LLVMGetParam(function, 8);
+
+   lp_build_name(context_ptr, "context");
+   lp_build_name(thread_data_ptr, "thread_data");
+   lp_build_name(block_id_ptr, "block_id");
+   lp_build_name(grid_size_ptr, "grid_size");
+   lp_build_name(block_size_ptr, "block_size");
+   lp_build_name(first_invocation, "first_invocation");
+   lp_build_name(phase, "phase");
+   lp_build_name(shared_ptr, "shared_mem");
+   lp_build_name(temps_ptr, "temps");
+
+   /*
+    * Function body
+    */
+
+   block = LLVMAppendBasicBlockInContext(lc, function, "entry");
+   builder = gallivm->builder;
+   assert(builder);
+   LLVMPositionBuilderAtEnd(builder, block);
+
+   lp_build_context_init(&uint_bld, gallivm, lp_uint_type(cs_type));
+
+   memset(&system_values, 0, sizeof system_values);
+   for (i = 0; i < 3; i++) {
+      LLVMValueRef index = lp_build_const_int32(gallivm, i);
+      system_values.block_id[i] =
+         lp_build_pointer_get(builder, block_id_ptr, index);
+      system_values.grid_size[i] =
+         lp_build_pointer_get(builder, grid_size_ptr, index);
+      system_values.block_size[i] =
+         lp_build_pointer_get(builder, block_size_ptr, index);
+   }
+
+   /* Linear index of each lane's invocation within the work group */
+   for (i = 0; i < cs_type.length; i++) {
+      lanes[i] = lp_build_const_int32(gallivm, i);
+   }
+   invocation = lp_build_add(&uint_bld,
+                             lp_build_broadcast_scalar(&uint_bld,
+                                                       first_invocation),
+                             LLVMConstVector(lanes, cs_type.length));
+
+   size_x = lp_build_broadcast_scalar(&uint_bld, system_values.block_size[0]);
+   size_y = lp_build_broadcast_scalar(&uint_bld, system_values.block_size[1]);
+   system_values.thread_id[0] = LLVMBuildURem(builder, invocation, size_x, "");
+   tmp = LLVMBuildUDiv(builder, invocation, size_x, "");
+   system_values.thread_id[1] = LLVMBuildURem(builder, tmp, size_y, "");
+   system_values.thread_id[2] = LLVMBuildUDiv(builder, tmp, size_y, "");
+
+   /* The last vector of a work group may be partially used */
+   num_invocations = LLVMBuildMul(builder, system_values.block_size[0],
+                                  system_values.block_size[1], "");
+   num_invocations = LLVMBuildMul(builder, num_invocations,
+                                  system_values.block_size[2], "");
+   num_invocations = lp_build_broadcast_scalar(&uint_bld, num_invocations);
+
+   lp_build_mask_begin(&mask, gallivm, cs_type,
+                       lp_build_cmp(&uint_bld, PIPE_FUNC_LESS,
+                                    invocation, num_invocations));
+
+   memset(&cs_iface, 0, sizeof cs_iface);
+   cs_iface.shared_ptr = shared_ptr;
+   cs_iface.shared_size =
+      lp_build_const_int32(gallivm, shader->base.req_local_mem);
+   cs_iface.ssbo_ptr = lp_jit_context_ssbos(gallivm, context_ptr);
+   cs_iface.ssbo_sizes_ptr = lp_jit_context_ssbo_sizes(gallivm, context_ptr);
+   if (shader->num_phases > 1) {
+      cs_iface.phase = phase;
+      cs_iface.temps_ptr = temps_ptr;
+   }
+
+   consts_ptr = lp_jit_context_constants(gallivm, context_ptr);
+   num_consts_ptr = lp_jit_context_num_constants(gallivm, context_ptr);
+
+   /* code generated texture sampling */
+   sampler = lp_llvm_sampler_soa_create(variant->key.state);
+
+   memset(outputs, 0, sizeof outputs);
+
+   lp_build_tgsi_soa(gallivm, shader->tokens, cs_type, &mask,
+                     consts_ptr, num_consts_ptr, &system_values,
+                     NULL, outputs, context_ptr, thread_data_ptr,
+                     sampler, &shader->info, NULL, &cs_iface, NULL);
+
+   sampler->destroy(sampler);
+
+   lp_build_mask_end(&mask);
+
+   LLVMBuildRetVoid(builder);
+
+   gallivm_verify_function(gallivm, function);
+}
+
+
+static void
+make_variant_key(struct llvmpipe_context *lp,
+                 struct lp_compute_shader *shader,
+                 struct lp_compute_shader_variant_key *key)
+{
+   unsigned i;
+
+   memset(key, 0, sizeof *key);
+
+   key->nr_samplers = shader->info.file_max[TGSI_FILE_SAMPLER] + 1;
+
+   for (i = 0; i < key->nr_samplers; ++i) {
+      if (shader->info.file_mask[TGSI_FILE_SAMPLER] & (1 << i)) {
+         lp_sampler_static_sampler_state(&key->state[i].sampler_state,
+                                         lp->samplers[PIPE_SHADER_COMPUTE][i]);
+      }
+   }
+
+   /* See make_variant_key in lp_state_fs.c */
+   if (shader->info.file_max[TGSI_FILE_SAMPLER_VIEW] != -1) {
+      key->nr_sampler_views = shader->info.file_max[TGSI_FILE_SAMPLER_VIEW] + 1;
+      for (i = 0; i < key->nr_sampler_views; ++i) {
+         if (shader->info.file_mask[TGSI_FILE_SAMPLER_VIEW] & (1 << i)) {
+            lp_llvm_static_texture_state(&key->state[i].texture_state,
+                                         lp->sampler_views[PIPE_SHADER_COMPUTE][i]);
+         }
+      }
+   }
+   else {
+      key->nr_sampler_views = key->nr_samplers;
+      for (i = 0; i < key->nr_sampler_views; ++i) {
+         if (shader->info.file_mask[TGSI_FILE_SAMPLER] & (1 << i)) {
+            lp_llvm_static_texture_state(&key->state[i].texture_state,
+                                         lp->sampler_views[PIPE_SHADER_COMPUTE][i]);
+         }
+      }
+   }
+}
+
+
+static void
+destroy_variant(struct lp_compute_shader_variant *variant)
+{
+   gallivm_destroy(variant->gallivm);
+   FREE(variant);
+}
+
+
+static struct lp_compute_shader_variant *
+generate_variant(struct llvmpipe_context *lp,
+                 struct lp_compute_shader *shader,
+                 const struct lp_compute_shader_variant_key *key)
+{
+   struct lp_compute_shader_variant *variant;
+   char module_name[64];
+
+   variant = CALLOC_STRUCT(lp_compute_shader_variant);
+   if (!variant)
+      return NULL;
+
+   memcpy(&variant->key, key, sizeof *key);
+   variant->no = shader->nr_variants;
+
+   util_snprintf(module_name, sizeof(module_name), "cs%u_variant%u",
+                 shader->no, variant->no);
+
+   variant->gallivm = gallivm_create(module_name, lp->context, NULL);
+   if (!variant->gallivm) {
+      FREE(variant);
+      return NULL;
+   }
+
+   lp_jit_init_cs_types(variant);
+
+   generate_compute(shader, variant);
+
+   gallivm_compile_module(variant->gallivm);
+
+   variant->jit_function = (lp_jit_cs_func)
+      gallivm_jit_function(variant->gallivm, variant->function);
+
+   gallivm_free_ir(variant->gallivm);
+
+   return variant;
+}
+
+
+/**
+ * Find or build the variant of the bound compute shader for the current
+ * sampler state.
+ */
+static struct lp_compute_shader_variant *
+get_variant(struct llvmpipe_context *lp,
+            struct lp_compute_shader *shader)
+{
+   struct lp_compute_shader_variant_key key;
+   struct lp_compute_shader_variant *variant, **prev;
+
+   if (shader->unsupported) {
+      debug_printf("llvmpipe: compute shader %u has a barrier in control "
+                   "flow, which is not supported; grid skipped\n",
+                   shader->no);
+      return NULL;
+   }
+
+   make_variant_key(lp, shader, &key);
+
+   for (prev = &shader->variants; *prev; prev = &(*prev)->next) {
+      variant = *prev;
+      if (memcmp(&variant->key, &key, sizeof key) == 0) {
+         /* move to the front */
+         *prev = variant->next;
+         variant->next = shader->variants;
+         shader->variants = variant;
+         return variant;
+      }
+   }
+
+   if (LP_DEBUG & DEBUG_FS) {
+      debug_printf("llvmpipe: compute shader %u: new variant %u\n",
+                   shader->no, shader->nr_variants);
+   }
+
+   variant = generate_variant(lp, shader, &key);
+   if (!variant)
+      return NULL;
+
+   variant->next = shader->variants;
+   shader->variants = variant;
+   shader->nr_variants++;
+
+   /* drop the least recently used one */
+   if (shader->nr_variants > LP_MAX_CS_VARIANTS) {
+      struct lp_compute_shader_variant *last = variant;
+      while (last->next->next)
+         last = last->next;
+      destroy_variant(last->next);
+      last->next = NULL;
+      shader->nr_variants--;
+   }
+
+   return variant;
+}
+
+
+/**
+ * Whether any barrier of the shader is inside control flow or a
+ * subroutine, or follows a return from main.  The invocations of a vector
+ * may then not all reach it, and the shader can't be split into phases.
+ */
+static boolean
+has_barrier_in_control_flow(const struct tgsi_token *tokens)
+{
+   struct tgsi_parse_context parse;
+   unsigned depth = 0;
+   boolean returned = FALSE;
+   boolean found = FALSE;
+
+   tgsi_parse_init(&parse, tokens);
+   while (!tgsi_parse_end_of_tokens(&parse) && !found) {
+      tgsi_parse_token(&parse);
+      if (parse.FullToken.Token.Type != TGSI_TOKEN_TYPE_INSTRUCTION)
+         continue;
+
+      switch (parse.FullToken.FullInstruction.Instruction.Opcode) {
+      case TGSI_OPCODE_IF:
+      case TGSI_OPCODE_UIF:
+      case TGSI_OPCODE_BGNLOOP:
+      case TGSI_OPCODE_SWITCH:
+      case TGSI_OPCODE_BGNSUB:
+         depth++;
+         break;
+      case TGSI_OPCODE_ENDIF:
+      case TGSI_OPCODE_ENDLOOP:
+      case TGSI_OPCODE_ENDSWITCH:
+      case TGSI_OPCODE_ENDSUB:
+         if (depth)
+            depth--;
+         break;
+      case TGSI_OPCODE_RET:
+         if (depth == 0)
+            returned = TRUE;
+         break;
+      case TGSI_OPCODE_BARRIER:
+         found = depth > 0 || returned;
+         break;
+      default:
+         break;
+      }
+   }
+   tgsi_parse_free(&parse);
+
+   return found;
+}
+
+
+static void *
+llvmpipe_create_compute_state(struct pipe_context *pipe,
+                              const struct pipe_compute_state *templ)
+{
+   struct lp_compute_shader *shader;
+
+   if (templ->ir_type != PIPE_SHADER_IR_TGSI)
+      return NULL;
+
+   shader = CALLOC_STRUCT(lp_compute_shader);
+   if (!shader)
+      return NULL;
+
+   shader->base = *templ;
+   shader->no = cs_no++;
+
+   shader->tokens = tgsi_dup_tokens(templ->prog);
+   if (!shader->tokens) {
+      FREE(shader);
+      return NULL;
+   }
+   shader->base.prog = shader->tokens;
+
+   tgsi_scan_shader(shader->tokens, &shader->info);
+
+   shader->num_phases = shader->info.opcode_count[TGSI_OPCODE_BARRIER] + 1;
+   if (shader->num_phases > 1) {
+      shader->temps_size = lp_build_tgsi_soa_temps_size(&shader->info,
+                                                        cs_vector_type());
+      shader->unsupported = has_barrier_in_control_flow(shader->tokens);
+   }
+
+   if (LP_DEBUG & DEBUG_TGSI) {
+      debug_printf("llvmpipe: Create compute shader %u %p:\n",
+                   shader->no, (void *) shader);
+      tgsi_dump(shader->tokens, 0);
+   }
+
+   return shader;
+}
+
+
+static void
+llvmpipe_bind_compute_state(struct pipe_context *pipe, void *cs)
+{
+   struct llvmpipe_context *llvmpipe = llvmpipe_context(pipe);
+
+   llvmpipe->cs = (struct lp_compute_shader *) cs;
+}
+
+
+static void
+llvmpipe_delete_compute_state(struct pipe_context *pipe, void *cs)
+{
+   struct lp_compute_shader *shader = (struct lp_compute_shader *) cs;
+   struct lp_compute_shader_variant *variant, *next;
+
+   if (!shader)
+      return;
+
+   /* launch_grid is synchronous, so nothing can be using the variants */
+   for (variant = shader->variants; variant; variant = next) {
+      next = variant->next;
+      destroy_variant(variant);
+   }
+
+   tgsi_free_tokens(shader->tokens);
+   FREE(shader);
+}
+
+
+static void
+llvmpipe_set_shader_buffers(struct pipe_context *pipe,
+                            enum pipe_shader_type shader,
+                            unsigned start_slot, unsigned count,
+                            const struct pipe_shader_buffer *buffers)
+{
+   struct llvmpipe_context *llvmpipe = llvmpipe_context(pipe);
+   unsigned i;
+
+   assert(shader < PIPE_SHADER_TYPES);
+   assert(start_slot + count <= LP_MAX_TGSI_SHADER_BUFFERS);
+
+   for (i = 0; i < count; i++) {
+      struct pipe_shader_buffer *dst = &llvmpipe->ssbos[shader][start_slot + i];
+
+      if (buffers) {
+         pipe_resource_reference(&dst->buffer, buffers[i].buffer);
+         dst->buffer_offset = buffers[i].buffer_offset;
+         dst->buffer_size = buffers[i].buffer_size;
+      }
+      else {
+         pipe_resource_reference(&dst->buffer, NULL);
+         dst->buffer_offset = 0;
+         dst->buffer_size = 0;
+      }
+   }
+}
+
+
+/**
+ * Fill in the jit context from the compute state of the context.
+ */
+static void
+update_jit_context(struct llvmpipe_context *lp,
+                   struct lp_jit_context *jit_context)
+{
+   unsigned i;
+
+   for (i = 0; i < LP_MAX_TGSI_CONST_BUFFERS; i++) {
+      const struct pipe_constant_buffer *cb =
+         &lp->constants[PIPE_SHADER_COMPUTE][i];
+      const ubyte *data = NULL;
+
+      if (cb->buffer)
+         data = (const ubyte *) llvmpipe_resource_data(cb->buffer);
+      else if (cb->user_buffer)
+         data = (const ubyte *) cb->user_buffer;
+
+      if (data) {
+         jit_context->constants[i] =
+            (const float *) (data + cb->buffer_offset);
+         jit_context->num_constants[i] =
+            cb->buffer_size / (sizeof(float) * 4);
+      }
+      else {
+         jit_context->constants[i] = fake_const_buf;
+         jit_context->num_constants[i] = 0;
+      }
+   }
+
+   for (i = 0; i < lp->num_sampler_views[PIPE_SHADER_COMPUTE]; i++) {
+      const struct pipe_sampler_view *view =
+         lp->sampler_views[PIPE_SHADER_COMPUTE][i];
+
+      if (view)
+         lp_jit_texture_from_pipe(&jit_context->textures[i], view);
+   }
+
+   for (i = 0; i < lp->num_samplers[PIPE_SHADER_COMPUTE]; i++) {
+      const struct pipe_sampler_state *sampler =
+         lp->samplers[PIPE_SHADER_COMPUTE][i];
+
+      if (sampler) {
+         struct lp_jit_sampler *jit_sam = &jit_context->samplers[i];
+         jit_sam->min_lod = sampler->min_lod;
+         jit_sam->max_lod = sampler->max_lod;
+         jit_sam->lod_bias = sampler->lod_bias;
+         COPY_4V(jit_sam->border_color, sampler->border_color.f);
+      }
+   }
+
+   for (i = 0; i < LP_MAX_TGSI_SHADER_BUFFERS; i++) {
+      const struct pipe_shader_buffer *sb = &lp->ssbos[PIPE_SHADER_COMPUTE][i];
+
+      if (sb->buffer) {
+         const ubyte *data = (const ubyte *) llvmpipe_resource_data(sb->buffer);
+         jit_context->ssbos[i] = (const uint32_t *) (data + sb->buffer_offset);
+         jit_context->ssbo_sizes[i] = sb->buffer_size;
+      }
+      else {
+         /* loads from unbound buffers still need something to point at */
+         jit_context->ssbos[i] = fake_ssbo_buf;
+         jit_context->ssbo_sizes[i] = 0;
+      }
+   }
+}
+
+
+static unsigned
+cs_shared_mem_size(const struct lp_cs_job *job)
+{
+   return align(MAX2(job->shared_size, 64), 64);
+}
+
+
+static void
+cs_job_destroy(struct lp_cs_job *job)
+{
+   unsigned i;
+
+   for (i = 0; i < ARRAY_SIZE(job->thread_mem); i++)
+      align_free(job->thread_mem[i]);
+   FREE(job);
+}
+
+
+/**
+ * Run work groups until there are none left.  Called on each rasterizer
+ * thread.
+ */
+static void
+cs_run_job(void *data,
+           struct lp_jit_thread_data *thread_data,
+           unsigned thread_index)
+{
+   struct lp_cs_job *job = (struct lp_cs_job *) data;
+   uint8_t *mem = job->thread_mem[thread_index];
+   uint8_t *temps = mem + cs_shared_mem_size(job);
+   int64_t block;
+
+   while ((block = p_atomic_inc_return(&job->next_block) - 1) <
+          (int64_t) job->num_blocks) {
+      uint32_t block_id[3];
+      unsigned phase, chunk;
+
+      block_id[0] = block % job->grid_size[0];
+      block_id[1] = (block / job->grid_size[0]) % job->grid_size[1];
+      block_id[2] = block / job->grid_size[0] / job->grid_size[1];
+
+      for (phase = 0; phase < job->num_phases; phase++) {
+         for (chunk = 0; chunk < job->num_chunks; chunk++) {
+            job->jit_function(&job->jit_context,
+                              thread_data,
+                              block_id,
+                              job->grid_size,
+                              job->block_size,
+                              chunk * job->chunk_length,
+                              phase,
+                              mem,
+                              temps + chunk * job->temps_size);
+         }
+      }
+   }
+}
+
+
+static void
+fill_grid_size(struct pipe_context *pipe,
+               const struct pipe_grid_info *info,
+               uint32_t grid_size[3])
+{
+   struct pipe_transfer *transfer;
+   uint32_t *params;
+
+   if (!info->indirect) {
+      grid_size[0] = info->grid[0];
+      grid_size[1] = info->grid[1];
+      grid_size[2] = info->grid[2];
+      return;
+   }
+
+   params = pipe_buffer_map_range(pipe, info->indirect,
+                                  info->indirect_offset,
+                                  3 * sizeof(uint32_t),
+                                  PIPE_TRANSFER_READ,
+                                  &transfer);
+   if (!transfer) {
+      grid_size[0] = grid_size[1] = grid_size[2] = 0;
+      return;
+   }
+
+   grid_size[0] = params[0];
+   grid_size[1] = params[1];
+   grid_size[2] = params[2];
+   pipe_buffer_unmap(pipe, transfer);
+}
+
+
+static void
+llvmpipe_launch_grid(struct pipe_context *pipe,
+                     const struct pipe_grid_info *info)
+{
+   struct llvmpipe_context *lp = llvmpipe_context(pipe);
+   struct llvmpipe_screen *screen = llvmpipe_screen(pipe->screen);
+   struct lp_compute_shader *shader = lp->cs;
+   struct lp_compute_shader_variant *variant;
+   struct lp_fence *fence = NULL;
+   struct lp_cs_job *job;
+   unsigned num_invocations, mem_size, i;
+
+   if (!shader)
+      return;
+
+   job = CALLOC_STRUCT(lp_cs_job);
+   if (!job)
+      return;
+
+   fill_grid_size(pipe, info, job->grid_size);
+   job->block_size[0] = info->block[0];
+   job->block_size[1] = info->block[1];
+   job->block_size[2] = info->block[2];
+
+   job->num_blocks = (uint64_t) job->grid_size[0] * job->grid_size[1] *
+                     job->grid_size[2];
+   num_invocations = info->block[0] * info->block[1] * info->block[2];
+   if (!job->num_blocks || !num_invocations) {
+      FREE(job);
+      return;
+   }
+
+   variant = get_variant(lp, shader);
+   if (!variant) {
+      FREE(job);
+      return;
+   }
+
+   job->jit_function = variant->jit_function;
+   job->num_phases = shader->num_phases;
+   job->chunk_length = cs_vector_type().length;
+   job->num_chunks = DIV_ROUND_UP(num_invocations, job->chunk_length);
+   job->shared_size = shader->base.req_local_mem;
+   job->temps_size = shader->temps_size;
+
+   /* Allocate up front, so that no thread can drop work groups for lack
+    * of memory once the grid is running.
+    */
+   mem_size = cs_shared_mem_size(job) + job->num_chunks * job->temps_size;
+   for (i = 0; i < MAX2(1, screen->num_threads); i++) {
+      job->thread_mem[i] = align_malloc(mem_size, 64);
+      if (!job->thread_mem[i]) {
+         debug_printf("llvmpipe: out of memory launching compute grid "
+                      "(%u bytes per thread), grid skipped\n", mem_size);
+         cs_job_destroy(job);
+         return;
+      }
+   }
+
+   /* Compute shaders see the results of everything drawn before them */
+   llvmpipe_finish(pipe, __FUNCTION__);
+
+   update_jit_context(lp, &job->jit_context);
+
+   /* The rasterizer threads are shared by all the contexts: keep others
+    * from queueing scenes, and let the ones already queued finish.
+    */
+   mtx_lock(&screen->rast_mutex);
+   lp_fence_reference(&fence, screen->last_fence);
+   if (fence) {
+      lp_fence_wait(fence);
+      lp_fence_reference(&fence, NULL);
+   }
+
+   lp_rast_run_job(screen->rast, cs_run_job, job);
+   mtx_unlock(&screen->rast_mutex);
+
+   cs_job_destroy(job);
+}
+
+
+static void
+llvmpipe_memory_barrier(struct pipe_context *pipe, unsigned flags)
+{
+   /*
+    * Nothing to do: grids are run to completion by launch_grid, and
+    * draws don't write to shader buffers.
+    */
+}
+
+
+void
+llvmpipe_init_compute_funcs(struct llvmpipe_context *llvmpipe)
+{
+   llvmpipe->pipe.create_compute_state = llvmpipe_create_compute_state;
+   llvmpipe->pipe.bind_compute_state = llvmpipe_bind_compute_state;
+   llvmpipe->pipe.delete_compute_state = llvmpipe_delete_compute_state;
+   llvmpipe->pipe.set_shader_buffers = llvmpipe_set_shader_buffers;
+   llvmpipe->pipe.launch_grid = llvmpipe_launch_grid;
+   llvmpipe->pipe.memory_barrier = llvmpipe_memory_barrier;
+}
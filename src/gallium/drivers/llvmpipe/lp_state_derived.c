@@ -208,6 +208,8 @@ void llvmpipe_update_derived( struct llvmpipe_context *llvmpipe )
                           LP_NEW_SAMPLER_VIEW |
                           LP_NEW_OCCLUSION_QUERY))
       llvmpipe_update_fs( llvmpipe );
+   else if (llvmpipe->nr_fs_variants_pending)
+      llvmpipe_swap_fs_variants( llvmpipe );
 
    if (llvmpipe->dirty & (LP_NEW_RASTERIZER)) {
       boolean discard =
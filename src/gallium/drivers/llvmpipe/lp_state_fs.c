@@ -58,6 +58,7 @@
  */
 
 #include <limits.h>
+#include <inttypes.h>  /* for PRIu64 macro */
 #include "pipe/p_defines.h"
 #include "util/u_inlines.h"
 #include "util/u_memory.h"
@@ -68,16 +69,25 @@
 #include "util/simple_list.h"
 #include "util/u_dual_blend.h"
 #include "util/os_time.h"
+#include "util/mesa-sha1.h"
+#include "util/u_queue.h"
+#include "util/ralloc.h"
+#include "compiler/blob.h"
+#include "compiler/nir/nir.h"
+#include "compiler/nir/nir_serialize.h"
 #include "pipe/p_shader_tokens.h"
 #include "draw/draw_context.h"
 #include "tgsi/tgsi_dump.h"
 #include "tgsi/tgsi_scan.h"
 #include "tgsi/tgsi_parse.h"
+#include "nir/tgsi_to_nir.h"
 #include "gallivm/lp_bld_type.h"
 #include "gallivm/lp_bld_const.h"
 #include "gallivm/lp_bld_conv.h"
 #include "gallivm/lp_bld_init.h"
+#include "gallivm/lp_bld_misc.h"
 #include "gallivm/lp_bld_intr.h"
+#include "gallivm/lp_bld_nir.h"
 #include "gallivm/lp_bld_logic.h"
 #include "gallivm/lp_bld_tgsi.h"
 #include "gallivm/lp_bld_swizzle.h"
@@ -102,6 +112,7 @@
 #include "lp_flush.h"
 #include "lp_state_fs.h"
 #include "lp_rast.h"
+#include "lp_screen.h"
 
 
 /** Fragment shader number (for debugging) */
@@ -475,11 +486,18 @@ generate_fs_loop(struct gallivm_state *gallivm,
    lp_build_interp_soa_update_inputs_dyn(interp, gallivm, loop_state.counter);
 
    /* Build the actual shader */
-   lp_build_tgsi_soa(gallivm, tokens, type, &mask,
-                     consts_ptr, num_consts_ptr, &system_values,
-                     interp->inputs,
-                     outputs, context_ptr, thread_data_ptr,
-                     sampler, &shader->info.base, NULL);
+   if (shader->base.ir.nir)
+      lp_build_nir_soa(gallivm, shader->base.ir.nir, type, &mask,
+                       consts_ptr, num_consts_ptr, &system_values,
+                       interp->inputs,
+                       outputs, context_ptr, thread_data_ptr,
+                       sampler, &shader->info.base);
+   else
+      lp_build_tgsi_soa(gallivm, tokens, type, &mask,
+                        consts_ptr, num_consts_ptr, &system_values,
+                        interp->inputs,
+                        outputs, context_ptr, thread_data_ptr,
+                        sampler, &shader->info.base, NULL, NULL, NULL);
 
    /* Alpha test */
    if (key->alpha.enabled) {
@@ -1704,6 +1722,60 @@ convert_alpha(struct gallivm_state *gallivm,
 }
 
 
+/**
+ * The blend and color buffer conversion code only handles 4 and 8 wide
+ * vectors, so split 16 wide (AVX-512) shader outputs and masks in halves.
+ * \return the new number of fs vectors
+ */
+static unsigned
+split_fs_outputs(struct gallivm_state *gallivm,
+                 const struct lp_fragment_shader_variant_key *key,
+                 boolean dual_source_blend,
+                 struct lp_type *fs_type,
+                 LLVMValueRef fs_mask[16 / 4],
+                 LLVMValueRef fs_out_color[PIPE_MAX_COLOR_BUFS][TGSI_NUM_CHANNELS][16 / 4])
+{
+   LLVMBuilderRef builder = gallivm->builder;
+   LLVMValueRef two = lp_build_const_int32(gallivm, 2);
+   struct lp_type half_type = *fs_type;
+   LLVMTypeRef half_vec_type;
+   unsigned nr_outputs = MAX2(key->nr_cbufs, dual_source_blend ? 2 : 0);
+   unsigned cbuf, chan, i;
+   LLVMValueRef mask;
+
+   assert(fs_type->length == 16);
+   half_type.length = 8;
+   half_vec_type = lp_build_vec_type(gallivm, half_type);
+
+   for (cbuf = 0; cbuf < nr_outputs; cbuf++) {
+      for (chan = 0; chan < TGSI_NUM_CHANNELS; chan++) {
+         LLVMValueRef color = LLVMBuildLoad(builder,
+                                            fs_out_color[cbuf][chan][0], "");
+         LLVMValueRef store = lp_build_array_alloca(gallivm, half_vec_type,
+                                                    two, "color_half");
+
+         for (i = 0; i < 2; i++) {
+            LLVMValueRef index = lp_build_const_int32(gallivm, i);
+            LLVMValueRef ptr = LLVMBuildGEP(builder, store, &index, 1, "");
+            LLVMBuildStore(builder,
+                           lp_build_extract_range(gallivm, color, i * 8, 8),
+                           ptr);
+            fs_out_color[cbuf][chan][i] = ptr;
+         }
+      }
+   }
+
+   mask = fs_mask[0];
+   fs_mask[0] = lp_build_extract_range(gallivm, mask, 0, 8);
+   fs_mask[1] = lp_build_extract_range(gallivm, mask, 8, 8);
+
+   *fs_type = half_type;
+
+   /* 1d resources only use the upper half, as with 8 wide vectors */
+   return key->resource_1d ? 1 : 2;
+}
+
+
 /**
  * Generates the blend function for unswizzled colour buffers
  * Also generates the read & write from colour buffer
@@ -1819,7 +1891,8 @@ generate_unswizzled_blend(struct gallivm_state *gallivm,
    undef_src_val = lp_build_undef(gallivm, fs_type);
 
    row_type.length = fs_type.length;
-   vector_width    = dst_type.floating ? lp_native_vector_width : lp_integer_vector_width;
+   vector_width    = dst_type.floating ? MIN2(lp_native_vector_width, 256) :
+                                         lp_integer_vector_width;
 
    /* Compute correct swizzle and count channels */
    memset(swizzle, LP_BLD_SWIZZLE_DONTCARE, TGSI_NUM_CHANNELS);
@@ -2397,8 +2470,7 @@ generate_unswizzled_blend(struct gallivm_state *gallivm,
  * 2x2 pixels.
  */
 static void
-generate_fragment(struct llvmpipe_context *lp,
-                  struct lp_fragment_shader *shader,
+generate_fragment(struct lp_fragment_shader *shader,
                   struct lp_fragment_shader_variant *variant,
                   unsigned partial_mask)
 {
@@ -2486,8 +2558,12 @@ generate_fragment(struct llvmpipe_context *lp,
 
    blend_vec_type = lp_build_vec_type(gallivm, blend_type);
 
-   util_snprintf(func_name, sizeof(func_name), "fs%u_variant%u_%s",
-                 shader->no, variant->no, partial_mask ? "partial" : "whole");
+   /* The name must not depend on the shader/variant numbers, as these
+    * differ between processes and the code may come from the disk cache.
+    * The module name identifies the variant.
+    */
+   util_snprintf(func_name, sizeof(func_name), "fs_variant_%s",
+                 partial_mask ? "partial" : "whole");
 
    arg_types[0] = variant->jit_context_ptr_type;       /* context */
    arg_types[1] = int32_type;                          /* x */
@@ -2559,7 +2635,7 @@ generate_fragment(struct llvmpipe_context *lp,
 
    num_fs = 16 / fs_type.length; /* number of loops per 4x4 stamp */
    /* for 1d resources only run "upper half" of stamp */
-   if (key->resource_1d)
+   if (key->resource_1d && num_fs > 1)
       num_fs /= 2;
 
    {
@@ -2599,6 +2675,16 @@ generate_fragment(struct llvmpipe_context *lp,
          else {
             mask = lp_build_const_int_vec(gallivm, fs_type, ~0);
          }
+         if (key->resource_1d && fs_type.length == 16) {
+            /* only the upper half of the stamp, like the narrower paths */
+            LLVMValueRef upper[16];
+            unsigned j;
+            for (j = 0; j < 16; j++) {
+               upper[j] = lp_build_const_int32(gallivm, j < 8 ? ~0 : 0);
+            }
+            mask = LLVMBuildAnd(builder, mask,
+                                LLVMConstVector(upper, 16), "");
+         }
          LLVMBuildStore(builder, mask, mask_ptr);
       }
 
@@ -2645,6 +2731,11 @@ generate_fragment(struct llvmpipe_context *lp,
 
    sampler->destroy(sampler);
 
+   if (fs_type.length == 16) {
+      num_fs = split_fs_outputs(gallivm, key, dual_source_blend,
+                                &fs_type, fs_mask, fs_out_color);
+   }
+
    /* Loop over color outputs / color buffers to do blending.
     */
    for(cbuf = 0; cbuf < key->nr_cbufs; cbuf++) {
@@ -2772,6 +2863,8 @@ dump_fs_variant_key(const struct lp_fragment_shader_variant_key *key)
                    texture->pot_width,
                    texture->pot_height,
                    texture->pot_depth);
+      debug_printf("  .tiled = %u\n",
+                   texture->tiled);
    }
 }
 
@@ -2781,13 +2874,294 @@ lp_debug_fs_variant(const struct lp_fragment_shader_variant *variant)
 {
    debug_printf("llvmpipe: Fragment shader #%u variant #%u:\n", 
                 variant->shader->no, variant->no);
-   tgsi_dump(variant->shader->base.tokens, 0);
+   if (variant->shader->base.tokens)
+      tgsi_dump(variant->shader->base.tokens, 0);
+   if (variant->shader->base.ir.nir)
+      nir_print_shader(variant->shader->base.ir.nir, stderr);
    dump_fs_variant_key(&variant->key);
    debug_printf("variant->opaque = %u\n", variant->opaque);
    debug_printf("\n");
 }
 
 
+/**
+ * Compute the disk cache key of a fragment shader variant: everything the
+ * generated code depends on is in the shader IR and the variant key.
+ */
+static void
+lp_fs_get_ir_cache_key(const struct lp_fragment_shader *shader,
+                       const struct lp_fragment_shader_variant_key *key,
+                       unsigned char ir_sha1_cache_key[20])
+{
+   struct mesa_sha1 ctx;
+
+   _mesa_sha1_init(&ctx);
+   _mesa_sha1_update(&ctx, "fs", 2);
+   if (shader->base.tokens)
+      _mesa_sha1_update(&ctx, shader->base.tokens,
+                        tgsi_num_tokens(shader->base.tokens) *
+                        sizeof(struct tgsi_token));
+   if (shader->base.ir.nir)
+      _mesa_sha1_update(&ctx, shader->nir_sha1, sizeof(shader->nir_sha1));
+   _mesa_sha1_update(&ctx, key, shader->variant_key_size);
+   _mesa_sha1_final(&ctx, ir_sha1_cache_key);
+}
+
+
+/**
+ * Build and compile the code of a fragment shader variant, whose key and
+ * derived fields have already been filled in.
+ *
+ * If fast is set and the code isn't found in the disk cache, it is
+ * compiled without optimizations, and gallivm->no_opt is left set so that
+ * the caller can tell.
+ * \return  TRUE for success, FALSE for failure
+ */
+static boolean
+compile_variant(struct llvmpipe_screen *screen,
+                struct lp_fragment_shader_variant *variant,
+                LLVMContextRef context,
+                boolean fast)
+{
+   struct lp_fragment_shader *shader = variant->shader;
+   char module_name[64];
+   unsigned char ir_sha1_cache_key[20];
+   struct lp_cached_code cached = { 0 };
+   boolean needs_caching = FALSE;
+   boolean no_opt;
+   int64_t t0 = os_time_get();
+
+   util_snprintf(module_name, sizeof(module_name), "fs%u_variant%u",
+                 shader->no, variant->no);
+
+   if (screen->disk_shader_cache) {
+      lp_fs_get_ir_cache_key(shader, &variant->key, ir_sha1_cache_key);
+      lp_disk_cache_find_shader(screen, &cached, ir_sha1_cache_key);
+      needs_caching = !cached.data_size;
+   }
+
+   /* Unoptimized code must not end up in the disk cache */
+   no_opt = fast && !cached.data_size;
+
+   variant->gallivm = gallivm_create(module_name, context,
+                                     no_opt ? NULL : &cached);
+   if (!variant->gallivm) {
+      free(cached.data);
+      return FALSE;
+   }
+
+   variant->gallivm->no_opt = no_opt;
+
+   lp_jit_init_types(variant);
+   
+   if (variant->jit_function[RAST_EDGE_TEST] == NULL)
+      generate_fragment(shader, variant, RAST_EDGE_TEST);
+
+   if (variant->jit_function[RAST_WHOLE] == NULL) {
+      if (variant->opaque) {
+         /* Specialized shader, which doesn't need to read the color buffer. */
+         generate_fragment(shader, variant, RAST_WHOLE);
+      }
+   }
+
+   /*
+    * Compile everything
+    */
+
+   gallivm_compile_module(variant->gallivm);
+
+   variant->nr_instrs += lp_build_count_ir_module(variant->gallivm->module);
+
+   if (variant->function[RAST_EDGE_TEST]) {
+      variant->jit_function[RAST_EDGE_TEST] = (lp_jit_frag_func)
+            gallivm_jit_function(variant->gallivm,
+                                 variant->function[RAST_EDGE_TEST]);
+   }
+
+   if (variant->function[RAST_WHOLE]) {
+         variant->jit_function[RAST_WHOLE] = (lp_jit_frag_func)
+               gallivm_jit_function(variant->gallivm,
+                                    variant->function[RAST_WHOLE]);
+   } else if (!variant->jit_function[RAST_WHOLE]) {
+      variant->jit_function[RAST_WHOLE] = variant->jit_function[RAST_EDGE_TEST];
+   }
+
+   variant->code_size = lp_get_generated_code_size(variant->gallivm->code);
+
+   gallivm_free_ir(variant->gallivm);
+
+   if (needs_caching && !no_opt) {
+      lp_disk_cache_insert_shader(screen, &cached, ir_sha1_cache_key);
+   }
+   free(cached.data);
+
+   variant->compile_time = os_time_get() - t0;
+
+   return TRUE;
+}
+
+
+/**
+ * Optimized code of a fragment shader variant, compiled by one of the
+ * screen's compiler threads (see LP_ASYNC_COMPILE).
+ *
+ * Until it is ready the variant runs its unoptimized code.  The optimized
+ * code is built into a private copy of the variant, with its own LLVM
+ * context as those aren't thread safe, and is then swapped into the
+ * original one by llvmpipe_swap_fs_variants().
+ */
+struct lp_fs_async_variant
+{
+   struct util_queue_fence ready;
+   struct llvmpipe_screen *screen;
+   LLVMContextRef context;
+   struct lp_fragment_shader_variant opt;
+   boolean compiled;
+   boolean pending;
+};
+
+
+static void
+compile_async_variant(void *data, int thread_index)
+{
+   struct lp_fs_async_variant *async = (struct lp_fs_async_variant *) data;
+
+   async->context = LLVMContextCreate();
+   if (!async->context)
+      return;
+
+   async->compiled = compile_variant(async->screen, &async->opt,
+                                     async->context, FALSE);
+}
+
+
+/**
+ * Queue the compilation of the optimized code of a variant which was
+ * compiled without optimizations.
+ */
+static void
+queue_async_variant(struct llvmpipe_context *lp,
+                    struct lp_fragment_shader_variant *variant)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
+   struct lp_fs_async_variant *async;
+
+   async = CALLOC_STRUCT(lp_fs_async_variant);
+   if (!async)
+      return;   /* keep running the unoptimized code */
+
+   async->screen = screen;
+   memcpy(&async->opt.key, &variant->key, variant->shader->variant_key_size);
+   async->opt.opaque = variant->opaque;
+   async->opt.ps_inv_multiplier = variant->ps_inv_multiplier;
+   async->opt.shader = variant->shader;
+   async->opt.no = variant->no;
+   async->pending = TRUE;
+   util_queue_fence_init(&async->ready);
+
+   variant->async = async;
+   lp->nr_fs_variants_pending++;
+
+   util_queue_add_job(&screen->compile_queue, async, &async->ready,
+                      compile_async_variant, NULL);
+}
+
+
+/**
+ * Switch a variant over to its optimized code, once that is ready.
+ */
+static void
+swap_async_variant(struct llvmpipe_context *lp,
+                   struct lp_fragment_shader_variant *variant)
+{
+   struct lp_fs_async_variant *async = variant->async;
+
+   if (!async || !async->pending ||
+       !util_queue_fence_is_signalled(&async->ready))
+      return;
+
+   if (async->compiled) {
+      struct gallivm_state *gallivm = variant->gallivm;
+
+      /* Scenes in flight may still be running the unoptimized code, so it
+       * is only freed along with the variant.  The rasterizer fetches the
+       * function pointers from the variant, so binned scenes pick up the
+       * new code too.
+       */
+      variant->gallivm = async->opt.gallivm;
+      async->opt.gallivm = gallivm;
+
+      variant->jit_function[RAST_EDGE_TEST] =
+         async->opt.jit_function[RAST_EDGE_TEST];
+      variant->jit_function[RAST_WHOLE] =
+         async->opt.jit_function[RAST_WHOLE];
+
+      lp->nr_fs_instrs -= variant->nr_instrs;
+      variant->nr_instrs = async->opt.nr_instrs;
+      lp->nr_fs_instrs += variant->nr_instrs;
+
+      /* Both versions of the code are kept, see above */
+      variant->code_size += async->opt.code_size;
+      variant->compile_time += async->opt.compile_time;
+      lp->fs_code_size += async->opt.code_size;
+   }
+
+   async->pending = FALSE;
+   lp->nr_fs_variants_pending--;
+}
+
+
+/**
+ * Cancel or wait for the background compilation of a variant being
+ * destroyed, and free what it holds.
+ */
+static void
+destroy_async_variant(struct llvmpipe_context *lp,
+                      struct lp_fragment_shader_variant *variant)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
+   struct lp_fs_async_variant *async = variant->async;
+
+   util_queue_drop_job(&screen->compile_queue, &async->ready);
+
+   if (async->pending)
+      lp->nr_fs_variants_pending--;
+
+   if (async->opt.gallivm)
+      gallivm_destroy(async->opt.gallivm);
+
+   /* The variant's own code may come from this context, if it was swapped */
+   if (variant->gallivm) {
+      gallivm_destroy(variant->gallivm);
+      variant->gallivm = NULL;
+   }
+
+   if (async->context)
+      LLVMContextDispose(async->context);
+
+   util_queue_fence_destroy(&async->ready);
+   FREE(async);
+   variant->async = NULL;
+}
+
+
+/**
+ * Swap in the optimized code of the variants whose background compilation
+ * has finished.
+ */
+void
+llvmpipe_swap_fs_variants(struct llvmpipe_context *lp)
+{
+   struct lp_fs_variant_list_item *li;
+
+   li = first_elem(&lp->fs_variants_list);
+   while (!at_end(&lp->fs_variants_list, li) && lp->nr_fs_variants_pending) {
+      swap_async_variant(lp, li->base);
+      li = next_elem(li);
+   }
+}
+
+
 /**
  * Generate a new fragment shader variant from the shader code and
  * other state indicated by the key.
@@ -2797,24 +3171,16 @@ generate_variant(struct llvmpipe_context *lp,
                  struct lp_fragment_shader *shader,
                  const struct lp_fragment_shader_variant_key *key)
 {
+   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
    struct lp_fragment_shader_variant *variant;
    const struct util_format_description *cbuf0_format_desc = NULL;
    boolean fullcolormask;
-   char module_name[64];
+   boolean async = util_queue_is_initialized(&screen->compile_queue);
 
    variant = CALLOC_STRUCT(lp_fragment_shader_variant);
    if (!variant)
       return NULL;
 
-   util_snprintf(module_name, sizeof(module_name), "fs%u_variant%u",
-                 shader->no, shader->variants_created);
-
-   variant->gallivm = gallivm_create(module_name, lp->context);
-   if (!variant->gallivm) {
-      FREE(variant);
-      return NULL;
-   }
-
    variant->shader = shader;
    variant->list_item_global.base = variant;
    variant->list_item_local.base = variant;
@@ -2850,47 +3216,92 @@ generate_variant(struct llvmpipe_context *lp,
       variant->ps_inv_multiplier = 1;
    }
 
+   lp_linear_check_variant(variant);
+
    if ((LP_DEBUG & DEBUG_FS) || (gallivm_debug & GALLIVM_DEBUG_IR)) {
       lp_debug_fs_variant(variant);
    }
 
-   lp_jit_init_types(variant);
-   
-   if (variant->jit_function[RAST_EDGE_TEST] == NULL)
-      generate_fragment(lp, shader, variant, RAST_EDGE_TEST);
+   if (!compile_variant(screen, variant, lp->context, async)) {
+      FREE(variant);
+      return NULL;
+   }
 
-   if (variant->jit_function[RAST_WHOLE] == NULL) {
-      if (variant->opaque) {
-         /* Specialized shader, which doesn't need to read the color buffer. */
-         generate_fragment(lp, shader, variant, RAST_WHOLE);
-      }
+   if (variant->gallivm->no_opt) {
+      queue_async_variant(lp, variant);
    }
 
-   /*
-    * Compile everything
-    */
+   return variant;
+}
 
-   gallivm_compile_module(variant->gallivm);
 
-   variant->nr_instrs += lp_build_count_ir_module(variant->gallivm->module);
+/**
+ * Whether a TGSI shader only uses features that both tgsi_to_nir and the
+ * NIR translator handle, so that LP_DEBUG=nir can route it through NIR.
+ */
+static boolean
+fs_tgsi_to_nir_supported(const struct lp_tgsi_info *info)
+{
+   static const unsigned opcodes[] = {
+      TGSI_OPCODE_MOV, TGSI_OPCODE_MAD, TGSI_OPCODE_MUL, TGSI_OPCODE_ADD,
+      TGSI_OPCODE_DP2, TGSI_OPCODE_DP3, TGSI_OPCODE_DP4, TGSI_OPCODE_MIN,
+      TGSI_OPCODE_MAX, TGSI_OPCODE_SLT, TGSI_OPCODE_SGE, TGSI_OPCODE_SEQ,
+      TGSI_OPCODE_SNE, TGSI_OPCODE_RCP, TGSI_OPCODE_RSQ, TGSI_OPCODE_EX2,
+      TGSI_OPCODE_LG2, TGSI_OPCODE_POW, TGSI_OPCODE_FRC, TGSI_OPCODE_FLR,
+      TGSI_OPCODE_ROUND, TGSI_OPCODE_TRUNC, TGSI_OPCODE_CEIL,
+      TGSI_OPCODE_SSG, TGSI_OPCODE_CMP, TGSI_OPCODE_LRP, TGSI_OPCODE_SIN,
+      TGSI_OPCODE_COS, TGSI_OPCODE_DDX, TGSI_OPCODE_DDY, TGSI_OPCODE_TEX,
+      TGSI_OPCODE_TXB, TGSI_OPCODE_TXL, TGSI_OPCODE_TXP, TGSI_OPCODE_KILL,
+      TGSI_OPCODE_KILL_IF, TGSI_OPCODE_IF, TGSI_OPCODE_UIF,
+      TGSI_OPCODE_ELSE, TGSI_OPCODE_ENDIF, TGSI_OPCODE_BGNLOOP,
+      TGSI_OPCODE_ENDLOOP, TGSI_OPCODE_BRK, TGSI_OPCODE_CONT,
+      TGSI_OPCODE_END,
+   };
+   const struct tgsi_shader_info *base = &info->base;
+   unsigned num_supported = 0;
+   unsigned i;
 
-   if (variant->function[RAST_EDGE_TEST]) {
-      variant->jit_function[RAST_EDGE_TEST] = (lp_jit_frag_func)
-            gallivm_jit_function(variant->gallivm,
-                                 variant->function[RAST_EDGE_TEST]);
-   }
+   if (base->num_system_values ||
+       base->writes_stencil ||
+       base->writes_samplemask ||
+       base->uses_doubles)
+      return FALSE;
 
-   if (variant->function[RAST_WHOLE]) {
-         variant->jit_function[RAST_WHOLE] = (lp_jit_frag_func)
-               gallivm_jit_function(variant->gallivm,
-                                    variant->function[RAST_WHOLE]);
-   } else if (!variant->jit_function[RAST_WHOLE]) {
-      variant->jit_function[RAST_WHOLE] = variant->jit_function[RAST_EDGE_TEST];
+   for (i = 0; i < base->num_outputs; i++) {
+      if (base->output_semantic_name[i] != TGSI_SEMANTIC_COLOR &&
+          base->output_semantic_name[i] != TGSI_SEMANTIC_POSITION)
+         return FALSE;
    }
 
-   gallivm_free_ir(variant->gallivm);
+   for (i = 0; i < ARRAY_SIZE(opcodes); i++)
+      num_supported += base->opcode_count[opcodes[i]];
 
-   return variant;
+   return num_supported == base->num_instructions;
+}
+
+
+/**
+ * Prepare a NIR shader for translation and make it the code source of the
+ * fragment shader, which takes ownership of it.  Fails, leaving the shader
+ * alone, if the NIR translator can't handle it.
+ */
+static boolean
+fs_attach_nir(struct lp_fragment_shader *shader, struct nir_shader *nir)
+{
+   struct blob blob;
+
+   lp_build_nir_prepare(nir);
+   if (!lp_build_nir_supported(nir))
+      return FALSE;
+
+   blob_init(&blob);
+   nir_serialize(&blob, nir);
+   _mesa_sha1_compute(blob.data, blob.size, shader->nir_sha1);
+   blob_finish(&blob);
+
+   shader->base.type = PIPE_SHADER_IR_NIR;
+   shader->base.ir.nir = nir;
+   return TRUE;
 }
 
 
@@ -2911,14 +3322,43 @@ llvmpipe_create_fs_state(struct pipe_context *pipe,
    shader->no = fs_no++;
    make_empty_list(&shader->variants);
 
-   /* get/save the summary info for this shader */
-   lp_build_tgsi_info(templ->tokens, &shader->info);
+   if (templ->type == PIPE_SHADER_IR_NIR) {
+      if (!fs_attach_nir(shader, templ->ir.nir)) {
+         debug_printf("llvmpipe: NIR fragment shader with 64-bit or 16-bit "
+                      "types is not supported\n");
+         ralloc_free(templ->ir.nir);
+         FREE(shader);
+         return NULL;
+      }
+
+      /* get/save the summary info for this shader */
+      lp_build_nir_info(shader->base.ir.nir, &shader->info);
+
+      shader->draw_data = draw_create_fragment_shader_info(llvmpipe->draw,
+                                                           &shader->base,
+                                                           &shader->info.base);
+   }
+   else {
+      /* get/save the summary info for this shader */
+      lp_build_tgsi_info(templ->tokens, &shader->info);
+
+      /* we need to keep a local copy of the tokens */
+      shader->base.tokens = tgsi_dup_tokens(templ->tokens);
 
-   /* we need to keep a local copy of the tokens */
-   shader->base.tokens = tgsi_dup_tokens(templ->tokens);
+      if ((LP_DEBUG & DEBUG_NIR) && fs_tgsi_to_nir_supported(&shader->info)) {
+         struct nir_shader *nir =
+            tgsi_to_nir(templ->tokens, lp_build_nir_compiler_options());
+
+         /* otherwise stay with the TGSI backend */
+         if (!fs_attach_nir(shader, nir))
+            ralloc_free(nir);
+      }
+
+      shader->draw_data = draw_create_fragment_shader(llvmpipe->draw, templ);
+   }
 
-   shader->draw_data = draw_create_fragment_shader(llvmpipe->draw, templ);
    if (shader->draw_data == NULL) {
+      ralloc_free(shader->base.ir.nir);
       FREE((void *) shader->base.tokens);
       FREE(shader);
       return NULL;
@@ -2972,7 +3412,10 @@ llvmpipe_create_fs_state(struct pipe_context *pipe,
       unsigned attrib;
       debug_printf("llvmpipe: Create fragment shader #%u %p:\n",
                    shader->no, (void *) shader);
-      tgsi_dump(templ->tokens, 0);
+      if (shader->base.tokens)
+         tgsi_dump(shader->base.tokens, 0);
+      else
+         nir_print_shader(shader->base.ir.nir, stderr);
       debug_printf("usage masks:\n");
       for (attrib = 0; attrib < shader->info.base.num_inputs; ++attrib) {
          unsigned usage_mask = shader->info.base.input_usage_mask[attrib];
@@ -3024,7 +3467,10 @@ llvmpipe_remove_shader_variant(struct llvmpipe_context *lp,
                    lp->nr_fs_variants, variant->nr_instrs, lp->nr_fs_instrs);
    }
 
-   gallivm_destroy(variant->gallivm);
+   if (variant->async)
+      destroy_async_variant(lp, variant);
+   else
+      gallivm_destroy(variant->gallivm);
 
    /* remove from shader's list */
    remove_from_list(&variant->list_item_local);
@@ -3034,6 +3480,7 @@ llvmpipe_remove_shader_variant(struct llvmpipe_context *lp,
    remove_from_list(&variant->list_item_global);
    lp->nr_fs_variants--;
    lp->nr_fs_instrs -= variant->nr_instrs;
+   lp->fs_code_size -= variant->code_size;
 
    FREE(variant);
 }
@@ -3067,6 +3514,7 @@ llvmpipe_delete_fs_state(struct pipe_context *pipe, void *fs)
    draw_delete_fragment_shader(llvmpipe->draw, shader->draw_data);
 
    assert(shader->variants_cached == 0);
+   ralloc_free(shader->base.ir.nir);
    FREE((void *) shader->base.tokens);
    FREE(shader);
 }
@@ -3324,8 +3772,8 @@ make_variant_key(struct llvmpipe_context *lp,
       key->nr_sampler_views = shader->info.base.file_max[TGSI_FILE_SAMPLER_VIEW] + 1;
       for(i = 0; i < key->nr_sampler_views; ++i) {
          if(shader->info.base.file_mask[TGSI_FILE_SAMPLER_VIEW] & (1 << i)) {
-            lp_sampler_static_texture_state(&key->state[i].texture_state,
-                                            lp->sampler_views[PIPE_SHADER_FRAGMENT][i]);
+            lp_llvm_static_texture_state(&key->state[i].texture_state,
+                                         lp->sampler_views[PIPE_SHADER_FRAGMENT][i]);
          }
       }
    }
@@ -3333,8 +3781,8 @@ make_variant_key(struct llvmpipe_context *lp,
       key->nr_sampler_views = key->nr_samplers;
       for(i = 0; i < key->nr_sampler_views; ++i) {
          if(shader->info.base.file_mask[TGSI_FILE_SAMPLER] & (1 << i)) {
-            lp_sampler_static_texture_state(&key->state[i].texture_state,
-                                            lp->sampler_views[PIPE_SHADER_FRAGMENT][i]);
+            lp_llvm_static_texture_state(&key->state[i].texture_state,
+                                         lp->sampler_views[PIPE_SHADER_FRAGMENT][i]);
          }
       }
    }
@@ -3342,6 +3790,82 @@ make_variant_key(struct llvmpipe_context *lp,
 
 
 
+/**
+ * Cost of recompiling a variant, relative to the memory its code takes.
+ *
+ * The variant cache uses the GreedyDual-Size policy: each variant gets a
+ * priority of the cache clock plus this cost whenever it is used, the
+ * variant with the lowest priority is evicted first, and the clock then
+ * advances to that priority.  So variants which are big and quick to
+ * recompile go first, while the clock makes sure that expensive variants
+ * which are no longer used eventually go too.
+ */
+static inline uint64_t
+fs_variant_cost(const struct lp_fragment_shader_variant *variant)
+{
+   /* microseconds of compile time per KiB of code */
+   return ((uint64_t) MAX2(variant->compile_time, 1) * 1024) /
+          MAX2(variant->code_size, 1);
+}
+
+
+/**
+ * Evict fragment shader variants until the cache is back under 15/16 of
+ * its variant count and code size limits, so that evictions (and the
+ * finish they require) don't happen on every miss.
+ */
+static void
+evict_fs_variants(struct llvmpipe_context *lp)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
+   const unsigned max_variants =
+      LP_MAX_SHADER_VARIANTS - LP_MAX_SHADER_VARIANTS / 16;
+   const uint64_t max_code_size =
+      screen->fs_cache_size - screen->fs_cache_size / 16;
+
+   if (gallivm_debug & GALLIVM_DEBUG_PERF) {
+      debug_printf("Evicting FS: %u total variants,\t%u instrs,"
+                   "\t%" PRIu64 " bytes of code\n",
+                   lp->nr_fs_variants, lp->nr_fs_instrs, lp->fs_code_size);
+   }
+
+   /*
+    * XXX: we need to flush the context until we have some sort of
+    * reference counting in fragment shaders as they may still be binned
+    * Flushing alone might not be sufficient we need to wait on it too.
+    */
+   llvmpipe_finish(&lp->pipe, __FUNCTION__);
+
+   /*
+    * We need to re-check lp->nr_fs_variants because an arbitrarliy large
+    * number of shader variants (potentially all of them) could be
+    * pending for destruction on flush.
+    */
+
+   while (lp->nr_fs_variants > max_variants ||
+          lp->fs_code_size > max_code_size) {
+      struct lp_fragment_shader_variant *victim = NULL;
+      struct lp_fs_variant_list_item *li;
+
+      if (is_empty_list(&lp->fs_variants_list)) {
+         break;
+      }
+
+      /* Scan from the least recently used end, so that ties go to it */
+      li = last_elem(&lp->fs_variants_list);
+      while (!at_end(&lp->fs_variants_list, li)) {
+         if (!victim || li->base->cache_priority < victim->cache_priority)
+            victim = li->base;
+         li = prev_elem(li);
+      }
+
+      lp->fs_cache_clock = MAX2(lp->fs_cache_clock, victim->cache_priority);
+      llvmpipe_remove_shader_variant(lp, victim);
+      lp->fs_variant_evictions++;
+   }
+}
+
+
 /**
  * Update fragment shader state.  This is called just prior to drawing
  * something when some fragment-related state has changed.
@@ -3349,6 +3873,7 @@ make_variant_key(struct llvmpipe_context *lp,
 void 
 llvmpipe_update_fs(struct llvmpipe_context *lp)
 {
+   struct llvmpipe_screen *screen = llvmpipe_screen(lp->pipe.screen);
    struct lp_fragment_shader *shader = lp->fs;
    struct lp_fragment_shader_variant_key key;
    struct lp_fragment_shader_variant *variant = NULL;
@@ -3367,16 +3892,17 @@ llvmpipe_update_fs(struct llvmpipe_context *lp)
    }
 
    if (variant) {
-      /* Move this variant to the head of the list to implement LRU
-       * deletion of shader's when we have too many.
+      /* Move this variant to the head of the list, so that the
+       * most recently used ones are checked first for swapping.
        */
       move_to_head(&lp->fs_variants_list, &variant->list_item_global);
+      swap_async_variant(lp, variant);
+      variant->cache_priority = lp->fs_cache_clock + fs_variant_cost(variant);
+      lp->fs_variant_hits++;
    }
    else {
       /* variant not found, create it now */
       int64_t t0, t1, dt;
-      unsigned i;
-      unsigned variants_to_cull;
 
       if (LP_DEBUG & DEBUG_FS) {
          debug_printf("%u variants,\t%u instrs,\t%u instrs/variant\n",
@@ -3385,46 +3911,14 @@ llvmpipe_update_fs(struct llvmpipe_context *lp)
                       lp->nr_fs_variants ? lp->nr_fs_instrs / lp->nr_fs_variants : 0);
       }
 
-      /* First, check if we've exceeded the max number of shader variants.
-       * If so, free 6.25% of them (the least recently used ones).
-       */
-      variants_to_cull = lp->nr_fs_variants >= LP_MAX_SHADER_VARIANTS ? LP_MAX_SHADER_VARIANTS / 16 : 0;
-
-      if (variants_to_cull ||
-          lp->nr_fs_instrs >= LP_MAX_SHADER_INSTRUCTIONS) {
-         struct pipe_context *pipe = &lp->pipe;
-
-         if (gallivm_debug & GALLIVM_DEBUG_PERF) {
-            debug_printf("Evicting FS: %u fs variants,\t%u total variants,"
-                         "\t%u instrs,\t%u instrs/variant\n",
-                         shader->variants_cached,
-                         lp->nr_fs_variants, lp->nr_fs_instrs,
-                         lp->nr_fs_instrs / lp->nr_fs_variants);
-         }
+      lp->fs_variant_misses++;
 
-         /*
-          * XXX: we need to flush the context until we have some sort of
-          * reference counting in fragment shaders as they may still be binned
-          * Flushing alone might not be sufficient we need to wait on it too.
-          */
-         llvmpipe_finish(pipe, __FUNCTION__);
-
-         /*
-          * We need to re-check lp->nr_fs_variants because an arbitrarliy large
-          * number of shader variants (potentially all of them) could be
-          * pending for destruction on flush.
-          */
-
-         for (i = 0; i < variants_to_cull || lp->nr_fs_instrs >= LP_MAX_SHADER_INSTRUCTIONS; i++) {
-            struct lp_fs_variant_list_item *item;
-            if (is_empty_list(&lp->fs_variants_list)) {
-               break;
-            }
-            item = last_elem(&lp->fs_variants_list);
-            assert(item);
-            assert(item->base);
-            llvmpipe_remove_shader_variant(lp, item->base);
-         }
+      /* First, check if we've exceeded the max number of shader variants
+       * or the code size budget.
+       */
+      if (lp->nr_fs_variants >= LP_MAX_SHADER_VARIANTS ||
+          lp->fs_code_size >= screen->fs_cache_size) {
+         evict_fs_variants(lp);
       }
 
       /*
@@ -3443,7 +3937,9 @@ llvmpipe_update_fs(struct llvmpipe_context *lp)
          insert_at_head(&lp->fs_variants_list, &variant->list_item_global);
          lp->nr_fs_variants++;
          lp->nr_fs_instrs += variant->nr_instrs;
+         lp->fs_code_size += variant->code_size;
          shader->variants_cached++;
+         variant->cache_priority = lp->fs_cache_clock + fs_variant_cost(variant);
       }
    }
 
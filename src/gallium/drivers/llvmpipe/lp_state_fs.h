@@ -36,10 +36,12 @@
 #include "gallivm/lp_bld_sample.h" /* for struct lp_sampler_static_state */
 #include "gallivm/lp_bld_tgsi.h" /* for lp_tgsi_info */
 #include "lp_bld_interp.h" /* for struct lp_shader_input */
+#include "lp_linear.h" /* for struct lp_linear_info */
 
 
 struct tgsi_token;
 struct lp_fragment_shader;
+struct lp_fs_async_variant;
 
 
 /** Indexes into jit_function[] array */
@@ -100,6 +102,9 @@ struct lp_fragment_shader_variant
    boolean opaque;
    uint8_t ps_inv_multiplier;
 
+   /** Whether and how simple triangles can bypass the JIT code */
+   struct lp_linear_info linear;
+
    struct gallivm_state *gallivm;
 
    LLVMTypeRef jit_context_ptr_type;
@@ -113,9 +118,19 @@ struct lp_fragment_shader_variant
    /* Total number of LLVM instructions generated */
    unsigned nr_instrs;
 
+   /* Bytes of machine code and data, and microseconds it took to compile */
+   size_t code_size;
+   int64_t compile_time;
+
+   /* Eviction priority in the context's variant cache */
+   uint64_t cache_priority;
+
    struct lp_fs_variant_list_item list_item_global, list_item_local;
    struct lp_fragment_shader *shader;
 
+   /** Optimized code being compiled in the background, or NULL */
+   struct lp_fs_async_variant *async;
+
    /* For debugging/profiling purposes */
    unsigned no;
 };
@@ -124,8 +139,16 @@ struct lp_fragment_shader_variant
 /** Subclass of pipe_shader_state */
 struct lp_fragment_shader
 {
+   /**
+    * base.tokens is NULL for shaders created from NIR.  base.ir.nir is set
+    * whenever the shader is to be translated from NIR, which with
+    * LP_DEBUG=nir also includes TGSI shaders that tgsi_to_nir can handle.
+    */
    struct pipe_shader_state base;
 
+   /** SHA1 of the serialized NIR, for the shader cache key */
+   unsigned char nir_sha1[20];
+
    struct lp_tgsi_info info;
 
    struct lp_fs_variant_list_item variants;
@@ -38,6 +38,8 @@
 #include "lp_screen.h"
 #include "lp_state.h"
 #include "lp_debug.h"
+#include "lp_flush.h"
+#include "lp_texture.h"
 #include "state_tracker/sw_winsys.h"
 
 
@@ -151,6 +153,13 @@ llvmpipe_set_sampler_views(struct pipe_context *pipe,
    }
 
    if (shader == PIPE_SHADER_VERTEX || shader == PIPE_SHADER_GEOMETRY) {
+      /* the draw module only knows the linear texture layout */
+      for (i = 0; i < num; i++) {
+         if (views[i] && views[i]->texture &&
+             views[i]->texture->target != PIPE_BUFFER)
+            llvmpipe_resource_untile(pipe, views[i]->texture);
+      }
+
       draw_set_sampler_views(llvmpipe->draw,
                              shader,
                              llvmpipe->sampler_views[shader],
@@ -270,6 +279,13 @@ prepare_shader_sampling(
             struct pipe_resource *res = view->texture;
             int j;
 
+            /* Vertex shading runs now, fill in fast cleared tiles first */
+            if (lp_tex->clears_pending) {
+               llvmpipe_flush_resource(&lp->pipe, res, 0, TRUE, TRUE, FALSE,
+                                       __FUNCTION__);
+               llvmpipe_resolve_clears(res);
+            }
+
             if (llvmpipe_resource_is_texture(res)) {
                first_level = view->u.tex.first_level;
                last_level = view->u.tex.last_level;
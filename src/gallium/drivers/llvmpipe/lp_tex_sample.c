@@ -51,6 +51,7 @@
 #include "lp_tex_sample.h"
 #include "lp_state_fs.h"
 #include "lp_debug.h"
+#include "lp_texture.h"
 
 
 /**
@@ -324,3 +325,17 @@ lp_llvm_sampler_soa_create(const struct lp_sampler_static_state *static_state)
    return &sampler->base;
 }
 
+
+/**
+ * Fill in the static state of a texture, including its llvmpipe specific
+ * memory layout.
+ */
+void
+lp_llvm_static_texture_state(struct lp_static_texture_state *state,
+                             const struct pipe_sampler_view *view)
+{
+   lp_sampler_static_texture_state(state, view);
+
+   if (view && view->texture)
+      state->tiled = llvmpipe_resource_const(view->texture)->tiled;
+}
@@ -33,6 +33,8 @@
 
 
 struct lp_sampler_static_state;
+struct lp_static_texture_state;
+struct pipe_sampler_view;
 
 /**
  * Whether texture cache is used for s3tc textures.
@@ -46,4 +48,8 @@ struct lp_sampler_static_state;
 struct lp_build_sampler_soa *
 lp_llvm_sampler_soa_create(const struct lp_sampler_static_state *key);
 
+void
+lp_llvm_static_texture_state(struct lp_static_texture_state *state,
+                             const struct pipe_sampler_view *view);
+
 #endif /* LP_TEX_SAMPLE_H */
@@ -36,14 +36,19 @@
 #include "pipe/p_defines.h"
 
 #include "util/u_inlines.h"
+#include "util/u_box.h"
 #include "util/u_cpu_detect.h"
 #include "util/u_format.h"
 #include "util/u_math.h"
 #include "util/u_memory.h"
 #include "util/simple_list.h"
+#include "util/u_surface.h"
 #include "util/u_transfer.h"
 
+#include "gallivm/lp_bld_sample.h"
+
 #include "lp_context.h"
+#include "lp_debug.h"
 #include "lp_flush.h"
 #include "lp_screen.h"
 #include "lp_texture.h"
@@ -60,6 +65,72 @@ static struct llvmpipe_resource resource_list;
 static unsigned id_counter = 0;
 
 
+/**
+ * Whether a texture may be stored in the tiled layout (see
+ * LP_TEXTURE_TILE_SIZE), which keeps the texels of bilinear footprints and
+ * of quads mostly within one cache line.
+ *
+ * This is limited to formats with one texel per block, and to textures
+ * whose bindings don't require the linear layout up front.  Render target
+ * textures are tiled too: most are only sampled, and the others get
+ * converted to the linear layout once a surface of them is created, as
+ * are textures sampled by the draw module, see llvmpipe_resource_untile().
+ */
+static boolean
+llvmpipe_texture_can_tile(const struct pipe_resource *pt)
+{
+   const struct util_format_description *desc =
+      util_format_description(pt->format);
+
+   if (LP_PERF & PERF_NO_TEX_TILING)
+      return FALSE;
+
+   if (pt->bind & (PIPE_BIND_DISPLAY_TARGET |
+                   PIPE_BIND_SCANOUT |
+                   PIPE_BIND_SHARED |
+                   PIPE_BIND_LINEAR |
+                   PIPE_BIND_CURSOR |
+                   PIPE_BIND_SHADER_IMAGE))
+      return FALSE;
+
+   switch (pt->target) {
+   case PIPE_TEXTURE_2D:
+   case PIPE_TEXTURE_RECT:
+   case PIPE_TEXTURE_2D_ARRAY:
+   case PIPE_TEXTURE_CUBE:
+   case PIPE_TEXTURE_CUBE_ARRAY:
+   case PIPE_TEXTURE_3D:
+      break;
+   default:
+      return FALSE;
+   }
+
+   return pt->nr_samples <= 1 &&
+          desc->block.width == 1 &&
+          desc->block.height == 1 &&
+          !util_format_is_depth_or_stencil(pt->format);
+}
+
+
+/**
+ * Number of 2D images (3D slices, cube faces or array layers) of a
+ * mipmap level.
+ */
+static unsigned
+llvmpipe_texture_num_slices(const struct pipe_resource *pt, unsigned level)
+{
+   if (pt->target == PIPE_TEXTURE_3D)
+      return u_minify(pt->depth0, level);
+   else if (pt->target == PIPE_TEXTURE_1D_ARRAY ||
+            pt->target == PIPE_TEXTURE_2D_ARRAY ||
+            pt->target == PIPE_TEXTURE_CUBE ||
+            pt->target == PIPE_TEXTURE_CUBE_ARRAY)
+      return pt->array_size;
+   else
+      return 1;
+}
+
+
 /**
  * Conventional allocation path for non-display textures:
  * Compute strides and allocate data (unless asked not to).
@@ -73,9 +144,7 @@ llvmpipe_texture_layout(struct llvmpipe_screen *screen,
    unsigned level;
    unsigned width = pt->width0;
    unsigned height = pt->height0;
-   unsigned depth = pt->depth0;
    uint64_t total_size = 0;
-   unsigned layers = pt->array_size;
    /* XXX:
     * This alignment here (same for displaytarget) was added for the purpose of
     * ARB_map_buffer_alignment. I am not convinced it's needed for non-buffer
@@ -91,6 +160,7 @@ llvmpipe_texture_layout(struct llvmpipe_screen *screen,
    for (level = 0; level <= pt->last_level; level++) {
       uint64_t mipsize;
       unsigned align_x, align_y, nblocksx, nblocksy, block_size, num_slices;
+      unsigned num_rows;
 
       /* Row stride and image stride */
 
@@ -112,39 +182,46 @@ llvmpipe_texture_layout(struct llvmpipe_screen *screen,
             align_y = LP_RASTER_BLOCK_SIZE;
       }
 
+      /* Only whole texel tiles are stored */
+      if (lpr->tiled) {
+         align_x = MAX2(align_x, LP_TEXTURE_TILE_SIZE);
+         align_y = MAX2(align_y, LP_TEXTURE_TILE_SIZE);
+      }
+
       nblocksx = util_format_get_nblocksx(pt->format,
                                           align(width, align_x));
       nblocksy = util_format_get_nblocksy(pt->format,
                                           align(height, align_y));
       block_size = util_format_get_blocksize(pt->format);
 
-      if (util_format_is_compressed(pt->format))
+      if (util_format_is_compressed(pt->format)) {
          lpr->row_stride[level] = nblocksx * block_size;
-      else
+         num_rows = nblocksy;
+      }
+      else if (lpr->tiled) {
+         /* the row stride is the size of a row of tiles */
+         lpr->row_stride[level] = nblocksx * block_size * LP_TEXTURE_TILE_SIZE;
+         num_rows = nblocksy / LP_TEXTURE_TILE_SIZE;
+      }
+      else {
          lpr->row_stride[level] = align(nblocksx * block_size, util_cpu_caps.cacheline);
+         num_rows = nblocksy;
+      }
 
       /* if row_stride * height > LP_MAX_TEXTURE_SIZE */
-      if ((uint64_t)lpr->row_stride[level] * nblocksy > LP_MAX_TEXTURE_SIZE) {
+      if ((uint64_t)lpr->row_stride[level] * num_rows > LP_MAX_TEXTURE_SIZE) {
          /* image too large */
          goto fail;
       }
 
-      lpr->img_stride[level] = lpr->row_stride[level] * nblocksy;
+      lpr->img_stride[level] = lpr->row_stride[level] * num_rows;
 
       /* Number of 3D image slices, cube faces or texture array layers */
       if (lpr->base.target == PIPE_TEXTURE_CUBE) {
-         assert(layers == 6);
+         assert(pt->array_size == 6);
       }
 
-      if (lpr->base.target == PIPE_TEXTURE_3D)
-         num_slices = depth;
-      else if (lpr->base.target == PIPE_TEXTURE_1D_ARRAY ||
-               lpr->base.target == PIPE_TEXTURE_2D_ARRAY ||
-               lpr->base.target == PIPE_TEXTURE_CUBE ||
-               lpr->base.target == PIPE_TEXTURE_CUBE_ARRAY)
-         num_slices = layers;
-      else
-         num_slices = 1;
+      num_slices = llvmpipe_texture_num_slices(pt, level);
 
       /* if img_stride * num_slices_faces > LP_MAX_TEXTURE_SIZE */
       mipsize = (uint64_t)lpr->img_stride[level] * num_slices;
@@ -163,7 +240,6 @@ llvmpipe_texture_layout(struct llvmpipe_screen *screen,
       /* Compute size of next mipmap level */
       width = u_minify(width, 1);
       height = u_minify(height, 1);
-      depth = u_minify(depth, 1);
    }
 
    if (allocate) {
@@ -262,8 +338,25 @@ llvmpipe_resource_create_front(struct pipe_screen *_screen,
       }
       else {
          /* texture map */
+         lpr->tiled = llvmpipe_texture_can_tile(&lpr->base);
          if (!llvmpipe_texture_layout(screen, lpr, true))
             goto fail;
+
+         if ((lpr->base.bind & PIPE_BIND_RENDER_TARGET) &&
+             !util_format_is_depth_or_stencil(lpr->base.format) &&
+             (lpr->base.target == PIPE_TEXTURE_2D ||
+              lpr->base.target == PIPE_TEXTURE_RECT) &&
+             lpr->base.array_size == 1 &&
+             lpr->base.nr_samples <= 1) {
+            lpr->tiles_x = align(lpr->base.width0, TILE_SIZE) / TILE_SIZE;
+            lpr->tiles_y = align(lpr->base.height0, TILE_SIZE) / TILE_SIZE;
+            lpr->tile_clear = CALLOC(lpr->tiles_x * lpr->tiles_y,
+                                     sizeof *lpr->tile_clear);
+            if (!lpr->tile_clear) {
+               align_free(lpr->tex_data);
+               goto fail;
+            }
+         }
       }
    }
    else {
@@ -331,6 +424,8 @@ llvmpipe_resource_destroy(struct pipe_screen *pscreen,
          align_free(lpr->tex_data);
          lpr->tex_data = NULL;
       }
+      align_free(lpr->untiled_data);
+      FREE(lpr->tile_clear);
    }
    else if (!lpr->userBuffer) {
       assert(lpr->data);
@@ -504,6 +599,70 @@ llvmpipe_resource_get_handle(struct pipe_screen *screen,
 }
 
 
+/**
+ * Copy a box of texels of a mipmap level between the texture and a linear
+ * buffer, in either direction, taking care of the tiled layout.
+ */
+static void
+llvmpipe_copy_texture_box(struct llvmpipe_resource *lpr,
+                          unsigned level,
+                          const struct pipe_box *box,
+                          ubyte *linear,
+                          unsigned stride,
+                          unsigned layer_stride,
+                          boolean to_texture)
+{
+   const unsigned tile_size = LP_TEXTURE_TILE_SIZE;
+   const unsigned texel_size = util_format_get_blocksize(lpr->base.format);
+   unsigned x, y, z;
+
+   if (!lpr->tiled) {
+      ubyte *image = llvmpipe_get_texture_image_address(lpr, 0, level);
+
+      if (to_texture)
+         util_copy_box(image, lpr->base.format,
+                       lpr->row_stride[level], lpr->img_stride[level],
+                       box->x, box->y, box->z,
+                       box->width, box->height, box->depth,
+                       linear, stride, layer_stride, 0, 0, 0);
+      else
+         util_copy_box(linear, lpr->base.format,
+                       stride, layer_stride, 0, 0, 0,
+                       box->width, box->height, box->depth,
+                       image, lpr->row_stride[level], lpr->img_stride[level],
+                       box->x, box->y, box->z);
+      return;
+   }
+
+   for (z = 0; z < box->depth; z++) {
+      ubyte *image = llvmpipe_get_texture_image_address(lpr, box->z + z,
+                                                        level);
+
+      for (y = 0; y < box->height; y++) {
+         const unsigned ty = box->y + y;
+         ubyte *tile_row = image + (ty / tile_size) * lpr->row_stride[level] +
+                           (ty % tile_size) * tile_size * texel_size;
+         ubyte *row = linear + z * layer_stride + y * stride;
+
+         /* copy the span of the row in each tile */
+         for (x = 0; x < box->width; ) {
+            const unsigned tx = box->x + x;
+            const unsigned n = MIN2(tile_size - tx % tile_size, box->width - x);
+            ubyte *texels = tile_row +
+                            (tx / tile_size) * tile_size * tile_size * texel_size +
+                            (tx % tile_size) * texel_size;
+
+            if (to_texture)
+               memcpy(texels, row + x * texel_size, n * texel_size);
+            else
+               memcpy(row + x * texel_size, texels, n * texel_size);
+            x += n;
+         }
+      }
+   }
+}
+
+
 static void *
 llvmpipe_transfer_map( struct pipe_context *pipe,
                        struct pipe_resource *resource,
@@ -596,6 +755,36 @@ llvmpipe_transfer_map( struct pipe_context *pipe,
 
    format = lpr->base.format;
 
+   /* The rasterizer is done with the resource, fill in any fast clears */
+   if (!(usage & PIPE_TRANSFER_UNSYNCHRONIZED))
+      llvmpipe_resolve_clears(resource);
+
+   if (lpr->tiled) {
+      /*
+       * Map a linear copy of the box, which is written back on unmap.
+       */
+      if (usage & PIPE_TRANSFER_MAP_DIRECTLY)
+         goto fail;
+
+      pt->stride = util_format_get_stride(format, box->width);
+      pt->layer_stride = util_format_get_2d_size(format, pt->stride,
+                                                 box->height);
+      lpt->staging = MALLOC(pt->layer_stride * box->depth);
+      if (!lpt->staging)
+         goto fail;
+
+      if (!(usage & (PIPE_TRANSFER_DISCARD_RANGE |
+                     PIPE_TRANSFER_DISCARD_WHOLE_RESOURCE))) {
+         llvmpipe_copy_texture_box(lpr, level, box, lpt->staging,
+                                   pt->stride, pt->layer_stride, FALSE);
+      }
+
+      if (usage & PIPE_TRANSFER_WRITE)
+         screen->timestamp++;
+
+      return lpt->staging;
+   }
+
    map = llvmpipe_resource_map(resource,
                                level,
                                box->z,
@@ -616,6 +805,12 @@ llvmpipe_transfer_map( struct pipe_context *pipe,
       box->x / util_format_get_blockwidth(format) * util_format_get_blocksize(format);
 
    return map;
+
+fail:
+   pipe_resource_reference(&pt->resource, NULL);
+   FREE(lpt);
+   *transfer = NULL;
+   return NULL;
 }
 
 
@@ -623,8 +818,21 @@ static void
 llvmpipe_transfer_unmap(struct pipe_context *pipe,
                         struct pipe_transfer *transfer)
 {
+   struct llvmpipe_transfer *lpt = llvmpipe_transfer(transfer);
+
    assert(transfer->resource);
 
+   if (lpt->staging) {
+      /* The texture may have been untiled meanwhile, which is handled */
+      if (transfer->usage & PIPE_TRANSFER_WRITE) {
+         llvmpipe_copy_texture_box(llvmpipe_resource(transfer->resource),
+                                   transfer->level, &transfer->box,
+                                   lpt->staging, transfer->stride,
+                                   transfer->layer_stride, TRUE);
+      }
+      FREE(lpt->staging);
+   }
+
    llvmpipe_resource_unmap(transfer->resource,
                            transfer->level,
                            transfer->box.z);
@@ -726,6 +934,120 @@ tex_image_face_size(const struct llvmpipe_resource *lpr, unsigned level)
 }
 
 
+/**
+ * Write out the clear color of a fast cleared tile.
+ * Must only be called by whoever owns the tile: the rasterizer thread
+ * working on it, or anyone when the resource isn't being rendered to.
+ */
+void
+llvmpipe_resolve_tile_clear(struct llvmpipe_resource *lpr,
+                            unsigned tx, unsigned ty)
+{
+   struct llvmpipe_tile_clear *tc = &lpr->tile_clear[ty * lpr->tiles_x + tx];
+   const unsigned x = tx * TILE_SIZE;
+   const unsigned y = ty * TILE_SIZE;
+
+   if (!tc->cleared)
+      return;
+
+   util_fill_rect(lpr->tex_data, lpr->base.format, lpr->row_stride[0],
+                  x, y,
+                  MIN2(TILE_SIZE, lpr->base.width0 - x),
+                  MIN2(TILE_SIZE, lpr->base.height0 - y),
+                  &tc->value);
+   tc->cleared = FALSE;
+}
+
+
+/**
+ * Write out all fast cleared tiles of a resource, before it's accessed
+ * other than as a render target.
+ */
+void
+llvmpipe_resolve_clears(struct pipe_resource *resource)
+{
+   struct llvmpipe_resource *lpr = llvmpipe_resource(resource);
+   unsigned tx, ty;
+
+   if (!lpr->tile_clear || !lpr->clears_pending)
+      return;
+
+   for (ty = 0; ty < lpr->tiles_y; ty++) {
+      for (tx = 0; tx < lpr->tiles_x; tx++) {
+         llvmpipe_resolve_tile_clear(lpr, tx, ty);
+      }
+   }
+
+   lpr->clears_pending = FALSE;
+}
+
+
+/**
+ * Convert a tiled texture to the linear layout, before uses which don't
+ * know about tiles: rendering to it, or sampling it in the draw module.
+ * The texture then stays linear.
+ */
+void
+llvmpipe_resource_untile(struct pipe_context *pipe,
+                         struct pipe_resource *resource)
+{
+   struct llvmpipe_screen *screen = llvmpipe_screen(pipe->screen);
+   struct llvmpipe_resource *lpr = llvmpipe_resource(resource);
+   struct llvmpipe_resource linear;
+   unsigned level, slice;
+
+   if (!lpr->tiled)
+      return;
+
+   llvmpipe_flush_resource(pipe, resource, 0,
+                           FALSE, /* read_only */
+                           TRUE, /* cpu_access */
+                           FALSE, /* do_not_block */
+                           __FUNCTION__);
+
+   memset(&linear, 0, sizeof linear);
+   linear.base = lpr->base;
+   if (!llvmpipe_texture_layout(screen, &linear, TRUE)) {
+      debug_printf("llvmpipe: out of memory untiling texture %u\n", lpr->id);
+      return;
+   }
+
+   for (level = 0; level <= resource->last_level; level++) {
+      const unsigned num_slices = llvmpipe_texture_num_slices(resource, level);
+
+      for (slice = 0; slice < num_slices; slice++) {
+         struct pipe_box box;
+
+         u_box_2d_zslice(0, 0, slice,
+                         u_minify(resource->width0, level),
+                         u_minify(resource->height0, level), &box);
+         llvmpipe_copy_texture_box(lpr, level, &box,
+                                   llvmpipe_get_texture_image_address(&linear,
+                                                                      slice,
+                                                                      level),
+                                   linear.row_stride[level],
+                                   linear.img_stride[level],
+                                   FALSE);
+      }
+   }
+
+   /* Scenes of other contexts may still reference the tiled data, so it
+    * lives on until the resource is destroyed.  This only happens once,
+    * as textures never go back to being tiled.
+    */
+   assert(!lpr->untiled_data);
+   lpr->untiled_data = lpr->tex_data;
+   lpr->tex_data = linear.tex_data;
+   memcpy(lpr->row_stride, linear.row_stride, sizeof lpr->row_stride);
+   memcpy(lpr->img_stride, linear.img_stride, sizeof lpr->img_stride);
+   memcpy(lpr->mip_offsets, linear.mip_offsets, sizeof lpr->mip_offsets);
+   lpr->tiled = FALSE;
+
+   /* sampling code and texture pointers depend on the layout */
+   llvmpipe_context(pipe)->dirty |= LP_NEW_SAMPLER_VIEW;
+}
+
+
 /**
  * Return pointer to a 2D texture image/face/slice.
  * No tiled/linear conversion is done.
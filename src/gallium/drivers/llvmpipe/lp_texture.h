@@ -31,6 +31,7 @@
 
 #include "pipe/p_state.h"
 #include "util/u_debug.h"
+#include "util/u_pack_color.h"
 #include "lp_limits.h"
 
 
@@ -49,6 +50,16 @@ struct llvmpipe_context;
 struct sw_displaytarget;
 
 
+/**
+ * Fast clear state of one TILE_SIZE x TILE_SIZE tile of a render target.
+ */
+struct llvmpipe_tile_clear
+{
+   boolean cleared;           /**< tile is 'value', but memory isn't written */
+   union util_color value;    /**< packed clear color */
+};
+
+
 /**
  * llvmpipe subclass of pipe_resource.  A texture, drawing surface,
  * vertex buffer, const buffer, etc.
@@ -69,6 +80,14 @@ struct llvmpipe_resource
    /** allocated total size (for non-display target texture resources only) */
    unsigned total_alloc_size;
 
+   /**
+    * Texels are stored in tiles for better sampling locality, see
+    * LP_TEXTURE_TILE_SIZE.  Only ever set for textures which haven't been
+    * rendered to nor sampled by the draw module; those uses convert them
+    * to the linear layout with llvmpipe_resource_untile() first.
+    */
+   boolean tiled;
+
    /**
     * Display target, for textures with the PIPE_BIND_DISPLAY_TARGET
     * usage.
@@ -80,6 +99,13 @@ struct llvmpipe_resource
     */
    void *tex_data;
 
+   /**
+    * The tiled tex_data replaced by llvmpipe_resource_untile().  Scenes
+    * binned by any context may still sample from it, so it's only freed
+    * along with the resource, which those scenes hold a reference to.
+    */
+   void *untiled_data;
+
    /**
     * Data for non-texture resources.
     */
@@ -88,6 +114,17 @@ struct llvmpipe_resource
    boolean userBuffer;  /** Is this a user-space buffer? */
    unsigned timestamp;
 
+   /**
+    * Fast clear state for level 0 / layer 0 of 2D render targets, one
+    * entry per tile, or NULL.  Clears of tiles which nothing else is drawn
+    * to in a scene only record the color here.  The memory is filled in
+    * (resolved) when the tile is next drawn to, or when the resource is
+    * sampled from or mapped.  See lp_rast_clear_color().
+    */
+   struct llvmpipe_tile_clear *tile_clear;
+   unsigned tiles_x, tiles_y;
+   boolean clears_pending;    /**< some tile_clear[] entries are cleared */
+
    unsigned id;  /**< temporary, for debugging */
 
 #ifdef DEBUG
@@ -102,6 +139,9 @@ struct llvmpipe_transfer
    struct pipe_transfer base;
 
    unsigned long offset;
+
+   /** Linear copy of the mapped box of a tiled texture, or NULL */
+   void *staging;
 };
 
 
@@ -220,6 +260,19 @@ llvmpipe_get_texture_image_address(struct llvmpipe_resource *lpr,
                                    unsigned face_slice, unsigned level);
 
 
+void
+llvmpipe_resolve_tile_clear(struct llvmpipe_resource *lpr,
+                            unsigned tx, unsigned ty);
+
+void
+llvmpipe_resolve_clears(struct pipe_resource *resource);
+
+
+void
+llvmpipe_resource_untile(struct pipe_context *pipe,
+                         struct pipe_resource *resource);
+
+
 extern void
 llvmpipe_print_resources(void);
 
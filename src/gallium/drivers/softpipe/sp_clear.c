@@ -38,6 +38,7 @@
 #include "sp_clear.h"
 #include "sp_context.h"
 #include "sp_query.h"
+#include "sp_rast.h"
 #include "sp_tile_cache.h"
 
 
@@ -68,7 +69,10 @@ softpipe_clear(struct pipe_context *pipe, unsigned buffers,
 
    if (buffers & PIPE_CLEAR_COLOR) {
       for (i = 0; i < softpipe->framebuffer.nr_cbufs; i++) {
-         sp_tile_cache_clear(softpipe->cbuf_cache[i], color, 0);
+         if (softpipe->rast)
+            sp_rast_clear_cbuf(softpipe->rast, i, color);
+         else
+            sp_tile_cache_clear(softpipe->cbuf_cache[i], color, 0);
       }
    }
 
@@ -83,7 +87,10 @@ softpipe_clear(struct pipe_context *pipe, unsigned buffers,
       static const union pipe_color_union zero;
 
       cv = util_pack64_z_stencil(zsbuf->format, depth, stencil);
-      sp_tile_cache_clear(softpipe->zsbuf_cache, &zero, cv);
+      if (softpipe->rast)
+         sp_rast_clear_zsbuf(softpipe->rast, cv);
+      else
+         sp_tile_cache_clear(softpipe->zsbuf_cache, &zero, cv);
    }
 
    softpipe->dirty_render_cache = TRUE;
@@ -48,6 +48,7 @@
 
 
 struct softpipe_vbuf_render;
+struct sp_rast;
 struct draw_context;
 struct draw_stage;
 struct softpipe_tile_cache;
@@ -161,13 +162,7 @@ struct softpipe_context {
    } pstipple;
 
    /** Software quad rendering pipeline */
-   struct {
-      struct quad_stage *shade;
-      struct quad_stage *depth_test;
-      struct quad_stage *blend;
-      struct quad_stage *pstipple;
-      struct quad_stage *first; /**< points to one of the above stages */
-   } quad;
+   struct sp_quad_pipeline quad;
 
    /** TGSI exec things */
    struct {
@@ -194,6 +189,9 @@ struct softpipe_context {
    struct softpipe_tile_cache *cbuf_cache[PIPE_MAX_COLOR_BUFS];
    struct softpipe_tile_cache *zsbuf_cache;
 
+   /** Rasterizer threads, NULL when rendering on the calling thread */
+   struct sp_rast *rast;
+
    unsigned tex_timestamp;
 
    /*
@@ -35,6 +35,7 @@
 #include "draw/draw_context.h"
 #include "sp_flush.h"
 #include "sp_context.h"
+#include "sp_rast.h"
 #include "sp_state.h"
 #include "sp_tile_cache.h"
 #include "sp_tex_tile_cache.h"
@@ -75,6 +76,10 @@ softpipe_flush( struct pipe_context *pipe,
    if (softpipe->zsbuf_cache)
       sp_flush_tile_cache(softpipe->zsbuf_cache);
 
+   if (softpipe->rast)
+      sp_rast_flush(softpipe->rast,
+                    (flags & SP_FLUSH_TEXTURE_CACHE) != 0);
+
    softpipe->dirty_render_cache = FALSE;
 
    /* Enable to dump BMPs of the color/depth buffers each frame */
@@ -187,6 +192,9 @@ void softpipe_texture_barrier(struct pipe_context *pipe, unsigned flags)
    if (softpipe->zsbuf_cache)
       sp_flush_tile_cache(softpipe->zsbuf_cache);
 
+   if (softpipe->rast)
+      sp_rast_flush(softpipe->rast, TRUE);
+
    softpipe->dirty_render_cache = FALSE;
 }
 
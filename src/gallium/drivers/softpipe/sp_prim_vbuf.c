@@ -37,6 +37,7 @@
 
 
 #include "sp_context.h"
+#include "sp_rast.h"
 #include "sp_setup.h"
 #include "sp_state.h"
 #include "sp_prim_vbuf.h"
@@ -137,7 +138,12 @@ sp_vbuf_set_primitive(struct vbuf_render *vbr, enum pipe_prim_type prim)
 {
    struct softpipe_vbuf_render *cvbr = softpipe_vbuf_render(vbr);
    struct setup_context *setup_ctx = cvbr->setup;
-   
+
+   /* the binned primitives are rendered with the state they were set up for */
+   if (cvbr->softpipe->rast &&
+       u_reduced_prim(prim) != cvbr->softpipe->reduced_prim)
+      sp_rast_render(cvbr->softpipe->rast);
+
    sp_setup_prepare( setup_ctx );
 
    cvbr->softpipe->reduced_prim = u_reduced_prim(prim);
@@ -153,6 +159,25 @@ static inline cptrf4 get_vert( const void *vertex_buffer,
 }
 
 
+/**
+ * Return vertices start .. start + nr - 1 of the vertex buffer.  The
+ * rasterizer threads render after the draw module has reused the buffer,
+ * so for them these are copied.
+ */
+static const void *
+sp_vbuf_vertices(struct softpipe_vbuf_render *cvbr, uint start, uint nr)
+{
+   const unsigned stride = cvbr->softpipe->vertex_info.size * sizeof(float);
+   const void *vertices = get_vert(cvbr->vertex_buffer, start, stride);
+
+   if (cvbr->softpipe->rast)
+      return sp_rast_copy_vertices(cvbr->softpipe->rast, vertices,
+                                   nr * stride);
+
+   return vertices;
+}
+
+
 /**
  * draw elements / indexed primitives
  */
@@ -162,11 +187,14 @@ sp_vbuf_draw_elements(struct vbuf_render *vbr, const ushort *indices, uint nr)
    struct softpipe_vbuf_render *cvbr = softpipe_vbuf_render(vbr);
    struct softpipe_context *softpipe = cvbr->softpipe;
    const unsigned stride = softpipe->vertex_info.size * sizeof(float);
-   const void *vertex_buffer = cvbr->vertex_buffer;
+   const void *vertex_buffer = sp_vbuf_vertices(cvbr, 0, cvbr->nr_vertices);
    struct setup_context *setup = cvbr->setup;
    const boolean flatshade_first = softpipe->rasterizer->flatshade_first;
    unsigned i;
 
+   if (!vertex_buffer)
+      return;
+
    switch (cvbr->prim) {
    case PIPE_PRIM_POINTS:
       for (i = 0; i < nr; i++) {
@@ -359,11 +387,13 @@ sp_vbuf_draw_arrays(struct vbuf_render *vbr, uint start, uint nr)
    struct softpipe_context *softpipe = cvbr->softpipe;
    struct setup_context *setup = cvbr->setup;
    const unsigned stride = softpipe->vertex_info.size * sizeof(float);
-   const void *vertex_buffer =
-      (void *) get_vert(cvbr->vertex_buffer, start, stride);
+   const void *vertex_buffer = sp_vbuf_vertices(cvbr, start, nr);
    const boolean flatshade_first = softpipe->rasterizer->flatshade_first;
    unsigned i;
 
+   if (!vertex_buffer)
+      return;
+
    switch (cvbr->prim) {
    case PIPE_PRIM_POINTS:
       for (i = 0; i < nr; i++) {
@@ -667,7 +697,7 @@ sp_create_vbuf_backend(struct softpipe_context *sp)
 
    cvbr->softpipe = sp;
 
-   cvbr->setup = sp_setup_create_context(cvbr->softpipe);
+   cvbr->setup = sp_setup_create_context(cvbr->softpipe, sp->rast);
 
    return &cvbr->base;
 }
@@ -32,8 +32,37 @@
 #define SP_QUAD_PIPE_H
 
 
+#include "pipe/p_state.h"
+
+
 struct softpipe_context;
+struct softpipe_tile_cache;
+struct tgsi_exec_machine;
 struct quad_header;
+struct quad_stage;
+
+
+/**
+ * A quad pipeline: the stages and the resources they render with.
+ * The context has one.  With SOFTPIPE_NUM_THREADS each rasterizer thread
+ * has its own (see sp_rast.c), so that threads never share an interpreter
+ * or a tile cache.
+ */
+struct sp_quad_pipeline {
+   struct quad_stage *shade;
+   struct quad_stage *depth_test;
+   struct quad_stage *blend;
+   struct quad_stage *pstipple;
+   struct quad_stage *first; /**< points to one of the above stages */
+
+   struct tgsi_exec_machine *fs_machine;
+   struct softpipe_tile_cache **cbuf_cache;  /**< [PIPE_MAX_COLOR_BUFS] */
+   struct softpipe_tile_cache *zsbuf_cache;
+
+   /** Counters the stages add to */
+   uint64_t *occlusion_count;
+   uint64_t *ps_invocations;
+};
 
 
 /**
@@ -43,6 +72,7 @@ struct quad_header;
  */
 struct quad_stage {
    struct softpipe_context *softpipe;
+   struct sp_quad_pipeline *pipeline;
 
    struct quad_stage *next;
 
@@ -67,6 +97,11 @@ struct quad_stage *sp_quad_blend_stage( struct softpipe_context *softpipe );
 struct quad_stage *sp_quad_colormask_stage( struct softpipe_context *softpipe );
 struct quad_stage *sp_quad_output_stage( struct softpipe_context *softpipe );
 
-void sp_build_quad_pipeline(struct softpipe_context *sp);
+boolean sp_create_quad_pipeline(struct softpipe_context *sp,
+                                struct sp_quad_pipeline *quad);
+void sp_destroy_quad_pipeline(struct sp_quad_pipeline *quad);
+
+void sp_build_quad_pipeline(struct softpipe_context *sp,
+                            struct sp_quad_pipeline *quad);
 
 #endif /* SP_QUAD_PIPE_H */
@@ -0,0 +1,761 @@
+/**************************************************************************
+ *
+ * Copyright 2007 VMware, Inc.
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/**
+ * Binned rasterization on worker threads.
+ *
+ * With SOFTPIPE_NUM_THREADS=n the vbuf backend's setup context doesn't
+ * render primitives, it bins them here.  The framebuffer tiles are split
+ * between n tasks by render tile cache entry (see sp_tile_cache_pos()):
+ * task i owns the tiles of entries i, i + n, i + 2n...  Each task renders
+ * the binned primitives that touch its tiles with its own setup context,
+ * quad pipeline, tile caches, interpreter and texture caches.  Task 0 runs
+ * on the calling thread, the others on a util_queue.  The bins are
+ * rendered at the end of each draw, or earlier when they fill up.
+ *
+ * A task sees the primitives of its tiles in submission order, and each of
+ * its tile cache entries sees the same sequence of tiles as the entry of
+ * the context's single cache would.  So tiles are evicted, and converted
+ * to the surface format, at the same points as when rendering on the
+ * calling thread, and the results are bit-identical.
+ *
+ * Fragment shaders with side effects, and feedback loops where a bound
+ * texture is also rendered to, are rendered on the calling thread, still
+ * through the tasks' pipelines so the caches stay consistent.
+ */
+
+#include "sp_context.h"
+#include "sp_quad_pipe.h"
+#include "sp_rast.h"
+#include "sp_setup.h"
+#include "sp_state.h"
+#include "sp_texture.h"
+#include "sp_tex_sample.h"
+#include "sp_tex_tile_cache.h"
+#include "sp_tile_cache.h"
+#include "tgsi/tgsi_exec.h"
+#include "util/u_math.h"
+#include "util/u_memory.h"
+#include "util/u_queue.h"
+
+
+/** Max primitives binned before rendering */
+#define SP_RAST_MAX_PRIMS 4096
+
+/** Initial size of the buffer binned primitives' vertices are copied to */
+#define SP_RAST_VERTEX_BUFFER_SIZE (1024 * 1024)
+
+
+struct sp_rast_prim {
+   const float (*v[3])[4];
+   unsigned nr_verts;
+   unsigned tasks;  /**< bitmask of the tasks whose tiles it may touch */
+};
+
+
+struct sp_rast_task {
+   struct sp_rast *rast;
+   unsigned index;
+
+   struct setup_context *setup;
+   struct sp_quad_pipeline quad;
+   struct tgsi_exec_machine *fs_machine;
+   struct softpipe_tile_cache *cbuf_cache[PIPE_MAX_COLOR_BUFS];
+   struct softpipe_tile_cache *zsbuf_cache;
+   struct sp_tgsi_sampler *sampler;
+   struct softpipe_tex_tile_cache *tex_cache[PIPE_MAX_SHADER_SAMPLER_VIEWS];
+
+   /** The fragment shader variant bound to fs_machine */
+   const struct sp_fragment_shader_variant *fs_variant;
+
+   /** Statistics, added to the context's after each render */
+   uint64_t occlusion_count;
+   uint64_t ps_invocations;
+   uint64_t c_primitives;
+
+   struct util_queue_fence fence;
+};
+
+
+struct sp_rast {
+   struct softpipe_context *softpipe;
+
+   unsigned num_tasks;
+   struct sp_rast_task tasks[SP_MAX_RAST_THREADS];
+   struct util_queue queue;
+
+   /** The task owning each render tile cache entry, as a bit */
+   unsigned entry_tasks[NUM_ENTRIES];
+
+   /** Renders all tiles on the calling thread, through the tasks' pipelines */
+   struct setup_context *serial_setup;
+
+   struct sp_rast_prim prims[SP_RAST_MAX_PRIMS];
+   unsigned num_prims;
+
+   ubyte *vertices;
+   unsigned vertex_size;
+   unsigned vertex_used;
+};
+
+
+/**
+ * Return the tasks owning the tiles which a primitive with the given
+ * bounds in window coordinates may touch.
+ */
+static unsigned
+bin_tasks(const struct sp_rast *rast,
+          float xmin, float ymin, float xmax, float ymax)
+{
+   const struct softpipe_context *sp = rast->softpipe;
+   const unsigned all_tasks = (1u << rast->num_tasks) - 1;
+   const int width = sp->framebuffer.width;
+   const int height = sp->framebuffer.height;
+   unsigned tasks = 0;
+   int tx0, ty0, tx1, ty1, tx, ty;
+
+   /* the tiles of other layers aren't tracked */
+   if (sp->layer_slot > 0)
+      return all_tasks;
+
+   /* Off screen.  Still let one task set it up, for the statistics. */
+   if (xmax < 0.0f || ymax < 0.0f ||
+       xmin >= (float) width || ymin >= (float) height)
+      return 1;
+
+   tx0 = (int) MAX2(xmin, 0.0f) / TILE_SIZE;
+   ty0 = (int) MAX2(ymin, 0.0f) / TILE_SIZE;
+   tx1 = (int) MIN2(xmax, (float) (width - 1)) / TILE_SIZE;
+   ty1 = (int) MIN2(ymax, (float) (height - 1)) / TILE_SIZE;
+
+   for (ty = ty0; ty <= ty1; ty++) {
+      for (tx = tx0; tx <= tx1; tx++) {
+         union tile_address addr = tile_address(tx * TILE_SIZE,
+                                                ty * TILE_SIZE, 0);
+
+         tasks |= rast->entry_tasks[sp_tile_cache_pos(addr)];
+         if (tasks == all_tasks)
+            return tasks;
+      }
+   }
+
+   return tasks ? tasks : 1;
+}
+
+
+/**
+ * Bin a primitive.  pad is how far its fragments may reach beyond the
+ * bounding box of its vertices.
+ */
+static void
+bin_prim(struct sp_rast *rast,
+         const float (*v0)[4],
+         const float (*v1)[4],
+         const float (*v2)[4],
+         unsigned nr_verts,
+         float pad)
+{
+   const float (*v[3])[4] = { v0, v1, v2 };
+   struct sp_rast_prim *prim;
+   float xmin, ymin, xmax, ymax;
+   unsigned i;
+
+   if (rast->num_prims == ARRAY_SIZE(rast->prims))
+      sp_rast_render(rast);
+
+   xmin = xmax = v0[0][0];
+   ymin = ymax = v0[0][1];
+   for (i = 1; i < nr_verts; i++) {
+      xmin = MIN2(xmin, v[i][0][0]);
+      xmax = MAX2(xmax, v[i][0][0]);
+      ymin = MIN2(ymin, v[i][0][1]);
+      ymax = MAX2(ymax, v[i][0][1]);
+   }
+
+   prim = &rast->prims[rast->num_prims++];
+   for (i = 0; i < 3; i++)
+      prim->v[i] = v[i];
+   prim->nr_verts = nr_verts;
+
+   /* NaN or huge coordinates, MIN2/MAX2 may have dropped them */
+   if (util_is_inf_or_nan(v0[0][0] + v0[0][1] + v1[0][0] + v1[0][1] +
+                          v2[0][0] + v2[0][1] + pad))
+      prim->tasks = (1u << rast->num_tasks) - 1;
+   else
+      prim->tasks = bin_tasks(rast, xmin - pad, ymin - pad,
+                              xmax + pad, ymax + pad);
+}
+
+
+void
+sp_rast_bin_tri(struct sp_rast *rast,
+                const float (*v0)[4],
+                const float (*v1)[4],
+                const float (*v2)[4])
+{
+   bin_prim(rast, v0, v1, v2, 3, 1.0f);
+}
+
+
+void
+sp_rast_bin_line(struct sp_rast *rast,
+                 const float (*v0)[4],
+                 const float (*v1)[4])
+{
+   const float width = rast->softpipe->rasterizer->line_width;
+
+   bin_prim(rast, v0, v1, v1, 2, 0.5f * MAX2(width, 1.0f) + 1.0f);
+}
+
+
+void
+sp_rast_bin_point(struct sp_rast *rast,
+                  const float (*v0)[4])
+{
+   const struct softpipe_context *sp = rast->softpipe;
+   const float size = sp->psize_slot > 0 ? v0[sp->psize_slot][0]
+                                         : sp->rasterizer->point_size;
+
+   bin_prim(rast, v0, v0, v0, 1, 0.5f * MAX2(size, 1.0f) + 2.0f);
+}
+
+
+/**
+ * Copy the vertices of the primitives about to be binned, since the draw
+ * module reuses its vertex buffer before the bins are rendered.
+ */
+const void *
+sp_rast_copy_vertices(struct sp_rast *rast,
+                      const void *vertices,
+                      unsigned size)
+{
+   const unsigned aligned_size = align(size, 16);
+   void *copy;
+
+   if (rast->vertex_used + aligned_size > rast->vertex_size) {
+      /* Nothing binned refers to the buffer once it is rendered */
+      sp_rast_render(rast);
+      rast->vertex_used = 0;
+
+      if (aligned_size > rast->vertex_size) {
+         align_free(rast->vertices);
+         rast->vertices = align_malloc(aligned_size, 16);
+         rast->vertex_size = rast->vertices ? aligned_size : 0;
+         if (!rast->vertices)
+            return NULL;
+      }
+   }
+
+   copy = rast->vertices + rast->vertex_used;
+   memcpy(copy, vertices, size);
+   rast->vertex_used += aligned_size;
+
+   return copy;
+}
+
+
+/**
+ * Point a task's fragment shader samplers at its own texture caches.
+ */
+static void
+task_update_samplers(struct sp_rast *rast, struct sp_rast_task *task)
+{
+   struct softpipe_context *sp = rast->softpipe;
+   const struct sp_tgsi_sampler *src = sp->tgsi.sampler[PIPE_SHADER_FRAGMENT];
+   struct sp_tgsi_sampler *dst = task->sampler;
+   unsigned i;
+
+   memcpy(dst->sp_sampler, src->sp_sampler, sizeof(dst->sp_sampler));
+   memcpy(dst->sp_sview, src->sp_sview, sizeof(dst->sp_sview));
+
+   for (i = 0; i < ARRAY_SIZE(task->tex_cache); i++) {
+      struct softpipe_tex_tile_cache *tc = task->tex_cache[i];
+
+      sp_tex_tile_cache_set_sampler_view(tc,
+                                         sp->sampler_views[PIPE_SHADER_FRAGMENT][i]);
+
+      if (tc->texture) {
+         struct softpipe_resource *spt = softpipe_resource(tc->texture);
+         if (spt->timestamp != tc->timestamp) {
+            sp_tex_tile_cache_validate_texture(tc);
+            tc->timestamp = spt->timestamp;
+         }
+      }
+
+      if (dst->sp_sview[i].cache)
+         dst->sp_sview[i].cache = tc;
+   }
+}
+
+
+/**
+ * Bring a task's pipeline up to date with the context state.
+ */
+static void
+task_prepare(struct sp_rast *rast, struct sp_rast_task *task)
+{
+   struct softpipe_context *sp = rast->softpipe;
+
+   task_update_samplers(rast, task);
+
+   if (sp->fs_variant && task->fs_variant != sp->fs_variant) {
+      sp->fs_variant->prepare(sp->fs_variant,
+                              task->fs_machine,
+                              (struct tgsi_sampler *) task->sampler,
+                              (struct tgsi_image *) sp->tgsi.image[PIPE_SHADER_FRAGMENT],
+                              (struct tgsi_buffer *) sp->tgsi.buffer[PIPE_SHADER_FRAGMENT]);
+      task->fs_variant = sp->fs_variant;
+   }
+
+   sp_build_quad_pipeline(sp, &task->quad);
+}
+
+
+/**
+ * Whether the binned primitives must be rendered in order on the calling
+ * thread: the fragment shader has side effects other tiles may observe, or
+ * a bound texture is also being rendered to, whose texture cache may have
+ * to flush the context when it maps the texture.
+ */
+static boolean
+needs_serial_render(const struct sp_rast *rast)
+{
+   const struct softpipe_context *sp = rast->softpipe;
+   const struct pipe_framebuffer_state *fb = &sp->framebuffer;
+   unsigned i, j;
+
+   if (sp->fs_variant && sp->fs_variant->info.writes_memory)
+      return TRUE;
+
+   for (i = 0; i < sp->num_sampler_views[PIPE_SHADER_FRAGMENT]; i++) {
+      const struct pipe_sampler_view *view =
+         sp->sampler_views[PIPE_SHADER_FRAGMENT][i];
+
+      if (!view)
+         continue;
+
+      for (j = 0; j < fb->nr_cbufs; j++) {
+         if (fb->cbufs[j] && fb->cbufs[j]->texture == view->texture)
+            return TRUE;
+      }
+      if (fb->zsbuf && fb->zsbuf->texture == view->texture)
+         return TRUE;
+   }
+
+   return FALSE;
+}
+
+
+/**
+ * Set up the binned primitives which touch the tiles of the tasks in mask.
+ * Triangles are counted by the first of their tasks only.
+ */
+static void
+render_prims(const struct sp_rast *rast,
+             struct setup_context *setup,
+             unsigned mask,
+             uint64_t *c_primitives)
+{
+   unsigned i;
+
+   for (i = 0; i < rast->num_prims; i++) {
+      const struct sp_rast_prim *prim = &rast->prims[i];
+      const unsigned first_task = prim->tasks & ~(prim->tasks - 1);
+
+      if (!(prim->tasks & mask))
+         continue;
+
+      sp_setup_set_primitive_counter(setup, (first_task & mask) ?
+                                     c_primitives : NULL);
+
+      switch (prim->nr_verts) {
+      case 3:
+         sp_setup_tri(setup, prim->v[0], prim->v[1], prim->v[2]);
+         break;
+      case 2:
+         sp_setup_line(setup, prim->v[0], prim->v[1]);
+         break;
+      default:
+         sp_setup_point(setup, prim->v[0]);
+         break;
+      }
+   }
+}
+
+
+static void
+task_render(void *data, int thread_index)
+{
+   struct sp_rast_task *task = (struct sp_rast_task *) data;
+
+   render_prims(task->rast, task->setup, 1u << task->index,
+                &task->c_primitives);
+}
+
+
+static void
+task_flush(void *data, int thread_index)
+{
+   struct sp_rast_task *task = (struct sp_rast_task *) data;
+   const struct softpipe_context *sp = task->rast->softpipe;
+   unsigned i;
+
+   for (i = 0; i < sp->framebuffer.nr_cbufs; i++)
+      sp_flush_tile_cache(task->cbuf_cache[i]);
+
+   sp_flush_tile_cache(task->zsbuf_cache);
+}
+
+
+/**
+ * Run func for every task, the first one on the calling thread, and wait
+ * for all of them.
+ */
+static void
+run_tasks(struct sp_rast *rast, util_queue_execute_func func)
+{
+   unsigned i;
+
+   for (i = 1; i < rast->num_tasks; i++) {
+      util_queue_add_job(&rast->queue, &rast->tasks[i], &rast->tasks[i].fence,
+                         func, NULL);
+   }
+
+   func(&rast->tasks[0], 0);
+
+   for (i = 1; i < rast->num_tasks; i++)
+      util_queue_fence_wait(&rast->tasks[i].fence);
+}
+
+
+/**
+ * Render the binned primitives, and wait until they're done.
+ */
+void
+sp_rast_render(struct sp_rast *rast)
+{
+   struct softpipe_context *sp = rast->softpipe;
+   unsigned i;
+
+   if (!rast->num_prims)
+      return;
+
+   for (i = 0; i < rast->num_tasks; i++)
+      task_prepare(rast, &rast->tasks[i]);
+
+   if (needs_serial_render(rast)) {
+      sp_setup_prepare(rast->serial_setup);
+      render_prims(rast, rast->serial_setup, ~0u,
+                   &rast->tasks[0].c_primitives);
+   }
+   else {
+      for (i = 0; i < rast->num_tasks; i++)
+         sp_setup_prepare(rast->tasks[i].setup);
+      run_tasks(rast, task_render);
+   }
+
+   for (i = 0; i < rast->num_tasks; i++) {
+      struct sp_rast_task *task = &rast->tasks[i];
+
+      sp->occlusion_count += task->occlusion_count;
+      sp->pipeline_statistics.ps_invocations += task->ps_invocations;
+      sp->pipeline_statistics.c_primitives += task->c_primitives;
+      task->occlusion_count = 0;
+      task->ps_invocations = 0;
+      task->c_primitives = 0;
+   }
+
+   rast->num_prims = 0;
+}
+
+
+/**
+ * Render anything binned, then write the tasks' render tile caches back
+ * to the surfaces and, if textures is set, drop their texture caches.
+ */
+void
+sp_rast_flush(struct sp_rast *rast, boolean textures)
+{
+   unsigned i, j;
+
+   sp_rast_render(rast);
+
+   if (textures) {
+      for (i = 0; i < rast->num_tasks; i++) {
+         struct sp_rast_task *task = &rast->tasks[i];
+
+         for (j = 0; j < ARRAY_SIZE(task->tex_cache); j++)
+            sp_flush_tex_tile_cache(task->tex_cache[j]);
+      }
+   }
+
+   run_tasks(rast, task_flush);
+}
+
+
+/**
+ * Flush the tasks' tile caches of surfaces being unbound, and bind the new
+ * ones.
+ */
+void
+sp_rast_set_framebuffer(struct sp_rast *rast,
+                        const struct pipe_framebuffer_state *fb)
+{
+   unsigned i, j;
+
+   sp_rast_render(rast);
+
+   for (i = 0; i < rast->num_tasks; i++) {
+      struct sp_rast_task *task = &rast->tasks[i];
+
+      for (j = 0; j < PIPE_MAX_COLOR_BUFS; j++) {
+         struct pipe_surface *cb = j < fb->nr_cbufs ? fb->cbufs[j] : NULL;
+
+         if (sp_tile_cache_get_surface(task->cbuf_cache[j]) != cb) {
+            sp_flush_tile_cache(task->cbuf_cache[j]);
+            sp_tile_cache_set_surface(task->cbuf_cache[j], cb);
+         }
+      }
+
+      if (sp_tile_cache_get_surface(task->zsbuf_cache) != fb->zsbuf) {
+         sp_flush_tile_cache(task->zsbuf_cache);
+         sp_tile_cache_set_surface(task->zsbuf_cache, fb->zsbuf);
+      }
+   }
+}
+
+
+void
+sp_rast_clear_cbuf(struct sp_rast *rast,
+                   unsigned cbuf,
+                   const union pipe_color_union *color)
+{
+   unsigned i;
+
+   sp_rast_render(rast);
+
+   for (i = 0; i < rast->num_tasks; i++)
+      sp_tile_cache_clear(rast->tasks[i].cbuf_cache[cbuf], color, 0);
+}
+
+
+void
+sp_rast_clear_zsbuf(struct sp_rast *rast, uint64_t clear_value)
+{
+   static const union pipe_color_union zero;
+   unsigned i;
+
+   sp_rast_render(rast);
+
+   for (i = 0; i < rast->num_tasks; i++)
+      sp_tile_cache_clear(rast->tasks[i].zsbuf_cache, &zero, clear_value);
+}
+
+
+/**
+ * Unbind a fragment shader variant about to be deleted from the tasks'
+ * interpreters.
+ */
+void
+sp_rast_release_fs_variant(struct sp_rast *rast,
+                           const struct sp_fragment_shader_variant *var)
+{
+   unsigned i;
+
+   for (i = 0; i < rast->num_tasks; i++) {
+      struct sp_rast_task *task = &rast->tasks[i];
+
+      if (task->fs_variant == var) {
+         tgsi_exec_machine_bind_shader(task->fs_machine, NULL, NULL, NULL, NULL);
+         task->fs_variant = NULL;
+      }
+   }
+}
+
+
+static boolean
+task_init(struct sp_rast *rast, struct sp_rast_task *task, unsigned index)
+{
+   struct softpipe_context *sp = rast->softpipe;
+   uint64_t entry_mask = 0;
+   unsigned i;
+
+   task->rast = rast;
+   task->index = index;
+   util_queue_fence_init(&task->fence);
+
+   for (i = 0; i < NUM_ENTRIES; i++) {
+      if (rast->entry_tasks[i] & (1u << index))
+         entry_mask |= 1ull << i;
+   }
+
+   for (i = 0; i < PIPE_MAX_COLOR_BUFS; i++) {
+      task->cbuf_cache[i] = sp_create_tile_cache(&sp->pipe);
+      if (!task->cbuf_cache[i])
+         return FALSE;
+      task->cbuf_cache[i]->entry_mask = entry_mask;
+   }
+
+   task->zsbuf_cache = sp_create_tile_cache(&sp->pipe);
+   if (!task->zsbuf_cache)
+      return FALSE;
+   task->zsbuf_cache->entry_mask = entry_mask;
+
+   for (i = 0; i < ARRAY_SIZE(task->tex_cache); i++) {
+      task->tex_cache[i] = sp_create_tex_tile_cache(&sp->pipe);
+      if (!task->tex_cache[i])
+         return FALSE;
+   }
+
+   task->sampler = sp_create_tgsi_sampler();
+   if (!task->sampler)
+      return FALSE;
+
+   task->fs_machine = tgsi_exec_machine_create(PIPE_SHADER_FRAGMENT);
+   if (!task->fs_machine)
+      return FALSE;
+
+   if (!sp_create_quad_pipeline(sp, &task->quad))
+      return FALSE;
+
+   task->quad.fs_machine = task->fs_machine;
+   task->quad.cbuf_cache = task->cbuf_cache;
+   task->quad.zsbuf_cache = task->zsbuf_cache;
+   task->quad.occlusion_count = &task->occlusion_count;
+   task->quad.ps_invocations = &task->ps_invocations;
+
+   task->setup = sp_setup_create_context(sp, NULL);
+   if (!task->setup)
+      return FALSE;
+
+   for (i = 0; i < NUM_ENTRIES; i++) {
+      sp_setup_set_tile_quad(task->setup, i,
+                             (entry_mask & (1ull << i)) ? &task->quad : NULL);
+   }
+
+   return TRUE;
+}
+
+
+static void
+task_destroy(struct sp_rast_task *task)
+{
+   unsigned i;
+
+   if (task->setup)
+      sp_setup_destroy_context(task->setup);
+
+   sp_destroy_quad_pipeline(&task->quad);
+   tgsi_exec_machine_destroy(task->fs_machine);
+   FREE(task->sampler);
+
+   for (i = 0; i < ARRAY_SIZE(task->tex_cache); i++) {
+      if (task->tex_cache[i]) {
+         /* drop the texture reference */
+         sp_tex_tile_cache_set_sampler_view(task->tex_cache[i], NULL);
+         sp_destroy_tex_tile_cache(task->tex_cache[i]);
+      }
+   }
+
+   for (i = 0; i < PIPE_MAX_COLOR_BUFS; i++)
+      sp_destroy_tile_cache(task->cbuf_cache[i]);
+   sp_destroy_tile_cache(task->zsbuf_cache);
+
+   util_queue_fence_destroy(&task->fence);
+}
+
+
+/**
+ * Create the rasterizer threads.  num_threads counts the calling thread.
+ */
+struct sp_rast *
+sp_rast_create(struct softpipe_context *sp, unsigned num_threads)
+{
+   struct sp_rast *rast;
+   unsigned i;
+
+   assert(num_threads > 1 && num_threads <= SP_MAX_RAST_THREADS);
+
+   rast = CALLOC_STRUCT(sp_rast);
+   if (!rast)
+      return NULL;
+
+   rast->softpipe = sp;
+
+   for (i = 0; i < NUM_ENTRIES; i++)
+      rast->entry_tasks[i] = 1u << (i % num_threads);
+
+   rast->vertex_size = SP_RAST_VERTEX_BUFFER_SIZE;
+   rast->vertices = align_malloc(rast->vertex_size, 16);
+   if (!rast->vertices)
+      goto fail;
+
+   for (i = 0; i < num_threads; i++) {
+      /* counted before init, so that a partly initialized task is freed */
+      rast->num_tasks = i + 1;
+      if (!task_init(rast, &rast->tasks[i], i))
+         goto fail;
+   }
+
+   rast->serial_setup = sp_setup_create_context(sp, NULL);
+   if (!rast->serial_setup)
+      goto fail;
+
+   for (i = 0; i < NUM_ENTRIES; i++) {
+      sp_setup_set_tile_quad(rast->serial_setup, i,
+                             &rast->tasks[i % num_threads].quad);
+   }
+
+   if (!util_queue_init(&rast->queue, "sp_rast", SP_MAX_RAST_THREADS,
+                        num_threads - 1, 0))
+      goto fail;
+
+   return rast;
+
+fail:
+   sp_rast_destroy(rast);
+   return NULL;
+}
+
+
+void
+sp_rast_destroy(struct sp_rast *rast)
+{
+   unsigned i;
+
+   if (util_queue_is_initialized(&rast->queue))
+      util_queue_destroy(&rast->queue);
+
+   if (rast->serial_setup)
+      sp_setup_destroy_context(rast->serial_setup);
+
+   for (i = 0; i < rast->num_tasks; i++)
+      task_destroy(&rast->tasks[i]);
+
+   align_free(rast->vertices);
+   FREE(rast);
+}
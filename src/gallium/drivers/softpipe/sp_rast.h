@@ -0,0 +1,96 @@
+/**************************************************************************
+ *
+ * Copyright 2007 VMware, Inc.
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+/* Binned rasterization on worker threads, see sp_rast.c */
+
+#ifndef SP_RAST_H
+#define SP_RAST_H
+
+#include "pipe/p_compiler.h"
+
+
+/** Upper limit for SOFTPIPE_NUM_THREADS */
+#define SP_MAX_RAST_THREADS 16
+
+
+struct softpipe_context;
+struct sp_fragment_shader_variant;
+struct sp_rast;
+struct pipe_framebuffer_state;
+union pipe_color_union;
+
+
+struct sp_rast *
+sp_rast_create(struct softpipe_context *sp, unsigned num_threads);
+
+void
+sp_rast_destroy(struct sp_rast *rast);
+
+const void *
+sp_rast_copy_vertices(struct sp_rast *rast,
+                      const void *vertices,
+                      unsigned size);
+
+void
+sp_rast_bin_tri(struct sp_rast *rast,
+                const float (*v0)[4],
+                const float (*v1)[4],
+                const float (*v2)[4]);
+
+void
+sp_rast_bin_line(struct sp_rast *rast,
+                 const float (*v0)[4],
+                 const float (*v1)[4]);
+
+void
+sp_rast_bin_point(struct sp_rast *rast,
+                  const float (*v0)[4]);
+
+void
+sp_rast_render(struct sp_rast *rast);
+
+void
+sp_rast_flush(struct sp_rast *rast, boolean textures);
+
+void
+sp_rast_set_framebuffer(struct sp_rast *rast,
+                        const struct pipe_framebuffer_state *fb);
+
+void
+sp_rast_clear_cbuf(struct sp_rast *rast,
+                   unsigned cbuf,
+                   const union pipe_color_union *color);
+
+void
+sp_rast_clear_zsbuf(struct sp_rast *rast, uint64_t clear_value);
+
+void
+sp_rast_release_fs_variant(struct sp_rast *rast,
+                           const struct sp_fragment_shader_variant *var);
+
+
+#endif /* SP_RAST_H */
@@ -35,8 +35,10 @@
 #include "sp_context.h"
 #include "sp_quad.h"
 #include "sp_quad_pipe.h"
+#include "sp_rast.h"
 #include "sp_setup.h"
 #include "sp_state.h"
+#include "sp_tile_cache.h"
 #include "draw/draw_context.h"
 #include "pipe/p_shader_tokens.h"
 #include "util/u_math.h"
@@ -113,6 +115,19 @@ struct setup_context {
 
    unsigned cull_face;		/* which faces cull */
    unsigned nr_vertex_attrs;
+
+   /**
+    * Quad pipeline that renders each tile, indexed by the tile's render
+    * cache entry (see sp_tile_cache_pos()).  NULL for the tiles of other
+    * rasterizer threads.
+    */
+   struct sp_quad_pipeline *tile_quad[NUM_ENTRIES];
+
+   /** Where to count the triangles for statistics queries, may be NULL */
+   uint64_t *c_primitives;
+
+   /** If set, primitives are binned for the rasterizer threads */
+   struct sp_rast *rast;
 };
 
 
@@ -121,6 +136,17 @@ struct setup_context {
 
 
 
+/**
+ * Return the quad pipeline that renders the tile containing (x, y), or NULL
+ * if the tile belongs to another rasterizer thread.
+ */
+static inline struct sp_quad_pipeline *
+tile_quad(const struct setup_context *setup, int x, int y, unsigned layer)
+{
+   return setup->tile_quad[sp_tile_cache_pos(tile_address(x, y, layer))];
+}
+
+
 /**
  * Clip setup->quad against the scissor/surface bounds.
  */
@@ -162,13 +188,17 @@ clip_emit_quad(struct setup_context *setup, struct quad_header *quad)
    quad_clip(setup, quad);
 
    if (quad->inout.mask) {
-      struct softpipe_context *sp = setup->softpipe;
+      struct sp_quad_pipeline *pipeline =
+         tile_quad(setup, quad->input.x0, quad->input.y0, quad->input.layer);
+
+      if (!pipeline)
+         return;
 
 #if DEBUG_FRAGS
       setup->numFragsEmitted += util_bitcount(quad->inout.mask);
 #endif
 
-      sp->quad.first->run( sp->quad.first, &quad, 1 );
+      pipeline->first->run( pipeline->first, &quad, 1 );
    }
 }
 
@@ -203,7 +233,6 @@ flush_spans(struct setup_context *setup)
    const int xleft1 = setup->span.left[1];
    const int xright0 = setup->span.right[0];
    const int xright1 = setup->span.right[1];
-   struct quad_stage *pipe = setup->softpipe->quad.first;
 
    const int minleft = block_x(MIN2(xleft0, xleft1));
    const int maxright = MAX2(xright0, xright1);
@@ -230,6 +259,15 @@ flush_spans(struct setup_context *setup)
       unsigned mask1 = ~skipmask_left1 & ~skipmask_right1;
 
       if (mask0 | mask1) {
+         /* a chunk never straddles two tiles */
+         struct sp_quad_pipeline *pipeline =
+            tile_quad(setup, x, setup->span.y, setup->quad[0].input.layer);
+         struct quad_stage *pipe;
+
+         if (!pipeline)
+            continue;
+
+         pipe = pipeline->first;
          do {
             unsigned quadmask = (mask0 & 3) | ((mask1 & 3) << 2);
             if (quadmask) {
@@ -821,7 +859,12 @@ sp_setup_tri(struct setup_context *setup,
 
    if (setup->softpipe->no_rast || setup->softpipe->rasterizer->rasterizer_discard)
       return;
-   
+
+   if (setup->rast) {
+      sp_rast_bin_tri(setup->rast, v0, v1, v2);
+      return;
+   }
+
    det = calc_det(v0, v1, v2);
    /*
    debug_printf("%s\n", __FUNCTION__ );
@@ -873,8 +916,8 @@ sp_setup_tri(struct setup_context *setup,
 
    flush_spans( setup );
 
-   if (setup->softpipe->active_statistics_queries) {
-      setup->softpipe->pipeline_statistics.c_primitives++;
+   if (setup->softpipe->active_statistics_queries && setup->c_primitives) {
+      (*setup->c_primitives)++;
    }
 
 #if DEBUG_FRAGS
@@ -1110,6 +1153,11 @@ sp_setup_line(struct setup_context *setup,
    if (dx == 0 && dy == 0)
       return;
 
+   if (setup->rast) {
+      sp_rast_bin_line(setup->rast, v0, v1);
+      return;
+   }
+
    if (!setup_line_coefficients(setup, v0, v1))
       return;
 
@@ -1254,6 +1302,11 @@ sp_setup_point(struct setup_context *setup,
    if (setup->softpipe->no_rast || setup->softpipe->rasterizer->rasterizer_discard)
       return;
 
+   if (setup->rast) {
+      sp_rast_bin_point(setup->rast, v0);
+      return;
+   }
+
    assert(setup->softpipe->reduced_prim == PIPE_PRIM_POINTS);
 
    if (setup->softpipe->layer_slot > 0) {
@@ -1478,7 +1531,13 @@ sp_setup_prepare(struct setup_context *setup)
 
    setup->max_layer = max_layer;
 
-   sp->quad.first->begin( sp->quad.first );
+   for (i = 0; i < ARRAY_SIZE(setup->tile_quad); i++) {
+      struct sp_quad_pipeline *quad = setup->tile_quad[i];
+
+      /* begin() is cheap and may be repeated, skip the common duplicates */
+      if (quad && (i == 0 || quad != setup->tile_quad[i - 1]))
+         quad->first->begin( quad->first );
+   }
 
    if (sp->reduced_api_prim == PIPE_PRIM_TRIANGLES &&
        sp->rasterizer->fill_front == PIPE_POLYGON_MODE_FILL &&
@@ -1500,16 +1559,53 @@ sp_setup_destroy_context(struct setup_context *setup)
 }
 
 
+/**
+ * Set the quad pipeline which renders the tiles mapping to the given
+ * render cache entry, or NULL to skip those tiles.
+ */
+void
+sp_setup_set_tile_quad(struct setup_context *setup,
+                       unsigned entry,
+                       struct sp_quad_pipeline *quad)
+{
+   assert(entry < ARRAY_SIZE(setup->tile_quad));
+   setup->tile_quad[entry] = quad;
+}
+
+
+/**
+ * Set where triangles are counted for pipeline statistics queries.
+ */
+void
+sp_setup_set_primitive_counter(struct setup_context *setup,
+                               uint64_t *c_primitives)
+{
+   setup->c_primitives = c_primitives;
+}
+
+
 /**
  * Create a new primitive setup/render stage.
+ * If rast is given, primitives are binned for its threads instead of
+ * being rendered.
  */
 struct setup_context *
-sp_setup_create_context(struct softpipe_context *softpipe)
+sp_setup_create_context(struct softpipe_context *softpipe,
+                        struct sp_rast *rast)
 {
    struct setup_context *setup = CALLOC_STRUCT(setup_context);
    unsigned i;
 
+   if (!setup)
+      return NULL;
+
    setup->softpipe = softpipe;
+   setup->rast = rast;
+   setup->c_primitives = &softpipe->pipeline_statistics.c_primitives;
+
+   for (i = 0; i < ARRAY_SIZE(setup->tile_quad); i++) {
+      setup->tile_quad[i] = &softpipe->quad;
+   }
 
    for (i = 0; i < MAX_QUADS; i++) {
       setup->quad[i].coef = setup->coef;
@@ -29,6 +29,8 @@
 
 struct setup_context;
 struct softpipe_context;
+struct sp_quad_pipeline;
+struct sp_rast;
 
 /**
  * Attribute interpolation mode
@@ -70,8 +72,15 @@ sp_clamp_viewport_idx(int idx)
    return (PIPE_MAX_VIEWPORTS > idx && idx >= 0) ? idx : 0;
 }
 
-struct setup_context *sp_setup_create_context( struct softpipe_context *softpipe );
+struct setup_context *sp_setup_create_context( struct softpipe_context *softpipe,
+                                              struct sp_rast *rast );
 void sp_setup_prepare( struct setup_context *setup );
 void sp_setup_destroy_context( struct setup_context *setup );
 
+void sp_setup_set_tile_quad( struct setup_context *setup,
+                             unsigned entry,
+                             struct sp_quad_pipeline *quad );
+void sp_setup_set_primitive_counter( struct setup_context *setup,
+                                     uint64_t *c_primitives );
+
 #endif
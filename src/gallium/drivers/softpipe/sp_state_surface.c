@@ -29,6 +29,7 @@
  */
 
 #include "sp_context.h"
+#include "sp_rast.h"
 #include "sp_state.h"
 #include "sp_tile_cache.h"
 
@@ -53,6 +54,10 @@ softpipe_set_framebuffer_state(struct pipe_context *pipe,
 
    draw_flush(sp->draw);
 
+   /* before the old surfaces may be released */
+   if (sp->rast)
+      sp_rast_set_framebuffer(sp->rast, fb);
+
    for (i = 0; i < PIPE_MAX_COLOR_BUFS; i++) {
       struct pipe_surface *cb = i < fb->nr_cbufs ? fb->cbufs[i] : NULL;
 
@@ -42,16 +42,6 @@ static struct softpipe_cached_tile *
 sp_alloc_tile(struct softpipe_tile_cache *tc);
 
 
-/**
- * Return the position in the cache for the tile that contains win pos (x,y).
- * We currently use a direct mapped cache so this is like a hack key.
- * At some point we should investige something more sophisticated, like
- * a LRU replacement policy.
- */
-#define CACHE_POS(x, y, l)                        \
-   (((x) + (y) * 5 + (l) * 10) % NUM_ENTRIES)
-
-
 static inline int addr_to_clear_pos(union tile_address addr)
 {
    int pos;
@@ -104,6 +94,8 @@ sp_create_tile_cache( struct pipe_context *pipe )
 
    STATIC_ASSERT((TILE_SIZE << TILE_ADDR_BITS) >= MAX_WIDTH);
 
+   STATIC_ASSERT(NUM_ENTRIES <= 64);
+
    tc = CALLOC_STRUCT( softpipe_tile_cache );
    if (tc) {
       tc->pipe = pipe;
@@ -111,6 +103,7 @@ sp_create_tile_cache( struct pipe_context *pipe )
          tc->tile_addrs[pos].bits.invalid = 1;
       }
       tc->last_tile_addr.bits.invalid = 1;
+      tc->entry_mask = (1ull << NUM_ENTRIES) - 1;
 
       /* this allocation allows us to guarantee that allocation
        * failures are never fatal later
@@ -362,6 +355,9 @@ sp_tile_cache_flush_clear(struct softpipe_tile_cache *tc, int layer)
       for (x = 0; x < w; x += TILE_SIZE) {
          union tile_address addr = tile_address(x, y, layer);
 
+         if (!(tc->entry_mask & (1ull << sp_tile_cache_pos(addr))))
+            continue;
+
          if (is_clear_flag_set(tc->clear_flags, addr, tc->clear_flags_size)) {
             /* write the scratch tile to the surface */
             if (tc->depth_stencil) {
@@ -518,10 +514,11 @@ sp_find_cached_tile(struct softpipe_tile_cache *tc,
 {
    struct pipe_transfer *pt;
    /* cache pos/entry: */
-   const int pos = CACHE_POS(addr.bits.x,
-                             addr.bits.y, addr.bits.layer);
+   const int pos = sp_tile_cache_pos(addr);
    struct softpipe_cached_tile *tile = tc->entries[pos];
    int layer;
+   assert(tc->entry_mask & (1ull << pos));
+
    if (!tile) {
       tile = sp_alloc_tile(tc);
       tc->entries[pos] = tile;
@@ -99,6 +99,13 @@ struct softpipe_tile_cache
 
    union tile_address last_tile_addr;
    struct softpipe_cached_tile *last_tile;  /**< most recently retrieved tile */
+
+   /**
+    * Cache entries whose tiles this cache owns, one bit per entry.  When
+    * the rasterizer threads of sp_rast.c share a surface, each one only
+    * writes back the cleared tiles it owns.
+    */
+   uint64_t entry_mask;
 };
 
 
@@ -141,6 +148,17 @@ tile_address( unsigned x,
    return addr;
 }
 
+/**
+ * Return the cache entry for the given tile.  The cache is direct mapped,
+ * so this is like a hash key.
+ */
+static inline unsigned
+sp_tile_cache_pos(union tile_address addr)
+{
+   return (addr.bits.x + addr.bits.y * 5 + addr.bits.layer * 10) % NUM_ENTRIES;
+}
+
+
 /* Quickly retrieve tile if it matches last lookup.
  */
 static inline struct softpipe_cached_tile *
@@ -67,17 +67,17 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("swr_context.h", ".");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("width", 67));
-            dbgMembers.push_back(std::make_pair("height", 68));
-            dbgMembers.push_back(std::make_pair("depth", 69));
-            dbgMembers.push_back(std::make_pair("first_level", 70));
-            dbgMembers.push_back(std::make_pair("last_level", 71));
-            dbgMembers.push_back(std::make_pair("base_ptr", 72));
-            dbgMembers.push_back(std::make_pair("row_stride", 73));
-            dbgMembers.push_back(std::make_pair("img_stride", 74));
-            dbgMembers.push_back(std::make_pair("mip_offsets", 75));
+            dbgMembers.push_back(std::make_pair("width", 72));
+            dbgMembers.push_back(std::make_pair("height", 73));
+            dbgMembers.push_back(std::make_pair("depth", 74));
+            dbgMembers.push_back(std::make_pair("first_level", 75));
+            dbgMembers.push_back(std::make_pair("last_level", 76));
+            dbgMembers.push_back(std::make_pair("base_ptr", 77));
+            dbgMembers.push_back(std::make_pair("row_stride", 78));
+            dbgMembers.push_back(std::make_pair("img_stride", 79));
+            dbgMembers.push_back(std::make_pair("mip_offsets", 80));
             
-            pJitMgr->CreateDebugStructType(pRetType, "swr_jit_texture", pFile, 66, dbgMembers);
+            pJitMgr->CreateDebugStructType(pRetType, "swr_jit_texture", pFile, 71, dbgMembers);
 
         }
 
@@ -116,12 +116,12 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("swr_context.h", ".");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("min_lod", 79));
-            dbgMembers.push_back(std::make_pair("max_lod", 80));
-            dbgMembers.push_back(std::make_pair("lod_bias", 81));
-            dbgMembers.push_back(std::make_pair("border_color", 82));
+            dbgMembers.push_back(std::make_pair("min_lod", 84));
+            dbgMembers.push_back(std::make_pair("max_lod", 85));
+            dbgMembers.push_back(std::make_pair("lod_bias", 86));
+            dbgMembers.push_back(std::make_pair("border_color", 87));
             
-            pJitMgr->CreateDebugStructType(pRetType, "swr_jit_sampler", pFile, 78, dbgMembers);
+            pJitMgr->CreateDebugStructType(pRetType, "swr_jit_sampler", pFile, 83, dbgMembers);
 
         }
 
@@ -149,13 +149,23 @@ namespace SwrJit
             /* num_constantsFS  */ members.push_back(ArrayType::get(Type::getInt32Ty(ctx), PIPE_MAX_CONSTANT_BUFFERS));
             /* constantGS       */ members.push_back(ArrayType::get(PointerType::get(Type::getFloatTy(ctx), 0), PIPE_MAX_CONSTANT_BUFFERS));
             /* num_constantsGS  */ members.push_back(ArrayType::get(Type::getInt32Ty(ctx), PIPE_MAX_CONSTANT_BUFFERS));
+            /* constantTCS      */ members.push_back(ArrayType::get(PointerType::get(Type::getFloatTy(ctx), 0), PIPE_MAX_CONSTANT_BUFFERS));
+            /* num_constantsTCS */ members.push_back(ArrayType::get(Type::getInt32Ty(ctx), PIPE_MAX_CONSTANT_BUFFERS));
+            /* constantTES      */ members.push_back(ArrayType::get(PointerType::get(Type::getFloatTy(ctx), 0), PIPE_MAX_CONSTANT_BUFFERS));
+            /* num_constantsTES */ members.push_back(ArrayType::get(Type::getInt32Ty(ctx), PIPE_MAX_CONSTANT_BUFFERS));
             /* texturesVS       */ members.push_back(ArrayType::get(Gen_swr_jit_texture(pJitMgr), PIPE_MAX_SHADER_SAMPLER_VIEWS));
             /* samplersVS       */ members.push_back(ArrayType::get(Gen_swr_jit_sampler(pJitMgr), PIPE_MAX_SAMPLERS));
             /* texturesFS       */ members.push_back(ArrayType::get(Gen_swr_jit_texture(pJitMgr), PIPE_MAX_SHADER_SAMPLER_VIEWS));
             /* samplersFS       */ members.push_back(ArrayType::get(Gen_swr_jit_sampler(pJitMgr), PIPE_MAX_SAMPLERS));
             /* texturesGS       */ members.push_back(ArrayType::get(Gen_swr_jit_texture(pJitMgr), PIPE_MAX_SHADER_SAMPLER_VIEWS));
             /* samplersGS       */ members.push_back(ArrayType::get(Gen_swr_jit_sampler(pJitMgr), PIPE_MAX_SAMPLERS));
+            /* texturesTCS      */ members.push_back(ArrayType::get(Gen_swr_jit_texture(pJitMgr), PIPE_MAX_SHADER_SAMPLER_VIEWS));
+            /* samplersTCS      */ members.push_back(ArrayType::get(Gen_swr_jit_sampler(pJitMgr), PIPE_MAX_SAMPLERS));
+            /* texturesTES      */ members.push_back(ArrayType::get(Gen_swr_jit_texture(pJitMgr), PIPE_MAX_SHADER_SAMPLER_VIEWS));
+            /* samplersTES      */ members.push_back(ArrayType::get(Gen_swr_jit_sampler(pJitMgr), PIPE_MAX_SAMPLERS));
             /* userClipPlanes   */ members.push_back(ArrayType::get(ArrayType::get(Type::getFloatTy(ctx), 4), PIPE_MAX_CLIP_PLANES));
+            /* defaultTessOuter */ members.push_back(ArrayType::get(Type::getFloatTy(ctx), 4));
+            /* defaultTessInner */ members.push_back(ArrayType::get(Type::getFloatTy(ctx), 2));
             /* polyStipple      */ members.push_back(ArrayType::get(Type::getInt32Ty(ctx), 32));
             /* renderTargets    */ members.push_back(ArrayType::get(Gen_SWR_SURFACE_STATE(pJitMgr), SWR_NUM_ATTACHMENTS));
             /* swr_query_result */ members.push_back(PointerType::get(Type::getInt32Ty(ctx), 0));
@@ -168,25 +178,35 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("swr_context.h", ".");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("constantVS", 86));
-            dbgMembers.push_back(std::make_pair("num_constantsVS", 87));
-            dbgMembers.push_back(std::make_pair("constantFS", 88));
-            dbgMembers.push_back(std::make_pair("num_constantsFS", 89));
-            dbgMembers.push_back(std::make_pair("constantGS", 90));
-            dbgMembers.push_back(std::make_pair("num_constantsGS", 91));
-            dbgMembers.push_back(std::make_pair("texturesVS", 93));
-            dbgMembers.push_back(std::make_pair("samplersVS", 94));
-            dbgMembers.push_back(std::make_pair("texturesFS", 95));
-            dbgMembers.push_back(std::make_pair("samplersFS", 96));
-            dbgMembers.push_back(std::make_pair("texturesGS", 97));
-            dbgMembers.push_back(std::make_pair("samplersGS", 98));
-            dbgMembers.push_back(std::make_pair("userClipPlanes", 100));
-            dbgMembers.push_back(std::make_pair("polyStipple", 102));
-            dbgMembers.push_back(std::make_pair("renderTargets", 104));
-            dbgMembers.push_back(std::make_pair("swr_query_result", 105));
-            dbgMembers.push_back(std::make_pair("pAPI", 106));
+            dbgMembers.push_back(std::make_pair("constantVS", 91));
+            dbgMembers.push_back(std::make_pair("num_constantsVS", 92));
+            dbgMembers.push_back(std::make_pair("constantFS", 93));
+            dbgMembers.push_back(std::make_pair("num_constantsFS", 94));
+            dbgMembers.push_back(std::make_pair("constantGS", 95));
+            dbgMembers.push_back(std::make_pair("num_constantsGS", 96));
+            dbgMembers.push_back(std::make_pair("constantTCS", 97));
+            dbgMembers.push_back(std::make_pair("num_constantsTCS", 98));
+            dbgMembers.push_back(std::make_pair("constantTES", 99));
+            dbgMembers.push_back(std::make_pair("num_constantsTES", 100));
+            dbgMembers.push_back(std::make_pair("texturesVS", 102));
+            dbgMembers.push_back(std::make_pair("samplersVS", 103));
+            dbgMembers.push_back(std::make_pair("texturesFS", 104));
+            dbgMembers.push_back(std::make_pair("samplersFS", 105));
+            dbgMembers.push_back(std::make_pair("texturesGS", 106));
+            dbgMembers.push_back(std::make_pair("samplersGS", 107));
+            dbgMembers.push_back(std::make_pair("texturesTCS", 108));
+            dbgMembers.push_back(std::make_pair("samplersTCS", 109));
+            dbgMembers.push_back(std::make_pair("texturesTES", 110));
+            dbgMembers.push_back(std::make_pair("samplersTES", 111));
+            dbgMembers.push_back(std::make_pair("userClipPlanes", 113));
+            dbgMembers.push_back(std::make_pair("defaultTessOuter", 116));
+            dbgMembers.push_back(std::make_pair("defaultTessInner", 117));
+            dbgMembers.push_back(std::make_pair("polyStipple", 119));
+            dbgMembers.push_back(std::make_pair("renderTargets", 121));
+            dbgMembers.push_back(std::make_pair("swr_query_result", 122));
+            dbgMembers.push_back(std::make_pair("pAPI", 123));
             
-            pJitMgr->CreateDebugStructType(pRetType, "swr_draw_context", pFile, 85, dbgMembers);
+            pJitMgr->CreateDebugStructType(pRetType, "swr_draw_context", pFile, 90, dbgMembers);
 
         }
 
@@ -199,17 +219,27 @@ namespace SwrJit
     static const uint32_t swr_draw_context_num_constantsFS  = 3;
     static const uint32_t swr_draw_context_constantGS       = 4;
     static const uint32_t swr_draw_context_num_constantsGS  = 5;
-    static const uint32_t swr_draw_context_texturesVS       = 6;
-    static const uint32_t swr_draw_context_samplersVS       = 7;
-    static const uint32_t swr_draw_context_texturesFS       = 8;
-    static const uint32_t swr_draw_context_samplersFS       = 9;
-    static const uint32_t swr_draw_context_texturesGS       = 10;
-    static const uint32_t swr_draw_context_samplersGS       = 11;
-    static const uint32_t swr_draw_context_userClipPlanes   = 12;
-    static const uint32_t swr_draw_context_polyStipple      = 13;
-    static const uint32_t swr_draw_context_renderTargets    = 14;
-    static const uint32_t swr_draw_context_swr_query_result = 15;
-    static const uint32_t swr_draw_context_pAPI             = 16;
+    static const uint32_t swr_draw_context_constantTCS      = 6;
+    static const uint32_t swr_draw_context_num_constantsTCS = 7;
+    static const uint32_t swr_draw_context_constantTES      = 8;
+    static const uint32_t swr_draw_context_num_constantsTES = 9;
+    static const uint32_t swr_draw_context_texturesVS       = 10;
+    static const uint32_t swr_draw_context_samplersVS       = 11;
+    static const uint32_t swr_draw_context_texturesFS       = 12;
+    static const uint32_t swr_draw_context_samplersFS       = 13;
+    static const uint32_t swr_draw_context_texturesGS       = 14;
+    static const uint32_t swr_draw_context_samplersGS       = 15;
+    static const uint32_t swr_draw_context_texturesTCS      = 16;
+    static const uint32_t swr_draw_context_samplersTCS      = 17;
+    static const uint32_t swr_draw_context_texturesTES      = 18;
+    static const uint32_t swr_draw_context_samplersTES      = 19;
+    static const uint32_t swr_draw_context_userClipPlanes   = 20;
+    static const uint32_t swr_draw_context_defaultTessOuter = 21;
+    static const uint32_t swr_draw_context_defaultTessInner = 22;
+    static const uint32_t swr_draw_context_polyStipple      = 23;
+    static const uint32_t swr_draw_context_renderTargets    = 24;
+    static const uint32_t swr_draw_context_swr_query_result = 25;
+    static const uint32_t swr_draw_context_pAPI             = 26;
 
 } // ns SwrJit
 
@@ -0,0 +1,417 @@
+/****************************************************************************
+* Copyright (C) 2018 Intel Corporation.   All Rights Reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice (including the next
+* paragraph) shall be included in all copies or substantial portions of the
+* Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* @file ar_trace.cpp
+*
+* @brief Converts ArchRast event files to trace-event JSON, viewable in
+*        chrome://tracing or Perfetto.  Each event file becomes a thread.
+*        Begin/end events form the timeline and are only present when the
+*        driver ran with KNOB_AR_ENABLE_TIMELINE.  All other events are
+*        shown as instant events carrying their fields.
+*
+******************************************************************************/
+
+#include "gen_ar_eventdesc.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+using namespace ArchRast;
+
+struct EventFile
+{
+    std::string name;
+    std::vector<uint8_t> data;
+    uint32_t pid;
+    uint32_t tid;
+};
+
+struct EventRecord
+{
+    uint32_t file;
+    uint32_t eventId;
+    const uint8_t* pData;
+    uint64_t timestamp;
+};
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Read a field value, widened to 64 bits.
+static uint64_t ReadField(const uint8_t* pData, const EventFieldDesc& field)
+{
+    uint64_t value = 0;
+    memcpy(&value, pData + field.offset, field.size);
+
+    if (field.kind == FIELD_INT && field.size < 8)
+    {
+        // sign extend
+        uint64_t signBit = 1ULL << (field.size * 8 - 1);
+        value = (value ^ signBit) - signBit;
+    }
+    return value;
+}
+
+static uint32_t FindEvent(const char* pName)
+{
+    for (uint32_t id = 1; id < NumEventDescs; ++id)
+    {
+        if (strcmp(EventDescs[id].pName, pName) == 0)
+        {
+            return id;
+        }
+    }
+    return 0;
+}
+
+static const EventFieldDesc* FindField(uint32_t eventId, const char* pName)
+{
+    const EventDesc& desc = EventDescs[eventId];
+    for (uint32_t i = 0; i < desc.numFields; ++i)
+    {
+        if (strcmp(desc.pFields[i].pName, pName) == 0)
+        {
+            return &desc.pFields[i];
+        }
+    }
+    return nullptr;
+}
+
+static void WriteFieldValue(FILE* pOut, const uint8_t* pData, const EventFieldDesc& field)
+{
+    uint64_t value = ReadField(pData, field);
+
+    switch (field.kind)
+    {
+    case FIELD_INT:
+        fprintf(pOut, "%lld", (long long)value);
+        break;
+    case FIELD_FLOAT:
+        if (field.size == 4)
+        {
+            float f;
+            memcpy(&f, &value, sizeof(f));
+            fprintf(pOut, "%g", f);
+        }
+        else
+        {
+            double d;
+            memcpy(&d, &value, sizeof(d));
+            fprintf(pOut, "%g", d);
+        }
+        break;
+    case FIELD_ENUM:
+        if (value < field.numEnumNames)
+        {
+            fprintf(pOut, "\"%s\"", field.pEnumNames[value]);
+            break;
+        }
+        // fall through
+    default:
+        fprintf(pOut, "%llu", (unsigned long long)value);
+        break;
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Write a field as a string, for the name of duration events.
+///        Values outside the enum table are written as "<field> <value>".
+static void WriteFieldName(FILE* pOut, const uint8_t* pData, const EventFieldDesc& field)
+{
+    uint64_t value = ReadField(pData, field);
+
+    if (field.kind == FIELD_ENUM && value < field.numEnumNames)
+    {
+        fprintf(pOut, "\"%s\"", field.pEnumNames[value]);
+    }
+    else
+    {
+        fprintf(pOut, "\"%s %llu\"", field.pName, (unsigned long long)value);
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Load an event file and derive its process and thread ids from
+///        the name the driver gave it: ar_event<creator thread>_<id>.bin,
+///        where id is the worker index, or the worker count for the API
+///        thread.
+static bool LoadEventFile(const char* pFilename, std::map<std::string, uint32_t>& processes, EventFile& file)
+{
+    std::ifstream in(pFilename, std::ios::in | std::ios::binary);
+    if (!in.is_open())
+    {
+        fprintf(stderr, "swr_ar_trace: could not open %s\n", pFilename);
+        return false;
+    }
+
+    file.name = pFilename;
+    file.data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    std::string base = file.name;
+    size_t ext = base.rfind(".bin");
+    if (ext != std::string::npos)
+    {
+        base.erase(ext);
+    }
+
+    size_t sep = base.rfind('_');
+    file.tid = (sep != std::string::npos) ? (uint32_t)strtoul(base.c_str() + sep + 1, nullptr, 10) : 0;
+
+    std::string process = base.substr(0, sep);
+    auto it = processes.find(process);
+    if (it == processes.end())
+    {
+        it = processes.insert(std::make_pair(process, (uint32_t)processes.size() + 1)).first;
+    }
+    file.pid = it->second;
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Split an event file into records. Events without a timestamp
+///        of their own take the timestamp of the last begin/end event on
+///        the same thread.
+static bool ParseEventFile(uint32_t fileIdx, const EventFile& file, std::vector<EventRecord>& records, bool& bIsApi)
+{
+    const uint8_t* pCur = file.data.data();
+    const uint8_t* pEnd = pCur + file.data.size();
+    uint64_t timestamp = 0;
+    bool bHaveTimestamp = false;
+
+    while (pCur < pEnd)
+    {
+        uint32_t eventId;
+        if (pEnd - pCur < (ptrdiff_t)sizeof(eventId))
+        {
+            break;
+        }
+        memcpy(&eventId, pCur, sizeof(eventId));
+        pCur += sizeof(eventId);
+
+        if (eventId == 0 || eventId >= NumEventDescs ||
+            pEnd - pCur < (ptrdiff_t)EventDescs[eventId].size)
+        {
+            fprintf(stderr, "swr_ar_trace: %s is corrupt or from a different events.proto at offset %u\n",
+                file.name.c_str(), (uint32_t)(pCur - sizeof(eventId) - file.data.data()));
+            return false;
+        }
+
+        static const uint32_t apiStartId = FindEvent("ThreadStartApiEvent");
+        if (eventId == apiStartId)
+        {
+            bIsApi = true;
+        }
+
+        const EventFieldDesc* pTimestamp = FindField(eventId, "timestamp");
+        if (pTimestamp)
+        {
+            timestamp = ReadField(pCur, *pTimestamp);
+            bHaveTimestamp = true;
+        }
+
+        if (bHaveTimestamp)
+        {
+            records.push_back({ fileIdx, eventId, pCur, timestamp });
+        }
+
+        pCur += EventDescs[eventId].size;
+    }
+
+    return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Measure the TSC frequency of this machine in MHz.
+static double CalibrateTsc()
+{
+    auto start = std::chrono::steady_clock::now();
+    uint64_t tscStart = __rdtsc();
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(100))
+    {
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    uint64_t tscElapsed = __rdtsc() - tscStart;
+
+    return (double)tscElapsed / std::chrono::duration<double, std::micro>(elapsed).count();
+}
+
+static void Usage()
+{
+    fprintf(stderr,
+        "usage: swr_ar_trace [-o trace.json] [--tsc-mhz MHZ] ar_event*.bin\n"
+        "\n"
+        "  -o FILE         write the trace to FILE instead of stdout\n"
+        "  --tsc-mhz MHZ   TSC frequency of the machine that recorded the events;\n"
+        "                  measured on this machine when omitted\n");
+}
+
+int main(int argc, char** argv)
+{
+    const char* pOutName = nullptr;
+    double tscMhz = 0.0;
+    std::vector<const char*> inputs;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+        {
+            pOutName = argv[++i];
+        }
+        else if (strcmp(argv[i], "--tsc-mhz") == 0 && i + 1 < argc)
+        {
+            tscMhz = atof(argv[++i]);
+        }
+        else if (argv[i][0] == '-')
+        {
+            Usage();
+            return 1;
+        }
+        else
+        {
+            inputs.push_back(argv[i]);
+        }
+    }
+
+    if (inputs.empty())
+    {
+        Usage();
+        return 1;
+    }
+
+    if (tscMhz <= 0.0)
+    {
+        tscMhz = CalibrateTsc();
+    }
+
+    std::map<std::string, uint32_t> processes;
+    std::vector<EventFile> files(inputs.size());
+    std::vector<EventRecord> records;
+    std::vector<bool> isApi(inputs.size(), false);
+
+    for (uint32_t i = 0; i < inputs.size(); ++i)
+    {
+        if (!LoadEventFile(inputs[i], processes, files[i]))
+        {
+            return 1;
+        }
+
+        bool bIsApi = false;
+        if (!ParseEventFile(i, files[i], records, bIsApi))
+        {
+            return 1;
+        }
+        isApi[i] = bIsApi;
+    }
+
+    if (records.empty())
+    {
+        fprintf(stderr, "swr_ar_trace: no timestamped events found, was KNOB_AR_ENABLE_TIMELINE set?\n");
+        return 1;
+    }
+
+    uint64_t baseTimestamp = records[0].timestamp;
+    for (const EventRecord& record : records)
+    {
+        baseTimestamp = std::min(baseTimestamp, record.timestamp);
+    }
+
+    FILE* pOut = pOutName ? fopen(pOutName, "w") : stdout;
+    if (!pOut)
+    {
+        fprintf(stderr, "swr_ar_trace: could not open %s\n", pOutName);
+        return 1;
+    }
+
+    fprintf(pOut, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    for (uint32_t i = 0; i < files.size(); ++i)
+    {
+        fprintf(pOut, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"",
+            files[i].pid, files[i].tid);
+        if (isApi[i])
+        {
+            fprintf(pOut, "API");
+        }
+        else
+        {
+            fprintf(pOut, "Worker %u", files[i].tid);
+        }
+        fprintf(pOut, "\"}},\n");
+    }
+
+    const uint32_t startId = FindEvent("Start");
+    const uint32_t endId = FindEvent("End");
+
+    for (uint32_t i = 0; i < records.size(); ++i)
+    {
+        const EventRecord& record = records[i];
+        const EventFile& file = files[record.file];
+        const EventDesc& desc = EventDescs[record.eventId];
+        double ts = (double)(record.timestamp - baseTimestamp) / tscMhz;
+
+        if (record.eventId == startId || record.eventId == endId)
+        {
+            // type, drawId/count, timestamp
+            const EventFieldDesc& type = desc.pFields[0];
+            fprintf(pOut, "{\"ph\":\"%s\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"name\":",
+                (record.eventId == startId) ? "B" : "E", file.pid, file.tid, ts);
+            WriteFieldName(pOut, record.pData, type);
+            fprintf(pOut, ",\"args\":{\"%s\":", (record.eventId == startId) ? "drawId" : "count");
+            WriteFieldValue(pOut, record.pData, desc.pFields[1]);
+            fprintf(pOut, "}}");
+        }
+        else
+        {
+            fprintf(pOut, "{\"ph\":\"i\",\"s\":\"t\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"name\":\"%s\",\"args\":{",
+                file.pid, file.tid, ts, desc.pName);
+            for (uint32_t f = 0; f < desc.numFields; ++f)
+            {
+                fprintf(pOut, "%s\"%s\":", f ? "," : "", desc.pFields[f].pName);
+                WriteFieldValue(pOut, record.pData, desc.pFields[f]);
+            }
+            fprintf(pOut, "}}");
+        }
+
+        fprintf(pOut, "%s\n", (i + 1 < records.size()) ? "," : "");
+    }
+
+    fprintf(pOut, "]}\n");
+
+    if (pOut != stdout)
+    {
+        fclose(pOut);
+    }
+
+    return 0;
+}
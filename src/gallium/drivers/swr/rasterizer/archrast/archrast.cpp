@@ -66,6 +66,13 @@ namespace ArchRast
         uint32_t vertsInput;
     };
 
+    struct WorkerStats
+    {
+        uint64_t idleCycles = 0;
+        uint32_t subTilesStolen = 0;
+        uint64_t workItemsStolen = 0;
+    };
+
     //////////////////////////////////////////////////////////////////////////
     /// @brief Event handler that saves stat events to event files. This
     ///        handler filters out unwanted events.
@@ -74,9 +81,22 @@ namespace ArchRast
     public:
         EventHandlerStatsFile(uint32_t id) : EventHandlerFile(id), mNeedFlush(false) {}
 
-        // These are events that we're not interested in saving in stats event files.
-        virtual void Handle(const Start& event) {}
-        virtual void Handle(const End& event) {}
+        // Begin/end events are only saved when a timeline was asked for.
+        virtual void Handle(const Start& event)
+        {
+            if (KNOB_AR_ENABLE_TIMELINE)
+            {
+                EventHandlerFile::Handle(event);
+            }
+        }
+
+        virtual void Handle(const End& event)
+        {
+            if (KNOB_AR_ENABLE_TIMELINE)
+            {
+                EventHandlerFile::Handle(event);
+            }
+        }
 
         virtual void Handle(const EarlyDepthStencilInfoSingleSample& event)
         {
@@ -171,6 +191,13 @@ namespace ArchRast
         // Flush cached events for this draw
         virtual void FlushDraw(uint32_t drawId)
         {
+            //Backend scheduling
+            if (mWorker.idleCycles || mWorker.subTilesStolen)
+            {
+                EventHandlerFile::Handle(WorkerIdle(drawId, mWorker.idleCycles, mWorker.subTilesStolen, mWorker.workItemsStolen));
+                mWorker = {};
+            }
+
             if (mNeedFlush == false) return;
 
             //singleSample
@@ -239,6 +266,17 @@ namespace ArchRast
             mTS.inputPrims += event.data.primCount;
         }
 
+        virtual void Handle(const WorkerIdleInfo& event)
+        {
+            mWorker.idleCycles += event.data.idleCycles;
+        }
+
+        virtual void Handle(const WorkerStealInfo& event)
+        {
+            mWorker.subTilesStolen++;
+            mWorker.workItemsStolen += event.data.numWorkItems;
+        }
+
     protected:
         bool mNeedFlush;
         // Per draw stats
@@ -250,6 +288,7 @@ namespace ArchRast
         CStats mClipper = {};
         TEStats mTS = {};
         GSStats mGS = {};
+        WorkerStats mWorker = {};
 
     };
 
@@ -300,3 +300,18 @@ void TessPrims::Accept(EventHandler* pHandler) const
 {
     pHandler->Handle(*this);
 }
+
+void WorkerIdleInfo::Accept(EventHandler* pHandler) const
+{
+    pHandler->Handle(*this);
+}
+
+void WorkerStealInfo::Accept(EventHandler* pHandler) const
+{
+    pHandler->Handle(*this);
+}
+
+void WorkerIdle::Accept(EventHandler* pHandler) const
+{
+    pHandler->Handle(*this);
+}
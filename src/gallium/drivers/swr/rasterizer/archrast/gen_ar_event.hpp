@@ -129,6 +129,7 @@ namespace ArchRast
         // Fields
         GroupType type;
         uint32_t id;
+        uint64_t timestamp;
     };
 #pragma pack(pop)
 
@@ -142,11 +143,13 @@ namespace ArchRast
         // Constructor
         Start(
             GroupType type,
-            uint32_t id
+            uint32_t id,
+            uint64_t timestamp
         )
         {
             data.type = type;
             data.id = id;
+            data.timestamp = timestamp;
         }
 
         virtual void Accept(EventHandler* pHandler) const;
@@ -161,6 +164,7 @@ namespace ArchRast
         // Fields
         GroupType type;
         uint32_t count;
+        uint64_t timestamp;
     };
 #pragma pack(pop)
 
@@ -174,11 +178,13 @@ namespace ArchRast
         // Constructor
         End(
             GroupType type,
-            uint32_t count
+            uint32_t count,
+            uint64_t timestamp
         )
         {
             data.type = type;
             data.count = count;
+            data.timestamp = timestamp;
         }
 
         virtual void Accept(EventHandler* pHandler) const;
@@ -1894,4 +1900,100 @@ namespace ArchRast
 
         virtual void Accept(EventHandler* pHandler) const;
     };
+
+    //////////////////////////////////////////////////////////////////////////
+    /// WorkerIdleInfoData
+    //////////////////////////////////////////////////////////////////////////
+#pragma pack(push, 1)
+    struct WorkerIdleInfoData
+    {
+        // Fields
+        uint64_t idleCycles;
+    };
+#pragma pack(pop)
+
+    //////////////////////////////////////////////////////////////////////////
+    /// WorkerIdleInfo
+    //////////////////////////////////////////////////////////////////////////
+    struct WorkerIdleInfo : Event
+    {
+        WorkerIdleInfoData data;
+
+        // Constructor
+        WorkerIdleInfo(
+            uint64_t idleCycles
+        )
+        {
+            data.idleCycles = idleCycles;
+        }
+
+        virtual void Accept(EventHandler* pHandler) const;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    /// WorkerStealInfoData
+    //////////////////////////////////////////////////////////////////////////
+#pragma pack(push, 1)
+    struct WorkerStealInfoData
+    {
+        // Fields
+        uint32_t numWorkItems;
+    };
+#pragma pack(pop)
+
+    //////////////////////////////////////////////////////////////////////////
+    /// WorkerStealInfo
+    //////////////////////////////////////////////////////////////////////////
+    struct WorkerStealInfo : Event
+    {
+        WorkerStealInfoData data;
+
+        // Constructor
+        WorkerStealInfo(
+            uint32_t numWorkItems
+        )
+        {
+            data.numWorkItems = numWorkItems;
+        }
+
+        virtual void Accept(EventHandler* pHandler) const;
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    /// WorkerIdleData
+    //////////////////////////////////////////////////////////////////////////
+#pragma pack(push, 1)
+    struct WorkerIdleData
+    {
+        // Fields
+        uint32_t drawId;
+        uint64_t idleCycles;
+        uint32_t subTilesStolen;
+        uint64_t workItemsStolen;
+    };
+#pragma pack(pop)
+
+    //////////////////////////////////////////////////////////////////////////
+    /// WorkerIdle
+    //////////////////////////////////////////////////////////////////////////
+    struct WorkerIdle : Event
+    {
+        WorkerIdleData data;
+
+        // Constructor
+        WorkerIdle(
+            uint32_t drawId,
+            uint64_t idleCycles,
+            uint32_t subTilesStolen,
+            uint64_t workItemsStolen
+        )
+        {
+            data.drawId = drawId;
+            data.idleCycles = idleCycles;
+            data.subTilesStolen = subTilesStolen;
+            data.workItemsStolen = workItemsStolen;
+        }
+
+        virtual void Accept(EventHandler* pHandler) const;
+    };
 }
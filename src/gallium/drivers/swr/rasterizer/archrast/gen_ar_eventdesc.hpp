@@ -0,0 +1,558 @@
+/****************************************************************************
+* Copyright (C) 2018 Intel Corporation.   All Rights Reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice (including the next
+* paragraph) shall be included in all copies or substantial portions of the
+* Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* @file gen_ar_eventdesc.hpp
+*
+* @brief Event descriptor tables used to decode event files without
+*        the rasterizer headers.  auto-generated file
+*
+* DO NOT EDIT
+*
+* Generation Command Line:
+*  ./rasterizer/codegen/gen_archrast.py
+*    --proto
+*    ./rasterizer/archrast/events.proto
+*    --output
+*    rasterizer/archrast/gen_ar_eventdesc.hpp
+*    --gen_eventdesc_hpp
+*
+******************************************************************************/
+#pragma once
+
+#include <stdint.h>
+
+namespace ArchRast
+{
+    enum EventFieldKind
+    {
+        FIELD_UINT,
+        FIELD_INT,
+        FIELD_FLOAT,
+        FIELD_ENUM,
+    };
+
+    struct EventFieldDesc
+    {
+        const char* pName;
+        EventFieldKind kind;
+        uint32_t offset;
+        uint32_t size;
+        const char* const* pEnumNames;  // value names for FIELD_ENUM fields
+        uint32_t numEnumNames;
+    };
+
+    struct EventDesc
+    {
+        const char* pName;
+        uint32_t size;                  // packed payload size in the event file
+        uint32_t numFields;
+        const EventFieldDesc* pFields;
+    };
+
+    static const char* const GroupTypeNames[] =
+    {
+        "APIClearRenderTarget",
+        "APIDraw",
+        "APIDrawWakeAllThreads",
+        "APIDrawIndexed",
+        "APIDispatch",
+        "APIStoreTiles",
+        "APIGetDrawContext",
+        "APISync",
+        "APIWaitForIdle",
+        "FEProcessDraw",
+        "FEProcessDrawIndexed",
+        "FEFetchShader",
+        "FEVertexShader",
+        "FEHullShader",
+        "FETessellation",
+        "FEDomainShader",
+        "FEGeometryShader",
+        "FEStreamout",
+        "FEPAAssemble",
+        "FEBinPoints",
+        "FEBinLines",
+        "FEBinTriangles",
+        "FETriangleSetup",
+        "FEViewportCull",
+        "FEGuardbandClip",
+        "FEClipPoints",
+        "FEClipLines",
+        "FEClipTriangles",
+        "FECullZeroAreaAndBackface",
+        "FECullBetweenCenters",
+        "FEProcessStoreTiles",
+        "FEProcessInvalidateTiles",
+        "WorkerWorkOnFifoBE",
+        "WorkerFoundWork",
+        "BELoadTiles",
+        "BEDispatch",
+        "BEClear",
+        "BERasterizeLine",
+        "BERasterizeTriangle",
+        "BETriangleSetup",
+        "BEStepSetup",
+        "BECullZeroArea",
+        "BEEmptyTriangle",
+        "BETrivialAccept",
+        "BETrivialReject",
+        "BERasterizePartial",
+        "BEPixelBackend",
+        "BESetup",
+        "BEBarycentric",
+        "BEEarlyDepthTest",
+        "BEPixelShader",
+        "BESingleSampleBackend",
+        "BEPixelRateBackend",
+        "BESampleRateBackend",
+        "BENullBackend",
+        "BELateDepthTest",
+        "BEOutputMerger",
+        "BEStoreTiles",
+        "BEEndTile",
+        "WorkerWaitForThreadEvent",
+    };
+
+    static const EventFieldDesc StartFields[] =
+    {
+        { "type", FIELD_ENUM, 0, 4, GroupTypeNames, sizeof(GroupTypeNames) / sizeof(GroupTypeNames[0]) },
+        { "id", FIELD_UINT, 4, 4, nullptr, 0 },
+        { "timestamp", FIELD_UINT, 8, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc EndFields[] =
+    {
+        { "type", FIELD_ENUM, 0, 4, GroupTypeNames, sizeof(GroupTypeNames) / sizeof(GroupTypeNames[0]) },
+        { "count", FIELD_UINT, 4, 4, nullptr, 0 },
+        { "timestamp", FIELD_UINT, 8, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc DrawInstancedEventFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "topology", FIELD_UINT, 4, 4, nullptr, 0 },
+        { "numVertices", FIELD_UINT, 8, 4, nullptr, 0 },
+        { "startVertex", FIELD_INT, 12, 4, nullptr, 0 },
+        { "numInstances", FIELD_UINT, 16, 4, nullptr, 0 },
+        { "startInstance", FIELD_UINT, 20, 4, nullptr, 0 },
+    };
+
+    static const EventFieldDesc DrawIndexedInstancedEventFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "topology", FIELD_UINT, 4, 4, nullptr, 0 },
+        { "numIndices", FIELD_UINT, 8, 4, nullptr, 0 },
+        { "indexOffset", FIELD_INT, 12, 4, nullptr, 0 },
+        { "baseVertex", FIELD_INT, 16, 4, nullptr, 0 },
+        { "numInstances", FIELD_UINT, 20, 4, nullptr, 0 },
+        { "startInstance", FIELD_UINT, 24, 4, nullptr, 0 },
+    };
+
+    static const EventFieldDesc DispatchEventFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "threadGroupCountX", FIELD_UINT, 4, 4, nullptr, 0 },
+        { "threadGroupCountY", FIELD_UINT, 8, 4, nullptr, 0 },
+        { "threadGroupCountZ", FIELD_UINT, 12, 4, nullptr, 0 },
+    };
+
+    static const EventFieldDesc FrameEndEventFields[] =
+    {
+        { "frameId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "nextDrawId", FIELD_UINT, 4, 4, nullptr, 0 },
+    };
+
+    static const EventFieldDesc DrawInstancedSplitEventFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+    };
+
+    static const EventFieldDesc DrawIndexedInstancedSplitEventFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+    };
+
+    static const EventFieldDesc SwrSyncEventFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+    };
+
+    static const EventFieldDesc SwrInvalidateTilesEventFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+    };
+
+    static const EventFieldDesc SwrDiscardRectEventFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+    };
+
+    static const EventFieldDesc SwrStoreTilesEventFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+    };
+
+    static const EventFieldDesc FrontendStatsEventFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "IaVertices", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "IaPrimitives", FIELD_UINT, 12, 8, nullptr, 0 },
+        { "VsInvocations", FIELD_UINT, 20, 8, nullptr, 0 },
+        { "HsInvocations", FIELD_UINT, 28, 8, nullptr, 0 },
+        { "DsInvocations", FIELD_UINT, 36, 8, nullptr, 0 },
+        { "GsInvocations", FIELD_UINT, 44, 8, nullptr, 0 },
+        { "GsPrimitives", FIELD_UINT, 52, 8, nullptr, 0 },
+        { "CInvocations", FIELD_UINT, 60, 8, nullptr, 0 },
+        { "CPrimitives", FIELD_UINT, 68, 8, nullptr, 0 },
+        { "SoPrimStorageNeeded0", FIELD_UINT, 76, 8, nullptr, 0 },
+        { "SoPrimStorageNeeded1", FIELD_UINT, 84, 8, nullptr, 0 },
+        { "SoPrimStorageNeeded2", FIELD_UINT, 92, 8, nullptr, 0 },
+        { "SoPrimStorageNeeded3", FIELD_UINT, 100, 8, nullptr, 0 },
+        { "SoNumPrimsWritten0", FIELD_UINT, 108, 8, nullptr, 0 },
+        { "SoNumPrimsWritten1", FIELD_UINT, 116, 8, nullptr, 0 },
+        { "SoNumPrimsWritten2", FIELD_UINT, 124, 8, nullptr, 0 },
+        { "SoNumPrimsWritten3", FIELD_UINT, 132, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc BackendStatsEventFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "DepthPassCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "PsInvocations", FIELD_UINT, 12, 8, nullptr, 0 },
+        { "CsInvocations", FIELD_UINT, 20, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc EarlyDepthStencilInfoSingleSampleFields[] =
+    {
+        { "depthPassMask", FIELD_UINT, 0, 8, nullptr, 0 },
+        { "stencilPassMask", FIELD_UINT, 8, 8, nullptr, 0 },
+        { "coverageMask", FIELD_UINT, 16, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc EarlyDepthStencilInfoSampleRateFields[] =
+    {
+        { "depthPassMask", FIELD_UINT, 0, 8, nullptr, 0 },
+        { "stencilPassMask", FIELD_UINT, 8, 8, nullptr, 0 },
+        { "coverageMask", FIELD_UINT, 16, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc EarlyDepthStencilInfoNullPSFields[] =
+    {
+        { "depthPassMask", FIELD_UINT, 0, 8, nullptr, 0 },
+        { "stencilPassMask", FIELD_UINT, 8, 8, nullptr, 0 },
+        { "coverageMask", FIELD_UINT, 16, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc LateDepthStencilInfoSingleSampleFields[] =
+    {
+        { "depthPassMask", FIELD_UINT, 0, 8, nullptr, 0 },
+        { "stencilPassMask", FIELD_UINT, 8, 8, nullptr, 0 },
+        { "coverageMask", FIELD_UINT, 16, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc LateDepthStencilInfoSampleRateFields[] =
+    {
+        { "depthPassMask", FIELD_UINT, 0, 8, nullptr, 0 },
+        { "stencilPassMask", FIELD_UINT, 8, 8, nullptr, 0 },
+        { "coverageMask", FIELD_UINT, 16, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc LateDepthStencilInfoNullPSFields[] =
+    {
+        { "depthPassMask", FIELD_UINT, 0, 8, nullptr, 0 },
+        { "stencilPassMask", FIELD_UINT, 8, 8, nullptr, 0 },
+        { "coverageMask", FIELD_UINT, 16, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc EarlyDepthInfoPixelRateFields[] =
+    {
+        { "depthPassCount", FIELD_UINT, 0, 8, nullptr, 0 },
+        { "activeLanes", FIELD_UINT, 8, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc LateDepthInfoPixelRateFields[] =
+    {
+        { "depthPassCount", FIELD_UINT, 0, 8, nullptr, 0 },
+        { "activeLanes", FIELD_UINT, 8, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc BackendDrawEndEventFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+    };
+
+    static const EventFieldDesc FrontendDrawEndEventFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+    };
+
+    static const EventFieldDesc EarlyZSingleSampleFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc LateZSingleSampleFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc EarlyStencilSingleSampleFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc LateStencilSingleSampleFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc EarlyZSampleRateFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc LateZSampleRateFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc EarlyStencilSampleRateFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc LateStencilSampleRateFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc EarlyZNullPSFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc EarlyStencilNullPSFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc EarlyZPixelRateFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc LateZPixelRateFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc EarlyOmZFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc EarlyOmStencilFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc LateOmZFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc LateOmStencilFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "passCount", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "failCount", FIELD_UINT, 12, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc GSPrimInfoFields[] =
+    {
+        { "inputPrimCount", FIELD_UINT, 0, 8, nullptr, 0 },
+        { "primGeneratedCount", FIELD_UINT, 8, 8, nullptr, 0 },
+        { "vertsInput", FIELD_UINT, 16, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc GSInputPrimsFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "inputPrimCount", FIELD_UINT, 4, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc GSPrimsGenFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "primGeneratedCount", FIELD_UINT, 4, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc GSVertsInputFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "vertsInput", FIELD_UINT, 4, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc ClipVertexCountFields[] =
+    {
+        { "vertsPerPrim", FIELD_UINT, 0, 8, nullptr, 0 },
+        { "primMask", FIELD_UINT, 8, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc FlushVertClipFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+    };
+
+    static const EventFieldDesc VertsClippedFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "clipCount", FIELD_UINT, 4, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc TessPrimCountFields[] =
+    {
+        { "primCount", FIELD_UINT, 0, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc TessPrimFlushFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+    };
+
+    static const EventFieldDesc TessPrimsFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "primCount", FIELD_UINT, 4, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc WorkerIdleInfoFields[] =
+    {
+        { "idleCycles", FIELD_UINT, 0, 8, nullptr, 0 },
+    };
+
+    static const EventFieldDesc WorkerStealInfoFields[] =
+    {
+        { "numWorkItems", FIELD_UINT, 0, 4, nullptr, 0 },
+    };
+
+    static const EventFieldDesc WorkerIdleFields[] =
+    {
+        { "drawId", FIELD_UINT, 0, 4, nullptr, 0 },
+        { "idleCycles", FIELD_UINT, 4, 8, nullptr, 0 },
+        { "subTilesStolen", FIELD_UINT, 12, 4, nullptr, 0 },
+        { "workItemsStolen", FIELD_UINT, 16, 8, nullptr, 0 },
+    };
+
+    // Indexed by event id. Id 0 is never written to event files.
+    static const EventDesc EventDescs[] =
+    {
+        { nullptr, 0, 0, nullptr },
+        { "Start", 16, 3, StartFields },
+        { "End", 16, 3, EndFields },
+        { "ThreadStartApiEvent", 0, 0, nullptr },
+        { "ThreadStartWorkerEvent", 0, 0, nullptr },
+        { "DrawInstancedEvent", 24, 6, DrawInstancedEventFields },
+        { "DrawIndexedInstancedEvent", 28, 7, DrawIndexedInstancedEventFields },
+        { "DispatchEvent", 16, 4, DispatchEventFields },
+        { "FrameEndEvent", 8, 2, FrameEndEventFields },
+        { "DrawInstancedSplitEvent", 4, 1, DrawInstancedSplitEventFields },
+        { "DrawIndexedInstancedSplitEvent", 4, 1, DrawIndexedInstancedSplitEventFields },
+        { "SwrSyncEvent", 4, 1, SwrSyncEventFields },
+        { "SwrInvalidateTilesEvent", 4, 1, SwrInvalidateTilesEventFields },
+        { "SwrDiscardRectEvent", 4, 1, SwrDiscardRectEventFields },
+        { "SwrStoreTilesEvent", 4, 1, SwrStoreTilesEventFields },
+        { "FrontendStatsEvent", 140, 18, FrontendStatsEventFields },
+        { "BackendStatsEvent", 28, 4, BackendStatsEventFields },
+        { "EarlyDepthStencilInfoSingleSample", 24, 3, EarlyDepthStencilInfoSingleSampleFields },
+        { "EarlyDepthStencilInfoSampleRate", 24, 3, EarlyDepthStencilInfoSampleRateFields },
+        { "EarlyDepthStencilInfoNullPS", 24, 3, EarlyDepthStencilInfoNullPSFields },
+        { "LateDepthStencilInfoSingleSample", 24, 3, LateDepthStencilInfoSingleSampleFields },
+        { "LateDepthStencilInfoSampleRate", 24, 3, LateDepthStencilInfoSampleRateFields },
+        { "LateDepthStencilInfoNullPS", 24, 3, LateDepthStencilInfoNullPSFields },
+        { "EarlyDepthInfoPixelRate", 16, 2, EarlyDepthInfoPixelRateFields },
+        { "LateDepthInfoPixelRate", 16, 2, LateDepthInfoPixelRateFields },
+        { "BackendDrawEndEvent", 4, 1, BackendDrawEndEventFields },
+        { "FrontendDrawEndEvent", 4, 1, FrontendDrawEndEventFields },
+        { "EarlyZSingleSample", 20, 3, EarlyZSingleSampleFields },
+        { "LateZSingleSample", 20, 3, LateZSingleSampleFields },
+        { "EarlyStencilSingleSample", 20, 3, EarlyStencilSingleSampleFields },
+        { "LateStencilSingleSample", 20, 3, LateStencilSingleSampleFields },
+        { "EarlyZSampleRate", 20, 3, EarlyZSampleRateFields },
+        { "LateZSampleRate", 20, 3, LateZSampleRateFields },
+        { "EarlyStencilSampleRate", 20, 3, EarlyStencilSampleRateFields },
+        { "LateStencilSampleRate", 20, 3, LateStencilSampleRateFields },
+        { "EarlyZNullPS", 20, 3, EarlyZNullPSFields },
+        { "EarlyStencilNullPS", 20, 3, EarlyStencilNullPSFields },
+        { "EarlyZPixelRate", 20, 3, EarlyZPixelRateFields },
+        { "LateZPixelRate", 20, 3, LateZPixelRateFields },
+        { "EarlyOmZ", 20, 3, EarlyOmZFields },
+        { "EarlyOmStencil", 20, 3, EarlyOmStencilFields },
+        { "LateOmZ", 20, 3, LateOmZFields },
+        { "LateOmStencil", 20, 3, LateOmStencilFields },
+        { "GSPrimInfo", 24, 3, GSPrimInfoFields },
+        { "GSInputPrims", 12, 2, GSInputPrimsFields },
+        { "GSPrimsGen", 12, 2, GSPrimsGenFields },
+        { "GSVertsInput", 12, 2, GSVertsInputFields },
+        { "ClipVertexCount", 16, 2, ClipVertexCountFields },
+        { "FlushVertClip", 4, 1, FlushVertClipFields },
+        { "VertsClipped", 12, 2, VertsClippedFields },
+        { "TessPrimCount", 8, 1, TessPrimCountFields },
+        { "TessPrimFlush", 4, 1, TessPrimFlushFields },
+        { "TessPrims", 12, 2, TessPrimsFields },
+        { "WorkerIdleInfo", 8, 1, WorkerIdleInfoFields },
+        { "WorkerStealInfo", 4, 1, WorkerStealInfoFields },
+        { "WorkerIdle", 24, 4, WorkerIdleFields },
+    };
+
+    static const uint32_t NumEventDescs = sizeof(EventDescs) / sizeof(EventDescs[0]);
+}
@@ -104,5 +104,8 @@ namespace ArchRast
         virtual void Handle(const TessPrimCount& event) {}
         virtual void Handle(const TessPrimFlush& event) {}
         virtual void Handle(const TessPrims& event) {}
+        virtual void Handle(const WorkerIdleInfo& event) {}
+        virtual void Handle(const WorkerStealInfo& event) {}
+        virtual void Handle(const WorkerIdle& event) {}
     };
 }
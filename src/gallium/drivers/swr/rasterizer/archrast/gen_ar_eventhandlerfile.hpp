@@ -448,6 +448,24 @@ namespace ArchRast
         {
             Write(52, (char*)&event.data, sizeof(event.data));
         }
+        //////////////////////////////////////////////////////////////////////////
+        /// @brief Handle WorkerIdleInfo event
+        virtual void Handle(const WorkerIdleInfo& event)
+        {
+            Write(53, (char*)&event.data, sizeof(event.data));
+        }
+        //////////////////////////////////////////////////////////////////////////
+        /// @brief Handle WorkerStealInfo event
+        virtual void Handle(const WorkerStealInfo& event)
+        {
+            Write(54, (char*)&event.data, sizeof(event.data));
+        }
+        //////////////////////////////////////////////////////////////////////////
+        /// @brief Handle WorkerIdle event
+        virtual void Handle(const WorkerIdle& event)
+        {
+            Write(55, (char*)&event.data, sizeof(event.data));
+        }
 
         //////////////////////////////////////////////////////////////////////////
         /// @brief Everything written to buffer this point is the header.
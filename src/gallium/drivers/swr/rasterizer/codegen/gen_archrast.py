@@ -120,6 +120,47 @@ def parse_protos(filename):
 
     return protos
 
+# Sizes and kinds of the field types allowed in events.proto. Enums are
+# stored as 32-bit values.
+field_type_info = {
+    'bool'     : (1, 'FIELD_UINT'),
+    'uint8_t'  : (1, 'FIELD_UINT'),
+    'int8_t'   : (1, 'FIELD_INT'),
+    'uint16_t' : (2, 'FIELD_UINT'),
+    'int16_t'  : (2, 'FIELD_INT'),
+    'uint32_t' : (4, 'FIELD_UINT'),
+    'int32_t'  : (4, 'FIELD_INT'),
+    'uint64_t' : (8, 'FIELD_UINT'),
+    'int64_t'  : (8, 'FIELD_INT'),
+    'float'    : (4, 'FIELD_FLOAT'),
+    'double'   : (8, 'FIELD_FLOAT'),
+}
+
+def compute_event_layouts(protos):
+    # events are written packed, so offsets are a running sum of field sizes.
+    for name in protos['event_names']:
+        event = protos['events'][name]
+        offset = 0
+        event['field_offsets'] = []
+        event['field_sizes'] = []
+        event['field_kinds'] = []
+        for field_type in event['field_types']:
+            if field_type in protos['enums']:
+                (size, kind) = (4, 'FIELD_ENUM')
+            elif field_type in field_type_info:
+                (size, kind) = field_type_info[field_type]
+            else:
+                raise Exception('Unsupported field type %s in event %s' % (field_type, name))
+            event['field_offsets'].append(offset)
+            event['field_sizes'].append(size)
+            event['field_kinds'].append(kind)
+            offset += size
+        event['size'] = offset
+
+    for name in protos['enum_names']:
+        enum = protos['enums'][name]
+        enum['value_names'] = [re.match(r'\s*(\w+)', line).group(1) for line in enum['names']]
+
 def main():
 
     # Parse args...
@@ -130,6 +171,7 @@ def main():
     parser.add_argument('--gen_event_cpp', help='Generate event cpp', action='store_true', default=False)
     parser.add_argument('--gen_eventhandler_hpp', help='Generate eventhandler header', action='store_true', default=False)
     parser.add_argument('--gen_eventhandlerfile_hpp', help='Generate eventhandler header for writing to files', action='store_true', default=False)
+    parser.add_argument('--gen_eventdesc_hpp', help='Generate event descriptor tables for reading event files', action='store_true', default=False)
     args = parser.parse_args()
 
     proto_filename = args.proto
@@ -194,6 +236,19 @@ def main():
                 event_header='gen_ar_eventhandler.hpp',
                 protos=protos)
 
+    # Generate event descriptor header
+    if args.gen_eventdesc_hpp:
+        compute_event_layouts(protos)
+
+        curdir = os.path.dirname(os.path.abspath(__file__))
+        template_file = os.sep.join([curdir, 'templates', 'gen_ar_eventdesc.hpp'])
+        output_fullpath = os.sep.join([output_dir, output_filename])
+
+        MakoTemplateWriter.to_file(template_file, output_fullpath,
+                cmdline=sys.argv,
+                filename=output_filename,
+                protos=protos)
+
     return 0
 
 if __name__ == '__main__':
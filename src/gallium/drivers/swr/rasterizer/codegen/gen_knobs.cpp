@@ -119,12 +119,15 @@ GlobalKnobs::GlobalKnobs()
     InitKnob(BUCKETS_START_FRAME);
     InitKnob(BUCKETS_END_FRAME);
     InitKnob(WORKER_SPIN_LOOP_COUNT);
+    InitKnob(BE_SPLIT_MIN_WORK);
     InitKnob(MAX_DRAWS_IN_FLIGHT);
     InitKnob(MAX_PRIMS_PER_DRAW);
     InitKnob(MAX_TESS_PRIMS_PER_DRAW);
     InitKnob(DEBUG_OUTPUT_DIR);
+    InitKnob(AR_ENABLE_TIMELINE);
     InitKnob(JIT_ENABLE_CACHE);
     InitKnob(JIT_CACHE_DIR);
+    InitKnob(JIT_CACHE_MAX_SIZE);
     InitKnob(TOSS_DRAW);
     InitKnob(TOSS_QUEUE_FE);
     InitKnob(TOSS_FETCH);
@@ -185,6 +188,9 @@ std::string GlobalKnobs::ToString(const char* optPerLinePrefix)
     str << optPerLinePrefix << "KNOB_WORKER_SPIN_LOOP_COUNT:     ";
     str << std::hex << std::setw(11) << std::left << KNOB_WORKER_SPIN_LOOP_COUNT;
     str << std::dec << KNOB_WORKER_SPIN_LOOP_COUNT << "\n";
+    str << optPerLinePrefix << "KNOB_BE_SPLIT_MIN_WORK:          ";
+    str << std::hex << std::setw(11) << std::left << KNOB_BE_SPLIT_MIN_WORK;
+    str << std::dec << KNOB_BE_SPLIT_MIN_WORK << "\n";
     str << optPerLinePrefix << "KNOB_MAX_DRAWS_IN_FLIGHT:        ";
     str << std::hex << std::setw(11) << std::left << KNOB_MAX_DRAWS_IN_FLIGHT;
     str << std::dec << KNOB_MAX_DRAWS_IN_FLIGHT << "\n";
@@ -196,10 +202,15 @@ std::string GlobalKnobs::ToString(const char* optPerLinePrefix)
     str << std::dec << KNOB_MAX_TESS_PRIMS_PER_DRAW << "\n";
     str << optPerLinePrefix << "KNOB_DEBUG_OUTPUT_DIR:           ";
     str << KNOB_DEBUG_OUTPUT_DIR << "\n";
+    str << optPerLinePrefix << "KNOB_AR_ENABLE_TIMELINE:         ";
+    str << (KNOB_AR_ENABLE_TIMELINE ? "+\n" : "-\n");
     str << optPerLinePrefix << "KNOB_JIT_ENABLE_CACHE:           ";
     str << (KNOB_JIT_ENABLE_CACHE ? "+\n" : "-\n");
     str << optPerLinePrefix << "KNOB_JIT_CACHE_DIR:              ";
     str << KNOB_JIT_CACHE_DIR << "\n";
+    str << optPerLinePrefix << "KNOB_JIT_CACHE_MAX_SIZE:         ";
+    str << std::hex << std::setw(11) << std::left << KNOB_JIT_CACHE_MAX_SIZE;
+    str << std::dec << KNOB_JIT_CACHE_MAX_SIZE << "\n";
     str << optPerLinePrefix << "KNOB_TOSS_DRAW:                  ";
     str << (KNOB_TOSS_DRAW ? "+\n" : "-\n");
     str << optPerLinePrefix << "KNOB_TOSS_QUEUE_FE:              ";
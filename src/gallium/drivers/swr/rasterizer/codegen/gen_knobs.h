@@ -215,6 +215,16 @@ struct GlobalKnobs
     //
     DEFINE_KNOB(WORKER_SPIN_LOOP_COUNT, uint32_t, 5000);
 
+    //-----------------------------------------------------------
+    // KNOB_BE_SPLIT_MIN_WORK
+    //
+    // Minimum number of queued primitives in a macrotile before its
+    // owner splits them by sub-tile so idle workers can steal part
+    // of the macrotile.
+    //   0 == Never split
+    //
+    DEFINE_KNOB(BE_SPLIT_MIN_WORK, uint32_t, 64);
+
     //-----------------------------------------------------------
     // KNOB_MAX_DRAWS_IN_FLIGHT
     //
@@ -248,10 +258,22 @@ struct GlobalKnobs
     //
     DEFINE_KNOB(DEBUG_OUTPUT_DIR, std::string, "/tmp/Rast/DebugOutput");
 
+    //-----------------------------------------------------------
+    // KNOB_AR_ENABLE_TIMELINE
+    //
+    // Write timestamped begin/end events to the ArchRast event files.
+    // Use swr_ar_trace to convert them to a trace-event timeline.
+    // 
+    // NOTE: Requires KNOB_ENABLE_AR to be defined at build time
+    //
+    DEFINE_KNOB(AR_ENABLE_TIMELINE, bool, false);
+
     //-----------------------------------------------------------
     // KNOB_JIT_ENABLE_CACHE
     //
-    // Enables caching of compiled shaders
+    // Enables the on-disk cache of JIT compiled code.
+    // Fetch, blend, streamout and shader objects are shared by all
+    // processes using the same cache directory and CPU.
     //
     DEFINE_KNOB(JIT_ENABLE_CACHE, bool, false);
 
@@ -262,6 +284,15 @@ struct GlobalKnobs
     //
     DEFINE_KNOB(JIT_CACHE_DIR, std::string, "${HOME}/.swr/jitcache");
 
+    //-----------------------------------------------------------
+    // KNOB_JIT_CACHE_MAX_SIZE
+    //
+    // Maximum size of the JIT cache directory, in MB.
+    // The least recently used objects are evicted to stay within it.
+    //   0 == No limit
+    //
+    DEFINE_KNOB(JIT_CACHE_MAX_SIZE, uint32_t, 256);
+
     //-----------------------------------------------------------
     // KNOB_TOSS_DRAW
     //
@@ -355,12 +386,15 @@ extern GlobalKnobs g_GlobalKnobs;
 #define KNOB_BUCKETS_START_FRAME         GET_KNOB(BUCKETS_START_FRAME)
 #define KNOB_BUCKETS_END_FRAME           GET_KNOB(BUCKETS_END_FRAME)
 #define KNOB_WORKER_SPIN_LOOP_COUNT      GET_KNOB(WORKER_SPIN_LOOP_COUNT)
+#define KNOB_BE_SPLIT_MIN_WORK           GET_KNOB(BE_SPLIT_MIN_WORK)
 #define KNOB_MAX_DRAWS_IN_FLIGHT         GET_KNOB(MAX_DRAWS_IN_FLIGHT)
 #define KNOB_MAX_PRIMS_PER_DRAW          GET_KNOB(MAX_PRIMS_PER_DRAW)
 #define KNOB_MAX_TESS_PRIMS_PER_DRAW     GET_KNOB(MAX_TESS_PRIMS_PER_DRAW)
 #define KNOB_DEBUG_OUTPUT_DIR            GET_KNOB(DEBUG_OUTPUT_DIR)
+#define KNOB_AR_ENABLE_TIMELINE          GET_KNOB(AR_ENABLE_TIMELINE)
 #define KNOB_JIT_ENABLE_CACHE            GET_KNOB(JIT_ENABLE_CACHE)
 #define KNOB_JIT_CACHE_DIR               GET_KNOB(JIT_CACHE_DIR)
+#define KNOB_JIT_CACHE_MAX_SIZE          GET_KNOB(JIT_CACHE_MAX_SIZE)
 #define KNOB_TOSS_DRAW                   GET_KNOB(TOSS_DRAW)
 #define KNOB_TOSS_QUEUE_FE               GET_KNOB(TOSS_QUEUE_FE)
 #define KNOB_TOSS_FETCH                  GET_KNOB(TOSS_FETCH)
@@ -155,6 +155,16 @@ KNOBS = [
         'category'  : 'perf',
     }],
 
+    ['BE_SPLIT_MIN_WORK', {
+        'type'      : 'uint32_t',
+        'default'   : '64',
+        'desc'      : ['Minimum number of queued primitives in a macrotile before its',
+                       'owner splits them by sub-tile so idle workers can steal part',
+                       'of the macrotile.',
+                       '  0 == Never split'],
+        'category'  : 'perf',
+    }],
+
     ['MAX_DRAWS_IN_FLIGHT', {
         'type'      : 'uint32_t',
         'default'   : '256',
@@ -189,18 +199,39 @@ KNOBS = [
         'category'  : 'debug',
     }],
 
-    ['JIT_ENABLE_CACHE', {
+    ['AR_ENABLE_TIMELINE', {
         'type'      : 'bool',
         'default'   : 'false',
-        'desc'      : ['Enables caching of compiled shaders'],
+        'desc'      : ['Write timestamped begin/end events to the ArchRast event files.',
+                       'Use swr_ar_trace to convert them to a trace-event timeline.',
+                       '',
+                       'NOTE: Requires KNOB_ENABLE_AR to be defined at build time'],
         'category'  : 'debug',
     }],
 
+    ['JIT_ENABLE_CACHE', {
+        'type'      : 'bool',
+        'default'   : 'false',
+        'desc'      : ['Enables the on-disk cache of JIT compiled code.',
+                       'Fetch, blend, streamout and shader objects are shared by all',
+                       'processes using the same cache directory and CPU.'],
+        'category'  : 'perf',
+    }],
+
     ['JIT_CACHE_DIR', {
         'type'      : 'std::string',
         'default'   : r'%TEMP%\SWR\JitCache' if sys.platform == 'win32' else '${HOME}/.swr/jitcache',
         'desc'      : ['Cache directory for compiled shaders.'],
-        'category'  : 'debug',
+        'category'  : 'perf',
+    }],
+
+    ['JIT_CACHE_MAX_SIZE', {
+        'type'      : 'uint32_t',
+        'default'   : '256',
+        'desc'      : ['Maximum size of the JIT cache directory, in MB.',
+                       'The least recently used objects are evicted to stay within it.',
+                       '  0 == No limit'],
+        'category'  : 'perf',
     }],
 
     ['TOSS_DRAW', {
@@ -0,0 +1,113 @@
+/****************************************************************************
+* Copyright (C) 2018 Intel Corporation.   All Rights Reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice (including the next
+* paragraph) shall be included in all copies or substantial portions of the
+* Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* @file ${filename}
+*
+* @brief Event descriptor tables used to decode event files without
+*        the rasterizer headers.  auto-generated file
+*
+* DO NOT EDIT
+*
+* Generation Command Line:
+*  ${'\n*    '.join(cmdline)}
+*
+******************************************************************************/
+#pragma once
+
+#include <stdint.h>
+
+namespace ArchRast
+{
+    enum EventFieldKind
+    {
+        FIELD_UINT,
+        FIELD_INT,
+        FIELD_FLOAT,
+        FIELD_ENUM,
+    };
+
+    struct EventFieldDesc
+    {
+        const char* pName;
+        EventFieldKind kind;
+        uint32_t offset;
+        uint32_t size;
+        const char* const* pEnumNames;  // value names for FIELD_ENUM fields
+        uint32_t numEnumNames;
+    };
+
+    struct EventDesc
+    {
+        const char* pName;
+        uint32_t size;                  // packed payload size in the event file
+        uint32_t numFields;
+        const EventFieldDesc* pFields;
+    };
+
+% for name in protos['enum_names']:
+    static const char* const ${name}Names[] =
+    {
+% for value in protos['enums'][name]['value_names']:
+        "${value}",
+% endfor
+    };
+
+% endfor
+% for name in protos['event_names']:
+<%
+    event = protos['events'][name]
+%>\
+% if event['num_fields'] > 0:
+    static const EventFieldDesc ${name}Fields[] =
+    {
+% for i in range(event['num_fields']):
+<%
+        field_type = event['field_types'][i]
+        if field_type in protos['enums']:
+            enum_names = '%sNames, sizeof(%sNames) / sizeof(%sNames[0])' % (field_type, field_type, field_type)
+        else:
+            enum_names = 'nullptr, 0'
+%>\
+        { "${event['field_names'][i]}", ${event['field_kinds'][i]}, ${event['field_offsets'][i]}, ${event['field_sizes'][i]}, ${enum_names} },
+% endfor
+    };
+
+% endif
+% endfor
+    // Indexed by event id. Id 0 is never written to event files.
+    static const EventDesc EventDescs[] =
+    {
+        { nullptr, 0, 0, nullptr },
+% for name in protos['event_names']:
+<%
+    event = protos['events'][name]
+%>\
+% if event['num_fields'] > 0:
+        { "${name}", ${event['size']}, ${event['num_fields']}, ${name}Fields },
+% else:
+        { "${name}", 0, 0, nullptr },
+% endif
+% endfor
+    };
+
+    static const uint32_t NumEventDescs = sizeof(EventDescs) / sizeof(EventDescs[0]);
+}
@@ -89,7 +89,7 @@ HANDLE SwrCreateContext(
     for (uint32_t dc = 0; dc < pContext->MAX_DRAWS_IN_FLIGHT; ++dc)
     {
         pContext->dcRing[dc].pArena = new CachingArena(pContext->cachingArenaAllocator);
-        new (&pContext->pMacroTileManagerArray[dc]) MacroTileMgr(*pContext->dcRing[dc].pArena);
+        new (&pContext->pMacroTileManagerArray[dc]) MacroTileMgr(*pContext->dcRing[dc].pArena, pContext->cachingArenaAllocator);
         new (&pContext->pDispatchQueueArray[dc]) DispatchQueue();
 
         pContext->dsRing[dc].pArena = new CachingArena(pContext->cachingArenaAllocator);
@@ -136,6 +136,7 @@ HANDLE SwrCreateContext(
 
     pContext->ppScratch = new uint8_t*[pContext->NumWorkerThreads];
     pContext->pStats = (SWR_STATS*)AlignedMalloc(sizeof(SWR_STATS) * pContext->NumWorkerThreads, 64);
+    pContext->pBEWorkerState = (BE_WORKER_STATE*)AlignedMalloc(sizeof(BE_WORKER_STATE) * pContext->NumWorkerThreads, 64);
 
 #if defined(KNOB_ENABLE_AR)
     // Setup ArchRast thread contexts which includes +1 for API thread.
@@ -158,6 +159,9 @@ HANDLE SwrCreateContext(
         pContext->ppScratch[i] = (uint8_t*)AlignedMalloc(32 * sizeof(KILOBYTE), KNOB_SIMD_WIDTH * 4);
 #endif
 
+        pContext->pBEWorkerState[i].subTile = BE_SUBTILE_ALL;
+        pContext->pBEWorkerState[i].idleStart = 0;
+
 #if defined(KNOB_ENABLE_AR)
         // Initialize worker thread context for ArchRast.
         pContext->pArContext[i] = ArchRast::CreateThreadContext(ArchRast::AR_THREAD::WORKER);
@@ -421,6 +425,7 @@ void SwrDestroyContext(HANDLE hContext)
 
     delete[] pContext->ppScratch;
     AlignedFree(pContext->pStats);
+    AlignedFree(pContext->pBEWorkerState);
 
     delete(pContext->pHotTileMgr);
 
@@ -291,6 +291,8 @@ void BackendNullPS(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint32_t y,
                     uint32_t statMask = _simd_movemask_ps(depthPassMask);
                     uint32_t statCount = _mm_popcnt_u32(statMask);
                     UPDATE_STAT_BE(DepthPassCount, statCount);
+                    UPDATE_STAT_BE(EarlyDepthTestCount, _mm_popcnt_u32(_simd_movemask_ps(vCoverageMask)));
+                    UPDATE_STAT_BE(EarlyDepthKillCount, _mm_popcnt_u32(_simd_movemask_ps(_simd_andnot_ps(depthPassMask, vCoverageMask))));
                 }
 
             Endtile:
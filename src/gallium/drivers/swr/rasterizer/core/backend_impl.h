@@ -934,8 +934,11 @@ void BackendPixelRate(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint32_t
             // Early-Z?
             if(T::bCanEarlyZ && !T::bForcedSampleCount)
             {
+                uint32_t depthTestCount = _mm_popcnt_u32(_simd_movemask_ps(activeLanes));
                 uint32_t depthPassCount = PixelRateZTest(activeLanes, psContext, BEEarlyDepthTest);
                 UPDATE_STAT_BE(DepthPassCount, depthPassCount);
+                UPDATE_STAT_BE(EarlyDepthTestCount, depthTestCount);
+                UPDATE_STAT_BE(EarlyDepthKillCount, depthTestCount - _mm_popcnt_u32(_simd_movemask_ps(activeLanes)));
                 AR_EVENT(EarlyDepthInfoPixelRate(depthPassCount, _simd_movemask_ps(activeLanes)));
             }
 
@@ -146,6 +146,9 @@ void BackendSampleRate(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint32_
                         AR_EVENT(EarlyDepthStencilInfoSampleRate(_simd_movemask_ps(depthPassMask), _simd_movemask_ps(stencilPassMask), _simd_movemask_ps(vCoverageMask)));
                         AR_END(BEEarlyDepthTest, 0);
 
+                        UPDATE_STAT_BE(EarlyDepthTestCount, _mm_popcnt_u32(_simd_movemask_ps(vCoverageMask)));
+                        UPDATE_STAT_BE(EarlyDepthKillCount, _mm_popcnt_u32(_simd_movemask_ps(_simd_andnot_ps(depthPassMask, vCoverageMask))));
+
                         // early-exit if no samples passed depth or earlyZ is forced on.
                         if (state.psState.forceEarlyZ || !_simd_movemask_ps(depthPassMask))
                         {
@@ -130,6 +130,9 @@ void BackendSingleSample(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t x, uint3
                     AR_EVENT(EarlyDepthStencilInfoSingleSample(_simd_movemask_ps(depthPassMask), _simd_movemask_ps(stencilPassMask), _simd_movemask_ps(vCoverageMask)));
                     AR_END(BEEarlyDepthTest, 0);
 
+                    UPDATE_STAT_BE(EarlyDepthTestCount, _mm_popcnt_u32(_simd_movemask_ps(vCoverageMask)));
+                    UPDATE_STAT_BE(EarlyDepthKillCount, _mm_popcnt_u32(_simd_movemask_ps(_simd_andnot_ps(depthPassMask, vCoverageMask))));
+
                     // early-exit if no pixels passed depth or earlyZ is forced on
                     if (state.psState.forceEarlyZ || !_simd_movemask_ps(depthPassMask))
                     {
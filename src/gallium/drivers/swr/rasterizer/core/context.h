@@ -439,6 +439,17 @@ INLINE void* GetPrivateState(const DRAW_CONTEXT* pDC)
 
 class HotTileMgr;
 
+#define BE_SUBTILE_ALL 0xffffffff
+
+//////////////////////////////////////////////////////////////////////////
+/// BE_WORKER_STATE - per worker backend state, one cache line per worker.
+//////////////////////////////////////////////////////////////////////////
+OSALIGNLINE(struct) BE_WORKER_STATE
+{
+    uint32_t subTile;       // Sub-tile of a split macrotile the rasterizer is restricted to, or BE_SUBTILE_ALL.
+    uint64_t idleStart;     // Timestamp of when this worker ran out of backend work, 0 while busy.
+};
+
 struct SWR_CONTEXT
 {
     // Draw Context Ring
@@ -506,6 +517,9 @@ struct SWR_CONTEXT
     // Scratch space for workers.
     uint8_t** ppScratch;
 
+    // Backend scheduling state for workers.
+    BE_WORKER_STATE* pBEWorkerState;
+
     volatile OSALIGNLINE(uint32_t)  drawsOutstandingFE;
 
     OSALIGNLINE(CachingAllocator) cachingArenaAllocator;
@@ -527,8 +541,8 @@ struct SWR_CONTEXT
 #define AR_API_CTX     pContext->pArContext[pContext->NumWorkerThreads]
 
 #ifdef KNOB_ENABLE_AR
-    #define _AR_BEGIN(ctx, type, id)    ArchRast::Dispatch(ctx, ArchRast::Start(ArchRast::type, id))
-    #define _AR_END(ctx, type, count)   ArchRast::Dispatch(ctx, ArchRast::End(ArchRast::type, count))
+    #define _AR_BEGIN(ctx, type, id)    ArchRast::Dispatch(ctx, ArchRast::Start(ArchRast::type, id, __rdtsc()))
+    #define _AR_END(ctx, type, count)   ArchRast::Dispatch(ctx, ArchRast::End(ArchRast::type, count, __rdtsc()))
     #define _AR_EVENT(ctx, event)       ArchRast::Dispatch(ctx, ArchRast::event)
     #define _AR_FLUSH(ctx, id)          ArchRast::FlushDraw(ctx, id)
 #else
@@ -95,6 +95,17 @@ struct QUEUE
         return &mBlocks[block][mHead & (mBlockSize-1)];
     }
 
+    // random access to queued entries, offset 0 is the head
+    T* peek(uint32_t offset)
+    {
+        if (offset >= mNumEntries)
+        {
+            return nullptr;
+        }
+        uint32_t idx = mHead + offset;
+        return &mBlocks[idx >> mBlockSizeShift][idx & (mBlockSize-1)];
+    }
+
     void dequeue_noinc()
     {
         mHead ++;
@@ -128,6 +128,10 @@ void ProcessClear(
     work.pfnWork = ProcessClearBE;
     work.desc.clear = *pDesc;
 
+    // clears and stores usually cover the whole render target, so size the
+    // tile grid once here rather than growing it tile by tile
+    pTileMgr->reserve(macroTileXMax + 1, macroTileYMax + 1);
+
     for (uint32_t y = macroTileYMin; y <= macroTileYMax; ++y)
     {
         for (uint32_t x = macroTileXMin; x <= macroTileXMax; ++x)
@@ -167,6 +171,9 @@ void ProcessStoreTiles(
     work.pfnWork = ProcessStoreTilesBE;
     work.desc.storeTiles = *pDesc;
 
+    // see ProcessClear
+    pTileMgr->reserve(macroTileXMax + 1, macroTileYMax + 1);
+
     for (uint32_t y = macroTileYMin; y <= macroTileYMax; ++y)
     {
         for (uint32_t x = macroTileXMin; x <= macroTileXMax; ++x)
@@ -1525,6 +1532,12 @@ void ProcessDraw(
     DRAW_WORK&          work = *(DRAW_WORK*)pUserData;
     const API_STATE&    state = GetApiState(pDC);
 
+    // Draws too large for one DC are split into batches, only count the first.
+    if (work.startPrimID == 0)
+    {
+        UPDATE_STAT_FE(Draws, 1);
+    }
+
     uint32_t indexSize = 0;
     uint32_t endVertex = work.numVerts;
 
@@ -119,6 +119,16 @@
 #define KNOB_MACROTILE_X_DIM_IN_TILES       (KNOB_MACROTILE_X_DIM >> KNOB_TILE_X_DIM_SHIFT)
 #define KNOB_MACROTILE_Y_DIM_IN_TILES       (KNOB_MACROTILE_Y_DIM >> KNOB_TILE_Y_DIM_SHIFT)
 
+// sub-tiles a heavily loaded macrotile is split into so idle workers can
+// steal part of it, must be whole raster tiles
+#define KNOB_BE_SUBTILE_X_DIM               (KNOB_MACROTILE_X_DIM / 2)
+#define KNOB_BE_SUBTILE_Y_DIM               (KNOB_MACROTILE_Y_DIM / 2)
+#define KNOB_BE_SUBTILE_X_DIM_FIXED         (KNOB_BE_SUBTILE_X_DIM << 8)
+#define KNOB_BE_SUBTILE_Y_DIM_FIXED         (KNOB_BE_SUBTILE_Y_DIM << 8)
+#define KNOB_BE_NUM_SUBTILES_X              (KNOB_MACROTILE_X_DIM / KNOB_BE_SUBTILE_X_DIM)
+#define KNOB_BE_NUM_SUBTILES_Y              (KNOB_MACROTILE_Y_DIM / KNOB_BE_SUBTILE_Y_DIM)
+#define KNOB_BE_NUM_SUBTILES                (KNOB_BE_NUM_SUBTILES_X * KNOB_BE_NUM_SUBTILES_Y)
+
 // total # of hot tiles available. This should be enough to
 // fully render a 16kx16k 128bpp render target
 #define KNOB_NUM_HOT_TILES_X                 256
@@ -135,6 +145,10 @@
 #error "incompatible width/tile dimensions"
 #endif
 
+#if (KNOB_BE_SUBTILE_X_DIM % KNOB_TILE_X_DIM) || (KNOB_BE_SUBTILE_Y_DIM % KNOB_TILE_Y_DIM)
+#error "incompatible sub-tile/tile dimensions"
+#endif
+
 #if ENABLE_AVX512_SIMD16
 #if KNOB_SIMD16_WIDTH == 16 && KNOB_TILE_X_DIM < 8
 #error "incompatible width/tile dimensions"
@@ -284,6 +284,18 @@ void RasterizeSimplePoint(DRAW_CONTEXT *pDC, uint32_t workerId, uint32_t macroTi
     uint32_t tileAlignedY = *(uint32_t*)(workDesc.pTriBuffer + 1);
     float z = *(workDesc.pTriBuffer + 2);
 
+    // skip points outside the sub-tile of a split macrotile
+    uint32_t subTile = pDC->pContext->pBEWorkerState[workerId].subTile;
+    if (subTile != BE_SUBTILE_ALL)
+    {
+        uint32_t subTileX = (tileAlignedX % KNOB_MACROTILE_X_DIM) / KNOB_BE_SUBTILE_X_DIM;
+        uint32_t subTileY = (tileAlignedY % KNOB_MACROTILE_Y_DIM) / KNOB_BE_SUBTILE_Y_DIM;
+        if (subTile != subTileY * KNOB_BE_NUM_SUBTILES_X + subTileX)
+        {
+            return;
+        }
+    }
+
     // construct triangle descriptor for point
     // no interpolation, set up i,j for constant interpolation of z and attribs
     // @todo implement an optimized backend that doesn't require triangle information
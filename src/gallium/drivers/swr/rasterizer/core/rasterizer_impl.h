@@ -1012,6 +1012,26 @@ void RasterizeTriangle(DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroTile,
     intersect.xmax = std::min(intersect.xmax, macroBoxRight);
     intersect.ymax = std::min(intersect.ymax, macroBoxBottom);
 
+    // a macrotile split across workers restricts each of them to one sub-tile
+    uint32_t subTile = pContext->pBEWorkerState[workerId].subTile;
+    if (subTile != BE_SUBTILE_ALL)
+    {
+        int32_t subBoxLeft = macroBoxLeft + (int32_t)(subTile % KNOB_BE_NUM_SUBTILES_X) * KNOB_BE_SUBTILE_X_DIM_FIXED;
+        int32_t subBoxTop = macroBoxTop + (int32_t)(subTile / KNOB_BE_NUM_SUBTILES_X) * KNOB_BE_SUBTILE_Y_DIM_FIXED;
+
+        intersect.xmin = std::max(intersect.xmin, subBoxLeft);
+        intersect.ymin = std::max(intersect.ymin, subBoxTop);
+        intersect.xmax = std::min(intersect.xmax, subBoxLeft + KNOB_BE_SUBTILE_X_DIM_FIXED - 1);
+        intersect.ymax = std::min(intersect.ymax, subBoxTop + KNOB_BE_SUBTILE_Y_DIM_FIXED - 1);
+
+        if (intersect.xmin > intersect.xmax || intersect.ymin > intersect.ymax)
+        {
+            AR_END(BETriangleSetup, 0);
+            AR_END(BERasterizeTriangle, 1);
+            return;
+        }
+    }
+
     SWR_ASSERT(intersect.xmin <= intersect.xmax && intersect.ymin <= intersect.ymax && intersect.xmin >= 0 && intersect.xmax >= 0 && intersect.ymin >= 0 && intersect.ymax >= 0);
 
     AR_END(BETriangleSetup, 0);
@@ -612,6 +612,11 @@ OSALIGNLINE(struct) SWR_STATS
     uint64_t PsInvocations;  // Number of Pixel Shader invocations
     uint64_t CsInvocations;  // Number of Compute Shader invocations
 
+    // Backend tuning counters
+    uint64_t EarlyDepthTestCount; // Number of covered pixels/samples depth tested before the PS
+    uint64_t EarlyDepthKillCount; // Number of those that failed the early depth test
+    uint64_t MacroTiles;          // Number of macrotiles rendered
+    uint64_t BeCycles;            // Cycles spent by workers on backend work
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -634,6 +639,10 @@ OSALIGNLINE(struct) SWR_STATS_FE
     // Streamout Stats
     uint64_t SoPrimStorageNeeded[4];
     uint64_t SoNumPrimsWritten[4];
+
+    // Frontend tuning counters
+    uint64_t Draws;         // Number of draws, not counting split batches
+    uint64_t FeCycles;      // Cycles spent by workers on frontend work
 };
 
 //////////////////////////////////////////////////////////////////////////
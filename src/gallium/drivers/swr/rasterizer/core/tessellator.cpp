@@ -0,0 +1,706 @@
+/****************************************************************************
+* Copyright (C) 2018 Intel Corporation.   All Rights Reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice (including the next
+* paragraph) shall be included in all copies or substantial portions of the
+* Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+* IN THE SOFTWARE.
+*
+* @file tessellator.cpp
+*
+* @brief Tessellator fixed function unit.
+*
+*        The domain is built as a set of concentric rings.  The outermost
+*        ring is subdivided by the outer tessellation factors, every inner
+*        ring by the inner factors, and neighbouring rings are stitched
+*        together side by side.  Edge points are placed symmetrically, so
+*        an edge shared by two patches gets the same points whichever way
+*        each patch walks it.
+*
+******************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <new>
+
+#include "api.h"
+#include "utils.h"
+#include "tessellator.h"
+
+namespace
+{
+    const uint32_t TS_MAX_FACTOR = 64;
+
+    // Worst case is a quad domain with all factors at 64: a 65x65 grid of
+    // points, and at most two triangles per point.  Both rounded up to a
+    // multiple of 16 for the SIMD readers.
+    const uint32_t TS_MAX_POINTS = ((TS_MAX_FACTOR + 1) * (TS_MAX_FACTOR + 1) + 15) & ~15u;
+    const uint32_t TS_MAX_PRIMS = (2 * (TS_MAX_FACTOR + 1) * (TS_MAX_FACTOR + 1) + 15) & ~15u;
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief One ring of the domain, walked counter-clockwise in (u, v).
+    ///        Neighbouring sides share their corner point.  A side may have
+    ///        no segments at all when the ring collapses to a line or point.
+    struct TSRing
+    {
+        uint32_t numSegs[4];
+        uint32_t idx[4][TS_MAX_FACTOR + 1];
+        float t[4][TS_MAX_FACTOR + 1];  // position along the side, 0..1
+    };
+
+    struct TSContext
+    {
+        SWR_TS_DOMAIN domain;
+        SWR_TS_PARTITIONING partitioning;
+        SWR_TS_OUTPUT_TOPOLOGY outputTopology;
+
+        uint32_t numPoints;
+        uint32_t numPrims;
+
+        float* pU;
+        float* pV;
+        uint32_t* pIndices[3];
+
+        TSRing rings[2];
+    };
+
+    INLINE size_t TSContextSize()
+    {
+        return AlignUp(sizeof(TSContext), 64) +
+            2 * TS_MAX_POINTS * sizeof(float) +
+            3 * TS_MAX_PRIMS * sizeof(uint32_t);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Clamp and round a tessellation factor for the partitioning.
+    /// @param numSegs - receives the number of segments the edge is cut into
+    /// @return the clamped factor, which may be fractional
+    float ProcessFactor(float factor, SWR_TS_PARTITIONING partitioning, uint32_t& numSegs)
+    {
+        float minFactor = (partitioning == SWR_TS_EVEN_FRACTIONAL) ? 2.0f : 1.0f;
+        float maxFactor = (partitioning == SWR_TS_ODD_FRACTIONAL) ? float(TS_MAX_FACTOR - 1) : float(TS_MAX_FACTOR);
+
+        // written so that NaN ends up at the minimum
+        if (!(factor > minFactor))
+        {
+            factor = minFactor;
+        }
+        if (factor > maxFactor)
+        {
+            factor = maxFactor;
+        }
+
+        numSegs = (uint32_t)std::ceil(factor);
+
+        switch (partitioning)
+        {
+        case SWR_TS_INTEGER:
+            factor = (float)numSegs;
+            break;
+        case SWR_TS_ODD_FRACTIONAL:
+            numSegs |= 1;
+            break;
+        case SWR_TS_EVEN_FRACTIONAL:
+            numSegs += numSegs & 1;
+            break;
+        default:
+            SWR_INVALID("Invalid tessellation partitioning: %d", partitioning);
+            break;
+        }
+
+        return factor;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Positions (0..1) of the points cutting an edge into numSegs
+    ///        segments.  All segments have the same length, except that for
+    ///        a fractional factor the two segments next to the middle are
+    ///        shorter.  The result is symmetric: pos[i] == 1 - pos[numSegs - i].
+    void EdgePositions(float factor, uint32_t numSegs, float* pPos)
+    {
+        pPos[0] = 0.0f;
+        pPos[numSegs] = 1.0f;
+        if (numSegs == 1)
+        {
+            return;
+        }
+
+        float shortLen = (factor - float(numSegs - 2)) * 0.5f;
+        uint32_t short0 = (numSegs & 1) ? (numSegs - 3) / 2 : numSegs / 2 - 1;
+        uint32_t short1 = (numSegs & 1) ? (numSegs + 1) / 2 : numSegs / 2;
+        float rcpFactor = 1.0f / factor;
+
+        float sum = 0.0f;
+        for (uint32_t i = 1; i <= numSegs / 2; ++i)
+        {
+            uint32_t seg = i - 1;
+            sum += (seg == short0 || seg == short1) ? shortLen : 1.0f;
+            pPos[i] = sum * rcpFactor;
+        }
+        if (!(numSegs & 1))
+        {
+            pPos[numSegs / 2] = 0.5f;
+        }
+        for (uint32_t i = numSegs / 2 + 1; i < numSegs; ++i)
+        {
+            pPos[i] = 1.0f - pPos[numSegs - i];
+        }
+    }
+
+    INLINE uint32_t AddPoint(TSContext* pCtx, float u, float v)
+    {
+        SWR_ASSERT(pCtx->numPoints < TS_MAX_POINTS);
+        pCtx->pU[pCtx->numPoints] = u;
+        pCtx->pV[pCtx->numPoints] = v;
+        return pCtx->numPoints++;
+    }
+
+    /// Triangles are generated counter-clockwise in (u, v).
+    INLINE void AddTri(TSContext* pCtx, uint32_t i0, uint32_t i1, uint32_t i2)
+    {
+        switch (pCtx->outputTopology)
+        {
+        case SWR_TS_OUTPUT_TRI_CCW:
+            break;
+        case SWR_TS_OUTPUT_TRI_CW:
+            std::swap(i1, i2);
+            break;
+        default:
+            // points are emitted at the end, lines only exist for isolines
+            return;
+        }
+
+        SWR_ASSERT(pCtx->numPrims < TS_MAX_PRIMS);
+        pCtx->pIndices[0][pCtx->numPrims] = i0;
+        pCtx->pIndices[1][pCtx->numPrims] = i1;
+        pCtx->pIndices[2][pCtx->numPrims] = i2;
+        pCtx->numPrims++;
+    }
+
+    INLINE void AddLine(TSContext* pCtx, uint32_t i0, uint32_t i1)
+    {
+        if (pCtx->outputTopology != SWR_TS_OUTPUT_LINE)
+        {
+            return;
+        }
+
+        SWR_ASSERT(pCtx->numPrims < TS_MAX_PRIMS);
+        pCtx->pIndices[0][pCtx->numPrims] = i0;
+        pCtx->pIndices[1][pCtx->numPrims] = i1;
+        pCtx->pIndices[2][pCtx->numPrims] = 0;
+        pCtx->numPrims++;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Triangulate the strip between a side of a ring and the same
+    ///        side of the next ring inwards.  Walks both sides together,
+    ///        always advancing the one whose next segment starts earlier.
+    void StitchSide(TSContext* pCtx, const TSRing& outer, const TSRing& inner, uint32_t side)
+    {
+        const uint32_t* pOuter = outer.idx[side];
+        const uint32_t* pInner = inner.idx[side];
+        const float* tOuter = outer.t[side];
+        const float* tInner = inner.t[side];
+        uint32_t numOuter = outer.numSegs[side];
+        uint32_t numInner = inner.numSegs[side];
+
+        uint32_t i = 0, j = 0;
+        while (i < numOuter || j < numInner)
+        {
+            bool advanceOuter;
+            if (i == numOuter)
+            {
+                advanceOuter = false;
+            }
+            else if (j == numInner)
+            {
+                advanceOuter = true;
+            }
+            else
+            {
+                advanceOuter = (tOuter[i] + tOuter[i + 1]) <= (tInner[j] + tInner[j + 1]);
+            }
+
+            if (advanceOuter)
+            {
+                AddTri(pCtx, pOuter[i], pOuter[i + 1], pInner[j]);
+                ++i;
+            }
+            else
+            {
+                AddTri(pCtx, pOuter[i], pInner[j + 1], pInner[j]);
+                ++j;
+            }
+        }
+    }
+
+    void StitchRings(TSContext* pCtx, const TSRing& outer, const TSRing& inner, uint32_t numSides)
+    {
+        for (uint32_t side = 0; side < numSides; ++side)
+        {
+            StitchSide(pCtx, outer, inner, side);
+        }
+    }
+
+    /// Fill one side of a ring with points on the line from (u0,v0) to
+    /// (u1,v1), at the given positions.  The corners must already be set.
+    void FillSide(TSContext* pCtx, TSRing& ring, uint32_t side, uint32_t numSegs,
+                  float u0, float v0, float u1, float v1, const float* pT)
+    {
+        ring.numSegs[side] = numSegs;
+        for (uint32_t j = 0; j <= numSegs; ++j)
+        {
+            ring.t[side][j] = pT[j];
+            if (j > 0 && j < numSegs)
+            {
+                float t = pT[j];
+                ring.idx[side][j] = AddPoint(pCtx, u0 + (u1 - u0) * t, v0 + (v1 - v0) * t);
+            }
+        }
+    }
+
+    /// Side that reuses the points of another side, walked the other way
+    void ReverseSide(TSRing& ring, uint32_t side, uint32_t srcSide)
+    {
+        uint32_t numSegs = ring.numSegs[srcSide];
+        ring.numSegs[side] = numSegs;
+        for (uint32_t j = 0; j <= numSegs; ++j)
+        {
+            ring.idx[side][j] = ring.idx[srcSide][numSegs - j];
+            ring.t[side][j] = 1.0f - ring.t[srcSide][numSegs - j];
+        }
+    }
+
+    /// Positions pPos[first..first + numSegs], renormalized to 0..1
+    void SubPositions(const float* pPos, uint32_t first, uint32_t numSegs, float* pT)
+    {
+        float start = pPos[first];
+        float scale = numSegs ? 1.0f / (pPos[first + numSegs] - start) : 0.0f;
+        for (uint32_t j = 0; j <= numSegs; ++j)
+        {
+            pT[j] = (pPos[first + j] - start) * scale;
+        }
+        if (numSegs)
+        {
+            pT[numSegs] = 1.0f;
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Triangle domain.  Corners are W (0,0), U (1,0) and V (0,1).
+    void TessellateTri(TSContext* pCtx, const SWR_TESSELLATION_FACTORS& factors)
+    {
+        float outer[3];
+        uint32_t outerSegs[3];
+        for (uint32_t i = 0; i < 3; ++i)
+        {
+            outer[i] = ProcessFactor(factors.OuterTessFactors[i], pCtx->partitioning, outerSegs[i]);
+        }
+        uint32_t innerSegs;
+        float inner = ProcessFactor(factors.InnerTessFactors[SWR_QUAD_U_TRI_INSIDE], pCtx->partitioning, innerSegs);
+
+        uint32_t cornerW = AddPoint(pCtx, 0.0f, 0.0f);
+        uint32_t cornerU = AddPoint(pCtx, 1.0f, 0.0f);
+        uint32_t cornerV = AddPoint(pCtx, 0.0f, 1.0f);
+
+        if (innerSegs == 1)
+        {
+            if (outerSegs[0] == 1 && outerSegs[1] == 1 && outerSegs[2] == 1)
+            {
+                AddTri(pCtx, cornerW, cornerU, cornerV);
+                return;
+            }
+            // treated as slightly more than one, to get an inner ring
+            inner = ProcessFactor(std::nextafter(1.0f, 2.0f), pCtx->partitioning, innerSegs);
+        }
+
+        float pos[TS_MAX_FACTOR + 1];
+        float t[TS_MAX_FACTOR + 1];
+
+        // Outer ring: W->U is v == 0, U->V is w == 0, V->W is u == 0
+        TSRing* pOuter = &pCtx->rings[0];
+        const uint32_t corners[4] = { cornerW, cornerU, cornerV, cornerW };
+        static const uint32_t sideFactor[3] = { SWR_QUAD_V_EQ0_TRI_V_LINE_DENSITY, SWR_QUAD_U_EQ1_TRI_W, SWR_QUAD_U_EQ0_TRI_U_LINE_DETAIL };
+        static const float sideCoords[3][4] = { { 0, 0, 1, 0 }, { 1, 0, 0, 1 }, { 0, 1, 0, 0 } };
+        for (uint32_t side = 0; side < 3; ++side)
+        {
+            uint32_t f = sideFactor[side];
+            EdgePositions(outer[f], outerSegs[f], pos);
+            pOuter->idx[side][0] = corners[side];
+            pOuter->idx[side][outerSegs[f]] = corners[side + 1];
+            const float* c = sideCoords[side];
+            FillSide(pCtx, *pOuter, side, outerSegs[f], c[0], c[1], c[2], c[3], pos);
+        }
+
+        // Inner rings
+        EdgePositions(inner, innerSegs, pos);
+        uint32_t numRings = innerSegs / 2;
+        for (uint32_t ring = 1; ring <= numRings; ++ring)
+        {
+            TSRing* pInner = &pCtx->rings[ring & 1];
+            uint32_t numSegs = innerSegs - 2 * ring;
+
+            if (numSegs == 0)
+            {
+                uint32_t center = AddPoint(pCtx, 1.0f / 3.0f, 1.0f / 3.0f);
+                for (uint32_t side = 0; side < 3; ++side)
+                {
+                    pInner->numSegs[side] = 0;
+                    pInner->idx[side][0] = center;
+                    pInner->t[side][0] = 0.0f;
+                }
+            }
+            else
+            {
+                // corners where the perpendiculars to the outer edges
+                // through the ring's first points meet
+                float b = pos[ring] * (2.0f / 3.0f);
+                float ringCoords[4][2] = { { b, b }, { 1.0f - 2.0f * b, b }, { b, 1.0f - 2.0f * b }, { b, b } };
+                uint32_t ringCorners[4];
+                ringCorners[0] = AddPoint(pCtx, ringCoords[0][0], ringCoords[0][1]);
+                ringCorners[1] = AddPoint(pCtx, ringCoords[1][0], ringCoords[1][1]);
+                ringCorners[2] = AddPoint(pCtx, ringCoords[2][0], ringCoords[2][1]);
+                ringCorners[3] = ringCorners[0];
+
+                SubPositions(pos, ring, numSegs, t);
+                for (uint32_t side = 0; side < 3; ++side)
+                {
+                    pInner->idx[side][0] = ringCorners[side];
+                    pInner->idx[side][numSegs] = ringCorners[side + 1];
+                    FillSide(pCtx, *pInner, side, numSegs,
+                             ringCoords[side][0], ringCoords[side][1],
+                             ringCoords[side + 1][0], ringCoords[side + 1][1], t);
+                }
+            }
+
+            StitchRings(pCtx, *pOuter, *pInner, 3);
+            pOuter = pInner;
+        }
+
+        // odd number of inner segments leaves a single triangle
+        if (innerSegs & 1)
+        {
+            AddTri(pCtx, pOuter->idx[0][0], pOuter->idx[1][0], pOuter->idx[2][0]);
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Quad domain.  Sides are v == 0, u == 1, v == 1 and u == 0.
+    void TessellateQuad(TSContext* pCtx, const SWR_TESSELLATION_FACTORS& factors)
+    {
+        float outer[4];
+        uint32_t outerSegs[4];
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            outer[i] = ProcessFactor(factors.OuterTessFactors[i], pCtx->partitioning, outerSegs[i]);
+        }
+        float inner[2];
+        uint32_t innerSegs[2];
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            inner[i] = ProcessFactor(factors.InnerTessFactors[i], pCtx->partitioning, innerSegs[i]);
+        }
+
+        uint32_t corners[5];
+        corners[0] = AddPoint(pCtx, 0.0f, 0.0f);
+        corners[1] = AddPoint(pCtx, 1.0f, 0.0f);
+        corners[2] = AddPoint(pCtx, 1.0f, 1.0f);
+        corners[3] = AddPoint(pCtx, 0.0f, 1.0f);
+        corners[4] = corners[0];
+
+        if (innerSegs[0] == 1 && innerSegs[1] == 1 &&
+            outerSegs[0] == 1 && outerSegs[1] == 1 && outerSegs[2] == 1 && outerSegs[3] == 1)
+        {
+            AddTri(pCtx, corners[0], corners[1], corners[2]);
+            AddTri(pCtx, corners[0], corners[2], corners[3]);
+            return;
+        }
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            if (innerSegs[i] == 1)
+            {
+                inner[i] = ProcessFactor(std::nextafter(1.0f, 2.0f), pCtx->partitioning, innerSegs[i]);
+            }
+        }
+
+        float pos[TS_MAX_FACTOR + 1];
+        float t[TS_MAX_FACTOR + 1];
+
+        TSRing* pOuter = &pCtx->rings[0];
+        static const uint32_t sideFactor[4] = { SWR_QUAD_V_EQ0_TRI_V_LINE_DENSITY, SWR_QUAD_U_EQ1_TRI_W, SWR_QUAD_V_EQ1, SWR_QUAD_U_EQ0_TRI_U_LINE_DETAIL };
+        static const float sideCoords[4][4] = { { 0, 0, 1, 0 }, { 1, 0, 1, 1 }, { 1, 1, 0, 1 }, { 0, 1, 0, 0 } };
+        for (uint32_t side = 0; side < 4; ++side)
+        {
+            uint32_t f = sideFactor[side];
+            EdgePositions(outer[f], outerSegs[f], pos);
+            pOuter->idx[side][0] = corners[side];
+            pOuter->idx[side][outerSegs[f]] = corners[side + 1];
+            const float* c = sideCoords[side];
+            FillSide(pCtx, *pOuter, side, outerSegs[f], c[0], c[1], c[2], c[3], pos);
+        }
+
+        float posU[TS_MAX_FACTOR + 1];
+        float posV[TS_MAX_FACTOR + 1];
+        uint32_t segsU = innerSegs[SWR_QUAD_U_TRI_INSIDE];
+        uint32_t segsV = innerSegs[SWR_QUAD_V_INSIDE];
+        EdgePositions(inner[SWR_QUAD_U_TRI_INSIDE], segsU, posU);
+        EdgePositions(inner[SWR_QUAD_V_INSIDE], segsV, posV);
+
+        uint32_t numRings = std::min(segsU, segsV) / 2;
+        for (uint32_t ring = 1; ring <= numRings; ++ring)
+        {
+            TSRing* pInner = &pCtx->rings[ring & 1];
+            uint32_t numU = segsU - 2 * ring;
+            uint32_t numV = segsV - 2 * ring;
+            float u0 = posU[ring], u1 = posU[segsU - ring];
+            float v0 = posV[ring], v1 = posV[segsV - ring];
+
+            // the ring collapses to a vertical line, horizontal line or a
+            // point when there are no segments left in one direction
+            uint32_t ringCorners[5];
+            ringCorners[0] = AddPoint(pCtx, u0, v0);
+            ringCorners[1] = numU ? AddPoint(pCtx, u1, v0) : ringCorners[0];
+            ringCorners[2] = numV ? AddPoint(pCtx, u1, v1) : ringCorners[1];
+            ringCorners[3] = numU ? (numV ? AddPoint(pCtx, u0, v1) : ringCorners[0]) : ringCorners[2];
+            ringCorners[4] = ringCorners[0];
+            for (uint32_t side = 0; side < 4; ++side)
+            {
+                uint32_t numSegs = (side & 1) ? numV : numU;
+                pInner->idx[side][0] = ringCorners[side];
+                pInner->idx[side][numSegs] = ringCorners[side + 1];
+            }
+
+            // bottom and right
+            SubPositions(posU, ring, numU, t);
+            FillSide(pCtx, *pInner, 0, numU, u0, v0, u1, v0, t);
+            SubPositions(posV, ring, numV, t);
+            FillSide(pCtx, *pInner, 1, numV, u1, v0, u1, v1, t);
+
+            // top and left, which are the bottom and right again if the
+            // ring has no height or width
+            if (numV)
+            {
+                SubPositions(posU, ring, numU, t);
+                for (uint32_t j = 0; j <= numU; ++j)
+                {
+                    t[j] = 1.0f - t[j];
+                }
+                std::reverse(t, t + numU + 1);
+                FillSide(pCtx, *pInner, 2, numU, u1, v1, u0, v1, t);
+            }
+            else
+            {
+                ReverseSide(*pInner, 2, 0);
+            }
+            if (numU)
+            {
+                SubPositions(posV, ring, numV, t);
+                for (uint32_t j = 0; j <= numV; ++j)
+                {
+                    t[j] = 1.0f - t[j];
+                }
+                std::reverse(t, t + numV + 1);
+                FillSide(pCtx, *pInner, 3, numV, u0, v1, u0, v0, t);
+            }
+            else
+            {
+                ReverseSide(*pInner, 3, 1);
+            }
+
+            StitchRings(pCtx, *pOuter, *pInner, 4);
+            pOuter = pInner;
+        }
+
+        // An odd count in the shorter direction leaves a strip one segment
+        // wide in the middle
+        uint32_t numU = pOuter->numSegs[0];
+        uint32_t numV = pOuter->numSegs[1];
+        if (numU && numV)
+        {
+            const uint32_t* pBottom = pOuter->idx[0];
+            const uint32_t* pRight = pOuter->idx[1];
+            const uint32_t* pTop = pOuter->idx[2];
+            const uint32_t* pLeft = pOuter->idx[3];
+            if (numV == 1)
+            {
+                for (uint32_t c = 0; c < numU; ++c)
+                {
+                    AddTri(pCtx, pBottom[c], pBottom[c + 1], pTop[numU - c - 1]);
+                    AddTri(pCtx, pBottom[c], pTop[numU - c - 1], pTop[numU - c]);
+                }
+            }
+            else
+            {
+                SWR_ASSERT(numU == 1);
+                for (uint32_t r = 0; r < numV; ++r)
+                {
+                    AddTri(pCtx, pLeft[numV - r], pRight[r], pRight[r + 1]);
+                    AddTri(pCtx, pLeft[numV - r], pRight[r + 1], pLeft[numV - r - 1]);
+                }
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Isoline domain.  Lines of constant v, the number of lines is
+    ///        always integer partitioned.
+    void TessellateIsoline(TSContext* pCtx, const SWR_TESSELLATION_FACTORS& factors)
+    {
+        uint32_t numLines;
+        ProcessFactor(factors.OuterTessFactors[SWR_QUAD_V_EQ0_TRI_V_LINE_DENSITY], SWR_TS_INTEGER, numLines);
+
+        uint32_t numSegs;
+        float detail = ProcessFactor(factors.OuterTessFactors[SWR_QUAD_U_EQ0_TRI_U_LINE_DETAIL], pCtx->partitioning, numSegs);
+
+        float pos[TS_MAX_FACTOR + 1];
+        EdgePositions(detail, numSegs, pos);
+
+        for (uint32_t line = 0; line < numLines; ++line)
+        {
+            float v = float(line) / float(numLines);
+            uint32_t first = AddPoint(pCtx, pos[0], v);
+            for (uint32_t j = 1; j <= numSegs; ++j)
+            {
+                AddPoint(pCtx, pos[j], v);
+                AddLine(pCtx, first + j - 1, first + j);
+            }
+        }
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Allocate and initialize a new tessellation context
+HANDLE SWR_API TSInitCtx(
+    SWR_TS_DOMAIN tsDomain,
+    SWR_TS_PARTITIONING tsPartitioning,
+    SWR_TS_OUTPUT_TOPOLOGY tsOutputTopology,
+    void* pContextMem,
+    size_t& memSize)
+{
+    size_t requiredSize = TSContextSize();
+    if (pContextMem == nullptr || memSize < requiredSize)
+    {
+        memSize = requiredSize;
+        return NULL;
+    }
+    SWR_ASSERT(((uintptr_t)pContextMem & 63) == 0);
+
+    TSContext* pCtx = new (pContextMem) TSContext;
+    pCtx->domain = tsDomain;
+    pCtx->partitioning = tsPartitioning;
+    pCtx->outputTopology = tsOutputTopology;
+    pCtx->numPoints = 0;
+    pCtx->numPrims = 0;
+
+    uint8_t* pMem = (uint8_t*)pContextMem + AlignUp(sizeof(TSContext), 64);
+    pCtx->pU = (float*)pMem;
+    pMem += TS_MAX_POINTS * sizeof(float);
+    pCtx->pV = (float*)pMem;
+    pMem += TS_MAX_POINTS * sizeof(float);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        pCtx->pIndices[i] = (uint32_t*)pMem;
+        pMem += TS_MAX_PRIMS * sizeof(uint32_t);
+    }
+
+    return pCtx;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Destroy a tessellation context.  The memory belongs to the caller.
+void SWR_API TSDestroyCtx(HANDLE tsCtx)
+{
+    TSContext* pCtx = (TSContext*)tsCtx;
+    if (pCtx)
+    {
+        pCtx->~TSContext();
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Tessellate one patch
+void SWR_API TSTessellate(
+    HANDLE tsCtx,
+    const SWR_TESSELLATION_FACTORS& tsTessFactors,
+    SWR_TS_TESSELLATED_DATA& tsTessellatedData)
+{
+    TSContext* pCtx = (TSContext*)tsCtx;
+    SWR_ASSERT(pCtx);
+
+    pCtx->numPoints = 0;
+    pCtx->numPrims = 0;
+
+    // A patch is culled if any of the outer factors that apply to its
+    // domain is zero, negative or NaN
+    uint32_t numOuter = 4;
+    switch (pCtx->domain)
+    {
+    case SWR_TS_TRI: numOuter = 3; break;
+    case SWR_TS_ISOLINE: numOuter = 2; break;
+    default: break;
+    }
+    bool culled = false;
+    for (uint32_t i = 0; i < numOuter; ++i)
+    {
+        culled |= !(tsTessFactors.OuterTessFactors[i] > 0.0f);
+    }
+
+    if (!culled)
+    {
+        switch (pCtx->domain)
+        {
+        case SWR_TS_QUAD: TessellateQuad(pCtx, tsTessFactors); break;
+        case SWR_TS_TRI: TessellateTri(pCtx, tsTessFactors); break;
+        case SWR_TS_ISOLINE: TessellateIsoline(pCtx, tsTessFactors); break;
+        default: SWR_INVALID("Invalid tessellation domain: %d", pCtx->domain); break;
+        }
+
+        if (pCtx->outputTopology == SWR_TS_OUTPUT_POINT)
+        {
+            for (uint32_t i = 0; i < pCtx->numPoints; ++i)
+            {
+                pCtx->pIndices[0][i] = i;
+            }
+            pCtx->numPrims = pCtx->numPoints;
+        }
+    }
+    else
+    {
+        pCtx->numPoints = 0;
+    }
+
+    // zero the padding up to the next 16 entries
+    for (uint32_t i = pCtx->numPoints; i < AlignUp(pCtx->numPoints, 16); ++i)
+    {
+        pCtx->pU[i] = 0.0f;
+        pCtx->pV[i] = 0.0f;
+    }
+    for (uint32_t i = pCtx->numPrims; i < AlignUp(pCtx->numPrims, 16); ++i)
+    {
+        pCtx->pIndices[0][i] = 0;
+        pCtx->pIndices[1][i] = 0;
+        pCtx->pIndices[2][i] = 0;
+    }
+
+    tsTessellatedData.NumPrimitives = pCtx->numPrims;
+    tsTessellatedData.NumDomainPoints = pCtx->numPoints;
+    tsTessellatedData.ppIndices[0] = pCtx->pIndices[0];
+    tsTessellatedData.ppIndices[1] = pCtx->pIndices[1];
+    tsTessellatedData.ppIndices[2] = pCtx->pIndices[2];
+    tsTessellatedData.pDomainPointsU = pCtx->pU;
+    tsTessellatedData.pDomainPointsV = pCtx->pV;
+}
@@ -39,6 +39,10 @@ HANDLE SWR_API TSInitCtx(
 void SWR_API TSDestroyCtx(
     HANDLE tsCtx);  ///< [IN] Tessellation context to be destroyed
 
+/// Output of TSTessellate.  The arrays live in the tessellation context and
+/// stay valid until the next TSTessellate call on it.  They are 64 byte
+/// aligned and zero padded to a multiple of 16 entries, so they can be read
+/// a full SIMD at a time.
 struct SWR_TS_TESSELLATED_DATA
 {
     uint32_t NumPrimitives;
@@ -55,34 +59,3 @@ void SWR_API TSTessellate(
     HANDLE tsCtx,                                   ///< [IN] Tessellation Context
     const SWR_TESSELLATION_FACTORS& tsTessFactors,  ///< [IN] Tessellation Factors
     SWR_TS_TESSELLATED_DATA& tsTessellatedData);    ///< [OUT] Tessellated Data
-
-
-
-/// @TODO - Implement OSS tessellator
-
-INLINE HANDLE SWR_API TSInitCtx(
-    SWR_TS_DOMAIN tsDomain,
-    SWR_TS_PARTITIONING tsPartitioning,
-    SWR_TS_OUTPUT_TOPOLOGY tsOutputTopology,
-    void* pContextMem,
-    size_t& memSize)
-{
-    SWR_NOT_IMPL;
-    return NULL;
-}
-
-
-INLINE void SWR_API TSDestroyCtx(HANDLE tsCtx)
-{
-    SWR_NOT_IMPL;
-}
-
-
-INLINE void SWR_API TSTessellate(
-    HANDLE tsCtx,
-    const SWR_TESSELLATION_FACTORS& tsTessFactors,
-    SWR_TS_TESSELLATED_DATA& tsTessellatedData)
-{
-    SWR_NOT_IMPL;
-}
-
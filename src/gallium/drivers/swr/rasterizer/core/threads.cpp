@@ -366,6 +366,11 @@ INLINE void UpdateClientStats(SWR_CONTEXT* pContext, uint32_t workerId, DRAW_CON
 
         stats.PsInvocations  += dynState.pStats[i].PsInvocations;
         stats.CsInvocations  += dynState.pStats[i].CsInvocations;
+
+        stats.EarlyDepthTestCount += dynState.pStats[i].EarlyDepthTestCount;
+        stats.EarlyDepthKillCount += dynState.pStats[i].EarlyDepthKillCount;
+        stats.MacroTiles          += dynState.pStats[i].MacroTiles;
+        stats.BeCycles            += dynState.pStats[i].BeCycles;
     }
 
 
@@ -451,6 +456,101 @@ INLINE bool FindFirstIncompleteDraw(SWR_CONTEXT* pContext, uint32_t workerId, ui
     return IDComparesLess(curDrawBE, drawEnqueued);
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Start timing a stretch where this worker has no macrotile to
+///        work on, unless one is already being timed.
+INLINE void BeginIdleBE(SWR_CONTEXT* pContext, uint32_t workerId)
+{
+#if defined(KNOB_ENABLE_AR)
+    BE_WORKER_STATE& state = pContext->pBEWorkerState[workerId];
+    if (state.idleStart == 0)
+    {
+        state.idleStart = __rdtsc();
+    }
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Worker found backend work, report how long it went without.
+INLINE void EndIdleBE(SWR_CONTEXT* pContext, uint32_t workerId)
+{
+#if defined(KNOB_ENABLE_AR)
+    BE_WORKER_STATE& state = pContext->pBEWorkerState[workerId];
+    if (state.idleStart != 0)
+    {
+        AR_EVENT(WorkerIdleInfo(__rdtsc() - state.idleStart));
+        state.idleStart = 0;
+    }
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Returns how many work items at the front of the macrotile can be
+///        split by sub-tile together. That is a run of DRAW work rendering to
+///        the same array slice, any other work item is a run of its own.
+INLINE uint32_t GetSplitRunLength(MacroTileQueue* tile)
+{
+    BE_WORK* pWork = tile->peek();
+    if (pWork->type != DRAW)
+    {
+        return 1;
+    }
+
+    uint32_t renderTargetArrayIndex = pWork->desc.tri.triFlags.renderTargetArrayIndex;
+    uint32_t numItems = 1;
+    while ((pWork = tile->peek(numItems)) != nullptr &&
+           pWork->type == DRAW &&
+           pWork->desc.tri.triFlags.renderTargetArrayIndex == renderTargetArrayIndex)
+    {
+        numItems++;
+    }
+
+    return numItems;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Claim sub-tiles of a split macrotile and run the split's work
+///        items on each of them. Pixels never cross sub-tiles and each
+///        sub-tile runs the items in queue order on a single worker, so
+///        per pixel ordering is the same as without the split.
+/// @param bStolen - true if another worker holds the macrotile's lock.
+/// @returns        number of sub-tiles this worker processed.
+INLINE uint32_t WorkOnSubTiles(DRAW_CONTEXT* pDC, uint32_t workerId, MacroTileQueue* tile, bool bStolen)
+{
+    SWR_CONTEXT* pContext = pDC->pContext;
+    BE_WORKER_STATE& state = pContext->pBEWorkerState[workerId];
+
+    uint32_t numSubTiles = 0;
+    uint32_t subTile;
+    while (tile->claimSubTile(subTile))
+    {
+        EndIdleBE(pContext, workerId);
+
+        uint64_t start = __rdtsc();
+        uint32_t numItems = tile->getSplitNumItems();
+
+        state.subTile = subTile;
+        for (uint32_t i = 0; i < numItems; ++i)
+        {
+            BE_WORK* pWork = tile->peek(i);
+            pWork->pfnWork(pDC, workerId, tile->mId, &pWork->desc);
+        }
+        state.subTile = BE_SUBTILE_ALL;
+
+        // The owner's time is counted by WorkOnFifoBE.
+        if (bStolen)
+        {
+            AR_EVENT(WorkerStealInfo(numItems));
+            UPDATE_STAT_BE(BeCycles, __rdtsc() - start);
+        }
+
+        tile->finishSubTile();
+        numSubTiles++;
+    }
+
+    return numSubTiles;
+}
+
 //////////////////////////////////////////////////////////////////////////
 /// @brief If there is any BE work then go work on it.
 /// @param pContext - pointer to SWR context.
@@ -464,7 +564,8 @@ INLINE bool FindFirstIncompleteDraw(SWR_CONTEXT* pContext, uint32_t workerId, ui
 ///                      on future draws the lockedTiles ensure that it doesn't work on tiles that may
 ///                      still have work pending in a previous draw. Additionally, the lockedTiles is
 ///                      hueristic that can steer a worker back to the same macrotile that it had been
-///                      working on in a previous draw.
+///                      working on in a previous draw. A worker that finds a locked macrotile which its
+///                      owner has split by sub-tile helps with the split before adding it to the set.
 /// @returns        true if worker thread should shutdown
 bool WorkOnFifoBE(
     SWR_CONTEXT *pContext,
@@ -512,7 +613,7 @@ bool WorkOnFifoBE(
         }
 
         // Grab the list of all dirty macrotiles. A tile is dirty if it has work queued to it.
-        auto &macroTiles = pDC->pTileMgr->getDirtyTiles();
+        auto macroTiles = pDC->pTileMgr->getDirtyTiles();
 
         for (auto tile : macroTiles)
         {
@@ -541,7 +642,9 @@ bool WorkOnFifoBE(
             {
                 BE_WORK *pWork;
 
+                EndIdleBE(pContext, workerId);
                 AR_BEGIN(WorkerFoundWork, pDC->drawId);
+                uint64_t beStart = __rdtsc();
 
                 uint32_t numWorkItems = tile->getNumQueued();
                 SWR_ASSERT(numWorkItems);
@@ -551,17 +654,60 @@ bool WorkOnFifoBE(
                 if (pWork->type == DRAW)
                 {
                     pContext->pHotTileMgr->InitializeHotTiles(pContext, pDC, workerId, tileID);
+                    UPDATE_STAT_BE(MacroTiles, 1);
                 }
                 else if (pWork->type == SHUTDOWN)
                 {
                     bShutdown = true;
                 }
 
+                // Long runs of primitives are split by sub-tile so that workers without a
+                // macrotile of their own can take part of this one.
+                uint32_t splitMinWork = (pContext->NumBEThreads > 1) ? KNOB_BE_SPLIT_MIN_WORK : 0;
+                uint32_t runLength = 0;
+
                 while ((pWork = tile->peek()) != nullptr)
                 {
+                    if (splitMinWork)
+                    {
+                        if (runLength == 0)
+                        {
+                            runLength = GetSplitRunLength(tile);
+                        }
+
+                        if (runLength >= splitMinWork)
+                        {
+                            // Hot tiles can't switch array slices while several workers
+                            // render to them, so load the run's slice up front.
+                            pContext->pHotTileMgr->InitializeHotTiles(pContext, pDC, workerId, tileID,
+                                pWork->desc.tri.triFlags.renderTargetArrayIndex);
+
+                            tile->openSplit(runLength);
+                            WorkOnSubTiles(pDC, workerId, tile, false);
+
+                            // Waiting on the other workers isn't backend time.
+                            uint64_t waitStart = __rdtsc();
+                            while (!tile->isSplitComplete())
+                            {
+                                _mm_pause();
+                            }
+                            beStart += __rdtsc() - waitStart;
+
+                            for (uint32_t i = 0; i < runLength; ++i)
+                            {
+                                tile->dequeue();
+                            }
+                            runLength = 0;
+                            continue;
+                        }
+
+                        runLength--;
+                    }
+
                     pWork->pfnWork(pDC, workerId, tileID, &pWork->desc);
                     tile->dequeue();
                 }
+                UPDATE_STAT_BE(BeCycles, __rdtsc() - beStart);
                 AR_END(WorkerFoundWork, numWorkItems);
 
                 _ReadWriteBarrier();
@@ -589,6 +735,9 @@ bool WorkOnFifoBE(
             }
             else
             {
+                // Steal sub-tiles if the owner has split its work.
+                WorkOnSubTiles(pDC, workerId, tile, true);
+
                 // This tile is already locked. So let's add it to our locked tiles set. This way we don't try locking this one again.
                 lockedTiles.insert(tileID);
             }
@@ -673,7 +822,9 @@ void WorkOnFifoFE(SWR_CONTEXT *pContext, uint32_t workerId, uint32_t &curDrawFE)
             if (initial == 0)
             {
                 // successfully grabbed the DC, now run the FE
+                uint64_t feStart = __rdtsc();
                 pDC->FeWork.pfnWork(pContext, pDC, workerId, &pDC->FeWork.desc);
+                UPDATE_STAT_FE(FeCycles, __rdtsc() - feStart);
 
                 CompleteDrawFE(pContext, workerId, pDC);
             }
@@ -853,6 +1004,8 @@ DWORD workerThreadMain(LPVOID pData)
             bShutdown |= WorkOnFifoBE(pContext, workerId, curDrawBE, lockedTiles, numaNode, numaMask);
             AR_END(WorkerWorkOnFifoBE, 0);
 
+            BeginIdleBE(pContext, workerId);
+
             WorkOnCompute(pContext, workerId, curDrawBE);
         }
 
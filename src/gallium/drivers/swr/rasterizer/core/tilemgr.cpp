@@ -35,10 +35,59 @@
 
 #define TILE_ID(x,y) ((x << 16 | y))
 
-MacroTileMgr::MacroTileMgr(CachingArena& arena) : mArena(arena)
+MacroTileMgr::MacroTileMgr(CachingArena& arena, CachingAllocator& allocator) :
+    mArena(arena), mTileArena(allocator)
 {
 }
 
+void MacroTileMgr::reserve(uint32_t numTilesX, uint32_t numTilesY)
+{
+    numTilesX = std::min<uint32_t>(std::max(numTilesX, mTilesX), KNOB_NUM_HOT_TILES_X);
+    numTilesY = std::min<uint32_t>(std::max(numTilesY, mTilesY), KNOB_NUM_HOT_TILES_Y);
+
+    if (numTilesX == mTilesX && numTilesY == mTilesY)
+    {
+        return;
+    }
+
+    // The old grid stays in the tile arena; growth is geometric and capped,
+    // so that costs at most about as much as the final grid.
+    uint32_t numTiles = numTilesX * numTilesY;
+    MacroTileQueue* pTiles = (MacroTileQueue*)mTileArena.AllocAligned(sizeof(MacroTileQueue) * numTiles, 64);
+    uint32_t numDirtyWords = (numTiles + 31) / 32;
+    uint32_t* pDirtyMask = (uint32_t*)mTileArena.AllocAligned(sizeof(uint32_t) * numDirtyWords, 64);
+    memset(pDirtyMask, 0, sizeof(uint32_t) * numDirtyWords);
+
+    for (uint32_t y = 0; y < numTilesY; ++y)
+    {
+        for (uint32_t x = 0; x < numTilesX; ++x)
+        {
+            uint32_t index = y * numTilesX + x;
+
+            if (x >= mTilesX || y >= mTilesY)
+            {
+                new (&pTiles[index]) MacroTileQueue();
+                continue;
+            }
+
+            // Queues already hold work when a draw grows the grid.
+            uint32_t oldIndex = y * mTilesX + x;
+            new (&pTiles[index]) MacroTileQueue(std::move(mTiles[oldIndex]));
+            mTiles[oldIndex].~MacroTileQueue();
+
+            if (mDirtyMask[oldIndex / 32] & (1u << (oldIndex % 32)))
+            {
+                pDirtyMask[index / 32] |= 1u << (index % 32);
+            }
+        }
+    }
+
+    mTiles = pTiles;
+    mDirtyMask = pDirtyMask;
+    mTilesX = numTilesX;
+    mTilesY = numTilesY;
+}
+
 void MacroTileMgr::enqueue(uint32_t x, uint32_t y, BE_WORK *pWork)
 {
     // Should not enqueue more then what we have backing for in the hot tile manager.
@@ -50,16 +99,21 @@ void MacroTileMgr::enqueue(uint32_t x, uint32_t y, BE_WORK *pWork)
         return;
     }
 
-    uint32_t id = TILE_ID(x, y);
+    if (x >= mTilesX || y >= mTilesY)
+    {
+        reserve(x >= mTilesX ? std::max(x + 1, mTilesX * 2) : mTilesX,
+                y >= mTilesY ? std::max(y + 1, mTilesY * 2) : mTilesY);
+    }
 
-    MacroTileQueue &tile = mTiles[id];
+    uint32_t index = y * mTilesX + x;
+    MacroTileQueue &tile = mTiles[index];
     tile.mWorkItemsFE++;
-    tile.mId = id;
+    tile.mId = TILE_ID(x, y);
 
     if (tile.mWorkItemsFE == 1)
     {
         tile.clear(mArena);
-        mDirtyTiles.push_back(&tile);
+        mDirtyMask[index / 32] |= 1u << (index % 32);
     }
 
     mWorkItemsProduced++;
@@ -68,8 +122,10 @@ void MacroTileMgr::enqueue(uint32_t x, uint32_t y, BE_WORK *pWork)
 
 void MacroTileMgr::markTileComplete(uint32_t id)
 {
-    SWR_ASSERT(mTiles.find(id) != mTiles.end());
-    MacroTileQueue &tile = mTiles[id];
+    uint32_t x, y;
+    getTileIndices(id, x, y);
+    SWR_ASSERT(x < mTilesX && y < mTilesY);
+    MacroTileQueue &tile = mTiles[y * mTilesX + x];
     uint32_t numTiles = tile.mWorkItemsFE;
     InterlockedExchangeAdd(&mWorkItemsConsumed, numTiles);
 
@@ -376,7 +432,10 @@ void HotTileMgr::ClearStencilHotTile(const HOTTILE* pHotTile)
 /// to avoid unnecessary setup every triangle
 /// @todo support deferred clear
 /// @param pCreateInfo - pointer to creation info.
-void HotTileMgr::InitializeHotTiles(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroID)
+/// @param renderTargetArrayIndex - array slice to make resident, so workers
+///        sharing a split macrotile never have to switch slices.
+void HotTileMgr::InitializeHotTiles(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroID,
+    uint32_t renderTargetArrayIndex)
 {
     const API_STATE& state = GetApiState(pDC);
 
@@ -392,7 +451,7 @@ void HotTileMgr::InitializeHotTiles(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, ui
     uint32_t colorHottileEnableMask = state.colorHottileEnable;
     while (_BitScanForward(&rtSlot, colorHottileEnableMask))
     {
-        HOTTILE* pHotTile = GetHotTile(pContext, pDC, macroID, (SWR_RENDERTARGET_ATTACHMENT)(SWR_ATTACHMENT_COLOR0 + rtSlot), true, numSamples);
+        HOTTILE* pHotTile = GetHotTile(pContext, pDC, macroID, (SWR_RENDERTARGET_ATTACHMENT)(SWR_ATTACHMENT_COLOR0 + rtSlot), true, numSamples, renderTargetArrayIndex);
 
         if (pHotTile->state == HOTTILE_INVALID)
         {
@@ -416,7 +475,7 @@ void HotTileMgr::InitializeHotTiles(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, ui
     // check depth if enabled
     if (state.depthHottileEnable)
     {
-        HOTTILE* pHotTile = GetHotTile(pContext, pDC, macroID, SWR_ATTACHMENT_DEPTH, true, numSamples);
+        HOTTILE* pHotTile = GetHotTile(pContext, pDC, macroID, SWR_ATTACHMENT_DEPTH, true, numSamples, renderTargetArrayIndex);
         if (pHotTile->state == HOTTILE_INVALID)
         {
             AR_BEGIN(BELoadTiles, pDC->drawId);
@@ -438,7 +497,7 @@ void HotTileMgr::InitializeHotTiles(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, ui
     // check stencil if enabled
     if (state.stencilHottileEnable)
     {
-        HOTTILE* pHotTile = GetHotTile(pContext, pDC, macroID, SWR_ATTACHMENT_STENCIL, true, numSamples);
+        HOTTILE* pHotTile = GetHotTile(pContext, pDC, macroID, SWR_ATTACHMENT_STENCIL, true, numSamples, renderTargetArrayIndex);
         if (pHotTile->state == HOTTILE_INVALID)
         {
             AR_BEGIN(BELoadTiles, pDC->drawId);
@@ -41,7 +41,6 @@
 struct MacroTileQueue
 {
     MacroTileQueue() { }
-    ~MacroTileQueue() { }
 
     //////////////////////////////////////////////////////////////////////////
     /// @brief Returns number of work items queued for this tile.
@@ -85,6 +84,13 @@ struct MacroTileQueue
         mFifo.dequeue_noinc();
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Peek at work offset items behind the front of the fifo.
+    BE_WORK* peek(uint32_t offset)
+    {
+        return mFifo.peek(offset);
+    }
+
     //////////////////////////////////////////////////////////////////////////
     /// @brief Destroy fifo
     void destroy()
@@ -92,6 +98,61 @@ struct MacroTileQueue
         mFifo.destroy();
     }
 
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Let other workers help with the first numItems work items by
+    ///        claiming sub-tiles of this macrotile. Only the worker holding
+    ///        the lock may open a split, and it must not dequeue the items
+    ///        until isSplitComplete() is true.
+    void openSplit(uint32_t numItems)
+    {
+        mSplitNumItems = numItems;
+        mSplitDone = 0;
+        _ReadWriteBarrier();
+        mSplitClaim = 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Claim the next unprocessed sub-tile of an open split. Returns
+    ///        false if there is no open split or all sub-tiles are claimed.
+    bool claimSubTile(uint32_t& subTile)
+    {
+        if (mSplitClaim >= KNOB_BE_NUM_SUBTILES)
+        {
+            return false;
+        }
+
+        long result = InterlockedIncrement(&mSplitClaim) - 1;
+        if (result >= KNOB_BE_NUM_SUBTILES)
+        {
+            return false;
+        }
+
+        subTile = result;
+        return true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Returns number of work items in the open split.
+    uint32_t getSplitNumItems()
+    {
+        return mSplitNumItems;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Called by a worker once it has run the split's work items on
+    ///        the sub-tile it claimed.
+    void finishSubTile()
+    {
+        InterlockedIncrement(&mSplitDone);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Split is complete once every sub-tile has been finished.
+    bool isSplitComplete()
+    {
+        return mSplitDone == KNOB_BE_NUM_SUBTILES;
+    }
+
     ///@todo This will all be private.
     uint32_t mWorkItemsFE = 0;
     uint32_t mWorkItemsBE = 0;
@@ -99,20 +160,32 @@ struct MacroTileQueue
 
 private:
     QUEUE<BE_WORK> mFifo;
+
+    // Sub-tile split of the work at the front of the fifo. Claims start out
+    // exhausted so there is nothing to steal until the owner opens a split.
+    uint32_t mSplitNumItems = 0;
+    OSALIGNLINE(volatile long) mSplitClaim{ KNOB_BE_NUM_SUBTILES };
+    OSALIGNLINE(volatile long) mSplitDone{ KNOB_BE_NUM_SUBTILES };
 };
 
 //////////////////////////////////////////////////////////////////////////
 /// MacroTileMgr - Manages macrotiles for a draw.
+///
+/// The queues live in a dense row-major grid that grows to the render
+/// target's extent in macrotiles and is kept across draws, so enqueue is an
+/// index instead of a hash lookup.  A bitmap tracks which of the queues have
+/// work for the current draw.
 //////////////////////////////////////////////////////////////////////////
 class MacroTileMgr
 {
 public:
-    MacroTileMgr(CachingArena& arena);
+    MacroTileMgr(CachingArena& arena, CachingAllocator& allocator);
     ~MacroTileMgr()
     {
-        for (auto &tile : mTiles)
+        for (uint32_t i = 0; i < mTilesX * mTilesY; ++i)
         {
-            tile.second.destroy();
+            mTiles[i].destroy();
+            mTiles[i].~MacroTileQueue();
         }
     }
 
@@ -121,10 +194,68 @@ public:
         mWorkItemsProduced = 0;
         mWorkItemsConsumed = 0;
 
-        mDirtyTiles.clear();
+        memset(mDirtyMask, 0, sizeof(uint32_t) * getNumDirtyWords());
     }
 
-    INLINE std::vector<MacroTileQueue*>& getDirtyTiles() { return mDirtyTiles; }
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Walks the dirty tiles in row-major order, one bitmap word at
+    ///        a time.
+    class DirtyTileIterator
+    {
+    public:
+        DirtyTileIterator(const MacroTileMgr& mgr, uint32_t word) :
+            mMgr(mgr), mWord(word), mBits(0)
+        {
+            if (mWord < mMgr.getNumDirtyWords())
+            {
+                mBits = mMgr.mDirtyMask[mWord];
+                skipEmptyWords();
+            }
+        }
+
+        MacroTileQueue* operator*() const
+        {
+            unsigned long bit;
+            _BitScanForward(&bit, mBits);
+            return &mMgr.mTiles[mWord * 32 + bit];
+        }
+
+        DirtyTileIterator& operator++()
+        {
+            mBits &= mBits - 1;
+            skipEmptyWords();
+            return *this;
+        }
+
+        bool operator!=(const DirtyTileIterator& rhs) const
+        {
+            return (mWord != rhs.mWord) || (mBits != rhs.mBits);
+        }
+
+    private:
+        void skipEmptyWords()
+        {
+            uint32_t numWords = mMgr.getNumDirtyWords();
+            while (!mBits && ++mWord < numWords)
+            {
+                mBits = mMgr.mDirtyMask[mWord];
+            }
+        }
+
+        const MacroTileMgr& mMgr;
+        uint32_t mWord;
+        uint32_t mBits;
+    };
+
+    struct DirtyTiles
+    {
+        const MacroTileMgr& mMgr;
+
+        DirtyTileIterator begin() const { return DirtyTileIterator(mMgr, 0); }
+        DirtyTileIterator end() const { return DirtyTileIterator(mMgr, mMgr.getNumDirtyWords()); }
+    };
+
+    INLINE DirtyTiles getDirtyTiles() const { return DirtyTiles{ *this }; }
     void markTileComplete(uint32_t id);
 
     INLINE bool isWorkComplete()
@@ -134,6 +265,11 @@ public:
 
     void enqueue(uint32_t x, uint32_t y, BE_WORK *pWork);
 
+    //////////////////////////////////////////////////////////////////////////
+    /// @brief Grow the tile grid to at least numTilesX by numTilesY macrotiles.
+    ///        Only the FE thread that owns the draw may call this.
+    void reserve(uint32_t numTilesX, uint32_t numTilesY);
+
     static INLINE void getTileIndices(uint32_t tileID, uint32_t &x, uint32_t &y)
     {
         y = tileID & 0xffff;
@@ -141,11 +277,22 @@ public:
     }
 
 private:
+    INLINE uint32_t getNumDirtyWords() const
+    {
+        return (mTilesX * mTilesY + 31) / 32;
+    }
+
     CachingArena& mArena;
-    std::unordered_map<uint32_t, MacroTileQueue> mTiles;
+
+    // Backs the tile grid and the dirty bitmap; outlives the draws, unlike mArena.
+    CachingArena mTileArena;
+
+    MacroTileQueue* mTiles{ nullptr };
+    uint32_t mTilesX{ 0 };
+    uint32_t mTilesY{ 0 };
 
     // Any tile that has work queued to it is a dirty tile.
-    std::vector<MacroTileQueue*> mDirtyTiles;
+    uint32_t* mDirtyMask{ nullptr };
 
     OSALIGNLINE(long) mWorkItemsProduced { 0 };
     OSALIGNLINE(volatile long) mWorkItemsConsumed { 0 };
@@ -303,7 +450,8 @@ public:
         }
     }
 
-    void InitializeHotTiles(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroID);
+    void InitializeHotTiles(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32_t workerId, uint32_t macroID,
+        uint32_t renderTargetArrayIndex = 0);
 
     HOTTILE *GetHotTile(SWR_CONTEXT* pContext, DRAW_CONTEXT* pDC, uint32_t macroID, SWR_RENDERTARGET_ATTACHMENT attachment, bool create, uint32_t numSamples = 1,
         uint32_t renderTargetArrayIndex = 0);
@@ -465,6 +465,11 @@ extern "C"
 /// JitCache
 //////////////////////////////////////////////////////////////////////////
 
+/// Marks the per-ISA directories under the cache root
+#define JC_ISA_DIR_TAG "_simd"
+/// Extension of partially written entries
+#define JC_TMP_EXT ".tmp"
+
 //////////////////////////////////////////////////////////////////////////
 /// JitCacheFileHeader
 //////////////////////////////////////////////////////////////////////////
@@ -546,8 +551,8 @@ struct JitCacheFileHeader
 #endif
 
 private:
-    static const uint64_t   JC_MAGIC_NUMBER = 0xfedcba9876543211ULL + 3;
-    static const size_t     JC_STR_MAX_LEN = 32;
+    static const uint64_t   JC_MAGIC_NUMBER = 0xfedcba9876543211ULL + 4;
+    static const size_t     JC_STR_MAX_LEN = 64;
     static const uint32_t   JC_PLATFORM_KEY =
         (LLVM_VERSION_MAJOR << 24)  |
         (LLVM_VERSION_MINOR << 16)  |
@@ -590,15 +595,34 @@ JitCache::JitCache()
         if (!(homedir = getenv("HOME"))) {
             homedir = getpwuid(getuid())->pw_dir;
         }
-        mCacheDir = homedir;
-        mCacheDir += (KNOB_JIT_CACHE_DIR.c_str() + 1);
+        mCacheRoot = homedir;
+        mCacheRoot += (KNOB_JIT_CACHE_DIR.c_str() + 1);
     } else
 #endif
     {
-        mCacheDir = KNOB_JIT_CACHE_DIR;
+        mCacheRoot = KNOB_JIT_CACHE_DIR;
     }
 }
 
+void JitCache::Init(
+    JitManager* pJitMgr,
+    const llvm::StringRef& cpu,
+    llvm::CodeGenOpt::Level level)
+{
+    mCpu = cpu.str();
+    mpJitMgr = pJitMgr;
+    mOptLevel = level;
+
+    // Objects are only usable on the ISA they were generated for, so each
+    // ISA gets its own directory under the (shared) cache root.
+    const char* pIsa = pJitMgr->mArch.AVX512F() ? "avx512" :
+                       pJitMgr->mArch.AVX2() ? "avx2" : "avx";
+
+    mCacheDir = mCacheRoot;
+    llvm::sys::path::append(mCacheDir,
+        mCpu + "_" + pIsa + JC_ISA_DIR_TAG + std::to_string(pJitMgr->mVWidth));
+}
+
 #if defined(_WIN32)
 int ExecUnhookedProcess(const char* pCmdLine)
 {
@@ -652,40 +676,7 @@ void JitCache::notifyObjectCompiled(const llvm::Module *M, llvm::MemoryBufferRef
         return;
     }
 
-    if (!llvm::sys::fs::exists(mCacheDir.str()) &&
-        llvm::sys::fs::create_directories(mCacheDir.str()))
-    {
-        SWR_INVALID("Unable to create directory: %s", mCacheDir.c_str());
-        return;
-    }
-
-    JitCacheFileHeader header;
-
-    llvm::SmallString<MAX_PATH> filePath = mCacheDir;
-    llvm::sys::path::append(filePath, moduleID);
-
-    llvm::SmallString<MAX_PATH> objPath = filePath;
-    objPath += JIT_OBJ_EXT;
-
-    {
-        std::error_code err;
-        llvm::raw_fd_ostream fileObj(objPath.c_str(), err, llvm::sys::fs::F_None);
-        fileObj << Obj.getBuffer();
-        fileObj.flush();
-    }
-
-
-    {
-        std::error_code err;
-        llvm::raw_fd_ostream fileObj(filePath.c_str(), err, llvm::sys::fs::F_None);
-
-        uint32_t objcrc = ComputeCRC(0, Obj.getBufferStart(), Obj.getBufferSize());
-
-        header.Init(mCurrentModuleCRC, objcrc, moduleID, mCpu, mOptLevel, Obj.getBufferSize());
-
-        fileObj.write((const char*)&header, sizeof(header));
-        fileObj.flush();
-    }
+    WriteEntry(moduleID, mCurrentModuleCRC, Obj.getBuffer());
 }
 
 /// Returns a pointer to a newly allocated MemoryBuffer that contains the
@@ -701,23 +692,36 @@ std::unique_ptr<llvm::MemoryBuffer> JitCache::getObject(const llvm::Module* M)
         return nullptr;
     }
 
-    if (!llvm::sys::fs::exists(mCacheDir))
+    return ReadEntry(moduleID, mCurrentModuleCRC);
+}
+
+std::unique_ptr<llvm::MemoryBuffer> JitCache::LoadObject(const std::string& name)
+{
+    if (!IsEnabled() || !name.length())
     {
         return nullptr;
     }
 
-    llvm::SmallString<MAX_PATH> filePath = mCacheDir;
-    llvm::sys::path::append(filePath, moduleID);
+    return ReadEntry(name, 0);
+}
+
+void JitCache::StoreObject(const std::string& name, llvm::StringRef obj)
+{
+    if (!IsEnabled() || !name.length())
+    {
+        return;
+    }
 
-    llvm::SmallString<MAX_PATH> objFilePath = filePath;
-    objFilePath += JIT_OBJ_EXT;
+    WriteEntry(name, 0, obj);
+}
 
-#if defined(ENABLE_JIT_DEBUG)
-    FILE* fpModuleIn = nullptr;
-#endif
-    FILE* fpObjIn = nullptr;
-    FILE* fpIn = fopen(filePath.c_str(), "rb");
-    if (!fpIn)
+std::unique_ptr<llvm::MemoryBuffer> JitCache::ReadEntry(const std::string& name, uint32_t llCRC)
+{
+    llvm::SmallString<MAX_PATH> filePath = mCacheDir;
+    llvm::sys::path::append(filePath, name + JIT_OBJ_EXT);
+
+    int fd;
+    if (llvm::sys::fs::openFileForRead(filePath, fd))
     {
         return nullptr;
     }
@@ -725,57 +729,180 @@ std::unique_ptr<llvm::MemoryBuffer> JitCache::getObject(const llvm::Module* M)
     std::unique_ptr<llvm::MemoryBuffer> pBuf = nullptr;
     do
     {
-        JitCacheFileHeader header;
-        if (!fread(&header, sizeof(header), 1, fpIn))
+        auto file = llvm::MemoryBuffer::getOpenFile(fd, filePath, uint64_t(-1), false);
+        if (!file)
         {
             break;
         }
 
-        if (!header.IsValid(mCurrentModuleCRC, moduleID, mCpu, mOptLevel))
-        {
-            break;
-        }
+        llvm::StringRef data = (*file)->getBuffer();
 
-        fpObjIn = fopen(objFilePath.c_str(), "rb");
-        if (!fpObjIn)
+        JitCacheFileHeader header;
+        if (data.size() < sizeof(header))
         {
             break;
         }
+        memcpy(&header, data.data(), sizeof(header));
 
-#if LLVM_VERSION_MAJOR < 6
-        pBuf = llvm::MemoryBuffer::getNewUninitMemBuffer(size_t(header.GetObjectSize()));
-#else
-        pBuf = llvm::WritableMemoryBuffer::getNewUninitMemBuffer(size_t(header.GetObjectSize()));
-#endif
-        if (!fread(const_cast<char*>(pBuf->getBufferStart()), header.GetObjectSize(), 1, fpObjIn))
+        if (!header.IsValid(llCRC, name, mCpu, mOptLevel) ||
+            header.GetObjectSize() != data.size() - sizeof(header))
         {
-            pBuf = nullptr;
             break;
         }
 
-        if (header.GetObjectCRC() != ComputeCRC(0, pBuf->getBufferStart(), pBuf->getBufferSize()))
+        llvm::StringRef obj = data.substr(sizeof(header));
+        if (header.GetObjectCRC() != ComputeCRC(0, obj.data(), obj.size()))
         {
             SWR_TRACE("Invalid object cache file, ignoring: %s", filePath.c_str());
-            pBuf = nullptr;
             break;
         }
 
+        // Copy, so the object gets its own suitably aligned buffer.
+        pBuf = llvm::MemoryBuffer::getMemBufferCopy(obj, name);
+
+        // Eviction goes by modification time, so bump it on every hit.
+#if LLVM_VERSION_MAJOR < 4
+        llvm::sys::fs::setLastModificationAndAccessTime(fd, llvm::sys::TimeValue::now());
+#else
+        llvm::sys::fs::setLastModificationAndAccessTime(fd, llvm::sys::toTimePoint(time(nullptr)));
+#endif
     }
     while (0);
 
-    fclose(fpIn);
+    llvm::sys::Process::SafelyCloseFileDescriptor(fd);
 
-    if (fpObjIn)
+    return pBuf;
+}
+
+void JitCache::WriteEntry(const std::string& name, uint32_t llCRC, llvm::StringRef obj)
+{
+    if (!llvm::sys::fs::exists(mCacheDir.str()) &&
+        llvm::sys::fs::create_directories(mCacheDir.str()))
     {
-        fclose(fpObjIn);
+        SWR_INVALID("Unable to create directory: %s", mCacheDir.c_str());
+        return;
     }
 
-#if defined(ENABLE_JIT_DEBUG)
-    if (fpModuleIn)
+    llvm::SmallString<MAX_PATH> filePath = mCacheDir;
+    llvm::sys::path::append(filePath, name + JIT_OBJ_EXT);
+
+    // Other processes may be reading the entry or writing the same one, so
+    // write it under a unique name and rename it into place when complete.
+    int fd;
+    llvm::SmallString<MAX_PATH> tmpPath;
+    if (llvm::sys::fs::createUniqueFile(llvm::Twine(filePath) + "-%%%%%%" + JC_TMP_EXT, fd, tmpPath))
     {
-        fclose(fpModuleIn);
+        return;
     }
+
+    JitCacheFileHeader header;
+    header.Init(llCRC, ComputeCRC(0, obj.data(), obj.size()), name, mCpu, mOptLevel, obj.size());
+
+    bool written;
+    {
+        llvm::raw_fd_ostream fileObj(fd, true);
+        fileObj.write((const char*)&header, sizeof(header));
+        fileObj << obj;
+        fileObj.close();
+
+        written = !fileObj.has_error();
+        fileObj.clear_error();
+    }
+
+    if (!written || llvm::sys::fs::rename(tmpPath, filePath))
+    {
+        llvm::sys::fs::remove(tmpPath);
+        return;
+    }
+
+    if (KNOB_JIT_CACHE_MAX_SIZE)
+    {
+        // The running size misses whatever other processes add, pruning
+        // rescans the whole cache to get it right again.
+        const uint64_t maxSize = uint64_t(KNOB_JIT_CACHE_MAX_SIZE) << 20;
+        if (mCacheSize == CACHE_SIZE_UNKNOWN ||
+            (mCacheSize += sizeof(header) + obj.size()) > maxSize)
+        {
+            mCacheSize = Prune(maxSize);
+        }
+    }
+}
+
+/// Evicts the least recently used entries of all ISAs until the cache holds
+/// at most maxSize bytes.  Returns the number of bytes left.
+uint64_t JitCache::Prune(uint64_t maxSize)
+{
+    struct Entry
+    {
+        time_t time;
+        uint64_t size;
+        std::string path;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+
+    // Only look at files this cache could have written.  The cache root is
+    // user configurable and may well hold other things.
+    std::error_code err;
+    for (llvm::sys::fs::directory_iterator dir(mCacheRoot, err), dirEnd;
+         !err && dir != dirEnd; dir.increment(err))
+    {
+        if (llvm::sys::path::filename(dir->path()).find(JC_ISA_DIR_TAG) == llvm::StringRef::npos)
+        {
+            continue;
+        }
+
+        std::error_code fileErr;
+        for (llvm::sys::fs::directory_iterator file(dir->path(), fileErr), fileEnd;
+             !fileErr && file != fileEnd; file.increment(fileErr))
+        {
+            llvm::StringRef ext = llvm::sys::path::extension(file->path());
+            if (ext != JIT_OBJ_EXT && ext != JC_TMP_EXT)
+            {
+                continue;
+            }
+
+            llvm::sys::fs::file_status status;
+            if (llvm::sys::fs::status(file->path(), status) ||
+                !llvm::sys::fs::is_regular_file(status))
+            {
+                continue;
+            }
+
+#if LLVM_VERSION_MAJOR < 4
+            time_t time = status.getLastModificationTime().toEpochTime();
+#else
+            time_t time = llvm::sys::toTimeT(status.getLastModificationTime());
 #endif
+            entries.push_back({ time, status.getSize(), file->path() });
+            total += status.getSize();
+        }
+    }
 
-    return pBuf;
+    if (total <= maxSize)
+    {
+        return total;
+    }
+
+    // Go a bit below the limit, so that the next few misses don't each
+    // trigger another scan.
+    const uint64_t targetSize = maxSize - maxSize / 8;
+
+    std::sort(entries.begin(), entries.end(),
+        [](const Entry& a, const Entry& b) { return a.time < b.time; });
+
+    for (const Entry& entry : entries)
+    {
+        if (total <= targetSize)
+        {
+            break;
+        }
+
+        if (!llvm::sys::fs::remove(entry.path))
+        {
+            total -= entry.size;
+        }
+    }
+
+    return total;
 }
@@ -99,12 +99,7 @@ public:
     void Init(
         JitManager* pJitMgr,
         const llvm::StringRef& cpu,
-        llvm::CodeGenOpt::Level level)
-    {
-        mCpu = cpu.str();
-        mpJitMgr = pJitMgr;
-        mOptLevel = level;
-    }
+        llvm::CodeGenOpt::Level level);
 
     /// notifyObjectCompiled - Provides a pointer to compiled code for Module M.
     virtual void notifyObjectCompiled(const llvm::Module *M, llvm::MemoryBufferRef Obj);
@@ -114,9 +109,28 @@ public:
     /// available.
     virtual std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* M);
 
+    /// Looks up the object stored under name by StoreObject, for code which
+    /// is not compiled through the JitManager's execution engine.  There is
+    /// no IR to validate the object against, so name alone must identify
+    /// the generated code.  Returns 0 if the cache is disabled or on a miss.
+    std::unique_ptr<llvm::MemoryBuffer> LoadObject(const std::string& name);
+
+    /// Stores an object for LoadObject.
+    void StoreObject(const std::string& name, llvm::StringRef obj);
+
+    bool IsEnabled() const { return mpJitMgr != nullptr; }
+
 private:
+    std::unique_ptr<llvm::MemoryBuffer> ReadEntry(const std::string& name, uint32_t llCRC);
+    void WriteEntry(const std::string& name, uint32_t llCRC, llvm::StringRef obj);
+    uint64_t Prune(uint64_t maxSize);
+
+    static const uint64_t CACHE_SIZE_UNKNOWN = ~0ULL;
+
     std::string mCpu;
-    llvm::SmallString<MAX_PATH> mCacheDir;
+    llvm::SmallString<MAX_PATH> mCacheRoot;     ///< KNOB_JIT_CACHE_DIR, shared by all ISAs
+    llvm::SmallString<MAX_PATH> mCacheDir;      ///< Entries for this JitManager's ISA
+    uint64_t mCacheSize = CACHE_SIZE_UNKNOWN;   ///< Bytes under mCacheRoot, as last seen
     uint32_t mCurrentModuleCRC = 0;
     JitManager* mpJitMgr = nullptr;
     llvm::CodeGenOpt::Level mOptLevel = llvm::CodeGenOpt::None;
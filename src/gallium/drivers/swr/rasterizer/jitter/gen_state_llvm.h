@@ -905,15 +905,15 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("enable", 649));
-            dbgMembers.push_back(std::make_pair("soWriteEnable", 650));
-            dbgMembers.push_back(std::make_pair("pBuffer", 653));
-            dbgMembers.push_back(std::make_pair("bufferSize", 656));
-            dbgMembers.push_back(std::make_pair("pitch", 659));
-            dbgMembers.push_back(std::make_pair("streamOffset", 662));
-            dbgMembers.push_back(std::make_pair("pWriteOffset", 665));
+            dbgMembers.push_back(std::make_pair("enable", 658));
+            dbgMembers.push_back(std::make_pair("soWriteEnable", 659));
+            dbgMembers.push_back(std::make_pair("pBuffer", 662));
+            dbgMembers.push_back(std::make_pair("bufferSize", 665));
+            dbgMembers.push_back(std::make_pair("pitch", 668));
+            dbgMembers.push_back(std::make_pair("streamOffset", 671));
+            dbgMembers.push_back(std::make_pair("pWriteOffset", 674));
             
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_STREAMOUT_BUFFER", pFile, 647, dbgMembers);
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_STREAMOUT_BUFFER", pFile, 656, dbgMembers);
 
         }
 
@@ -953,15 +953,15 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("soEnable", 675));
-            dbgMembers.push_back(std::make_pair("streamEnable", 678));
-            dbgMembers.push_back(std::make_pair("rasterizerDisable", 681));
-            dbgMembers.push_back(std::make_pair("streamToRasterizer", 684));
-            dbgMembers.push_back(std::make_pair("streamMasks", 689));
-            dbgMembers.push_back(std::make_pair("streamNumEntries", 693));
-            dbgMembers.push_back(std::make_pair("vertexAttribOffset", 696));
+            dbgMembers.push_back(std::make_pair("soEnable", 684));
+            dbgMembers.push_back(std::make_pair("streamEnable", 687));
+            dbgMembers.push_back(std::make_pair("rasterizerDisable", 690));
+            dbgMembers.push_back(std::make_pair("streamToRasterizer", 693));
+            dbgMembers.push_back(std::make_pair("streamMasks", 698));
+            dbgMembers.push_back(std::make_pair("streamNumEntries", 702));
+            dbgMembers.push_back(std::make_pair("vertexAttribOffset", 705));
             
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_STREAMOUT_STATE", pFile, 672, dbgMembers);
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_STREAMOUT_STATE", pFile, 681, dbgMembers);
 
         }
 
@@ -998,12 +998,12 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("pPrimData", 704));
-            dbgMembers.push_back(std::make_pair("pBuffer", 705));
-            dbgMembers.push_back(std::make_pair("numPrimsWritten", 708));
-            dbgMembers.push_back(std::make_pair("numPrimStorageNeeded", 711));
+            dbgMembers.push_back(std::make_pair("pPrimData", 713));
+            dbgMembers.push_back(std::make_pair("pBuffer", 714));
+            dbgMembers.push_back(std::make_pair("numPrimsWritten", 717));
+            dbgMembers.push_back(std::make_pair("numPrimStorageNeeded", 720));
             
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_STREAMOUT_CONTEXT", pFile, 702, dbgMembers);
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_STREAMOUT_CONTEXT", pFile, 711, dbgMembers);
 
         }
 
@@ -1049,24 +1049,24 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("gsEnable", 719));
-            dbgMembers.push_back(std::make_pair("numInputAttribs", 723));
-            dbgMembers.push_back(std::make_pair("inputVertStride", 726));
-            dbgMembers.push_back(std::make_pair("outputTopology", 729));
-            dbgMembers.push_back(std::make_pair("maxNumVerts", 732));
-            dbgMembers.push_back(std::make_pair("instanceCount", 735));
-            dbgMembers.push_back(std::make_pair("isSingleStream", 740));
-            dbgMembers.push_back(std::make_pair("singleStreamID", 744));
-            dbgMembers.push_back(std::make_pair("allocationSize", 747));
-            dbgMembers.push_back(std::make_pair("vertexAttribOffset", 750));
-            dbgMembers.push_back(std::make_pair("srcVertexAttribOffset", 753));
-            dbgMembers.push_back(std::make_pair("controlDataSize", 757));
-            dbgMembers.push_back(std::make_pair("controlDataOffset", 760));
-            dbgMembers.push_back(std::make_pair("outputVertexSize", 763));
-            dbgMembers.push_back(std::make_pair("outputVertexOffset", 766));
-            dbgMembers.push_back(std::make_pair("staticVertexCount", 770));
-            
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_GS_STATE", pFile, 717, dbgMembers);
+            dbgMembers.push_back(std::make_pair("gsEnable", 728));
+            dbgMembers.push_back(std::make_pair("numInputAttribs", 732));
+            dbgMembers.push_back(std::make_pair("inputVertStride", 735));
+            dbgMembers.push_back(std::make_pair("outputTopology", 738));
+            dbgMembers.push_back(std::make_pair("maxNumVerts", 741));
+            dbgMembers.push_back(std::make_pair("instanceCount", 744));
+            dbgMembers.push_back(std::make_pair("isSingleStream", 749));
+            dbgMembers.push_back(std::make_pair("singleStreamID", 753));
+            dbgMembers.push_back(std::make_pair("allocationSize", 756));
+            dbgMembers.push_back(std::make_pair("vertexAttribOffset", 759));
+            dbgMembers.push_back(std::make_pair("srcVertexAttribOffset", 762));
+            dbgMembers.push_back(std::make_pair("controlDataSize", 766));
+            dbgMembers.push_back(std::make_pair("controlDataOffset", 769));
+            dbgMembers.push_back(std::make_pair("outputVertexSize", 772));
+            dbgMembers.push_back(std::make_pair("outputVertexOffset", 775));
+            dbgMembers.push_back(std::make_pair("staticVertexCount", 779));
+            
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_GS_STATE", pFile, 726, dbgMembers);
 
         }
 
@@ -1119,19 +1119,19 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("tsEnable", 816));
-            dbgMembers.push_back(std::make_pair("tsOutputTopology", 817));
-            dbgMembers.push_back(std::make_pair("partitioning", 818));
-            dbgMembers.push_back(std::make_pair("domain", 819));
-            dbgMembers.push_back(std::make_pair("postDSTopology", 821));
-            dbgMembers.push_back(std::make_pair("numHsInputAttribs", 823));
-            dbgMembers.push_back(std::make_pair("numHsOutputAttribs", 824));
-            dbgMembers.push_back(std::make_pair("numDsOutputAttribs", 825));
-            dbgMembers.push_back(std::make_pair("dsAllocationSize", 826));
-            dbgMembers.push_back(std::make_pair("dsOutVtxAttribOffset", 827));
-            dbgMembers.push_back(std::make_pair("vertexAttribOffset", 830));
-            
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_TS_STATE", pFile, 814, dbgMembers);
+            dbgMembers.push_back(std::make_pair("tsEnable", 825));
+            dbgMembers.push_back(std::make_pair("tsOutputTopology", 826));
+            dbgMembers.push_back(std::make_pair("partitioning", 827));
+            dbgMembers.push_back(std::make_pair("domain", 828));
+            dbgMembers.push_back(std::make_pair("postDSTopology", 830));
+            dbgMembers.push_back(std::make_pair("numHsInputAttribs", 832));
+            dbgMembers.push_back(std::make_pair("numHsOutputAttribs", 833));
+            dbgMembers.push_back(std::make_pair("numDsOutputAttribs", 834));
+            dbgMembers.push_back(std::make_pair("dsAllocationSize", 835));
+            dbgMembers.push_back(std::make_pair("dsOutVtxAttribOffset", 836));
+            dbgMembers.push_back(std::make_pair("vertexAttribOffset", 839));
+            
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_TS_STATE", pFile, 823, dbgMembers);
 
         }
 
@@ -1172,12 +1172,12 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("writeDisableRed", 836));
-            dbgMembers.push_back(std::make_pair("writeDisableGreen", 837));
-            dbgMembers.push_back(std::make_pair("writeDisableBlue", 838));
-            dbgMembers.push_back(std::make_pair("writeDisableAlpha", 839));
+            dbgMembers.push_back(std::make_pair("writeDisableRed", 845));
+            dbgMembers.push_back(std::make_pair("writeDisableGreen", 846));
+            dbgMembers.push_back(std::make_pair("writeDisableBlue", 847));
+            dbgMembers.push_back(std::make_pair("writeDisableAlpha", 848));
             
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_RENDER_TARGET_BLEND_STATE", pFile, 834, dbgMembers);
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_RENDER_TARGET_BLEND_STATE", pFile, 843, dbgMembers);
 
         }
 
@@ -1212,13 +1212,13 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("constantColor", 863));
-            dbgMembers.push_back(std::make_pair("alphaTestReference", 866));
-            dbgMembers.push_back(std::make_pair("sampleMask", 867));
-            dbgMembers.push_back(std::make_pair("sampleCount", 870));
-            dbgMembers.push_back(std::make_pair("renderTarget", 872));
+            dbgMembers.push_back(std::make_pair("constantColor", 872));
+            dbgMembers.push_back(std::make_pair("alphaTestReference", 875));
+            dbgMembers.push_back(std::make_pair("sampleMask", 876));
+            dbgMembers.push_back(std::make_pair("sampleCount", 879));
+            dbgMembers.push_back(std::make_pair("renderTarget", 881));
             
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_BLEND_STATE", pFile, 860, dbgMembers);
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_BLEND_STATE", pFile, 869, dbgMembers);
 
         }
 
@@ -1254,13 +1254,13 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("vpTransformDisable", 906));
-            dbgMembers.push_back(std::make_pair("bEnableCutIndex", 907));
-            dbgMembers.push_back(std::make_pair("triFan", 912));
-            dbgMembers.push_back(std::make_pair("lineStripList", 913));
-            dbgMembers.push_back(std::make_pair("triStripList", 914));
+            dbgMembers.push_back(std::make_pair("vpTransformDisable", 915));
+            dbgMembers.push_back(std::make_pair("bEnableCutIndex", 916));
+            dbgMembers.push_back(std::make_pair("triFan", 921));
+            dbgMembers.push_back(std::make_pair("lineStripList", 922));
+            dbgMembers.push_back(std::make_pair("triStripList", 923));
             
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_FRONTEND_STATE", pFile, 902, dbgMembers);
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_FRONTEND_STATE", pFile, 911, dbgMembers);
 
         }
 
@@ -1297,14 +1297,14 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("m00", 930));
-            dbgMembers.push_back(std::make_pair("m11", 931));
-            dbgMembers.push_back(std::make_pair("m22", 932));
-            dbgMembers.push_back(std::make_pair("m30", 933));
-            dbgMembers.push_back(std::make_pair("m31", 934));
-            dbgMembers.push_back(std::make_pair("m32", 935));
+            dbgMembers.push_back(std::make_pair("m00", 939));
+            dbgMembers.push_back(std::make_pair("m11", 940));
+            dbgMembers.push_back(std::make_pair("m22", 941));
+            dbgMembers.push_back(std::make_pair("m30", 942));
+            dbgMembers.push_back(std::make_pair("m31", 943));
+            dbgMembers.push_back(std::make_pair("m32", 944));
             
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_VIEWPORT_MATRIX", pFile, 928, dbgMembers);
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_VIEWPORT_MATRIX", pFile, 937, dbgMembers);
 
         }
 
@@ -1342,14 +1342,14 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("m00", 943));
-            dbgMembers.push_back(std::make_pair("m11", 944));
-            dbgMembers.push_back(std::make_pair("m22", 945));
-            dbgMembers.push_back(std::make_pair("m30", 946));
-            dbgMembers.push_back(std::make_pair("m31", 947));
-            dbgMembers.push_back(std::make_pair("m32", 948));
+            dbgMembers.push_back(std::make_pair("m00", 952));
+            dbgMembers.push_back(std::make_pair("m11", 953));
+            dbgMembers.push_back(std::make_pair("m22", 954));
+            dbgMembers.push_back(std::make_pair("m30", 955));
+            dbgMembers.push_back(std::make_pair("m31", 956));
+            dbgMembers.push_back(std::make_pair("m32", 957));
             
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_VIEWPORT_MATRICES", pFile, 941, dbgMembers);
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_VIEWPORT_MATRICES", pFile, 950, dbgMembers);
 
         }
 
@@ -1387,14 +1387,14 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("x", 956));
-            dbgMembers.push_back(std::make_pair("y", 957));
-            dbgMembers.push_back(std::make_pair("width", 958));
-            dbgMembers.push_back(std::make_pair("height", 959));
-            dbgMembers.push_back(std::make_pair("minZ", 960));
-            dbgMembers.push_back(std::make_pair("maxZ", 961));
+            dbgMembers.push_back(std::make_pair("x", 965));
+            dbgMembers.push_back(std::make_pair("y", 966));
+            dbgMembers.push_back(std::make_pair("width", 967));
+            dbgMembers.push_back(std::make_pair("height", 968));
+            dbgMembers.push_back(std::make_pair("minZ", 969));
+            dbgMembers.push_back(std::make_pair("maxZ", 970));
             
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_VIEWPORT", pFile, 954, dbgMembers);
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_VIEWPORT", pFile, 963, dbgMembers);
 
         }
 
@@ -1436,18 +1436,18 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("_xi", 1025));
-            dbgMembers.push_back(std::make_pair("_yi", 1026));
-            dbgMembers.push_back(std::make_pair("_x", 1027));
-            dbgMembers.push_back(std::make_pair("_y", 1028));
-            dbgMembers.push_back(std::make_pair("_vXi", 1031));
-            dbgMembers.push_back(std::make_pair("_vYi", 1032));
-            dbgMembers.push_back(std::make_pair("_vX", 1033));
-            dbgMembers.push_back(std::make_pair("_vY", 1034));
-            dbgMembers.push_back(std::make_pair("tileSampleOffsetsX", 1035));
-            dbgMembers.push_back(std::make_pair("tileSampleOffsetsY", 1036));
-            
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_MULTISAMPLE_POS", pFile, 996, dbgMembers);
+            dbgMembers.push_back(std::make_pair("_xi", 1034));
+            dbgMembers.push_back(std::make_pair("_yi", 1035));
+            dbgMembers.push_back(std::make_pair("_x", 1036));
+            dbgMembers.push_back(std::make_pair("_y", 1037));
+            dbgMembers.push_back(std::make_pair("_vXi", 1040));
+            dbgMembers.push_back(std::make_pair("_vYi", 1041));
+            dbgMembers.push_back(std::make_pair("_vX", 1042));
+            dbgMembers.push_back(std::make_pair("_vY", 1043));
+            dbgMembers.push_back(std::make_pair("tileSampleOffsetsX", 1044));
+            dbgMembers.push_back(std::make_pair("tileSampleOffsetsY", 1045));
+            
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_MULTISAMPLE_POS", pFile, 1005, dbgMembers);
 
         }
 
@@ -1506,31 +1506,31 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("cullMode", 1044));
-            dbgMembers.push_back(std::make_pair("fillMode", 1045));
-            dbgMembers.push_back(std::make_pair("frontWinding", 1046));
-            dbgMembers.push_back(std::make_pair("scissorEnable", 1047));
-            dbgMembers.push_back(std::make_pair("depthClipEnable", 1048));
-            dbgMembers.push_back(std::make_pair("clipHalfZ", 1049));
-            dbgMembers.push_back(std::make_pair("pointParam", 1050));
-            dbgMembers.push_back(std::make_pair("pointSpriteEnable", 1051));
-            dbgMembers.push_back(std::make_pair("pointSpriteTopOrigin", 1052));
-            dbgMembers.push_back(std::make_pair("forcedSampleCount", 1053));
-            dbgMembers.push_back(std::make_pair("pixelOffset", 1054));
-            dbgMembers.push_back(std::make_pair("depthBiasPreAdjusted", 1055));
-            dbgMembers.push_back(std::make_pair("conservativeRast", 1056));
-            dbgMembers.push_back(std::make_pair("pointSize", 1058));
-            dbgMembers.push_back(std::make_pair("lineWidth", 1059));
-            dbgMembers.push_back(std::make_pair("depthBias", 1061));
-            dbgMembers.push_back(std::make_pair("slopeScaledDepthBias", 1062));
-            dbgMembers.push_back(std::make_pair("depthBiasClamp", 1063));
-            dbgMembers.push_back(std::make_pair("depthFormat", 1064));
-            dbgMembers.push_back(std::make_pair("sampleCount", 1067));
-            dbgMembers.push_back(std::make_pair("pixelLocation", 1068));
-            dbgMembers.push_back(std::make_pair("samplePositions", 1069));
-            dbgMembers.push_back(std::make_pair("bIsCenterPattern", 1070));
-            
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_RASTSTATE", pFile, 1042, dbgMembers);
+            dbgMembers.push_back(std::make_pair("cullMode", 1053));
+            dbgMembers.push_back(std::make_pair("fillMode", 1054));
+            dbgMembers.push_back(std::make_pair("frontWinding", 1055));
+            dbgMembers.push_back(std::make_pair("scissorEnable", 1056));
+            dbgMembers.push_back(std::make_pair("depthClipEnable", 1057));
+            dbgMembers.push_back(std::make_pair("clipHalfZ", 1058));
+            dbgMembers.push_back(std::make_pair("pointParam", 1059));
+            dbgMembers.push_back(std::make_pair("pointSpriteEnable", 1060));
+            dbgMembers.push_back(std::make_pair("pointSpriteTopOrigin", 1061));
+            dbgMembers.push_back(std::make_pair("forcedSampleCount", 1062));
+            dbgMembers.push_back(std::make_pair("pixelOffset", 1063));
+            dbgMembers.push_back(std::make_pair("depthBiasPreAdjusted", 1064));
+            dbgMembers.push_back(std::make_pair("conservativeRast", 1065));
+            dbgMembers.push_back(std::make_pair("pointSize", 1067));
+            dbgMembers.push_back(std::make_pair("lineWidth", 1068));
+            dbgMembers.push_back(std::make_pair("depthBias", 1070));
+            dbgMembers.push_back(std::make_pair("slopeScaledDepthBias", 1071));
+            dbgMembers.push_back(std::make_pair("depthBiasClamp", 1072));
+            dbgMembers.push_back(std::make_pair("depthFormat", 1073));
+            dbgMembers.push_back(std::make_pair("sampleCount", 1076));
+            dbgMembers.push_back(std::make_pair("pixelLocation", 1077));
+            dbgMembers.push_back(std::make_pair("samplePositions", 1078));
+            dbgMembers.push_back(std::make_pair("bIsCenterPattern", 1079));
+            
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_RASTSTATE", pFile, 1051, dbgMembers);
 
         }
 
@@ -1582,11 +1582,11 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("sourceAttrib", 1084));
-            dbgMembers.push_back(std::make_pair("constantSource", 1085));
-            dbgMembers.push_back(std::make_pair("componentOverrideMask", 1086));
+            dbgMembers.push_back(std::make_pair("sourceAttrib", 1093));
+            dbgMembers.push_back(std::make_pair("constantSource", 1094));
+            dbgMembers.push_back(std::make_pair("componentOverrideMask", 1095));
             
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_ATTRIB_SWIZZLE", pFile, 1082, dbgMembers);
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_ATTRIB_SWIZZLE", pFile, 1091, dbgMembers);
 
         }
 
@@ -1627,20 +1627,20 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("constantInterpolationMask", 1092));
-            dbgMembers.push_back(std::make_pair("pointSpriteTexCoordMask", 1093));
-            dbgMembers.push_back(std::make_pair("numAttributes", 1095));
-            dbgMembers.push_back(std::make_pair("numComponents", 1096));
-            dbgMembers.push_back(std::make_pair("swizzleEnable", 1098));
-            dbgMembers.push_back(std::make_pair("swizzleMap", 1101));
-            dbgMembers.push_back(std::make_pair("readRenderTargetArrayIndex", 1103));
-            dbgMembers.push_back(std::make_pair("readViewportArrayIndex", 1104));
-            dbgMembers.push_back(std::make_pair("vertexAttribOffset", 1107));
-            dbgMembers.push_back(std::make_pair("cullDistanceMask", 1110));
-            dbgMembers.push_back(std::make_pair("clipDistanceMask", 1111));
-            dbgMembers.push_back(std::make_pair("vertexClipCullOffset", 1114));
-            
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_BACKEND_STATE", pFile, 1090, dbgMembers);
+            dbgMembers.push_back(std::make_pair("constantInterpolationMask", 1101));
+            dbgMembers.push_back(std::make_pair("pointSpriteTexCoordMask", 1102));
+            dbgMembers.push_back(std::make_pair("numAttributes", 1104));
+            dbgMembers.push_back(std::make_pair("numComponents", 1105));
+            dbgMembers.push_back(std::make_pair("swizzleEnable", 1107));
+            dbgMembers.push_back(std::make_pair("swizzleMap", 1110));
+            dbgMembers.push_back(std::make_pair("readRenderTargetArrayIndex", 1112));
+            dbgMembers.push_back(std::make_pair("readViewportArrayIndex", 1113));
+            dbgMembers.push_back(std::make_pair("vertexAttribOffset", 1116));
+            dbgMembers.push_back(std::make_pair("cullDistanceMask", 1119));
+            dbgMembers.push_back(std::make_pair("clipDistanceMask", 1120));
+            dbgMembers.push_back(std::make_pair("vertexClipCullOffset", 1123));
+            
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_BACKEND_STATE", pFile, 1099, dbgMembers);
 
         }
 
@@ -1689,19 +1689,19 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("pfnPixelShader", 1187));
-            dbgMembers.push_back(std::make_pair("killsPixel", 1190));
-            dbgMembers.push_back(std::make_pair("inputCoverage", 1191));
-            dbgMembers.push_back(std::make_pair("writesODepth", 1192));
-            dbgMembers.push_back(std::make_pair("usesSourceDepth", 1193));
-            dbgMembers.push_back(std::make_pair("shadingRate", 1194));
-            dbgMembers.push_back(std::make_pair("posOffset", 1195));
-            dbgMembers.push_back(std::make_pair("barycentricsMask", 1196));
-            dbgMembers.push_back(std::make_pair("usesUAV", 1197));
-            dbgMembers.push_back(std::make_pair("forceEarlyZ", 1198));
-            dbgMembers.push_back(std::make_pair("renderTargetMask", 1200));
-            
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_PS_STATE", pFile, 1184, dbgMembers);
+            dbgMembers.push_back(std::make_pair("pfnPixelShader", 1196));
+            dbgMembers.push_back(std::make_pair("killsPixel", 1199));
+            dbgMembers.push_back(std::make_pair("inputCoverage", 1200));
+            dbgMembers.push_back(std::make_pair("writesODepth", 1201));
+            dbgMembers.push_back(std::make_pair("usesSourceDepth", 1202));
+            dbgMembers.push_back(std::make_pair("shadingRate", 1203));
+            dbgMembers.push_back(std::make_pair("posOffset", 1204));
+            dbgMembers.push_back(std::make_pair("barycentricsMask", 1205));
+            dbgMembers.push_back(std::make_pair("usesUAV", 1206));
+            dbgMembers.push_back(std::make_pair("forceEarlyZ", 1207));
+            dbgMembers.push_back(std::make_pair("renderTargetMask", 1209));
+            
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_PS_STATE", pFile, 1193, dbgMembers);
 
         }
 
@@ -1741,11 +1741,11 @@ namespace SwrJit
             llvm::DIFile* pFile = builder.createFile("state.h", "./rasterizer/core");
 
             std::vector<std::pair<std::string, uint32_t>> dbgMembers;
-            dbgMembers.push_back(std::make_pair("depthBoundsTestEnable", 1206));
-            dbgMembers.push_back(std::make_pair("depthBoundsTestMinValue", 1207));
-            dbgMembers.push_back(std::make_pair("depthBoundsTestMaxValue", 1208));
+            dbgMembers.push_back(std::make_pair("depthBoundsTestEnable", 1215));
+            dbgMembers.push_back(std::make_pair("depthBoundsTestMinValue", 1216));
+            dbgMembers.push_back(std::make_pair("depthBoundsTestMaxValue", 1217));
             
-            pJitMgr->CreateDebugStructType(pRetType, "SWR_DEPTH_BOUNDS_STATE", pFile, 1204, dbgMembers);
+            pJitMgr->CreateDebugStructType(pRetType, "SWR_DEPTH_BOUNDS_STATE", pFile, 1213, dbgMembers);
 
         }
 
@@ -68,6 +68,7 @@ using PassManager = llvm::legacy::PassManager;
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/Process.h"
 #include "llvm/Support/DynamicLibrary.h"
 
 #include "llvm/IR/DIBuilder.h"
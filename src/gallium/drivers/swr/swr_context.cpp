@@ -320,6 +320,8 @@ swr_blit(struct pipe_context *pipe, const struct pipe_blit_info *blit_info)
    util_blitter_save_vertex_elements(ctx->blitter, (void *)ctx->velems);
    util_blitter_save_vertex_shader(ctx->blitter, (void *)ctx->vs);
    util_blitter_save_geometry_shader(ctx->blitter, (void*)ctx->gs);
+   util_blitter_save_tessctrl_shader(ctx->blitter, (void*)ctx->tcs);
+   util_blitter_save_tesseval_shader(ctx->blitter, (void*)ctx->tes);
    util_blitter_save_so_targets(
       ctx->blitter,
       ctx->num_so_targets,
@@ -400,6 +402,7 @@ swr_destroy(struct pipe_context *pipe)
       ctx->api.pfnSwrDestroyContext(ctx->swrContext);
 
    delete ctx->blendJIT;
+   delete ctx->tcs_fixed_func;
 
    swr_destroy_scratch_buffers(ctx);
 
@@ -430,16 +433,21 @@ swr_UpdateStats(HANDLE hPrivateContext, const SWR_STATS *pStats)
 {
    swr_draw_context *pDC = (swr_draw_context*)hPrivateContext;
 
-   if (!pDC)
+   if (!pDC || !pDC->pStats)
       return;
 
    struct swr_query_result *pqr = pDC->pStats;
 
    SWR_STATS *pSwrStats = &pqr->core;
 
-   pSwrStats->DepthPassCount += pStats->DepthPassCount;
-   pSwrStats->PsInvocations += pStats->PsInvocations;
-   pSwrStats->CsInvocations += pStats->CsInvocations;
+   /* Draws completing on different workers share the interval */
+   p_atomic_add(&pSwrStats->DepthPassCount, pStats->DepthPassCount);
+   p_atomic_add(&pSwrStats->PsInvocations, pStats->PsInvocations);
+   p_atomic_add(&pSwrStats->CsInvocations, pStats->CsInvocations);
+   p_atomic_add(&pSwrStats->EarlyDepthTestCount, pStats->EarlyDepthTestCount);
+   p_atomic_add(&pSwrStats->EarlyDepthKillCount, pStats->EarlyDepthKillCount);
+   p_atomic_add(&pSwrStats->MacroTiles, pStats->MacroTiles);
+   p_atomic_add(&pSwrStats->BeCycles, pStats->BeCycles);
 }
 
 static void
@@ -447,7 +455,7 @@ swr_UpdateStatsFE(HANDLE hPrivateContext, const SWR_STATS_FE *pStats)
 {
    swr_draw_context *pDC = (swr_draw_context*)hPrivateContext;
 
-   if (!pDC)
+   if (!pDC || !pDC->pStats)
       return;
 
    struct swr_query_result *pqr = pDC->pStats;
@@ -462,6 +470,8 @@ swr_UpdateStatsFE(HANDLE hPrivateContext, const SWR_STATS_FE *pStats)
    p_atomic_add(&pSwrStats->CInvocations, pStats->CInvocations);
    p_atomic_add(&pSwrStats->CPrimitives, pStats->CPrimitives);
    p_atomic_add(&pSwrStats->GsPrimitives, pStats->GsPrimitives);
+   p_atomic_add(&pSwrStats->Draws, pStats->Draws);
+   p_atomic_add(&pSwrStats->FeCycles, pStats->FeCycles);
 
    for (unsigned i = 0; i < 4; i++) {
       p_atomic_add(&pSwrStats->SoPrimStorageNeeded[i],
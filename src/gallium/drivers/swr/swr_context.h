@@ -29,6 +29,7 @@
 #include "pipe/p_context.h"
 #include "pipe/p_state.h"
 #include "util/u_blitter.h"
+#include "util/list.h"
 #include "jit_api.h"
 #include "swr_state.h"
 #include <unordered_map>
@@ -52,6 +53,11 @@
 #define SWR_NEW_CLIP (1 << 16)
 #define SWR_NEW_SO (1 << 17)
 #define SWR_LARGE_CLIENT_DRAW (1<<18) // Indicates client draw will block
+#define SWR_NEW_TCS (1 << 19)
+#define SWR_NEW_TES (1 << 20)
+#define SWR_NEW_TS (1 << 21)
+#define SWR_NEW_TCSCONSTANTS (1 << 22)
+#define SWR_NEW_TESCONSTANTS (1 << 23)
 
 namespace std
 {
@@ -89,6 +95,10 @@ struct swr_draw_context {
    uint32_t num_constantsFS[PIPE_MAX_CONSTANT_BUFFERS];
    const float *constantGS[PIPE_MAX_CONSTANT_BUFFERS];
    uint32_t num_constantsGS[PIPE_MAX_CONSTANT_BUFFERS];
+   const float *constantTCS[PIPE_MAX_CONSTANT_BUFFERS];
+   uint32_t num_constantsTCS[PIPE_MAX_CONSTANT_BUFFERS];
+   const float *constantTES[PIPE_MAX_CONSTANT_BUFFERS];
+   uint32_t num_constantsTES[PIPE_MAX_CONSTANT_BUFFERS];
 
    swr_jit_texture texturesVS[PIPE_MAX_SHADER_SAMPLER_VIEWS];
    swr_jit_sampler samplersVS[PIPE_MAX_SAMPLERS];
@@ -96,9 +106,17 @@ struct swr_draw_context {
    swr_jit_sampler samplersFS[PIPE_MAX_SAMPLERS];
    swr_jit_texture texturesGS[PIPE_MAX_SHADER_SAMPLER_VIEWS];
    swr_jit_sampler samplersGS[PIPE_MAX_SAMPLERS];
+   swr_jit_texture texturesTCS[PIPE_MAX_SHADER_SAMPLER_VIEWS];
+   swr_jit_sampler samplersTCS[PIPE_MAX_SAMPLERS];
+   swr_jit_texture texturesTES[PIPE_MAX_SHADER_SAMPLER_VIEWS];
+   swr_jit_sampler samplersTES[PIPE_MAX_SAMPLERS];
 
    float userClipPlanes[PIPE_MAX_CLIP_PLANES][4];
 
+   /* read by the fixed-function TCS */
+   float defaultTessOuter[4];
+   float defaultTessInner[2];
+
    uint32_t polyStipple[32];
 
    SWR_SURFACE_STATE renderTargets[SWR_NUM_ATTACHMENTS];
@@ -122,6 +140,9 @@ struct swr_context {
    struct swr_vertex_shader *vs;
    struct swr_fragment_shader *fs;
    struct swr_geometry_shader *gs;
+   struct swr_tess_ctrl_shader *tcs;
+   struct swr_tess_eval_shader *tes;
+   struct swr_tess_ctrl_shader *tcs_fixed_func; /**< used when tcs is NULL */
    struct swr_vertex_element_state *velems;
 
    /** Other rendering state */
@@ -147,12 +168,14 @@ struct swr_context {
    enum pipe_render_cond_flag render_cond_mode;
    boolean render_cond_cond;
    unsigned active_queries;
+   struct list_head query_list;  /**< active counter queries */
 
    unsigned num_vertex_buffers;
    unsigned num_samplers[PIPE_SHADER_TYPES];
    unsigned num_sampler_views[PIPE_SHADER_TYPES];
 
    unsigned sample_mask;
+   unsigned patch_vertices; /**< of the last PIPE_PRIM_PATCHES draw */
 
    // streamout
    pipe_stream_output_target *so_targets[MAX_SO_STREAMS];
@@ -184,13 +207,10 @@ swr_context(struct pipe_context *pipe)
 }
 
 static INLINE void
-swr_update_draw_context(struct swr_context *ctx,
-      struct swr_query_result *pqr = nullptr)
+swr_update_draw_context(struct swr_context *ctx)
 {
    swr_draw_context *pDC =
       (swr_draw_context *)ctx->api.pfnSwrGetPrivateContextState(ctx->swrContext);
-   if (pqr)
-      ctx->swrDC.pStats = pqr;
    memcpy(pDC, &ctx->swrDC, sizeof(swr_draw_context));
 }
 
@@ -180,6 +180,13 @@ swr_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info)
    enum pipe_prim_type topology;
    if (ctx->gs)
       topology = (pipe_prim_type)ctx->gs->info.base.properties[TGSI_PROPERTY_GS_OUTPUT_PRIM];
+   else if (ctx->tes && ctx->tes->info.base.properties[TGSI_PROPERTY_TES_POINT_MODE])
+      topology = PIPE_PRIM_POINTS;
+   else if (ctx->tes &&
+            ctx->tes->info.base.properties[TGSI_PROPERTY_TES_PRIM_MODE] == PIPE_PRIM_LINES)
+      topology = PIPE_PRIM_LINES;
+   else if (ctx->tes)
+      topology = PIPE_PRIM_TRIANGLES;
    else
       topology = info->mode;
 
@@ -212,7 +219,7 @@ swr_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info)
 
    if (info->index_size)
       ctx->api.pfnSwrDrawIndexedInstanced(ctx->swrContext,
-                                          swr_convert_prim_topology(info->mode),
+                                          swr_convert_prim_topology(info->mode, info->vertices_per_patch),
                                           info->count,
                                           info->instance_count,
                                           info->start,
@@ -220,7 +227,7 @@ swr_draw_vbo(struct pipe_context *pipe, const struct pipe_draw_info *info)
                                           info->start_instance);
    else
       ctx->api.pfnSwrDrawInstanced(ctx->swrContext,
-                                   swr_convert_prim_topology(info->mode),
+                                   swr_convert_prim_topology(info->mode, info->vertices_per_patch),
                                    info->count,
                                    info->instance_count,
                                    info->start,
@@ -105,6 +105,18 @@ swr_delete_gs_cb(struct swr_fence_work *work)
    delete work->free.swr_gs;
 }
 
+static void
+swr_delete_tcs_cb(struct swr_fence_work *work)
+{
+   delete work->free.swr_tcs;
+}
+
+static void
+swr_delete_tes_cb(struct swr_fence_work *work)
+{
+   delete work->free.swr_tes;
+}
+
 bool
 swr_fence_work_free(struct pipe_fence_handle *fence, void *data,
                     bool aligned_free)
@@ -167,3 +179,33 @@ swr_fence_work_delete_gs(struct pipe_fence_handle *fence,
 
    return true;
 }
+
+bool
+swr_fence_work_delete_tcs(struct pipe_fence_handle *fence,
+                          struct swr_tess_ctrl_shader *swr_tcs)
+{
+   struct swr_fence_work *work = CALLOC_STRUCT(swr_fence_work);
+   if (!work)
+      return false;
+   work->callback = swr_delete_tcs_cb;
+   work->free.swr_tcs = swr_tcs;
+
+   swr_add_fence_work(fence, work);
+
+   return true;
+}
+
+bool
+swr_fence_work_delete_tes(struct pipe_fence_handle *fence,
+                          struct swr_tess_eval_shader *swr_tes)
+{
+   struct swr_fence_work *work = CALLOC_STRUCT(swr_fence_work);
+   if (!work)
+      return false;
+   work->callback = swr_delete_tes_cb;
+   work->free.swr_tes = swr_tes;
+
+   swr_add_fence_work(fence, work);
+
+   return true;
+}
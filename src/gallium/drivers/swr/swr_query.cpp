@@ -22,6 +22,7 @@
  ***************************************************************************/
 
 #include "pipe/p_defines.h"
+#include "util/u_inlines.h"
 #include "util/u_memory.h"
 #include "util/os_time.h"
 #include "swr_context.h"
@@ -37,12 +38,94 @@ swr_query(struct pipe_query *p)
    return (struct swr_query *)p;
 }
 
+static void
+swr_stats_interval_reference(struct swr_stats_interval **ptr,
+                             struct swr_stats_interval *interval)
+{
+   struct swr_stats_interval *old = *ptr;
+
+   if (pipe_reference(old ? &old->reference : NULL,
+                      interval ? &interval->reference : NULL))
+      AlignedFree(old);
+   *ptr = interval;
+}
+
+/*
+ * Send the stats of subsequent draws to a new interval, referenced by
+ * every active counter query.  Called whenever a counter query begins or
+ * ends, so that a query's intervals hold exactly the draws issued while
+ * it was active.
+ */
+static void
+swr_new_stats_interval(struct swr_context *ctx)
+{
+   struct swr_query_result *stats = NULL;
+
+   if (!LIST_IS_EMPTY(&ctx->query_list)) {
+      struct swr_stats_interval *interval = (struct swr_stats_interval *)
+         AlignedMalloc(sizeof(struct swr_stats_interval), 64);
+      memset(interval, 0, sizeof(*interval));
+      pipe_reference_init(&interval->reference, 1);
+
+      list_for_each_entry(struct swr_query, pq, &ctx->query_list, list) {
+         struct swr_stats_interval *ref = NULL;
+         swr_stats_interval_reference(&ref, interval);
+         util_dynarray_append(&pq->intervals,
+                              struct swr_stats_interval *, ref);
+      }
+
+      /* Draws can only use it while a query holds a reference */
+      stats = &interval->stats;
+      swr_stats_interval_reference(&interval, NULL);
+   }
+
+   ctx->swrDC.pStats = stats;
+   swr_update_draw_context(ctx);
+}
+
+static void
+swr_add_counters(uint64_t *dst, const uint64_t *src, unsigned size)
+{
+   for (unsigned i = 0; i < size / sizeof(uint64_t); i++)
+      dst[i] += src[i];
+}
+
+/*
+ * Add up the intervals of a query, once all of their draws are done.
+ */
+static void
+swr_query_collect(struct swr_query *pq)
+{
+   STATIC_ASSERT(sizeof(SWR_STATS) % sizeof(uint64_t) == 0);
+   STATIC_ASSERT(sizeof(SWR_STATS_FE) % sizeof(uint64_t) == 0);
+
+   util_dynarray_foreach(&pq->intervals, struct swr_stats_interval *, it) {
+      swr_add_counters((uint64_t *)&pq->result.core,
+                       (const uint64_t *)&(*it)->stats.core,
+                       sizeof(SWR_STATS));
+      swr_add_counters((uint64_t *)&pq->result.coreFE,
+                       (const uint64_t *)&(*it)->stats.coreFE,
+                       sizeof(SWR_STATS_FE));
+      swr_stats_interval_reference(it, NULL);
+   }
+   util_dynarray_clear(&pq->intervals);
+}
+
+static void
+swr_query_release(struct swr_query *pq)
+{
+   util_dynarray_foreach(&pq->intervals, struct swr_stats_interval *, it)
+      swr_stats_interval_reference(it, NULL);
+   util_dynarray_clear(&pq->intervals);
+}
+
 static struct pipe_query *
 swr_create_query(struct pipe_context *pipe, unsigned type, unsigned index)
 {
    struct swr_query *pq;
 
-   assert(type < PIPE_QUERY_TYPES);
+   assert(type < PIPE_QUERY_TYPES ||
+          (type >= PIPE_QUERY_DRIVER_SPECIFIC && type <= SWR_QUERY_LAST));
    assert(index < MAX_SO_STREAMS);
 
    pq = (struct swr_query *) AlignedMalloc(sizeof(struct swr_query), 64);
@@ -51,23 +134,33 @@ swr_create_query(struct pipe_context *pipe, unsigned type, unsigned index)
    if (pq) {
       pq->type = type;
       pq->index = index;
+      util_dynarray_init(&pq->intervals, NULL);
    }
 
    return (struct pipe_query *)pq;
 }
 
 
+static bool
+swr_end_query(struct pipe_context *pipe, struct pipe_query *q);
+
 static void
 swr_destroy_query(struct pipe_context *pipe, struct pipe_query *q)
 {
    struct swr_query *pq = swr_query(q);
 
+   /* In-flight draws may still write to the query's intervals */
+   if (pq->active)
+      swr_end_query(pipe, q);
+
    if (pq->fence) {
       if (swr_is_fence_pending(pq->fence))
          swr_fence_finish(pipe->screen, NULL, pq->fence, 0);
       swr_fence_reference(pipe->screen, &pq->fence, NULL);
    }
 
+   swr_query_release(pq);
+   util_dynarray_fini(&pq->intervals);
    AlignedFree(pq);
 }
 
@@ -89,8 +182,10 @@ swr_get_query_result(struct pipe_context *pipe,
       swr_fence_reference(pipe->screen, &pq->fence, NULL);
    }
 
+   swr_query_collect(pq);
+
    /* All values are reset to 0 at swr_begin_query, except starting timestamp.
-    * Counters become simply end values.  */
+    * Counters become the sum of the query's stats intervals.  */
    switch (pq->type) {
    /* Booleans */
    case PIPE_QUERY_OCCLUSION_PREDICATE:
@@ -150,6 +245,23 @@ swr_get_query_result(struct pipe_context *pipe,
       result->b = num_primitives_written > primitives_storage_needed;
    }
       break;
+   /* Driver specific */
+   case SWR_QUERY_EARLY_Z_KILL_RATE: {
+      uint64_t tested = pq->result.core.EarlyDepthTestCount;
+      result->u64 = tested ?
+         pq->result.core.EarlyDepthKillCount * 100 / tested : 0;
+   } break;
+   case SWR_QUERY_TILES_PER_DRAW: {
+      uint64_t draws = pq->result.coreFE.Draws;
+      result->f = draws ?
+         (float)pq->result.core.MacroTiles / (float)draws : 0.0f;
+   } break;
+   case SWR_QUERY_FE_CYCLES:
+      result->u64 = pq->result.coreFE.FeCycles;
+      break;
+   case SWR_QUERY_BE_CYCLES:
+      result->u64 = pq->result.core.BeCycles;
+      break;
    default:
       assert(0 && "Unsupported query");
       break;
@@ -166,6 +278,12 @@ swr_begin_query(struct pipe_context *pipe, struct pipe_query *q)
 
    /* Initialize Results */
    memset(&pq->result, 0, sizeof(pq->result));
+
+   /* Draws of the previous begin/end pair may still write to its
+    * intervals if the result was never read. */
+   if (pq->fence && swr_is_fence_pending(pq->fence))
+      swr_fence_finish(pipe->screen, NULL, pq->fence, 0);
+   swr_query_release(pq);
    switch (pq->type) {
    case PIPE_QUERY_GPU_FINISHED:
    case PIPE_QUERY_TIMESTAMP:
@@ -175,9 +293,11 @@ swr_begin_query(struct pipe_context *pipe, struct pipe_query *q)
       pq->result.timestamp_start = swr_get_timestamp(pipe->screen);
       break;
    default:
-      /* Core counters required.  Update draw context with location to
-       * store results. */
-      swr_update_draw_context(ctx, &pq->result);
+      /* Core counters required.  Start a new stats interval for the draw
+       * context, which this query will add up. */
+      LIST_ADDTAIL(&pq->list, &ctx->query_list);
+      pq->active = TRUE;
+      swr_new_stats_interval(ctx);
 
       /* Only change stat collection if there are no active queries */
       if (ctx->active_queries == 0) {
@@ -207,6 +327,11 @@ swr_end_query(struct pipe_context *pipe, struct pipe_query *q)
       pq->result.timestamp_end = swr_get_timestamp(pipe->screen);
       break;
    default:
+      /* Later draws go to an interval this query doesn't hold */
+      LIST_DEL(&pq->list);
+      pq->active = FALSE;
+      swr_new_stats_interval(ctx);
+
       /* Stats are updated asynchronously, a fence is used to signal
        * completion. */
       if (!pq->fence) {
@@ -256,6 +381,36 @@ swr_set_active_query_state(struct pipe_context *pipe, boolean enable)
 {
 }
 
+/* Backend tuning counters.  They are collected with the core stats, so
+ * they only cost anything while a query is active. */
+int
+swr_get_driver_query_info(struct pipe_screen *screen,
+                          unsigned index,
+                          struct pipe_driver_query_info *info)
+{
+#define QUERY(NAME, ENUM, TYPE, RESULT_TYPE) \
+   {NAME, ENUM, {0}, PIPE_DRIVER_QUERY_TYPE_##TYPE, \
+    PIPE_DRIVER_QUERY_RESULT_TYPE_##RESULT_TYPE, 0, 0x0}
+
+   static const struct pipe_driver_query_info queries[] = {
+      QUERY("early-z-kill-rate", SWR_QUERY_EARLY_Z_KILL_RATE, PERCENTAGE, AVERAGE),
+      QUERY("tiles-per-draw", SWR_QUERY_TILES_PER_DRAW, FLOAT, AVERAGE),
+      QUERY("fe-cycles", SWR_QUERY_FE_CYCLES, UINT64, CUMULATIVE),
+      QUERY("be-cycles", SWR_QUERY_BE_CYCLES, UINT64, CUMULATIVE),
+   };
+
+#undef QUERY
+
+   if (!info)
+      return ARRAY_SIZE(queries);
+
+   if (index >= ARRAY_SIZE(queries))
+      return 0;
+
+   *info = queries[index];
+   return 1;
+}
+
 void
 swr_query_init(struct pipe_context *pipe)
 {
@@ -269,4 +424,5 @@ swr_query_init(struct pipe_context *pipe)
    pipe->set_active_query_state = swr_set_active_query_state;
 
    ctx->active_queries = 0;
+   LIST_INITHEAD(&ctx->query_list);
 }
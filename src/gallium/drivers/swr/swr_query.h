@@ -27,6 +27,18 @@
 
 #include <limits.h>
 
+#include "util/list.h"
+#include "util/u_dynarray.h"
+
+struct pipe_driver_query_info;
+
+/** Driver specific queries, see swr_get_driver_query_info() */
+#define SWR_QUERY_EARLY_Z_KILL_RATE (PIPE_QUERY_DRIVER_SPECIFIC + 0)
+#define SWR_QUERY_TILES_PER_DRAW    (PIPE_QUERY_DRIVER_SPECIFIC + 1)
+#define SWR_QUERY_FE_CYCLES         (PIPE_QUERY_DRIVER_SPECIFIC + 2)
+#define SWR_QUERY_BE_CYCLES         (PIPE_QUERY_DRIVER_SPECIFIC + 3)
+#define SWR_QUERY_LAST              SWR_QUERY_BE_CYCLES
+
 struct swr_query_result {
    SWR_STATS core;
    SWR_STATS_FE coreFE;
@@ -34,15 +46,34 @@ struct swr_query_result {
    uint64_t timestamp_end;
 };
 
+/**
+ * Core counters of the draws issued between two begin/end calls of
+ * counter queries.  Draws accumulate into the context's current interval,
+ * and each query adds up the intervals that were current while it was
+ * active, so any number of queries can be active at once.
+ */
+OSALIGNLINE(struct) swr_stats_interval {
+   struct pipe_reference reference;
+   struct swr_query_result stats;
+};
+
 OSALIGNLINE(struct) swr_query {
    unsigned type; /* PIPE_QUERY_* */
    unsigned index;
 
    struct swr_query_result result;
    struct pipe_fence_handle *fence;
+
+   struct list_head list;          /**< in swr_context::query_list */
+   boolean active;
+   struct util_dynarray intervals; /**< struct swr_stats_interval * */
 };
 
 extern void swr_query_init(struct pipe_context *pipe);
 
+extern int swr_get_driver_query_info(struct pipe_screen *screen,
+                                     unsigned index,
+                                     struct pipe_driver_query_info *info);
+
 extern boolean swr_check_render_cond(struct pipe_context *pipe);
 #endif
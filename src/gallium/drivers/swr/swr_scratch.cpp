@@ -94,6 +94,8 @@ swr_destroy_scratch_buffers(struct swr_context *ctx)
       AlignedFree(scratch->vs_constants.base);
       AlignedFree(scratch->fs_constants.base);
       AlignedFree(scratch->gs_constants.base);
+      AlignedFree(scratch->tcs_constants.base);
+      AlignedFree(scratch->tes_constants.base);
       AlignedFree(scratch->vertex_buffer.base);
       AlignedFree(scratch->index_buffer.base);
       FREE(scratch);
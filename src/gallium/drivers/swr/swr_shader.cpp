@@ -36,6 +36,9 @@
 #include "tgsi/tgsi_strings.h"
 #include "util/u_format.h"
 #include "util/u_prim.h"
+#include "util/disk_cache.h"
+#include "util/mesa-sha1.h"
+#include "gallivm/lp_bld_debug.h"
 #include "gallivm/lp_bld_init.h"
 #include "gallivm/lp_bld_flow.h"
 #include "gallivm/lp_bld_struct.h"
@@ -73,6 +76,16 @@ bool operator==(const swr_jit_gs_key &lhs, const swr_jit_gs_key &rhs)
    return !memcmp(&lhs, &rhs, sizeof(lhs));
 }
 
+bool operator==(const swr_jit_tcs_key &lhs, const swr_jit_tcs_key &rhs)
+{
+   return !memcmp(&lhs, &rhs, sizeof(lhs));
+}
+
+bool operator==(const swr_jit_tes_key &lhs, const swr_jit_tes_key &rhs)
+{
+   return !memcmp(&lhs, &rhs, sizeof(lhs));
+}
+
 static void
 swr_generate_sampler_key(const struct lp_tgsi_info &info,
                          struct swr_context *ctx,
@@ -148,6 +161,8 @@ swr_generate_fs_key(struct swr_jit_fs_key &key,
    struct tgsi_shader_info *pPrevShader;
    if (ctx->gs)
       pPrevShader = &ctx->gs->info.base;
+   else if (ctx->tes)
+      pPrevShader = &ctx->tes->info.base;
    else
       pPrevShader = &ctx->vs->info.base;
 
@@ -195,7 +210,11 @@ swr_generate_gs_key(struct swr_jit_gs_key &key,
 {
    memset(&key, 0, sizeof(key));
 
-   struct tgsi_shader_info *pPrevShader = &ctx->vs->info.base;
+   struct tgsi_shader_info *pPrevShader;
+   if (ctx->tes)
+      pPrevShader = &ctx->tes->info.base;
+   else
+      pPrevShader = &ctx->vs->info.base;
 
    memcpy(&key.vs_output_semantic_name,
           &pPrevShader->output_semantic_name,
@@ -207,12 +226,109 @@ swr_generate_gs_key(struct swr_jit_gs_key &key,
    swr_generate_sampler_key(swr_gs->info, ctx, PIPE_SHADER_GEOMETRY, key);
 }
 
+void
+swr_generate_tcs_key(struct swr_jit_tcs_key &key,
+                     struct swr_context *ctx,
+                     swr_tess_ctrl_shader *swr_tcs)
+{
+   memset(&key, 0, sizeof(key));
+
+   struct tgsi_shader_info *pPrevShader = &ctx->vs->info.base;
+
+   memcpy(&key.vs_output_semantic_name,
+          &pPrevShader->output_semantic_name,
+          sizeof(key.vs_output_semantic_name));
+   memcpy(&key.vs_output_semantic_idx,
+          &pPrevShader->output_semantic_index,
+          sizeof(key.vs_output_semantic_idx));
+
+   key.tes_prim_mode =
+      ctx->tes->info.base.properties[TGSI_PROPERTY_TES_PRIM_MODE];
+   key.vertices_per_patch = ctx->patch_vertices;
+
+   if (swr_tcs->pipe.tokens)
+      swr_generate_sampler_key(swr_tcs->info, ctx, PIPE_SHADER_TESS_CTRL, key);
+}
+
+void
+swr_generate_tes_key(struct swr_jit_tes_key &key,
+                     struct swr_context *ctx,
+                     swr_tess_eval_shader *swr_tes)
+{
+   memset(&key, 0, sizeof(key));
+
+   key.clip_plane_mask =
+      swr_tes->info.base.clipdist_writemask ?
+      swr_tes->info.base.clipdist_writemask & ctx->rasterizer->clip_plane_enable :
+      ctx->rasterizer->clip_plane_enable;
+
+   /* the fixed-function TCS hands the VS outputs on unchanged */
+   struct tgsi_shader_info *pPrevShader;
+   if (ctx->tcs)
+      pPrevShader = &ctx->tcs->info.base;
+   else
+      pPrevShader = &ctx->vs->info.base;
+
+   memcpy(&key.tcs_output_semantic_name,
+          &pPrevShader->output_semantic_name,
+          sizeof(key.tcs_output_semantic_name));
+   memcpy(&key.tcs_output_semantic_idx,
+          &pPrevShader->output_semantic_index,
+          sizeof(key.tcs_output_semantic_idx));
+
+   key.vertices_in = ctx->tcs ?
+      ctx->tcs->info.base.properties[TGSI_PROPERTY_TCS_VERTICES_OUT] :
+      ctx->patch_vertices;
+
+   swr_generate_sampler_key(swr_tes->info, ctx, PIPE_SHADER_TESS_EVAL, key);
+}
+
+/*
+ * Name of a shader variant in the JitManager's object cache.  Unlike the
+ * fetch, blend and streamout modules, gallivm's are not checked against
+ * their IR when loaded, so this hashes everything the code depends on: the
+ * build, the shader tokens and the variant key.  The CPU and ISA are taken
+ * care of by the cache itself.  Returns an empty name if the build can't be
+ * identified, which disables caching.
+ */
+static std::string
+swr_shader_cache_name(const char *stage, const struct tgsi_token *tokens,
+                      const void *key, size_t key_size)
+{
+   static uint32_t timestamps[2];
+   static const bool have_timestamps =
+      disk_cache_get_function_timestamp((void *)swr_shader_cache_name,
+                                        &timestamps[0]) &&
+      disk_cache_get_function_timestamp((void *)LLVMModuleCreateWithNameInContext,
+                                        &timestamps[1]);
+   if (!have_timestamps)
+      return std::string();
+
+   unsigned gallivm_flags[2] = { gallivm_debug, lp_native_vector_width };
+   struct mesa_sha1 sha1_ctx;
+   unsigned char sha1[20];
+   char hex[20 * 2 + 1];
+
+   _mesa_sha1_init(&sha1_ctx);
+   _mesa_sha1_update(&sha1_ctx, timestamps, sizeof(timestamps));
+   _mesa_sha1_update(&sha1_ctx, gallivm_flags, sizeof(gallivm_flags));
+   if (tokens)
+      _mesa_sha1_update(&sha1_ctx, tokens,
+                        tgsi_num_tokens(tokens) * sizeof(struct tgsi_token));
+   _mesa_sha1_update(&sha1_ctx, key, key_size);
+   _mesa_sha1_final(&sha1_ctx, sha1);
+   disk_cache_format_hex_id(hex, sha1, 20 * 2);
+
+   return std::string(stage) + "_" + hex;
+}
+
 struct BuilderSWR : public Builder {
    BuilderSWR(JitManager *pJitMgr, const char *pName)
       : Builder(pJitMgr)
    {
       pJitMgr->SetupNewModule();
-      gallivm = gallivm_create(pName, wrap(&JM()->mContext));
+      gallivm = gallivm_create(pName, wrap(&JM()->mContext),
+                               pJitMgr->mCache.IsEnabled() ? &cached : NULL);
       pJitMgr->mpCurrentModule = unwrap(gallivm->module);
    }
 
@@ -223,10 +339,33 @@ struct BuilderSWR : public Builder {
    void WriteVS(Value *pVal, Value *pVsContext, Value *pVtxOutput,
                 unsigned slot, unsigned channel);
 
+   void WriteDS(Value *pVal, Value *pDsContext,
+                unsigned slot, unsigned channel);
+
+   template <typename WriteFunc>
+   void WriteClipDistances(struct swr_context *ctx,
+                           struct tgsi_shader_info *info,
+                           Value *hPrivateData,
+                           LLVMValueRef (*outputs)[TGSI_NUM_CHANNELS],
+                           bool simd16, WriteFunc write);
+
+   Value *TessFactorPtr(Value *pPatch, bool outer, unsigned channel,
+                        unsigned tes_prim_mode);
+   Value *TessPatchPtr(struct tgsi_shader_info *info, unsigned tes_prim_mode,
+                       Value *pPatch, Value *vert_index, Value *attr_index,
+                       unsigned channel);
+
+   template <typename Key>
+   func_pointer JitFunction(Function *pFunction, const char *stage,
+                     const struct tgsi_token *tokens, const Key &key);
+
    struct gallivm_state *gallivm;
+   struct lp_cached_code cached = {};
    PFN_VERTEX_FUNC CompileVS(struct swr_context *ctx, swr_jit_vs_key &key);
    PFN_PIXEL_KERNEL CompileFS(struct swr_context *ctx, swr_jit_fs_key &key);
    PFN_GS_FUNC CompileGS(struct swr_context *ctx, swr_jit_gs_key &key);
+   PFN_HS_FUNC CompileTCS(struct swr_context *ctx, swr_jit_tcs_key &key);
+   PFN_DS_FUNC CompileTES(struct swr_context *ctx, swr_jit_tes_key &key);
 
    LLVMValueRef
    swr_gs_llvm_fetch_input(const struct lp_build_tgsi_gs_iface *gs_iface,
@@ -254,6 +393,50 @@ struct BuilderSWR : public Builder {
                         LLVMValueRef total_emitted_vertices_vec,
                         LLVMValueRef emitted_prims_vec);
 
+   LLVMValueRef
+   swr_tcs_llvm_fetch_vertex_input(const struct lp_build_tgsi_tess_iface *tess_iface,
+                                   struct lp_build_tgsi_context * bld_base,
+                                   boolean is_vindex_indirect,
+                                   LLVMValueRef vertex_index,
+                                   boolean is_aindex_indirect,
+                                   LLVMValueRef attrib_index,
+                                   LLVMValueRef swizzle_index);
+
+   LLVMValueRef
+   swr_tcs_llvm_fetch_output(const struct lp_build_tgsi_tess_iface *tess_iface,
+                             struct lp_build_tgsi_context * bld_base,
+                             boolean is_vindex_indirect,
+                             LLVMValueRef vertex_index,
+                             boolean is_aindex_indirect,
+                             LLVMValueRef attrib_index,
+                             LLVMValueRef swizzle_index);
+
+   void
+   swr_tcs_llvm_store_output(const struct lp_build_tgsi_tess_iface *tess_iface,
+                             struct lp_build_tgsi_context * bld_base,
+                             boolean is_vindex_indirect,
+                             LLVMValueRef vertex_index,
+                             boolean is_aindex_indirect,
+                             LLVMValueRef attrib_index,
+                             LLVMValueRef swizzle_index,
+                             LLVMValueRef value,
+                             LLVMValueRef mask_vec);
+
+   LLVMValueRef
+   swr_tes_llvm_fetch_vertex_input(const struct lp_build_tgsi_tess_iface *tess_iface,
+                                   struct lp_build_tgsi_context * bld_base,
+                                   boolean is_vindex_indirect,
+                                   LLVMValueRef vertex_index,
+                                   boolean is_aindex_indirect,
+                                   LLVMValueRef attrib_index,
+                                   LLVMValueRef swizzle_index);
+
+   LLVMValueRef
+   swr_tes_llvm_fetch_patch_input(const struct lp_build_tgsi_tess_iface *tess_iface,
+                                  struct lp_build_tgsi_context * bld_base,
+                                  boolean is_aindex_indirect,
+                                  LLVMValueRef attrib_index,
+                                  LLVMValueRef swizzle_index);
 };
 
 struct swr_gs_llvm_iface {
@@ -503,77 +686,1090 @@ BuilderSWR::swr_gs_llvm_end_primitive(const struct lp_build_tgsi_gs_iface *gs_ba
     Value *pStack = STACKSAVE();
     Value *pTmpPtr = ALLOCA(mInt8Ty, C(4)); // used for dummy read/write for lane masking
 
-    for (uint32_t lane = 0; lane < mVWidth; ++lane) {
-       Value *vLaneOffset = VEXTRACT(vOffset, C(lane));
-       Value *pStream = LOAD(iface->pGsCtx, {0, SWR_GS_CONTEXT_pStreams, lane});
-       Value *pStreamOffset = GEP(pStream, vLaneOffset);
+    for (uint32_t lane = 0; lane < mVWidth; ++lane) {
+       Value *vLaneOffset = VEXTRACT(vOffset, C(lane));
+       Value *pStream = LOAD(iface->pGsCtx, {0, SWR_GS_CONTEXT_pStreams, lane});
+       Value *pStreamOffset = GEP(pStream, vLaneOffset);
+
+       Value *pLaneMask = VEXTRACT(vMask1, C(lane));
+       pStreamOffset = SELECT(pLaneMask, pStreamOffset, pTmpPtr);
+
+       Value *vVal = LOAD(pStreamOffset);
+       vVal = OR(vVal, VEXTRACT(vValue, C(lane)));
+       STORE(vVal, pStreamOffset);
+    }
+
+    STACKRESTORE(pStack);
+}
+
+void
+BuilderSWR::swr_gs_llvm_epilogue(const struct lp_build_tgsi_gs_iface *gs_base,
+                        struct lp_build_tgsi_context * bld_base,
+                        LLVMValueRef total_emitted_vertices_vec,
+                        LLVMValueRef emitted_prims_vec)
+{
+   swr_gs_llvm_iface *iface = (swr_gs_llvm_iface*)gs_base;
+
+   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+   // Store emit count to each output stream in the first DWORD
+   for (uint32_t lane = 0; lane < mVWidth; ++lane)
+   {
+      Value* pStream = LOAD(iface->pGsCtx, {0, SWR_GS_CONTEXT_pStreams, lane});
+      pStream = BITCAST(pStream, mInt32PtrTy);
+      Value* pLaneCount = VEXTRACT(unwrap(total_emitted_vertices_vec), C(lane));
+      STORE(pLaneCount, pStream);
+   }
+}
+
+/*
+ * gallivm_compile_module and gallivm_jit_function, with the machine code
+ * loaded from or stored to the JitManager's object cache when it's enabled.
+ */
+template <typename Key>
+func_pointer
+BuilderSWR::JitFunction(Function *pFunction, const char *stage,
+                        const struct tgsi_token *tokens, const Key &key)
+{
+   std::string name;
+   std::unique_ptr<MemoryBuffer> pObj;
+
+   if (gallivm->cache && !cached.dont_cache) {
+      name = swr_shader_cache_name(stage, tokens, &key, sizeof(key));
+      pObj = JM()->mCache.LoadObject(name);
+   }
+
+   if (pObj) {
+      cached.data = (void *)pObj->getBufferStart();
+      cached.data_size = pObj->getBufferSize();
+   }
+
+   gallivm_compile_module(gallivm);
+
+   func_pointer pFunc = gallivm_jit_function(gallivm, wrap(pFunction));
+
+   /* On a miss gallivm hands back a malloc'ed copy of the new object */
+   if (!pObj && cached.data) {
+      if (name.length() && !cached.dont_cache)
+         JM()->mCache.StoreObject(name, StringRef((const char *)cached.data,
+                                                  cached.data_size));
+      free(cached.data);
+   }
+
+   cached.data = NULL;
+   cached.data_size = 0;
+
+   return pFunc;
+}
+
+PFN_GS_FUNC
+BuilderSWR::CompileGS(struct swr_context *ctx, swr_jit_gs_key &key)
+{
+   SWR_GS_STATE *pGS = &ctx->gs->gsState;
+   struct tgsi_shader_info *info = &ctx->gs->info.base;
+
+   memset(pGS, 0, sizeof(*pGS));
+
+   pGS->gsEnable = true;
+
+   pGS->numInputAttribs = info->num_inputs;
+   pGS->outputTopology =
+      swr_convert_prim_topology(info->properties[TGSI_PROPERTY_GS_OUTPUT_PRIM]);
+   pGS->maxNumVerts = info->properties[TGSI_PROPERTY_GS_MAX_OUTPUT_VERTICES];
+   pGS->instanceCount = info->properties[TGSI_PROPERTY_GS_INVOCATIONS];
+
+   // XXX: single stream for now...
+   pGS->isSingleStream = true;
+   pGS->singleStreamID = 0;
+
+   pGS->vertexAttribOffset = VERTEX_ATTRIB_START_SLOT; // TODO: optimize
+   pGS->srcVertexAttribOffset = VERTEX_ATTRIB_START_SLOT; // TODO: optimize
+   pGS->inputVertStride = pGS->numInputAttribs + pGS->vertexAttribOffset;
+   pGS->outputVertexSize = SWR_VTX_NUM_SLOTS;
+   pGS->controlDataSize = 8; // GS ouputs max of 8 32B units
+   pGS->controlDataOffset = VERTEX_COUNT_SIZE;
+   pGS->outputVertexOffset = pGS->controlDataOffset + CONTROL_HEADER_SIZE;
+
+   pGS->allocationSize =
+      VERTEX_COUNT_SIZE + // vertex count
+      CONTROL_HEADER_SIZE + // control header
+      (SWR_VTX_NUM_SLOTS * 16) * // sizeof vertex
+      pGS->maxNumVerts; // num verts
+
+   struct swr_geometry_shader *gs = ctx->gs;
+
+   LLVMValueRef inputs[PIPE_MAX_SHADER_INPUTS][TGSI_NUM_CHANNELS];
+   LLVMValueRef outputs[PIPE_MAX_SHADER_OUTPUTS][TGSI_NUM_CHANNELS];
+
+   memset(outputs, 0, sizeof(outputs));
+
+   AttrBuilder attrBuilder;
+   attrBuilder.addStackAlignmentAttr(JM()->mVWidth * sizeof(float));
+
+   std::vector<Type *> gsArgs{PointerType::get(Gen_swr_draw_context(JM()), 0),
+                              PointerType::get(Gen_SWR_GS_CONTEXT(JM()), 0)};
+   FunctionType *vsFuncType =
+      FunctionType::get(Type::getVoidTy(JM()->mContext), gsArgs, false);
+
+   // create new vertex shader function
+   auto pFunction = Function::Create(vsFuncType,
+                                     GlobalValue::ExternalLinkage,
+                                     "GS",
+                                     JM()->mpCurrentModule);
+#if HAVE_LLVM < 0x0500
+   AttributeSet attrSet = AttributeSet::get(
+      JM()->mContext, AttributeSet::FunctionIndex, attrBuilder);
+   pFunction->addAttributes(AttributeSet::FunctionIndex, attrSet);
+#else
+   pFunction->addAttributes(AttributeList::FunctionIndex, attrBuilder);
+#endif
+
+   BasicBlock *block = BasicBlock::Create(JM()->mContext, "entry", pFunction);
+   IRB()->SetInsertPoint(block);
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(block));
+
+   auto argitr = pFunction->arg_begin();
+   Value *hPrivateData = &*argitr++;
+   hPrivateData->setName("hPrivateData");
+   Value *pGsCtx = &*argitr++;
+   pGsCtx->setName("gsCtx");
+
+   Value *consts_ptr =
+      GEP(hPrivateData, {C(0), C(swr_draw_context_constantGS)});
+   consts_ptr->setName("gs_constants");
+   Value *const_sizes_ptr =
+      GEP(hPrivateData, {0, swr_draw_context_num_constantsGS});
+   const_sizes_ptr->setName("num_gs_constants");
+
+   struct lp_build_sampler_soa *sampler =
+      swr_sampler_soa_create(key.sampler, PIPE_SHADER_GEOMETRY);
+
+   struct lp_bld_tgsi_system_values system_values;
+   memset(&system_values, 0, sizeof(system_values));
+   system_values.prim_id = wrap(LOAD(pGsCtx, {0, SWR_GS_CONTEXT_PrimitiveID}));
+   system_values.instance_id = wrap(LOAD(pGsCtx, {0, SWR_GS_CONTEXT_InstanceID}));
+
+   /* the TES writes its outputs in the VS layout */
+   struct tgsi_shader_info *pPrevShader;
+   if (ctx->tes)
+      pPrevShader = &ctx->tes->info.base;
+   else
+      pPrevShader = &ctx->vs->info.base;
+
+   std::vector<Constant*> mapConstants;
+   Value *vtxAttribMap = ALLOCA(ArrayType::get(mInt32Ty, PIPE_MAX_SHADER_INPUTS));
+   for (unsigned slot = 0; slot < info->num_inputs; slot++) {
+      ubyte semantic_name = info->input_semantic_name[slot];
+      ubyte semantic_idx = info->input_semantic_index[slot];
+
+      unsigned vs_slot = locate_linkage(semantic_name, semantic_idx, pPrevShader);
+
+      vs_slot += VERTEX_ATTRIB_START_SLOT;
+
+      if (pPrevShader->output_semantic_name[0] == TGSI_SEMANTIC_POSITION)
+         vs_slot--;
+
+      if (semantic_name == TGSI_SEMANTIC_POSITION)
+         vs_slot = VERTEX_POSITION_SLOT;
+
+      STORE(C(vs_slot), vtxAttribMap, {0, slot});
+      mapConstants.push_back(C(vs_slot));
+   }
+
+   struct lp_build_mask_context mask;
+   Value *mask_val = LOAD(pGsCtx, {0, SWR_GS_CONTEXT_mask}, "gsMask");
+   lp_build_mask_begin(&mask, gallivm,
+                       lp_type_float_vec(32, 32 * 8), wrap(mask_val));
+
+   // zero out cut buffer so we can load/modify/store bits
+   for (uint32_t lane = 0; lane < mVWidth; ++lane)
+   {
+      Value* pStream = LOAD(pGsCtx, {0, SWR_GS_CONTEXT_pStreams, lane});
+      MEMSET(pStream, C((char)0), VERTEX_COUNT_SIZE + CONTROL_HEADER_SIZE, sizeof(float) * KNOB_SIMD_WIDTH);
+   }
+
+   struct swr_gs_llvm_iface gs_iface;
+   gs_iface.base.fetch_input = ::swr_gs_llvm_fetch_input;
+   gs_iface.base.emit_vertex = ::swr_gs_llvm_emit_vertex;
+   gs_iface.base.end_primitive = ::swr_gs_llvm_end_primitive;
+   gs_iface.base.gs_epilogue = ::swr_gs_llvm_epilogue;
+   gs_iface.pBuilder = this;
+   gs_iface.pGsCtx = pGsCtx;
+   gs_iface.pGsState = pGS;
+   gs_iface.num_outputs = gs->info.base.num_outputs;
+   gs_iface.num_verts_per_prim =
+      u_vertices_per_prim((pipe_prim_type)info->properties[TGSI_PROPERTY_GS_OUTPUT_PRIM]);
+   gs_iface.info = info;
+   gs_iface.pVtxAttribMap = vtxAttribMap;
+
+   lp_build_tgsi_soa(gallivm,
+                     gs->pipe.tokens,
+                     lp_type_float_vec(32, 32 * 8),
+                     &mask,
+                     wrap(consts_ptr),
+                     wrap(const_sizes_ptr),
+                     &system_values,
+                     inputs,
+                     outputs,
+                     wrap(hPrivateData), // (sampler context)
+                     NULL, // thread data
+                     sampler,
+                     &gs->info.base,
+                     &gs_iface.base,
+                     NULL, // compute shader interface
+                     NULL); // tessellation shader interface
+
+   lp_build_mask_end(&mask);
+
+   sampler->destroy(sampler);
+
+   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+   RET_VOID();
+
+   gallivm_verify_function(gallivm, wrap(pFunction));
+
+   PFN_GS_FUNC pFunc =
+      (PFN_GS_FUNC)JitFunction(pFunction, "GS",
+                               ctx->gs->pipe.tokens, key);
+
+   debug_printf("geom shader  %p\n", pFunc);
+   assert(pFunc && "Error: GeomShader = NULL");
+
+   JM()->mIsModuleFinalized = true;
+
+   return pFunc;
+}
+
+PFN_GS_FUNC
+swr_compile_gs(struct swr_context *ctx, swr_jit_gs_key &key)
+{
+   BuilderSWR builder(
+      reinterpret_cast<JitManager *>(swr_screen(ctx->pipe.screen)->hJitMgr),
+      "GS");
+   PFN_GS_FUNC func = builder.CompileGS(ctx, key);
+
+   ctx->gs->map.insert(std::make_pair(key, make_unique<VariantGS>(builder.gallivm, func)));
+   return func;
+}
+
+struct swr_tcs_llvm_iface {
+   struct lp_build_tgsi_tess_iface base;
+   struct tgsi_shader_info *info;
+
+   BuilderSWR *pBuilder;
+
+   Value *pTcsCtx;
+   unsigned tes_prim_mode;
+
+   Value *pVtxAttribMap;
+};
+
+struct swr_tes_llvm_iface {
+   struct lp_build_tgsi_tess_iface base;
+   struct tgsi_shader_info *info;
+
+   BuilderSWR *pBuilder;
+
+   Value *pTesCtx;
+
+   Value *pPatchAttribMap;
+};
+
+// trampoline functions so we can use the builder llvm construction methods
+static LLVMValueRef
+swr_tcs_llvm_fetch_vertex_input(const struct lp_build_tgsi_tess_iface *tess_iface,
+                                struct lp_build_tgsi_context * bld_base,
+                                boolean is_vindex_indirect,
+                                LLVMValueRef vertex_index,
+                                boolean is_aindex_indirect,
+                                LLVMValueRef attrib_index,
+                                LLVMValueRef swizzle_index)
+{
+    swr_tcs_llvm_iface *iface = (swr_tcs_llvm_iface*)tess_iface;
+
+    return iface->pBuilder->swr_tcs_llvm_fetch_vertex_input(tess_iface, bld_base,
+                                                           is_vindex_indirect,
+                                                           vertex_index,
+                                                           is_aindex_indirect,
+                                                           attrib_index,
+                                                           swizzle_index);
+}
+
+static LLVMValueRef
+swr_tcs_llvm_fetch_output(const struct lp_build_tgsi_tess_iface *tess_iface,
+                          struct lp_build_tgsi_context * bld_base,
+                          boolean is_vindex_indirect,
+                          LLVMValueRef vertex_index,
+                          boolean is_aindex_indirect,
+                          LLVMValueRef attrib_index,
+                          LLVMValueRef swizzle_index)
+{
+    swr_tcs_llvm_iface *iface = (swr_tcs_llvm_iface*)tess_iface;
+
+    return iface->pBuilder->swr_tcs_llvm_fetch_output(tess_iface, bld_base,
+                                                     is_vindex_indirect,
+                                                     vertex_index,
+                                                     is_aindex_indirect,
+                                                     attrib_index,
+                                                     swizzle_index);
+}
+
+static void
+swr_tcs_llvm_store_output(const struct lp_build_tgsi_tess_iface *tess_iface,
+                          struct lp_build_tgsi_context * bld_base,
+                          boolean is_vindex_indirect,
+                          LLVMValueRef vertex_index,
+                          boolean is_aindex_indirect,
+                          LLVMValueRef attrib_index,
+                          LLVMValueRef swizzle_index,
+                          LLVMValueRef value,
+                          LLVMValueRef mask_vec)
+{
+    swr_tcs_llvm_iface *iface = (swr_tcs_llvm_iface*)tess_iface;
+
+    iface->pBuilder->swr_tcs_llvm_store_output(tess_iface, bld_base,
+                                              is_vindex_indirect,
+                                              vertex_index,
+                                              is_aindex_indirect,
+                                              attrib_index,
+                                              swizzle_index,
+                                              value,
+                                              mask_vec);
+}
+
+static LLVMValueRef
+swr_tes_llvm_fetch_vertex_input(const struct lp_build_tgsi_tess_iface *tess_iface,
+                                struct lp_build_tgsi_context * bld_base,
+                                boolean is_vindex_indirect,
+                                LLVMValueRef vertex_index,
+                                boolean is_aindex_indirect,
+                                LLVMValueRef attrib_index,
+                                LLVMValueRef swizzle_index)
+{
+    swr_tes_llvm_iface *iface = (swr_tes_llvm_iface*)tess_iface;
+
+    return iface->pBuilder->swr_tes_llvm_fetch_vertex_input(tess_iface, bld_base,
+                                                           is_vindex_indirect,
+                                                           vertex_index,
+                                                           is_aindex_indirect,
+                                                           attrib_index,
+                                                           swizzle_index);
+}
+
+static LLVMValueRef
+swr_tes_llvm_fetch_patch_input(const struct lp_build_tgsi_tess_iface *tess_iface,
+                               struct lp_build_tgsi_context * bld_base,
+                               boolean is_aindex_indirect,
+                               LLVMValueRef attrib_index,
+                               LLVMValueRef swizzle_index)
+{
+    swr_tes_llvm_iface *iface = (swr_tes_llvm_iface*)tess_iface;
+
+    return iface->pBuilder->swr_tes_llvm_fetch_patch_input(tess_iface, bld_base,
+                                                          is_aindex_indirect,
+                                                          attrib_index,
+                                                          swizzle_index);
+}
+
+/*
+ * Tessellation factor of a ScalarPatch, in the tessellator's order: GL
+ * lists the isoline density before the detail, SWR the other way round.
+ */
+Value *
+BuilderSWR::TessFactorPtr(Value *pPatch, bool outer, unsigned channel,
+                          unsigned tes_prim_mode)
+{
+   if (outer) {
+      if (tes_prim_mode == PIPE_PRIM_LINES && channel < 2)
+         channel ^= 1;
+      return GEP(pPatch, {C(0), C(ScalarPatch_tessFactors),
+                          C(SWR_TESSELLATION_FACTORS_OuterTessFactors),
+                          C(channel)});
+   }
+
+   if (channel >= SWR_NUM_INNER_TESS_FACTORS)
+      return nullptr;
+   return GEP(pPatch, {C(0), C(ScalarPatch_tessFactors),
+                       C(SWR_TESSELLATION_FACTORS_InnerTessFactors),
+                       C(channel)});
+}
+
+/*
+ * One float of a ScalarPatch: control point attribute, or per-patch
+ * attribute without a vertex index.  With the TCS info, the TESSOUTER and
+ * TESSINNER outputs go to the tessellation factors instead; nullptr for
+ * the components the factors don't have.
+ */
+Value *
+BuilderSWR::TessPatchPtr(struct tgsi_shader_info *info, unsigned tes_prim_mode,
+                         Value *pPatch, Value *vert_index, Value *attr_index,
+                         unsigned channel)
+{
+   if (info && !vert_index && isa<ConstantInt>(attr_index)) {
+      unsigned attrib = cast<ConstantInt>(attr_index)->getZExtValue();
+
+      if (info->output_semantic_name[attrib] == TGSI_SEMANTIC_TESSOUTER)
+         return TessFactorPtr(pPatch, true, channel, tes_prim_mode);
+      if (info->output_semantic_name[attrib] == TGSI_SEMANTIC_TESSINNER)
+         return TessFactorPtr(pPatch, false, channel, tes_prim_mode);
+   }
+
+   Value *pAttrib;
+   if (vert_index)
+      pAttrib = GEP(pPatch, {C(0), C(ScalarPatch_cp), vert_index,
+                             C(ScalarCPoint_attrib), attr_index});
+   else
+      pAttrib = GEP(pPatch, {C(0), C(ScalarPatch_patchData),
+                             C(ScalarCPoint_attrib), attr_index});
+
+   return GEP(BITCAST(pAttrib, mFP32PtrTy), C(channel));
+}
+
+LLVMValueRef
+BuilderSWR::swr_tcs_llvm_fetch_vertex_input(const struct lp_build_tgsi_tess_iface *tess_iface,
+                                            struct lp_build_tgsi_context * bld_base,
+                                            boolean is_vindex_indirect,
+                                            LLVMValueRef vertex_index,
+                                            boolean is_aindex_indirect,
+                                            LLVMValueRef attrib_index,
+                                            LLVMValueRef swizzle_index)
+{
+    swr_tcs_llvm_iface *iface = (swr_tcs_llvm_iface*)tess_iface;
+    Value *vert_index = unwrap(vertex_index);
+    Value *attr_index = unwrap(attrib_index);
+
+    IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+    if (is_vindex_indirect || is_aindex_indirect) {
+       int i;
+       Value *res = unwrap(bld_base->base.zero);
+       struct lp_type type = bld_base->base.type;
+
+       for (i = 0; i < type.length; i++) {
+          Value *vert_chan_index = vert_index;
+          Value *attr_chan_index = attr_index;
+
+          if (is_vindex_indirect) {
+             vert_chan_index = VEXTRACT(vert_index, C(i));
+          }
+          if (is_aindex_indirect) {
+             attr_chan_index = VEXTRACT(attr_index, C(i));
+          }
+
+          Value *attrib =
+             LOAD(GEP(iface->pVtxAttribMap, {C(0), attr_chan_index}));
+
+          Value *pInput =
+             LOAD(GEP(iface->pTcsCtx, {C(0), C(SWR_HS_CONTEXT_vert),
+                                       vert_chan_index, C(simdvertex_attrib),
+                                       attrib, unwrap(swizzle_index)}));
+
+          Value *value = VEXTRACT(pInput, C(i));
+          res = VINSERT(res, value, C(i));
+       }
+
+       return wrap(res);
+    } else {
+       Value *attrib = LOAD(GEP(iface->pVtxAttribMap, {C(0), attr_index}));
+
+       Value *pInput =
+          LOAD(GEP(iface->pTcsCtx, {C(0), C(SWR_HS_CONTEXT_vert),
+                                    vert_index, C(simdvertex_attrib),
+                                    attrib, unwrap(swizzle_index)}));
+
+       return wrap(pInput);
+    }
+}
+
+LLVMValueRef
+BuilderSWR::swr_tcs_llvm_fetch_output(const struct lp_build_tgsi_tess_iface *tess_iface,
+                                      struct lp_build_tgsi_context * bld_base,
+                                      boolean is_vindex_indirect,
+                                      LLVMValueRef vertex_index,
+                                      boolean is_aindex_indirect,
+                                      LLVMValueRef attrib_index,
+                                      LLVMValueRef swizzle_index)
+{
+    swr_tcs_llvm_iface *iface = (swr_tcs_llvm_iface*)tess_iface;
+    Value *vert_index = vertex_index ? unwrap(vertex_index) : nullptr;
+    Value *attr_index = unwrap(attrib_index);
+    unsigned channel = cast<ConstantInt>(unwrap(swizzle_index))->getZExtValue();
+
+    IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+    Value *pCPout = LOAD(iface->pTcsCtx, {0, SWR_HS_CONTEXT_pCPout});
+    Value *res = unwrap(bld_base->base.zero);
+
+    // each lane is a patch
+    for (uint32_t lane = 0; lane < mVWidth; ++lane) {
+       Value *vert_chan_index = vert_index;
+       Value *attr_chan_index = attr_index;
+
+       if (vert_index && is_vindex_indirect) {
+          vert_chan_index = VEXTRACT(vert_index, C(lane));
+       }
+       if (is_aindex_indirect) {
+          attr_chan_index = VEXTRACT(attr_index, C(lane));
+       }
+
+       Value *pOutput = TessPatchPtr(iface->info, iface->tes_prim_mode,
+                                     GEP(pCPout, C(lane)),
+                                     vert_chan_index, attr_chan_index,
+                                     channel);
+       if (!pOutput)
+          break;
+
+       res = VINSERT(res, LOAD(pOutput), C(lane));
+    }
+
+    return wrap(res);
+}
+
+void
+BuilderSWR::swr_tcs_llvm_store_output(const struct lp_build_tgsi_tess_iface *tess_iface,
+                                      struct lp_build_tgsi_context * bld_base,
+                                      boolean is_vindex_indirect,
+                                      LLVMValueRef vertex_index,
+                                      boolean is_aindex_indirect,
+                                      LLVMValueRef attrib_index,
+                                      LLVMValueRef swizzle_index,
+                                      LLVMValueRef value,
+                                      LLVMValueRef mask_vec)
+{
+    swr_tcs_llvm_iface *iface = (swr_tcs_llvm_iface*)tess_iface;
+    Value *vert_index = vertex_index ? unwrap(vertex_index) : nullptr;
+    Value *attr_index = unwrap(attrib_index);
+    unsigned channel = cast<ConstantInt>(unwrap(swizzle_index))->getZExtValue();
+
+    IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+    Value *pCPout = LOAD(iface->pTcsCtx, {0, SWR_HS_CONTEXT_pCPout});
+    Value *vMask1 = TRUNC(unwrap(mask_vec), VectorType::get(mInt1Ty, mVWidth));
+
+    Value *pStack = STACKSAVE();
+    Value *pTmpPtr = ALLOCA(mFP32Ty, C(4)); // used for dummy write for lane masking
+
+    // each lane is a patch
+    for (uint32_t lane = 0; lane < mVWidth; ++lane) {
+       Value *vert_chan_index = vert_index;
+       Value *attr_chan_index = attr_index;
+
+       if (vert_index && is_vindex_indirect) {
+          vert_chan_index = VEXTRACT(vert_index, C(lane));
+       }
+       if (is_aindex_indirect) {
+          attr_chan_index = VEXTRACT(attr_index, C(lane));
+       }
+
+       Value *pOutput = TessPatchPtr(iface->info, iface->tes_prim_mode,
+                                     GEP(pCPout, C(lane)),
+                                     vert_chan_index, attr_chan_index,
+                                     channel);
+       if (!pOutput)
+          break;
+
+       Value *pLaneMask = VEXTRACT(vMask1, C(lane));
+       pOutput = SELECT(pLaneMask, pOutput, pTmpPtr);
+
+       STORE(VEXTRACT(unwrap(value), C(lane)), pOutput);
+    }
+
+    STACKRESTORE(pStack);
+}
+
+LLVMValueRef
+BuilderSWR::swr_tes_llvm_fetch_vertex_input(const struct lp_build_tgsi_tess_iface *tess_iface,
+                                            struct lp_build_tgsi_context * bld_base,
+                                            boolean is_vindex_indirect,
+                                            LLVMValueRef vertex_index,
+                                            boolean is_aindex_indirect,
+                                            LLVMValueRef attrib_index,
+                                            LLVMValueRef swizzle_index)
+{
+    swr_tes_llvm_iface *iface = (swr_tes_llvm_iface*)tess_iface;
+    Value *vert_index = unwrap(vertex_index);
+    Value *attr_index = unwrap(attrib_index);
+    unsigned channel = cast<ConstantInt>(unwrap(swizzle_index))->getZExtValue();
+
+    IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+    // all the lanes share the patch
+    Value *pCpIn = LOAD(iface->pTesCtx, {0, SWR_DS_CONTEXT_pCpIn});
+
+    if (is_vindex_indirect || is_aindex_indirect) {
+       int i;
+       Value *res = unwrap(bld_base->base.zero);
+       struct lp_type type = bld_base->base.type;
+
+       for (i = 0; i < type.length; i++) {
+          Value *vert_chan_index = vert_index;
+          Value *attr_chan_index = attr_index;
+
+          if (is_vindex_indirect) {
+             vert_chan_index = VEXTRACT(vert_index, C(i));
+          }
+          if (is_aindex_indirect) {
+             attr_chan_index = VEXTRACT(attr_index, C(i));
+          }
+
+          Value *attrib =
+             LOAD(GEP(iface->pPatchAttribMap, {C(0), attr_chan_index}));
+
+          Value *value = LOAD(TessPatchPtr(nullptr, 0, pCpIn,
+                                           vert_chan_index, attrib, channel));
+          res = VINSERT(res, value, C(i));
+       }
+
+       return wrap(res);
+    } else {
+       Value *attrib = LOAD(GEP(iface->pPatchAttribMap, {C(0), attr_index}));
+
+       Value *value = LOAD(TessPatchPtr(nullptr, 0, pCpIn,
+                                        vert_index, attrib, channel));
+
+       return wrap(VBROADCAST(value));
+    }
+}
+
+LLVMValueRef
+BuilderSWR::swr_tes_llvm_fetch_patch_input(const struct lp_build_tgsi_tess_iface *tess_iface,
+                                           struct lp_build_tgsi_context * bld_base,
+                                           boolean is_aindex_indirect,
+                                           LLVMValueRef attrib_index,
+                                           LLVMValueRef swizzle_index)
+{
+    swr_tes_llvm_iface *iface = (swr_tes_llvm_iface*)tess_iface;
+    Value *attr_index = unwrap(attrib_index);
+    unsigned channel = cast<ConstantInt>(unwrap(swizzle_index))->getZExtValue();
+
+    IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+    Value *pCpIn = LOAD(iface->pTesCtx, {0, SWR_DS_CONTEXT_pCpIn});
+
+    if (is_aindex_indirect) {
+       int i;
+       Value *res = unwrap(bld_base->base.zero);
+       struct lp_type type = bld_base->base.type;
+
+       for (i = 0; i < type.length; i++) {
+          Value *attr_chan_index = VEXTRACT(attr_index, C(i));
+          Value *attrib =
+             LOAD(GEP(iface->pPatchAttribMap, {C(0), attr_chan_index}));
+
+          Value *value = LOAD(TessPatchPtr(nullptr, 0, pCpIn,
+                                           nullptr, attrib, channel));
+          res = VINSERT(res, value, C(i));
+       }
+
+       return wrap(res);
+    } else {
+       Value *attrib = LOAD(GEP(iface->pPatchAttribMap, {C(0), attr_index}));
+
+       Value *value = LOAD(TessPatchPtr(nullptr, 0, pCpIn,
+                                        nullptr, attrib, channel));
+
+       return wrap(VBROADCAST(value));
+    }
+}
+
+/*
+ * Slot of a VS output in SWR_HS_CONTEXT::vert.  The frontend copies the VS
+ * output vertex into the HS input from VERTEX_ATTRIB_START_SLOT on, see
+ * SWR_TS_STATE::vertexAttribOffset in swr_update_derived.
+ */
+static unsigned
+swr_tcs_input_slot(ubyte semantic_name, ubyte semantic_idx,
+                   struct tgsi_shader_info *vs_info)
+{
+   unsigned vs_slot;
+
+   if (semantic_name == TGSI_SEMANTIC_POSITION) {
+      vs_slot = VERTEX_POSITION_SLOT;
+   } else {
+      vs_slot = locate_linkage(semantic_name, semantic_idx, vs_info);
+
+      vs_slot += VERTEX_ATTRIB_START_SLOT;
+
+      if (vs_info->output_semantic_name[0] == TGSI_SEMANTIC_POSITION)
+         vs_slot--;
+   }
+
+   return MIN2(VERTEX_ATTRIB_START_SLOT + vs_slot, SWR_VTX_NUM_SLOTS - 1);
+}
+
+PFN_HS_FUNC
+BuilderSWR::CompileTCS(struct swr_context *ctx, swr_jit_tcs_key &key)
+{
+   struct swr_tess_ctrl_shader *tcs =
+      ctx->tcs ? ctx->tcs : ctx->tcs_fixed_func;
+   struct tgsi_shader_info *info = &tcs->info.base;
+   struct tgsi_shader_info *vs_info = &ctx->vs->info.base;
+
+   AttrBuilder attrBuilder;
+   attrBuilder.addStackAlignmentAttr(JM()->mVWidth * sizeof(float));
+
+   std::vector<Type *> tcsArgs{PointerType::get(Gen_swr_draw_context(JM()), 0),
+                               PointerType::get(Gen_SWR_HS_CONTEXT(JM()), 0)};
+   FunctionType *tcsFuncType =
+      FunctionType::get(Type::getVoidTy(JM()->mContext), tcsArgs, false);
+
+   // create new tess control shader function
+   auto pFunction = Function::Create(tcsFuncType,
+                                     GlobalValue::ExternalLinkage,
+                                     "TCS",
+                                     JM()->mpCurrentModule);
+#if HAVE_LLVM < 0x0500
+   AttributeSet attrSet = AttributeSet::get(
+      JM()->mContext, AttributeSet::FunctionIndex, attrBuilder);
+   pFunction->addAttributes(AttributeSet::FunctionIndex, attrSet);
+#else
+   pFunction->addAttributes(AttributeList::FunctionIndex, attrBuilder);
+#endif
+
+   BasicBlock *block = BasicBlock::Create(JM()->mContext, "entry", pFunction);
+   IRB()->SetInsertPoint(block);
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(block));
+
+   auto argitr = pFunction->arg_begin();
+   Value *hPrivateData = &*argitr++;
+   hPrivateData->setName("hPrivateData");
+   Value *pTcsCtx = &*argitr++;
+   pTcsCtx->setName("tcsCtx");
+
+   if (!tcs->pipe.tokens) {
+      // fixed function: pass the control points through, 8 patches at a time
+      Value *pCPout = LOAD(pTcsCtx, {0, SWR_HS_CONTEXT_pCPout});
+
+      for (uint32_t attrib = 0; attrib < vs_info->num_outputs; attrib++) {
+         unsigned slot =
+            swr_tcs_input_slot(vs_info->output_semantic_name[attrib],
+                               vs_info->output_semantic_index[attrib],
+                               vs_info);
+
+         for (uint32_t vert = 0; vert < key.vertices_per_patch; vert++) {
+            for (uint32_t channel = 0; channel < TGSI_NUM_CHANNELS; channel++) {
+               Value *vData = LOAD(pTcsCtx, {0, SWR_HS_CONTEXT_vert, vert,
+                                             simdvertex_attrib, slot, channel});
+
+               for (uint32_t lane = 0; lane < mVWidth; ++lane) {
+                  Value *pOutput = TessPatchPtr(nullptr, 0,
+                                                GEP(pCPout, C(lane)),
+                                                C(vert), C(attrib), channel);
+                  STORE(VEXTRACT(vData, C(lane)), pOutput);
+               }
+            }
+         }
+      }
+
+      for (uint32_t lane = 0; lane < mVWidth; ++lane) {
+         Value *pPatch = GEP(pCPout, C(lane));
+
+         for (uint32_t i = 0; i < 4; i++) {
+            Value *level =
+               LOAD(hPrivateData, {0, swr_draw_context_defaultTessOuter, i});
+            STORE(level, TessFactorPtr(pPatch, true, i, key.tes_prim_mode));
+         }
+         for (uint32_t i = 0; i < 2; i++) {
+            Value *level =
+               LOAD(hPrivateData, {0, swr_draw_context_defaultTessInner, i});
+            STORE(level, TessFactorPtr(pPatch, false, i, key.tes_prim_mode));
+         }
+      }
+
+      RET_VOID();
+
+      gallivm_verify_function(gallivm, wrap(pFunction));
+
+      PFN_HS_FUNC pFunc =
+         (PFN_HS_FUNC)JitFunction(pFunction, "TCS",
+                                  tcs->pipe.tokens, key);
+
+      debug_printf("tess ctrl shader  %p\n", pFunc);
+      assert(pFunc && "Error: TessCtrlShader = NULL");
+
+      JM()->mIsModuleFinalized = true;
+
+      return pFunc;
+   }
+
+   /*
+    * The invocations of the 8 patches in flight run one after the other,
+    * each a SIMD8 call of the body.  A barrier splits the body into
+    * phases, and every invocation finishes a phase before any starts the
+    * next one; the temporaries then live in memory, see
+    * lp_build_tgsi_cs_iface.
+    */
+   struct lp_type type = lp_type_float_vec(32, 32 * 8);
+   unsigned num_phases = info->opcode_count[TGSI_OPCODE_BARRIER] + 1;
+   unsigned num_invocations = info->properties[TGSI_PROPERTY_TCS_VERTICES_OUT];
+   unsigned temps_vectors = num_phases > 1 ?
+      lp_build_tgsi_soa_temps_size(info, type) / (sizeof(float) * mVWidth) : 0;
+
+   std::vector<Type *> bodyArgs{PointerType::get(Gen_swr_draw_context(JM()), 0),
+                                PointerType::get(Gen_SWR_HS_CONTEXT(JM()), 0),
+                                mInt32Ty, mInt32Ty, mInt8PtrTy};
+   FunctionType *bodyFuncType =
+      FunctionType::get(Type::getVoidTy(JM()->mContext), bodyArgs, false);
+   auto pBody = Function::Create(bodyFuncType,
+                                 GlobalValue::InternalLinkage,
+                                 "TCS_invocation",
+                                 JM()->mpCurrentModule);
+#if HAVE_LLVM < 0x0500
+   pBody->addAttributes(AttributeSet::FunctionIndex, attrSet);
+#else
+   pBody->addAttributes(AttributeList::FunctionIndex, attrBuilder);
+#endif
+
+   Value *pTemps = temps_vectors ?
+      BITCAST(ALLOCA(mSimdFP32Ty, C(temps_vectors * num_invocations)),
+              PointerType::get(mSimdFP32Ty, 0)) :
+      nullptr;
+
+   for (unsigned phase = 0; phase < num_phases; phase++) {
+      BasicBlock *pPreheader = IRB()->GetInsertBlock();
+      BasicBlock *pLoop =
+         BasicBlock::Create(JM()->mContext, "invocation", pFunction);
+      BasicBlock *pDone =
+         BasicBlock::Create(JM()->mContext, "phase_end", pFunction);
+
+      BR(pLoop);
+      IRB()->SetInsertPoint(pLoop);
+
+      PHINode *pInvocation = PHI(mInt32Ty, 2);
+      pInvocation->addIncoming(C(0), pPreheader);
+
+      Value *pInvocationTemps = pTemps ?
+         BITCAST(GEP(pTemps, MUL(pInvocation, C(temps_vectors))), mInt8PtrTy) :
+         ConstantPointerNull::get(cast<PointerType>(mInt8PtrTy));
+
+      CALL(pBody, {hPrivateData, pTcsCtx, pInvocation, C(phase),
+                   pInvocationTemps});
+
+      Value *pNext = ADD(pInvocation, C(1));
+      pInvocation->addIncoming(pNext, pLoop);
+      COND_BR(ICMP_ULT(pNext, C(num_invocations)), pLoop, pDone);
+
+      IRB()->SetInsertPoint(pDone);
+   }
+
+   RET_VOID();
+
+   block = BasicBlock::Create(JM()->mContext, "entry", pBody);
+   IRB()->SetInsertPoint(block);
+   LLVMPositionBuilderAtEnd(gallivm->builder, wrap(block));
+
+   argitr = pBody->arg_begin();
+   hPrivateData = &*argitr++;
+   hPrivateData->setName("hPrivateData");
+   pTcsCtx = &*argitr++;
+   pTcsCtx->setName("tcsCtx");
+   Value *invocation = &*argitr++;
+   invocation->setName("invocation");
+   Value *phase = &*argitr++;
+   phase->setName("phase");
+   Value *temps = &*argitr++;
+   temps->setName("temps");
+
+   Value *consts_ptr =
+      GEP(hPrivateData, {C(0), C(swr_draw_context_constantTCS)});
+   consts_ptr->setName("tcs_constants");
+   Value *const_sizes_ptr =
+      GEP(hPrivateData, {0, swr_draw_context_num_constantsTCS});
+   const_sizes_ptr->setName("num_tcs_constants");
+
+   struct lp_build_sampler_soa *sampler =
+      swr_sampler_soa_create(key.sampler, PIPE_SHADER_TESS_CTRL);
+
+   struct lp_bld_tgsi_system_values system_values;
+   memset(&system_values, 0, sizeof(system_values));
+   system_values.prim_id = wrap(LOAD(pTcsCtx, {0, SWR_HS_CONTEXT_PrimitiveID}));
+   system_values.invocation_id = wrap(invocation);
+   system_values.vertices_in = wrap(C(key.vertices_per_patch));
+
+   Value *vtxAttribMap = ALLOCA(ArrayType::get(mInt32Ty, PIPE_MAX_SHADER_INPUTS));
+   for (unsigned slot = 0; slot < info->num_inputs; slot++) {
+      unsigned hs_slot = swr_tcs_input_slot(info->input_semantic_name[slot],
+                                            info->input_semantic_index[slot],
+                                            vs_info);
+
+      STORE(C(hs_slot), vtxAttribMap, {0, slot});
+   }
+
+   struct lp_build_mask_context mask;
+   Value *mask_val = LOAD(pTcsCtx, {0, SWR_HS_CONTEXT_mask}, "tcsMask");
+   lp_build_mask_begin(&mask, gallivm, type, wrap(mask_val));
+
+   struct lp_build_tgsi_cs_iface cs_iface;
+   memset(&cs_iface, 0, sizeof(cs_iface));
+   cs_iface.phase = wrap(phase);
+   cs_iface.temps_ptr = wrap(temps);
+
+   struct swr_tcs_llvm_iface tcs_iface;
+   memset(&tcs_iface, 0, sizeof(tcs_iface));
+   tcs_iface.base.fetch_vertex_input = ::swr_tcs_llvm_fetch_vertex_input;
+   tcs_iface.base.fetch_output = ::swr_tcs_llvm_fetch_output;
+   tcs_iface.base.emit_store_output = ::swr_tcs_llvm_store_output;
+   tcs_iface.info = info;
+   tcs_iface.pBuilder = this;
+   tcs_iface.pTcsCtx = pTcsCtx;
+   tcs_iface.tes_prim_mode = key.tes_prim_mode;
+   tcs_iface.pVtxAttribMap = vtxAttribMap;
+
+   LLVMValueRef inputs[PIPE_MAX_SHADER_INPUTS][TGSI_NUM_CHANNELS];
+   LLVMValueRef outputs[PIPE_MAX_SHADER_OUTPUTS][TGSI_NUM_CHANNELS];
+
+   memset(outputs, 0, sizeof(outputs));
+
+   lp_build_tgsi_soa(gallivm,
+                     tcs->pipe.tokens,
+                     type,
+                     &mask,
+                     wrap(consts_ptr),
+                     wrap(const_sizes_ptr),
+                     &system_values,
+                     inputs,
+                     outputs,
+                     wrap(hPrivateData), // (sampler context)
+                     NULL, // thread data
+                     sampler,
+                     info,
+                     NULL, // geometry shader interface
+                     num_phases > 1 ? &cs_iface : NULL,
+                     &tcs_iface.base);
+
+   lp_build_mask_end(&mask);
+
+   sampler->destroy(sampler);
+
+   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+
+   RET_VOID();
+
+   gallivm_verify_function(gallivm, wrap(pBody));
+   gallivm_verify_function(gallivm, wrap(pFunction));
 
-       Value *pLaneMask = VEXTRACT(vMask1, C(lane));
-       pStreamOffset = SELECT(pLaneMask, pStreamOffset, pTmpPtr);
+   PFN_HS_FUNC pFunc =
+      (PFN_HS_FUNC)JitFunction(pFunction, "TCS",
+                               tcs->pipe.tokens, key);
 
-       Value *vVal = LOAD(pStreamOffset);
-       vVal = OR(vVal, VEXTRACT(vValue, C(lane)));
-       STORE(vVal, pStreamOffset);
-    }
+   debug_printf("tess ctrl shader  %p\n", pFunc);
+   assert(pFunc && "Error: TessCtrlShader = NULL");
 
-    STACKRESTORE(pStack);
+   JM()->mIsModuleFinalized = true;
+
+   return pFunc;
 }
 
-void
-BuilderSWR::swr_gs_llvm_epilogue(const struct lp_build_tgsi_gs_iface *gs_base,
-                        struct lp_build_tgsi_context * bld_base,
-                        LLVMValueRef total_emitted_vertices_vec,
-                        LLVMValueRef emitted_prims_vec)
+PFN_HS_FUNC
+swr_compile_tcs(struct swr_context *ctx, swr_jit_tcs_key &key)
 {
-   swr_gs_llvm_iface *iface = (swr_gs_llvm_iface*)gs_base;
+   struct swr_tess_ctrl_shader *tcs =
+      ctx->tcs ? ctx->tcs : ctx->tcs_fixed_func;
 
-   IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
+   BuilderSWR builder(
+      reinterpret_cast<JitManager *>(swr_screen(ctx->pipe.screen)->hJitMgr),
+      "TCS");
+   PFN_HS_FUNC func = builder.CompileTCS(ctx, key);
 
-   // Store emit count to each output stream in the first DWORD
-   for (uint32_t lane = 0; lane < mVWidth; ++lane)
-   {
-      Value* pStream = LOAD(iface->pGsCtx, {0, SWR_GS_CONTEXT_pStreams, lane});
-      pStream = BITCAST(pStream, mInt32PtrTy);
-      Value* pLaneCount = VEXTRACT(unwrap(total_emitted_vertices_vec), C(lane));
-      STORE(pLaneCount, pStream);
-   }
+   tcs->map.insert(std::make_pair(key, make_unique<VariantTCS>(builder.gallivm, func)));
+   return func;
 }
 
-PFN_GS_FUNC
-BuilderSWR::CompileGS(struct swr_context *ctx, swr_jit_gs_key &key)
+/*
+ * Clip and cull distances of the vertex in outputs, from the shader's
+ * CLIPDIST outputs or the user clip planes; write(dist, slot, channel)
+ * stores one of them.
+ */
+template <typename WriteFunc>
+void
+BuilderSWR::WriteClipDistances(struct swr_context *ctx,
+                               struct tgsi_shader_info *info,
+                               Value *hPrivateData,
+                               LLVMValueRef (*outputs)[TGSI_NUM_CHANNELS],
+                               bool simd16, WriteFunc write)
 {
-   SWR_GS_STATE *pGS = &ctx->gs->gsState;
-   struct tgsi_shader_info *info = &ctx->gs->info.base;
+   if (ctx->rasterizer->clip_plane_enable ||
+       info->culldist_writemask) {
+      unsigned clip_mask = ctx->rasterizer->clip_plane_enable;
 
-   memset(pGS, 0, sizeof(*pGS));
+      unsigned cv = 0;
+      if (info->writes_clipvertex) {
+         cv = locate_linkage(TGSI_SEMANTIC_CLIPVERTEX, 0,
+                             info);
+      } else {
+         for (int i = 0; i < PIPE_MAX_SHADER_OUTPUTS; i++) {
+            if (info->output_semantic_name[i] == TGSI_SEMANTIC_POSITION &&
+                info->output_semantic_index[i] == 0) {
+               cv = i;
+               break;
+            }
+         }
+      }
+      LLVMValueRef cx = LLVMBuildLoad(gallivm->builder, outputs[cv][0], "");
+      LLVMValueRef cy = LLVMBuildLoad(gallivm->builder, outputs[cv][1], "");
+      LLVMValueRef cz = LLVMBuildLoad(gallivm->builder, outputs[cv][2], "");
+      LLVMValueRef cw = LLVMBuildLoad(gallivm->builder, outputs[cv][3], "");
 
-   pGS->gsEnable = true;
+      for (unsigned val = 0; val < PIPE_MAX_CLIP_PLANES; val++) {
+         // clip distance overrides user clip planes
+         if ((info->clipdist_writemask & clip_mask & (1 << val)) ||
+             ((info->culldist_writemask << info->num_written_clipdistance) & (1 << val))) {
+            unsigned cv = locate_linkage(TGSI_SEMANTIC_CLIPDIST, val < 4 ? 0 : 1,
+                                         info);
+            if (val < 4) {
+               LLVMValueRef dist = LLVMBuildLoad(gallivm->builder, outputs[cv][val], "");
+               write(unwrap(dist), VERTEX_CLIPCULL_DIST_LO_SLOT, val);
+            } else {
+               LLVMValueRef dist = LLVMBuildLoad(gallivm->builder, outputs[cv][val - 4], "");
+               write(unwrap(dist), VERTEX_CLIPCULL_DIST_HI_SLOT, val - 4);
+            }
+            continue;
+         }
 
-   pGS->numInputAttribs = info->num_inputs;
-   pGS->outputTopology =
-      swr_convert_prim_topology(info->properties[TGSI_PROPERTY_GS_OUTPUT_PRIM]);
-   pGS->maxNumVerts = info->properties[TGSI_PROPERTY_GS_MAX_OUTPUT_VERTICES];
-   pGS->instanceCount = info->properties[TGSI_PROPERTY_GS_INVOCATIONS];
+         if (!(clip_mask & (1 << val)))
+            continue;
 
-   // XXX: single stream for now...
-   pGS->isSingleStream = true;
-   pGS->singleStreamID = 0;
+         Value *px = LOAD(GEP(hPrivateData, {0, swr_draw_context_userClipPlanes, val, 0}));
+         Value *py = LOAD(GEP(hPrivateData, {0, swr_draw_context_userClipPlanes, val, 1}));
+         Value *pz = LOAD(GEP(hPrivateData, {0, swr_draw_context_userClipPlanes, val, 2}));
+         Value *pw = LOAD(GEP(hPrivateData, {0, swr_draw_context_userClipPlanes, val, 3}));
+         Value *bpx = simd16 ? VBROADCAST_16(px) : VBROADCAST(px);
+         Value *bpy = simd16 ? VBROADCAST_16(py) : VBROADCAST(py);
+         Value *bpz = simd16 ? VBROADCAST_16(pz) : VBROADCAST(pz);
+         Value *bpw = simd16 ? VBROADCAST_16(pw) : VBROADCAST(pw);
+         Value *dist = FADD(FMUL(unwrap(cx), bpx),
+                            FADD(FMUL(unwrap(cy), bpy),
+                                 FADD(FMUL(unwrap(cz), bpz),
+                                      FMUL(unwrap(cw), bpw))));
 
-   pGS->vertexAttribOffset = VERTEX_ATTRIB_START_SLOT; // TODO: optimize
-   pGS->srcVertexAttribOffset = VERTEX_ATTRIB_START_SLOT; // TODO: optimize
-   pGS->inputVertStride = pGS->numInputAttribs + pGS->vertexAttribOffset;
-   pGS->outputVertexSize = SWR_VTX_NUM_SLOTS;
-   pGS->controlDataSize = 8; // GS ouputs max of 8 32B units
-   pGS->controlDataOffset = VERTEX_COUNT_SIZE;
-   pGS->outputVertexOffset = pGS->controlDataOffset + CONTROL_HEADER_SIZE;
+         if (val < 4)
+            write(dist, VERTEX_CLIPCULL_DIST_LO_SLOT, val);
+         else
+            write(dist, VERTEX_CLIPCULL_DIST_HI_SLOT, val - 4);
+      }
+   }
 
-   pGS->allocationSize =
-      VERTEX_COUNT_SIZE + // vertex count
-      CONTROL_HEADER_SIZE + // control header
-      (SWR_VTX_NUM_SLOTS * 16) * // sizeof vertex
-      pGS->maxNumVerts; // num verts
+}
 
-   struct swr_geometry_shader *gs = ctx->gs;
+void
+BuilderSWR::WriteDS(Value *pVal, Value *pDsContext, unsigned slot, unsigned channel)
+{
+   // one row of vectorStride vectors per attribute component
+   Value *pOutput = LOAD(pDsContext, {0, SWR_DS_CONTEXT_pOutputData});
+   Value *vectorStride = LOAD(pDsContext, {0, SWR_DS_CONTEXT_vectorStride});
+   Value *vectorOffset = LOAD(pDsContext, {0, SWR_DS_CONTEXT_vectorOffset});
+
+   Value *index = ADD(MUL(C(slot * 4 + channel), vectorStride), vectorOffset);
+   STORE(pVal, GEP(pOutput, index));
+}
+
+PFN_DS_FUNC
+BuilderSWR::CompileTES(struct swr_context *ctx, swr_jit_tes_key &key)
+{
+   struct swr_tess_eval_shader *tes = ctx->tes;
+   struct tgsi_shader_info *info = &tes->info.base;
+   unsigned prim_mode = info->properties[TGSI_PROPERTY_TES_PRIM_MODE];
 
    LLVMValueRef inputs[PIPE_MAX_SHADER_INPUTS][TGSI_NUM_CHANNELS];
    LLVMValueRef outputs[PIPE_MAX_SHADER_OUTPUTS][TGSI_NUM_CHANNELS];
@@ -583,15 +1779,15 @@ BuilderSWR::CompileGS(struct swr_context *ctx, swr_jit_gs_key &key)
    AttrBuilder attrBuilder;
    attrBuilder.addStackAlignmentAttr(JM()->mVWidth * sizeof(float));
 
-   std::vector<Type *> gsArgs{PointerType::get(Gen_swr_draw_context(JM()), 0),
-                              PointerType::get(Gen_SWR_GS_CONTEXT(JM()), 0)};
-   FunctionType *vsFuncType =
-      FunctionType::get(Type::getVoidTy(JM()->mContext), gsArgs, false);
+   std::vector<Type *> tesArgs{PointerType::get(Gen_swr_draw_context(JM()), 0),
+                               PointerType::get(Gen_SWR_DS_CONTEXT(JM()), 0)};
+   FunctionType *tesFuncType =
+      FunctionType::get(Type::getVoidTy(JM()->mContext), tesArgs, false);
 
-   // create new vertex shader function
-   auto pFunction = Function::Create(vsFuncType,
+   // create new tess evaluation shader function
+   auto pFunction = Function::Create(tesFuncType,
                                      GlobalValue::ExternalLinkage,
-                                     "GS",
+                                     "TES",
                                      JM()->mpCurrentModule);
 #if HAVE_LLVM < 0x0500
    AttributeSet attrSet = AttributeSet::get(
@@ -608,74 +1804,72 @@ BuilderSWR::CompileGS(struct swr_context *ctx, swr_jit_gs_key &key)
    auto argitr = pFunction->arg_begin();
    Value *hPrivateData = &*argitr++;
    hPrivateData->setName("hPrivateData");
-   Value *pGsCtx = &*argitr++;
-   pGsCtx->setName("gsCtx");
+   Value *pTesCtx = &*argitr++;
+   pTesCtx->setName("tesCtx");
 
    Value *consts_ptr =
-      GEP(hPrivateData, {C(0), C(swr_draw_context_constantGS)});
-   consts_ptr->setName("gs_constants");
+      GEP(hPrivateData, {C(0), C(swr_draw_context_constantTES)});
+   consts_ptr->setName("tes_constants");
    Value *const_sizes_ptr =
-      GEP(hPrivateData, {0, swr_draw_context_num_constantsGS});
-   const_sizes_ptr->setName("num_gs_constants");
+      GEP(hPrivateData, {0, swr_draw_context_num_constantsTES});
+   const_sizes_ptr->setName("num_tes_constants");
 
    struct lp_build_sampler_soa *sampler =
-      swr_sampler_soa_create(key.sampler, PIPE_SHADER_GEOMETRY);
+      swr_sampler_soa_create(key.sampler, PIPE_SHADER_TESS_EVAL);
+
+   // the lanes are domain points of a single patch
+   Value *pCpIn = LOAD(pTesCtx, {0, SWR_DS_CONTEXT_pCpIn});
+   Value *vectorOffset = LOAD(pTesCtx, {0, SWR_DS_CONTEXT_vectorOffset});
+   Value *u = LOAD(GEP(LOAD(pTesCtx, {0, SWR_DS_CONTEXT_pDomainU}), vectorOffset));
+   Value *v = LOAD(GEP(LOAD(pTesCtx, {0, SWR_DS_CONTEXT_pDomainV}), vectorOffset));
 
    struct lp_bld_tgsi_system_values system_values;
    memset(&system_values, 0, sizeof(system_values));
-   system_values.prim_id = wrap(LOAD(pGsCtx, {0, SWR_GS_CONTEXT_PrimitiveID}));
-   system_values.instance_id = wrap(LOAD(pGsCtx, {0, SWR_GS_CONTEXT_InstanceID}));
-
-   std::vector<Constant*> mapConstants;
-   Value *vtxAttribMap = ALLOCA(ArrayType::get(mInt32Ty, PIPE_MAX_SHADER_INPUTS));
-   for (unsigned slot = 0; slot < info->num_inputs; slot++) {
-      ubyte semantic_name = info->input_semantic_name[slot];
-      ubyte semantic_idx = info->input_semantic_index[slot];
-
-      unsigned vs_slot = locate_linkage(semantic_name, semantic_idx, &ctx->vs->info.base);
-
-      vs_slot += VERTEX_ATTRIB_START_SLOT;
-
-      if (ctx->vs->info.base.output_semantic_name[0] == TGSI_SEMANTIC_POSITION)
-         vs_slot--;
-
-      if (semantic_name == TGSI_SEMANTIC_POSITION)
-         vs_slot = VERTEX_POSITION_SLOT;
-
-      STORE(C(vs_slot), vtxAttribMap, {0, slot});
-      mapConstants.push_back(C(vs_slot));
+   system_values.prim_id =
+      wrap(VBROADCAST(LOAD(pTesCtx, {0, SWR_DS_CONTEXT_PrimitiveID})));
+   system_values.vertices_in = wrap(C(key.vertices_in));
+   system_values.tess_coord[0] = wrap(u);
+   system_values.tess_coord[1] = wrap(v);
+   system_values.tess_coord[2] = prim_mode == PIPE_PRIM_TRIANGLES ?
+      wrap(FSUB(FSUB(VIMMED1(1.0f), u), v)) : wrap(VIMMED1(0.0f));
+   for (unsigned i = 0; i < 4; i++) {
+      system_values.tess_outer[i] =
+         wrap(LOAD(TessFactorPtr(pCpIn, true, i, prim_mode)));
+   }
+   for (unsigned i = 0; i < 2; i++) {
+      system_values.tess_inner[i] =
+         wrap(LOAD(TessFactorPtr(pCpIn, false, i, prim_mode)));
    }
 
-   struct lp_build_mask_context mask;
-   Value *mask_val = LOAD(pGsCtx, {0, SWR_GS_CONTEXT_mask}, "gsMask");
-   lp_build_mask_begin(&mask, gallivm,
-                       lp_type_float_vec(32, 32 * 8), wrap(mask_val));
+   // the fixed-function TCS stores the VS outputs at their own index
+   struct tgsi_shader_info *pPrevShader;
+   if (ctx->tcs)
+      pPrevShader = &ctx->tcs->info.base;
+   else
+      pPrevShader = &ctx->vs->info.base;
 
-   // zero out cut buffer so we can load/modify/store bits
-   for (uint32_t lane = 0; lane < mVWidth; ++lane)
-   {
-      Value* pStream = LOAD(pGsCtx, {0, SWR_GS_CONTEXT_pStreams, lane});
-      MEMSET(pStream, C((char)0), VERTEX_COUNT_SIZE + CONTROL_HEADER_SIZE, sizeof(float) * KNOB_SIMD_WIDTH);
+   Value *patchAttribMap = ALLOCA(ArrayType::get(mInt32Ty, PIPE_MAX_SHADER_INPUTS));
+   for (unsigned slot = 0; slot < info->num_inputs; slot++) {
+      unsigned tcs_slot = locate_linkage(info->input_semantic_name[slot],
+                                         info->input_semantic_index[slot],
+                                         pPrevShader);
+
+      STORE(C(MIN2(tcs_slot, SWR_VTX_NUM_SLOTS - 1)), patchAttribMap, {0, slot});
    }
 
-   struct swr_gs_llvm_iface gs_iface;
-   gs_iface.base.fetch_input = ::swr_gs_llvm_fetch_input;
-   gs_iface.base.emit_vertex = ::swr_gs_llvm_emit_vertex;
-   gs_iface.base.end_primitive = ::swr_gs_llvm_end_primitive;
-   gs_iface.base.gs_epilogue = ::swr_gs_llvm_epilogue;
-   gs_iface.pBuilder = this;
-   gs_iface.pGsCtx = pGsCtx;
-   gs_iface.pGsState = pGS;
-   gs_iface.num_outputs = gs->info.base.num_outputs;
-   gs_iface.num_verts_per_prim =
-      u_vertices_per_prim((pipe_prim_type)info->properties[TGSI_PROPERTY_GS_OUTPUT_PRIM]);
-   gs_iface.info = info;
-   gs_iface.pVtxAttribMap = vtxAttribMap;
+   struct swr_tes_llvm_iface tes_iface;
+   memset(&tes_iface, 0, sizeof(tes_iface));
+   tes_iface.base.fetch_vertex_input = ::swr_tes_llvm_fetch_vertex_input;
+   tes_iface.base.fetch_patch_input = ::swr_tes_llvm_fetch_patch_input;
+   tes_iface.info = info;
+   tes_iface.pBuilder = this;
+   tes_iface.pTesCtx = pTesCtx;
+   tes_iface.pPatchAttribMap = patchAttribMap;
 
    lp_build_tgsi_soa(gallivm,
-                     gs->pipe.tokens,
+                     tes->pipe.tokens,
                      lp_type_float_vec(32, 32 * 8),
-                     &mask,
+                     NULL, // mask
                      wrap(consts_ptr),
                      wrap(const_sizes_ptr),
                      &system_values,
@@ -684,40 +1878,73 @@ BuilderSWR::CompileGS(struct swr_context *ctx, swr_jit_gs_key &key)
                      wrap(hPrivateData), // (sampler context)
                      NULL, // thread data
                      sampler,
-                     &gs->info.base,
-                     &gs_iface.base);
-
-   lp_build_mask_end(&mask);
+                     info,
+                     NULL, // geometry shader interface
+                     NULL, // compute shader interface
+                     &tes_iface.base);
 
    sampler->destroy(sampler);
 
    IRB()->SetInsertPoint(unwrap(LLVMGetInsertBlock(gallivm->builder)));
 
+   // same vertex layout as the VS writes
+   for (uint32_t channel = 0; channel < TGSI_NUM_CHANNELS; channel++) {
+      for (uint32_t attrib = 0; attrib < PIPE_MAX_SHADER_OUTPUTS; attrib++) {
+         if (!outputs[attrib][channel])
+            continue;
+
+         Value *val;
+         uint32_t outSlot;
+
+         if (info->output_semantic_name[attrib] == TGSI_SEMANTIC_PSIZE) {
+            if (channel != VERTEX_SGV_POINT_SIZE_COMP)
+               continue;
+            val = LOAD(unwrap(outputs[attrib][0]));
+            outSlot = VERTEX_SGV_SLOT;
+         } else if (info->output_semantic_name[attrib] == TGSI_SEMANTIC_POSITION) {
+            val = LOAD(unwrap(outputs[attrib][channel]));
+            outSlot = VERTEX_POSITION_SLOT;
+         } else {
+            val = LOAD(unwrap(outputs[attrib][channel]));
+            outSlot = VERTEX_ATTRIB_START_SLOT + attrib;
+            if (info->output_semantic_name[0] == TGSI_SEMANTIC_POSITION)
+               outSlot--;
+         }
+
+         WriteDS(val, pTesCtx, outSlot, channel);
+      }
+   }
+
+   WriteClipDistances(ctx, info, hPrivateData, outputs, false,
+                      [&](Value *dist, unsigned slot, unsigned channel) {
+                         WriteDS(dist, pTesCtx, slot, channel);
+                      });
+
    RET_VOID();
 
    gallivm_verify_function(gallivm, wrap(pFunction));
-   gallivm_compile_module(gallivm);
 
-   PFN_GS_FUNC pFunc =
-      (PFN_GS_FUNC)gallivm_jit_function(gallivm, wrap(pFunction));
+   PFN_DS_FUNC pFunc =
+      (PFN_DS_FUNC)JitFunction(pFunction, "TES",
+                               tes->pipe.tokens, key);
 
-   debug_printf("geom shader  %p\n", pFunc);
-   assert(pFunc && "Error: GeomShader = NULL");
+   debug_printf("tess eval shader  %p\n", pFunc);
+   assert(pFunc && "Error: TessEvalShader = NULL");
 
    JM()->mIsModuleFinalized = true;
 
    return pFunc;
 }
 
-PFN_GS_FUNC
-swr_compile_gs(struct swr_context *ctx, swr_jit_gs_key &key)
+PFN_DS_FUNC
+swr_compile_tes(struct swr_context *ctx, swr_jit_tes_key &key)
 {
    BuilderSWR builder(
       reinterpret_cast<JitManager *>(swr_screen(ctx->pipe.screen)->hJitMgr),
-      "GS");
-   PFN_GS_FUNC func = builder.CompileGS(ctx, key);
+      "TES");
+   PFN_DS_FUNC func = builder.CompileTES(ctx, key);
 
-   ctx->gs->map.insert(std::make_pair(key, make_unique<VariantGS>(builder.gallivm, func)));
+   ctx->tes->map.insert(std::make_pair(key, make_unique<VariantTES>(builder.gallivm, func)));
    return func;
 }
 
@@ -833,7 +2060,9 @@ BuilderSWR::CompileVS(struct swr_context *ctx, swr_jit_vs_key &key)
                      NULL, // thread data
                      sampler, // sampler
                      &swr_vs->info.base,
-                     NULL); // geometry shader face
+                     NULL, // geometry shader face
+                     NULL, // compute shader interface
+                     NULL); // tessellation shader interface
 
    sampler->destroy(sampler);
 
@@ -871,83 +2100,23 @@ BuilderSWR::CompileVS(struct swr_context *ctx, swr_jit_vs_key &key)
       }
    }
 
-   if (ctx->rasterizer->clip_plane_enable ||
-       swr_vs->info.base.culldist_writemask) {
-      unsigned clip_mask = ctx->rasterizer->clip_plane_enable;
-
-      unsigned cv = 0;
-      if (swr_vs->info.base.writes_clipvertex) {
-         cv = locate_linkage(TGSI_SEMANTIC_CLIPVERTEX, 0,
-                             &swr_vs->info.base);
-      } else {
-         for (int i = 0; i < PIPE_MAX_SHADER_OUTPUTS; i++) {
-            if (swr_vs->info.base.output_semantic_name[i] == TGSI_SEMANTIC_POSITION &&
-                swr_vs->info.base.output_semantic_index[i] == 0) {
-               cv = i;
-               break;
-            }
-         }
-      }
-      LLVMValueRef cx = LLVMBuildLoad(gallivm->builder, outputs[cv][0], "");
-      LLVMValueRef cy = LLVMBuildLoad(gallivm->builder, outputs[cv][1], "");
-      LLVMValueRef cz = LLVMBuildLoad(gallivm->builder, outputs[cv][2], "");
-      LLVMValueRef cw = LLVMBuildLoad(gallivm->builder, outputs[cv][3], "");
-
-      for (unsigned val = 0; val < PIPE_MAX_CLIP_PLANES; val++) {
-         // clip distance overrides user clip planes
-         if ((swr_vs->info.base.clipdist_writemask & clip_mask & (1 << val)) ||
-             ((swr_vs->info.base.culldist_writemask << swr_vs->info.base.num_written_clipdistance) & (1 << val))) {
-            unsigned cv = locate_linkage(TGSI_SEMANTIC_CLIPDIST, val < 4 ? 0 : 1,
-                                         &swr_vs->info.base);
-            if (val < 4) {
-               LLVMValueRef dist = LLVMBuildLoad(gallivm->builder, outputs[cv][val], "");
-               WriteVS(unwrap(dist), pVsCtx, vtxOutput, VERTEX_CLIPCULL_DIST_LO_SLOT, val);
-            } else {
-               LLVMValueRef dist = LLVMBuildLoad(gallivm->builder, outputs[cv][val - 4], "");
-               WriteVS(unwrap(dist), pVsCtx, vtxOutput, VERTEX_CLIPCULL_DIST_HI_SLOT, val - 4);
-            }
-            continue;
-         }
-
-         if (!(clip_mask & (1 << val)))
-            continue;
-
-         Value *px = LOAD(GEP(hPrivateData, {0, swr_draw_context_userClipPlanes, val, 0}));
-         Value *py = LOAD(GEP(hPrivateData, {0, swr_draw_context_userClipPlanes, val, 1}));
-         Value *pz = LOAD(GEP(hPrivateData, {0, swr_draw_context_userClipPlanes, val, 2}));
-         Value *pw = LOAD(GEP(hPrivateData, {0, swr_draw_context_userClipPlanes, val, 3}));
 #if USE_SIMD16_VS
-         Value *bpx = VBROADCAST_16(px);
-         Value *bpy = VBROADCAST_16(py);
-         Value *bpz = VBROADCAST_16(pz);
-         Value *bpw = VBROADCAST_16(pw);
+   bool simd16 = true;
 #else
-         Value *bpx = VBROADCAST(px);
-         Value *bpy = VBROADCAST(py);
-         Value *bpz = VBROADCAST(pz);
-         Value *bpw = VBROADCAST(pw);
+   bool simd16 = false;
 #endif
-         Value *dist = FADD(FMUL(unwrap(cx), bpx),
-                            FADD(FMUL(unwrap(cy), bpy),
-                                 FADD(FMUL(unwrap(cz), bpz),
-                                      FMUL(unwrap(cw), bpw))));
-
-         if (val < 4)
-            WriteVS(dist, pVsCtx, vtxOutput, VERTEX_CLIPCULL_DIST_LO_SLOT, val);
-         else
-            WriteVS(dist, pVsCtx, vtxOutput, VERTEX_CLIPCULL_DIST_HI_SLOT, val - 4);
-      }
-   }
+   WriteClipDistances(ctx, &swr_vs->info.base, hPrivateData, outputs, simd16,
+                      [&](Value *dist, unsigned slot, unsigned channel) {
+                         WriteVS(dist, pVsCtx, vtxOutput, slot, channel);
+                      });
 
    RET_VOID();
 
    gallivm_verify_function(gallivm, wrap(pFunction));
-   gallivm_compile_module(gallivm);
-
-   //   lp_debug_dump_value(func);
 
    PFN_VERTEX_FUNC pFunc =
-      (PFN_VERTEX_FUNC)gallivm_jit_function(gallivm, wrap(pFunction));
+      (PFN_VERTEX_FUNC)JitFunction(pFunction, "VS",
+                                   swr_vs->pipe.tokens, key);
 
    debug_printf("vert shader  %p\n", pFunc);
    assert(pFunc && "Error: VertShader = NULL");
@@ -1020,6 +2189,8 @@ BuilderSWR::CompileFS(struct swr_context *ctx, swr_jit_fs_key &key)
    struct tgsi_shader_info *pPrevShader;
    if (ctx->gs)
       pPrevShader = &ctx->gs->info.base;
+   else if (ctx->tes)
+      pPrevShader = &ctx->tes->info.base;
    else
       pPrevShader = &ctx->vs->info.base;
 
@@ -1320,7 +2491,9 @@ BuilderSWR::CompileFS(struct swr_context *ctx, swr_jit_fs_key &key)
                      NULL, // thread data
                      sampler, // sampler
                      &swr_fs->info.base,
-                     NULL); // geometry shader face
+                     NULL, // geometry shader face
+                     NULL, // compute shader interface
+                     NULL); // tessellation shader interface
 
    sampler->destroy(sampler);
 
@@ -1387,10 +2560,9 @@ BuilderSWR::CompileFS(struct swr_context *ctx, swr_jit_fs_key &key)
 
    gallivm_verify_function(gallivm, wrap(pFunction));
 
-   gallivm_compile_module(gallivm);
-
    PFN_PIXEL_KERNEL kernel =
-      (PFN_PIXEL_KERNEL)gallivm_jit_function(gallivm, wrap(pFunction));
+      (PFN_PIXEL_KERNEL)JitFunction(pFunction, "FS",
+                                    swr_fs->pipe.tokens, key);
    debug_printf("frag shader  %p\n", kernel);
    assert(kernel && "Error: FragShader = NULL");
 
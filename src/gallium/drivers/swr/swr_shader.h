@@ -26,9 +26,13 @@
 struct swr_vertex_shader;
 struct swr_fragment_shader;
 struct swr_geometry_shader;
+struct swr_tess_ctrl_shader;
+struct swr_tess_eval_shader;
 struct swr_jit_fs_key;
 struct swr_jit_vs_key;
 struct swr_jit_gs_key;
+struct swr_jit_tcs_key;
+struct swr_jit_tes_key;
 
 unsigned swr_so_adjust_attrib(unsigned in_attrib,
                               swr_vertex_shader *swr_vs);
@@ -42,6 +46,12 @@ swr_compile_fs(struct swr_context *ctx, swr_jit_fs_key &key);
 PFN_GS_FUNC
 swr_compile_gs(struct swr_context *ctx, swr_jit_gs_key &key);
 
+PFN_HS_FUNC
+swr_compile_tcs(struct swr_context *ctx, swr_jit_tcs_key &key);
+
+PFN_DS_FUNC
+swr_compile_tes(struct swr_context *ctx, swr_jit_tes_key &key);
+
 void swr_generate_fs_key(struct swr_jit_fs_key &key,
                          struct swr_context *ctx,
                          swr_fragment_shader *swr_fs);
@@ -57,6 +67,14 @@ void swr_generate_gs_key(struct swr_jit_gs_key &key,
                          struct swr_context *ctx,
                          swr_geometry_shader *swr_gs);
 
+void swr_generate_tcs_key(struct swr_jit_tcs_key &key,
+                          struct swr_context *ctx,
+                          swr_tess_ctrl_shader *swr_tcs);
+
+void swr_generate_tes_key(struct swr_jit_tes_key &key,
+                          struct swr_context *ctx,
+                          swr_tess_eval_shader *swr_tes);
+
 struct swr_jit_sampler_key {
    unsigned nr_samplers;
    unsigned nr_sampler_views;
@@ -85,6 +103,20 @@ struct swr_jit_gs_key : swr_jit_sampler_key {
    ubyte vs_output_semantic_idx[PIPE_MAX_SHADER_OUTPUTS];
 };
 
+struct swr_jit_tcs_key : swr_jit_sampler_key {
+   ubyte vs_output_semantic_name[PIPE_MAX_SHADER_OUTPUTS];
+   ubyte vs_output_semantic_idx[PIPE_MAX_SHADER_OUTPUTS];
+   unsigned tes_prim_mode; // isolines swap the first two outer levels
+   unsigned vertices_per_patch; // input patch size
+};
+
+struct swr_jit_tes_key : swr_jit_sampler_key {
+   unsigned clip_plane_mask; // from rasterizer state & tes_info
+   ubyte tcs_output_semantic_name[PIPE_MAX_SHADER_OUTPUTS];
+   ubyte tcs_output_semantic_idx[PIPE_MAX_SHADER_OUTPUTS];
+   unsigned vertices_in; // control points per patch out of the TCS
+};
+
 namespace std
 {
 template <> struct hash<swr_jit_fs_key> {
@@ -114,9 +146,25 @@ template <> struct hash<swr_jit_gs_key> {
       return util_hash_crc32(&k, sizeof(k));
    }
 };
+
+template <> struct hash<swr_jit_tcs_key> {
+   std::size_t operator()(const swr_jit_tcs_key &k) const
+   {
+      return util_hash_crc32(&k, sizeof(k));
+   }
+};
+
+template <> struct hash<swr_jit_tes_key> {
+   std::size_t operator()(const swr_jit_tes_key &k) const
+   {
+      return util_hash_crc32(&k, sizeof(k));
+   }
+};
 };
 
 bool operator==(const swr_jit_fs_key &lhs, const swr_jit_fs_key &rhs);
 bool operator==(const swr_jit_vs_key &lhs, const swr_jit_vs_key &rhs);
 bool operator==(const swr_jit_fetch_key &lhs, const swr_jit_fetch_key &rhs);
 bool operator==(const swr_jit_gs_key &lhs, const swr_jit_gs_key &rhs);
+bool operator==(const swr_jit_tcs_key &lhs, const swr_jit_tcs_key &rhs);
+bool operator==(const swr_jit_tes_key &lhs, const swr_jit_tes_key &rhs);
@@ -460,6 +460,98 @@ swr_delete_gs_state(struct pipe_context *pipe, void *gs)
    swr_fence_work_delete_gs(screen->flush_fence, swr_gs);
 }
 
+static void *
+swr_create_tcs_state(struct pipe_context *pipe,
+                     const struct pipe_shader_state *tcs)
+{
+   struct swr_tess_ctrl_shader *swr_tcs = new swr_tess_ctrl_shader;
+   if (!swr_tcs)
+      return NULL;
+
+   swr_tcs->pipe.tokens = tgsi_dup_tokens(tcs->tokens);
+
+   lp_build_tgsi_info(tcs->tokens, &swr_tcs->info);
+
+   return swr_tcs;
+}
+
+
+static void
+swr_bind_tcs_state(struct pipe_context *pipe, void *tcs)
+{
+   struct swr_context *ctx = swr_context(pipe);
+
+   if (ctx->tcs == tcs)
+      return;
+
+   ctx->tcs = (swr_tess_ctrl_shader *)tcs;
+   ctx->dirty |= SWR_NEW_TCS;
+}
+
+static void
+swr_delete_tcs_state(struct pipe_context *pipe, void *tcs)
+{
+   struct swr_tess_ctrl_shader *swr_tcs = (swr_tess_ctrl_shader *)tcs;
+   FREE((void *)swr_tcs->pipe.tokens);
+   struct swr_screen *screen = swr_screen(pipe->screen);
+
+   /* Defer deletion of tcs state */
+   swr_fence_work_delete_tcs(screen->flush_fence, swr_tcs);
+}
+
+static void *
+swr_create_tes_state(struct pipe_context *pipe,
+                     const struct pipe_shader_state *tes)
+{
+   struct swr_tess_eval_shader *swr_tes = new swr_tess_eval_shader;
+   if (!swr_tes)
+      return NULL;
+
+   swr_tes->pipe.tokens = tgsi_dup_tokens(tes->tokens);
+
+   lp_build_tgsi_info(tes->tokens, &swr_tes->info);
+
+   return swr_tes;
+}
+
+
+static void
+swr_bind_tes_state(struct pipe_context *pipe, void *tes)
+{
+   struct swr_context *ctx = swr_context(pipe);
+
+   if (ctx->tes == tes)
+      return;
+
+   ctx->tes = (swr_tess_eval_shader *)tes;
+   ctx->dirty |= SWR_NEW_TES;
+}
+
+static void
+swr_delete_tes_state(struct pipe_context *pipe, void *tes)
+{
+   struct swr_tess_eval_shader *swr_tes = (swr_tess_eval_shader *)tes;
+   FREE((void *)swr_tes->pipe.tokens);
+   struct swr_screen *screen = swr_screen(pipe->screen);
+
+   /* Defer deletion of tes state */
+   swr_fence_work_delete_tes(screen->flush_fence, swr_tes);
+}
+
+static void
+swr_set_tess_state(struct pipe_context *pipe,
+                   const float default_outer_level[4],
+                   const float default_inner_level[2])
+{
+   struct swr_context *ctx = swr_context(pipe);
+
+   memcpy(ctx->swrDC.defaultTessOuter, default_outer_level,
+          sizeof(ctx->swrDC.defaultTessOuter));
+   memcpy(ctx->swrDC.defaultTessInner, default_inner_level,
+          sizeof(ctx->swrDC.defaultTessInner));
+   ctx->dirty |= SWR_NEW_TS;
+}
+
 static void
 swr_set_constant_buffer(struct pipe_context *pipe,
                         enum pipe_shader_type shader,
@@ -481,6 +573,10 @@ swr_set_constant_buffer(struct pipe_context *pipe,
       ctx->dirty |= SWR_NEW_FSCONSTANTS;
    } else if (shader == PIPE_SHADER_GEOMETRY) {
       ctx->dirty |= SWR_NEW_GSCONSTANTS;
+   } else if (shader == PIPE_SHADER_TESS_CTRL) {
+      ctx->dirty |= SWR_NEW_TCSCONSTANTS;
+   } else if (shader == PIPE_SHADER_TESS_EVAL) {
+      ctx->dirty |= SWR_NEW_TESCONSTANTS;
    }
 
    if (cb && cb->user_buffer) {
@@ -868,6 +964,16 @@ swr_update_constants(struct swr_context *ctx, enum pipe_shader_type shaderType)
       num_constants = pDC->num_constantsGS;
       scratch = &ctx->scratch->gs_constants;
       break;
+   case PIPE_SHADER_TESS_CTRL:
+      constant = pDC->constantTCS;
+      num_constants = pDC->num_constantsTCS;
+      scratch = &ctx->scratch->tcs_constants;
+      break;
+   case PIPE_SHADER_TESS_EVAL:
+      constant = pDC->constantTES;
+      num_constants = pDC->num_constantsTES;
+      scratch = &ctx->scratch->tes_constants;
+      break;
    default:
       debug_printf("Unsupported shader type constants\n");
       return;
@@ -1388,9 +1494,148 @@ swr_update_derived(struct pipe_context *pipe,
       }
    }
 
+   /* Patch size of the draw, the TCS reads its input vertices with it */
+   if (p_draw_info && p_draw_info->mode == PIPE_PRIM_PATCHES &&
+       p_draw_info->vertices_per_patch != ctx->patch_vertices) {
+      ctx->patch_vertices = p_draw_info->vertices_per_patch;
+      ctx->dirty |= SWR_NEW_TS;
+   }
+
+   /* Tessellation */
+   if (ctx->dirty & (SWR_NEW_TCS |
+                     SWR_NEW_TES |
+                     SWR_NEW_TS |
+                     SWR_NEW_VS |
+                     SWR_NEW_RASTERIZER | // for clip planes
+                     SWR_NEW_SAMPLER |
+                     SWR_NEW_SAMPLER_VIEW |
+                     SWR_NEW_FRAMEBUFFER)) {
+      SWR_TS_STATE tsState = {0};
+
+      if (ctx->tes) {
+         struct tgsi_shader_info *tes_info = &ctx->tes->info.base;
+         struct tgsi_shader_info *vs_info = &ctx->vs->info.base;
+
+         if (!ctx->tcs && !ctx->tcs_fixed_func)
+            ctx->tcs_fixed_func = new swr_tess_ctrl_shader();
+         struct swr_tess_ctrl_shader *tcs =
+            ctx->tcs ? ctx->tcs : ctx->tcs_fixed_func;
+
+         swr_jit_tcs_key tcs_key;
+         swr_generate_tcs_key(tcs_key, ctx, tcs);
+         auto tcs_search = tcs->map.find(tcs_key);
+         PFN_HS_FUNC tcs_func;
+         if (tcs_search != tcs->map.end()) {
+            tcs_func = tcs_search->second->shader;
+         } else {
+            tcs_func = swr_compile_tcs(ctx, tcs_key);
+         }
+         ctx->api.pfnSwrSetHsFunc(ctx->swrContext, tcs_func);
+
+         swr_jit_tes_key tes_key;
+         swr_generate_tes_key(tes_key, ctx, ctx->tes);
+         auto tes_search = ctx->tes->map.find(tes_key);
+         PFN_DS_FUNC tes_func;
+         if (tes_search != ctx->tes->map.end()) {
+            tes_func = tes_search->second->shader;
+         } else {
+            tes_func = swr_compile_tes(ctx, tes_key);
+         }
+         ctx->api.pfnSwrSetDsFunc(ctx->swrContext, tes_func);
+
+         /* JIT sampler state */
+         if (ctx->dirty & SWR_NEW_SAMPLER) {
+            if (ctx->tcs)
+               swr_update_sampler_state(ctx,
+                                        PIPE_SHADER_TESS_CTRL,
+                                        tcs_key.nr_samplers,
+                                        ctx->swrDC.samplersTCS);
+            swr_update_sampler_state(ctx,
+                                     PIPE_SHADER_TESS_EVAL,
+                                     tes_key.nr_samplers,
+                                     ctx->swrDC.samplersTES);
+         }
+
+         /* JIT sampler view state */
+         if (ctx->dirty & (SWR_NEW_SAMPLER_VIEW | SWR_NEW_FRAMEBUFFER)) {
+            if (ctx->tcs)
+               swr_update_texture_state(ctx,
+                                        PIPE_SHADER_TESS_CTRL,
+                                        tcs_key.nr_sampler_views,
+                                        ctx->swrDC.texturesTCS);
+            swr_update_texture_state(ctx,
+                                     PIPE_SHADER_TESS_EVAL,
+                                     tes_key.nr_sampler_views,
+                                     ctx->swrDC.texturesTES);
+         }
+
+         tsState.tsEnable = true;
+
+         switch (tes_info->properties[TGSI_PROPERTY_TES_PRIM_MODE]) {
+         case PIPE_PRIM_QUADS:
+            tsState.domain = SWR_TS_QUAD;
+            break;
+         case PIPE_PRIM_LINES:
+            tsState.domain = SWR_TS_ISOLINE;
+            break;
+         default:
+            tsState.domain = SWR_TS_TRI;
+            break;
+         }
+
+         /* equal spacing has integer levels, the tessellator rounds up */
+         switch (tes_info->properties[TGSI_PROPERTY_TES_SPACING]) {
+         case PIPE_TESS_SPACING_FRACTIONAL_ODD:
+            tsState.partitioning = SWR_TS_ODD_FRACTIONAL;
+            break;
+         case PIPE_TESS_SPACING_FRACTIONAL_EVEN:
+            tsState.partitioning = SWR_TS_EVEN_FRACTIONAL;
+            break;
+         default:
+            tsState.partitioning = SWR_TS_INTEGER;
+            break;
+         }
+
+         if (tes_info->properties[TGSI_PROPERTY_TES_POINT_MODE]) {
+            tsState.tsOutputTopology = SWR_TS_OUTPUT_POINT;
+            tsState.postDSTopology = TOP_POINT_LIST;
+         } else if (tsState.domain == SWR_TS_ISOLINE) {
+            tsState.tsOutputTopology = SWR_TS_OUTPUT_LINE;
+            tsState.postDSTopology = TOP_LINE_LIST;
+         } else {
+            tsState.tsOutputTopology =
+               tes_info->properties[TGSI_PROPERTY_TES_VERTEX_ORDER_CW] ?
+               SWR_TS_OUTPUT_TRI_CW : SWR_TS_OUTPUT_TRI_CCW;
+            tsState.postDSTopology = TOP_TRIANGLE_LIST;
+         }
+
+         /* The HS sees the VS output slots from SGV on, in its attribute
+          * window starting at VERTEX_ATTRIB_START_SLOT; see
+          * swr_tcs_input_slot */
+         unsigned pos_adj =
+            vs_info->output_semantic_name[0] == TGSI_SEMANTIC_POSITION;
+         tsState.vertexAttribOffset = 0;
+         tsState.numHsInputAttribs =
+            std::min(VERTEX_ATTRIB_START_SLOT + vs_info->num_outputs - pos_adj,
+                     (unsigned)(SWR_VTX_NUM_SLOTS - VERTEX_ATTRIB_START_SLOT));
+         tsState.numHsOutputAttribs = SWR_VTX_NUM_SLOTS;
+
+         /* the TES writes its outputs in the VS layout */
+         tsState.numDsOutputAttribs = SWR_VTX_NUM_SLOTS;
+         tsState.dsAllocationSize = SWR_VTX_NUM_SLOTS;
+         tsState.dsOutVtxAttribOffset = VERTEX_ATTRIB_START_SLOT;
+      } else {
+         ctx->api.pfnSwrSetHsFunc(ctx->swrContext, NULL);
+         ctx->api.pfnSwrSetDsFunc(ctx->swrContext, NULL);
+      }
+
+      ctx->api.pfnSwrSetTsState(ctx->swrContext, &tsState);
+   }
+
    /* GeometryShader */
    if (ctx->dirty & (SWR_NEW_GS |
                      SWR_NEW_VS |
+                     SWR_NEW_TES |
                      SWR_NEW_SAMPLER |
                      SWR_NEW_SAMPLER_VIEW)) {
       if (ctx->gs) {
@@ -1480,6 +1725,7 @@ swr_update_derived(struct pipe_context *pipe,
    if (ctx->dirty & (SWR_NEW_FS |
                      SWR_NEW_VS |
                      SWR_NEW_GS |
+                     SWR_NEW_TES |
                      SWR_NEW_RASTERIZER |
                      SWR_NEW_SAMPLER |
                      SWR_NEW_SAMPLER_VIEW |
@@ -1570,6 +1816,16 @@ swr_update_derived(struct pipe_context *pipe,
       swr_update_constants(ctx, PIPE_SHADER_GEOMETRY);
    }
 
+   /* Tessellation Control Shader Constants */
+   if (ctx->dirty & SWR_NEW_TCSCONSTANTS) {
+      swr_update_constants(ctx, PIPE_SHADER_TESS_CTRL);
+   }
+
+   /* Tessellation Evaluation Shader Constants */
+   if (ctx->dirty & SWR_NEW_TESCONSTANTS) {
+      swr_update_constants(ctx, PIPE_SHADER_TESS_EVAL);
+   }
+
    /* Depth/stencil state */
    if (ctx->dirty & (SWR_NEW_DEPTH_STENCIL_ALPHA | SWR_NEW_FRAMEBUFFER)) {
       struct pipe_depth_state *depth = &(ctx->depth_stencil->depth);
@@ -1756,10 +2012,17 @@ swr_update_derived(struct pipe_context *pipe,
       }
    }
 
-   if (ctx->dirty & (SWR_NEW_CLIP | SWR_NEW_RASTERIZER | SWR_NEW_VS)) {
+   /* The last stage that writes the clip distances, see WriteClipDistances */
+   struct tgsi_shader_info *pLastVtx =
+      ctx->tes ?
+      &ctx->tes->info.base :
+      &ctx->vs->info.base;
+
+   if (ctx->dirty & (SWR_NEW_CLIP | SWR_NEW_RASTERIZER | SWR_NEW_VS |
+                     SWR_NEW_TES)) {
       // shader exporting clip distances overrides all user clip planes
       if (ctx->rasterizer->clip_plane_enable &&
-          !ctx->vs->info.base.num_written_clipdistance)
+          !pLastVtx->num_written_clipdistance)
       {
          swr_draw_context *pDC = &ctx->swrDC;
          memcpy(pDC->userClipPlanes,
@@ -1773,16 +2036,16 @@ swr_update_derived(struct pipe_context *pipe,
    if (ctx->gs) {
       backendState.numAttributes = ctx->gs->info.base.num_outputs - 1;
    } else {
-      backendState.numAttributes = ctx->vs->info.base.num_outputs - 1;
+      backendState.numAttributes = pLastVtx->num_outputs - 1;
       if (ctx->fs->info.base.uses_primid) {
          backendState.numAttributes++;
          backendState.swizzleEnable = true;
          for (unsigned i = 0; i < sizeof(backendState.numComponents); i++) {
             backendState.swizzleMap[i].sourceAttrib = i;
          }
-         backendState.swizzleMap[ctx->vs->info.base.num_outputs - 1].constantSource =
+         backendState.swizzleMap[pLastVtx->num_outputs - 1].constantSource =
             SWR_CONSTANT_SOURCE_PRIM_ID;
-         backendState.swizzleMap[ctx->vs->info.base.num_outputs - 1].componentOverrideMask = 1;
+         backendState.swizzleMap[pLastVtx->num_outputs - 1].componentOverrideMask = 1;
       }
    }
    if (ctx->rasterizer->sprite_coord_enable)
@@ -1799,18 +2062,18 @@ swr_update_derived(struct pipe_context *pipe,
    struct tgsi_shader_info *pLastFE =
       ctx->gs ?
       &ctx->gs->info.base :
-      &ctx->vs->info.base;
+      pLastVtx;
    backendState.readRenderTargetArrayIndex = pLastFE->writes_layer;
    backendState.readViewportArrayIndex = pLastFE->writes_viewport_index;
    backendState.vertexAttribOffset = VERTEX_ATTRIB_START_SLOT; // TODO: optimize
 
    backendState.clipDistanceMask =
-      ctx->vs->info.base.num_written_clipdistance ?
-      ctx->vs->info.base.clipdist_writemask & ctx->rasterizer->clip_plane_enable :
+      pLastVtx->num_written_clipdistance ?
+      pLastVtx->clipdist_writemask & ctx->rasterizer->clip_plane_enable :
       ctx->rasterizer->clip_plane_enable;
 
    backendState.cullDistanceMask =
-      ctx->vs->info.base.culldist_writemask << ctx->vs->info.base.num_written_clipdistance;
+      pLastVtx->culldist_writemask << pLastVtx->num_written_clipdistance;
 
    // Assume old layout of SGV, POSITION, CLIPCULL, ATTRIB
    backendState.vertexClipCullOffset = backendState.vertexAttribOffset - 2;
@@ -1919,6 +2182,16 @@ swr_state_init(struct pipe_context *pipe)
    pipe->bind_gs_state = swr_bind_gs_state;
    pipe->delete_gs_state = swr_delete_gs_state;
 
+   pipe->create_tcs_state = swr_create_tcs_state;
+   pipe->bind_tcs_state = swr_bind_tcs_state;
+   pipe->delete_tcs_state = swr_delete_tcs_state;
+
+   pipe->create_tes_state = swr_create_tes_state;
+   pipe->bind_tes_state = swr_bind_tes_state;
+   pipe->delete_tes_state = swr_delete_tes_state;
+
+   pipe->set_tess_state = swr_set_tess_state;
+
    pipe->set_constant_buffer = swr_set_constant_buffer;
 
    pipe->create_vertex_elements_state = swr_create_vertex_elements_state;
@@ -49,6 +49,8 @@ struct ShaderVariant {
 typedef ShaderVariant<PFN_VERTEX_FUNC> VariantVS;
 typedef ShaderVariant<PFN_PIXEL_KERNEL> VariantFS;
 typedef ShaderVariant<PFN_GS_FUNC> VariantGS;
+typedef ShaderVariant<PFN_HS_FUNC> VariantTCS;
+typedef ShaderVariant<PFN_DS_FUNC> VariantTES;
 
 /* skeleton */
 struct swr_vertex_shader {
@@ -76,6 +78,25 @@ struct swr_geometry_shader {
    std::unordered_map<swr_jit_gs_key, std::unique_ptr<VariantGS>> map;
 };
 
+/*
+ * A NULL pipe.tokens is the fixed-function control shader, used when a
+ * TES is bound without a TCS: it passes the VS outputs through and writes
+ * the default tessellation levels.
+ */
+struct swr_tess_ctrl_shader {
+   struct pipe_shader_state pipe;
+   struct lp_tgsi_info info;
+
+   std::unordered_map<swr_jit_tcs_key, std::unique_ptr<VariantTCS>> map;
+};
+
+struct swr_tess_eval_shader {
+   struct pipe_shader_state pipe;
+   struct lp_tgsi_info info;
+
+   std::unordered_map<swr_jit_tes_key, std::unique_ptr<VariantTES>> map;
+};
+
 /* Vertex element state */
 struct swr_vertex_element_state {
    FETCH_COMPILE_STATE fsState;
@@ -340,7 +361,8 @@ swr_convert_target_type(const enum pipe_texture_target target)
  * Convert mesa PIPE_PRIM_X to SWR enum PRIMITIVE_TOPOLOGY
  */
 static INLINE enum PRIMITIVE_TOPOLOGY
-swr_convert_prim_topology(const unsigned mode)
+swr_convert_prim_topology(const unsigned mode,
+                          const unsigned vertices_per_patch = 0)
 {
    switch (mode) {
    case PIPE_PRIM_POINTS:
@@ -371,6 +393,10 @@ swr_convert_prim_topology(const unsigned mode)
       return TOP_TRI_LIST_ADJ;
    case PIPE_PRIM_TRIANGLE_STRIP_ADJACENCY:
       return TOP_TRI_STRIP_ADJ;
+   case PIPE_PRIM_PATCHES:
+      assert(vertices_per_patch >= 1 &&
+             vertices_per_patch <= MAX_NUM_VERTS_PER_PRIM);
+      return (PRIMITIVE_TOPOLOGY)(TOP_PATCHLIST_BASE + vertices_per_patch);
    default:
       assert(0 && "Unknown topology");
       return TOP_UNKNOWN;
@@ -0,0 +1,557 @@
+/**************************************************************************
+ *
+ * Copyright 2018 VMware, Inc.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ **************************************************************************/
+
+
+/*
+ * Tests and benchmark for the draw module post-transform vertex cache.
+ *
+ * Index streams are run through the vsplit front end, with a middle end
+ * that only checks what it is handed: every draw element must map back to
+ * the index it came from, and no vertex may be fetched twice within a
+ * segment.  The total number of fetches is compared against the number of
+ * distinct vertices for streams which fit in a single segment.
+ *
+ * A few procedural meshes, plus any Wavefront .obj files given on the
+ * command line, are then drawn the same way to report the vertex shader
+ * invocations per triangle (the average cache miss ratio, ACMR) and the
+ * hit ratio from draw_get_vertex_cache_stats().
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util/u_memory.h"
+#include "draw/draw_context.h"
+#include "draw/draw_private.h"
+#include "draw/draw_pt.h"
+#include "draw/draw_vertex_cache.h"
+
+
+#define MAX_VERTICES 4096
+
+
+struct test_middle_end {
+   struct draw_pt_middle_end base;
+
+   /* the final fetch index of every element of the stream being drawn */
+   const unsigned *expected;
+   unsigned num_expected;
+
+   unsigned fetches;
+   unsigned draws;
+   unsigned errors;
+};
+
+
+static void
+test_prepare(struct draw_pt_middle_end *middle, unsigned prim, unsigned opt,
+             unsigned *max_vertices)
+{
+   *max_vertices = MAX_VERTICES;
+}
+
+
+static void
+test_run(struct draw_pt_middle_end *middle,
+         const unsigned *fetch_elts, unsigned fetch_count,
+         const ushort *draw_elts, unsigned draw_count,
+         unsigned prim_flags)
+{
+   struct test_middle_end *test = (struct test_middle_end *)middle;
+   unsigned i, j;
+
+   for (i = 0; i < fetch_count; i++) {
+      for (j = 0; j < i; j++) {
+         if (fetch_elts[i] == fetch_elts[j]) {
+            printf("vertex 0x%x fetched twice in a segment\n", fetch_elts[i]);
+            test->errors++;
+         }
+      }
+   }
+
+   for (i = 0; i < draw_count; i++) {
+      unsigned expected;
+
+      if (test->draws + i >= test->num_expected) {
+         printf("more elements drawn than given\n");
+         test->errors++;
+         break;
+      }
+
+      expected = test->expected[test->draws + i];
+      if (draw_elts[i] >= fetch_count ||
+          fetch_elts[draw_elts[i]] != expected) {
+         printf("element %u: expected vertex 0x%x\n",
+                test->draws + i, expected);
+         test->errors++;
+      }
+   }
+
+   test->fetches += fetch_count;
+   test->draws += draw_count;
+}
+
+
+static void
+test_finish(struct draw_pt_middle_end *middle)
+{
+}
+
+
+/**
+ * Draw a triangle list with the given index buffer through vsplit.
+ *
+ * \return the number of vertices fetched, or ~0 on error.
+ */
+static unsigned
+test_draw(const char *name, const void *elts, unsigned elt_size, int bias,
+          const unsigned *expected, unsigned count,
+          struct draw_vertex_cache_stats *stats)
+{
+   struct draw_context *draw = CALLOC_STRUCT(draw_context);
+   struct draw_pt_front_end *vsplit;
+   struct test_middle_end test;
+
+   memset(&test, 0, sizeof test);
+   test.base.prepare = test_prepare;
+   test.base.run = test_run;
+   test.base.finish = test_finish;
+   test.expected = expected;
+   test.num_expected = count;
+
+   draw->pt.user.elts = elts;
+   draw->pt.user.eltSizeIB = elt_size;
+   draw->pt.user.eltSize = elt_size;
+   draw->pt.user.eltMax = count;
+   draw->pt.user.eltBias = bias;
+   /* an index range larger than the draw avoids the linear fetch path */
+   draw->pt.user.min_index = 0;
+   draw->pt.user.max_index = ~0;
+
+   vsplit = draw_pt_vsplit(draw);
+   vsplit->prepare(vsplit, PIPE_PRIM_TRIANGLES, &test.base, 0);
+   vsplit->run(vsplit, 0, count);
+   vsplit->flush(vsplit, DRAW_FLUSH_STATE_CHANGE);
+   vsplit->destroy(vsplit);
+
+   if (stats)
+      draw_get_vertex_cache_stats(draw, stats);
+   FREE(draw);
+
+   if (test.draws != count) {
+      printf("%s: %u of %u elements drawn\n", name, test.draws, count);
+      test.errors++;
+   }
+
+   return test.errors ? ~0 : test.fetches;
+}
+
+
+static boolean
+test_stream(const char *name, const unsigned *elts, unsigned count,
+            unsigned expected_fetches)
+{
+   unsigned fetches = test_draw(name, elts, 4, 0, elts, count, NULL);
+
+   if (fetches != expected_fetches) {
+      printf("%s: %u vertices fetched, expected %u\n",
+             name, fetches, expected_fetches);
+      return FALSE;
+   }
+   return TRUE;
+}
+
+
+/**
+ * A w x h grid of quads, as a triangle list.
+ */
+static unsigned *
+make_grid(unsigned w, unsigned h, unsigned *count)
+{
+   unsigned *elts = MALLOC(w * h * 6 * sizeof *elts);
+   unsigned x, y, n = 0;
+
+   for (y = 0; y < h; y++) {
+      for (x = 0; x < w; x++) {
+         unsigned v = y * (w + 1) + x;
+
+         elts[n++] = v;
+         elts[n++] = v + 1;
+         elts[n++] = v + w + 1;
+         elts[n++] = v + w + 1;
+         elts[n++] = v + 1;
+         elts[n++] = v + w + 2;
+      }
+   }
+
+   *count = n;
+   return elts;
+}
+
+
+static boolean
+test_grid(void)
+{
+   unsigned count;
+   unsigned *elts = make_grid(8, 8, &count);
+   boolean pass = test_stream("grid", elts, count, 9 * 9);
+
+   FREE(elts);
+   return pass;
+}
+
+
+/**
+ * Vertices a multiple of 256 apart, which all collided in the direct-mapped
+ * cache vsplit used to have.
+ */
+static boolean
+test_stride(void)
+{
+   unsigned elts[300];
+   unsigned i;
+
+   for (i = 0; i < ARRAY_SIZE(elts); i++)
+      elts[i] = (i % 3) * 256;
+
+   return test_stream("stride", elts, ARRAY_SIZE(elts), 3);
+}
+
+
+/**
+ * A long stream in random order, split into several segments.  Only the
+ * element mapping and uniqueness per segment are checked.
+ */
+static boolean
+test_random(void)
+{
+   const unsigned count = 3 * 2000;
+   unsigned *elts = MALLOC(count * sizeof *elts);
+   unsigned i, fetches;
+
+   srand(0);
+   for (i = 0; i < count; i++)
+      elts[i] = rand() % 700;
+
+   fetches = test_draw("random", elts, 4, 0, elts, count, NULL);
+   FREE(elts);
+
+   return fetches != ~0;
+}
+
+
+/**
+ * DRAW_MAX_FETCH_IDX must be cached like any other index, whether it's in
+ * the index buffer or the result of the index bias.
+ */
+static boolean
+test_max_index(void)
+{
+   static const unsigned uint_elts[] = {
+      0xffffffff, 0, 1,
+      1, 0, 0xffffffff,
+      0xffffffff, 1, 2,
+   };
+   static const ushort ushort_elts[] = {
+      0, 1, 2,
+      2, 1, 0,
+      0, 2, 3,
+   };
+   unsigned expected[ARRAY_SIZE(ushort_elts)];
+   boolean pass = TRUE;
+   unsigned i;
+
+   pass = test_stream("max index", uint_elts, ARRAY_SIZE(uint_elts), 4) &&
+          pass;
+
+   for (i = 0; i < ARRAY_SIZE(ushort_elts); i++)
+      expected[i] = ushort_elts[i] - 1;
+
+   if (test_draw("max index bias", ushort_elts, 2, -1,
+                 expected, ARRAY_SIZE(ushort_elts), NULL) != 4) {
+      printf("max index bias: wrong number of vertices fetched\n");
+      pass = FALSE;
+   }
+
+   return pass;
+}
+
+
+/**
+ * Entries of an old generation must not be found again once the
+ * generation counter wraps around.
+ */
+static boolean
+test_generation_wrap(void)
+{
+   struct draw_vertex_cache *cache = CALLOC_STRUCT(draw_vertex_cache);
+   boolean pass = TRUE;
+
+   draw_vertex_cache_clear(cache);
+   draw_vertex_cache_add(cache, 5, 0);
+
+   cache->generation = ~0u;
+   draw_vertex_cache_add(cache, 7, 0);
+   if (draw_vertex_cache_add(cache, 7, 1) != 0) {
+      printf("generation wrap: entry not found before wrap\n");
+      pass = FALSE;
+   }
+
+   draw_vertex_cache_clear(cache);
+   if (cache->generation == 0) {
+      printf("generation wrap: generation 0 is in use\n");
+      pass = FALSE;
+   }
+
+   /* 5 was tagged with generation 1, which the counter restarts at */
+   if (draw_vertex_cache_add(cache, 5, 1) != 1 ||
+       draw_vertex_cache_add(cache, 7, 2) != 2) {
+      printf("generation wrap: stale entry found after wrap\n");
+      pass = FALSE;
+   }
+
+   if (draw_vertex_cache_add(cache, 5, 3) != 1) {
+      printf("generation wrap: entry not found after wrap\n");
+      pass = FALSE;
+   }
+
+   FREE(cache);
+   return pass;
+}
+
+
+struct mesh {
+   char name[64];
+   unsigned num_vertices;
+   unsigned num_indices;
+   unsigned max_indices;
+   unsigned *indices;
+};
+
+
+static void
+mesh_add_triangle(struct mesh *mesh, unsigned a, unsigned b, unsigned c)
+{
+   if (mesh->num_indices + 3 > mesh->max_indices) {
+      unsigned new_max = MAX2(mesh->max_indices * 2, 3 * 1024);
+      mesh->indices = REALLOC(mesh->indices,
+                              mesh->max_indices * sizeof *mesh->indices,
+                              new_max * sizeof *mesh->indices);
+      mesh->max_indices = new_max;
+   }
+   mesh->indices[mesh->num_indices++] = a;
+   mesh->indices[mesh->num_indices++] = b;
+   mesh->indices[mesh->num_indices++] = c;
+}
+
+
+static void
+mesh_grid(struct mesh *mesh, unsigned n)
+{
+   memset(mesh, 0, sizeof *mesh);
+   snprintf(mesh->name, sizeof mesh->name, "grid %ux%u", n, n);
+   mesh->num_vertices = (n + 1) * (n + 1);
+   mesh->indices = make_grid(n, n, &mesh->num_indices);
+   mesh->max_indices = mesh->num_indices;
+}
+
+
+/**
+ * UV sphere, triangles emitted ring by ring, with the vertices numbered
+ * column by column so that the index stream is not in vertex order.
+ */
+static void
+mesh_sphere(struct mesh *mesh, unsigned rings, unsigned sectors)
+{
+   unsigned r, s;
+
+   memset(mesh, 0, sizeof *mesh);
+   snprintf(mesh->name, sizeof mesh->name, "sphere %ux%u", rings, sectors);
+   mesh->num_vertices = (rings + 1) * sectors;
+
+   for (r = 0; r < rings; r++) {
+      for (s = 0; s < sectors; s++) {
+         unsigned a = s * (rings + 1) + r;
+         unsigned b = (s + 1) % sectors * (rings + 1) + r;
+
+         mesh_add_triangle(mesh, a, b, a + 1);
+         mesh_add_triangle(mesh, b, b + 1, a + 1);
+      }
+   }
+}
+
+
+/**
+ * Shuffle whole triangles within a window, as exporters that don't
+ * optimize the index order tend to produce.
+ */
+static void
+mesh_shuffle(struct mesh *mesh, unsigned window)
+{
+   unsigned num_tris = mesh->num_indices / 3;
+   unsigned i, k;
+
+   strncat(mesh->name, " shuffled",
+           sizeof mesh->name - strlen(mesh->name) - 1);
+
+   srand(1);
+   for (i = 0; i < num_tris; i++) {
+      unsigned j = i + rand() % MIN2(window, num_tris - i);
+
+      for (k = 0; k < 3; k++) {
+         unsigned tmp = mesh->indices[i * 3 + k];
+         mesh->indices[i * 3 + k] = mesh->indices[j * 3 + k];
+         mesh->indices[j * 3 + k] = tmp;
+      }
+   }
+}
+
+
+/**
+ * Minimal Wavefront .obj reader: only faces are used, and polygons are
+ * triangulated as fans.
+ */
+static boolean
+mesh_load_obj(struct mesh *mesh, const char *filename)
+{
+   char line[1024];
+   FILE *f = fopen(filename, "r");
+
+   if (!f)
+      return FALSE;
+
+   memset(mesh, 0, sizeof *mesh);
+   snprintf(mesh->name, sizeof mesh->name, "%s", filename);
+
+   while (fgets(line, sizeof line, f)) {
+      if (line[0] == 'v' && line[1] == ' ') {
+         mesh->num_vertices++;
+      }
+      else if (line[0] == 'f' && line[1] == ' ') {
+         unsigned face[3];
+         unsigned count = 0;
+         char *tok = strtok(line + 2, " \t\r\n");
+
+         while (tok) {
+            long idx = strtol(tok, NULL, 10);
+
+            /* negative indices are relative to the current vertex count */
+            face[MIN2(count, 2)] = idx < 0 ? mesh->num_vertices + idx : idx - 1;
+            if (count >= 2) {
+               mesh_add_triangle(mesh, face[0], face[1], face[2]);
+               face[1] = face[2];
+            }
+            count++;
+            tok = strtok(NULL, " \t\r\n");
+         }
+      }
+   }
+
+   fclose(f);
+
+   return mesh->num_indices != 0;
+}
+
+
+/**
+ * Report the vertex shader invocations per triangle of a mesh.
+ */
+static boolean
+bench_mesh(struct mesh *mesh)
+{
+   unsigned num_tris = mesh->num_indices / 3;
+   struct draw_vertex_cache_stats stats;
+   unsigned fetches;
+
+   fetches = test_draw(mesh->name, mesh->indices, 4, 0,
+                       mesh->indices, num_tris * 3, &stats);
+   if (fetches != ~0) {
+      printf("%-32s %8u %8u  %6.3f  %5.1f%%\n",
+             mesh->name, num_tris, mesh->num_vertices,
+             (double)fetches / num_tris,
+             stats.lookups ? 100.0 * stats.hits / stats.lookups : 0.0);
+   }
+
+   FREE(mesh->indices);
+   return fetches != ~0;
+}
+
+
+static boolean
+bench_meshes(int argc, char **argv)
+{
+   boolean pass = TRUE;
+   struct mesh mesh;
+   int i;
+
+   printf("%-32s %8s %8s  %6s  %6s\n",
+          "mesh", "tris", "verts", "acmr", "hits");
+
+   mesh_grid(&mesh, 256);
+   pass = bench_mesh(&mesh) && pass;
+   mesh_grid(&mesh, 256);
+   mesh_shuffle(&mesh, 512);
+   pass = bench_mesh(&mesh) && pass;
+   mesh_sphere(&mesh, 64, 128);
+   pass = bench_mesh(&mesh) && pass;
+   mesh_sphere(&mesh, 64, 128);
+   mesh_shuffle(&mesh, 512);
+   pass = bench_mesh(&mesh) && pass;
+
+   for (i = 1; i < argc; i++) {
+      if (!mesh_load_obj(&mesh, argv[i])) {
+         printf("%s: could not load mesh\n", argv[i]);
+         pass = FALSE;
+         continue;
+      }
+      pass = bench_mesh(&mesh) && pass;
+   }
+
+   return pass;
+}
+
+
+int
+main(int argc, char **argv)
+{
+   boolean pass = TRUE;
+
+   pass = test_grid() && pass;
+   pass = test_stride() && pass;
+   pass = test_random() && pass;
+   pass = test_max_index() && pass;
+   pass = test_generation_wrap() && pass;
+   pass = bench_meshes(argc, argv) && pass;
+
+   if (pass)
+      printf("Success!\n");
+   else
+      printf("Failure!\n");
+
+   return pass ? 0 : 1;
+}
@@ -70,6 +70,22 @@ static inline void u_thread_setname( const char *name )
    (void)name;
 }
 
+/**
+ * Bind the calling thread to a single CPU.  This is only a hint, and is a
+ * no-op on platforms that don't support it.
+ */
+static inline void u_thread_pin_to_cpu( unsigned cpu )
+{
+#if defined(HAVE_PTHREAD) && defined(__linux__) && defined(CPU_SET)
+   cpu_set_t cpuset;
+
+   CPU_ZERO(&cpuset);
+   CPU_SET(cpu, &cpuset);
+   pthread_setaffinity_np(pthread_self(), sizeof cpuset, &cpuset);
+#endif
+   (void)cpu;
+}
+
 /*
  * Thread statistics.
  */